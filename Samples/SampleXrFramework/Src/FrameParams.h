@@ -85,6 +85,14 @@ struct ovrApplFrameIn {
     OVR::Vector2f RightRemoteJoystick = {0.0f, 0.0f};
     bool LeftRemoteTracked = false;
     bool RightRemoteTracked = false;
+    /// velocities in the tracking space, zero when the runtime does not report them
+    /// (remotes use the grip space)
+    OVR::Vector3f HeadLinearVelocity;
+    OVR::Vector3f HeadAngularVelocity;
+    OVR::Vector3f LeftRemoteLinearVelocity;
+    OVR::Vector3f LeftRemoteAngularVelocity;
+    OVR::Vector3f RightRemoteLinearVelocity;
+    OVR::Vector3f RightRemoteAngularVelocity;
     /// controller buttons
     uint32_t AllButtons = 0u;
     uint32_t AllTouches = 0u;
@@ -96,6 +104,12 @@ struct ovrApplFrameIn {
     float RightRemoteIndexTrigger = 0.0;
     float LeftRemoteGripTrigger = 0.0f;
     float RightRemoteGripTrigger = 0.0;
+    /// raw values of the ovrActionTable float and vector2 slots; the framework uses the
+    /// kInput* slots below (also copied to the named fields above), apps the rest
+    static const int kMaxInputFloats = 16;
+    static const int kMaxInputVectors = 8;
+    float InputFloats[kMaxInputFloats] = {};
+    OVR::Vector2f InputVectors[kMaxInputVectors];
 
     /// Headset
     bool HeadsetIsMounted = true;
@@ -121,6 +135,16 @@ struct ovrApplFrameIn {
     static const int kButtonLeftThumbStick = 1 << 11;
     static const int kButtonRightThumbStick = 1 << 12;
 
+    /// input slots
+    static const int kInputLeftIndexTrigger = 0;
+    static const int kInputRightIndexTrigger = 1;
+    static const int kInputLeftGripTrigger = 2;
+    static const int kInputRightGripTrigger = 3;
+    static const int kFirstAppInputFloat = 4;
+    static const int kInputLeftJoystick = 0;
+    static const int kInputRightJoystick = 1;
+    static const int kFirstAppInputVector = 2;
+
     inline bool Clicked(const uint32_t& b) const {
         const bool isDown = (b & AllButtons) != 0;
         const bool wasDown = (b & LastFrameAllButtons) != 0;
@@ -147,7 +171,7 @@ class ovrApplFrameOut {
 };
 
 struct ovrRendererOutput {
-    FrameMatrices FrameMatrices; // view and projection transforms
+    OVRFW::FrameMatrices FrameMatrices; // view and projection transforms
     std::vector<ovrDrawSurface> Surfaces; // list of surfaces to render
 };
 
@@ -0,0 +1,131 @@
+/*******************************************************************************
+
+Filename    :   ActionTable.cpp
+Content     :   Declarative mapping of OpenXR actions to the ovrApplFrameIn input snapshot.
+Language    :   C++
+
+*******************************************************************************/
+
+#include "ActionTable.h"
+
+#include <cmath>
+
+#include "Misc/Log.h"
+
+namespace OVRFW {
+
+int ovrActionTable::Add(const ovrActionBinding& binding) {
+    if (binding.FloatSlot >= ovrApplFrameIn::kMaxInputFloats ||
+        binding.VectorSlot >= ovrApplFrameIn::kMaxInputVectors) {
+        ALOGE("ovrActionTable: slot out of range");
+        return -1;
+    }
+    Bindings.push_back(binding);
+    States.emplace_back();
+    return static_cast<int>(Bindings.size()) - 1;
+}
+
+void ovrActionTable::Clear() {
+    Bindings.clear();
+    States.clear();
+    AllButtons = 0u;
+    AllTouches = 0u;
+}
+
+void ovrActionTable::Sync(XrSession session, XrTime time, ovrApplFrameIn& in) {
+    in.LastFrameAllButtons = AllButtons;
+    in.LastFrameAllTouches = AllTouches;
+    AllButtons = 0u;
+    AllTouches = 0u;
+    for (int i = 0; i < ovrApplFrameIn::kMaxInputFloats; i++) {
+        in.InputFloats[i] = 0.0f;
+    }
+    for (int i = 0; i < ovrApplFrameIn::kMaxInputVectors; i++) {
+        in.InputVectors[i] = OVR::Vector2f(0.0f, 0.0f);
+    }
+
+    XrActionStateGetInfo getInfo = {XR_TYPE_ACTION_STATE_GET_INFO};
+    const size_t count = Bindings.size();
+    for (size_t i = 0; i < count; i++) {
+        const ovrActionBinding& binding = Bindings[i];
+        ovrActionBindingState& state = States[i];
+        getInfo.action = binding.Action;
+        getInfo.subactionPath = binding.SubactionPath;
+
+        XrResult result = XR_ERROR_ACTION_TYPE_MISMATCH;
+        XrBool32 changed = XR_FALSE;
+        XrTime lastChangeTime = 0;
+        bool pressed = false;
+        switch (binding.Type) {
+            case XR_ACTION_TYPE_BOOLEAN_INPUT: {
+                XrActionStateBoolean s = {XR_TYPE_ACTION_STATE_BOOLEAN};
+                result = xrGetActionStateBoolean(session, &getInfo, &s);
+                state.IsActive = s.isActive == XR_TRUE;
+                state.Value = s.currentState ? 1.0f : 0.0f;
+                pressed = s.currentState == XR_TRUE;
+                changed = s.changedSinceLastSync;
+                lastChangeTime = s.lastChangeTime;
+                break;
+            }
+            case XR_ACTION_TYPE_FLOAT_INPUT: {
+                XrActionStateFloat s = {XR_TYPE_ACTION_STATE_FLOAT};
+                result = xrGetActionStateFloat(session, &getInfo, &s);
+                state.IsActive = s.isActive == XR_TRUE;
+                state.Value = s.currentState;
+                pressed = s.currentState > binding.Threshold;
+                changed = s.changedSinceLastSync;
+                lastChangeTime = s.lastChangeTime;
+                break;
+            }
+            case XR_ACTION_TYPE_VECTOR2F_INPUT: {
+                XrActionStateVector2f s = {XR_TYPE_ACTION_STATE_VECTOR2F};
+                result = xrGetActionStateVector2f(session, &getInfo, &s);
+                state.IsActive = s.isActive == XR_TRUE;
+                state.Vector = s.currentState;
+                state.Value = std::sqrt(
+                    s.currentState.x * s.currentState.x + s.currentState.y * s.currentState.y);
+                pressed = state.Value > binding.Threshold;
+                changed = s.changedSinceLastSync;
+                lastChangeTime = s.lastChangeTime;
+                break;
+            }
+            default:
+                break;
+        }
+        if (XR_FAILED(result)) {
+            // Same as an inactive action: no contribution this frame
+            state.IsActive = false;
+            state.Value = 0.0f;
+            state.Vector = {0.0f, 0.0f};
+            pressed = false;
+        }
+
+        state.Changed = changed == XR_TRUE;
+        if (state.Changed) {
+            state.LastChangeTime = lastChangeTime;
+        }
+        if (pressed != state.Pressed) {
+            const XrTime edgeTime = state.Changed && lastChangeTime != 0 ? lastChangeTime : time;
+            (pressed ? state.PressTime : state.ReleaseTime) = edgeTime;
+            state.Pressed = pressed;
+        }
+
+        if (pressed) {
+            AllButtons |= binding.ButtonMask;
+            AllTouches |= binding.TouchMask;
+        }
+        if (binding.FloatSlot >= 0 &&
+            std::fabs(state.Value) > std::fabs(in.InputFloats[binding.FloatSlot])) {
+            in.InputFloats[binding.FloatSlot] = state.Value;
+        }
+        if (binding.VectorSlot >= 0 &&
+            state.Value > in.InputVectors[binding.VectorSlot].Length()) {
+            in.InputVectors[binding.VectorSlot] = OVR::Vector2f(state.Vector.x, state.Vector.y);
+        }
+    }
+
+    in.AllButtons = AllButtons;
+    in.AllTouches = AllTouches;
+}
+
+} // namespace OVRFW
@@ -0,0 +1,87 @@
+/*******************************************************************************
+
+Filename    :   ActionTable.h
+Content     :   Declarative mapping of OpenXR actions to the ovrApplFrameIn input snapshot.
+Language    :   C++
+
+*******************************************************************************/
+
+#pragma once
+
+#include <vector>
+
+#include <openxr/openxr.h>
+
+#include "FrameParams.h"
+
+namespace OVRFW {
+
+// One action (and optional subaction path) and where its value goes in the snapshot.
+// Boolean actions count as pressed when true, float actions when above Threshold and
+// vector2 actions when the length is above it. While pressed, ButtonMask is OR'd into
+// AllButtons and TouchMask into AllTouches. FloatSlot/VectorSlot, when not -1, receive
+// the raw value in InputFloats/InputVectors; for several bindings on the same slot the
+// largest magnitude wins.
+struct ovrActionBinding {
+    XrAction Action = XR_NULL_HANDLE;
+    XrPath SubactionPath = XR_NULL_PATH;
+    XrActionType Type = XR_ACTION_TYPE_BOOLEAN_INPUT;
+    uint32_t ButtonMask = 0u;
+    uint32_t TouchMask = 0u;
+    float Threshold = 0.0f;
+    int FloatSlot = -1;
+    int VectorSlot = -1;
+};
+
+// State of one binding after the last Sync
+struct ovrActionBindingState {
+    bool IsActive = false;
+    bool Pressed = false;
+    float Value = 0.0f; // booleans are 0 or 1, vector2 is the length
+    XrVector2f Vector = {0.0f, 0.0f};
+    // Runtime reported a change since the previous xrSyncActions
+    bool Changed = false;
+    XrTime LastChangeTime = 0;
+    // Times Pressed last went up and down; the runtime's lastChangeTime when it has one,
+    // otherwise the sync time
+    XrTime PressTime = 0;
+    XrTime ReleaseTime = 0;
+};
+
+// Contiguous table of bindings, read in one pass per frame after xrSyncActions.
+//
+// XrApp fills it with the default controller bindings in Init; apps create extra
+// actions in BaseActionSet (so they are synced with the rest), suggest bindings for
+// them in GetSuggestedBindings and Add them here, using button bits above
+// ovrApplFrameIn::kButtonRightThumbStick or slots from kFirstAppInputFloat /
+// kFirstAppInputVector on. No change to XrApp is needed.
+class ovrActionTable {
+   public:
+    // Returns the index to read the state with
+    int Add(const ovrActionBinding& binding);
+    void Clear();
+
+    // Reads every binding and rebuilds AllButtons, AllTouches, InputFloats and
+    // InputVectors of in. The previous masks move to LastFrameAllButtons/Touches.
+    void Sync(XrSession session, XrTime time, ovrApplFrameIn& in);
+
+    int GetCount() const {
+        return static_cast<int>(Bindings.size());
+    }
+    const ovrActionBinding& GetBinding(int index) const {
+        return Bindings[index];
+    }
+    const ovrActionBindingState& GetState(int index) const {
+        return States[index];
+    }
+
+   private:
+    // Parallel arrays indexed by the value Add returns
+    std::vector<ovrActionBinding> Bindings;
+    std::vector<ovrActionBindingState> States;
+
+    uint32_t AllButtons = 0u;
+    uint32_t AllTouches = 0u;
+};
+
+} // namespace OVRFW
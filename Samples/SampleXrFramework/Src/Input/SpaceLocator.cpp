@@ -0,0 +1,194 @@
+/*******************************************************************************
+
+Filename    :   SpaceLocator.cpp
+Content     :   Frame-scoped cache of space locations, batched when possible.
+Language    :   C++
+
+*******************************************************************************/
+
+#include "SpaceLocator.h"
+
+#include "Misc/Log.h"
+
+namespace OVRFW {
+
+static const ovrSpaceLocation UntrackedLocation;
+
+void ovrSpaceLocator::Init(XrInstance instance, XrSession session, XrVersion apiVersion) {
+    Session = session;
+    LocateSpaces = nullptr;
+#if defined(XR_VERSION_1_1)
+    // Core in 1.1; on 1.0 only if the runtime exposes XR_KHR_locate_spaces (the
+    // loader fails the lookup when the extension was not enabled)
+    const char* name = XR_VERSION_MINOR(apiVersion) >= 1 || XR_VERSION_MAJOR(apiVersion) > 1
+        ? "xrLocateSpaces"
+        : "xrLocateSpacesKHR";
+    PFN_xrVoidFunction function = nullptr;
+    if (XR_SUCCEEDED(xrGetInstanceProcAddr(instance, name, &function)) && function != nullptr) {
+        LocateSpaces = reinterpret_cast<PFN_xrLocateSpaces>(function);
+    }
+#else
+    (void)instance;
+    (void)apiVersion;
+#endif // defined(XR_VERSION_1_1)
+    ALOGV("ovrSpaceLocator: %s", LocateSpaces != nullptr ? "batched" : "one call per space");
+}
+
+void ovrSpaceLocator::Shutdown() {
+    Session = XR_NULL_HANDLE;
+    LocateSpaces = nullptr;
+    Spaces.clear();
+    Locations.clear();
+    BatchDirty = true;
+    LocatedBase = XR_NULL_HANDLE;
+    LocatedTime = 0;
+}
+
+int ovrSpaceLocator::Register(XrSpace space) {
+    if (space == XR_NULL_HANDLE) {
+        return -1;
+    }
+    int freeIndex = -1;
+    for (int i = 0; i < static_cast<int>(Spaces.size()); i++) {
+        if (Spaces[i] == space) {
+            return i;
+        }
+        if (Spaces[i] == XR_NULL_HANDLE && freeIndex < 0) {
+            freeIndex = i;
+        }
+    }
+    if (freeIndex < 0) {
+        freeIndex = static_cast<int>(Spaces.size());
+        Spaces.push_back(XR_NULL_HANDLE);
+        Locations.emplace_back();
+    }
+    Spaces[freeIndex] = space;
+    Locations[freeIndex] = ovrSpaceLocation();
+    BatchDirty = true;
+    Invalidate();
+    return freeIndex;
+}
+
+void ovrSpaceLocator::Unregister(XrSpace space) {
+    for (size_t i = 0; i < Spaces.size(); i++) {
+        if (Spaces[i] == space) {
+            Spaces[i] = XR_NULL_HANDLE;
+            Locations[i] = ovrSpaceLocation();
+            BatchDirty = true;
+        }
+    }
+}
+
+const ovrSpaceLocation& ovrSpaceLocator::Get(int index) const {
+    if (index < 0 || index >= static_cast<int>(Locations.size())) {
+        return UntrackedLocation;
+    }
+    return Locations[index];
+}
+
+const ovrSpaceLocation* ovrSpaceLocator::Find(XrSpace space) const {
+    for (size_t i = 0; i < Spaces.size(); i++) {
+        if (Spaces[i] == space && space != XR_NULL_HANDLE) {
+            return &Locations[i];
+        }
+    }
+    return nullptr;
+}
+
+void ovrSpaceLocator::Locate(XrSpace baseSpace, XrTime time) {
+    if (baseSpace == XR_NULL_HANDLE || time <= 0) {
+        return;
+    }
+    if (baseSpace == LocatedBase && time == LocatedTime) {
+        return;
+    }
+    LocatedBase = baseSpace;
+    LocatedTime = time;
+
+    if (BatchDirty) {
+        BatchDirty = false;
+        BatchSpaces.clear();
+        BatchIndices.clear();
+        for (size_t i = 0; i < Spaces.size(); i++) {
+            if (Spaces[i] != XR_NULL_HANDLE) {
+                BatchSpaces.push_back(Spaces[i]);
+                BatchIndices.push_back(static_cast<int>(i));
+            }
+        }
+#if defined(XR_VERSION_1_1)
+        BatchLocations.resize(BatchSpaces.size());
+        BatchVelocities.resize(BatchSpaces.size());
+#endif // defined(XR_VERSION_1_1)
+    }
+    if (BatchSpaces.empty()) {
+        return;
+    }
+
+    if (LocateSpaces != nullptr) {
+        LocateBatched();
+    } else {
+        LocateEach();
+    }
+}
+
+void ovrSpaceLocator::LocateBatched() {
+#if defined(XR_VERSION_1_1)
+    XrSpacesLocateInfo info = {XR_TYPE_SPACES_LOCATE_INFO};
+    info.baseSpace = LocatedBase;
+    info.time = LocatedTime;
+    info.spaceCount = static_cast<uint32_t>(BatchSpaces.size());
+    info.spaces = BatchSpaces.data();
+
+    XrSpaceVelocities velocities = {XR_TYPE_SPACE_VELOCITIES};
+    velocities.velocityCount = static_cast<uint32_t>(BatchVelocities.size());
+    velocities.velocities = BatchVelocities.data();
+    XrSpaceLocations locations = {XR_TYPE_SPACE_LOCATIONS};
+    locations.next = &velocities;
+    locations.locationCount = static_cast<uint32_t>(BatchLocations.size());
+    locations.locations = BatchLocations.data();
+
+    const XrResult result = LocateSpaces(Session, &info, &locations);
+    if (XR_FAILED(result)) {
+        ALOGW("ovrSpaceLocator: xrLocateSpaces failed (%d), locating one by one", result);
+        LocateSpaces = nullptr;
+        LocateEach();
+        return;
+    }
+    for (size_t i = 0; i < BatchSpaces.size(); i++) {
+        ovrSpaceLocation& location = Locations[BatchIndices[i]];
+        location.LocationFlags = BatchLocations[i].locationFlags;
+        location.Pose = BatchLocations[i].pose;
+        location.VelocityFlags = BatchVelocities[i].velocityFlags;
+        location.LinearVelocity = location.IsLinearVelocityValid()
+            ? BatchVelocities[i].linearVelocity
+            : XrVector3f{0.0f, 0.0f, 0.0f};
+        location.AngularVelocity = location.IsAngularVelocityValid()
+            ? BatchVelocities[i].angularVelocity
+            : XrVector3f{0.0f, 0.0f, 0.0f};
+    }
+#endif // defined(XR_VERSION_1_1)
+}
+
+void ovrSpaceLocator::LocateEach() {
+    for (size_t i = 0; i < BatchSpaces.size(); i++) {
+        XrSpaceVelocity velocity = {XR_TYPE_SPACE_VELOCITY};
+        XrSpaceLocation spaceLocation = {XR_TYPE_SPACE_LOCATION};
+        spaceLocation.next = &velocity;
+        ovrSpaceLocation& location = Locations[BatchIndices[i]];
+        if (XR_FAILED(xrLocateSpace(BatchSpaces[i], LocatedBase, LocatedTime, &spaceLocation))) {
+            location = ovrSpaceLocation();
+            continue;
+        }
+        location.LocationFlags = spaceLocation.locationFlags;
+        location.Pose = spaceLocation.pose;
+        location.VelocityFlags = velocity.velocityFlags;
+        location.LinearVelocity = location.IsLinearVelocityValid()
+            ? velocity.linearVelocity
+            : XrVector3f{0.0f, 0.0f, 0.0f};
+        location.AngularVelocity = location.IsAngularVelocityValid()
+            ? velocity.angularVelocity
+            : XrVector3f{0.0f, 0.0f, 0.0f};
+    }
+}
+
+} // namespace OVRFW
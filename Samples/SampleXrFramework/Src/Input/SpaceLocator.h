@@ -0,0 +1,106 @@
+/*******************************************************************************
+
+Filename    :   SpaceLocator.h
+Content     :   Frame-scoped cache of space locations, batched when possible.
+Language    :   C++
+
+*******************************************************************************/
+
+#pragma once
+
+#include <vector>
+
+#include <openxr/openxr.h>
+
+namespace OVRFW {
+
+struct ovrSpaceLocation {
+    XrSpaceLocationFlags LocationFlags = 0;
+    XrSpaceVelocityFlags VelocityFlags = 0;
+    XrPosef Pose = {{0.0f, 0.0f, 0.0f, 1.0f}, {0.0f, 0.0f, 0.0f}};
+    XrVector3f LinearVelocity = {0.0f, 0.0f, 0.0f}; // zero unless the flag is set
+    XrVector3f AngularVelocity = {0.0f, 0.0f, 0.0f};
+
+    bool IsPositionValid() const {
+        return (LocationFlags & XR_SPACE_LOCATION_POSITION_VALID_BIT) != 0;
+    }
+    bool IsOrientationValid() const {
+        return (LocationFlags & XR_SPACE_LOCATION_ORIENTATION_VALID_BIT) != 0;
+    }
+    bool IsLinearVelocityValid() const {
+        return (VelocityFlags & XR_SPACE_VELOCITY_LINEAR_VALID_BIT) != 0;
+    }
+    bool IsAngularVelocityValid() const {
+        return (VelocityFlags & XR_SPACE_VELOCITY_ANGULAR_VALID_BIT) != 0;
+    }
+};
+
+// Locates every registered space, with velocities, once per base space and time.
+// Uses xrLocateSpaces (OpenXR 1.1) or xrLocateSpacesKHR (XR_KHR_locate_spaces) when the
+// runtime has them, so the head and controllers cost one runtime call per frame;
+// otherwise falls back to one xrLocateSpace per space.
+//
+// XrApp registers the head and controller spaces and calls Locate once per frame
+// with the predicted display time; apps can Register their own spaces in
+// SessionInit and read them from the same cache instead of calling xrLocateSpace.
+class ovrSpaceLocator {
+   public:
+    // Called once the session exists; apiVersion is the version the instance was
+    // created with
+    void Init(XrInstance instance, XrSession session, XrVersion apiVersion);
+    // Forgets all spaces, call before the session is destroyed
+    void Shutdown();
+
+    // Returns the index to read the space with; registering twice returns the same index
+    int Register(XrSpace space);
+    void Unregister(XrSpace space);
+
+    // Locates all spaces relative to baseSpace at time. Does nothing if they were
+    // already located for the same base space and time.
+    void Locate(XrSpace baseSpace, XrTime time);
+    // The next Locate runs even for the same base space and time
+    void Invalidate() {
+        LocatedTime = 0;
+    }
+
+    // Location at the last Locate; untracked until the first one
+    const ovrSpaceLocation& Get(int index) const;
+    // nullptr if the space is not registered
+    const ovrSpaceLocation* Find(XrSpace space) const;
+
+    XrTime GetLocatedTime() const {
+        return LocatedTime;
+    }
+    bool IsBatched() const {
+        return LocateSpaces != nullptr;
+    }
+
+   private:
+    void LocateBatched();
+    void LocateEach();
+
+    XrSession Session = XR_NULL_HANDLE;
+#if defined(XR_VERSION_1_1)
+    PFN_xrLocateSpaces LocateSpaces = nullptr; // same signature as xrLocateSpacesKHR
+#else
+    void* LocateSpaces = nullptr;
+#endif // defined(XR_VERSION_1_1)
+
+    // Indexed by the value Register returns; unregistered entries are XR_NULL_HANDLE
+    std::vector<XrSpace> Spaces;
+    std::vector<ovrSpaceLocation> Locations;
+
+    // Compact list handed to xrLocateSpaces, rebuilt when registrations change
+    bool BatchDirty = true;
+    std::vector<XrSpace> BatchSpaces;
+    std::vector<int> BatchIndices;
+#if defined(XR_VERSION_1_1)
+    std::vector<XrSpaceLocationData> BatchLocations;
+    std::vector<XrSpaceVelocityData> BatchVelocities;
+#endif // defined(XR_VERSION_1_1)
+
+    XrSpace LocatedBase = XR_NULL_HANDLE;
+    XrTime LocatedTime = 0;
+};
+
+} // namespace OVRFW
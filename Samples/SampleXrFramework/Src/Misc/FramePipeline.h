@@ -0,0 +1,125 @@
+/*******************************************************************************
+
+Filename    :   FramePipeline.h
+Content     :   Bounded in-order hand-off of frame packets between two threads.
+Language    :   C++
+
+*******************************************************************************/
+
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace OVRFW {
+
+// Fixed ring of Packet slots written by one producer thread and read, in the same
+// order, by one consumer thread. Slots are reused, so containers inside a packet keep
+// their capacity from frame to frame.
+//
+// depth is how many packets the producer may finish ahead of the one the consumer
+// holds: with 1 the producer builds frame N+1 while frame N is consumed.
+template <typename Packet>
+class ovrFramePipeline {
+   public:
+    // Not thread safe, call while neither side is running
+    void Start(int depth) {
+        Slots.resize(depth < 1 ? 2 : depth + 1);
+        WriteCount = 0;
+        ReadCount = 0;
+        StopRequested = false;
+        ProducerDone = false;
+    }
+    int GetDepth() const {
+        return static_cast<int>(Slots.size()) - 1;
+    }
+
+    //--------------------------------------------------------------
+    // Producer
+
+    // Next slot to fill; blocks while depth packets are waiting to be read.
+    // nullptr once a stop was requested.
+    Packet* BeginWrite() {
+        std::unique_lock<std::mutex> lock(Mutex);
+        Changed.wait(
+            lock, [this] { return StopRequested || WriteCount - ReadCount < Slots.size(); });
+        if (StopRequested) {
+            return nullptr;
+        }
+        return &Slots[WriteCount % Slots.size()];
+    }
+    // Makes the slot from BeginWrite visible to the consumer
+    void EndWrite() {
+        {
+            std::lock_guard<std::mutex> lock(Mutex);
+            WriteCount++;
+        }
+        Changed.notify_all();
+    }
+    // The producer will not write again until the next Start
+    void FinishWriting() {
+        {
+            std::lock_guard<std::mutex> lock(Mutex);
+            ProducerDone = true;
+        }
+        Changed.notify_all();
+    }
+
+    //--------------------------------------------------------------
+    // Consumer
+
+    // Oldest unread packet, or nullptr if none arrived within timeout
+    Packet* BeginRead(std::chrono::milliseconds timeout) {
+        std::unique_lock<std::mutex> lock(Mutex);
+        if (!Changed.wait_for(lock, timeout, [this] { return ReadCount < WriteCount; })) {
+            return nullptr;
+        }
+        return &Slots[ReadCount % Slots.size()];
+    }
+    // Returns the slot from BeginRead to the producer
+    void EndRead() {
+        {
+            std::lock_guard<std::mutex> lock(Mutex);
+            ReadCount++;
+        }
+        Changed.notify_all();
+    }
+
+    //--------------------------------------------------------------
+    // Either side
+
+    void RequestStop() {
+        {
+            std::lock_guard<std::mutex> lock(Mutex);
+            StopRequested = true;
+        }
+        Changed.notify_all();
+    }
+    bool IsStopRequested() const {
+        std::lock_guard<std::mutex> lock(Mutex);
+        return StopRequested;
+    }
+    bool IsProducerDone() const {
+        std::lock_guard<std::mutex> lock(Mutex);
+        return ProducerDone;
+    }
+    // Packets written and not yet read
+    int GetQueued() const {
+        std::lock_guard<std::mutex> lock(Mutex);
+        return static_cast<int>(WriteCount - ReadCount);
+    }
+
+   private:
+    mutable std::mutex Mutex;
+    std::condition_variable Changed;
+    std::vector<Packet> Slots;
+    uint64_t WriteCount = 0; // packets made visible by EndWrite
+    uint64_t ReadCount = 0; // packets returned by EndRead
+    bool StopRequested = false;
+    bool ProducerDone = false;
+};
+
+} // namespace OVRFW
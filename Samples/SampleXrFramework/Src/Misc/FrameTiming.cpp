@@ -0,0 +1,249 @@
+/*******************************************************************************
+
+Filename    :   FrameTiming.cpp
+Content     :   Per-phase CPU timing of XrApp::MainLoop frames.
+Language    :   C++
+
+*******************************************************************************/
+
+#include "FrameTiming.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "Log.h"
+
+namespace OVRFW {
+
+static_assert(
+    (ovrFrameTimer::RING_SIZE & (ovrFrameTimer::RING_SIZE - 1)) == 0,
+    "RING_SIZE must be a power of two");
+
+static const char* const FramePhaseNames[FRAME_PHASE_COUNT] = {
+    "XrEvents",
+    "WaitFrame",
+    "BeginFrame",
+    "LocateViews",
+    "SyncActions",
+    "Update",
+    "Scene",
+    "Render",
+    "RenderEye0",
+    "RenderEye1",
+    "EndFrame",
+};
+
+const char* FramePhaseName(ovrFramePhase phase) {
+    return phase >= 0 && phase < FRAME_PHASE_COUNT ? FramePhaseNames[phase] : "Unknown";
+}
+
+static const char* const FrameCounterNames[FRAME_COUNTER_COUNT] = {
+    "drawCalls",
+    "programBinds",
+    "textureBinds",
+    "bufferBinds",
+};
+
+const char* FrameCounterName(ovrFrameCounter counter) {
+    return counter >= 0 && counter < FRAME_COUNTER_COUNT ? FrameCounterNames[counter]
+                                                         : "Unknown";
+}
+
+ovrFrameTimer::~ovrFrameTimer() {
+    StopTrace();
+}
+
+// Writes one frame as complete ("X") trace events, timestamps in microseconds
+static void WriteTraceFrame(FILE* f, const ovrFrameTimingRecord& r, uint64_t originNs, bool first) {
+    const double frameUs = (r.StartNs - originNs) * 0.001;
+    fprintf(
+        f,
+        "%s{\"name\":\"Frame\",\"cat\":\"frame\",\"ph\":\"X\",\"pid\":1,\"tid\":1,"
+        "\"ts\":%.3f,\"dur\":%.3f,\"args\":{\"frame\":%lld",
+        first ? "" : ",\n",
+        frameUs,
+        r.FrameNs * 0.001,
+        static_cast<long long>(r.FrameIndex));
+    for (int c = 0; c < FRAME_COUNTER_COUNT; c++) {
+        fprintf(f, ",\"%s\":%u", FrameCounterNames[c], r.Counters[c]);
+    }
+    fprintf(f, "}}");
+    for (int p = 0; p < FRAME_PHASE_COUNT; p++) {
+        if (r.PhaseNs[p] == 0) {
+            continue;
+        }
+        fprintf(
+            f,
+            ",\n{\"name\":\"%s\",\"cat\":\"phase\",\"ph\":\"X\",\"pid\":1,\"tid\":1,"
+            "\"ts\":%.3f,\"dur\":%.3f}",
+            FramePhaseNames[p],
+            frameUs + r.PhaseStartNs[p] * 0.001,
+            r.PhaseNs[p] * 0.001);
+    }
+}
+
+void ovrFrameTimer::Publish() {
+    InFrame = false;
+    Current.FrameNs = static_cast<uint32_t>(NowNs() - Current.StartNs);
+
+    const uint64_t index = WriteCount.load(std::memory_order_relaxed);
+    Slot& slot = Ring[index & (RING_SIZE - 1)];
+    const uint32_t sequence = slot.Sequence.load(std::memory_order_relaxed);
+    slot.Sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.Record = Current;
+    slot.Sequence.store(sequence + 2, std::memory_order_release);
+    WriteCount.store(index + 1, std::memory_order_release);
+
+    if (TraceFile != nullptr && Current.FrameNs >= TraceThresholdNs) {
+        WriteTraceFrame(TraceFile, Current, TraceStartNs, TraceFrames == 0);
+        TraceFrames++;
+    }
+}
+
+bool ovrFrameTimer::ReadSlot(uint64_t index, ovrFrameTimingRecord& record) const {
+    const Slot& slot = Ring[index & (RING_SIZE - 1)];
+    // The slot holds frame index after its (index / RING_SIZE + 1)-th write
+    const uint32_t expected = static_cast<uint32_t>(2 * (index / RING_SIZE + 1));
+    for (;;) {
+        const uint32_t before = slot.Sequence.load(std::memory_order_acquire);
+        if (before != expected) {
+            if ((before & 1) == 0) {
+                return false; // overwritten by a newer frame
+            }
+            continue; // being written, retry
+        }
+        record = slot.Record;
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.Sequence.load(std::memory_order_relaxed) == before) {
+            return true;
+        }
+    }
+}
+
+bool ovrFrameTimer::GetRecord(int framesAgo, ovrFrameTimingRecord& record) const {
+    const uint64_t count = WriteCount.load(std::memory_order_acquire);
+    if (framesAgo < 0 || framesAgo >= RING_SIZE || static_cast<uint64_t>(framesAgo) >= count) {
+        return false;
+    }
+    return ReadSlot(count - 1 - framesAgo, record);
+}
+
+static void ComputePhaseStats(std::vector<uint32_t>& samples, ovrFramePhaseStats& stats) {
+    stats = ovrFramePhaseStats();
+    if (samples.empty()) {
+        return;
+    }
+    uint64_t total = 0;
+    for (const uint32_t ns : samples) {
+        total += ns;
+    }
+    stats.MeanMs = total * 1e-6 / samples.size();
+    const size_t last = samples.size() - 1;
+    const size_t p50 = std::min(last, samples.size() / 2);
+    const size_t p95 = std::min(last, samples.size() * 95 / 100);
+    std::nth_element(samples.begin(), samples.begin() + p50, samples.end());
+    stats.P50Ms = samples[p50] * 1e-6;
+    std::nth_element(samples.begin() + p50, samples.begin() + p95, samples.end());
+    stats.P95Ms = samples[p95] * 1e-6;
+    stats.MaxMs = *std::max_element(samples.begin() + p95, samples.end()) * 1e-6;
+}
+
+bool ovrFrameTimer::GetStats(int windowFrames, ovrFrameTimingStats& stats) const {
+    stats = ovrFrameTimingStats();
+    const uint64_t count = WriteCount.load(std::memory_order_acquire);
+    const int window = static_cast<int>(
+        std::min<uint64_t>(count, static_cast<uint64_t>(std::min(windowFrames, RING_SIZE))));
+    if (window <= 0) {
+        return false;
+    }
+
+    std::vector<ovrFrameTimingRecord> records;
+    records.reserve(window);
+    ovrFrameTimingRecord record;
+    for (int i = 0; i < window; i++) {
+        if (ReadSlot(count - 1 - i, record)) {
+            records.push_back(record);
+        }
+    }
+    if (records.empty()) {
+        return false;
+    }
+    stats.Frames = static_cast<int>(records.size());
+
+    std::vector<uint32_t> samples(records.size());
+    for (size_t i = 0; i < records.size(); i++) {
+        samples[i] = records[i].FrameNs;
+    }
+    ComputePhaseStats(samples, stats.Frame);
+    for (int p = 0; p < FRAME_PHASE_COUNT; p++) {
+        for (size_t i = 0; i < records.size(); i++) {
+            samples[i] = records[i].PhaseNs[p];
+        }
+        ComputePhaseStats(samples, stats.Phase[p]);
+    }
+    for (int c = 0; c < FRAME_COUNTER_COUNT; c++) {
+        uint64_t total = 0;
+        for (const ovrFrameTimingRecord& r : records) {
+            total += r.Counters[c];
+            stats.CounterMax[c] = std::max(stats.CounterMax[c], r.Counters[c]);
+        }
+        stats.CounterMean[c] = static_cast<double>(total) / records.size();
+    }
+    return true;
+}
+
+bool ovrFrameTimer::WriteChromeTrace(const char* fileName) const {
+    const uint64_t count = WriteCount.load(std::memory_order_acquire);
+    const uint64_t available = std::min<uint64_t>(count, RING_SIZE);
+    std::vector<ovrFrameTimingRecord> records;
+    records.reserve(available);
+    ovrFrameTimingRecord record;
+    for (uint64_t index = count - available; index < count; index++) {
+        if (ReadSlot(index, record)) {
+            records.push_back(record);
+        }
+    }
+
+    FILE* f = fopen(fileName, "w");
+    if (f == nullptr) {
+        ALOGE("ovrFrameTimer: could not open %s", fileName);
+        return false;
+    }
+    fprintf(f, "[\n");
+    const uint64_t originNs = records.empty() ? 0 : records.front().StartNs;
+    for (size_t i = 0; i < records.size(); i++) {
+        WriteTraceFrame(f, records[i], originNs, i == 0);
+    }
+    fprintf(f, "\n]\n");
+    const bool ok = ferror(f) == 0;
+    fclose(f);
+    return ok;
+}
+
+bool ovrFrameTimer::StartTrace(const char* fileName, double slowFrameThresholdMs) {
+    StopTrace();
+    TraceFile = fopen(fileName, "w");
+    if (TraceFile == nullptr) {
+        ALOGE("ovrFrameTimer: could not open %s", fileName);
+        return false;
+    }
+    // JSON array format: viewers accept a missing closing bracket if the app dies
+    fprintf(TraceFile, "[\n");
+    TraceThresholdNs = static_cast<uint32_t>(std::max(0.0, slowFrameThresholdMs) * 1e6);
+    TraceStartNs = NowNs();
+    TraceFrames = 0;
+    return true;
+}
+
+void ovrFrameTimer::StopTrace() {
+    if (TraceFile == nullptr) {
+        return;
+    }
+    fprintf(TraceFile, "\n]\n");
+    fclose(TraceFile);
+    TraceFile = nullptr;
+    ALOG("ovrFrameTimer: traced %llu frames", static_cast<unsigned long long>(TraceFrames));
+}
+
+} // namespace OVRFW
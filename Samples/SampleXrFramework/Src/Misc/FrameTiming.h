@@ -0,0 +1,210 @@
+/*******************************************************************************
+
+Filename    :   FrameTiming.h
+Content     :   Per-phase CPU timing of XrApp::MainLoop frames.
+Language    :   C++
+
+*******************************************************************************/
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+namespace OVRFW {
+
+// Phases of one MainLoop iteration, in the order they run
+enum ovrFramePhase {
+    FRAME_PHASE_XR_EVENTS, // HandleXrEvents
+    FRAME_PHASE_WAIT_FRAME, // PreWaitFrame + xrWaitFrame, mostly blocking
+    FRAME_PHASE_BEGIN_FRAME, // xrBeginFrame
+    FRAME_PHASE_LOCATE_VIEWS, // head and view location, eye matrices
+    FRAME_PHASE_SYNC_ACTIONS, // SyncActionSets
+    FRAME_PHASE_UPDATE, // app Update
+    FRAME_PHASE_SCENE, // Scene.Frame + GenerateFrameSurfaceList
+    FRAME_PHASE_RENDER, // app Render
+    FRAME_PHASE_RENDER_EYE_0, // acquire, AppRenderEye, resolve and release of each eye
+    FRAME_PHASE_RENDER_EYE_1,
+    FRAME_PHASE_END_FRAME, // layer composition + xrEndFrame
+    FRAME_PHASE_COUNT
+};
+
+const char* FramePhaseName(ovrFramePhase phase);
+
+// Per-frame totals of what the eye buffers drew, from the ovrDrawCounters of
+// XrApp::AppRenderEye summed over both eyes
+enum ovrFrameCounter {
+    FRAME_COUNTER_DRAW_CALLS,
+    FRAME_COUNTER_PROGRAM_BINDS,
+    FRAME_COUNTER_TEXTURE_BINDS,
+    FRAME_COUNTER_BUFFER_BINDS,
+    FRAME_COUNTER_COUNT
+};
+
+const char* FrameCounterName(ovrFrameCounter counter);
+
+// One finished frame. Times are nanoseconds; phases that did not run are 0.
+struct ovrFrameTimingRecord {
+    int64_t FrameIndex = 0;
+    uint64_t StartNs = 0; // steady clock
+    uint32_t FrameNs = 0; // whole iteration, first phase to last
+    uint32_t PhaseStartNs[FRAME_PHASE_COUNT] = {}; // relative to StartNs
+    uint32_t PhaseNs[FRAME_PHASE_COUNT] = {};
+    uint32_t Counters[FRAME_COUNTER_COUNT] = {};
+};
+
+struct ovrFramePhaseStats {
+    double P50Ms = 0.0;
+    double P95Ms = 0.0;
+    double MaxMs = 0.0;
+    double MeanMs = 0.0;
+};
+
+struct ovrFrameTimingStats {
+    int Frames = 0; // frames the statistics were computed from
+    ovrFramePhaseStats Frame;
+    ovrFramePhaseStats Phase[FRAME_PHASE_COUNT];
+    double CounterMean[FRAME_COUNTER_COUNT] = {};
+    uint32_t CounterMax[FRAME_COUNTER_COUNT] = {};
+};
+
+// Collects per-phase timings of MainLoop into a ring of the last RING_SIZE frames.
+// Only the MainLoop thread writes; any thread may read with GetRecord/GetStats.
+// Every slot is a seqlock, so readers never block the writer and retry on a torn read.
+//
+// Disabled by default. While disabled each timing point costs one predictable
+// branch; enable with SetEnabled(true), usually from AppInit.
+//
+// StartTrace streams finished frames to a Chrome trace-event JSON file
+// (chrome://tracing, ui.perfetto.dev). With a threshold only frames slower than it
+// are written, so hours-long sessions stay small and slow frames can still be
+// attributed to a phase afterwards.
+class ovrFrameTimer {
+   public:
+    static const int RING_SIZE = 1024; // power of two
+
+    ovrFrameTimer() = default;
+    ~ovrFrameTimer();
+
+    ovrFrameTimer(const ovrFrameTimer&) = delete;
+    ovrFrameTimer& operator=(const ovrFrameTimer&) = delete;
+
+    void SetEnabled(bool enabled) {
+        Enabled = enabled;
+    }
+    bool IsEnabled() const {
+        return Enabled;
+    }
+
+    static uint64_t NowNs() {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                         std::chrono::steady_clock::now().time_since_epoch())
+                                         .count());
+    }
+
+    // Starts a new record; a record that was begun but not ended is dropped
+    void BeginFrame(int64_t frameIndex) {
+        if (Enabled) {
+            Current = ovrFrameTimingRecord();
+            Current.FrameIndex = frameIndex;
+            Current.StartNs = NowNs();
+            InFrame = true;
+        }
+    }
+
+    // For when the frame index is only known after the frame has begun
+    void SetFrameIndex(int64_t frameIndex) {
+        if (InFrame) {
+            Current.FrameIndex = frameIndex;
+        }
+    }
+
+    void AddPhase(ovrFramePhase phase, uint64_t startNs, uint64_t endNs) {
+        if (InFrame && startNs >= Current.StartNs) {
+            // A phase can run more than once per frame; the time is accumulated
+            if (Current.PhaseNs[phase] == 0) {
+                Current.PhaseStartNs[phase] = static_cast<uint32_t>(startNs - Current.StartNs);
+            }
+            Current.PhaseNs[phase] += static_cast<uint32_t>(endNs - startNs);
+        }
+    }
+
+    void AddCount(ovrFrameCounter counter, uint32_t count) {
+        if (InFrame) {
+            Current.Counters[counter] += count;
+        }
+    }
+
+    // Publishes the record to the ring and to the trace file
+    void EndFrame() {
+        if (InFrame) {
+            Publish();
+        }
+    }
+
+    // Frames published since the timer was created
+    uint64_t GetFrameCount() const {
+        return WriteCount.load(std::memory_order_acquire);
+    }
+
+    // Copies the record framesAgo frames back (0 = newest). False if it was not
+    // recorded yet or has already been overwritten.
+    bool GetRecord(int framesAgo, ovrFrameTimingRecord& record) const;
+
+    // p50/p95/max/mean of the last windowFrames frames (at most RING_SIZE)
+    bool GetStats(int windowFrames, ovrFrameTimingStats& stats) const;
+
+    // Writes the frames currently in the ring as a Chrome trace
+    bool WriteChromeTrace(const char* fileName) const;
+
+    bool StartTrace(const char* fileName, double slowFrameThresholdMs = 0.0);
+    void StopTrace();
+    bool IsTracing() const {
+        return TraceFile != nullptr;
+    }
+
+   private:
+    struct Slot {
+        std::atomic<uint32_t> Sequence{0}; // odd while being written
+        ovrFrameTimingRecord Record;
+    };
+
+    void Publish();
+    bool ReadSlot(uint64_t index, ovrFrameTimingRecord& record) const;
+
+    bool Enabled = false;
+    bool InFrame = false;
+    ovrFrameTimingRecord Current;
+    Slot Ring[RING_SIZE];
+    std::atomic<uint64_t> WriteCount{0};
+
+    FILE* TraceFile = nullptr;
+    uint32_t TraceThresholdNs = 0;
+    uint64_t TraceStartNs = 0;
+    uint64_t TraceFrames = 0;
+};
+
+// Times the enclosing scope as one phase of the current frame
+class ovrFramePhaseScope {
+   public:
+    ovrFramePhaseScope(ovrFrameTimer& timer, ovrFramePhase phase)
+        : Timer(timer), Phase(phase), StartNs(timer.IsEnabled() ? ovrFrameTimer::NowNs() : 0) {}
+    ~ovrFramePhaseScope() {
+        if (StartNs != 0) {
+            Timer.AddPhase(Phase, StartNs, ovrFrameTimer::NowNs());
+        }
+    }
+
+    ovrFramePhaseScope(const ovrFramePhaseScope&) = delete;
+    ovrFramePhaseScope& operator=(const ovrFramePhaseScope&) = delete;
+
+   private:
+    ovrFrameTimer& Timer;
+    ovrFramePhase Phase;
+    uint64_t StartNs;
+};
+
+} // namespace OVRFW
@@ -28,6 +28,9 @@ Authors     :   Peter Chan
 #include "ModelAnimationUtils.h"
 #include "ModelFile.h"
 
+#include <algorithm>
+#include <cmath>
+
 #include "Misc/Log.h"
 
 using OVR::OVRMath_Lerp;
@@ -218,4 +221,442 @@ void ApplyAnimation(ModelState& modelState, int animationIndex) {
     }
 }
 
+//==============================================================
+// Compiled clips
+//==============================================================
+
+static int AccessorComponentCount(const ModelAccessorType type) {
+    switch (type) {
+        case ACCESSOR_SCALAR:
+            return 1;
+        case ACCESSOR_VEC2:
+            return 2;
+        case ACCESSOR_VEC3:
+            return 3;
+        case ACCESSOR_VEC4:
+            return 4;
+        case ACCESSOR_MAT2:
+            return 4;
+        case ACCESSOR_MAT3:
+            return 9;
+        case ACCESSOR_MAT4:
+            return 16;
+        default:
+            return 0;
+    }
+}
+
+static int CompileClipTimeLine(const ModelAnimationTimeLine& timeLine, ModelAnimationClip& clip) {
+    ModelAnimationClipTimeLine clipTimeLine;
+    clipTimeLine.startTime = timeLine.startTime;
+    clipTimeLine.endTime = timeLine.endTime;
+    clipTimeLine.firstTime = static_cast<int>(clip.times.size());
+    clipTimeLine.sampleCount = timeLine.sampleCount;
+    clip.times.insert(
+        clip.times.end(), timeLine.sampleTimes, timeLine.sampleTimes + timeLine.sampleCount);
+
+    // Direct lookup if every key is within 0.1 milliseconds of a fixed rate
+    const float duration = timeLine.endTime - timeLine.startTime;
+    if (timeLine.sampleCount > 1 && duration > 0.0f) {
+        const float step = duration / static_cast<float>(timeLine.sampleCount - 1);
+        clipTimeLine.rcpStep = 1.0f / step;
+        for (int i = 0; i < timeLine.sampleCount; i++) {
+            const float delta = timeLine.sampleTimes[i] - (timeLine.startTime + i * step);
+            if (fabsf(delta) > 1e-4f) {
+                clipTimeLine.rcpStep = 0.0f;
+                break;
+            }
+        }
+    }
+
+    if (clip.timeLines.empty()) {
+        clip.startTime = clipTimeLine.startTime;
+        clip.endTime = clipTimeLine.endTime;
+    } else {
+        clip.startTime = std::min(clip.startTime, clipTimeLine.startTime);
+        clip.endTime = std::max(clip.endTime, clipTimeLine.endTime);
+    }
+    clip.timeLines.push_back(clipTimeLine);
+    return static_cast<int>(clip.timeLines.size()) - 1;
+}
+
+void CompileAnimationClip(
+    const ModelFile& modelFile,
+    const ModelAnimation& animation,
+    ModelAnimationClip& clip) {
+    clip = ModelAnimationClip();
+    clip.name = animation.name;
+
+    // File timeline index -> clip timeline index
+    std::vector<int> clipTimeLines(modelFile.AnimationTimeLines.size(), -1);
+
+    for (const ModelAnimationChannel& channel : animation.channels) {
+        const ModelAnimationSampler* sampler = channel.sampler;
+        if (sampler == nullptr || sampler->output == nullptr || sampler->timeLineIndex < 0 ||
+            sampler->timeLineIndex >= static_cast<int>(clipTimeLines.size()) ||
+            channel.nodeIndex < 0 ||
+            channel.nodeIndex >= static_cast<int>(modelFile.Nodes.size())) {
+            ALOGW(
+                "Animation '%s': channel without sampler or node, dropped",
+                animation.name.c_str());
+            continue;
+        }
+        const ModelAnimationTimeLine& timeLine =
+            modelFile.AnimationTimeLines[sampler->timeLineIndex];
+        const ModelAccessor* output = sampler->output;
+        const float* outputData = reinterpret_cast<const float*>(output->BufferData());
+        if (output->componentType != MODEL_COMPONENT_TYPE_FLOAT || outputData == nullptr ||
+            timeLine.sampleTimes == nullptr || timeLine.sampleCount < 1) {
+            ALOGW("Animation '%s': channel without float keys, dropped", animation.name.c_str());
+            continue;
+        }
+
+        // Cubic spline keys are in-tangent, value, out-tangent
+        const int numKeys = timeLine.sampleCount;
+        const bool cubicSpline =
+            sampler->interpolation == MODEL_ANIMATION_INTERPOLATION_CUBICSPLINE;
+        const int elementsPerKey = cubicSpline ? 3 : 1;
+
+        ModelAnimationClipTrack track;
+        track.nodeIndex = channel.nodeIndex;
+        std::vector<ModelAnimationClipTrack>* tracks = nullptr;
+        if (channel.path == MODEL_ANIMATION_PATH_TRANSLATION) {
+            track.numComponents = 3;
+            tracks = &clip.translations;
+        } else if (channel.path == MODEL_ANIMATION_PATH_ROTATION) {
+            track.numComponents = 4;
+            tracks = &clip.rotations;
+        } else if (channel.path == MODEL_ANIMATION_PATH_SCALE) {
+            track.numComponents = 3;
+            tracks = &clip.scales;
+        } else if (channel.path == MODEL_ANIMATION_PATH_WEIGHTS) {
+            track.numComponents = output->count / (numKeys * elementsPerKey);
+            tracks = &clip.weights;
+            const size_t nodeWeights = modelFile.Nodes[channel.nodeIndex].weights.size();
+            if (static_cast<size_t>(track.numComponents) != nodeWeights) {
+                ALOGE(
+                    "Mismatch animation weights count, node:%zu, animation:%d, channel:%d, '%s'",
+                    nodeWeights,
+                    track.numComponents,
+                    channel.nodeIndex,
+                    animation.name.c_str());
+                continue;
+            }
+            if (channel.additiveWeightIndex >= track.numComponents) {
+                ALOGW("Animation '%s': bad additiveWeightIndex, dropped", animation.name.c_str());
+                continue;
+            }
+            track.additiveWeightIndex = channel.additiveWeightIndex;
+        } else {
+            ALOGW("Bad animation path on channel '%s'", animation.name.c_str());
+            continue;
+        }
+
+        const int available = output->count * AccessorComponentCount(output->type);
+        if (available < numKeys * elementsPerKey * track.numComponents) {
+            ALOGW("Animation '%s': channel with too few keys, dropped", animation.name.c_str());
+            continue;
+        }
+
+        if (sampler->interpolation == MODEL_ANIMATION_INTERPOLATION_STEP) {
+            track.interpolation = MODEL_ANIMATION_INTERPOLATION_STEP;
+        } else {
+            if (sampler->interpolation != MODEL_ANIMATION_INTERPOLATION_LINEAR) {
+                ALOGW(
+                    "Animation '%s': spline interpolation not implemented, treating as linear",
+                    animation.name.c_str());
+            }
+            track.interpolation = MODEL_ANIMATION_INTERPOLATION_LINEAR;
+        }
+
+        int& clipTimeLine = clipTimeLines[sampler->timeLineIndex];
+        if (clipTimeLine < 0) {
+            clipTimeLine = CompileClipTimeLine(timeLine, clip);
+        }
+        track.timeLineIndex = clipTimeLine;
+
+        track.firstValue = static_cast<int>(clip.values.size());
+        const int valueElement = cubicSpline ? 1 : 0;
+        for (int key = 0; key < numKeys; key++) {
+            const float* value =
+                outputData + (key * elementsPerKey + valueElement) * track.numComponents;
+            clip.values.insert(clip.values.end(), value, value + track.numComponents);
+        }
+        tracks->push_back(track);
+
+        if (std::find(clip.nodes.begin(), clip.nodes.end(), track.nodeIndex) == clip.nodes.end()) {
+            clip.nodes.push_back(track.nodeIndex);
+        }
+        clip.numNodes = std::max(clip.numNodes, track.nodeIndex + 1);
+    }
+}
+
+void CompileAnimationClips(ModelFile& modelFile) {
+    modelFile.AnimationClips.resize(modelFile.Animations.size());
+    for (int i = 0; i < static_cast<int>(modelFile.Animations.size()); i++) {
+        CompileAnimationClip(modelFile, modelFile.Animations[i], modelFile.AnimationClips[i]);
+    }
+}
+
+namespace {
+
+// The two keys around a time on one timeline
+struct ModelAnimationClipKeys {
+    int first;
+    int second;
+    float fraction;
+};
+
+} // namespace
+
+static ModelAnimationClipKeys FindClipKeys(
+    const ModelAnimationClip& clip,
+    const ModelAnimationClipTimeLine& timeLine,
+    const float timeInSeconds) {
+    // Same keys as ModelAnimationTimeLineState::CalculateFrameAndFraction
+    const float* times = clip.times.data() + timeLine.firstTime;
+    const int lastFrame = timeLine.sampleCount - 2;
+    ModelAnimationClipKeys keys;
+    if (lastFrame < 0 || timeInSeconds <= timeLine.startTime) {
+        keys.first = 0;
+        keys.fraction = 0.0f;
+    } else if (timeInSeconds >= timeLine.endTime) {
+        keys.first = lastFrame;
+        keys.fraction = 1.0f;
+    } else {
+        int frame;
+        if (timeLine.rcpStep != 0.0f) {
+            // Evenly spaced, off by at most one key where rounding differs
+            frame = static_cast<int>((timeInSeconds - timeLine.startTime) * timeLine.rcpStep);
+            frame = std::min(std::max(frame, 0), lastFrame);
+            if (frame > 0 && timeInSeconds < times[frame]) {
+                frame--;
+            } else if (frame < lastFrame && timeInSeconds >= times[frame + 1]) {
+                frame++;
+            }
+        } else {
+            frame = static_cast<int>(
+                        std::upper_bound(times, times + timeLine.sampleCount, timeInSeconds) -
+                        times) -
+                1;
+            frame = std::min(std::max(frame, 0), lastFrame);
+        }
+        keys.first = frame;
+        keys.fraction = (timeInSeconds - times[frame]) / (times[frame + 1] - times[frame]);
+    }
+    keys.second = std::min(keys.first + 1, timeLine.sampleCount - 1);
+    return keys;
+}
+
+static inline float SampleClipValue(
+    const float* first,
+    const float* second,
+    const int component,
+    const float fraction,
+    const ModelAnimationInterpolation interpolation) {
+    if (interpolation == MODEL_ANIMATION_INTERPOLATION_STEP) {
+        return fraction >= 1.0f ? second[component] : first[component];
+    }
+    return OVRMath_Lerp(first[component], second[component], fraction);
+}
+
+static Vector3f SampleClipVector3f(
+    const ModelAnimationClip& clip,
+    const ModelAnimationClipTrack& track,
+    const ModelAnimationClipKeys& keys) {
+    const float* first = clip.values.data() + track.firstValue + keys.first * 3;
+    const float* second = clip.values.data() + track.firstValue + keys.second * 3;
+    return Vector3f(
+        SampleClipValue(first, second, 0, keys.fraction, track.interpolation),
+        SampleClipValue(first, second, 1, keys.fraction, track.interpolation),
+        SampleClipValue(first, second, 2, keys.fraction, track.interpolation));
+}
+
+static Quatf SampleClipQuatf(
+    const ModelAnimationClip& clip,
+    const ModelAnimationClipTrack& track,
+    const ModelAnimationClipKeys& keys) {
+    const float* first = clip.values.data() + track.firstValue + keys.first * 4;
+    const float* second = clip.values.data() + track.firstValue + keys.second * 4;
+    const Quatf firstRotation(first[0], first[1], first[2], first[3]);
+    const Quatf secondRotation(second[0], second[1], second[2], second[3]);
+    if (track.interpolation == MODEL_ANIMATION_INTERPOLATION_STEP) {
+        return keys.fraction >= 1.0f ? secondRotation : firstRotation;
+    }
+    return firstRotation.Lerp(secondRotation, keys.fraction);
+}
+
+void SampleAnimationClip(
+    ModelState& modelState,
+    const ModelAnimationClip& clip,
+    const float timeInSeconds) {
+    if (clip.numNodes > static_cast<int>(modelState.nodeStates.size())) {
+        ALOGW("Animation clip '%s' does not match the model state", clip.name.c_str());
+        return;
+    }
+
+    // Per thread, so the keys of a frame are found without allocating once it has grown
+    static thread_local std::vector<ModelAnimationClipKeys> timeLineKeys;
+    timeLineKeys.resize(clip.timeLines.size());
+    for (int i = 0; i < static_cast<int>(clip.timeLines.size()); i++) {
+        timeLineKeys[i] = FindClipKeys(clip, clip.timeLines[i], timeInSeconds);
+    }
+
+    ModelNodeState* nodeStates = modelState.nodeStates.data();
+    for (const ModelAnimationClipTrack& track : clip.translations) {
+        nodeStates[track.nodeIndex].translation =
+            SampleClipVector3f(clip, track, timeLineKeys[track.timeLineIndex]);
+    }
+    for (const ModelAnimationClipTrack& track : clip.rotations) {
+        nodeStates[track.nodeIndex].rotation =
+            SampleClipQuatf(clip, track, timeLineKeys[track.timeLineIndex]);
+    }
+    for (const ModelAnimationClipTrack& track : clip.scales) {
+        nodeStates[track.nodeIndex].scale =
+            SampleClipVector3f(clip, track, timeLineKeys[track.timeLineIndex]);
+    }
+    for (const ModelAnimationClipTrack& track : clip.weights) {
+        std::vector<float>& weights = nodeStates[track.nodeIndex].weights;
+        if (static_cast<int>(weights.size()) != track.numComponents) {
+            continue;
+        }
+        const ModelAnimationClipKeys& keys = timeLineKeys[track.timeLineIndex];
+        const float* first =
+            clip.values.data() + track.firstValue + keys.first * track.numComponents;
+        const float* second =
+            clip.values.data() + track.firstValue + keys.second * track.numComponents;
+        if (track.additiveWeightIndex >= 0) {
+            weights[track.additiveWeightIndex] += SampleClipValue(
+                first, second, track.additiveWeightIndex, keys.fraction, track.interpolation);
+        } else {
+            for (int i = 0; i < track.numComponents; i++) {
+                weights[i] =
+                    SampleClipValue(first, second, i, keys.fraction, track.interpolation);
+            }
+        }
+    }
+
+    for (const int nodeIndex : clip.nodes) {
+        nodeStates[nodeIndex].CalculateLocalTransform();
+    }
+}
+
+//==============================================================
+// ModelAnimationBatch
+//==============================================================
+
+// States claimed at a time by each thread
+static const int BATCH_STATES_PER_CLAIM = 4;
+
+ModelAnimationBatch::~ModelAnimationBatch() {
+    StopWorkers();
+}
+
+void ModelAnimationBatch::SetNumWorkerThreads(const int numThreads) {
+    const int count = std::max(numThreads, 0);
+    if (count == static_cast<int>(Workers.size())) {
+        return;
+    }
+    StopWorkers();
+    ExitWorkers = false;
+    for (int i = 0; i < count; i++) {
+        // The generation is handed over here, a worker that read it once running could miss
+        // an Evaluate that started before it did
+        Workers.emplace_back(&ModelAnimationBatch::WorkerThread, this, Generation);
+    }
+}
+
+void ModelAnimationBatch::StopWorkers() {
+    {
+        std::lock_guard<std::mutex> lock(Mutex);
+        ExitWorkers = true;
+    }
+    WorkAvailable.notify_all();
+    for (std::thread& worker : Workers) {
+        worker.join();
+    }
+    Workers.clear();
+}
+
+void ModelAnimationBatch::Clear() {
+    Jobs.clear();
+    StateFirstJobs.clear();
+}
+
+void ModelAnimationBatch::Add(
+    ModelState& modelState,
+    const ModelAnimationClip& clip,
+    const float timeInSeconds) {
+    if (Jobs.empty() || Jobs.back().state != &modelState) {
+        StateFirstJobs.push_back(static_cast<int>(Jobs.size()));
+    }
+    ModelAnimationJob job;
+    job.state = &modelState;
+    job.clip = &clip;
+    job.timeInSeconds = timeInSeconds;
+    Jobs.push_back(job);
+}
+
+void ModelAnimationBatch::Evaluate() {
+    const int numStates = static_cast<int>(StateFirstJobs.size());
+    if (numStates == 0) {
+        return;
+    }
+    StateFirstJobs.push_back(static_cast<int>(Jobs.size()));
+    NextState.store(0);
+
+    if (Workers.empty() || numStates <= BATCH_STATES_PER_CLAIM) {
+        EvaluateStates();
+    } else {
+        {
+            std::lock_guard<std::mutex> lock(Mutex);
+            NumBusyWorkers = static_cast<int>(Workers.size());
+            Generation++;
+        }
+        WorkAvailable.notify_all();
+        EvaluateStates();
+        std::unique_lock<std::mutex> lock(Mutex);
+        WorkDone.wait(lock, [this] { return NumBusyWorkers == 0; });
+    }
+
+    StateFirstJobs.pop_back();
+}
+
+void ModelAnimationBatch::EvaluateStates() {
+    const int numStates = static_cast<int>(StateFirstJobs.size()) - 1;
+    for (;;) {
+        const int first = NextState.fetch_add(BATCH_STATES_PER_CLAIM);
+        if (first >= numStates) {
+            return;
+        }
+        const int last = std::min(first + BATCH_STATES_PER_CLAIM, numStates);
+        for (int state = first; state < last; state++) {
+            for (int i = StateFirstJobs[state]; i < StateFirstJobs[state + 1]; i++) {
+                const ModelAnimationJob& job = Jobs[i];
+                SampleAnimationClip(*job.state, *job.clip, job.timeInSeconds);
+            }
+            Jobs[StateFirstJobs[state]].state->UpdateGlobalTransforms();
+        }
+    }
+}
+
+void ModelAnimationBatch::WorkerThread(int generation) {
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(Mutex);
+            WorkAvailable.wait(
+                lock, [this, generation] { return ExitWorkers || Generation != generation; });
+            if (ExitWorkers) {
+                return;
+            }
+            generation = Generation;
+        }
+        EvaluateStates();
+        std::lock_guard<std::mutex> lock(Mutex);
+        if (--NumBusyWorkers == 0) {
+            WorkDone.notify_one();
+        }
+    }
+}
+
 } // namespace OVRFW
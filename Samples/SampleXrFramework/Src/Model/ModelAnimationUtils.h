@@ -27,10 +27,81 @@ Authors     :   Peter Chan
 
 #pragma once
 
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
 #include "ModelDef.h"
 
 namespace OVRFW {
 
+// Samples the channels of an animation straight from the accessors, at the frame and fraction
+// in modelState.animationTimelineStates. Prefer the compiled clips below.
 void ApplyAnimation(ModelState& modelState, int animationIndex);
 
+// Bakes animation into clip. Channels that cannot be sampled (unknown path, accessors that are
+// not float or too short, weights that do not match the node) are dropped with a warning here
+// instead of every frame. Cubic spline keys keep only their values and, like catmull-rom, are
+// sampled linearly, as ApplyAnimation does.
+void CompileAnimationClip(
+    const ModelFile& modelFile,
+    const ModelAnimation& animation,
+    ModelAnimationClip& clip);
+// Fills modelFile.AnimationClips from modelFile.Animations
+void CompileAnimationClips(ModelFile& modelFile);
+
+// Sets the animated translation, rotation, scale and weights of the nodes of clip at
+// timeInSeconds (not wrapped, see ModelState::GetAnimationTime) and recalculates their local
+// transforms, marking them dirty. Global transforms are left to the caller
+// (ModelState::UpdateGlobalTransforms). Does not allocate.
+void SampleAnimationClip(
+    ModelState& modelState,
+    const ModelAnimationClip& clip,
+    const float timeInSeconds);
+
+// Samples clips into many model states in one pass, for crowds of animated models. The clips
+// added for a frame are sampled in order, then the global transforms of each state are
+// recalculated once. Whole states are spread over the worker threads, so the clips of one
+// state must be added one after the other. The job list keeps its capacity across Clear.
+class ModelAnimationBatch {
+   public:
+    ModelAnimationBatch() = default;
+    ~ModelAnimationBatch();
+
+    // Threads besides the one calling Evaluate, 0 (the default) evaluates on the caller only
+    void SetNumWorkerThreads(const int numThreads);
+    int GetNumWorkerThreads() const {
+        return static_cast<int>(Workers.size());
+    }
+
+    void Clear();
+    void Add(ModelState& modelState, const ModelAnimationClip& clip, const float timeInSeconds);
+    void Evaluate();
+
+   private:
+    struct ModelAnimationJob {
+        ModelState* state;
+        const ModelAnimationClip* clip;
+        float timeInSeconds;
+    };
+
+    void EvaluateStates();
+    void WorkerThread(int generation);
+    void StopWorkers();
+
+    std::vector<ModelAnimationJob> Jobs;
+    std::vector<int> StateFirstJobs; // first job of each state, then Jobs.size() while evaluating
+    std::atomic<int> NextState{0};
+
+    std::vector<std::thread> Workers;
+    std::mutex Mutex;
+    std::condition_variable WorkAvailable;
+    std::condition_variable WorkDone;
+    int Generation = 0;
+    int NumBusyWorkers = 0;
+    bool ExitWorkers = false;
+};
+
 } // namespace OVRFW
@@ -402,6 +402,56 @@ struct ModelAnimation {
     std::vector<ModelAnimationChannel> channels;
 };
 
+// Key times of one timeline of a compiled clip.
+struct ModelAnimationClipTimeLine {
+    ModelAnimationClipTimeLine()
+        : startTime(0.0f), endTime(0.0f), rcpStep(0.0f), firstTime(0), sampleCount(0) {}
+
+    float startTime; // in seconds
+    float endTime; // in seconds
+    float rcpStep; // 1 / key spacing if the keys are evenly spaced, else 0
+    int firstTime; // into ModelAnimationClip::times
+    int sampleCount;
+};
+
+// One channel of a compiled clip.
+struct ModelAnimationClipTrack {
+    ModelAnimationClipTrack()
+        : nodeIndex(-1),
+          timeLineIndex(-1),
+          firstValue(0),
+          numComponents(0),
+          additiveWeightIndex(-1),
+          interpolation(MODEL_ANIMATION_INTERPOLATION_LINEAR) {}
+
+    int nodeIndex;
+    int timeLineIndex; // into ModelAnimationClip::timeLines
+    int firstValue; // into ModelAnimationClip::values, numComponents floats per key
+    int numComponents; // 3, 4, or the number of morph weights
+    int additiveWeightIndex; // weights only
+    ModelAnimationInterpolation interpolation; // linear or step
+};
+
+// A ModelAnimation baked by CompileAnimationClip (ModelAnimationUtils.h) for sampling every
+// frame: node indices and timelines resolved, key times and values copied out of the accessors
+// into two float arrays, and the tracks split by path so the sampler does not switch on it.
+struct ModelAnimationClip {
+    ModelAnimationClip() : startTime(0.0f), endTime(0.0f), numNodes(0) {}
+
+    std::string name;
+    float startTime; // in seconds
+    float endTime; // in seconds
+    int numNodes; // one more than the highest node index used
+    std::vector<ModelAnimationClipTimeLine> timeLines;
+    std::vector<float> times;
+    std::vector<float> values;
+    std::vector<ModelAnimationClipTrack> translations;
+    std::vector<ModelAnimationClipTrack> rotations;
+    std::vector<ModelAnimationClipTrack> scales;
+    std::vector<ModelAnimationClipTrack> weights;
+    std::vector<int> nodes; // every node with a track, once
+};
+
 struct ModelSkin {
     ModelSkin() : inverseBindMatricesAccessor(nullptr) {}
 
@@ -420,6 +470,14 @@ struct ModelSubScene {
     bool visible;
 };
 
+// localTransform = translation * rotation * scale
+void CalculateTransformFromRTS(
+    OVR::Matrix4f* localTransform,
+    const OVR::Quatf rotation,
+    const OVR::Vector3f translation,
+    const OVR::Vector3f scale);
+
+// The matrices live in the flattened hierarchy of the owning ModelState
 class ModelNodeState {
    public:
     ModelNodeState()
@@ -428,22 +486,22 @@ class ModelNodeState {
           rotation(0.0f, 0.0f, 0.0f, 1.0f),
           translation(0.0f, 0.0f, 0.0f),
           scale(1.0f, 1.0f, 1.0f),
-          localTransform(OVR::Matrix4f::Identity()),
-          globalTransform(OVR::Matrix4f::Identity()) {}
+          transformIndex(-1) {}
 
     void GenerateStateFromNode(const ModelNode* _node, ModelState* _modelState);
+    // Both mark the node dirty for the next ModelState::UpdateGlobalTransforms
     void CalculateLocalTransform();
     void SetLocalTransform(const OVR::Matrix4f matrix);
-    OVR::Matrix4f GetLocalTransform() const {
-        return localTransform;
-    }
-    OVR::Matrix4f GetGlobalTransform() const {
-        return globalTransform;
-    }
+    inline const OVR::Matrix4f& GetLocalTransform() const;
+    inline const OVR::Matrix4f& GetGlobalTransform() const;
+    // Recalculates this node and its subtree right away
     void RecalculateMatrix();
     const ModelNode* GetNode() const {
         return node;
     }
+    int GetTransformIndex() const {
+        return transformIndex;
+    }
 
     void AddNodesToEmitList(std::vector<ModelNodeState*>& emitList);
 
@@ -455,8 +513,9 @@ class ModelNodeState {
     std::vector<float> weights;
 
    private:
-    OVR::Matrix4f localTransform;
-    OVR::Matrix4f globalTransform;
+    friend class ModelState;
+
+    int transformIndex; // position in ModelState::transformNodes
 };
 
 enum ModelAnimationTimeType {
@@ -500,20 +559,54 @@ class ModelState {
         return modelMatrix;
     }
 
+    // timeInSeconds wrapped or clamped to the animation range of the model file
+    float GetAnimationTime(const ModelAnimationTimeType type, float timeInSeconds) const;
     void CalculateAnimationFrameAndFraction(const ModelAnimationTimeType type, float timeInSeconds);
 
+    // The next UpdateGlobalTransforms recalculates this node and everything below it
+    void MarkTransformDirty(const int transformIndex);
+    // Recalculates the global transforms of the dirty nodes and their subtrees, clean subtrees
+    // are not visited
+    void UpdateGlobalTransforms();
+    int GetNumDirtyTransforms() const {
+        return static_cast<int>(dirtyTransforms.size());
+    }
+
     long long DontRenderForClientUid; // skip rendering the model if the current scene's client uid
                                       // matches this
     std::vector<ModelNodeState> nodeStates;
     std::vector<ModelAnimationTimeLineState> animationTimelineStates;
     std::vector<ModelSubSceneState> subSceneStates;
 
+    // Flattened node hierarchy in depth first order, so parents come before their children and
+    // every subtree is the contiguous range [i, transformSubtreeEnds[i]). All indexed by
+    // transform index, see ModelNodeState::GetTransformIndex.
+    std::vector<int> transformNodes; // index into nodeStates
+    std::vector<int> transformParents; // transform index of the parent, -1 for roots
+    std::vector<int> transformSubtreeEnds;
+    std::vector<OVR::Matrix4f> localTransforms;
+    std::vector<OVR::Matrix4f> globalTransforms;
+
     const ModelFile* mf;
 
    private:
+    friend class ModelNodeState;
+
+    void RecalculateTransforms(const int first, const int end);
+
     OVR::Matrix4f modelMatrix;
+    std::vector<uint8_t> transformDirty;
+    std::vector<int> dirtyTransforms; // each dirty node once, in the order they were marked
 };
 
+inline const OVR::Matrix4f& ModelNodeState::GetLocalTransform() const {
+    return state->localTransforms[transformIndex];
+}
+
+inline const OVR::Matrix4f& ModelNodeState::GetGlobalTransform() const {
+    return state->globalTransforms[transformIndex];
+}
+
 struct ModelGlPrograms {
     ModelGlPrograms()
         : ProgVertexColor(nullptr),
@@ -48,9 +48,6 @@ namespace OVRFW {
 //	ModelFile
 //-----------------------------------------------------------------------------
 
-ModelFile::ModelFile()
-    : UsingSrgbTextures(false), animationStartTime(0.0f), animationEndTime(0.0f) {}
-
 ModelFile::~ModelFile() {
     ALOG("Destroying ModelFileModel %s", FileName.c_str());
 
@@ -128,16 +125,6 @@ Bounds3f ModelFile::GetBounds() const {
     return modelBounds;
 }
 
-void CalculateTransformFromRTS(
-    Matrix4f* localTransform,
-    const Quatf rotation,
-    const Vector3f translation,
-    const Vector3f scale) {
-    Matrix4f::Multiply(localTransform, Matrix4f(rotation), Matrix4f::Scaling(scale));
-    Matrix4f::Multiply(
-        localTransform, Matrix4f::Translation(translation), Matrix4f(*localTransform));
-}
-
 //-----------------------------------------------------------------------------
 //	Model Loading
 //-----------------------------------------------------------------------------
@@ -508,188 +495,4 @@ ModelFile* LoadModelFile(
     return scene;
 }
 
-uint8_t* ModelAccessor::BufferData() const {
-    if (bufferView == nullptr || bufferView->buffer == nullptr ||
-        bufferView->buffer->bufferData.empty()) {
-        return nullptr;
-    }
-    return (uint8_t*)bufferView->buffer->bufferData.data() + bufferView->byteOffset + byteOffset;
-}
-
-void ModelNode::SetLocalTransform(const Matrix4f matrix) {
-    localTransform = matrix;
-}
-
-void ModelNode::RecalculateGlobalTransform(ModelFile& modelFile) {
-    if (parentIndex < 0) {
-        globalTransform = localTransform;
-    } else {
-        globalTransform = modelFile.Nodes[parentIndex].GetGlobalTransform() * localTransform;
-    }
-
-    for (int i = 0; i < static_cast<int>(children.size()); i++) {
-        modelFile.Nodes[children[i]].RecalculateGlobalTransform(modelFile);
-    }
-}
-
-void ModelAnimationTimeLine::Initialize(const ModelAccessor* _accessor) {
-    accessor = _accessor;
-    sampleCount = accessor->count;
-    sampleTimes = (float*)(accessor->BufferData());
-    startTime = sampleTimes[0];
-    endTime = sampleTimes[sampleCount - 1];
-    float duration = endTime - startTime;
-    const float step = duration / sampleCount;
-    rcpStep = 1.0f / step;
-    for (int keyFrameIndex = 0; keyFrameIndex < sampleCount; keyFrameIndex++) {
-        const float delta =
-            sampleTimes[keyFrameIndex] - (((float)keyFrameIndex) * step + startTime);
-        // Check if the time is more than 0.1 milliseconds from a fixed-rate time-line.
-        if (fabs(delta) > 1e-4f) {
-            rcpStep = 0.0f;
-            break;
-        }
-    }
-}
-
-void ModelAnimationTimeLineState::CalculateFrameAndFraction(float timeInSeconds) {
-    if (timeInSeconds <= timeline->startTime) {
-        frame = 0;
-        fraction = 0.0f;
-    } else if (timeInSeconds >= timeline->endTime) {
-        frame = timeline->sampleCount - 2;
-        fraction = 1.0f;
-    } else {
-        if (timeline->rcpStep != 0.0f) {
-            // Use direct lookup if this is a fixed rate animation.
-            frame = (int)((timeInSeconds - timeline->startTime) * timeline->rcpStep);
-        } else {
-            // Use a binary search to find the key frame.
-            frame = 0;
-            // Use a binary search to find the key frame.
-            for (int sampleCount = timeline->sampleCount; sampleCount > 1; sampleCount >>= 1) {
-                const int mid = sampleCount >> 1;
-                if (timeInSeconds >= timeline->sampleTimes[frame + mid]) {
-                    frame += mid;
-                    sampleCount = (sampleCount - mid) * 2;
-                }
-            }
-        }
-
-        fraction = (timeInSeconds - timeline->sampleTimes[frame]) /
-            (timeline->sampleTimes[frame + 1] - timeline->sampleTimes[frame]);
-    }
-}
-
-void ModelState::CalculateAnimationFrameAndFraction(
-    const ModelAnimationTimeType type,
-    float timeInSeconds) {
-    // float prevTime = timeInSeconds;
-    switch (type) {
-        case MODEL_ANIMATION_TIME_TYPE_ONCE_FORWARD: {
-            if (timeInSeconds > mf->animationEndTime) {
-                timeInSeconds = mf->animationEndTime;
-            }
-        } break;
-        case MODEL_ANIMATION_TIME_TYPE_LOOP_FORWARD: {
-            timeInSeconds = fmodf(timeInSeconds, mf->animationEndTime);
-        } break;
-        case MODEL_ANIMATION_TIME_TYPE_LOOP_FORWARD_AND_BACK: {
-            const float tempDur = mf->animationEndTime * 2.0f;
-            timeInSeconds = fmodf(timeInSeconds, tempDur);
-
-            if (timeInSeconds > mf->animationEndTime) {
-                timeInSeconds = timeInSeconds - mf->animationEndTime;
-                timeInSeconds = mf->animationEndTime - timeInSeconds;
-            }
-        } break;
-    }
-
-    for (int i = 0; i < static_cast<int>(animationTimelineStates.size()); i++) {
-        animationTimelineStates[i].CalculateFrameAndFraction(timeInSeconds);
-    }
-}
-
-void ModelNodeState::GenerateStateFromNode(const ModelNode* _node, ModelState* _modelState) {
-    node = _node;
-    state = _modelState;
-    rotation = node->rotation;
-    translation = node->translation;
-    scale = node->scale;
-    weights = node->weights;
-
-    // These values should be calculated already.
-    localTransform = node->GetLocalTransform();
-    globalTransform = node->GetGlobalTransform();
-}
-
-void ModelNodeState::CalculateLocalTransform() {
-    CalculateTransformFromRTS(&localTransform, rotation, translation, scale);
-}
-
-void ModelNodeState::SetLocalTransform(const Matrix4f matrix) {
-    localTransform = matrix;
-}
-
-void ModelNodeState::RecalculateMatrix() {
-    if (node->parentIndex < 0) {
-        globalTransform = state->GetMatrix() * localTransform;
-    } else {
-        globalTransform = state->nodeStates[node->parentIndex].globalTransform * localTransform;
-    }
-
-    for (int i = 0; i < static_cast<int>(node->children.size()); i++) {
-        state->nodeStates[node->children[i]].RecalculateMatrix();
-    }
-}
-
-void ModelNodeState::AddNodesToEmitList(std::vector<ModelNodeState*>& emitList) {
-    emitList.push_back(this);
-    for (int i = 0; i < static_cast<int>(node->children.size()); i++) {
-        state->nodeStates[node->children[i]].AddNodesToEmitList(emitList);
-    }
-}
-
-void ModelSubSceneState::GenerateStateFromSubScene(const ModelSubScene* _subScene) {
-    subScene = _subScene;
-    visible = subScene->visible;
-
-    nodeStates.resize(subScene->nodes.size());
-    for (int i = 0; i < static_cast<int>(subScene->nodes.size()); i++) {
-        nodeStates[i] = subScene->nodes[i];
-    }
-}
-
-void ModelState::GenerateStateFromModelFile(const ModelFile* _mf) {
-    subSceneStates.clear();
-    modelMatrix = Matrix4f::Identity();
-
-    mf = _mf;
-    DontRenderForClientUid = 0;
-
-    nodeStates.resize(mf->Nodes.size());
-    for (int i = 0; i < static_cast<int>(mf->Nodes.size()); i++) {
-        nodeStates[i].GenerateStateFromNode(&mf->Nodes[i], this);
-    }
-
-    animationTimelineStates.resize(mf->AnimationTimeLines.size());
-    for (int i = 0; i < static_cast<int>(mf->AnimationTimeLines.size()); i++) {
-        animationTimelineStates[i].timeline = &mf->AnimationTimeLines[i];
-    }
-
-    subSceneStates.resize(mf->SubScenes.size());
-    for (int i = 0; i < static_cast<int>(mf->SubScenes.size()); i++) {
-        subSceneStates[i].GenerateStateFromSubScene(&mf->SubScenes[i]);
-    }
-}
-
-void ModelState::SetMatrix(const Matrix4f matrix) {
-    modelMatrix = matrix;
-    for (int i = 0; i < static_cast<int>(subSceneStates.size()); i++) {
-        for (int j = 0; j < static_cast<int>(subSceneStates[i].nodeStates.size()); j++) {
-            nodeStates[subSceneStates[i].nodeStates[j]].RecalculateMatrix();
-        }
-    }
-}
-
 } // namespace OVRFW
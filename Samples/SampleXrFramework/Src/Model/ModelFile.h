@@ -37,7 +37,7 @@ namespace OVRFW {
 // and modify a model for a particular task, such as changing materials.
 class ModelFile {
    public:
-    ModelFile();
+    ModelFile() : UsingSrgbTextures(false), animationStartTime(0.0f), animationEndTime(0.0f) {}
     ModelFile(const char* name) : FileName(name) {}
     ~ModelFile(); // Frees all textures and geometry
 
@@ -78,6 +78,7 @@ class ModelFile {
     std::vector<ModelNode> Nodes;
     std::vector<ModelAnimation> Animations;
     std::vector<ModelAnimationTimeLine> AnimationTimeLines;
+    std::vector<ModelAnimationClip> AnimationClips; // Animations compiled at load time
     std::vector<ModelSkin> Skins;
     std::vector<ModelSubScene> SubScenes;
 };
@@ -41,12 +41,6 @@ Authors     :   John Carmack, J.M.P. van Waveren
 
 namespace OVRFW {
 
-void CalculateTransformFromRTS(
-    OVR::Matrix4f* localTransform,
-    const OVR::Quatf rotation,
-    const OVR::Vector3f translation,
-    const OVR::Vector3f scale);
-
 void LoadModelFileTexture(
     ModelFile& model,
     const char* textureName,
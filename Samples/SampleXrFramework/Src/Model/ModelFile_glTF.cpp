@@ -26,6 +26,7 @@ Authors     :   John Carmack, J.M.P. van Waveren
 *************************************************************************************/
 
 #include "Model/ModelDef.h"
+#include "ModelAnimationUtils.h"
 #include "ModelFileLoading.h"
 
 #include "OVR_Std.h"
@@ -1950,6 +1951,7 @@ bool LoadModelFile_glTF_Json(
                         }
                     }
                 }
+                CompileAnimationClips(modelFile);
             } // END ANIMATION TIMELINES
 
             if (loaded) { // SKINS
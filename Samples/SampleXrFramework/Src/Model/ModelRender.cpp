@@ -32,6 +32,8 @@ Authors     :   John Carmack
 
 #include "Misc/Log.h"
 #include "Render/Egl.h"
+#include "Render/FrustumCuller.h"
+#include "Render/RenderQueue.h"
 
 using OVR::Bounds3f;
 using OVR::Matrix4f;
@@ -41,134 +43,42 @@ using OVR::Vector4f;
 
 namespace OVRFW {
 
-// Returns 0 if the bounds is culled by the mvp, otherwise returns the max W
-// value of the bounds corners so it can be sorted into roughly front to back
-// order for more efficient Z cull.  Sorting bounds in increasing order of
-// their farthest W value usually makes characters and objects draw before
-// the environments they are in, and draws sky boxes last, which is what we want.
-static float BoundsSortCullKey(const Bounds3f& bounds, const Matrix4f& mvp) {
-    // Always cull empty bounds, which can be used to disable a surface.
-    // Don't just check a single axis, or billboards would be culled.
-    if (bounds.b[1].x == bounds.b[0].x && bounds.b[1].y == bounds.b[0].y) {
-        return 0;
-    }
-
-    // Not very efficient code...
-    Vector4f c[8];
-    for (int i = 0; i < 8; i++) {
-        Vector4f world;
-        world.x = bounds.b[(i & 1)].x;
-        world.y = bounds.b[(i & 2) >> 1].y;
-        world.z = bounds.b[(i & 4) >> 2].z;
-        world.w = 1.0f;
-
-        c[i] = mvp.Transform(world);
-    }
-
-    int i;
-    for (i = 0; i < 8; i++) {
-        if (c[i].x > -c[i].w) {
-            break;
-        }
-    }
-    if (i == 8) {
-        return 0; // all off one side
-    }
-    for (i = 0; i < 8; i++) {
-        if (c[i].x < c[i].w) {
-            break;
-        }
-    }
-    if (i == 8) {
-        return 0; // all off one side
-    }
-
-    for (i = 0; i < 8; i++) {
-        if (c[i].y > -c[i].w) {
-            break;
-        }
-    }
-    if (i == 8) {
-        return 0; // all off one side
-    }
-    for (i = 0; i < 8; i++) {
-        if (c[i].y < c[i].w) {
-            break;
-        }
-    }
-    if (i == 8) {
-        return 0; // all off one side
-    }
-
-    for (i = 0; i < 8; i++) {
-        if (c[i].z > -c[i].w) {
-            break;
-        }
-    }
-    if (i == 8) {
-        return 0; // all off one side
-    }
-    for (i = 0; i < 8; i++) {
-        if (c[i].z < c[i].w) {
-            break;
-        }
-    }
-    if (i == 8) {
-        return 0; // all off one side
-    }
-
-    // calculate the farthest W point for front to back sorting
-    float maxW = 0;
-    for (i = 0; i < 8; i++) {
-        const float w = c[i].w;
-        if (w > maxW) {
-            maxW = w;
-        }
-    }
-
-    return maxW; // couldn't cull
-}
-
-struct bsort_t {
-    float key;
-    Matrix4f modelMatrix;
-    const std::vector<Matrix4f>* joints;
-    const ovrSurfaceDef* surface;
-    bool transparent;
-
-    bool operator<(const bsort_t& b2) const {
-        const bsort_t& b1 = *this;
-        bool trans1 = b1.transparent;
-        bool trans2 = b2.transparent;
-        if (trans1 == trans2) {
-            float f1 = b1.key;
-            float f2 = b2.key;
-            if (!trans1) {
-                // both are solid, sort front-to-back
-                return (f1 < f2);
-            } else {
-                // both are transparent, sort back-to-front
-                return (f2 < f1);
-            }
-        }
-        // otherwise, one is solid and one is translucent... the solid is always rendered first
-        return !trans1;
-    };
-};
-
 void BuildModelSurfaceList(
     std::vector<ovrDrawSurface>& surfaceList,
     const std::vector<ModelNodeState*>& emitNodes,
     const std::vector<ovrDrawSurface>& emitSurfaces,
     const Matrix4f& viewMatrix,
     const Matrix4f& projectionMatrix) {
-    // A mobile GPU will be in trouble if it draws more than this.
-    static const int MAX_DRAW_SURFACES = 1024;
-    bsort_t bsort[MAX_DRAW_SURFACES];
-
     const Matrix4f vpMatrix = projectionMatrix * viewMatrix;
 
-    int numSurfaces = 0;
+    // Cull every candidate surface in one batch, in the same order the loops below visit them.
+    // The key is 0 for a culled bounds, otherwise the max W value of the bounds, so surfaces can be
+    // sorted into roughly front to back order for more efficient Z cull.  Sorting bounds in
+    // increasing order of their farthest W value usually makes characters and objects draw
+    // before the environments they are in, and draws sky boxes last, which is what we want.
+    static thread_local ovrFrustumCuller culler;
+    culler.Clear();
+    // At least one bounds per node; nodes with several surfaces grow it once, then the
+    // capacity is kept across frames
+    culler.Reserve(static_cast<int>(emitNodes.size() + emitSurfaces.size()));
+    for (const ModelNodeState* nodeState : emitNodes) {
+        if (nodeState->GetNode() != NULL && nodeState->GetNode()->model != NULL) {
+            const Matrix4f modelMatrix = nodeState->GetGlobalTransform();
+            for (const ModelSurface& surface : nodeState->GetNode()->model->surfaces) {
+                culler.Add(surface.surfaceDef.geo.localBounds, modelMatrix);
+            }
+        }
+    }
+    for (const ovrDrawSurface& drawSurf : emitSurfaces) {
+        culler.Add(drawSurf.surface->geo.localBounds, drawSurf.modelMatrix);
+    }
+    const int numVisible = culler.Cull(vpMatrix);
+
+    // Sorted by layer, transparency, depth and GPU state, see ovrRenderQueue
+    static thread_local ovrRenderQueue queue;
+    queue.Clear();
+    queue.Reserve(numVisible, static_cast<int>(emitNodes.size() + emitSurfaces.size()));
+    int firstCullIndex = 0;
 
     for (int nodeNum = 0; nodeNum < static_cast<int>(emitNodes.size()); nodeNum++) {
         const ModelNodeState& nodeState = *emitNodes[nodeNum];
@@ -182,11 +92,13 @@ void BuildModelSurfaceList(
 
             if (nodeState.GetNode()->model != nullptr) {
                 const Model& modelDef = *nodeState.GetNode()->model;
+                const int nodeCullIndex = firstCullIndex;
+                firstCullIndex += static_cast<int>(modelDef.surfaces.size());
+                int transformIndex = -1;
                 for (int surfaceNum = 0; surfaceNum < static_cast<int>(modelDef.surfaces.size());
                      surfaceNum++) {
                     const ovrSurfaceDef& surfaceDef = modelDef.surfaces[surfaceNum].surfaceDef;
-                    const float sort = BoundsSortCullKey(
-                        surfaceDef.geo.localBounds, vpMatrix * nodeState.GetGlobalTransform());
+                    const float sort = culler.GetSortKey(nodeCullIndex + surfaceNum);
                     if (sort == 0) {
                         if (allowCulling) {
                             if (LogRenderSurfaces) {
@@ -200,10 +112,6 @@ void BuildModelSurfaceList(
                         }
                     }
 
-                    if (numSurfaces == MAX_DRAW_SURFACES) {
-                        break;
-                    }
-
                     /*
                                         // Update the Joint Uniform Buffer
                                         if ( nodeState.node->skinIndex >= 0 )
@@ -260,13 +168,11 @@ void BuildModelSurfaceList(
                                         }
                     */
 
-                    bsort[numSurfaces].key = sort;
-                    bsort[numSurfaces].modelMatrix = nodeState.GetGlobalTransform();
-                    bsort[numSurfaces].surface = &surfaceDef;
-                    bsort[numSurfaces].transparent =
-                        (surfaceDef.graphicsCommand.GpuState.blendEnable !=
-                         ovrGpuState::BLEND_DISABLE);
-                    numSurfaces++;
+                    // All the surfaces of a node share its transform
+                    if (transformIndex < 0) {
+                        transformIndex = queue.AddTransform(nodeState.GetGlobalTransform());
+                    }
+                    queue.Add(&surfaceDef, transformIndex, sort);
                 }
             }
         }
@@ -275,8 +181,7 @@ void BuildModelSurfaceList(
     for (int i = 0; i < static_cast<int>(emitSurfaces.size()); i++) {
         const ovrDrawSurface& drawSurf = emitSurfaces[i];
         const ovrSurfaceDef& surfaceDef = *drawSurf.surface;
-        const float sort =
-            BoundsSortCullKey(surfaceDef.geo.localBounds, vpMatrix * drawSurf.modelMatrix);
+        const float sort = culler.GetSortKey(firstCullIndex + i);
         if (sort == 0) {
             if (LogRenderSurfaces) {
                 ALOG("Culled %s", surfaceDef.surfaceName.c_str());
@@ -284,31 +189,16 @@ void BuildModelSurfaceList(
             continue;
         }
 
-        if (numSurfaces == MAX_DRAW_SURFACES) {
-            break;
-        }
-
-        bsort[numSurfaces].key = sort;
-        bsort[numSurfaces].modelMatrix = drawSurf.modelMatrix;
-        bsort[numSurfaces].surface = &surfaceDef;
-        bsort[numSurfaces].transparent =
-            (surfaceDef.graphicsCommand.GpuState.blendEnable != ovrGpuState::BLEND_DISABLE);
-        numSurfaces++;
+        queue.Add(&surfaceDef, queue.AddTransform(drawSurf.modelMatrix), sort);
     }
 
-    // sort by the far W and transparency
-    // IMPORTANT: use a stable sort so surfaces with identical bounds
-    // will sort consistently from frame to frame, rather than randomly
-    // as happens with qsort.
-    std::stable_sort(bsort, bsort + numSurfaces);
+    // IMPORTANT: the sort is stable, so surfaces with identical keys
+    // will sort consistently from frame to frame.
+    queue.Sort();
 
     // ----TODO_DRAWEYEVIEW : don't overwrite surfaces which may have already been added to the
     // surfaceList.
-    surfaceList.resize(numSurfaces);
-    for (int i = 0; i < numSurfaces; i++) {
-        surfaceList[i].modelMatrix = bsort[i].modelMatrix;
-        surfaceList[i].surface = bsort[i].surface;
-    }
+    queue.GetSurfaceList(surfaceList);
 }
 
 } // namespace OVRFW
@@ -0,0 +1,331 @@
+/************************************************************************************
+
+Filename    :   ModelState.cpp
+Content     :   Runtime state of a loaded model: node transforms and animation timelines.
+Language    :   C++
+
+*************************************************************************************/
+
+#include "ModelFile.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <utility>
+
+using OVR::Matrix4f;
+using OVR::Quatf;
+using OVR::Vector3f;
+
+namespace OVRFW {
+
+void CalculateTransformFromRTS(
+    Matrix4f* localTransform,
+    const Quatf rotation,
+    const Vector3f translation,
+    const Vector3f scale) {
+    // translation * rotation * scale written out, the two 4x4 multiplies only added zeros
+    const Matrix4f r(rotation);
+    Matrix4f& m = *localTransform;
+    for (int i = 0; i < 3; i++) {
+        m.M[i][0] = r.M[i][0] * scale.x;
+        m.M[i][1] = r.M[i][1] * scale.y;
+        m.M[i][2] = r.M[i][2] * scale.z;
+        m.M[i][3] = translation[i];
+    }
+    m.M[3][0] = 0.0f;
+    m.M[3][1] = 0.0f;
+    m.M[3][2] = 0.0f;
+    m.M[3][3] = 1.0f;
+}
+
+uint8_t* ModelAccessor::BufferData() const {
+    if (bufferView == nullptr || bufferView->buffer == nullptr ||
+        bufferView->buffer->bufferData.empty()) {
+        return nullptr;
+    }
+    return (uint8_t*)bufferView->buffer->bufferData.data() + bufferView->byteOffset + byteOffset;
+}
+
+void ModelNode::SetLocalTransform(const Matrix4f matrix) {
+    localTransform = matrix;
+}
+
+void ModelNode::RecalculateGlobalTransform(ModelFile& modelFile) {
+    if (parentIndex < 0) {
+        globalTransform = localTransform;
+    } else {
+        globalTransform = modelFile.Nodes[parentIndex].GetGlobalTransform() * localTransform;
+    }
+
+    for (int i = 0; i < static_cast<int>(children.size()); i++) {
+        modelFile.Nodes[children[i]].RecalculateGlobalTransform(modelFile);
+    }
+}
+
+void ModelAnimationTimeLine::Initialize(const ModelAccessor* _accessor) {
+    accessor = _accessor;
+    sampleCount = accessor->count;
+    sampleTimes = (float*)(accessor->BufferData());
+    startTime = sampleTimes[0];
+    endTime = sampleTimes[sampleCount - 1];
+    float duration = endTime - startTime;
+    const float step = duration / sampleCount;
+    rcpStep = 1.0f / step;
+    for (int keyFrameIndex = 0; keyFrameIndex < sampleCount; keyFrameIndex++) {
+        const float delta =
+            sampleTimes[keyFrameIndex] - (((float)keyFrameIndex) * step + startTime);
+        // Check if the time is more than 0.1 milliseconds from a fixed-rate time-line.
+        if (fabs(delta) > 1e-4f) {
+            rcpStep = 0.0f;
+            break;
+        }
+    }
+}
+
+void ModelAnimationTimeLineState::CalculateFrameAndFraction(float timeInSeconds) {
+    if (timeInSeconds <= timeline->startTime) {
+        frame = 0;
+        fraction = 0.0f;
+    } else if (timeInSeconds >= timeline->endTime) {
+        frame = timeline->sampleCount - 2;
+        fraction = 1.0f;
+    } else {
+        if (timeline->rcpStep != 0.0f) {
+            // Use direct lookup if this is a fixed rate animation.
+            frame = (int)((timeInSeconds - timeline->startTime) * timeline->rcpStep);
+        } else {
+            // Use a binary search to find the key frame.
+            frame = 0;
+            // Use a binary search to find the key frame.
+            for (int sampleCount = timeline->sampleCount; sampleCount > 1; sampleCount >>= 1) {
+                const int mid = sampleCount >> 1;
+                if (timeInSeconds >= timeline->sampleTimes[frame + mid]) {
+                    frame += mid;
+                    sampleCount = (sampleCount - mid) * 2;
+                }
+            }
+        }
+
+        fraction = (timeInSeconds - timeline->sampleTimes[frame]) /
+            (timeline->sampleTimes[frame + 1] - timeline->sampleTimes[frame]);
+    }
+}
+
+float ModelState::GetAnimationTime(const ModelAnimationTimeType type, float timeInSeconds)
+    const {
+    switch (type) {
+        case MODEL_ANIMATION_TIME_TYPE_ONCE_FORWARD: {
+            if (timeInSeconds > mf->animationEndTime) {
+                timeInSeconds = mf->animationEndTime;
+            }
+        } break;
+        case MODEL_ANIMATION_TIME_TYPE_LOOP_FORWARD: {
+            timeInSeconds = fmodf(timeInSeconds, mf->animationEndTime);
+        } break;
+        case MODEL_ANIMATION_TIME_TYPE_LOOP_FORWARD_AND_BACK: {
+            const float tempDur = mf->animationEndTime * 2.0f;
+            timeInSeconds = fmodf(timeInSeconds, tempDur);
+
+            if (timeInSeconds > mf->animationEndTime) {
+                timeInSeconds = timeInSeconds - mf->animationEndTime;
+                timeInSeconds = mf->animationEndTime - timeInSeconds;
+            }
+        } break;
+    }
+    return timeInSeconds;
+}
+
+void ModelState::CalculateAnimationFrameAndFraction(
+    const ModelAnimationTimeType type,
+    float timeInSeconds) {
+    timeInSeconds = GetAnimationTime(type, timeInSeconds);
+    for (int i = 0; i < static_cast<int>(animationTimelineStates.size()); i++) {
+        animationTimelineStates[i].CalculateFrameAndFraction(timeInSeconds);
+    }
+}
+
+void ModelNodeState::GenerateStateFromNode(const ModelNode* _node, ModelState* _modelState) {
+    node = _node;
+    state = _modelState;
+    rotation = node->rotation;
+    translation = node->translation;
+    scale = node->scale;
+    weights = node->weights;
+}
+
+void ModelNodeState::CalculateLocalTransform() {
+    CalculateTransformFromRTS(
+        &state->localTransforms[transformIndex], rotation, translation, scale);
+    state->MarkTransformDirty(transformIndex);
+}
+
+void ModelNodeState::SetLocalTransform(const Matrix4f matrix) {
+    state->localTransforms[transformIndex] = matrix;
+    state->MarkTransformDirty(transformIndex);
+}
+
+void ModelNodeState::RecalculateMatrix() {
+    state->RecalculateTransforms(transformIndex, state->transformSubtreeEnds[transformIndex]);
+}
+
+void ModelNodeState::AddNodesToEmitList(std::vector<ModelNodeState*>& emitList) {
+    // The subtree is contiguous and already in the order the recursion visited it
+    for (int i = transformIndex; i < state->transformSubtreeEnds[transformIndex]; i++) {
+        emitList.push_back(&state->nodeStates[state->transformNodes[i]]);
+    }
+}
+
+void ModelSubSceneState::GenerateStateFromSubScene(const ModelSubScene* _subScene) {
+    subScene = _subScene;
+    visible = subScene->visible;
+
+    nodeStates.resize(subScene->nodes.size());
+    for (int i = 0; i < static_cast<int>(subScene->nodes.size()); i++) {
+        nodeStates[i] = subScene->nodes[i];
+    }
+}
+
+void ModelState::GenerateStateFromModelFile(const ModelFile* _mf) {
+    subSceneStates.clear();
+    modelMatrix = Matrix4f::Identity();
+
+    mf = _mf;
+    DontRenderForClientUid = 0;
+
+    const int numNodes = static_cast<int>(mf->Nodes.size());
+    nodeStates.resize(numNodes);
+    for (int i = 0; i < numNodes; i++) {
+        nodeStates[i].GenerateStateFromNode(&mf->Nodes[i], this);
+        nodeStates[i].transformIndex = -1;
+    }
+
+    // Depth first from every root, children in the order of ModelNode::children. The second
+    // pass picks up nodes whose parent does not list them, as roots of their own.
+    transformNodes.clear();
+    transformParents.clear();
+    transformNodes.reserve(numNodes);
+    transformParents.reserve(numNodes);
+    transformSubtreeEnds.assign(numNodes, 0);
+    std::vector<std::pair<int, int>> stack; // node index, parent transform index
+    for (int pass = 0; pass < 2; pass++) {
+        for (int root = 0; root < numNodes; root++) {
+            const int rootParent = mf->Nodes[root].parentIndex;
+            if (nodeStates[root].transformIndex >= 0 ||
+                (pass == 0 && rootParent >= 0 && rootParent < numNodes)) {
+                continue;
+            }
+            stack.push_back(std::make_pair(root, -1));
+            while (!stack.empty()) {
+                const int nodeIndex = stack.back().first;
+                const int parentTransform = stack.back().second;
+                stack.pop_back();
+                ModelNodeState& nodeState = nodeStates[nodeIndex];
+                if (nodeState.transformIndex >= 0) {
+                    continue;
+                }
+                nodeState.transformIndex = static_cast<int>(transformNodes.size());
+                transformNodes.push_back(nodeIndex);
+                transformParents.push_back(parentTransform);
+                const std::vector<int>& children = nodeState.node->children;
+                for (int i = static_cast<int>(children.size()) - 1; i >= 0; i--) {
+                    stack.push_back(std::make_pair(children[i], nodeState.transformIndex));
+                }
+            }
+        }
+    }
+
+    // A subtree ends where the next node that is not below it starts
+    for (int i = numNodes - 1; i >= 0; i--) {
+        if (transformSubtreeEnds[i] < i + 1) {
+            transformSubtreeEnds[i] = i + 1;
+        }
+        const int parent = transformParents[i];
+        if (parent >= 0 && transformSubtreeEnds[parent] < transformSubtreeEnds[i]) {
+            transformSubtreeEnds[parent] = transformSubtreeEnds[i];
+        }
+    }
+
+    // These values should be calculated already.
+    localTransforms.resize(numNodes);
+    globalTransforms.resize(numNodes);
+    for (int i = 0; i < numNodes; i++) {
+        localTransforms[i] = mf->Nodes[transformNodes[i]].GetLocalTransform();
+        globalTransforms[i] = mf->Nodes[transformNodes[i]].GetGlobalTransform();
+    }
+    transformDirty.assign(numNodes, 0);
+    dirtyTransforms.clear();
+    dirtyTransforms.reserve(numNodes);
+
+    animationTimelineStates.resize(mf->AnimationTimeLines.size());
+    for (int i = 0; i < static_cast<int>(mf->AnimationTimeLines.size()); i++) {
+        animationTimelineStates[i].timeline = &mf->AnimationTimeLines[i];
+    }
+
+    subSceneStates.resize(mf->SubScenes.size());
+    for (int i = 0; i < static_cast<int>(mf->SubScenes.size()); i++) {
+        subSceneStates[i].GenerateStateFromSubScene(&mf->SubScenes[i]);
+    }
+}
+
+void ModelState::SetMatrix(const Matrix4f matrix) {
+    modelMatrix = matrix;
+    for (int i = 0; i < static_cast<int>(transformParents.size()); i++) {
+        if (transformParents[i] < 0) {
+            MarkTransformDirty(i);
+        }
+    }
+    UpdateGlobalTransforms();
+}
+
+void ModelState::MarkTransformDirty(const int transformIndex) {
+    if (transformDirty[transformIndex] == 0) {
+        transformDirty[transformIndex] = 1;
+        dirtyTransforms.push_back(transformIndex);
+    }
+}
+
+void ModelState::RecalculateTransforms(const int first, const int end) {
+    for (int i = first; i < end; i++) {
+        const int parent = transformParents[i];
+        globalTransforms[i] =
+            (parent < 0 ? modelMatrix : globalTransforms[parent]) * localTransforms[i];
+        transformDirty[i] = 0;
+    }
+}
+
+void ModelState::UpdateGlobalTransforms() {
+    const int numDirty = static_cast<int>(dirtyTransforms.size());
+    if (numDirty == 0) {
+        return;
+    }
+    const int numTransforms = static_cast<int>(transformNodes.size());
+    if (numDirty * 8 >= numTransforms) {
+        // Most of the model moved: one pass over everything, a node is recalculated when it
+        // or its parent is dirty and then counts as dirty for its own children
+        for (int i = 0; i < numTransforms; i++) {
+            const int parent = transformParents[i];
+            if (transformDirty[i] != 0 || (parent >= 0 && transformDirty[parent] != 0)) {
+                globalTransforms[i] =
+                    (parent < 0 ? modelMatrix : globalTransforms[parent]) * localTransforms[i];
+                transformDirty[i] = 1;
+            }
+        }
+        memset(transformDirty.data(), 0, transformDirty.size());
+    } else {
+        // A few nodes moved: recalculate the subtree of each one, in depth first order so a
+        // dirty node inside a subtree that was already recalculated is skipped
+        std::sort(dirtyTransforms.begin(), dirtyTransforms.end());
+        int recalculatedEnd = 0;
+        for (const int index : dirtyTransforms) {
+            if (index < recalculatedEnd || transformDirty[index] == 0) {
+                continue;
+            }
+            recalculatedEnd = transformSubtreeEnds[index];
+            RecalculateTransforms(index, recalculatedEnd);
+        }
+    }
+    dirtyTransforms.clear();
+}
+
+} // namespace OVRFW
@@ -394,16 +394,22 @@ void ModelInScene::AnimateJoints(const double timeInSeconds) {
     // new animation method.
     {
         if (State.animationTimelineStates.size() > 0) {
-            State.CalculateAnimationFrameAndFraction(
-                MODEL_ANIMATION_TIME_TYPE_LOOP_FORWARD, (float)timeInSeconds);
+            if (State.mf->AnimationClips.size() == State.mf->Animations.size()) {
+                const float animationTime = State.GetAnimationTime(
+                    MODEL_ANIMATION_TIME_TYPE_LOOP_FORWARD, (float)timeInSeconds);
+                for (const ModelAnimationClip& clip : State.mf->AnimationClips) {
+                    SampleAnimationClip(State, clip, animationTime);
+                }
+            } else {
+                State.CalculateAnimationFrameAndFraction(
+                    MODEL_ANIMATION_TIME_TYPE_LOOP_FORWARD, (float)timeInSeconds);
 
-            for (int i = 0; i < static_cast<int>(State.mf->Animations.size()); i++) {
-                ApplyAnimation(State, i);
+                for (int i = 0; i < static_cast<int>(State.mf->Animations.size()); i++) {
+                    ApplyAnimation(State, i);
+                }
             }
 
-            for (int i = 0; i < static_cast<int>(State.nodeStates.size()); i++) {
-                State.nodeStates[i].RecalculateMatrix();
-            }
+            State.UpdateGlobalTransforms();
         }
     }
 }
@@ -413,6 +419,7 @@ void ModelInScene::AnimateJoints(const double timeInSeconds) {
 OvrSceneView::OvrSceneView()
     : FreeWorldModelOnChange(false),
       LoadedPrograms(false),
+      InstancedBatching(true),
       Paused(false),
       SuppressModelsWithClientId(-1),
       // FIXME: ideally EyeHeight and IPD properties would default initialize to 0.0f, but there are
@@ -435,12 +442,41 @@ OvrSceneView::OvrSceneView()
     CenterEyeViewMatrix = Matrix4f::Identity();
 }
 
+void OvrSceneView::Shutdown() {
+    InstanceBatcher.Shutdown();
+    InstanceBatcher.FreeInstancedPrograms();
+}
+
 ModelGlPrograms OvrSceneView::GetDefaultGLPrograms() {
     ModelGlPrograms programs;
 
     if (!LoadedPrograms) {
+        // Instanced variants of the programs that only read the model transform through
+        // ModelMatrix, for InstanceBatcher. A variant that fails to build is just not used.
+        auto buildInstanced = [this](
+                                  const OVRFW::GlProgram& program,
+                                  const char* vertexSrc,
+                                  const char* fragmentSrc,
+                                  const OVRFW::ovrProgramParm* parms,
+                                  const int numParms) {
+            OVRFW::GlProgram instanced = OVRFW::GlProgram::Build(
+                OVRFW::GlProgram::INSTANCED_VERTEX_DIRECTIVES,
+                vertexSrc,
+                nullptr,
+                fragmentSrc,
+                parms,
+                numParms,
+                OVRFW::GlProgram::GLSL_PROGRAM_VERSION,
+                false /* abortOnError */);
+            if (instanced.IsValid()) {
+                InstanceBatcher.SetInstancedProgram(program, instanced);
+            }
+        };
+
         ProgVertexColor = OVRFW::GlProgram::Build(
             VertexColorVertexShaderSrc, VertexColorFragmentShaderSrc, nullptr, 0);
+        buildInstanced(
+            ProgVertexColor, VertexColorVertexShaderSrc, VertexColorFragmentShaderSrc, nullptr, 0);
 
         {
             OVRFW::ovrProgramParm uniformParms[] = {
@@ -454,6 +490,12 @@ ModelGlPrograms OvrSceneView::GetDefaultGLPrograms() {
                 SingleTextureFragmentShaderSrc,
                 uniformParms,
                 uniformCount);
+            buildInstanced(
+                ProgSingleTexture,
+                SingleTextureVertexShaderSrc,
+                SingleTextureFragmentShaderSrc,
+                uniformParms,
+                uniformCount);
         }
 
         {
@@ -469,6 +511,12 @@ ModelGlPrograms OvrSceneView::GetDefaultGLPrograms() {
                 LightMappedFragmentShaderSrc,
                 uniformParms,
                 uniformCount);
+            buildInstanced(
+                ProgLightMapped,
+                LightMappedVertexShaderSrc,
+                LightMappedFragmentShaderSrc,
+                uniformParms,
+                uniformCount);
         }
 
         {
@@ -499,6 +547,12 @@ ModelGlPrograms OvrSceneView::GetDefaultGLPrograms() {
             const int uniformCount = sizeof(uniformParms) / sizeof(OVRFW::ovrProgramParm);
             ProgSimplePBR = OVRFW::GlProgram::Build(
                 SimplePBRVertexShaderSrc, SimplePBRFragmentShaderSrc, uniformParms, uniformCount);
+            buildInstanced(
+                ProgSimplePBR,
+                SimplePBRVertexShaderSrc,
+                SimplePBRFragmentShaderSrc,
+                uniformParms,
+                uniformCount);
         }
 
         {
@@ -514,6 +568,12 @@ ModelGlPrograms OvrSceneView::GetDefaultGLPrograms() {
                 BaseColorPBRFragmentShaderSrc,
                 uniformParms,
                 uniformCount);
+            buildInstanced(
+                ProgBaseColorPBR,
+                SimplePBRVertexShaderSrc,
+                BaseColorPBRFragmentShaderSrc,
+                uniformParms,
+                uniformCount);
         }
 
         {
@@ -531,6 +591,12 @@ ModelGlPrograms OvrSceneView::GetDefaultGLPrograms() {
                 BaseColorEmissivePBRFragmentShaderSrc,
                 uniformParms,
                 uniformCount);
+            buildInstanced(
+                ProgBaseColorEmissivePBR,
+                SimplePBRVertexShaderSrc,
+                BaseColorEmissivePBRFragmentShaderSrc,
+                uniformParms,
+                uniformCount);
         }
 
         {
@@ -842,6 +908,12 @@ void OvrSceneView::GenerateFrameSurfaceList(
         symmetricEyeProjectionMatrix);
 }
 
+void OvrSceneView::BatchInstances(std::vector<ovrDrawSurface>& surfaceList) const {
+    if (InstancedBatching) {
+        InstanceBatcher.Batch(surfaceList);
+    }
+}
+
 void OvrSceneView::SetFootPos(const Vector3f& pos, bool updateCenterEye /*= true*/) {
     FootPos = pos;
     if (updateCenterEye) {
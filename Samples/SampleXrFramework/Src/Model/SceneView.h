@@ -29,6 +29,7 @@ Authors     :   John Carmack
 
 #include "FrameParams.h"
 #include "ModelFile.h"
+#include "Render/InstanceBatcher.h"
 
 namespace OVRFW {
 
@@ -105,6 +106,27 @@ class OvrSceneView {
         const FrameMatrices& matrices,
         std::vector<ovrDrawSurface>& surfaceList) const;
 
+    // Merges repeated opaque surfaces drawn with the default programs into instanced draws,
+    // see ovrInstanceBatcher. It uploads the instance matrices, so it runs on the GL thread
+    // right before the list is rendered, not in GenerateFrameSurfaceList: XrApp calls it
+    // from AppRenderFrame. Does nothing with SetInstancedBatching(false).
+    void BatchInstances(std::vector<ovrDrawSurface>& surfaceList) const;
+    // On by default
+    void SetInstancedBatching(const bool enable) {
+        InstancedBatching = enable;
+    }
+    // Sets of instance buffers kept by BatchInstances, see ovrInstanceBatcher::ReserveFrameSets
+    void ReserveInstanceFrameSets(const int numFrameSets) {
+        InstanceBatcher.ReserveFrameSets(numFrameSets);
+    }
+    const ovrInstanceBatcher& GetInstanceBatcher() const {
+        return InstanceBatcher;
+    }
+
+    // Frees the instance buffers and the instanced variants built by GetDefaultGLPrograms,
+    // needs the GL context. The default programs are kept, models may still use them.
+    void Shutdown();
+
     // Systems that want to manage individual surfaces instead of complete models
     // can add surfaces to this list during Frame().  They will be drawn for
     // both eyes, then the list will be cleared.
@@ -214,6 +236,8 @@ class OvrSceneView {
     GlProgram ProgSkinnedBaseColorPBR;
     GlProgram ProgSkinnedBaseColorEmissivePBR;
     bool LoadedPrograms;
+    bool InstancedBatching;
+    mutable ovrInstanceBatcher InstanceBatcher; // holds the instanced program variants
 
     ModelGlPrograms GlPrograms;
 
@@ -28,7 +28,7 @@ Authors     :   Chris Taylor
 #include "OVR_MappedFile.h"
 #include "OVR_Types.h"
 
-#if defined(OVR_OS_ANDROID)
+#if defined(OVR_OS_ANDROID) || defined(OVR_OS_LINUX)
 
 #if defined(OVR_OS_ANDROID)
 // disable warnings on implicit type conversion where value may be changed by conversion for
@@ -133,19 +133,42 @@ bool MappedFile::OpenWrite(const char* path, size_t size) {
 
     if (File == -1) {
         return false;
-    } else {
-        if (-1 == lseek(File, size - 1, SEEK_SET)) {
-            return false;
-        } else {
-            if (1 != write(File, "", 1)) {
-                return false;
-            }
-        }
+    }
+
+    // posix_fallocate returns the error instead of setting errno
+    const int result = posix_fallocate(File, 0, (off_t)size);
+    if (result == 0) {
+        return true;
+    } else if (result != EOPNOTSUPP && result != EINVAL) {
+        // ENOSPC or an I/O error: a sparse file would only fault later, on a store
+        Close();
+        unlink(path);
+        return false;
+    }
+
+    // Filesystem without fallocate: extend the file sparsely instead
+    if (-1 == lseek(File, size - 1, SEEK_SET) || 1 != write(File, "", 1)) {
+        Close();
+        unlink(path);
+        return false;
     }
 
     return true;
 }
 
+bool MappedFile::Truncate(size_t size) {
+    if (File == -1 || ReadOnly) {
+        return false;
+    }
+
+    if (0 != ftruncate(File, (off_t)size)) {
+        return false;
+    }
+
+    Length = size;
+    return true;
+}
+
 void MappedFile::Close() {
     if (File != -1) {
         close(File);
@@ -205,7 +228,10 @@ uint8_t* MappedView::MapView(size_t offset, uint32_t length) {
     }
 
     // Use MAP_PRIVATE so that memory is not exposed to other processes.
-    Map = mmap(0, length, prot, MAP_PRIVATE, File->File, offset);
+    // Writable files need MAP_SHARED or the stores would never reach the file;
+    // they are created with mode 0660 so other applications still cannot see them.
+    const int flags = File->ReadOnly ? MAP_PRIVATE : MAP_SHARED;
+    Map = mmap(0, length, prot, flags, File->File, offset);
 
     if (Map == MAP_FAILED) {
         return 0;
@@ -219,6 +245,37 @@ uint8_t* MappedView::MapView(size_t offset, uint32_t length) {
     return Data;
 }
 
+bool MappedView::Sync(size_t offset, size_t length, bool wait) {
+    if (Map == MAP_FAILED || File == 0 || File->ReadOnly || offset >= Length) {
+        return false;
+    }
+    if (length > Length - offset) {
+        length = Length - offset;
+    }
+
+    // msync needs a page aligned start; the view itself is page aligned
+    const size_t page = GetAllocationGranularity();
+    const size_t start = offset & ~(page - 1);
+    length += offset - start;
+
+    return 0 == msync(Data + start, length, wait ? MS_SYNC : MS_ASYNC);
+}
+
+bool MappedView::Advise(AccessHint hint) {
+    if (Map == MAP_FAILED) {
+        return false;
+    }
+
+    int advice = MADV_NORMAL;
+    if (hint == ACCESS_SEQUENTIAL) {
+        advice = MADV_SEQUENTIAL;
+    } else if (hint == ACCESS_RANDOM) {
+        advice = MADV_RANDOM;
+    }
+
+    return 0 == madvise(Map, Length, advice);
+}
+
 void MappedView::Close() {
     if (Map != MAP_FAILED) {
         munmap(Map, Length);
@@ -231,4 +288,4 @@ void MappedView::Close() {
 
 } // namespace OVRFW
 
-#endif // defined(OVR_OS_ANDROID)
+#endif // defined(OVR_OS_ANDROID) || defined(OVR_OS_LINUX)
@@ -44,6 +44,10 @@ Authors     :   Chris Taylor
     For random file access, use MappedView with a MappedFile that has been
     opened with random_access = true.  Random access is usually used for a
     database-like file type, which is much better implemented using asynch IO.
+
+    Views of a file opened with OpenWrite are shared mappings: stores into the
+    view end up in the file without any write() call.  Use Sync to bound how
+    much a power loss can take, and Truncate to drop unused preallocated space.
 */
 
 namespace OVRFW {
@@ -60,9 +64,18 @@ class MappedFile {
     // Returns false on error (file not found, etc)
     bool OpenRead(const char* path, bool read_ahead = false, bool no_cache = false);
 
-    // Creates and opens the file for exclusive read/write access
+    // Creates and opens the file for exclusive read/write access.
+    // The blocks are reserved up front where the filesystem supports it, so
+    // stores into a view cannot fault later because the disk filled up. If the
+    // reservation fails for any other reason than missing support (e.g. ENOSPC)
+    // the file is closed and removed and false is returned. Without support the file is
+    // extended sparsely and a full disk can still fault a store.
     bool OpenWrite(const char* path, size_t size);
 
+    // Sets the file size, e.g. to cut a preallocated file down to the used part.
+    // Views must be closed or must not touch anything past the new length.
+    bool Truncate(size_t size);
+
     void Close();
 
     bool IsReadOnly() const {
@@ -84,6 +97,12 @@ class MappedFile {
 // View of a portion of the memory mapped file
 class MappedView {
    public:
+    enum AccessHint {
+        ACCESS_NORMAL,
+        ACCESS_SEQUENTIAL, // read or written front to back once
+        ACCESS_RANDOM,
+    };
+
     MappedView();
     ~MappedView();
 
@@ -93,6 +112,14 @@ class MappedView {
         uint32_t length = 0); // Returns 0 on error, 0 length means whole file
     void Close();
 
+    // Writes the dirty pages of [offset, offset + length) of the view back to
+    // the file.  offset is relative to GetFront().  wait = false only schedules
+    // the write.  Returns false on error or for read-only views.
+    bool Sync(size_t offset, size_t length, bool wait);
+
+    // Tells the kernel how the view will be accessed (readahead, page reclaim)
+    bool Advise(AccessHint hint);
+
     bool IsValid() const {
         return (Data != 0);
     }
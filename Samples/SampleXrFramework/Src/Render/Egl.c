@@ -62,6 +62,9 @@ void* EglGetExtensionProc(const char* functionName) {
     void* ptr = (void*)eglGetProcAddress(functionName);
 #elif defined(WIN32)
     void* ptr = (void*)wglGetProcAddress(functionName);
+#else
+    // Headless build, there is no driver to ask
+    void* ptr = NULL;
 #endif // defined(ANDROID)
     if (ptr == NULL) {
         ALOG("NOT FOUND: %s", functionName);
@@ -136,12 +139,18 @@ const char* EglErrorString(const EGLint error) {
     }
 }
 
-#else
+#elif defined(WIN32)
 
 const char* EglErrorString(const GLint err) {
     return ovrGl_ErrorString_Windows(err);
 }
 
+#else
+
+const char* EglErrorString(const GLint err) {
+    return "unknown";
+}
+
 #endif // defined(ANDROID)
 
 const char* GlFrameBufferStatusString(GLenum status) {
@@ -396,6 +405,9 @@ void ovrEgl_CreateContext(ovrEgl* egl, const ovrEgl* shareEgl) {
         egl->Context = EGL_NO_CONTEXT;
         return;
     }
+#if defined(OVR_GL_DISPATCH)
+    ovrGlDispatch_UseNative();
+#endif // defined(OVR_GL_DISPATCH)
 }
 
 void ovrEgl_DestroyContext(ovrEgl* egl) {
@@ -429,14 +441,25 @@ void ovrEgl_DestroyContext(ovrEgl* egl) {
     }
 }
 
-#else
+#elif defined(WIN32)
 
 void ovrEgl_CreateContext(ovrEgl* egl, const ovrEgl* shareEgl) {
     ovrGl_CreateContext_Windows(&egl->hDC, &egl->hGLRC);
+#if defined(OVR_GL_DISPATCH)
+    ovrGlDispatch_UseNative();
+#endif // defined(OVR_GL_DISPATCH)
 }
 
 void ovrEgl_DestroyContext(ovrEgl* egl) {
     ovrGl_DestroyContext_Windows();
 }
 
+#else
+
+// Headless build: no context, the GL calls of the render core go to the null dispatch table
+
+void ovrEgl_CreateContext(ovrEgl* egl, const ovrEgl* shareEgl) {}
+
+void ovrEgl_DestroyContext(ovrEgl* egl) {}
+
 #endif // defined(ANDROID)
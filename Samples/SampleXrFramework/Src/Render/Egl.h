@@ -218,3 +218,7 @@ bool GLCheckErrorsWithTitle(const char* logTitle);
 #if defined(__cplusplus)
 } // extern "C"
 #endif
+
+#if defined(OVR_GL_DISPATCH)
+#include "GlDispatch.h"
+#endif // defined(OVR_GL_DISPATCH)
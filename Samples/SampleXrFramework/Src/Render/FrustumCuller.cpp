@@ -0,0 +1,248 @@
+/*******************************************************************************
+
+Filename    :   FrustumCuller.cpp
+Content     :   Batched frustum culling and depth sort keys for world-space bounds.
+Language    :   C++
+
+*******************************************************************************/
+
+#include "FrustumCuller.h"
+
+#include "OVR_Types.h"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(OVR_CPU_SSE)
+#include <xmmintrin.h>
+#define OVR_FRUSTUM_CULL_SSE 1
+#elif defined(OVR_CPU_ARM_NEON) || defined(__ARM_NEON)
+#include <arm_neon.h>
+#define OVR_FRUSTUM_CULL_NEON 1
+#endif
+
+using OVR::Bounds3f;
+using OVR::Matrix4f;
+
+namespace OVRFW {
+
+void ovrFrustumCuller::Clear() {
+    CenterX.clear();
+    CenterY.clear();
+    CenterZ.clear();
+    ExtentX.clear();
+    ExtentY.clear();
+    ExtentZ.clear();
+    EmptyBounds.clear();
+    Count = 0;
+}
+
+void ovrFrustumCuller::Reserve(const int count) {
+    const size_t padded = (count + 3) & ~3;
+    CenterX.reserve(padded);
+    CenterY.reserve(padded);
+    CenterZ.reserve(padded);
+    ExtentX.reserve(padded);
+    ExtentY.reserve(padded);
+    ExtentZ.reserve(padded);
+    SortKeys.reserve(padded);
+}
+
+int ovrFrustumCuller::Add(const Bounds3f& localBounds, const Matrix4f& modelMatrix) {
+    const int index = Count++;
+
+    // Always cull empty bounds, which can be used to disable a surface.
+    // Don't just check a single axis, or billboards would be culled.
+    if (localBounds.b[1].x == localBounds.b[0].x && localBounds.b[1].y == localBounds.b[0].y) {
+        EmptyBounds.push_back(index);
+    }
+
+    // Centre and extents of the box around the transformed bounds (model matrices are affine)
+    const OVR::Vector3f c = (localBounds.b[0] + localBounds.b[1]) * 0.5f;
+    const OVR::Vector3f e = localBounds.b[1] - c;
+    const float(*m)[4] = modelMatrix.M;
+    CenterX.push_back(m[0][0] * c.x + m[0][1] * c.y + m[0][2] * c.z + m[0][3]);
+    CenterY.push_back(m[1][0] * c.x + m[1][1] * c.y + m[1][2] * c.z + m[1][3]);
+    CenterZ.push_back(m[2][0] * c.x + m[2][1] * c.y + m[2][2] * c.z + m[2][3]);
+    ExtentX.push_back(fabsf(m[0][0] * e.x) + fabsf(m[0][1] * e.y) + fabsf(m[0][2] * e.z));
+    ExtentY.push_back(fabsf(m[1][0] * e.x) + fabsf(m[1][1] * e.y) + fabsf(m[1][2] * e.z));
+    ExtentZ.push_back(fabsf(m[2][0] * e.x) + fabsf(m[2][1] * e.y) + fabsf(m[2][2] * e.z));
+    return index;
+}
+
+bool ovrFrustumCuller::HasSimd() {
+#if defined(OVR_FRUSTUM_CULL_SSE) || defined(OVR_FRUSTUM_CULL_NEON)
+    return true;
+#else
+    return false;
+#endif
+}
+
+int ovrFrustumCuller::Cull(const Matrix4f& viewProjectionMatrix) {
+    // Clip-space planes: x > -w, x < w, y > -w, y < w, z > -w, z < w. A bounds is outside
+    // a plane when even its corner farthest along the normal is not in front of it, which
+    // is the test the corner loop of BoundsSortCullKey did.
+    const float(*m)[4] = viewProjectionMatrix.M;
+    float planes[6][4];
+    for (int axis = 0; axis < 3; axis++) {
+        for (int j = 0; j < 4; j++) {
+            planes[axis * 2 + 0][j] = m[3][j] + m[axis][j];
+            planes[axis * 2 + 1][j] = m[3][j] - m[axis][j];
+        }
+    }
+    const float wRow[4] = {m[3][0], m[3][1], m[3][2], m[3][3]};
+
+    // Pad to whole groups of four with empty bounds at the origin
+    const size_t padded = (Count + 3) & ~3;
+    CenterX.resize(padded, 0.0f);
+    CenterY.resize(padded, 0.0f);
+    CenterZ.resize(padded, 0.0f);
+    ExtentX.resize(padded, 0.0f);
+    ExtentY.resize(padded, 0.0f);
+    ExtentZ.resize(padded, 0.0f);
+    SortKeys.resize(padded);
+
+    if (SimdEnabled && HasSimd()) {
+        CullSimd(planes, wRow);
+    } else {
+        CullScalar(planes, wRow);
+    }
+
+    // Back to the real count, so more bounds can be added after a Cull
+    CenterX.resize(Count);
+    CenterY.resize(Count);
+    CenterZ.resize(Count);
+    ExtentX.resize(Count);
+    ExtentY.resize(Count);
+    ExtentZ.resize(Count);
+    SortKeys.resize(Count);
+
+    for (const int index : EmptyBounds) {
+        SortKeys[index] = 0.0f;
+    }
+    int visible = 0;
+    for (int i = 0; i < Count; i++) {
+        visible += (SortKeys[i] > 0.0f);
+    }
+    return visible;
+}
+
+void ovrFrustumCuller::CullScalar(const float planes[6][4], const float wRow[4]) {
+    const int count = static_cast<int>(SortKeys.size());
+    for (int i = 0; i < count; i++) {
+        const float cx = CenterX[i];
+        const float cy = CenterY[i];
+        const float cz = CenterZ[i];
+        const float ex = ExtentX[i];
+        const float ey = ExtentY[i];
+        const float ez = ExtentZ[i];
+
+        bool outside = false;
+        for (int p = 0; p < 6 && !outside; p++) {
+            const float* n = planes[p];
+            const float d = n[0] * cx + n[1] * cy + n[2] * cz + n[3] + fabsf(n[0]) * ex +
+                fabsf(n[1]) * ey + fabsf(n[2]) * ez;
+            outside = (d <= 0.0f);
+        }
+
+        // Farthest W of the corners, a corner at 0 or behind never counts as visible
+        const float maxW = wRow[0] * cx + wRow[1] * cy + wRow[2] * cz + wRow[3] +
+            fabsf(wRow[0]) * ex + fabsf(wRow[1]) * ey + fabsf(wRow[2]) * ez;
+        SortKeys[i] = (outside || maxW <= 0.0f) ? 0.0f : maxW;
+    }
+}
+
+#if defined(OVR_FRUSTUM_CULL_SSE)
+
+void ovrFrustumCuller::CullSimd(const float planes[6][4], const float wRow[4]) {
+    const __m128 signMask = _mm_set1_ps(-0.0f);
+    const __m128 zero = _mm_setzero_ps();
+    const int count = static_cast<int>(SortKeys.size());
+    for (int i = 0; i < count; i += 4) {
+        const __m128 cx = _mm_loadu_ps(&CenterX[i]);
+        const __m128 cy = _mm_loadu_ps(&CenterY[i]);
+        const __m128 cz = _mm_loadu_ps(&CenterZ[i]);
+        const __m128 ex = _mm_loadu_ps(&ExtentX[i]);
+        const __m128 ey = _mm_loadu_ps(&ExtentY[i]);
+        const __m128 ez = _mm_loadu_ps(&ExtentZ[i]);
+
+        __m128 outside = zero;
+        for (int p = 0; p < 6; p++) {
+            const float* n = planes[p];
+            __m128 d = _mm_add_ps(
+                _mm_add_ps(
+                    _mm_mul_ps(_mm_set1_ps(n[0]), cx), _mm_mul_ps(_mm_set1_ps(n[1]), cy)),
+                _mm_add_ps(_mm_mul_ps(_mm_set1_ps(n[2]), cz), _mm_set1_ps(n[3])));
+            d = _mm_add_ps(
+                d,
+                _mm_add_ps(
+                    _mm_add_ps(
+                        _mm_mul_ps(_mm_andnot_ps(signMask, _mm_set1_ps(n[0])), ex),
+                        _mm_mul_ps(_mm_andnot_ps(signMask, _mm_set1_ps(n[1])), ey)),
+                    _mm_mul_ps(_mm_andnot_ps(signMask, _mm_set1_ps(n[2])), ez)));
+            outside = _mm_or_ps(outside, _mm_cmple_ps(d, zero));
+        }
+
+        __m128 maxW = _mm_add_ps(
+            _mm_add_ps(
+                _mm_mul_ps(_mm_set1_ps(wRow[0]), cx), _mm_mul_ps(_mm_set1_ps(wRow[1]), cy)),
+            _mm_add_ps(_mm_mul_ps(_mm_set1_ps(wRow[2]), cz), _mm_set1_ps(wRow[3])));
+        maxW = _mm_add_ps(
+            maxW,
+            _mm_add_ps(
+                _mm_add_ps(
+                    _mm_mul_ps(_mm_set1_ps(fabsf(wRow[0])), ex),
+                    _mm_mul_ps(_mm_set1_ps(fabsf(wRow[1])), ey)),
+                _mm_mul_ps(_mm_set1_ps(fabsf(wRow[2])), ez)));
+        outside = _mm_or_ps(outside, _mm_cmple_ps(maxW, zero));
+        _mm_storeu_ps(&SortKeys[i], _mm_andnot_ps(outside, maxW));
+    }
+}
+
+#elif defined(OVR_FRUSTUM_CULL_NEON)
+
+void ovrFrustumCuller::CullSimd(const float planes[6][4], const float wRow[4]) {
+    const float32x4_t zero = vdupq_n_f32(0.0f);
+    const int count = static_cast<int>(SortKeys.size());
+    for (int i = 0; i < count; i += 4) {
+        const float32x4_t cx = vld1q_f32(&CenterX[i]);
+        const float32x4_t cy = vld1q_f32(&CenterY[i]);
+        const float32x4_t cz = vld1q_f32(&CenterZ[i]);
+        const float32x4_t ex = vld1q_f32(&ExtentX[i]);
+        const float32x4_t ey = vld1q_f32(&ExtentY[i]);
+        const float32x4_t ez = vld1q_f32(&ExtentZ[i]);
+
+        uint32x4_t outside = vdupq_n_u32(0);
+        for (int p = 0; p < 6; p++) {
+            const float* n = planes[p];
+            float32x4_t d = vmlaq_n_f32(vdupq_n_f32(n[3]), cx, n[0]);
+            d = vmlaq_n_f32(d, cy, n[1]);
+            d = vmlaq_n_f32(d, cz, n[2]);
+            d = vmlaq_n_f32(d, ex, fabsf(n[0]));
+            d = vmlaq_n_f32(d, ey, fabsf(n[1]));
+            d = vmlaq_n_f32(d, ez, fabsf(n[2]));
+            outside = vorrq_u32(outside, vcleq_f32(d, zero));
+        }
+
+        float32x4_t maxW = vmlaq_n_f32(vdupq_n_f32(wRow[3]), cx, wRow[0]);
+        maxW = vmlaq_n_f32(maxW, cy, wRow[1]);
+        maxW = vmlaq_n_f32(maxW, cz, wRow[2]);
+        maxW = vmlaq_n_f32(maxW, ex, fabsf(wRow[0]));
+        maxW = vmlaq_n_f32(maxW, ey, fabsf(wRow[1]));
+        maxW = vmlaq_n_f32(maxW, ez, fabsf(wRow[2]));
+        outside = vorrq_u32(outside, vcleq_f32(maxW, zero));
+        vst1q_f32(
+            &SortKeys[i],
+            vreinterpretq_f32_u32(vbicq_u32(vreinterpretq_u32_f32(maxW), outside)));
+    }
+}
+
+#else
+
+void ovrFrustumCuller::CullSimd(const float planes[6][4], const float wRow[4]) {
+    CullScalar(planes, wRow);
+}
+
+#endif // defined(OVR_FRUSTUM_CULL_SSE)
+
+} // namespace OVRFW
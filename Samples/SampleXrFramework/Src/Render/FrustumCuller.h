@@ -0,0 +1,82 @@
+/*******************************************************************************
+
+Filename    :   FrustumCuller.h
+Content     :   Batched frustum culling and depth sort keys for world-space bounds.
+Language    :   C++
+
+*******************************************************************************/
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "OVR_Math.h"
+
+namespace OVRFW {
+
+// Culls many bounds against one view-projection at a time.
+//
+// Add transforms each local bounds into a world-space centre/extent pair (the box
+// around the transformed bounds, so rotated bounds cull a little less tightly than
+// testing their corners) and stores it in structure-of-arrays form. Cull then tests
+// four of them at a time against the six frustum planes with SSE or NEON, or one at a
+// time without either, and writes one sort key per bounds:
+//
+//   0      culled, or empty bounds (no extent in x and y, used to disable a surface)
+//   > 0    the farthest clip-space W of the bounds, for front-to-back sorting
+//
+// These are the keys the old per-surface corner test in ModelRender produced, so the
+// surface sort is unchanged apart from the looser bounds of rotated surfaces.
+class ovrFrustumCuller {
+   public:
+    ovrFrustumCuller() = default;
+
+    // Keeps the capacity, so a culler reused every frame does not allocate
+    void Clear();
+    void Reserve(const int count);
+
+    // Returns the index of the bounds, in the order they were added
+    int Add(const OVR::Bounds3f& localBounds, const OVR::Matrix4f& modelMatrix);
+    int GetCount() const {
+        return Count;
+    }
+
+    // Fills the sort keys and returns how many bounds are visible
+    int Cull(const OVR::Matrix4f& viewProjectionMatrix);
+
+    // Valid after Cull
+    float GetSortKey(const int index) const {
+        return SortKeys[index];
+    }
+    bool IsVisible(const int index) const {
+        return SortKeys[index] > 0.0f;
+    }
+    const std::vector<float>& GetSortKeys() const {
+        return SortKeys;
+    }
+
+    // Tests one bounds at a time even when SSE or NEON is available, for comparison
+    void SetSimdEnabled(const bool enable) {
+        SimdEnabled = enable;
+    }
+    static bool HasSimd();
+
+   private:
+    void CullScalar(const float planes[6][4], const float wRow[4]);
+    void CullSimd(const float planes[6][4], const float wRow[4]);
+
+    // Padded to a multiple of 4 so the vector loop can read whole groups
+    std::vector<float> CenterX;
+    std::vector<float> CenterY;
+    std::vector<float> CenterZ;
+    std::vector<float> ExtentX;
+    std::vector<float> ExtentY;
+    std::vector<float> ExtentZ;
+    std::vector<int> EmptyBounds; // indices of bounds that are always culled
+    std::vector<float> SortKeys;
+    int Count = 0;
+    bool SimdEnabled = true;
+};
+
+} // namespace OVRFW
@@ -0,0 +1,344 @@
+/*******************************************************************************
+
+Filename    :   GlDispatch.cpp
+Content     :   Optional dispatch table for the GL calls of the render core, with
+                native, null and capture implementations.
+Language    :   C++
+
+*******************************************************************************/
+
+#if defined(OVR_GL_DISPATCH)
+
+#define OVR_GL_DISPATCH_IMPLEMENTATION
+#include "Egl.h"
+
+#include <array>
+#include <cstring>
+#include <unordered_map>
+
+#include "Misc/Log.h"
+
+//==============================================================
+// Null implementation
+//==============================================================
+
+namespace {
+
+GLuint NullNextName = 1;
+GLint NullNextUniformLocation = 0;
+std::vector<unsigned char> NullMappedBuffer;
+
+// Does nothing and returns 0; the pointer type of the table member picks the parameters
+template <typename R, typename... Args>
+R GL_APIENTRY NullFunction(Args...) {
+    return R();
+}
+
+void GL_APIENTRY NullGenNames(GLsizei n, GLuint* names) {
+    for (GLsizei i = 0; i < n; i++) {
+        names[i] = NullNextName++;
+    }
+}
+
+GLuint GL_APIENTRY NullCreateProgram() {
+    return NullNextName++;
+}
+
+GLuint GL_APIENTRY NullCreateShader(GLenum) {
+    return NullNextName++;
+}
+
+// Shaders always compile and programs always link, with an empty info log
+void GL_APIENTRY NullGetShaderiv(GLuint, GLenum pname, GLint* params) {
+    *params = (pname == GL_COMPILE_STATUS) ? GL_TRUE : 0;
+}
+
+void GL_APIENTRY NullGetProgramiv(GLuint, GLenum pname, GLint* params) {
+    *params = (pname == GL_LINK_STATUS) ? GL_TRUE : 0;
+}
+
+void GL_APIENTRY NullGetInfoLog(GLuint, GLsizei bufSize, GLsizei* length, GLchar* infoLog) {
+    if (length != nullptr) {
+        *length = 0;
+    }
+    if (bufSize > 0) {
+        infoLog[0] = '\0';
+    }
+}
+
+// Every uniform exists, so the uniform paths of SurfaceRender are exercised
+GLint GL_APIENTRY NullGetUniformLocation(GLuint, const GLchar*) {
+    return NullNextUniformLocation++;
+}
+
+void* GL_APIENTRY NullMapBufferRange(GLenum, GLintptr, GLsizeiptr length, GLbitfield) {
+    if (NullMappedBuffer.size() < static_cast<size_t>(length)) {
+        NullMappedBuffer.resize(length);
+    }
+    return NullMappedBuffer.data();
+}
+
+GLboolean GL_APIENTRY NullUnmapBuffer(GLenum) {
+    return GL_TRUE;
+}
+
+const GLubyte* GL_APIENTRY NullGetString(GLenum) {
+    return reinterpret_cast<const GLubyte*>("");
+}
+
+ovrGlDispatch NullDispatch() {
+    ovrGlDispatch d;
+#define OVR_GL_NULL_ENTRY(ret, name, params, args) d.name = NullFunction<ret>;
+    OVR_GL_DISPATCH_FUNCTIONS(OVR_GL_NULL_ENTRY)
+#undef OVR_GL_NULL_ENTRY
+    d.CreateProgram = NullCreateProgram;
+    d.CreateShader = NullCreateShader;
+    d.GenBuffers = NullGenNames;
+    d.GenVertexArrays = NullGenNames;
+    d.GetProgramInfoLog = NullGetInfoLog;
+    d.GetProgramiv = NullGetProgramiv;
+    d.GetShaderInfoLog = NullGetInfoLog;
+    d.GetShaderiv = NullGetShaderiv;
+    d.GetString = NullGetString;
+    d.GetUniformLocation = NullGetUniformLocation;
+    d.MapBufferRange = NullMapBufferRange;
+    d.UnmapBuffer = NullUnmapBuffer;
+    return d;
+}
+
+//==============================================================
+// Capture implementation
+//==============================================================
+
+OVRFW::ovrGlCapture* ActiveCapture = nullptr;
+ovrGlDispatch CapturedDispatch; // the table the capture forwards to
+
+// Integers as is, floats bit-cast, pointers as 0
+template <typename T>
+uint64_t ArgBits(T value) {
+    return static_cast<uint64_t>(value);
+}
+
+uint64_t ArgBits(GLfloat value) {
+    uint32_t bits = 0;
+    memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+template <typename T>
+uint64_t ArgBits(T*) {
+    return 0;
+}
+
+void StoreArgs(OVRFW::ovrGlCall&) {}
+
+template <typename T, typename... Rest>
+void StoreArgs(OVRFW::ovrGlCall& call, T value, Rest... rest) {
+    if (call.ArgCount < OVRFW::ovrGlCall::MAX_ARGS) {
+        call.Args[call.ArgCount++] = ArgBits(value);
+    }
+    StoreArgs(call, rest...);
+}
+
+// CaptureCall<OVR_GL_Name>(arguments), so the argument list of the X macro can be reused
+template <ovrGlFunction Function, typename... Args>
+void CaptureCall(Args... args) {
+    OVRFW::ovrGlCall call;
+    call.Function = static_cast<uint16_t>(Function);
+    StoreArgs(call, args...);
+    ActiveCapture->Record(call);
+}
+
+#define OVR_GL_CAPTURE_FUNCTION(ret, name, params, args) \
+    ret GL_APIENTRY Capture##name params {               \
+        CaptureCall<OVR_GL_##name> args;                 \
+        return CapturedDispatch.name args;               \
+    }
+OVR_GL_DISPATCH_FUNCTIONS(OVR_GL_CAPTURE_FUNCTION)
+#undef OVR_GL_CAPTURE_FUNCTION
+
+ovrGlDispatch CaptureDispatch() {
+    ovrGlDispatch d;
+#define OVR_GL_CAPTURE_ENTRY(ret, name, params, args) d.name = Capture##name;
+    OVR_GL_DISPATCH_FUNCTIONS(OVR_GL_CAPTURE_ENTRY)
+#undef OVR_GL_CAPTURE_ENTRY
+    return d;
+}
+
+const char* const FunctionNames[OVR_GL_FUNCTION_COUNT] = {
+#define OVR_GL_FUNCTION_NAME(ret, name, params, args) "gl" #name,
+    OVR_GL_DISPATCH_FUNCTIONS(OVR_GL_FUNCTION_NAME)
+#undef OVR_GL_FUNCTION_NAME
+};
+
+} // namespace
+
+//==============================================================
+// ovrGlDispatch
+//==============================================================
+
+ovrGlDispatch ovrGl = NullDispatch();
+
+const char* ovrGlDispatch_FunctionName(ovrGlFunction function) {
+    return (function >= 0 && function < OVR_GL_FUNCTION_COUNT) ? FunctionNames[function]
+                                                                : "unknown";
+}
+
+void ovrGlDispatch_UseNull(void) {
+    ovrGl = NullDispatch();
+}
+
+#if defined(ANDROID) || defined(WIN32)
+void ovrGlDispatch_UseNative(void) {
+    // On Windows the gl names are the pointers GlWrapperWin32 loaded for the context
+#define OVR_GL_NATIVE_ENTRY(ret, name, params, args) ovrGl.name = gl##name;
+    OVR_GL_DISPATCH_FUNCTIONS(OVR_GL_NATIVE_ENTRY)
+#undef OVR_GL_NATIVE_ENTRY
+}
+#endif // defined(ANDROID) || defined(WIN32)
+
+namespace OVRFW {
+
+//==============================================================
+// ovrGlCapture
+//==============================================================
+
+ovrGlCapture::~ovrGlCapture() {
+    End();
+}
+
+void ovrGlCapture::Begin(bool recordCalls) {
+    if (Active) {
+        return;
+    }
+    if (ActiveCapture != nullptr) {
+        ALOGW("ovrGlCapture: another capture is active");
+        return;
+    }
+    RecordCalls = recordCalls;
+    CapturedDispatch = ovrGl;
+    ActiveCapture = this;
+    ovrGl = CaptureDispatch();
+    Active = true;
+}
+
+void ovrGlCapture::End() {
+    if (!Active) {
+        return;
+    }
+    ovrGl = CapturedDispatch;
+    ActiveCapture = nullptr;
+    Active = false;
+}
+
+bool ovrGlCapture::IsCapturing() const {
+    return Active;
+}
+
+void ovrGlCapture::Clear() {
+    memset(Counts, 0, sizeof(Counts));
+    Calls.clear();
+}
+
+uint64_t ovrGlCapture::GetTotalCallCount() const {
+    uint64_t total = 0;
+    for (int i = 0; i < OVR_GL_FUNCTION_COUNT; i++) {
+        total += Counts[i];
+    }
+    return total;
+}
+
+void ovrGlCapture::Record(const ovrGlCall& call) {
+    Counts[call.Function]++;
+    if (RecordCalls) {
+        Calls.push_back(call);
+    }
+}
+
+static uint64_t StateKey(ovrGlFunction function, uint64_t selector0 = 0, uint64_t selector1 = 0) {
+    return (uint64_t(function) << 48) | ((selector0 & 0xFFFFFF) << 24) | (selector1 & 0xFFFFFF);
+}
+
+uint64_t ovrGlCapture::CountRedundantStateCalls() const {
+    typedef std::array<uint64_t, ovrGlCall::MAX_ARGS> ovrStateValue;
+    std::unordered_map<uint64_t, ovrStateValue> state;
+    uint64_t activeTexture = GL_TEXTURE0;
+    uint64_t redundant = 0;
+
+    for (const ovrGlCall& call : Calls) {
+        const uint64_t* a = call.Args;
+        uint64_t key = 0;
+        ovrStateValue value = {};
+        switch (call.Function) {
+            case OVR_GL_UseProgram:
+            case OVR_GL_ActiveTexture:
+            case OVR_GL_DepthFunc:
+            case OVR_GL_DepthMask:
+            case OVR_GL_FrontFace:
+            case OVR_GL_LineWidth:
+                key = StateKey(ovrGlFunction(call.Function));
+                value[0] = a[0];
+                break;
+            case OVR_GL_BindVertexArray:
+                key = StateKey(OVR_GL_BindVertexArray);
+                value[0] = a[0];
+                if (state.count(key) == 0 || state[key] != value) {
+                    // The element array binding is part of the vertex array object
+                    state.erase(StateKey(OVR_GL_BindBuffer, GL_ELEMENT_ARRAY_BUFFER));
+                }
+                break;
+            case OVR_GL_BindTexture: // per unit and target
+                key = StateKey(OVR_GL_BindTexture, activeTexture, a[0]);
+                value[0] = a[1];
+                break;
+            case OVR_GL_Enable:
+            case OVR_GL_Disable:
+                key = StateKey(OVR_GL_Enable, a[0]);
+                value[0] = (call.Function == OVR_GL_Enable);
+                break;
+            case OVR_GL_BindBuffer:
+                key = StateKey(OVR_GL_BindBuffer, a[0]);
+                value[0] = a[1];
+                break;
+            case OVR_GL_BindBufferBase: // per target and index, also sets the generic binding
+                key = StateKey(OVR_GL_BindBufferBase, a[0], a[1]);
+                value[0] = a[2];
+                state[StateKey(OVR_GL_BindBuffer, a[0])] = {a[2]};
+                break;
+            case OVR_GL_BlendEquation:
+            case OVR_GL_BlendEquationSeparate:
+                key = StateKey(OVR_GL_BlendEquationSeparate);
+                value[0] = a[0];
+                value[1] = (call.Function == OVR_GL_BlendEquation) ? a[0] : a[1];
+                break;
+            case OVR_GL_BlendFunc:
+                key = StateKey(OVR_GL_BlendFuncSeparate);
+                value = {a[0], a[1], a[0], a[1]};
+                break;
+            case OVR_GL_BlendFuncSeparate:
+            case OVR_GL_ColorMask:
+            case OVR_GL_PolygonOffset:
+            case OVR_GL_DepthRangef:
+                key = StateKey(ovrGlFunction(call.Function));
+                value = {a[0], a[1], a[2], a[3]};
+                break;
+            default:
+                continue;
+        }
+
+        auto it = state.find(key);
+        if (it != state.end() && it->second == value) {
+            redundant++;
+        } else {
+            state[key] = value;
+        }
+        if (call.Function == OVR_GL_ActiveTexture) {
+            activeTexture = a[0];
+        }
+    }
+    return redundant;
+}
+
+} // namespace OVRFW
+
+#endif // defined(OVR_GL_DISPATCH)
@@ -0,0 +1,341 @@
+/*******************************************************************************
+
+Filename    :   GlDispatch.h
+Content     :   Optional dispatch table for the GL calls of the render core, with
+                native, null and capture implementations.
+Language    :   C99 / C++
+
+*******************************************************************************/
+
+#pragma once
+
+// Built with OVR_GL_DISPATCH (CMake option SAMPLEXR_GL_DISPATCH), every translation unit
+// that includes Egl.h calls the entry points below through the ovrGl table instead of
+// the driver. The table can point at:
+//
+//   native   the real GL functions; installed by ovrEgl_CreateContext on Android and
+//            Windows, so a dispatch build behaves like a normal one on device.
+//   null     no-ops that hand out object names, report successful compiles and links
+//            and map buffers to scratch memory. The default, so SurfaceRender, GlProgram,
+//            GlGeometry and GlBuffer run without a GPU or a context.
+//   capture  OVRFW::ovrGlCapture, which records the call stream and per-function counts
+//            and forwards to whichever table was installed before it.
+//
+// Only the entry points of the render core are in the table; anything else still calls
+// the driver directly. Without OVR_GL_DISPATCH this header adds nothing.
+
+#if defined(OVR_GL_DISPATCH)
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+// X(returnType, Name, (parameters), (arguments)) for each glName in the table
+#define OVR_GL_DISPATCH_FUNCTIONS(X)                                                      \
+    X(void, ActiveTexture, (GLenum texture), (texture))                                    \
+    X(void, AttachShader, (GLuint program, GLuint shader), (program, shader))              \
+    X(void,                                                                                \
+      BindAttribLocation,                                                                  \
+      (GLuint program, GLuint index, const GLchar* name),                                  \
+      (program, index, name))                                                              \
+    X(void, BindBuffer, (GLenum target, GLuint buffer), (target, buffer))                  \
+    X(void,                                                                                \
+      BindBufferBase,                                                                      \
+      (GLenum target, GLuint index, GLuint buffer),                                        \
+      (target, index, buffer))                                                             \
+    X(void, BindTexture, (GLenum target, GLuint texture), (target, texture))               \
+    X(void, BindVertexArray, (GLuint array), (array))                                      \
+    X(void, BlendEquation, (GLenum mode), (mode))                                          \
+    X(void,                                                                                \
+      BlendEquationSeparate,                                                               \
+      (GLenum modeRGB, GLenum modeAlpha),                                                  \
+      (modeRGB, modeAlpha))                                                                \
+    X(void, BlendFunc, (GLenum sfactor, GLenum dfactor), (sfactor, dfactor))               \
+    X(void,                                                                                \
+      BlendFuncSeparate,                                                                   \
+      (GLenum srcRGB, GLenum dstRGB, GLenum srcAlpha, GLenum dstAlpha),                    \
+      (srcRGB, dstRGB, srcAlpha, dstAlpha))                                                \
+    X(void,                                                                                \
+      BufferData,                                                                          \
+      (GLenum target, GLsizeiptr size, const void* data, GLenum usage),                    \
+      (target, size, data, usage))                                                         \
+    X(void,                                                                                \
+      BufferSubData,                                                                       \
+      (GLenum target, GLintptr offset, GLsizeiptr size, const void* data),                 \
+      (target, offset, size, data))                                                        \
+    X(void,                                                                                \
+      ColorMask,                                                                           \
+      (GLboolean red, GLboolean green, GLboolean blue, GLboolean alpha),                   \
+      (red, green, blue, alpha))                                                           \
+    X(void, CompileShader, (GLuint shader), (shader))                                      \
+    X(GLuint, CreateProgram, (void), ())                                                   \
+    X(GLuint, CreateShader, (GLenum type), (type))                                         \
+    X(void, DeleteBuffers, (GLsizei n, const GLuint* buffers), (n, buffers))               \
+    X(void, DeleteProgram, (GLuint program), (program))                                    \
+    X(void, DeleteShader, (GLuint shader), (shader))                                       \
+    X(void, DeleteVertexArrays, (GLsizei n, const GLuint* arrays), (n, arrays))            \
+    X(void, DepthFunc, (GLenum func), (func))                                              \
+    X(void, DepthMask, (GLboolean flag), (flag))                                           \
+    X(void, DepthRangef, (GLfloat n, GLfloat f), (n, f))                                   \
+    X(void, Disable, (GLenum cap), (cap))                                                  \
+    X(void, DisableVertexAttribArray, (GLuint index), (index))                             \
+    X(void,                                                                                \
+      DrawElements,                                                                        \
+      (GLenum mode, GLsizei count, GLenum type, const void* indices),                      \
+      (mode, count, type, indices))                                                        \
+    X(void,                                                                                \
+      DrawElementsInstanced,                                                               \
+      (GLenum mode, GLsizei count, GLenum type, const void* indices, GLsizei instancecount), \
+      (mode, count, type, indices, instancecount))                                         \
+    X(void, Enable, (GLenum cap), (cap))                                                   \
+    X(void, EnableVertexAttribArray, (GLuint index), (index))                              \
+    X(void, Finish, (void), ())                                                            \
+    X(void, Flush, (void), ())                                                             \
+    X(void, FrontFace, (GLenum mode), (mode))                                              \
+    X(void, GenBuffers, (GLsizei n, GLuint * buffers), (n, buffers))                       \
+    X(void, GenVertexArrays, (GLsizei n, GLuint * arrays), (n, arrays))                    \
+    X(GLenum, GetError, (void), ())                                                        \
+    X(void,                                                                                \
+      GetProgramInfoLog,                                                                   \
+      (GLuint program, GLsizei bufSize, GLsizei * length, GLchar * infoLog),               \
+      (program, bufSize, length, infoLog))                                                 \
+    X(void,                                                                                \
+      GetProgramiv,                                                                        \
+      (GLuint program, GLenum pname, GLint * params),                                      \
+      (program, pname, params))                                                            \
+    X(void,                                                                                \
+      GetShaderInfoLog,                                                                    \
+      (GLuint shader, GLsizei bufSize, GLsizei * length, GLchar * infoLog),                \
+      (shader, bufSize, length, infoLog))                                                  \
+    X(void,                                                                                \
+      GetShaderiv,                                                                         \
+      (GLuint shader, GLenum pname, GLint * params),                                       \
+      (shader, pname, params))                                                             \
+    X(const GLubyte*, GetString, (GLenum name), (name))                                    \
+    X(GLuint,                                                                              \
+      GetUniformBlockIndex,                                                                \
+      (GLuint program, const GLchar* uniformBlockName),                                    \
+      (program, uniformBlockName))                                                         \
+    X(GLint, GetUniformLocation, (GLuint program, const GLchar* name), (program, name))    \
+    X(void, LineWidth, (GLfloat width), (width))                                           \
+    X(void, LinkProgram, (GLuint program), (program))                                      \
+    X(void*,                                                                               \
+      MapBufferRange,                                                                      \
+      (GLenum target, GLintptr offset, GLsizeiptr length, GLbitfield access),              \
+      (target, offset, length, access))                                                    \
+    X(void, PolygonOffset, (GLfloat factor, GLfloat units), (factor, units))               \
+    X(void,                                                                                \
+      ShaderSource,                                                                        \
+      (GLuint shader, GLsizei count, const GLchar* const* string, const GLint* length),    \
+      (shader, count, string, length))                                                     \
+    X(void, Uniform1f, (GLint location, GLfloat v0), (location, v0))                       \
+    X(void, Uniform1i, (GLint location, GLint v0), (location, v0))                         \
+    X(void,                                                                                \
+      Uniform1iv,                                                                          \
+      (GLint location, GLsizei count, const GLint* value),                                 \
+      (location, count, value))                                                            \
+    X(void,                                                                                \
+      Uniform2fv,                                                                          \
+      (GLint location, GLsizei count, const GLfloat* value),                               \
+      (location, count, value))                                                            \
+    X(void,                                                                                \
+      Uniform2iv,                                                                          \
+      (GLint location, GLsizei count, const GLint* value),                                 \
+      (location, count, value))                                                            \
+    X(void,                                                                                \
+      Uniform3fv,                                                                          \
+      (GLint location, GLsizei count, const GLfloat* value),                               \
+      (location, count, value))                                                            \
+    X(void,                                                                                \
+      Uniform3iv,                                                                          \
+      (GLint location, GLsizei count, const GLint* value),                                 \
+      (location, count, value))                                                            \
+    X(void,                                                                                \
+      Uniform4fv,                                                                          \
+      (GLint location, GLsizei count, const GLfloat* value),                               \
+      (location, count, value))                                                            \
+    X(void,                                                                                \
+      Uniform4iv,                                                                          \
+      (GLint location, GLsizei count, const GLint* value),                                 \
+      (location, count, value))                                                            \
+    X(void,                                                                                \
+      UniformBlockBinding,                                                                 \
+      (GLuint program, GLuint uniformBlockIndex, GLuint uniformBlockBinding),              \
+      (program, uniformBlockIndex, uniformBlockBinding))                                   \
+    X(void,                                                                                \
+      UniformMatrix4fv,                                                                    \
+      (GLint location, GLsizei count, GLboolean transpose, const GLfloat* value),          \
+      (location, count, transpose, value))                                                 \
+    X(GLboolean, UnmapBuffer, (GLenum target), (target))                                   \
+    X(void, UseProgram, (GLuint program), (program))                                       \
+    X(void,                                                                                \
+      VertexAttribPointer,                                                                 \
+      (GLuint index,                                                                       \
+       GLint size,                                                                         \
+       GLenum type,                                                                        \
+       GLboolean normalized,                                                               \
+       GLsizei stride,                                                                     \
+       const void* pointer),                                                               \
+      (index, size, type, normalized, stride, pointer))
+
+typedef enum {
+#define OVR_GL_DISPATCH_ENUM(ret, name, params, args) OVR_GL_##name,
+    OVR_GL_DISPATCH_FUNCTIONS(OVR_GL_DISPATCH_ENUM)
+#undef OVR_GL_DISPATCH_ENUM
+        OVR_GL_FUNCTION_COUNT
+} ovrGlFunction;
+
+typedef struct {
+#define OVR_GL_DISPATCH_MEMBER(ret, name, params, args) ret(GL_APIENTRY* name) params;
+    OVR_GL_DISPATCH_FUNCTIONS(OVR_GL_DISPATCH_MEMBER)
+#undef OVR_GL_DISPATCH_MEMBER
+} ovrGlDispatch;
+
+// The table the render core calls through. Only touch it from the GL thread.
+extern ovrGlDispatch ovrGl;
+
+// "glUseProgram" for OVR_GL_UseProgram
+const char* ovrGlDispatch_FunctionName(ovrGlFunction function);
+
+void ovrGlDispatch_UseNull(void);
+#if defined(ANDROID) || defined(WIN32)
+// Needs a current context on Windows, where the entry points are loaded at runtime
+void ovrGlDispatch_UseNative(void);
+#endif // defined(ANDROID) || defined(WIN32)
+
+#if defined(__cplusplus)
+} // extern "C"
+#endif
+
+// The implementation needs the real names to build the native table
+#if !defined(OVR_GL_DISPATCH_IMPLEMENTATION)
+#define glActiveTexture ovrGl.ActiveTexture
+#define glAttachShader ovrGl.AttachShader
+#define glBindAttribLocation ovrGl.BindAttribLocation
+#define glBindBuffer ovrGl.BindBuffer
+#define glBindBufferBase ovrGl.BindBufferBase
+#define glBindTexture ovrGl.BindTexture
+#define glBindVertexArray ovrGl.BindVertexArray
+#define glBlendEquation ovrGl.BlendEquation
+#define glBlendEquationSeparate ovrGl.BlendEquationSeparate
+#define glBlendFunc ovrGl.BlendFunc
+#define glBlendFuncSeparate ovrGl.BlendFuncSeparate
+#define glBufferData ovrGl.BufferData
+#define glBufferSubData ovrGl.BufferSubData
+#define glColorMask ovrGl.ColorMask
+#define glCompileShader ovrGl.CompileShader
+#define glCreateProgram ovrGl.CreateProgram
+#define glCreateShader ovrGl.CreateShader
+#define glDeleteBuffers ovrGl.DeleteBuffers
+#define glDeleteProgram ovrGl.DeleteProgram
+#define glDeleteShader ovrGl.DeleteShader
+#define glDeleteVertexArrays ovrGl.DeleteVertexArrays
+#define glDepthFunc ovrGl.DepthFunc
+#define glDepthMask ovrGl.DepthMask
+#define glDepthRangef ovrGl.DepthRangef
+#define glDisable ovrGl.Disable
+#define glDisableVertexAttribArray ovrGl.DisableVertexAttribArray
+#define glDrawElements ovrGl.DrawElements
+#define glDrawElementsInstanced ovrGl.DrawElementsInstanced
+#define glEnable ovrGl.Enable
+#define glEnableVertexAttribArray ovrGl.EnableVertexAttribArray
+#define glFinish ovrGl.Finish
+#define glFlush ovrGl.Flush
+#define glFrontFace ovrGl.FrontFace
+#define glGenBuffers ovrGl.GenBuffers
+#define glGenVertexArrays ovrGl.GenVertexArrays
+#define glGetError ovrGl.GetError
+#define glGetProgramInfoLog ovrGl.GetProgramInfoLog
+#define glGetProgramiv ovrGl.GetProgramiv
+#define glGetShaderInfoLog ovrGl.GetShaderInfoLog
+#define glGetShaderiv ovrGl.GetShaderiv
+#define glGetString ovrGl.GetString
+#define glGetUniformBlockIndex ovrGl.GetUniformBlockIndex
+#define glGetUniformLocation ovrGl.GetUniformLocation
+#define glLineWidth ovrGl.LineWidth
+#define glLinkProgram ovrGl.LinkProgram
+#define glMapBufferRange ovrGl.MapBufferRange
+#define glPolygonOffset ovrGl.PolygonOffset
+#define glShaderSource ovrGl.ShaderSource
+#define glUniform1f ovrGl.Uniform1f
+#define glUniform1i ovrGl.Uniform1i
+#define glUniform1iv ovrGl.Uniform1iv
+#define glUniform2fv ovrGl.Uniform2fv
+#define glUniform2iv ovrGl.Uniform2iv
+#define glUniform3fv ovrGl.Uniform3fv
+#define glUniform3iv ovrGl.Uniform3iv
+#define glUniform4fv ovrGl.Uniform4fv
+#define glUniform4iv ovrGl.Uniform4iv
+#define glUniformBlockBinding ovrGl.UniformBlockBinding
+#define glUniformMatrix4fv ovrGl.UniformMatrix4fv
+#define glUnmapBuffer ovrGl.UnmapBuffer
+#define glUseProgram ovrGl.UseProgram
+#define glVertexAttribPointer ovrGl.VertexAttribPointer
+#endif // !defined(OVR_GL_DISPATCH_IMPLEMENTATION)
+
+#if defined(__cplusplus)
+
+#include <cstdint>
+#include <vector>
+
+namespace OVRFW {
+
+// One captured call: the function and its first arguments as raw bits (integers as
+// is, floats bit-cast, pointers as 0 so two runs of the same frame compare equal)
+struct ovrGlCall {
+    static const int MAX_ARGS = 4;
+
+    uint16_t Function = 0; // ovrGlFunction
+    uint16_t ArgCount = 0;
+    uint64_t Args[MAX_ARGS] = {};
+};
+
+// Records the GL calls of the render core between Begin and End. Counting only is
+// cheap enough to leave on for a whole benchmark; the call stream grows with every
+// call, so record it for a frame or two.
+class ovrGlCapture {
+   public:
+    ovrGlCapture() = default;
+    ~ovrGlCapture();
+
+    ovrGlCapture(const ovrGlCapture&) = delete;
+    ovrGlCapture& operator=(const ovrGlCapture&) = delete;
+
+    // Routes ovrGl through this capture, forwarding to the table installed now.
+    // One capture at a time.
+    void Begin(bool recordCalls = true);
+    // Puts back the table Begin replaced
+    void End();
+    bool IsCapturing() const;
+
+    void Clear();
+
+    uint64_t GetCallCount(ovrGlFunction function) const {
+        return Counts[function];
+    }
+    uint64_t GetTotalCallCount() const;
+    const std::vector<ovrGlCall>& GetCalls() const {
+        return Calls;
+    }
+
+    // Recorded calls that set a piece of state to the value it already had: program,
+    // vertex array, active texture unit, texture per unit and target, buffer bindings,
+    // enables, blend, depth, color mask, front face, polygon offset and line width.
+    // A call that changes the state and one that changes it back both count as needed.
+    uint64_t CountRedundantStateCalls() const;
+
+    // Called by the capture table
+    void Record(const ovrGlCall& call);
+
+   private:
+    uint64_t Counts[OVR_GL_FUNCTION_COUNT] = {};
+    std::vector<ovrGlCall> Calls;
+    bool RecordCalls = true;
+    bool Active = false;
+};
+
+} // namespace OVRFW
+
+#endif // defined(__cplusplus)
+
+#endif // defined(OVR_GL_DISPATCH)
@@ -40,6 +40,7 @@ Authors     :   John Carmack
 
 namespace OVRFW {
 static bool UseMultiview = false;
+static uint32_t ProgramFreeCount = 0;
 
 GlProgram::MultiViewScope::MultiViewScope(bool enableMultView) {
     wasEnabled = UseMultiview;
@@ -49,12 +50,18 @@ GlProgram::MultiViewScope::~MultiViewScope() {
     GlProgram::SetUseMultiview(wasEnabled);
 }
 
+const char* const GlProgram::INSTANCED_VERTEX_DIRECTIVES =
+    "#define INSTANCED_MODEL_MATRIX 1\n#define MAX_INSTANCES 256\n";
+
 // All GlPrograms implicitly get the VertexHeader
 static const char* VertexHeader =
     R"glsl(
 #ifndef DISABLE_MULTIVIEW
  #define DISABLE_MULTIVIEW 0
 #endif
+#ifndef INSTANCED_MODEL_MATRIX
+ #define INSTANCED_MODEL_MATRIX 0
+#endif
 #define NUM_VIEWS 2
 #define attribute in
 #define varying out
@@ -67,7 +74,17 @@ static const char* VertexHeader =
   #define VIEW_ID ViewID
 #endif
 
+#if INSTANCED_MODEL_MATRIX
+// One model matrix per instance, so surfaces that only differ in their transform can be
+// drawn with a single instanced draw. See ovrInstanceBatcher.
+uniform InstanceMatrices
+{
+	highp mat4 InstanceModelMatrix[MAX_INSTANCES];
+} im;
+#define ModelMatrix im.InstanceModelMatrix[gl_InstanceID]
+#else
 uniform highp mat4 ModelMatrix;
+#endif
 
 // Use a ubo in v300 path to workaround corruption issue on Adreno 420+v300
 // when uniform array of matrices used.
@@ -307,6 +324,15 @@ GlProgram GlProgram::Build(
             glUniformBlockBinding(p.Program, p.SceneMatrices.Location, p.SceneMatrices.Binding);
         }
 
+        p.InstanceMatrices.Type = ovrProgramParmType::BUFFER_UNIFORM;
+        p.InstanceMatrices.Location = glGetUniformBlockIndex(p.Program, "InstanceMatrices");
+        if (p.InstanceMatrices.Location >= 0) // only in INSTANCED_VERTEX_DIRECTIVES programs
+        {
+            p.InstanceMatrices.Binding = p.numUniformBufferBindings++;
+            glUniformBlockBinding(
+                p.Program, p.InstanceMatrices.Location, p.InstanceMatrices.Binding);
+        }
+
         p.ModelMatrix.Type = ovrProgramParmType::FLOAT_MATRIX4;
         p.ModelMatrix.Location = glGetUniformLocation(p.Program, "ModelMatrix");
         p.ModelMatrix.Binding = p.ModelMatrix.Location;
@@ -367,6 +393,7 @@ void GlProgram::Free(GlProgram& prog) {
     glUseProgram(0);
     if (prog.Program != 0) {
         glDeleteProgram(prog.Program);
+        ProgramFreeCount++;
     }
     if (prog.VertexShader != 0) {
         glDeleteShader(prog.VertexShader);
@@ -379,6 +406,10 @@ void GlProgram::Free(GlProgram& prog) {
     prog.FragmentShader = 0;
 }
 
+uint32_t GlProgram::GetFreeCount() {
+    return ProgramFreeCount;
+}
+
 void GlProgram::SetUseMultiview(const bool useMultiview_) {
     UseMultiview = useMultiview_;
 }
@@ -148,6 +148,9 @@ struct GlProgram {
         bool abortOnError = true);
 
     static void Free(GlProgram& program);
+    // Number of programs deleted by Free, so caches keyed by program name can drop
+    // entries whose name may have been reused.
+    static uint32_t GetFreeCount();
 
     static void SetUseMultiview(const bool useMultiview_);
 
@@ -158,6 +161,12 @@ struct GlProgram {
     static const int MAX_VIEWS = 2;
     static const int SCENE_MATRICES_UBO_SIZE = 2 * sizeof(OVR::Matrix4f) * MAX_VIEWS;
 
+    // Vertex directives for an instanced variant of a program: ModelMatrix is read per
+    // gl_InstanceID from the InstanceMatrices ubo instead of the uniform. The variant must be
+    // built with the same parms as the original, so their UniformData lines up.
+    static const char* const INSTANCED_VERTEX_DIRECTIVES;
+    static const int MAX_INSTANCES = 256; // 16KB, the minimum GL_MAX_UNIFORM_BLOCK_SIZE
+
     unsigned int Program;
     unsigned int VertexShader;
     unsigned int FragmentShader;
@@ -165,6 +174,7 @@ struct GlProgram {
     // Globally-defined system level uniforms.
     ovrUniform ViewID; // uniform for ViewID; is -1 if OVR_multiview unavailable or disabled
     ovrUniform ModelMatrix; // uniform for "uniform mat4 ModelMatrix;"
+    ovrUniform InstanceMatrices; // "InstanceMatrices" ubo of instanced variants, else -1
     ovrUniform SceneMatrices; // uniform for "SceneMatrices" ubo :
                               // uniform SceneMatrices {
                               //   mat4 ViewMatrix[NUM_VIEWS];
@@ -196,6 +206,8 @@ struct ovrGraphicsCommand {
     ovrUniformData
         UniformData[ovrUniform::MAX_UNIFORMS]; // data matching the types in Program.Uniforms[]
     GlTexture Textures[ovrGraphicsCommand::MAX_TEXTURES];
+    // GlBuffer with one transposed model matrix per instance, for Program.InstanceMatrices
+    ovrUniformData InstanceMatrices;
 
     void BindUniformTextures();
 };
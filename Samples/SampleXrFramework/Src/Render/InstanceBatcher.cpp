@@ -0,0 +1,251 @@
+/*******************************************************************************
+
+Filename    :   InstanceBatcher.cpp
+Content     :   Merges repeated opaque surfaces of a draw list into instanced draws.
+Language    :   C++
+
+*******************************************************************************/
+
+#include "InstanceBatcher.h"
+
+#include <cstring>
+
+#include "GlTexture.h"
+
+using OVR::Matrix4f;
+
+namespace OVRFW {
+
+// What a uniform binds, so surfaces with their own copy of the same texture still match
+static uintptr_t UniformIdentity(const ovrGraphicsCommand& cmd, const int index) {
+    const void* data = cmd.UniformData[index].Data;
+    if (data == nullptr) {
+        return 0;
+    }
+    switch (cmd.Program.Uniforms[index].Type) {
+        case ovrProgramParmType::TEXTURE_SAMPLED:
+            return static_cast<const GlTexture*>(data)->texture;
+        case ovrProgramParmType::BUFFER_UNIFORM:
+            return static_cast<const GlBuffer*>(data)->GetBuffer();
+        default:
+            return reinterpret_cast<uintptr_t>(data);
+    }
+}
+
+static bool SameGpuState(const ovrGpuState& a, const ovrGpuState& b) {
+    return a.blendMode == b.blendMode && a.blendSrc == b.blendSrc && a.blendDst == b.blendDst &&
+        a.blendSrcAlpha == b.blendSrcAlpha && a.blendDstAlpha == b.blendDstAlpha &&
+        a.blendModeAlpha == b.blendModeAlpha && a.depthFunc == b.depthFunc &&
+        a.frontFace == b.frontFace && a.polygonMode == b.polygonMode &&
+        a.blendEnable == b.blendEnable && a.depthEnable == b.depthEnable &&
+        a.depthMaskEnable == b.depthMaskEnable &&
+        memcmp(a.colorMaskEnable, b.colorMaskEnable, sizeof(a.colorMaskEnable)) == 0 &&
+        a.polygonOffsetEnable == b.polygonOffsetEnable && a.cullEnable == b.cullEnable &&
+        a.lineWidth == b.lineWidth && a.depthRange[0] == b.depthRange[0] &&
+        a.depthRange[1] == b.depthRange[1];
+}
+
+static bool SameBatch(const ovrSurfaceDef& a, const ovrSurfaceDef& b) {
+    if (&a == &b) {
+        return true;
+    }
+    const ovrGraphicsCommand& ca = a.graphicsCommand;
+    const ovrGraphicsCommand& cb = b.graphicsCommand;
+    if (a.geo.vertexArrayObject != b.geo.vertexArrayObject ||
+        a.geo.indexCount != b.geo.indexCount || a.geo.primitiveType != b.geo.primitiveType ||
+        ca.Program.Program != cb.Program.Program || !SameGpuState(ca.GpuState, cb.GpuState)) {
+        return false;
+    }
+    for (int i = 0; i < ovrUniform::MAX_UNIFORMS; i++) {
+        if (ca.Program.Uniforms[i].Type == ovrProgramParmType::MAX) {
+            break;
+        }
+        if (UniformIdentity(ca, i) != UniformIdentity(cb, i) ||
+            ca.UniformData[i].Count != cb.UniformData[i].Count) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static uint64_t HashBatch(const ovrSurfaceDef& surface) {
+    const ovrGraphicsCommand& cmd = surface.graphicsCommand;
+    uint64_t hash = 14695981039346656037ull;
+    auto mix = [&hash](const uint64_t value) { hash = (hash ^ value) * 1099511628211ull; };
+    mix(surface.geo.vertexArrayObject);
+    mix(surface.geo.indexCount);
+    mix(cmd.Program.Program);
+    for (int i = 0; i < ovrUniform::MAX_UNIFORMS; i++) {
+        if (cmd.Program.Uniforms[i].Type == ovrProgramParmType::MAX) {
+            break;
+        }
+        mix(UniformIdentity(cmd, i));
+    }
+    return hash ^ (hash >> 29);
+}
+
+void ovrInstanceBatcher::Shutdown() {
+    for (std::vector<std::unique_ptr<ovrInstanceBatch>>& batches : Batches) {
+        for (std::unique_ptr<ovrInstanceBatch>& batch : batches) {
+            batch->Matrices.Destroy();
+        }
+        batches.clear();
+    }
+}
+
+void ovrInstanceBatcher::ReserveFrameSets(const int numFrameSets) {
+    // New sets are empty, so adding them only delays the reuse of the others
+    if (numFrameSets > static_cast<int>(Batches.size())) {
+        Batches.resize(numFrameSets);
+    }
+}
+
+void ovrInstanceBatcher::FreeInstancedPrograms() {
+    for (auto& entry : InstancedPrograms) {
+        GlProgram::Free(entry.second);
+    }
+    InstancedPrograms.clear();
+}
+
+void ovrInstanceBatcher::SetInstancedProgram(
+    const GlProgram& program,
+    const GlProgram& instancedProgram) {
+    for (auto& entry : InstancedPrograms) {
+        if (entry.first == program.Program) {
+            entry.second = instancedProgram;
+            return;
+        }
+    }
+    InstancedPrograms.push_back(std::make_pair(program.Program, instancedProgram));
+}
+
+const GlProgram* ovrInstanceBatcher::FindInstancedProgram(const unsigned int program) const {
+    for (const auto& entry : InstancedPrograms) {
+        if (entry.first == program) {
+            return &entry.second;
+        }
+    }
+    return nullptr;
+}
+
+ovrInstanceBatcher::ovrInstanceBatch& ovrInstanceBatcher::GetBatch(const int index) {
+    std::vector<std::unique_ptr<ovrInstanceBatch>>& batches = Batches[FrameSet];
+    if (index >= static_cast<int>(batches.size())) {
+        batches.emplace_back(new ovrInstanceBatch());
+        batches.back()->Matrices.Create(
+            GLBUFFER_TYPE_UNIFORM, GlProgram::MAX_INSTANCES * sizeof(Matrix4f), nullptr);
+    }
+    return *batches[index];
+}
+
+// The current set was last drawn GetNumFrameSets() calls ago, so its extra buffers are idle
+void ovrInstanceBatcher::TrimFrameSet() {
+    std::vector<std::unique_ptr<ovrInstanceBatch>>& batches = Batches[FrameSet];
+    for (int i = NumBatches; i < static_cast<int>(batches.size()); i++) {
+        batches[i]->Matrices.Destroy();
+    }
+    if (static_cast<int>(batches.size()) > NumBatches) {
+        batches.resize(NumBatches);
+    }
+}
+
+void ovrInstanceBatcher::Batch(std::vector<ovrDrawSurface>& surfaceList) {
+    NumBatches = 0;
+    NumBatchedSurfaces = 0;
+    const int count = static_cast<int>(surfaceList.size());
+    if (InstancedPrograms.empty() || count < MinInstances) {
+        TrimFrameSet();
+        return;
+    }
+
+    // Group the candidates with an open addressing table over the first surface of each group
+    int tableSize = 64;
+    while (tableSize < count * 2) {
+        tableSize *= 2;
+    }
+    const int tableMask = tableSize - 1;
+    HashTable.assign(tableSize, -1);
+    GroupOf.assign(count, -1);
+    GroupNext.assign(count, -1);
+    GroupFirst.clear();
+    GroupCount.clear();
+    GroupLast.clear();
+
+    unsigned int lastProgram = 0;
+    bool lastProgramInstanced = false;
+    for (int i = 0; i < count; i++) {
+        const ovrSurfaceDef* surface = surfaceList[i].surface;
+        if (surface == nullptr || surface->numInstances > 1 ||
+            surface->graphicsCommand.GpuState.blendEnable != ovrGpuState::BLEND_DISABLE ||
+            surface->graphicsCommand.InstanceMatrices.Data != nullptr) {
+            continue;
+        }
+        const unsigned int program = surface->graphicsCommand.Program.Program;
+        if (program != lastProgram) {
+            lastProgram = program;
+            lastProgramInstanced = program != 0 && FindInstancedProgram(program) != nullptr;
+        }
+        if (!lastProgramInstanced) {
+            continue;
+        }
+
+        for (int slot = HashBatch(*surface) & tableMask;; slot = (slot + 1) & tableMask) {
+            const int group = HashTable[slot];
+            if (group < 0) {
+                HashTable[slot] = static_cast<int>(GroupFirst.size());
+                GroupOf[i] = HashTable[slot];
+                GroupFirst.push_back(i);
+                GroupCount.push_back(1);
+                GroupLast.push_back(i);
+                break;
+            }
+            if (SameBatch(*surfaceList[GroupFirst[group]].surface, *surface)) {
+                GroupOf[i] = group;
+                GroupNext[GroupLast[group]] = i;
+                GroupLast[group] = i;
+                GroupCount[group]++;
+                break;
+            }
+        }
+    }
+
+    // Each group replaces its first surface with one draw per MAX_INSTANCES surfaces
+    Output.clear();
+    for (int i = 0; i < count; i++) {
+        const int group = GroupOf[i];
+        if (group < 0 || GroupCount[group] < MinInstances) {
+            Output.push_back(surfaceList[i]);
+            continue;
+        }
+        if (GroupFirst[group] != i) {
+            continue;
+        }
+
+        const ovrSurfaceDef& first = *surfaceList[i].surface;
+        const GlProgram& instancedProgram =
+            *FindInstancedProgram(first.graphicsCommand.Program.Program);
+        for (int next = i; next >= 0;) {
+            TransposedMatrices.clear();
+            while (next >= 0 && TransposedMatrices.size() < GlProgram::MAX_INSTANCES) {
+                TransposedMatrices.push_back(surfaceList[next].modelMatrix.Transposed());
+                next = GroupNext[next];
+            }
+
+            ovrInstanceBatch& batch = GetBatch(NumBatches++);
+            batch.Matrices.Update(
+                TransposedMatrices.size() * sizeof(Matrix4f), TransposedMatrices.data());
+            batch.Surface = first;
+            batch.Surface.numInstances = static_cast<int>(TransposedMatrices.size());
+            batch.Surface.graphicsCommand.Program = instancedProgram;
+            batch.Surface.graphicsCommand.InstanceMatrices.Data = &batch.Matrices;
+            Output.push_back(ovrDrawSurface(&batch.Surface));
+        }
+        NumBatchedSurfaces += GroupCount[group];
+    }
+
+    surfaceList.swap(Output);
+    TrimFrameSet();
+    FrameSet = (FrameSet + 1) % static_cast<int>(Batches.size());
+}
+
+} // namespace OVRFW
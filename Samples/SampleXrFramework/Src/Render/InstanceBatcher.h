@@ -0,0 +1,112 @@
+/*******************************************************************************
+
+Filename    :   InstanceBatcher.h
+Content     :   Merges repeated opaque surfaces of a draw list into instanced draws.
+Language    :   C++
+
+*******************************************************************************/
+
+#pragma once
+
+#include <algorithm>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "OVR_Math.h"
+#include "GlBuffer.h"
+#include "GlProgram.h"
+#include "SurfaceRender.h"
+
+namespace OVRFW {
+
+// Runs on a finished surface list, after culling and sorting. Opaque surfaces that draw the
+// same geometry with the same program, GPU state and uniform data (typically several nodes
+// sharing one mesh) are replaced by one surface per group, drawn with numInstances and the
+// instanced variant of the program. The model matrices of the group go into a uniform
+// buffer that the variant reads per gl_InstanceID (GlProgram::INSTANCED_VERTEX_DIRECTIVES).
+//
+// Only programs with a registered variant are batched; everything else, transparent
+// surfaces and surfaces that already draw instances pass through in order. A group takes
+// the place of its first surface, which keeps the rough front to back order.
+//
+// Batch uploads the instance matrices, so it has to run on the thread with the GL context,
+// right before the list is rendered.
+//
+// The batched ovrSurfaceDefs and buffers belong to the batcher and are reused, with a
+// separate set for each of the last GetNumFrameSets() calls so a buffer the GPU may still
+// be reading is not overwritten right away. A set only keeps as many batches as its last
+// call used.
+class ovrInstanceBatcher {
+   public:
+    ovrInstanceBatcher() = default;
+
+    // Frees the instance buffers, needs the GL context
+    void Shutdown();
+
+    // Surfaces drawn with program are batched and drawn with instancedProgram, built from
+    // the same sources and parms plus GlProgram::INSTANCED_VERTEX_DIRECTIVES
+    void SetInstancedProgram(const GlProgram& program, const GlProgram& instancedProgram);
+    void ClearInstancedPrograms() {
+        InstancedPrograms.clear();
+    }
+    // For the owner of the variants: GlProgram::Free on each one, then clears them
+    void FreeInstancedPrograms();
+
+    // Keeps at least numFrameSets sets of buffers, one per frame the GPU may still be
+    // reading: GPU_FRAMES_IN_FLIGHT by default, plus the pipeline depth when frames are
+    // simulated ahead (XrApp::SetFramePipelineDepth). Never shrinks.
+    void ReserveFrameSets(const int numFrameSets);
+    int GetNumFrameSets() const {
+        return static_cast<int>(Batches.size());
+    }
+
+    // Groups smaller than this are left as separate draws
+    void SetMinInstances(const int minInstances) {
+        MinInstances = std::max(minInstances, 2);
+    }
+
+    // Rewrites surfaceList in place
+    void Batch(std::vector<ovrDrawSurface>& surfaceList);
+
+    // From the last Batch call
+    int GetNumBatches() const {
+        return NumBatches;
+    }
+    int GetNumBatchedSurfaces() const {
+        return NumBatchedSurfaces;
+    }
+
+    static const int GPU_FRAMES_IN_FLIGHT = 3;
+
+   private:
+
+    struct ovrInstanceBatch {
+        ovrSurfaceDef Surface;
+        GlBuffer Matrices;
+    };
+
+    const GlProgram* FindInstancedProgram(const unsigned int program) const;
+    ovrInstanceBatch& GetBatch(const int index);
+    void TrimFrameSet();
+
+    std::vector<std::pair<unsigned int, GlProgram>> InstancedPrograms;
+    std::vector<std::vector<std::unique_ptr<ovrInstanceBatch>>> Batches =
+        std::vector<std::vector<std::unique_ptr<ovrInstanceBatch>>>(GPU_FRAMES_IN_FLIGHT);
+    int FrameSet = 0;
+    int MinInstances = 2;
+    int NumBatches = 0;
+    int NumBatchedSurfaces = 0;
+
+    // Per call, kept for their capacity
+    std::vector<int> HashTable; // group index, or -1
+    std::vector<int> GroupOf; // per surface, or -1 when not batched
+    std::vector<int> GroupFirst; // first surface of each group
+    std::vector<int> GroupCount;
+    std::vector<int> GroupLast; // last surface of each group
+    std::vector<int> GroupNext; // per surface, next surface of the same group
+    std::vector<OVR::Matrix4f> TransposedMatrices;
+    std::vector<ovrDrawSurface> Output;
+};
+
+} // namespace OVRFW
@@ -0,0 +1,238 @@
+/*******************************************************************************
+
+Filename    :   PerfHud.cpp
+Content     :   Head-locked panel with frame timing, draw counters and app values.
+Language    :   C++
+
+*******************************************************************************/
+
+#include "PerfHud.h"
+
+#include <algorithm>
+#include <cstdio>
+
+#include "Misc/Log.h"
+#include "Render/BitmapFont.h"
+
+namespace OVRFW {
+
+static const int HUD_MAX_VERTICES = 8192;
+static const int HUD_MIN_LINES = 6; // lines are not made taller than for this many
+static const float HUD_MARGIN = 8.0f; // pixels
+
+static void
+FormatValue(char* buffer, size_t size, double value, ovrPerfHud::ovrValueFormat format) {
+    switch (format) {
+        case ovrPerfHud::VALUE_BYTES: {
+            static const char* const units[] = {"B", "KB", "MB", "GB"};
+            int unit = 0;
+            while (value >= 1024.0 && unit < 3) {
+                value /= 1024.0;
+                unit++;
+            }
+            snprintf(buffer, size, unit == 0 ? "%.0f %s" : "%.1f %s", value, units[unit]);
+            break;
+        }
+        case ovrPerfHud::VALUE_MS:
+            snprintf(buffer, size, "%.2f ms", value);
+            break;
+        default:
+            snprintf(buffer, size, "%.0f", value);
+            break;
+    }
+}
+
+bool ovrPerfHud::Init(
+    XrSession session,
+    ovrFileSys& fileSys,
+    ovrSurfaceRender& surfaceRender,
+    int width,
+    int height,
+    const char* fontUri) {
+    Shutdown();
+
+    Font = BitmapFont::Create();
+    if (!Font->Load(fileSys, fontUri)) {
+        ALOGE("ovrPerfHud: could not load font %s", fontUri);
+        Shutdown();
+        return false;
+    }
+    FontSurface = BitmapFontSurface::Create();
+    FontSurface->Init(HUD_MAX_VERTICES);
+
+    size_t len = 0;
+    float textWidth = 0.0f, textHeight = 0.0f, ascent = 0.0f, descent = 0.0f;
+    float lineWidth = 0.0f;
+    int numLines = 0;
+    Font->CalcTextMetrics(
+        "0", len, textWidth, textHeight, ascent, descent, FontHeight, &lineWidth, 1, numLines);
+    if (FontHeight <= 0.0f) {
+        ALOGE("ovrPerfHud: font %s has no line height", fontUri);
+        Shutdown();
+        return false;
+    }
+
+    if (!Overlay.Init(session, width, height)) {
+        Shutdown();
+        return false;
+    }
+    Overlay.SetClearColor(OVR::Vector4f(0.0f, 0.0f, 0.0f, 0.7f));
+    Overlay.SetRenderFunction([this](int w, int h) { RenderText(w, h); });
+
+    SurfaceRender = &surfaceRender;
+    Lines.clear();
+    LastRefreshNs = 0;
+    return true;
+}
+
+void ovrPerfHud::Shutdown() {
+    Overlay.Shutdown();
+    if (FontSurface != nullptr) {
+        BitmapFontSurface::Free(FontSurface);
+    }
+    if (Font != nullptr) {
+        BitmapFont::Free(Font);
+    }
+    SurfaceRender = nullptr;
+    Surfaces.clear();
+}
+
+void ovrPerfHud::AddValue(const std::string& label, ValueFunction value, ovrValueFormat format) {
+    Values.push_back({label, std::move(value), format});
+}
+
+void ovrPerfHud::Update(const ovrFrameTimer& frameTimer, const ovrFrameTimer& simulationTimer) {
+    if (!Overlay.IsInitialized() || !Overlay.IsVisible()) {
+        return;
+    }
+
+    const uint64_t nowNs = ovrFrameTimer::NowNs();
+    const uint64_t periodNs =
+        RefreshHz > 0.0f ? static_cast<uint64_t>(1e9 / RefreshHz) : UINT64_MAX;
+    if (LastRefreshNs == 0 || nowNs - LastRefreshNs >= periodNs) {
+        LastRefreshNs = nowNs;
+        BuildLines(frameTimer, simulationTimer, NewLines);
+        if (NewLines != Lines) {
+            Lines.swap(NewLines);
+            Overlay.MarkDirty();
+        }
+    }
+    Overlay.Update();
+}
+
+void ovrPerfHud::BuildLines(
+    const ovrFrameTimer& frameTimer,
+    const ovrFrameTimer& simulationTimer,
+    std::vector<std::string>& lines) const {
+    lines.clear();
+    char line[128];
+
+    ovrFrameTimingStats frame;
+    if (frameTimer.GetStats(WindowFrames, frame)) {
+        // Update runs on the simulation timer when MainLoop is pipelined
+        ovrFrameTimingStats simulation;
+        const ovrFrameTimingStats* update = &frame;
+        if (&simulationTimer != &frameTimer &&
+            simulationTimer.GetStats(WindowFrames, simulation)) {
+            update = &simulation;
+        }
+        const double renderMs = frame.Phase[FRAME_PHASE_RENDER].MeanMs +
+            frame.Phase[FRAME_PHASE_RENDER_EYE_0].MeanMs +
+            frame.Phase[FRAME_PHASE_RENDER_EYE_1].MeanMs;
+
+        snprintf(
+            line,
+            sizeof(line),
+            "Frame %.2f ms (%.0f fps)",
+            frame.Frame.MeanMs,
+            frame.Frame.MeanMs > 0.0 ? 1000.0 / frame.Frame.MeanMs : 0.0);
+        lines.push_back(line);
+        snprintf(
+            line, sizeof(line), "  p95 %.2f  max %.2f ms", frame.Frame.P95Ms, frame.Frame.MaxMs);
+        lines.push_back(line);
+        snprintf(
+            line,
+            sizeof(line),
+            "Update %.2f  Render %.2f ms",
+            update->Phase[FRAME_PHASE_UPDATE].MeanMs,
+            renderMs);
+        lines.push_back(line);
+        snprintf(
+            line,
+            sizeof(line),
+            "Draws %.0f  Prog %.0f  Tex %.0f",
+            frame.CounterMean[FRAME_COUNTER_DRAW_CALLS],
+            frame.CounterMean[FRAME_COUNTER_PROGRAM_BINDS],
+            frame.CounterMean[FRAME_COUNTER_TEXTURE_BINDS]);
+        lines.push_back(line);
+    } else {
+        lines.push_back("Frame timer disabled");
+    }
+
+    char value[32];
+    for (const ovrHudValue& v : Values) {
+        FormatValue(value, sizeof(value), v.Value(), v.Format);
+        lines.push_back(v.Label + " " + value);
+    }
+}
+
+void ovrPerfHud::RenderText(int width, int height) {
+    if (Lines.empty() || SurfaceRender == nullptr) {
+        return;
+    }
+
+    // Pixel coordinates, origin at the bottom left
+    const float w = static_cast<float>(width);
+    const float h = static_cast<float>(height);
+    float maxWidth = 0.0f;
+    for (const std::string& line : Lines) {
+        maxWidth = std::max(maxWidth, Font->CalcTextWidth(line.c_str()));
+    }
+    const float lineHeight =
+        (h - 2.0f * HUD_MARGIN) / std::max<float>(Lines.size(), HUD_MIN_LINES);
+    float scale = lineHeight / FontHeight;
+    if (maxWidth > 0.0f) {
+        scale = std::min(scale, (w - 2.0f * HUD_MARGIN) / maxWidth);
+    }
+
+    fontParms_t parms;
+    parms.AlignHoriz = HORIZONTAL_LEFT;
+    parms.AlignVert = VERTICAL_TOP;
+    const OVR::Vector3f normal(0.0f, 0.0f, 1.0f);
+    const OVR::Vector3f up(0.0f, 1.0f, 0.0f);
+    const OVR::Vector4f color(1.0f, 1.0f, 1.0f, 1.0f);
+    OVR::Vector3f pos(HUD_MARGIN, h - HUD_MARGIN, 0.0f);
+    for (const std::string& line : Lines) {
+        FontSurface->DrawText3D(*Font, parms, pos, normal, up, scale, color, line.c_str());
+        pos.y -= FontHeight * scale;
+    }
+    FontSurface->Finish(OVR::Matrix4f::Identity());
+
+    Surfaces.clear();
+    FontSurface->AppendSurfaceList(*Font, Surfaces);
+    for (ovrDrawSurface& surface : Surfaces) {
+        // The overlay has no depth buffer and the glyphs only need alpha blending
+        ovrSurfaceDef* def = const_cast<ovrSurfaceDef*>(surface.surface);
+        ovrGpuState& state = def->graphicsCommand.GpuState;
+        state.depthEnable = false;
+        state.depthMaskEnable = false;
+        state.cullEnable = false;
+        state.blendEnable = ovrGpuState::BLEND_ENABLE_SEPARATE;
+        state.blendSrc = GL_SRC_ALPHA;
+        state.blendDst = GL_ONE_MINUS_SRC_ALPHA;
+        state.blendSrcAlpha = GL_ONE;
+        state.blendDstAlpha = GL_ONE_MINUS_SRC_ALPHA;
+    }
+
+    // RenderSurfaceList reads one matrix per view
+    const OVR::Matrix4f views[2] = {OVR::Matrix4f::Identity(), OVR::Matrix4f::Identity()};
+    const OVR::Matrix4f ortho(
+        2.0f / w, 0.0f, 0.0f, -1.0f,
+        0.0f, 2.0f / h, 0.0f, -1.0f,
+        0.0f, 0.0f, 0.0f, 0.0f,
+        0.0f, 0.0f, 0.0f, 1.0f);
+    const OVR::Matrix4f projections[2] = {ortho, ortho};
+    SurfaceRender->RenderSurfaceList(Surfaces, views[0], projections[0], 0);
+}
+
+} // namespace OVRFW
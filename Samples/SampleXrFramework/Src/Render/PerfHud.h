@@ -0,0 +1,128 @@
+/*******************************************************************************
+
+Filename    :   PerfHud.h
+Content     :   Head-locked panel with frame timing, draw counters and app values.
+Language    :   C++
+
+*******************************************************************************/
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "Misc/FrameTiming.h"
+#include "Render/QuadOverlay.h"
+#include "Render/SurfaceRender.h"
+
+namespace OVRFW {
+
+class ovrFileSys;
+class BitmapFont;
+class BitmapFontSurface;
+
+// Performance panel drawn with BitmapFont glyphs into an ovrQuadOverlay.
+//
+// Shows the rolling frame time (mean, p95, max), the CPU time of Update and of
+// rendering, the draw calls and program/texture binds of the eye buffers and any
+// value the app adds with AddValue (queue depths, bytes written...).
+//
+// The numbers come from the lock-free ring of ovrFrameTimer and from the app's value
+// functions, read RefreshHz times per second; the text is redrawn only when it
+// changed. Collecting them never blocks the threads that publish them. Between
+// refreshes Update returns at once and the compositor keeps showing the last image,
+// and the panel's own draws bypass AppRenderEye, so they are not in the counters.
+//
+// The frame timer has to be enabled (XrApp::GetFrameTimer().SetEnabled(true)),
+// otherwise only the app values are shown.
+class ovrPerfHud {
+   public:
+    enum ovrValueFormat {
+        VALUE_COUNT, // integer
+        VALUE_BYTES, // B, KB, MB or GB
+        VALUE_MS, // milliseconds, two decimals
+    };
+
+    // Called at the refresh rate from Update; must be cheap and thread safe
+    // (an atomic load), it runs on the GL thread.
+    typedef std::function<double()> ValueFunction;
+
+    ovrPerfHud() = default;
+    ~ovrPerfHud() = default;
+
+    ovrPerfHud(const ovrPerfHud&) = delete;
+    ovrPerfHud& operator=(const ovrPerfHud&) = delete;
+
+    // Loads the font and creates the overlay. Needs the GL context.
+    bool Init(
+        XrSession session,
+        ovrFileSys& fileSys,
+        ovrSurfaceRender& surfaceRender,
+        int width = 512,
+        int height = 256,
+        const char* fontUri = "apk://font/res/raw/efigs.fnt");
+    void Shutdown();
+
+    // Placement, size and visibility of the layer
+    ovrQuadOverlay& GetOverlay() {
+        return Overlay;
+    }
+
+    void SetRefreshRate(float hz) {
+        RefreshHz = hz;
+    }
+    // Frames the timing statistics are computed from (at most ovrFrameTimer::RING_SIZE)
+    void SetWindowFrames(int frames) {
+        WindowFrames = frames;
+    }
+
+    // Adds a line "label value" below the framework counters
+    void
+    AddValue(const std::string& label, ValueFunction value, ovrValueFormat format = VALUE_COUNT);
+
+    // Once per frame on the GL thread. simulationTimer is XrApp::GetSimulationTimer(),
+    // where Update is timed; frameTimer is XrApp::GetFrameTimer().
+    void Update(const ovrFrameTimer& frameTimer, const ovrFrameTimer& simulationTimer);
+
+    template <typename LayerUnion>
+    void AddLayer(LayerUnion* layers, int& layerCount) const {
+        Overlay.AddLayer(layers, layerCount);
+    }
+
+    // The lines currently shown
+    const std::vector<std::string>& GetLines() const {
+        return Lines;
+    }
+
+   private:
+    struct ovrHudValue {
+        std::string Label;
+        ValueFunction Value;
+        ovrValueFormat Format;
+    };
+
+    void BuildLines(
+        const ovrFrameTimer& frameTimer,
+        const ovrFrameTimer& simulationTimer,
+        std::vector<std::string>& lines) const;
+    void RenderText(int width, int height);
+
+    ovrQuadOverlay Overlay;
+    ovrSurfaceRender* SurfaceRender = nullptr;
+    BitmapFont* Font = nullptr;
+    BitmapFontSurface* FontSurface = nullptr;
+    float FontHeight = 0.0f; // line height of the font at scale 1
+
+    std::vector<ovrHudValue> Values;
+    std::vector<std::string> Lines;
+    std::vector<std::string> NewLines;
+    std::vector<ovrDrawSurface> Surfaces;
+
+    float RefreshHz = 4.0f;
+    int WindowFrames = 90;
+    uint64_t LastRefreshNs = 0;
+};
+
+} // namespace OVRFW
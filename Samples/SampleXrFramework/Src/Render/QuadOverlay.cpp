@@ -0,0 +1,173 @@
+/*******************************************************************************
+
+Filename    :   QuadOverlay.cpp
+Content     :   Quad composition layer with its own swapchain, redrawn only when dirty.
+Language    :   C++
+
+*******************************************************************************/
+
+#include "QuadOverlay.h"
+
+#include "Misc/Log.h"
+
+namespace OVRFW {
+
+#if defined(XR_USE_GRAPHICS_API_OPENGL_ES)
+typedef XrSwapchainImageOpenGLESKHR ovrQuadOverlayImage;
+static const XrStructureType QUAD_OVERLAY_IMAGE_TYPE = XR_TYPE_SWAPCHAIN_IMAGE_OPENGL_ES_KHR;
+#elif defined(XR_USE_GRAPHICS_API_OPENGL)
+typedef XrSwapchainImageOpenGLKHR ovrQuadOverlayImage;
+static const XrStructureType QUAD_OVERLAY_IMAGE_TYPE = XR_TYPE_SWAPCHAIN_IMAGE_OPENGL_KHR;
+#endif // defined(XR_USE_GRAPHICS_API_OPENGL_ES)
+
+bool ovrQuadOverlay::Init(XrSession session, int width, int height, int64_t format) {
+    Shutdown();
+
+    XrSwapchainCreateInfo createInfo{XR_TYPE_SWAPCHAIN_CREATE_INFO};
+    createInfo.usageFlags =
+        XR_SWAPCHAIN_USAGE_COLOR_ATTACHMENT_BIT | XR_SWAPCHAIN_USAGE_SAMPLED_BIT;
+    createInfo.format = format;
+    createInfo.sampleCount = 1;
+    createInfo.width = width;
+    createInfo.height = height;
+    createInfo.faceCount = 1;
+    createInfo.arraySize = 1;
+    createInfo.mipCount = 1;
+    XrResult result = xrCreateSwapchain(session, &createInfo, &Swapchain);
+    if (XR_FAILED(result)) {
+        ALOGE("ovrQuadOverlay: xrCreateSwapchain failed (%d)", result);
+        Swapchain = XR_NULL_HANDLE;
+        return false;
+    }
+
+    // The image handles never change, enumerate them once
+    uint32_t imageCount = 0;
+    xrEnumerateSwapchainImages(Swapchain, 0, &imageCount, nullptr);
+    std::vector<ovrQuadOverlayImage> images(imageCount, {QUAD_OVERLAY_IMAGE_TYPE});
+    result = xrEnumerateSwapchainImages(
+        Swapchain,
+        imageCount,
+        &imageCount,
+        reinterpret_cast<XrSwapchainImageBaseHeader*>(images.data()));
+    if (XR_FAILED(result) || imageCount == 0) {
+        ALOGE("ovrQuadOverlay: xrEnumerateSwapchainImages failed (%d)", result);
+        Shutdown();
+        return false;
+    }
+
+    Textures.resize(imageCount);
+    Framebuffers.resize(imageCount);
+    glGenFramebuffers(imageCount, Framebuffers.data());
+    for (uint32_t i = 0; i < imageCount; i++) {
+        Textures[i] = images[i].image;
+        glBindFramebuffer(GL_FRAMEBUFFER, Framebuffers[i]);
+        glFramebufferTexture2D(
+            GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, Textures[i], 0);
+        const GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+        if (status != GL_FRAMEBUFFER_COMPLETE) {
+            ALOGE("ovrQuadOverlay: incomplete framebuffer for image %u (0x%x)", i, status);
+            glBindFramebuffer(GL_FRAMEBUFFER, 0);
+            Shutdown();
+            return false;
+        }
+    }
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    Width = width;
+    Height = height;
+    Layer.layerFlags = XR_COMPOSITION_LAYER_BLEND_TEXTURE_SOURCE_ALPHA_BIT;
+    Layer.eyeVisibility = XR_EYE_VISIBILITY_BOTH;
+    Layer.subImage.swapchain = Swapchain;
+    Layer.subImage.imageRect.offset = {0, 0};
+    Layer.subImage.imageRect.extent = {width, height};
+    Layer.subImage.imageArrayIndex = 0;
+    Dirty = true;
+    HasImage = false;
+    AcquiredImage = -1;
+    RenderCount = 0;
+    return true;
+}
+
+void ovrQuadOverlay::Shutdown() {
+    if (!Framebuffers.empty()) {
+        glDeleteFramebuffers(static_cast<GLsizei>(Framebuffers.size()), Framebuffers.data());
+        Framebuffers.clear();
+    }
+    Textures.clear();
+    if (Swapchain != XR_NULL_HANDLE) {
+        xrDestroySwapchain(Swapchain);
+        Swapchain = XR_NULL_HANDLE;
+    }
+    Layer.subImage.swapchain = XR_NULL_HANDLE;
+    HasImage = false;
+    AcquiredImage = -1;
+}
+
+void ovrQuadOverlay::SetPose(const OVR::Posef& pose) {
+    Layer.pose.position = {pose.Translation.x, pose.Translation.y, pose.Translation.z};
+    Layer.pose.orientation = {pose.Rotation.x, pose.Rotation.y, pose.Rotation.z, pose.Rotation.w};
+}
+
+bool ovrQuadOverlay::Update() {
+    if (!Dirty || !Visible || Swapchain == XR_NULL_HANDLE) {
+        return false;
+    }
+
+    // After a failed wait the image is still acquired: wait for it again instead of
+    // acquiring another one
+    if (AcquiredImage < 0) {
+        uint32_t imageIndex = 0;
+        XrSwapchainImageAcquireInfo acquireInfo{XR_TYPE_SWAPCHAIN_IMAGE_ACQUIRE_INFO};
+        const XrResult result = xrAcquireSwapchainImage(Swapchain, &acquireInfo, &imageIndex);
+        if (XR_FAILED(result)) {
+            ALOGE("ovrQuadOverlay: xrAcquireSwapchainImage failed (%d)", result);
+            return false; // still dirty, retried next frame
+        }
+        AcquiredImage = static_cast<int>(imageIndex);
+    }
+    XrSwapchainImageWaitInfo waitInfo{XR_TYPE_SWAPCHAIN_IMAGE_WAIT_INFO};
+    waitInfo.timeout = XR_INFINITE_DURATION;
+    const XrResult result = xrWaitSwapchainImage(Swapchain, &waitInfo);
+    if (result != XR_SUCCESS) {
+        // Releasing an image that was not waited for is a call order error
+        ALOGE("ovrQuadOverlay: could not wait for image %d (%d)", AcquiredImage, result);
+        return false; // still dirty, retried next frame
+    }
+    const uint32_t imageIndex = static_cast<uint32_t>(AcquiredImage);
+    AcquiredImage = -1;
+
+    const bool render = imageIndex < Framebuffers.size();
+    if (render) {
+        glBindFramebuffer(GL_FRAMEBUFFER, Framebuffers[imageIndex]);
+        glViewport(0, 0, Width, Height);
+        glClearColor(ClearColor.x, ClearColor.y, ClearColor.z, ClearColor.w);
+        glClear(GL_COLOR_BUFFER_BIT);
+        if (Render) {
+            Render(Width, Height);
+        }
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    } else {
+        ALOGE("ovrQuadOverlay: image %u out of range", imageIndex);
+    }
+
+    // A waited image has to be released even if nothing was drawn
+    XrSwapchainImageReleaseInfo releaseInfo{XR_TYPE_SWAPCHAIN_IMAGE_RELEASE_INFO};
+    xrReleaseSwapchainImage(Swapchain, &releaseInfo);
+    if (!render) {
+        return false;
+    }
+
+    Dirty = false;
+    HasImage = true;
+    RenderCount++;
+    return true;
+}
+
+const XrCompositionLayerQuad* ovrQuadOverlay::GetLayer() const {
+    if (!Visible || !HasImage || Swapchain == XR_NULL_HANDLE) {
+        return nullptr;
+    }
+    return &Layer;
+}
+
+} // namespace OVRFW
@@ -0,0 +1,149 @@
+/*******************************************************************************
+
+Filename    :   QuadOverlay.h
+Content     :   Quad composition layer with its own swapchain, redrawn only when dirty.
+Language    :   C++
+
+*******************************************************************************/
+
+#pragma once
+
+#include <functional>
+#include <vector>
+
+#include "Render/Egl.h"
+
+#if defined(ANDROID)
+#include <jni.h>
+#define XR_USE_GRAPHICS_API_OPENGL_ES 1
+#define XR_USE_PLATFORM_ANDROID 1
+#elif defined(WIN32)
+#include <unknwn.h>
+#define XR_USE_GRAPHICS_API_OPENGL 1
+#define XR_USE_PLATFORM_WIN32 1
+#endif // defined(ANDROID)
+
+#include <openxr/openxr.h>
+#include <openxr/openxr_platform.h>
+
+#include "OVR_Math.h"
+
+namespace OVRFW {
+
+// An XrCompositionLayerQuad backed by a swapchain it owns, for HUDs and other 2D
+// overlays whose content changes much less often than the display refreshes.
+//
+// The swapchain images and one framebuffer per image are created once in Init.
+// Update only acquires, renders and releases when the content was marked dirty;
+// otherwise the layer is resubmitted with the image released last, which the
+// compositor keeps showing. An idle overlay costs no GPU work and no OpenXR calls.
+//
+// Typical use: Init in SessionInit, SetRenderFunction, MarkDirty whenever what it
+// shows changes, Update once per frame from Render (or an AppRenderFrame override),
+// AddLayer from PostProjectionAddLayer and Shutdown in SessionEnd.
+//
+// Update makes GL calls and runs the render function, so it belongs on the render
+// thread only. Not from XrApp::Update: with a frame pipeline that runs on the
+// simulation thread, without the GL context. The overlay is not thread safe either,
+// so MarkDirty, SetVisible and whatever the render function reads should be touched
+// from the render thread as well.
+class ovrQuadOverlay {
+   public:
+    // Called with the overlay framebuffer bound, the viewport covering the whole image
+    // and the image cleared to the clear color
+    typedef std::function<void(int width, int height)> RenderFunction;
+
+    ovrQuadOverlay() {
+        Layer.pose.orientation.w = 1.0f;
+    }
+    ~ovrQuadOverlay() = default;
+
+    ovrQuadOverlay(const ovrQuadOverlay&) = delete;
+    ovrQuadOverlay& operator=(const ovrQuadOverlay&) = delete;
+
+    // Creates the swapchain and the framebuffers. The overlay starts dirty.
+    bool Init(XrSession session, int width, int height, int64_t format = GL_RGBA8);
+    void Shutdown();
+    bool IsInitialized() const {
+        return Swapchain != XR_NULL_HANDLE;
+    }
+
+    // Layer placement, in meters. The space must outlive the overlay's use.
+    void SetSpace(XrSpace space) {
+        Layer.space = space;
+    }
+    void SetPose(const OVR::Posef& pose);
+    void SetSize(float widthMeters, float heightMeters) {
+        Layer.size = {widthMeters, heightMeters};
+    }
+    void SetLayerFlags(XrCompositionLayerFlags flags) {
+        Layer.layerFlags = flags;
+    }
+
+    // A hidden overlay adds no layer and is not redrawn; a pending redraw waits until
+    // it is shown again
+    void SetVisible(bool visible) {
+        Visible = visible;
+    }
+    bool IsVisible() const {
+        return Visible;
+    }
+
+    void SetClearColor(const OVR::Vector4f& color) {
+        ClearColor = color;
+    }
+    void SetRenderFunction(const RenderFunction& render) {
+        Render = render;
+        Dirty = true;
+    }
+
+    void MarkDirty() {
+        Dirty = true;
+    }
+    bool IsDirty() const {
+        return Dirty;
+    }
+
+    // Redraws the next swapchain image if dirty and visible. Needs the GL context.
+    // Returns true if it redrew.
+    bool Update();
+
+    // Appends the quad to layers if there is something to show.
+    // LayerUnion is XrApp::xrCompositorLayerUnion.
+    template <typename LayerUnion>
+    void AddLayer(LayerUnion* layers, int& layerCount) const {
+        if (const XrCompositionLayerQuad* quad = GetLayer()) {
+            layers[layerCount++].Quad = *quad;
+        }
+    }
+    // nullptr while hidden or before the first image was rendered
+    const XrCompositionLayerQuad* GetLayer() const;
+
+    int GetWidth() const {
+        return Width;
+    }
+    int GetHeight() const {
+        return Height;
+    }
+    // Times Update redrew since Init
+    uint64_t GetRenderCount() const {
+        return RenderCount;
+    }
+
+   private:
+    XrSwapchain Swapchain = XR_NULL_HANDLE;
+    std::vector<GLuint> Textures; // swapchain images, by index
+    std::vector<GLuint> Framebuffers; // one per image, color attachment set once
+    XrCompositionLayerQuad Layer{XR_TYPE_COMPOSITION_LAYER_QUAD};
+    RenderFunction Render;
+    OVR::Vector4f ClearColor = OVR::Vector4f(0.0f, 0.0f, 0.0f, 0.0f);
+    int Width = 0;
+    int Height = 0;
+    bool Dirty = false;
+    bool Visible = true;
+    bool HasImage = false; // an image was released and can be submitted
+    int AcquiredImage = -1; // acquired but not yet waited for, -1 if none
+    uint64_t RenderCount = 0;
+};
+
+} // namespace OVRFW
@@ -0,0 +1,160 @@
+/*******************************************************************************
+
+Filename    :   RenderQueue.cpp
+Content     :   Surface queue sorted by packed 64-bit state and depth keys.
+Language    :   C++
+
+*******************************************************************************/
+
+#include "RenderQueue.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include "GlTexture.h"
+
+using OVR::Matrix4f;
+
+namespace OVRFW {
+
+static uint32_t DepthBits(const float depth) {
+    // Bits of a positive float sort like the float; anything else sorts as 0
+    if (!(depth > 0.0f)) {
+        return 0;
+    }
+    uint32_t bits;
+    memcpy(&bits, &depth, sizeof(bits));
+    return bits;
+}
+
+static uint32_t DepthBucket(const float depth) {
+    // 0 below 1, then one bucket per doubling, 7 from 64 on
+    if (!(depth > 0.0f)) {
+        return 0;
+    }
+    int exponent = 0;
+    frexpf(depth, &exponent);
+    return static_cast<uint32_t>(std::min(std::max(exponent, 0), 7));
+}
+
+static uint32_t FirstTextureName(const ovrGraphicsCommand& cmd) {
+    for (int i = 0; i < ovrUniform::MAX_UNIFORMS; i++) {
+        const ovrProgramParmType type = cmd.Program.Uniforms[i].Type;
+        if (type == ovrProgramParmType::MAX) {
+            break;
+        }
+        if (type == ovrProgramParmType::TEXTURE_SAMPLED && cmd.UniformData[i].Data != nullptr) {
+            return static_cast<const GlTexture*>(cmd.UniformData[i].Data)->texture;
+        }
+    }
+    return 0;
+}
+
+uint64_t ovrRenderQueue::MakeSortKey(
+    const ovrSurfaceDef& surface,
+    const float depth,
+    const int layer) {
+    const ovrGraphicsCommand& cmd = surface.graphicsCommand;
+    const uint64_t program = cmd.Program.Program;
+    const uint64_t texture = FirstTextureName(cmd);
+    const uint64_t layerBits = static_cast<uint64_t>(layer & 0xF) << 60;
+
+    if (cmd.GpuState.blendEnable != ovrGpuState::BLEND_DISABLE) {
+        // Back to front first, state only breaks ties
+        const uint64_t inverted = ~DepthBits(depth) & 0xFFFFFFFFull;
+        return layerBits | (1ull << 59) | (inverted << 27) | ((program & 0x3FFF) << 13) |
+            (texture & 0x1FFF);
+    }
+
+    const uint64_t bucket = DepthBucket(depth);
+    const uint64_t vao = surface.geo.vertexArrayObject;
+    const uint64_t fineDepth = DepthBits(depth) >> 16;
+    return layerBits | (bucket << 56) | ((program & 0x3FFF) << 42) | ((texture & 0x3FFF) << 28) |
+        ((vao & 0xFFF) << 16) | fineDepth;
+}
+
+void ovrRenderQueue::Clear() {
+    Entries.clear();
+    Surfaces.clear();
+    SurfaceTransforms.clear();
+    Transforms.clear();
+}
+
+void ovrRenderQueue::Reserve(const int surfaces, const int transforms) {
+    Entries.reserve(surfaces);
+    SortScratch.reserve(surfaces);
+    Surfaces.reserve(surfaces);
+    SurfaceTransforms.reserve(surfaces);
+    Transforms.reserve(transforms);
+}
+
+int ovrRenderQueue::AddTransform(const Matrix4f& modelMatrix) {
+    Transforms.push_back(modelMatrix);
+    return static_cast<int>(Transforms.size()) - 1;
+}
+
+void ovrRenderQueue::Add(
+    const ovrSurfaceDef* surface,
+    const int transformIndex,
+    const float depth,
+    const int layer) {
+    ovrQueueEntry entry;
+    entry.Key = MakeSortKey(*surface, depth, layer);
+    entry.Index = static_cast<uint32_t>(Surfaces.size());
+    Entries.push_back(entry);
+    Surfaces.push_back(surface);
+    SurfaceTransforms.push_back(transformIndex);
+}
+
+void ovrRenderQueue::Sort() {
+    const size_t count = Entries.size();
+    if (count < 2) {
+        return;
+    }
+
+    // Least significant byte first, counting all eight bytes in one pass. The sort is
+    // stable, so equal keys keep the order they were added in from frame to frame.
+    uint32_t histograms[8][256] = {};
+    for (const ovrQueueEntry& entry : Entries) {
+        for (int pass = 0; pass < 8; pass++) {
+            histograms[pass][(entry.Key >> (pass * 8)) & 0xFF]++;
+        }
+    }
+
+    SortScratch.resize(count);
+    ovrQueueEntry* src = Entries.data();
+    ovrQueueEntry* dst = SortScratch.data();
+    for (int pass = 0; pass < 8; pass++) {
+        uint32_t* histogram = histograms[pass];
+        const int shift = pass * 8;
+        // Skip bytes that are the same in every key, which is most of them
+        if (histogram[(src[0].Key >> shift) & 0xFF] == count) {
+            continue;
+        }
+        uint32_t offset = 0;
+        for (int i = 0; i < 256; i++) {
+            const uint32_t n = histogram[i];
+            histogram[i] = offset;
+            offset += n;
+        }
+        for (size_t i = 0; i < count; i++) {
+            dst[histogram[(src[i].Key >> shift) & 0xFF]++] = src[i];
+        }
+        std::swap(src, dst);
+    }
+    if (src != Entries.data()) {
+        Entries.swap(SortScratch);
+    }
+}
+
+void ovrRenderQueue::GetSurfaceList(std::vector<ovrDrawSurface>& surfaceList) const {
+    const int count = GetCount();
+    surfaceList.resize(count);
+    for (int i = 0; i < count; i++) {
+        surfaceList[i].modelMatrix = GetTransform(i);
+        surfaceList[i].surface = GetSurface(i);
+    }
+}
+
+} // namespace OVRFW
@@ -0,0 +1,84 @@
+/*******************************************************************************
+
+Filename    :   RenderQueue.h
+Content     :   Surface queue sorted by packed 64-bit state and depth keys.
+Language    :   C++
+
+*******************************************************************************/
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "OVR_Math.h"
+#include "SurfaceRender.h"
+
+namespace OVRFW {
+
+// Collects the surfaces of a frame and sorts them into draw order with a radix sort on
+// 64-bit keys, most significant field first:
+//
+//   opaque       layer:4  0:1  depth bucket:3  program:14  texture:14  vao:12  depth:16
+//   transparent  layer:4  1:1  inverted depth:32           program:14  texture:13
+//
+// Lower layers draw first, then opaque surfaces, then transparent ones. Opaque surfaces
+// are grouped by a coarse log2 depth bucket, so sky boxes and distant environments still
+// draw after nearby objects, and within a bucket by program, texture and vertex array to
+// cut the binds ovrSurfaceRender counts, near to far. Transparent surfaces are strictly
+// back to front. Program, texture and vertex array object names are masked to their
+// fields, so a name above the range only groups less well, it never changes correctness.
+//
+// Transforms live in their own array and surfaces reference them by index, so the
+// surfaces of one node share a matrix and the sort moves 16-byte entries.
+class ovrRenderQueue {
+   public:
+    ovrRenderQueue() = default;
+
+    // Keeps the capacity, so a queue reused every frame does not allocate
+    void Clear();
+    void Reserve(const int surfaces, const int transforms);
+
+    int AddTransform(const OVR::Matrix4f& modelMatrix);
+    // depth is the farthest W of the surface bounds (0 if unknown)
+    void Add(
+        const ovrSurfaceDef* surface,
+        const int transformIndex,
+        const float depth,
+        const int layer = 0);
+
+    void Sort();
+
+    int GetCount() const {
+        return static_cast<int>(Entries.size());
+    }
+    // In draw order after Sort, otherwise in the order they were added
+    const ovrSurfaceDef* GetSurface(const int index) const {
+        return Surfaces[Entries[index].Index];
+    }
+    const OVR::Matrix4f& GetTransform(const int index) const {
+        return Transforms[SurfaceTransforms[Entries[index].Index]];
+    }
+    uint64_t GetSortKey(const int index) const {
+        return Entries[index].Key;
+    }
+
+    // Replaces the contents of surfaceList with the queue in its current order
+    void GetSurfaceList(std::vector<ovrDrawSurface>& surfaceList) const;
+
+    static uint64_t MakeSortKey(const ovrSurfaceDef& surface, const float depth, const int layer);
+
+   private:
+    struct ovrQueueEntry {
+        uint64_t Key;
+        uint32_t Index; // into Surfaces and SurfaceTransforms
+    };
+
+    std::vector<ovrQueueEntry> Entries;
+    std::vector<ovrQueueEntry> SortScratch;
+    std::vector<const ovrSurfaceDef*> Surfaces;
+    std::vector<int> SurfaceTransforms;
+    std::vector<OVR::Matrix4f> Transforms;
+};
+
+} // namespace OVRFW
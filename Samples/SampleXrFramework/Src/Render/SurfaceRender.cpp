@@ -28,6 +28,7 @@ Authors     :   John Carmack
 #include "SurfaceRender.h"
 
 #include <stdlib.h>
+#include <string.h>
 
 #include "Misc/Log.h"
 
@@ -57,21 +58,31 @@ ChangeGpuState(const ovrGpuState oldState, const ovrGpuState newState, bool forc
             GL(glDisable(GL_BLEND));
         }
     }
-    if (force || newState.blendEnable != oldState.blendEnable ||
-        newState.blendSrc != oldState.blendSrc || newState.blendDst != oldState.blendDst ||
-        newState.blendSrcAlpha != oldState.blendSrcAlpha ||
-        newState.blendDstAlpha != oldState.blendDstAlpha ||
-        newState.blendMode != oldState.blendMode ||
-        newState.blendModeAlpha != oldState.blendModeAlpha) {
-        if (newState.blendEnable == ovrGpuState::BLEND_ENABLE_SEPARATE) {
+    // Compare the functions GL ends up with: without BLEND_ENABLE_SEPARATE the alpha
+    // channel uses the color ones, and toggling blending alone does not change them.
+    const bool oldSeparate = oldState.blendEnable == ovrGpuState::BLEND_ENABLE_SEPARATE;
+    const bool newSeparate = newState.blendEnable == ovrGpuState::BLEND_ENABLE_SEPARATE;
+    if (force || newState.blendSrc != oldState.blendSrc || newState.blendDst != oldState.blendDst ||
+        (newSeparate ? newState.blendSrcAlpha : newState.blendSrc) !=
+            (oldSeparate ? oldState.blendSrcAlpha : oldState.blendSrc) ||
+        (newSeparate ? newState.blendDstAlpha : newState.blendDst) !=
+            (oldSeparate ? oldState.blendDstAlpha : oldState.blendDst)) {
+        if (newSeparate) {
             GL(glBlendFuncSeparate(
                 newState.blendSrc,
                 newState.blendDst,
                 newState.blendSrcAlpha,
                 newState.blendDstAlpha));
-            GL(glBlendEquationSeparate(newState.blendMode, newState.blendModeAlpha));
         } else {
             GL(glBlendFunc(newState.blendSrc, newState.blendDst));
+        }
+    }
+    if (force || newState.blendMode != oldState.blendMode ||
+        (newSeparate ? newState.blendModeAlpha : newState.blendMode) !=
+            (oldSeparate ? oldState.blendModeAlpha : oldState.blendMode)) {
+        if (newSeparate) {
+            GL(glBlendEquationSeparate(newState.blendMode, newState.blendModeAlpha));
+        } else {
             GL(glBlendEquation(newState.blendMode));
         }
     }
@@ -136,7 +147,40 @@ ChangeGpuState(const ovrGpuState oldState, const ovrGpuState newState, bool forc
     // extend as needed
 }
 
-ovrSurfaceRender::ovrSurfaceRender() : CurrentSceneMatricesIdx(0) {}
+// Copies the value to the shadow and returns true if it differs from the last upload
+static bool UniformChanged(bool& valid, float* shadow, const void* value, const size_t size) {
+    if (valid && memcmp(shadow, value, size) == 0) {
+        return false;
+    }
+    memcpy(shadow, value, size);
+    valid = true;
+    return true;
+}
+
+// Bytes compared for a single uniform value, 0 for types that are not cached
+static size_t UniformValueSize(const ovrProgramParmType type) {
+    switch (type) {
+        case ovrProgramParmType::INT:
+        case ovrProgramParmType::FLOAT:
+            return 4;
+        case ovrProgramParmType::INT_VECTOR2:
+        case ovrProgramParmType::FLOAT_VECTOR2:
+            return 8;
+        case ovrProgramParmType::INT_VECTOR3:
+        case ovrProgramParmType::FLOAT_VECTOR3:
+            return 12;
+        case ovrProgramParmType::INT_VECTOR4:
+        case ovrProgramParmType::FLOAT_VECTOR4:
+            return 16;
+        case ovrProgramParmType::FLOAT_MATRIX4:
+            return 64;
+        default:
+            return 0;
+    }
+}
+
+ovrSurfaceRender::ovrSurfaceRender()
+    : CurrentSceneMatricesIdx(0), StateFiltering(true), ProgramFreeCount(0) {}
 
 ovrSurfaceRender::~ovrSurfaceRender() {}
 
@@ -152,6 +196,27 @@ void ovrSurfaceRender::Shutdown() {
     for (int i = 0; i < MAX_SCENEMATRICES_UBOS; i++) {
         SceneMatrices[i].Destroy();
     }
+    InvalidateStateCache();
+}
+
+void ovrSurfaceRender::InvalidateStateCache() {
+    ProgramShadows.clear();
+    ProgramFreeCount = GlProgram::GetFreeCount();
+}
+
+ovrSurfaceRender::ovrProgramShadow& ovrSurfaceRender::GetProgramShadow(
+    const unsigned int program) {
+    if (ProgramFreeCount != GlProgram::GetFreeCount()) {
+        InvalidateStateCache();
+    }
+    // GL names are small integers, index by name instead of hashing on every program switch
+    if (program >= ProgramShadows.size()) {
+        ProgramShadows.resize(program + 1);
+    }
+    if (ProgramShadows[program] == nullptr) {
+        ProgramShadows[program].reset(new ovrProgramShadow());
+    }
+    return *ProgramShadows[program];
 }
 
 int ovrSurfaceRender::UpdateSceneMatrices(
@@ -226,9 +291,14 @@ ovrDrawCounters ovrSurfaceRender::RenderSurfaceList(
     ChangeGpuState(currentGpuState, currentGpuState, true /* force */);
 
     // TODO: These should be range checked containers.
+    // Bindings are only shadowed within this call, other code may change them in between.
+    const bool filter = StateFiltering;
     GLuint currentBuffers[ovrUniform::MAX_UNIFORMS] = {};
     GLuint currentTextures[ovrUniform::MAX_UNIFORMS] = {};
     GLuint currentProgramObject = 0;
+    GLenum currentActiveTexture = 0; // unknown
+    GLuint currentVertexArray = ~0u; // unknown
+    ovrProgramShadow* shadow = nullptr;
 
     const int sceneMatricesIdx =
         UpdateSceneMatrices(&viewMatrix, &projectionMatrix, GlProgram::MAX_VIEWS /* num eyes */);
@@ -252,22 +322,69 @@ ovrDrawCounters ovrSurfaceRender::RenderSurfaceList(
 
                 currentProgramObject = cmd.Program.Program;
                 GL(glUseProgram(cmd.Program.Program));
+                if (filter) {
+                    shadow = &GetProgramShadow(cmd.Program.Program);
+                }
+            } else {
+                counters.numElidedProgramBinds++;
             }
 
             // Update globally defined system level uniforms.
             {
                 if (cmd.Program.ViewID.Location >= 0) // not defined when multiview enabled
                 {
-                    GL(glUniform1i(cmd.Program.ViewID.Location, eye));
+                    if (!filter || !shadow->ViewIDValid || shadow->ViewID != eye) {
+                        counters.numParameterUpdates++;
+                        GL(glUniform1i(cmd.Program.ViewID.Location, eye));
+                        if (filter) {
+                            shadow->ViewIDValid = true;
+                            shadow->ViewID = eye;
+                        }
+                    } else {
+                        counters.numElidedParameterUpdates++;
+                    }
+                }
+                if (!filter ||
+                    (cmd.Program.ModelMatrix.Location >= 0 &&
+                     UniformChanged(
+                         shadow->ModelMatrixValid,
+                         shadow->ModelMatrix,
+                         drawSurface.modelMatrix.M[0],
+                         sizeof(Matrix4f)))) {
+                    counters.numParameterUpdates++;
+                    GL(glUniformMatrix4fv(
+                        cmd.Program.ModelMatrix.Location,
+                        1,
+                        GL_TRUE,
+                        drawSurface.modelMatrix.M[0]));
+                } else if (cmd.Program.ModelMatrix.Location >= 0) {
+                    counters.numElidedParameterUpdates++;
                 }
-                GL(glUniformMatrix4fv(
-                    cmd.Program.ModelMatrix.Location, 1, GL_TRUE, drawSurface.modelMatrix.M[0]));
 
                 if (cmd.Program.SceneMatrices.Location >= 0) {
-                    GL(glBindBufferBase(
-                        GL_UNIFORM_BUFFER,
-                        cmd.Program.SceneMatrices.Binding,
-                        SceneMatrices[sceneMatricesIdx].GetBuffer()));
+                    const int binding = cmd.Program.SceneMatrices.Binding;
+                    const GLuint buffer = SceneMatrices[sceneMatricesIdx].GetBuffer();
+                    if (!filter || currentBuffers[binding] != buffer) {
+                        counters.numBufferBinds++;
+                        currentBuffers[binding] = buffer;
+                        GL(glBindBufferBase(GL_UNIFORM_BUFFER, binding, buffer));
+                    } else {
+                        counters.numElidedBufferBinds++;
+                    }
+                }
+
+                if (cmd.Program.InstanceMatrices.Location >= 0 &&
+                    cmd.InstanceMatrices.Data != NULL) {
+                    const int binding = cmd.Program.InstanceMatrices.Binding;
+                    const GLuint buffer =
+                        static_cast<const GlBuffer*>(cmd.InstanceMatrices.Data)->GetBuffer();
+                    if (!filter || currentBuffers[binding] != buffer) {
+                        counters.numBufferBinds++;
+                        currentBuffers[binding] = buffer;
+                        GL(glBindBufferBase(GL_UNIFORM_BUFFER, binding, buffer));
+                    } else {
+                        counters.numElidedBufferBinds++;
+                    }
                 }
             }
 
@@ -275,9 +392,28 @@ ovrDrawCounters ovrSurfaceRender::RenderSurfaceList(
             bool uniformsDone = false;
             {
                 for (int i = 0; i < ovrUniform::MAX_UNIFORMS && !uniformsDone; ++i) {
-                    counters.numParameterUpdates++;
                     const int parmLocation = cmd.Program.Uniforms[i].Location;
 
+                    // Values are compared with the last upload to this program; arrays of
+                    // matrices (skinning) are always uploaded.
+                    const size_t valueSize = UniformValueSize(cmd.Program.Uniforms[i].Type);
+                    if (valueSize > 0 && parmLocation >= 0 && cmd.UniformData[i].Data != NULL) {
+                        const bool isArray = cmd.UniformData[i].Count > 1;
+                        if (filter && !isArray &&
+                            !UniformChanged(
+                                shadow->UniformValid[i],
+                                shadow->UniformValues[i],
+                                cmd.UniformData[i].Data,
+                                valueSize)) {
+                            counters.numElidedParameterUpdates++;
+                            continue;
+                        }
+                        if (filter && isArray) {
+                            shadow->UniformValid[i] = false;
+                        }
+                        counters.numParameterUpdates++;
+                    }
+
                     switch (cmd.Program.Uniforms[i].Type) {
                         case ovrProgramParmType::INT: {
                             if (parmLocation >= 0 && cmd.UniformData[i].Data != NULL) {
@@ -378,10 +514,16 @@ ovrDrawCounters ovrSurfaceRender::RenderSurfaceList(
                                 if (currentTextures[parmBinding] != texture.texture) {
                                     counters.numTextureBinds++;
                                     currentTextures[parmBinding] = texture.texture;
-                                    GL(glActiveTexture(GL_TEXTURE0 + parmBinding));
+                                    const GLenum unit = GL_TEXTURE0 + parmBinding;
+                                    if (!filter || currentActiveTexture != unit) {
+                                        currentActiveTexture = unit;
+                                        GL(glActiveTexture(unit));
+                                    }
                                     GL(glBindTexture(
                                         texture.target ? texture.target : GL_TEXTURE_2D,
                                         texture.texture));
+                                } else {
+                                    counters.numElidedTextureBinds++;
                                 }
                             }
                         } break;
@@ -395,6 +537,8 @@ ovrDrawCounters ovrSurfaceRender::RenderSurfaceList(
                                     currentBuffers[parmBinding] = buffer.GetBuffer();
                                     GL(glBindBufferBase(
                                         GL_UNIFORM_BUFFER, parmBinding, buffer.GetBuffer()));
+                                } else {
+                                    counters.numElidedBufferBinds++;
                                 }
                             }
                         } break;
@@ -425,9 +569,17 @@ ovrDrawCounters ovrSurfaceRender::RenderSurfaceList(
 
         // Bind all the vertex and element arrays
         {
-            GL(glBindVertexArray(surfaceDef.geo.vertexArrayObject));
+            if (!filter || currentVertexArray != surfaceDef.geo.vertexArrayObject) {
+                counters.numVertexArrayBinds++;
+                currentVertexArray = surfaceDef.geo.vertexArrayObject;
+                GL(glBindVertexArray(surfaceDef.geo.vertexArrayObject));
+            } else {
+                counters.numElidedVertexArrayBinds++;
+            }
 
             if (surfaceDef.numInstances > 1) {
+                counters.numInstancedDrawCalls++;
+                counters.numInstances += surfaceDef.numInstances;
                 GL(glDrawElementsInstanced(
                     surfaceDef.geo.primitiveType,
                     surfaceDef.geo.indexCount,
@@ -29,6 +29,7 @@ Authors     :   John Carmack
 
 #include <vector>
 #include <string>
+#include <memory>
 
 #include "OVR_Math.h"
 
@@ -65,17 +66,35 @@ struct ovrDrawCounters {
     ovrDrawCounters()
         : numElements(0),
           numDrawCalls(0),
+          numInstancedDrawCalls(0),
+          numInstances(0),
           numProgramBinds(0),
           numParameterUpdates(0),
           numTextureBinds(0),
-          numBufferBinds(0) {}
+          numBufferBinds(0),
+          numVertexArrayBinds(0),
+          numElidedProgramBinds(0),
+          numElidedParameterUpdates(0),
+          numElidedTextureBinds(0),
+          numElidedBufferBinds(0),
+          numElidedVertexArrayBinds(0) {}
 
     int numElements;
     int numDrawCalls;
+    int numInstancedDrawCalls; // included in numDrawCalls
+    int numInstances; // drawn by the instanced calls
     int numProgramBinds;
     int numParameterUpdates; // MVP, etc
     int numTextureBinds;
     int numBufferBinds;
+    int numVertexArrayBinds;
+
+    // Calls skipped because the shadow state already had the value
+    int numElidedProgramBinds;
+    int numElidedParameterUpdates;
+    int numElidedTextureBinds;
+    int numElidedBufferBinds;
+    int numElidedVertexArrayBinds;
 };
 
 struct ovrDrawSurface {
@@ -112,7 +131,35 @@ class ovrSurfaceRender {
         const OVR::Matrix4f& projectionMatrix,
         const int eye);
 
+    // Program, texture, uniform buffer and vertex array bindings are tracked within a
+    // RenderSurfaceList call, and the last value uploaded to each uniform of each program
+    // across calls, so that unchanged binds and uploads are skipped. Code that sets
+    // uniforms of framework programs directly has to call InvalidateStateCache afterwards.
+    // Programs deleted with GlProgram::Free are dropped from the cache automatically.
+    void SetStateFiltering(const bool enable) {
+        StateFiltering = enable;
+        InvalidateStateCache();
+    }
+    bool GetStateFiltering() const {
+        return StateFiltering;
+    }
+    void InvalidateStateCache();
+
    private:
+    // Last values uploaded to the uniforms of one program
+    struct ovrProgramShadow {
+        static const int MAX_VALUE_FLOATS = 16; // one Matrix4f
+
+        bool ModelMatrixValid = false;
+        bool ViewIDValid = false;
+        int ViewID = 0;
+        float ModelMatrix[MAX_VALUE_FLOATS];
+        bool UniformValid[ovrUniform::MAX_UNIFORMS] = {};
+        float UniformValues[ovrUniform::MAX_UNIFORMS][MAX_VALUE_FLOATS];
+    };
+
+    ovrProgramShadow& GetProgramShadow(const unsigned int program);
+
     // Returns the index of the updated SceneMatrices UBO.
     int UpdateSceneMatrices(
         const OVR::Matrix4f* viewMatrix,
@@ -130,6 +177,10 @@ class ovrSurfaceRender {
 
     OVR::Matrix4f CachedViewMatrix[GlProgram::MAX_VIEWS];
     OVR::Matrix4f CachedProjectionMatrix[GlProgram::MAX_VIEWS];
+
+    bool StateFiltering;
+    unsigned int ProgramFreeCount; // GlProgram::GetFreeCount() when the cache was last valid
+    std::vector<std::unique_ptr<ovrProgramShadow>> ProgramShadows; // indexed by program name
 };
 
 // Set this true for log spew from BuildDrawSurfaceList and RenderSurfaceList.
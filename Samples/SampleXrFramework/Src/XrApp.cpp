@@ -195,6 +195,8 @@ void XrApp::HandleSessionStateChanges(XrSessionState state) {
 #endif // defined(ANDROID)
         assert(SessionActive);
 
+        // Frames the simulation thread has waited for are finished first
+        StopSimulationThread();
         OXR(xrEndSession(Session));
         SessionActive = false;
     }
@@ -252,6 +254,10 @@ void XrApp::HandleXrEvents() {
                     session_state_changed_event->state,
                     (void*)session_state_changed_event->session,
                     FromXrTime(session_state_changed_event->time));
+                if (PipelineSuspended) {
+                    // The failed xrWaitFrame may work in the new state
+                    PipelineSuspended = false;
+                }
                 SessionStateChanged(session_state_changed_event->state);
 
                 switch (session_state_changed_event->state) {
@@ -389,6 +395,9 @@ std::vector<const char*> XrApp::GetExtensions() {
         XR_EXT_PERFORMANCE_SETTINGS_EXTENSION_NAME,
         XR_KHR_ANDROID_THREAD_SETTINGS_EXTENSION_NAME,
 #endif // defined(XR_USE_PLATFORM_ANDROID)
+#if defined(XR_KHR_locate_spaces)
+        XR_KHR_LOCATE_SPACES_EXTENSION_NAME, // dropped below if the runtime lacks it
+#endif // defined(XR_KHR_locate_spaces)
         XR_KHR_COMPOSITION_LAYER_CUBE_EXTENSION_NAME,
         XR_KHR_COMPOSITION_LAYER_CYLINDER_EXTENSION_NAME};
     return extensions;
@@ -854,6 +863,8 @@ bool XrApp::Init(const xrJava& context) {
             NULL,
             2,
             handSubactionPaths);
+
+        AddDefaultActionBindings();
     }
 
     /// Interaction profile can be overridden
@@ -1047,6 +1058,18 @@ bool XrApp::InitSession() {
         CurrentSpace = StageSpace;
     }
 
+    SpaceLocator.Init(Instance, Session, OpenXRVersion);
+    HeadSpaceIndex = SpaceLocator.Register(HeadSpace);
+    const XrSpace controllerSpaces[] = {
+        LeftControllerAimSpace,
+        LeftControllerGripSpace,
+        RightControllerAimSpace,
+        RightControllerGripSpace,
+    };
+    for (int i = 0; i < 4; i++) {
+        ControllerSpaceIndex[i] = SpaceLocator.Register(controllerSpaces[i]);
+    }
+
     // Create the frame buffers.
     for (int eye = 0; eye < MAX_NUM_EYES; eye++) {
         ovrFramebuffer_Create(
@@ -1073,6 +1096,7 @@ void XrApp::EndSession() {
         ovrFramebuffer_Destroy(&FrameBuffer[eye]);
     }
 
+    SpaceLocator.Shutdown();
     OXR(xrDestroySpace(HeadSpace));
     OXR(xrDestroySpace(LocalSpace));
     // StageSpace is optional.
@@ -1081,6 +1105,8 @@ void XrApp::EndSession() {
     }
     CurrentSpace = XR_NULL_HANDLE;
     SessionEnd();
+    // After the app is done with the scene, while the GL context is still current
+    Scene.Shutdown();
     OXR(xrDestroySession(Session));
 
     ovrEgl_DestroyContext(&Egl);
@@ -1146,11 +1172,72 @@ void XrApp::Clear() {
     RightControllerAimSpace = XR_NULL_HANDLE;
     LeftControllerGripSpace = XR_NULL_HANDLE;
     RightControllerGripSpace = XR_NULL_HANDLE;
-    LastFrameAllButtons = 0u;
-    LastFrameAllTouches = 0u;
+    ActionTable.Clear();
 }
 
 // Internal Input
+void XrApp::AddDefaultActionBindings() {
+    auto add = [this](
+                   XrAction action,
+                   XrPath subactionPath,
+                   XrActionType type,
+                   uint32_t buttonMask,
+                   uint32_t touchMask,
+                   int floatSlot = -1,
+                   int vectorSlot = -1) {
+        ovrActionBinding binding;
+        binding.Action = action;
+        binding.SubactionPath = subactionPath;
+        binding.Type = type;
+        binding.ButtonMask = buttonMask;
+        binding.TouchMask = touchMask;
+        binding.Threshold = type == XR_ACTION_TYPE_FLOAT_INPUT ? 0.1f : 0.0f;
+        binding.FloatSlot = floatSlot;
+        binding.VectorSlot = vectorSlot;
+        ActionTable.Add(binding);
+    };
+    const XrActionType kBool = XR_ACTION_TYPE_BOOLEAN_INPUT;
+    const XrActionType kFloat = XR_ACTION_TYPE_FLOAT_INPUT;
+    const XrActionType kVector2 = XR_ACTION_TYPE_VECTOR2F_INPUT;
+
+    add(ButtonAAction, XR_NULL_PATH, kBool, ovrApplFrameIn::kButtonA, 0u);
+    add(ButtonBAction, XR_NULL_PATH, kBool, ovrApplFrameIn::kButtonB, 0u);
+    add(ButtonXAction, XR_NULL_PATH, kBool, ovrApplFrameIn::kButtonX, 0u);
+    add(ButtonYAction, XR_NULL_PATH, kBool, ovrApplFrameIn::kButtonY, 0u);
+    add(ButtonMenuAction, XR_NULL_PATH, kBool, ovrApplFrameIn::kButtonMenu, 0u);
+    add(thumbstickClickAction, LeftHandPath, kBool, ovrApplFrameIn::kButtonLeftThumbStick, 0u);
+    add(thumbstickClickAction, RightHandPath, kBool, ovrApplFrameIn::kButtonRightThumbStick, 0u);
+    add(IndexTriggerAction,
+        LeftHandPath,
+        kFloat,
+        ovrApplFrameIn::kTrigger,
+        0u,
+        ovrApplFrameIn::kInputLeftIndexTrigger);
+    add(IndexTriggerAction,
+        RightHandPath,
+        kFloat,
+        ovrApplFrameIn::kTrigger,
+        0u,
+        ovrApplFrameIn::kInputRightIndexTrigger);
+    add(GripTriggerAction,
+        LeftHandPath,
+        kFloat,
+        ovrApplFrameIn::kGripTrigger,
+        0u,
+        ovrApplFrameIn::kInputLeftGripTrigger);
+    add(GripTriggerAction,
+        RightHandPath,
+        kFloat,
+        ovrApplFrameIn::kGripTrigger,
+        0u,
+        ovrApplFrameIn::kInputRightGripTrigger);
+    add(JoystickAction, LeftHandPath, kVector2, 0u, 0u, -1, ovrApplFrameIn::kInputLeftJoystick);
+    add(JoystickAction, RightHandPath, kVector2, 0u, 0u, -1, ovrApplFrameIn::kInputRightJoystick);
+    add(ThumbStickTouchAction, XR_NULL_PATH, kBool, 0u, ovrApplFrameIn::kTouchJoystick);
+    add(ThumbRestTouchAction, XR_NULL_PATH, kBool, 0u, ovrApplFrameIn::kTouchThumbrest);
+    add(TriggerTouchAction, XR_NULL_PATH, kBool, 0u, ovrApplFrameIn::kTouchTrigger);
+}
+
 void XrApp::AttachActionSets() {
     XrSessionActionSetsAttachInfo attachInfo = {XR_TYPE_SESSION_ACTION_SETS_ATTACH_INFO};
     attachInfo.countActionSets = 1;
@@ -1166,26 +1253,23 @@ void XrApp::SyncActionSets(ovrApplFrameIn& in) {
     syncInfo.activeActionSets = &activeActionSet;
     OXR(xrSyncActions(Session, &syncInfo));
 
-    // query input action states
-    XrActionStateGetInfo getInfo = {XR_TYPE_ACTION_STATE_GET_INFO};
-    getInfo.subactionPath = XR_NULL_PATH;
+    // MainLoop has normally located everything for this display time already, then
+    // this is a no-op
+    SpaceLocator.Locate(CurrentSpace, ToXrTime(in.PredictedDisplayTime));
 
     XrAction controller[] = {AimPoseAction, GripPoseAction, AimPoseAction, GripPoseAction};
     XrPath subactionPath[] = {LeftHandPath, LeftHandPath, RightHandPath, RightHandPath};
-    XrSpace controllerSpace[] = {
-        LeftControllerAimSpace,
-        LeftControllerGripSpace,
-        RightControllerAimSpace,
-        RightControllerGripSpace,
-    };
     bool ControllerPoseActive[] = {false, false, false, false};
     XrPosef ControllerPose[] = {{}, {}, {}, {}};
+    OVR::Vector3f ControllerLinearVelocity[4];
+    OVR::Vector3f ControllerAngularVelocity[4];
     for (int i = 0; i < 4; i++) {
         if (ActionPoseIsActive(controller[i], subactionPath[i])) {
-            LocVel lv = GetSpaceLocVel(controllerSpace[i], ToXrTime(in.PredictedDisplayTime));
-            ControllerPoseActive[i] =
-                (lv.loc.locationFlags & XR_SPACE_LOCATION_POSITION_VALID_BIT) != 0;
-            ControllerPose[i] = lv.loc.pose;
+            const ovrSpaceLocation& location = SpaceLocator.Get(ControllerSpaceIndex[i]);
+            ControllerPoseActive[i] = location.IsPositionValid();
+            ControllerPose[i] = location.Pose;
+            ControllerLinearVelocity[i] = FromXrVector3f(location.LinearVelocity);
+            ControllerAngularVelocity[i] = FromXrVector3f(location.AngularVelocity);
         } else {
             ControllerPoseActive[i] = false;
             XrPosef_CreateIdentity(&ControllerPose[i]);
@@ -1204,9 +1288,10 @@ void XrApp::SyncActionSets(ovrApplFrameIn& in) {
 #endif
 
     /// Update pose
-    XrSpaceLocation loc = {XR_TYPE_SPACE_LOCATION};
-    OXR(xrLocateSpace(HeadSpace, CurrentSpace, ToXrTime(in.PredictedDisplayTime), &loc));
-    in.HeadPose = FromXrPosef(loc.pose);
+    const ovrSpaceLocation& head = SpaceLocator.Get(HeadSpaceIndex);
+    in.HeadPose = FromXrPosef(head.Pose);
+    in.HeadLinearVelocity = FromXrVector3f(head.LinearVelocity);
+    in.HeadAngularVelocity = FromXrVector3f(head.AngularVelocity);
     /// grip & point space
     in.LeftRemotePointPose = FromXrPosef(ControllerPose[0]);
     in.LeftRemotePose = FromXrPosef(ControllerPose[1]);
@@ -1214,83 +1299,19 @@ void XrApp::SyncActionSets(ovrApplFrameIn& in) {
     in.RightRemotePose = FromXrPosef(ControllerPose[3]);
     in.LeftRemoteTracked = ControllerPoseActive[1];
     in.RightRemoteTracked = ControllerPoseActive[3];
-
-    in.LeftRemoteIndexTrigger = GetActionStateFloat(IndexTriggerAction, LeftHandPath).currentState;
-    in.RightRemoteIndexTrigger =
-        GetActionStateFloat(IndexTriggerAction, RightHandPath).currentState;
-    in.LeftRemoteGripTrigger = GetActionStateFloat(GripTriggerAction, LeftHandPath).currentState;
-    in.RightRemoteGripTrigger = GetActionStateFloat(GripTriggerAction, RightHandPath).currentState;
-    in.LeftRemoteJoystick =
-        FromXrVector2f(GetActionStateVector2(JoystickAction, LeftHandPath).currentState);
-    in.RightRemoteJoystick =
-        FromXrVector2f(GetActionStateVector2(JoystickAction, RightHandPath).currentState);
-
-    bool aPressed = GetActionStateBoolean(ButtonAAction).currentState;
-    bool bPressed = GetActionStateBoolean(ButtonBAction).currentState;
-    bool xPressed = GetActionStateBoolean(ButtonXAction).currentState;
-    bool yPressed = GetActionStateBoolean(ButtonYAction).currentState;
-    bool menuPressed = GetActionStateBoolean(ButtonMenuAction).currentState;
-    bool leftThumbPressed = GetActionStateBoolean(thumbstickClickAction, LeftHandPath).currentState;
-    bool rightThumbPressed =
-        GetActionStateBoolean(thumbstickClickAction, RightHandPath).currentState;
-
-    in.LastFrameAllButtons = LastFrameAllButtons;
-    in.AllButtons = 0u;
-
-    if (aPressed) {
-        in.AllButtons |= ovrApplFrameIn::kButtonA;
-    }
-    if (bPressed) {
-        in.AllButtons |= ovrApplFrameIn::kButtonB;
-    }
-    if (xPressed) {
-        in.AllButtons |= ovrApplFrameIn::kButtonX;
-    }
-    if (yPressed) {
-        in.AllButtons |= ovrApplFrameIn::kButtonY;
-    }
-    if (menuPressed) {
-        in.AllButtons |= ovrApplFrameIn::kButtonMenu;
-    }
-    if (leftThumbPressed) {
-        in.AllButtons |= ovrApplFrameIn::kButtonLeftThumbStick;
-    }
-    if (rightThumbPressed) {
-        in.AllButtons |= ovrApplFrameIn::kButtonRightThumbStick;
-    }
-    if (in.LeftRemoteIndexTrigger > 0.1f) {
-        in.AllButtons |= ovrApplFrameIn::kTrigger;
-    }
-    if (in.RightRemoteIndexTrigger > 0.1f) {
-        in.AllButtons |= ovrApplFrameIn::kTrigger;
-    }
-    if (in.LeftRemoteGripTrigger > 0.1f) {
-        in.AllButtons |= ovrApplFrameIn::kGripTrigger;
-    }
-    if (in.RightRemoteGripTrigger > 0.1f) {
-        in.AllButtons |= ovrApplFrameIn::kGripTrigger;
-    }
-    LastFrameAllButtons = in.AllButtons;
-
-    /// touch
-    in.LastFrameAllTouches = LastFrameAllTouches;
-    in.AllTouches = 0u;
-
-    const bool thumbstickTouched = GetActionStateBoolean(ThumbStickTouchAction).currentState;
-    const bool thumbrestTouched = GetActionStateBoolean(ThumbRestTouchAction).currentState;
-    const bool triggerTouched = GetActionStateBoolean(TriggerTouchAction).currentState;
-
-    if (thumbstickTouched) {
-        in.AllTouches |= ovrApplFrameIn::kTouchJoystick;
-    }
-    if (thumbrestTouched) {
-        in.AllTouches |= ovrApplFrameIn::kTouchThumbrest;
-    }
-    if (triggerTouched) {
-        in.AllTouches |= ovrApplFrameIn::kTouchTrigger;
-    }
-
-    LastFrameAllTouches = in.AllTouches;
+    in.LeftRemoteLinearVelocity = ControllerLinearVelocity[1];
+    in.LeftRemoteAngularVelocity = ControllerAngularVelocity[1];
+    in.RightRemoteLinearVelocity = ControllerLinearVelocity[3];
+    in.RightRemoteAngularVelocity = ControllerAngularVelocity[3];
+
+    /// buttons, touches, triggers and joysticks in one pass over the action table
+    ActionTable.Sync(Session, ToXrTime(in.PredictedDisplayTime), in);
+    in.LeftRemoteIndexTrigger = in.InputFloats[ovrApplFrameIn::kInputLeftIndexTrigger];
+    in.RightRemoteIndexTrigger = in.InputFloats[ovrApplFrameIn::kInputRightIndexTrigger];
+    in.LeftRemoteGripTrigger = in.InputFloats[ovrApplFrameIn::kInputLeftGripTrigger];
+    in.RightRemoteGripTrigger = in.InputFloats[ovrApplFrameIn::kInputRightGripTrigger];
+    in.LeftRemoteJoystick = in.InputVectors[ovrApplFrameIn::kInputLeftJoystick];
+    in.RightRemoteJoystick = in.InputVectors[ovrApplFrameIn::kInputRightJoystick];
 
     /*
         /// timing
@@ -1306,15 +1327,17 @@ void XrApp::SyncActionSets(ovrApplFrameIn& in) {
 void XrApp::HandleInput(ovrApplFrameIn& in) {
     if (!SkipInputHandling) {
         // Sync default actions
+        ovrFramePhaseScope timing(GetSimulationTimer(), FRAME_PHASE_SYNC_ACTIONS);
         SyncActionSets(in);
     }
 
     // Call application Update function
+    ovrFramePhaseScope timing(GetSimulationTimer(), FRAME_PHASE_UPDATE);
     Update(in);
 }
 
-// Called once per frame to allow the application to render eye buffers.
-void XrApp::AppRenderFrame(const OVRFW::ovrApplFrameIn& in, OVRFW::ovrRendererOutput& out) {
+// Called once per frame after Update to advance the scene and build the surface list.
+void XrApp::AppSimulateFrame(const OVRFW::ovrApplFrameIn& in, OVRFW::ovrRendererOutput& out) {
     Scene.SetFreeMove(FreeMove);
     /// create a local copy
     OVRFW::ovrApplFrameIn localIn = in;
@@ -1324,13 +1347,23 @@ void XrApp::AppRenderFrame(const OVRFW::ovrApplFrameIn& in, OVRFW::ovrRendererOu
         localIn.RightRemoteJoystick.x = 0.0f;
         localIn.RightRemoteJoystick.y = 0.0f;
     }
+    ovrFramePhaseScope timing(GetSimulationTimer(), FRAME_PHASE_SCENE);
     Scene.Frame(localIn);
     Scene.GenerateFrameSurfaceList(out.FrameMatrices, out.Surfaces);
+}
+
+// Called once per frame to allow the application to render eye buffers.
+void XrApp::AppRenderFrame(const OVRFW::ovrApplFrameIn& in, OVRFW::ovrRendererOutput& out) {
     if (ShouldRender) {
+        ovrFramePhaseScope timing(FrameTimer, FRAME_PHASE_RENDER);
         Render(in, out);
+        // Uploads instance matrices, so here on the GL thread and not in AppSimulateFrame
+        Scene.BatchInstances(out.Surfaces);
     }
 
     for (int eye = 0; eye < MAX_NUM_EYES; eye++) {
+        ovrFramePhaseScope timing(
+            FrameTimer, eye == 0 ? FRAME_PHASE_RENDER_EYE_0 : FRAME_PHASE_RENDER_EYE_1);
         ovrFramebuffer* frameBuffer = &FrameBuffer[eye];
         ovrFramebuffer_Acquire(frameBuffer);
         ovrFramebuffer_SetCurrent(frameBuffer);
@@ -1346,11 +1379,15 @@ void XrApp::AppRenderFrame(const OVRFW::ovrApplFrameIn& in, OVRFW::ovrRendererOu
 
 void XrApp::AppRenderEye(const OVRFW::ovrApplFrameIn& in, OVRFW::ovrRendererOutput& out, int eye) {
     // Render the surfaces returned by Frame.
-    SurfaceRender.RenderSurfaceList(
+    const ovrDrawCounters counters = SurfaceRender.RenderSurfaceList(
         out.Surfaces,
         out.FrameMatrices.EyeView[0], // always use 0 as it assumes an array
         out.FrameMatrices.EyeProjection[0], // always use 0 as it assumes an array
         eye);
+    FrameTimer.AddCount(FRAME_COUNTER_DRAW_CALLS, counters.numDrawCalls);
+    FrameTimer.AddCount(FRAME_COUNTER_PROGRAM_BINDS, counters.numProgramBinds);
+    FrameTimer.AddCount(FRAME_COUNTER_TEXTURE_BINDS, counters.numTextureBinds);
+    FrameTimer.AddCount(FRAME_COUNTER_BUFFER_BINDS, counters.numBufferBinds);
 }
 
 // Called once per eye each frame for default renderer
@@ -1477,7 +1514,13 @@ void XrApp::MainLoop(MainLoopContext& loopContext) {
 
         loopContext.HandleOsEvents();
 
-        HandleXrEvents();
+        // A frame that stops before xrEndFrame is never published
+        FrameTimer.BeginFrame(frameCount);
+
+        {
+            ovrFramePhaseScope timing(FrameTimer, FRAME_PHASE_XR_EVENTS);
+            HandleXrEvents();
+        }
 
         if (loopContext.IsExitRequested()) {
             break;
@@ -1495,114 +1538,268 @@ void XrApp::MainLoop(MainLoopContext& loopContext) {
             stageBoundsDirty = false;
         }
 
-        // NOTE: OpenXR does not use the concept of frame indices. Instead,
-        // XrWaitFrame returns the predicted display time.
-        XrFrameWaitInfo waitFrameInfo = {XR_TYPE_FRAME_WAIT_INFO};
+        if (FramePipelineDepth > 0 && !PipelineSuspended) {
+            RenderPipelinedFrame();
+            continue;
+        }
+
+        ovrFramePacket& packet = SerialPacket;
+        packet.FrameIndex = frameCount;
+        WaitFrame(packet);
+        BeginXrFrame();
+        SimulateFrame(packet);
+        RenderFramePacket(packet);
+        FrameTimer.EndFrame();
+    }
+
+    StopSimulationThread();
+    SimulationTimer.StopTrace();
+    FrameTimer.StopTrace();
+
+    EndSession();
+    Shutdown(loopContext.GetJavaContext());
+}
+
+// NOTE: OpenXR does not use the concept of frame indices. Instead,
+// XrWaitFrame returns the predicted display time.
+bool XrApp::WaitFrame(ovrFramePacket& packet) {
+    ovrFramePhaseScope timing(GetSimulationTimer(), FRAME_PHASE_WAIT_FRAME);
+    XrFrameWaitInfo waitFrameInfo = {XR_TYPE_FRAME_WAIT_INFO};
+    packet.FrameState = {XR_TYPE_FRAME_STATE};
+    PreWaitFrame(waitFrameInfo);
+    XrResult result;
+    OXR(result = xrWaitFrame(Session, &waitFrameInfo, &packet.FrameState));
+    return XR_SUCCEEDED(result);
+}
 
-        PreWaitFrame(waitFrameInfo);
+// Locates the head, views and controllers for the frame's predicted display time, then
+// runs input, Update and AppSimulateFrame. Fills the packet and nothing else that the
+// render side reads.
+void XrApp::SimulateFrame(ovrFramePacket& packet) {
+    ovrFrameTimer& timer = GetSimulationTimer();
+    const uint64_t locateStartNs = timer.IsEnabled() ? ovrFrameTimer::NowNs() : 0;
+    const XrTime displayTime = packet.FrameState.predictedDisplayTime;
+
+    // Get the HMD pose, predicted for the middle of the time period during which
+    // the new eye images will be displayed. The number of frames predicted ahead
+    // depends on the pipeline depth of the engine and the synthesis rate.
+    // The better the prediction, the less black will be pulled in at the edges.
+    // Head, controllers and app spaces in one go; SyncActionSets reads from here
+    SpaceLocator.Locate(CurrentSpace, displayTime);
+    XrPosef xfStageFromHead = SpaceLocator.Get(HeadSpaceIndex).Pose;
+
+    XrViewState viewState = {XR_TYPE_VIEW_STATE};
+
+    XrViewLocateInfo projectionInfo = {XR_TYPE_VIEW_LOCATE_INFO};
+    projectionInfo.viewConfigurationType = ViewportConfig.viewConfigurationType;
+    projectionInfo.displayTime = displayTime;
+    projectionInfo.space = HeadSpace;
+
+    uint32_t projectionCapacityInput = MAX_NUM_EYES;
+    uint32_t projectionCountOutput = projectionCapacityInput;
+
+    PreLocateViews(projectionInfo);
+    OXR(xrLocateViews(
+        Session,
+        &projectionInfo,
+        &viewState,
+        projectionCapacityInput,
+        &projectionCountOutput,
+        packet.Projections));
+
+    OVRFW::ovrApplFrameIn& in = packet.In;
+    OVRFW::ovrRendererOutput& out = packet.Out;
+    in = {};
+    out.Surfaces.clear(); // keeps the capacity of the reused packet
+    in.FrameIndex = packet.FrameIndex;
+
+    /// time accounting
+    in.PredictedDisplayTime = FromXrTime(displayTime);
+    if (PrevDisplayTime > 0) {
+        in.DeltaSeconds = FromXrTime(displayTime - PrevDisplayTime);
+    }
+    PrevDisplayTime = displayTime;
 
-        XrFrameState frameState = {XR_TYPE_FRAME_STATE};
+    for (int eye = 0; eye < MAX_NUM_EYES; eye++) {
+        XrPosef xfHeadFromEye = packet.Projections[eye].pose;
+        XrPosef xfStageFromEye{};
+        XrPosef_Multiply(&xfStageFromEye, &xfStageFromHead, &xfHeadFromEye);
+        XrPosef_Invert(&packet.ViewTransform[eye], &xfStageFromEye);
+        XrMatrix4x4f viewMat{};
+        XrMatrix4x4f_CreateFromRigidTransform(&viewMat, &packet.ViewTransform[eye]);
+        const XrFovf fov = packet.Projections[eye].fov;
+        XrMatrix4x4f projMat;
+        XrMatrix4x4f_CreateProjectionFov(&projMat, GRAPHICS_OPENGL_ES, fov, 0.1f, 0.0f);
+        out.FrameMatrices.EyeView[eye] = FromXrMatrix4x4f(viewMat);
+        out.FrameMatrices.EyeProjection[eye] = FromXrMatrix4x4f(projMat);
+        in.Eye[eye].ViewMatrix = out.FrameMatrices.EyeView[eye];
+        in.Eye[eye].ProjectionMatrix = out.FrameMatrices.EyeProjection[eye];
+    }
 
-        OXR(xrWaitFrame(Session, &waitFrameInfo, &frameState));
+    XrPosef centerView;
+    XrPosef_Invert(&centerView, &xfStageFromHead);
+    XrMatrix4x4f viewMat{};
+    XrMatrix4x4f_CreateFromRigidTransform(&viewMat, &centerView);
+    out.FrameMatrices.CenterView = FromXrMatrix4x4f(viewMat);
+    if (locateStartNs != 0) {
+        timer.AddPhase(FRAME_PHASE_LOCATE_VIEWS, locateStartNs, ovrFrameTimer::NowNs());
+    }
 
-        // Get the HMD pose, predicted for the middle of the time period during which
-        // the new eye images will be displayed. The number of frames predicted ahead
-        // depends on the pipeline depth of the engine and the synthesis rate.
-        // The better the prediction, the less black will be pulled in at the edges.
-        XrFrameBeginInfo beginFrameDesc = {XR_TYPE_FRAME_BEGIN_INFO};
-        OXR(xrBeginFrame(Session, &beginFrameDesc));
-        ShouldRender = frameState.shouldRender;
+    // Input
+    HandleInput(in);
 
-        XrSpaceLocation loc = {XR_TYPE_SPACE_LOCATION};
-        OXR(xrLocateSpace(HeadSpace, CurrentSpace, frameState.predictedDisplayTime, &loc));
-        XrPosef xfStageFromHead = loc.pose;
-        OXR(xrLocateSpace(HeadSpace, LocalSpace, frameState.predictedDisplayTime, &loc));
+    AppSimulateFrame(in, out);
+}
 
-        XrViewState viewState = {XR_TYPE_VIEW_STATE};
+void XrApp::BeginXrFrame() {
+    ovrFramePhaseScope timing(FrameTimer, FRAME_PHASE_BEGIN_FRAME);
+    XrFrameBeginInfo beginFrameDesc = {XR_TYPE_FRAME_BEGIN_INFO};
+    OXR(xrBeginFrame(Session, &beginFrameDesc));
+}
 
-        XrViewLocateInfo projectionInfo = {XR_TYPE_VIEW_LOCATE_INFO};
-        projectionInfo.viewConfigurationType = ViewportConfig.viewConfigurationType;
-        projectionInfo.displayTime = frameState.predictedDisplayTime;
-        projectionInfo.space = HeadSpace;
+// Renders a simulated frame and submits it with the display time and view poses it was
+// simulated for, so the compositor reprojects from the same prediction.
+void XrApp::RenderFramePacket(ovrFramePacket& packet) {
+    ShouldRender = packet.FrameState.shouldRender;
+    // ProjectionAddLayer and app layer overrides read these members
+    for (int eye = 0; eye < MAX_NUM_EYES; eye++) {
+        Projections[eye] = packet.Projections[eye];
+        ViewTransform[eye] = packet.ViewTransform[eye];
+    }
 
-        uint32_t projectionCapacityInput = MAX_NUM_EYES;
-        uint32_t projectionCountOutput = projectionCapacityInput;
+    LayerCount = 0;
+    memset(Layers, 0, sizeof(xrCompositorLayerUnion) * MAX_NUM_LAYERS);
 
-        PreLocateViews(projectionInfo);
-        OXR(xrLocateViews(
-            Session,
-            &projectionInfo,
-            &viewState,
-            projectionCapacityInput,
-            &projectionCountOutput,
-            Projections));
-
-        OVRFW::ovrApplFrameIn in = {};
-        OVRFW::ovrRendererOutput out = {};
-        in.FrameIndex = frameCount;
-
-        /// time accounting
-        in.PredictedDisplayTime = FromXrTime(frameState.predictedDisplayTime);
-        if (PrevDisplayTime > 0) {
-            in.DeltaSeconds = FromXrTime(frameState.predictedDisplayTime - PrevDisplayTime);
-        }
-        PrevDisplayTime = frameState.predictedDisplayTime;
-
-        for (int eye = 0; eye < MAX_NUM_EYES; eye++) {
-            XrPosef xfHeadFromEye = Projections[eye].pose;
-            XrPosef xfStageFromEye{};
-            XrPosef_Multiply(&xfStageFromEye, &xfStageFromHead, &xfHeadFromEye);
-            XrPosef_Invert(&ViewTransform[eye], &xfStageFromEye);
-            XrMatrix4x4f viewMat{};
-            XrMatrix4x4f_CreateFromRigidTransform(&viewMat, &ViewTransform[eye]);
-            const XrFovf fov = Projections[eye].fov;
-            XrMatrix4x4f projMat;
-            XrMatrix4x4f_CreateProjectionFov(&projMat, GRAPHICS_OPENGL_ES, fov, 0.1f, 0.0f);
-            out.FrameMatrices.EyeView[eye] = FromXrMatrix4x4f(viewMat);
-            out.FrameMatrices.EyeProjection[eye] = FromXrMatrix4x4f(projMat);
-            in.Eye[eye].ViewMatrix = out.FrameMatrices.EyeView[eye];
-            in.Eye[eye].ProjectionMatrix = out.FrameMatrices.EyeProjection[eye];
-        }
+    // allow apps to submit a layer before the world view projection layer (uncommon)
+    PreProjectionAddLayer(Layers, LayerCount);
 
-        XrPosef centerView;
-        XrPosef_Invert(&centerView, &xfStageFromHead);
-        XrMatrix4x4f viewMat{};
-        XrMatrix4x4f_CreateFromRigidTransform(&viewMat, &centerView);
-        out.FrameMatrices.CenterView = FromXrMatrix4x4f(viewMat);
+    // Render the world-view layer (projection)
+    AppRenderFrame(packet.In, packet.Out);
+    ProjectionAddLayer(Layers, LayerCount);
 
-        // Input
-        HandleInput(in);
+    // allow apps to submit a layer after the world view projection layer (uncommon)
+    PostProjectionAddLayer(Layers, LayerCount);
 
-        LayerCount = 0;
-        memset(Layers, 0, sizeof(xrCompositorLayerUnion) * MAX_NUM_LAYERS);
+    EndXrFrame(packet.FrameState.predictedDisplayTime, LayerCount);
+}
+
+void XrApp::EndXrFrame(XrTime displayTime, int layerCount) {
+    ovrFramePhaseScope timing(FrameTimer, FRAME_PHASE_END_FRAME);
+
+    // Compose the layers for this frame.
+    const XrCompositionLayerBaseHeader* layers[MAX_NUM_LAYERS] = {};
+    for (int i = 0; i < layerCount; i++) {
+        layers[i] = (const XrCompositionLayerBaseHeader*)&Layers[i];
+    }
+
+    XrFrameEndInfo endFrameInfo = {XR_TYPE_FRAME_END_INFO};
+    endFrameInfo.displayTime = displayTime;
+    endFrameInfo.environmentBlendMode = XR_ENVIRONMENT_BLEND_MODE_OPAQUE;
+    endFrameInfo.layerCount = layerCount;
+    endFrameInfo.layers = layers;
+
+    OXR(xrEndFrame(Session, &endFrameInfo));
+}
+
+void XrApp::SetFramePipelineDepth(int depth) {
+    if (SimulationThread.joinable()) {
+        ALOGW("SetFramePipelineDepth: ignored while the simulation thread runs");
+        return;
+    }
+    FramePipelineDepth = depth < 0 ? 0 : depth;
+}
 
-        // allow apps to submit a layer before the world view projection layer (uncommon)
-        PreProjectionAddLayer(Layers, LayerCount);
+// One MainLoop iteration in pipelined mode: render the oldest simulated frame, if any
+void XrApp::RenderPipelinedFrame() {
+    if (SimulationThread.joinable() && Pipeline.IsProducerDone() && Pipeline.GetQueued() == 0) {
+        // xrWaitFrame failed on the simulation thread. A new thread would most likely fail
+        // the same way right away, so frames are serial until the session state changes.
+        StopSimulationThread();
+        PipelineSuspended = true;
+        ALOGW("RenderPipelinedFrame: xrWaitFrame failed, serial frames until the next state");
+        return;
+    }
+    if (!SimulationThread.joinable()) {
+        StartSimulationThread();
+    }
 
-        // Render the world-view layer (projection)
-        AppRenderFrame(in, out);
-        ProjectionAddLayer(Layers, LayerCount);
+    // Short timeout so OS and OpenXR events are still handled when simulation is slow
+    ovrFramePacket* packet = Pipeline.BeginRead(std::chrono::milliseconds(10));
+    if (packet == nullptr) {
+        return;
+    }
+    FrameTimer.SetFrameIndex(packet->FrameIndex);
+    BeginXrFrame();
+    RenderFramePacket(*packet);
+    Pipeline.EndRead();
+    FrameTimer.EndFrame();
+}
 
-        // allow apps to submit a layer after the world view projection layer (uncommon)
-        PostProjectionAddLayer(Layers, LayerCount);
+void XrApp::StartSimulationThread() {
+    // Frames simulated ahead are rendered later, so instance buffers are reused later too
+    Scene.ReserveInstanceFrameSets(ovrInstanceBatcher::GPU_FRAMES_IN_FLIGHT + FramePipelineDepth);
+    Pipeline.Start(FramePipelineDepth);
+    SimulationTimer.SetEnabled(FrameTimer.IsEnabled());
+    SimulationThread = std::thread(&XrApp::SimulationThreadMain, this);
+}
 
-        // Compose the layers for this frame.
-        const XrCompositionLayerBaseHeader* layers[MAX_NUM_LAYERS] = {};
-        for (int i = 0; i < LayerCount; i++) {
-            layers[i] = (const XrCompositionLayerBaseHeader*)&Layers[i];
+// Must run on the MainLoop thread while the session is still running
+void XrApp::StopSimulationThread() {
+    if (!SimulationThread.joinable()) {
+        return;
+    }
+    Pipeline.RequestStop();
+    // The simulation thread can be blocked in xrWaitFrame until the frame it waited for
+    // before is begun, so frames keep being begun and ended, without layers, until it exits
+    while (!Pipeline.IsProducerDone() || Pipeline.GetQueued() > 0) {
+        ovrFramePacket* packet = Pipeline.BeginRead(std::chrono::milliseconds(5));
+        if (packet != nullptr) {
+            BeginXrFrame();
+            EndXrFrame(packet->FrameState.predictedDisplayTime, 0);
+            Pipeline.EndRead();
         }
+    }
+    SimulationThread.join();
+}
 
-        XrFrameEndInfo endFrameInfo = {XR_TYPE_FRAME_END_INFO};
-        endFrameInfo.displayTime = frameState.predictedDisplayTime;
-        endFrameInfo.environmentBlendMode = XR_ENVIRONMENT_BLEND_MODE_OPAQUE;
-        endFrameInfo.layerCount = LayerCount;
-        endFrameInfo.layers = layers;
+void XrApp::SimulationThreadMain() {
+#if defined(ANDROID)
+    // Update may call into Java
+    JNIEnv* env = nullptr;
+    Context.Vm->AttachCurrentThread(&env, nullptr);
+    prctl(PR_SET_NAME, (long)"XrApp::Sim", 0, 0, 0);
 
-        OXR(xrEndFrame(Session, &endFrameInfo));
+    PFN_xrSetAndroidApplicationThreadKHR pfnSetAndroidApplicationThreadKHR = NULL;
+    OXR(xrGetInstanceProcAddr(
+        Instance,
+        "xrSetAndroidApplicationThreadKHR",
+        (PFN_xrVoidFunction*)(&pfnSetAndroidApplicationThreadKHR)));
+    if (pfnSetAndroidApplicationThreadKHR != NULL) {
+        OXR(pfnSetAndroidApplicationThreadKHR(
+            Session, XR_ANDROID_THREAD_TYPE_APPLICATION_WORKER_KHR, gettid()));
     }
+#endif // defined(ANDROID)
 
-    EndSession();
-    Shutdown(loopContext.GetJavaContext());
+    int64_t frameIndex = 0;
+    for (;;) {
+        ovrFramePacket* packet = Pipeline.BeginWrite();
+        if (packet == nullptr) {
+            break;
+        }
+        SimulationTimer.BeginFrame(frameIndex);
+        packet->FrameIndex = frameIndex++;
+        if (!WaitFrame(*packet)) {
+            break;
+        }
+        SimulateFrame(*packet);
+        Pipeline.EndWrite();
+        SimulationTimer.EndFrame();
+    }
+    Pipeline.FinishWriting();
+
+#if defined(ANDROID)
+    Context.Vm->DetachCurrentThread();
+#endif // defined(ANDROID)
 }
 
 void XrApp::ProjectionAddLayer(xrCompositorLayerUnion* layers, int& layerCount) {
@@ -16,6 +16,7 @@ Language    :   c++
 #include <unordered_map>
 #include <mutex>
 #include <memory>
+#include <thread>
 
 #include "OVR_Math.h"
 
@@ -86,6 +87,10 @@ typedef void(GL_APIENTRY* PFNGLFRAMEBUFFERTEXTURE2DMULTISAMPLEEXTPROC)(
 #include <meta_openxr_preview/openxr_oculus_helpers.h>
 #include <openxr/openxr_platform.h>
 
+#include "Input/ActionTable.h"
+#include "Input/SpaceLocator.h"
+#include "Misc/FramePipeline.h"
+#include "Misc/FrameTiming.h"
 #include "Model/SceneView.h"
 #include "Render/Framebuffer.h"
 #include "Render/SurfaceRender.h"
@@ -323,6 +328,16 @@ class XrApp {
     OVRFW::OvrSceneView& GetScene() {
         return Scene;
     }
+    // Per-phase timing of MainLoop, disabled until SetEnabled(true)
+    OVRFW::ovrFrameTimer& GetFrameTimer() {
+        return FrameTimer;
+    }
+    // Where the wait, locate, input, Update and scene phases go: the same timer as
+    // GetFrameTimer when MainLoop is serial, a separate one for the simulation thread
+    // when it is pipelined (enabled together with FrameTimer when the thread starts)
+    OVRFW::ovrFrameTimer& GetSimulationTimer() {
+        return FramePipelineDepth > 0 && !PipelineSuspended ? SimulationTimer : FrameTimer;
+    }
 
     void SetRunWhilePaused(bool b) {
         RunWhilePaused = b;
@@ -394,9 +409,13 @@ class XrApp {
     virtual void AppLostFocus();
     // Called when app re-gains focus
     virtual void AppGainedFocus();
+    // Called once per frame after Update to advance the scene and build the surface list.
+    // Runs on the simulation thread when MainLoop is pipelined, so it must not touch GL.
+    virtual void AppSimulateFrame(const OVRFW::ovrApplFrameIn& in, OVRFW::ovrRendererOutput& out);
     // Called once per frame to allow the application to render eye buffers.
     virtual void AppRenderFrame(const OVRFW::ovrApplFrameIn& in, OVRFW::ovrRendererOutput& out);
-    // Called once per eye each frame for default renderer
+    // Called once per eye each frame for default renderer. Adds its ovrDrawCounters to
+    // the frame timer's counters; an override has to do that itself.
     virtual void
     AppRenderEye(const OVRFW::ovrApplFrameIn& in, OVRFW::ovrRendererOutput& out, int eye);
     // Called once per eye each frame for default renderer
@@ -474,6 +493,15 @@ class XrApp {
     XrSpace& GetCurrentSpace() {
         return CurrentSpace;
     }
+    // Head, controller and app-registered spaces located once per frame in CurrentSpace
+    // at the predicted display time
+    OVRFW::ovrSpaceLocator& GetSpaceLocator() {
+        return SpaceLocator;
+    }
+    // Bindings read into ovrApplFrameIn every frame; add app actions from AppInit
+    OVRFW::ovrActionTable& GetActionTable() {
+        return ActionTable;
+    }
 
     virtual XrActionSet
     CreateActionSet(uint32_t priority, const char* name, const char* localizedName);
@@ -501,6 +529,8 @@ class XrApp {
     XrApp::LocVel GetSpaceLocVel(XrSpace space, XrTime time);
 
     /// XR Input state overrides
+    // Fills ActionTable with the controller buttons, triggers, joysticks and touches
+    void AddDefaultActionBindings();
     virtual void AttachActionSets();
     virtual void SyncActionSets(ovrApplFrameIn& in);
 
@@ -519,6 +549,31 @@ class XrApp {
         return PrevDisplayTime;
     }
 
+    // 0 (the default) runs MainLoop serially on one thread. With depth > 0 xrWaitFrame,
+    // view location, input, Update and AppSimulateFrame run on a simulation thread that
+    // may finish up to depth frames ahead of the MainLoop thread, which keeps the GL
+    // context and does xrBeginFrame, Render, the eyes and xrEndFrame. OpenXR blocks
+    // xrWaitFrame until the previous frame is begun, so depth 1 is usually all that helps.
+    // In that mode Update and AppSimulateFrame must not make GL calls, and state they
+    // share with Render has to go through ovrApplFrameIn/ovrRendererOutput.
+    // If xrWaitFrame fails on the simulation thread, MainLoop runs serially until the
+    // session state changes.
+    // Set from AppInit; ignored while the simulation thread is running.
+    void SetFramePipelineDepth(int depth);
+    int GetFramePipelineDepth() const {
+        return FramePipelineDepth;
+    }
+
+    // Everything the render side needs from one simulated frame
+    struct ovrFramePacket {
+        int64_t FrameIndex = 0;
+        XrFrameState FrameState = {XR_TYPE_FRAME_STATE};
+        XrView Projections[MAX_NUM_EYES] = {{XR_TYPE_VIEW}, {XR_TYPE_VIEW}};
+        XrPosef ViewTransform[MAX_NUM_EYES] = {};
+        OVRFW::ovrApplFrameIn In;
+        OVRFW::ovrRendererOutput Out;
+    };
+
    private:
     // Called one time when the application process starts.
     // Returns true if the application initialized successfully.
@@ -546,6 +601,19 @@ class XrApp {
     // Internal Input
     void HandleInput(ovrApplFrameIn& in);
 
+    // Frame stages, shared by the serial and the pipelined MainLoop
+    bool WaitFrame(ovrFramePacket& packet);
+    void SimulateFrame(ovrFramePacket& packet);
+    void BeginXrFrame();
+    void RenderFramePacket(ovrFramePacket& packet);
+    void EndXrFrame(XrTime displayTime, int layerCount);
+
+    // Pipelined MainLoop
+    void RenderPipelinedFrame();
+    void StartSimulationThread();
+    void StopSimulationThread();
+    void SimulationThreadMain();
+
     // Internal Render
     void RenderFrame(const ovrApplFrameIn& in, ovrRendererOutput& out);
 
@@ -623,11 +691,13 @@ class XrApp {
     XrSpace RightControllerAimSpace = XR_NULL_HANDLE;
     XrSpace LeftControllerGripSpace = XR_NULL_HANDLE;
     XrSpace RightControllerGripSpace = XR_NULL_HANDLE;
-    uint32_t LastFrameAllButtons = 0u;
-    uint32_t LastFrameAllTouches = 0u;
+    OVRFW::ovrSpaceLocator SpaceLocator;
+    OVRFW::ovrActionTable ActionTable;
 
     OVRFW::ovrSurfaceRender SurfaceRender;
     OVRFW::OvrSceneView Scene;
+    OVRFW::ovrFrameTimer FrameTimer;
+    OVRFW::ovrFrameTimer SimulationTimer;
     std::unique_ptr<OVRFW::ovrFileSys> FileSys;
     std::unique_ptr<OVRFW::ModelFile> SceneModel;
 
@@ -639,6 +709,18 @@ class XrApp {
     int MainThreadTid;
     int RenderThreadTid;
 
+    // SpaceLocator indices: head, then left aim, left grip, right aim, right grip
+    int HeadSpaceIndex = -1;
+    int ControllerSpaceIndex[4] = {-1, -1, -1, -1};
+
+    int FramePipelineDepth = 0;
+    // Set when xrWaitFrame fails on the simulation thread, cleared on the next session
+    // state change; only written while that thread is not running
+    bool PipelineSuspended = false;
+    ovrFramePacket SerialPacket; // reused every frame by the serial MainLoop
+    ovrFramePipeline<ovrFramePacket> Pipeline;
+    std::thread SimulationThread;
+
     xrCompositorLayerUnion Layers[MAX_NUM_LAYERS];
     int LayerCount;
 
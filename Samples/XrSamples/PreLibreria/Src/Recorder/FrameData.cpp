@@ -0,0 +1,22 @@
+#include "Recorder/FrameData.h"
+
+#include <iomanip>
+#include <sstream>
+
+std::string FrameData::toCSV() const {
+    std::ostringstream oss;
+    oss << std::fixed << std::setprecision(6)
+        << timestamp << ","
+        << headPosX << "," << headPosY << "," << headPosZ << ","
+        << headRotX << "," << headRotY << "," << headRotZ << "," << headRotW << ","
+        << (leftControllerTracked ? "1" : "0") << ","
+        << leftPosX << "," << leftPosY << "," << leftPosZ << ","
+        << leftRotX << "," << leftRotY << "," << leftRotZ << "," << leftRotW << ","
+        << leftTriggerValue << ","
+        << (rightControllerTracked ? "1" : "0") << ","
+        << rightPosX << "," << rightPosY << "," << rightPosZ << ","
+        << rightRotX << "," << rightRotY << "," << rightRotZ << "," << rightRotW << ","
+        << rightTriggerValue << ","
+        << (buttonAClicked() ? "1" : "0");
+    return oss.str();
+}
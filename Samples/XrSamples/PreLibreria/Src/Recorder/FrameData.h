@@ -0,0 +1,96 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include "FrameParams.h"
+
+// Datos de un frame grabado. Es trivialmente copiable para poder moverlo con memcpy
+// entre el hilo de render y el de escritura sin reservar memoria.
+struct FrameData {
+    double timestamp;
+
+    // Headset
+    float headPosX, headPosY, headPosZ;
+    float headRotX, headRotY, headRotZ, headRotW;
+
+    // Controlador izquierdo
+    bool leftControllerTracked;
+    float leftPosX, leftPosY, leftPosZ;
+    float leftRotX, leftRotY, leftRotZ, leftRotW;
+    float leftTriggerValue;
+
+    // Controlador derecho
+    bool rightControllerTracked;
+    float rightPosX, rightPosY, rightPosZ;
+    float rightRotX, rightRotY, rightRotZ, rightRotW;
+    float rightTriggerValue;
+
+    // Botones (mascaras ovrApplFrameIn::kButton*)
+    uint32_t allButtons;
+    uint32_t lastFrameAllButtons;
+
+    // Necesario para el lector, que rellena los campos a mano
+    FrameData() = default;
+
+    // Constructor para inicializar con datos del frame
+    FrameData(const OVRFW::ovrApplFrameIn& in, double ts) : timestamp(ts) {
+        // Headset
+        headPosX = in.HeadPose.Translation.x;
+        headPosY = in.HeadPose.Translation.y;
+        headPosZ = in.HeadPose.Translation.z;
+        headRotX = in.HeadPose.Rotation.x;
+        headRotY = in.HeadPose.Rotation.y;
+        headRotZ = in.HeadPose.Rotation.z;
+        headRotW = in.HeadPose.Rotation.w;
+
+        // Controlador izquierdo
+        leftControllerTracked = in.LeftRemoteTracked;
+        if (leftControllerTracked) {
+            leftPosX = in.LeftRemotePose.Translation.x;
+            leftPosY = in.LeftRemotePose.Translation.y;
+            leftPosZ = in.LeftRemotePose.Translation.z;
+            leftRotX = in.LeftRemotePose.Rotation.x;
+            leftRotY = in.LeftRemotePose.Rotation.y;
+            leftRotZ = in.LeftRemotePose.Rotation.z;
+            leftRotW = in.LeftRemotePose.Rotation.w;
+            leftTriggerValue = in.LeftRemoteIndexTrigger;
+        } else {
+            leftPosX = leftPosY = leftPosZ = 0.0f;
+            leftRotX = leftRotY = leftRotZ = 0.0f;
+            leftRotW = 1.0f;
+            leftTriggerValue = 0.0f;
+        }
+
+        // Controlador derecho
+        rightControllerTracked = in.RightRemoteTracked;
+        if (rightControllerTracked) {
+            rightPosX = in.RightRemotePose.Translation.x;
+            rightPosY = in.RightRemotePose.Translation.y;
+            rightPosZ = in.RightRemotePose.Translation.z;
+            rightRotX = in.RightRemotePose.Rotation.x;
+            rightRotY = in.RightRemotePose.Rotation.y;
+            rightRotZ = in.RightRemotePose.Rotation.z;
+            rightRotW = in.RightRemotePose.Rotation.w;
+            rightTriggerValue = in.RightRemoteIndexTrigger;
+        } else {
+            rightPosX = rightPosY = rightPosZ = 0.0f;
+            rightRotX = rightRotY = rightRotZ = 0.0f;
+            rightRotW = 1.0f;
+            rightTriggerValue = 0.0f;
+        }
+
+        // Botones
+        allButtons = in.AllButtons;
+        lastFrameAllButtons = in.LastFrameAllButtons;
+    }
+
+    // Mismo criterio que ovrApplFrameIn::Clicked (se suelta el boton)
+    bool buttonAClicked() const {
+        return (lastFrameAllButtons & OVRFW::ovrApplFrameIn::kButtonA) != 0 &&
+            (allButtons & OVRFW::ovrApplFrameIn::kButtonA) == 0;
+    }
+
+    // Convertir a CSV. Solo se usa en la exportacion offline (RecordingReader::exportCsv)
+    std::string toCSV() const;
+};
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+
+// Articulaciones de una mano en un frame, en el orden de XrHandJointEXT
+// (XR_HAND_JOINT_COUNT_EXT = 26). Las poses van en el espacio en el que se localizo
+// la mano, igual que HeadPose.
+struct HandJoints {
+    static const int JOINT_COUNT = 26;
+
+    // Mismos bits que XrSpaceLocationFlags, se copian tal cual
+    enum JointFlags : uint8_t {
+        JOINT_ORIENTATION_VALID = 0x1,
+        JOINT_POSITION_VALID = 0x2,
+        JOINT_ORIENTATION_TRACKED = 0x4,
+        JOINT_POSITION_TRACKED = 0x8,
+    };
+
+    float positions[JOINT_COUNT][3]; // xyz
+    float rotations[JOINT_COUNT][4]; // xyzw
+    float radii[JOINT_COUNT];
+    uint8_t flags[JOINT_COUNT]; // JointFlags
+    bool tracked; // XrHandJointLocationsEXT::isActive
+
+    // Mano sin tracking: rotaciones identidad y el resto a cero
+    void clear() {
+        memset(this, 0, sizeof(*this));
+        for (int j = 0; j < JOINT_COUNT; j++) {
+            rotations[j][3] = 1.0f;
+        }
+    }
+
+    // Copia un array de XrHandJointLocationEXT. Es una plantilla para que la
+    // grabadora no dependa de openxr.h y se pueda compilar fuera del casco.
+    template <typename JointLocation>
+    void set(bool isActive, const JointLocation* joints) {
+        if (!isActive) {
+            clear();
+            return;
+        }
+        tracked = true;
+        for (int j = 0; j < JOINT_COUNT; j++) {
+            positions[j][0] = joints[j].pose.position.x;
+            positions[j][1] = joints[j].pose.position.y;
+            positions[j][2] = joints[j].pose.position.z;
+            rotations[j][0] = joints[j].pose.orientation.x;
+            rotations[j][1] = joints[j].pose.orientation.y;
+            rotations[j][2] = joints[j].pose.orientation.z;
+            rotations[j][3] = joints[j].pose.orientation.w;
+            radii[j] = joints[j].radius;
+            flags[j] = static_cast<uint8_t>(joints[j].locationFlags & 0xF);
+        }
+    }
+};
+
+// Las dos manos de un frame. Viaja por su propia cola junto a FrameData y se
+// empareja con el por timestamp, que es el mismo valor en los dos.
+struct HandFrameData {
+    double timestamp;
+    HandJoints hands[2]; // 0 izquierda, 1 derecha
+
+    void clear(double ts) {
+        timestamp = ts;
+        hands[0].clear();
+        hands[1].clear();
+    }
+};
@@ -0,0 +1,134 @@
+#include "Recorder/HandJointColumn.h"
+
+#include <cstring>
+
+namespace {
+
+const size_t JOINT_COUNT = HandJoints::JOINT_COUNT;
+
+size_t maskSize(size_t frameCount) {
+    return (frameCount + 7) / 8;
+}
+
+size_t presentSize(size_t presentCount) {
+    return presentCount * JOINT_COUNT *
+        (HandJointColumn::FIELDS_PER_JOINT * sizeof(float) + sizeof(uint8_t));
+}
+
+// Los campos de una articulacion en el orden de la columna
+void getJointFields(const HandJoints& h, size_t j, float* fields) {
+    fields[0] = h.positions[j][0];
+    fields[1] = h.positions[j][1];
+    fields[2] = h.positions[j][2];
+    fields[3] = h.rotations[j][0];
+    fields[4] = h.rotations[j][1];
+    fields[5] = h.rotations[j][2];
+    fields[6] = h.rotations[j][3];
+    fields[7] = h.radii[j];
+}
+
+void setJointFields(HandJoints& h, size_t j, const float* fields) {
+    h.positions[j][0] = fields[0];
+    h.positions[j][1] = fields[1];
+    h.positions[j][2] = fields[2];
+    h.rotations[j][0] = fields[3];
+    h.rotations[j][1] = fields[4];
+    h.rotations[j][2] = fields[5];
+    h.rotations[j][3] = fields[6];
+    h.radii[j] = fields[7];
+}
+
+} // namespace
+
+size_t HandJointColumn::maxEncodedSize(size_t frameCount) {
+    return maskSize(frameCount) + presentSize(frameCount);
+}
+
+size_t HandJointColumn::encode(
+    const HandFrameData* frames,
+    size_t frameCount,
+    int hand,
+    uint8_t* out) {
+    uint8_t* mask = out;
+    memset(mask, 0, maskSize(frameCount));
+    size_t presentCount = 0;
+    for (size_t i = 0; i < frameCount; i++) {
+        if (frames[i].hands[hand].tracked) {
+            mask[i / 8] |= static_cast<uint8_t>(1u << (i % 8));
+            presentCount++;
+        }
+    }
+
+    // Se recorren los frames una vez y cada valor va a su array: el origen se lee
+    // seguido y los destinos son FIELDS_PER_JOINT * JOINT_COUNT flujos secuenciales
+    uint8_t* floats = out + maskSize(frameCount);
+    uint8_t* flags = floats + presentCount * JOINT_COUNT * FIELDS_PER_JOINT * sizeof(float);
+    const size_t runBytes = presentCount * sizeof(float);
+    size_t k = 0;
+    for (size_t i = 0; i < frameCount; i++) {
+        const HandJoints& h = frames[i].hands[hand];
+        if (!h.tracked) {
+            continue;
+        }
+        for (size_t j = 0; j < JOINT_COUNT; j++) {
+            float fields[FIELDS_PER_JOINT];
+            getJointFields(h, j, fields);
+            for (size_t c = 0; c < static_cast<size_t>(FIELDS_PER_JOINT); c++) {
+                memcpy(
+                    floats + (c * JOINT_COUNT + j) * runBytes + k * sizeof(float),
+                    &fields[c],
+                    sizeof(float));
+            }
+            flags[j * presentCount + k] = h.flags[j];
+        }
+        k++;
+    }
+    return maskSize(frameCount) + presentSize(presentCount);
+}
+
+bool HandJointColumn::decode(
+    const uint8_t* data,
+    size_t size,
+    size_t frameCount,
+    int hand,
+    HandFrameData* frames) {
+    if (size < maskSize(frameCount)) {
+        return false;
+    }
+    const uint8_t* mask = data;
+    size_t presentCount = 0;
+    for (size_t i = 0; i < frameCount; i++) {
+        if ((mask[i / 8] >> (i % 8)) & 1) {
+            presentCount++;
+        }
+    }
+    if (size != maskSize(frameCount) + presentSize(presentCount)) {
+        return false;
+    }
+
+    const uint8_t* floats = data + maskSize(frameCount);
+    const uint8_t* flags = floats + presentCount * JOINT_COUNT * FIELDS_PER_JOINT * sizeof(float);
+    const size_t runBytes = presentCount * sizeof(float);
+    size_t k = 0;
+    for (size_t i = 0; i < frameCount; i++) {
+        HandJoints& h = frames[i].hands[hand];
+        if (((mask[i / 8] >> (i % 8)) & 1) == 0) {
+            h.clear();
+            continue;
+        }
+        h.tracked = true;
+        for (size_t j = 0; j < JOINT_COUNT; j++) {
+            float fields[FIELDS_PER_JOINT];
+            for (size_t c = 0; c < static_cast<size_t>(FIELDS_PER_JOINT); c++) {
+                memcpy(
+                    &fields[c],
+                    floats + (c * JOINT_COUNT + j) * runBytes + k * sizeof(float),
+                    sizeof(float));
+            }
+            setJointFields(h, j, fields);
+            h.flags[j] = flags[j * presentCount + k];
+        }
+        k++;
+    }
+    return true;
+}
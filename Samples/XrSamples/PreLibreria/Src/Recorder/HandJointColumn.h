@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "Recorder/HandData.h"
+
+/*
+    Columna de articulaciones de una mano dentro de un chunk
+    (RECORDING_ENCODING_HAND_SOA). Una mano son ~860 bytes por frame, asi que se
+    guarda como estructura de arrays: cada componente de cada articulacion va
+    contigua para todo el chunk. Los valores parecidos quedan juntos, lo que ayuda a
+    cualquier compresion posterior, y codificar o leer una articulacion es recorrer
+    un array plano.
+
+    Datos de la columna:
+        bitmask de presencia, (frameCount + 7) / 8 bytes, bit i = mano con tracking en el frame i
+        f32 [FIELDS_PER_JOINT][JOINT_COUNT][presentCount]
+            campos: pos x, y, z, rot x, y, z, w, radio
+        u8  [JOINT_COUNT][presentCount]    HandJoints::JointFlags
+
+    Solo se guardan los frames presentes: una mano sin tracking cuesta un bit.
+*/
+class HandJointColumn {
+public:
+    static const int FIELDS_PER_JOINT = 8; // pos xyz + rot xyzw + radio
+
+    // Tamano maximo de la columna para frameCount frames
+    static size_t maxEncodedSize(size_t frameCount);
+
+    // Codifica la mano hand (0 izquierda, 1 derecha) de frameCount frames en out
+    // (al menos maxEncodedSize bytes) y devuelve los bytes usados
+    static size_t encode(const HandFrameData* frames, size_t frameCount, int hand, uint8_t* out);
+
+    // Inverso de encode: rellena hands[hand] de cada frame, las manos ausentes quedan
+    // con clear(). Devuelve false si el tamano no cuadra con frameCount y la mascara.
+    static bool decode(
+        const uint8_t* data,
+        size_t size,
+        size_t frameCount,
+        int hand,
+        HandFrameData* frames);
+};
@@ -0,0 +1,319 @@
+#include "Recorder/HttpConnection.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+
+#if defined(_WIN32)
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+#endif
+
+#include "Misc/Log.h"
+
+namespace {
+
+const size_t MAX_HEADER_BYTES = 64 * 1024;
+const size_t RECV_BLOCK = 16 * 1024;
+
+#if defined(_WIN32)
+typedef SOCKET SocketHandle;
+const int SEND_FLAGS = 0;
+
+void closeSocket(intptr_t fd) {
+    closesocket(static_cast<SocketHandle>(fd));
+}
+
+bool initSockets() {
+    static const bool initialized = [] {
+        WSADATA data;
+        return WSAStartup(MAKEWORD(2, 2), &data) == 0;
+    }();
+    return initialized;
+}
+
+void setTimeouts(SocketHandle s, int timeoutMs) {
+    const DWORD tv = static_cast<DWORD>(timeoutMs);
+    setsockopt(s, SOL_SOCKET, SO_RCVTIMEO, reinterpret_cast<const char*>(&tv), sizeof(tv));
+    setsockopt(s, SOL_SOCKET, SO_SNDTIMEO, reinterpret_cast<const char*>(&tv), sizeof(tv));
+}
+#else
+typedef int SocketHandle;
+// Un peer que cierra no tiene que matar el proceso con SIGPIPE
+const int SEND_FLAGS = MSG_NOSIGNAL;
+
+void closeSocket(intptr_t fd) {
+    ::close(static_cast<SocketHandle>(fd));
+}
+
+bool initSockets() {
+    return true;
+}
+
+void setTimeouts(SocketHandle s, int timeoutMs) {
+    timeval tv;
+    tv.tv_sec = timeoutMs / 1000;
+    tv.tv_usec = (timeoutMs % 1000) * 1000;
+    setsockopt(s, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    setsockopt(s, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+}
+#endif
+
+std::string toLower(std::string s) {
+    std::transform(s.begin(), s.end(), s.begin(), [](unsigned char c) {
+        return static_cast<char>(std::tolower(c));
+    });
+    return s;
+}
+
+std::string trim(const std::string& s) {
+    const size_t begin = s.find_first_not_of(" \t");
+    if (begin == std::string::npos) {
+        return std::string();
+    }
+    const size_t end = s.find_last_not_of(" \t\r");
+    return s.substr(begin, end - begin + 1);
+}
+
+} // namespace
+
+const std::string& HttpConnection::Response::header(const std::string& lowercaseName) const {
+    static const std::string empty;
+    const auto it = headers.find(lowercaseName);
+    return it != headers.end() ? it->second : empty;
+}
+
+HttpConnection::~HttpConnection() {
+    close();
+}
+
+void HttpConnection::setEndpoint(const std::string& newHost, uint16_t newPort, int newTimeoutMs) {
+    if (newHost != host || newPort != port) {
+        close();
+    }
+    host = newHost;
+    port = newPort;
+    timeoutMs = newTimeoutMs;
+}
+
+void HttpConnection::close() {
+    if (fd >= 0) {
+        closeSocket(fd);
+        fd = -1;
+    }
+    recvBuffer.clear();
+}
+
+bool HttpConnection::connect() {
+    close();
+    if (host.empty() || !initSockets()) {
+        return false;
+    }
+
+    addrinfo hints = {};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo* addresses = nullptr;
+    const std::string service = std::to_string(port);
+    const int error = getaddrinfo(host.c_str(), service.c_str(), &hints, &addresses);
+    if (error != 0) {
+        ALOGW("HttpConnection: could not resolve %s (%d)", host.c_str(), error);
+        return false;
+    }
+
+    for (addrinfo* a = addresses; a != nullptr; a = a->ai_next) {
+        const SocketHandle s = socket(a->ai_family, a->ai_socktype, a->ai_protocol);
+        if (static_cast<intptr_t>(s) < 0) {
+            continue;
+        }
+        // En Linux el timeout de envio tambien limita el connect
+        setTimeouts(s, timeoutMs);
+        if (::connect(s, a->ai_addr, static_cast<int>(a->ai_addrlen)) == 0) {
+            const int noDelay = 1;
+            setsockopt(
+                s, IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<const char*>(&noDelay), sizeof(noDelay));
+            fd = static_cast<intptr_t>(s);
+            break;
+        }
+        closeSocket(static_cast<intptr_t>(s));
+    }
+    freeaddrinfo(addresses);
+
+    if (fd < 0) {
+        ALOGW("HttpConnection: could not connect to %s:%u", host.c_str(), port);
+        return false;
+    }
+    connectCount++;
+    return true;
+}
+
+bool HttpConnection::sendAll(const void* data, size_t size) {
+    const char* ptr = static_cast<const char*>(data);
+    while (size > 0) {
+        const int chunk = static_cast<int>(std::min<size_t>(size, 1 << 20));
+        const auto sent = send(static_cast<SocketHandle>(fd), ptr, chunk, SEND_FLAGS);
+        if (sent <= 0) {
+            return false;
+        }
+        ptr += sent;
+        size -= static_cast<size_t>(sent);
+    }
+    return true;
+}
+
+bool HttpConnection::fill() {
+    char block[RECV_BLOCK];
+    const auto received =
+        recv(static_cast<SocketHandle>(fd), block, static_cast<int>(sizeof(block)), 0);
+    if (received <= 0) {
+        return false;
+    }
+    recvBuffer.append(block, static_cast<size_t>(received));
+    return true;
+}
+
+bool HttpConnection::request(
+    const char* method,
+    const std::string& path,
+    const std::string& extraHeaders,
+    const void* body,
+    size_t bodySize,
+    Response& response) {
+    std::string head;
+    head.reserve(256 + extraHeaders.size());
+    head += method;
+    head += " ";
+    head += path;
+    head += " HTTP/1.1\r\nHost: ";
+    head += host;
+    if (port != 80) {
+        head += ":" + std::to_string(port);
+    }
+    head += "\r\nConnection: keep-alive\r\n";
+    if (body != nullptr || strcmp(method, "HEAD") != 0) {
+        head += "Content-Length: " + std::to_string(bodySize) + "\r\n";
+    }
+    head += extraHeaders;
+    head += "\r\n";
+
+    // Una conexion keep-alive puede haberla cerrado el servidor mientras estaba
+    // parada; eso solo se ve al usarla, asi que se reintenta una vez con una nueva
+    for (int attempt = 0; attempt < 2; attempt++) {
+        const bool reused = isConnected();
+        if (!reused && !connect()) {
+            return false;
+        }
+
+        bool keepAlive = false;
+        response = Response();
+        if (sendAll(head.data(), head.size()) &&
+            (bodySize == 0 || sendAll(body, bodySize)) &&
+            readResponse(method, response, keepAlive)) {
+            if (!keepAlive) {
+                close();
+            }
+            return true;
+        }
+
+        close();
+        if (!reused) {
+            break;
+        }
+    }
+    return false;
+}
+
+bool HttpConnection::readResponse(const char* method, Response& response, bool& keepAlive) {
+    size_t headerEnd;
+    while ((headerEnd = recvBuffer.find("\r\n\r\n")) == std::string::npos) {
+        if (recvBuffer.size() > MAX_HEADER_BYTES || !fill()) {
+            return false;
+        }
+    }
+
+    const std::string head = recvBuffer.substr(0, headerEnd + 2);
+    recvBuffer.erase(0, headerEnd + 4);
+
+    // Linea de estado: "HTTP/1.1 204 No Content"
+    size_t lineEnd = head.find("\r\n");
+    const std::string statusLine = head.substr(0, lineEnd);
+    if (statusLine.compare(0, 7, "HTTP/1.") != 0 || statusLine.size() < 12) {
+        return false;
+    }
+    const bool http10 = statusLine[7] == '0';
+    response.status = atoi(statusLine.c_str() + 9);
+
+    size_t lineStart = lineEnd + 2;
+    while (lineStart < head.size()) {
+        lineEnd = head.find("\r\n", lineStart);
+        const std::string line = head.substr(lineStart, lineEnd - lineStart);
+        lineStart = lineEnd + 2;
+        const size_t colon = line.find(':');
+        if (colon == std::string::npos) {
+            continue;
+        }
+        response.headers[toLower(trim(line.substr(0, colon)))] = trim(line.substr(colon + 1));
+    }
+
+    const std::string connection = toLower(response.header("connection"));
+    keepAlive = http10 ? connection == "keep-alive" : connection != "close";
+
+    const bool noBody = strcmp(method, "HEAD") == 0 || response.status / 100 == 1 ||
+        response.status == 204 || response.status == 304;
+    if (noBody) {
+        return true;
+    }
+
+    if (toLower(response.header("transfer-encoding")).find("chunked") != std::string::npos) {
+        for (;;) {
+            size_t sizeEnd;
+            while ((sizeEnd = recvBuffer.find("\r\n")) == std::string::npos) {
+                if (!fill()) {
+                    return false;
+                }
+            }
+            const size_t chunkSize = strtoul(recvBuffer.c_str(), nullptr, 16);
+            recvBuffer.erase(0, sizeEnd + 2);
+            while (recvBuffer.size() < chunkSize + 2) {
+                if (!fill()) {
+                    return false;
+                }
+            }
+            if (chunkSize == 0) {
+                // Sin trailers: queda el "\r\n" final
+                recvBuffer.erase(0, 2);
+                return true;
+            }
+            response.body.append(recvBuffer, 0, chunkSize);
+            recvBuffer.erase(0, chunkSize + 2);
+        }
+    }
+
+    const std::string& contentLength = response.header("content-length");
+    if (!contentLength.empty()) {
+        const size_t length = strtoul(contentLength.c_str(), nullptr, 10);
+        while (recvBuffer.size() < length) {
+            if (!fill()) {
+                return false;
+            }
+        }
+        response.body = recvBuffer.substr(0, length);
+        recvBuffer.erase(0, length);
+        return true;
+    }
+
+    // Sin longitud: el cuerpo acaba cuando el servidor cierra
+    while (fill()) {
+    }
+    response.body.swap(recvBuffer);
+    keepAlive = false;
+    return true;
+}
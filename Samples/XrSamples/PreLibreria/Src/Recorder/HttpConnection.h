@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+
+// Cliente HTTP/1.1 minimo sobre un socket TCP, pensado para subir ficheros desde
+// un hilo de fondo. Reutiliza la conexion entre peticiones (keep-alive) y se
+// reconecta solo cuando el servidor la cierra. Sin TLS: el servidor tiene que
+// hablar HTTP plano (o haber un proxy delante que termine TLS).
+// Todas las llamadas son bloqueantes con timeout, no usar desde el hilo de render.
+class HttpConnection {
+public:
+    struct Response {
+        int status = 0;
+        std::map<std::string, std::string> headers; // nombres en minusculas
+        std::string body;
+
+        // Cabecera como string, o "" si no esta
+        const std::string& header(const std::string& lowercaseName) const;
+    };
+
+    HttpConnection() = default;
+    ~HttpConnection();
+
+    HttpConnection(const HttpConnection&) = delete;
+    HttpConnection& operator=(const HttpConnection&) = delete;
+
+    // Host y puerto para las peticiones siguientes. Cierra la conexion si cambian.
+    void setEndpoint(const std::string& host, uint16_t port, int timeoutMs);
+
+    // Envia una peticion y lee la respuesta completa. extraHeaders va tal cual,
+    // cada linea terminada en "\r\n". Si la conexion reutilizada estaba muerta se
+    // reintenta una vez con una nueva. Devuelve false si falla la red o el parseo;
+    // un status de error del servidor no es un fallo aqui.
+    bool request(
+        const char* method,
+        const std::string& path,
+        const std::string& extraHeaders,
+        const void* body,
+        size_t bodySize,
+        Response& response);
+
+    void close();
+    bool isConnected() const { return fd >= 0; }
+
+    // Conexiones abiertas desde el inicio, para comprobar la reutilizacion
+    uint32_t getConnectCount() const { return connectCount; }
+
+private:
+    bool connect();
+    bool sendAll(const void* data, size_t size);
+    bool readResponse(const char* method, Response& response, bool& keepAlive);
+    bool fill(); // lee mas datos del socket a recvBuffer
+
+    std::string host;
+    uint16_t port = 0;
+    int timeoutMs = 5000;
+    intptr_t fd = -1;
+    uint32_t connectCount = 0;
+    std::string recvBuffer;
+};
@@ -0,0 +1,169 @@
+#include "Recorder/MappedRecordingSink.h"
+
+#include <cstring>
+
+#include "Misc/Log.h"
+
+MappedRecordingSink::~MappedRecordingSink() {
+    close();
+}
+
+uint64_t MappedRecordingSink::getBytesWritten() const {
+    return sizeof(RecordingSegmentHeader) +
+        static_cast<uint64_t>(frameCount) * sizeof(RecordingFrameRecord);
+}
+
+void MappedRecordingSink::packRecord(const FrameData& f, RecordingFrameRecord& r) {
+    r.timestamp = f.timestamp;
+    const float head[7] = {
+        f.headPosX, f.headPosY, f.headPosZ, f.headRotX, f.headRotY, f.headRotZ, f.headRotW};
+    const float left[7] = {
+        f.leftPosX, f.leftPosY, f.leftPosZ, f.leftRotX, f.leftRotY, f.leftRotZ, f.leftRotW};
+    const float right[7] = {
+        f.rightPosX, f.rightPosY, f.rightPosZ, f.rightRotX, f.rightRotY, f.rightRotZ, f.rightRotW};
+    memcpy(r.headPose, head, sizeof(head));
+    memcpy(r.leftPose, left, sizeof(left));
+    memcpy(r.rightPose, right, sizeof(right));
+    r.triggers[0] = f.leftTriggerValue;
+    r.triggers[1] = f.rightTriggerValue;
+    r.buttons[0] = f.allButtons;
+    r.buttons[1] = f.lastFrameAllButtons;
+    r.tracked = (f.leftControllerTracked ? RECORDING_TRACKED_LEFT : 0) |
+        (f.rightControllerTracked ? RECORDING_TRACKED_RIGHT : 0);
+    memset(r.reserved, 0, sizeof(r.reserved));
+}
+
+void MappedRecordingSink::unpackRecord(const RecordingFrameRecord& r, FrameData& f) {
+    f.timestamp = r.timestamp;
+    f.headPosX = r.headPose[0];
+    f.headPosY = r.headPose[1];
+    f.headPosZ = r.headPose[2];
+    f.headRotX = r.headPose[3];
+    f.headRotY = r.headPose[4];
+    f.headRotZ = r.headPose[5];
+    f.headRotW = r.headPose[6];
+    f.leftPosX = r.leftPose[0];
+    f.leftPosY = r.leftPose[1];
+    f.leftPosZ = r.leftPose[2];
+    f.leftRotX = r.leftPose[3];
+    f.leftRotY = r.leftPose[4];
+    f.leftRotZ = r.leftPose[5];
+    f.leftRotW = r.leftPose[6];
+    f.rightPosX = r.rightPose[0];
+    f.rightPosY = r.rightPose[1];
+    f.rightPosZ = r.rightPose[2];
+    f.rightRotX = r.rightPose[3];
+    f.rightRotY = r.rightPose[4];
+    f.rightRotZ = r.rightPose[5];
+    f.rightRotW = r.rightPose[6];
+    f.leftTriggerValue = r.triggers[0];
+    f.rightTriggerValue = r.triggers[1];
+    f.allButtons = r.buttons[0];
+    f.lastFrameAllButtons = r.buttons[1];
+    f.leftControllerTracked = (r.tracked & RECORDING_TRACKED_LEFT) != 0;
+    f.rightControllerTracked = (r.tracked & RECORDING_TRACKED_RIGHT) != 0;
+}
+
+#if defined(ANDROID) || defined(__linux__)
+
+bool MappedRecordingSink::open(
+    const std::string& name,
+    uint32_t partIndex,
+    int64_t sessionStartUnixMs,
+    uint32_t maxFrames) {
+    close();
+
+    const size_t size = sizeof(RecordingSegmentHeader) +
+        static_cast<size_t>(maxFrames) * sizeof(RecordingFrameRecord);
+    if (maxFrames == 0 || !file.OpenWrite(name.c_str(), size)) {
+        ALOGE("MappedRecordingSink: could not create %s", name.c_str());
+        file.Close();
+        return false;
+    }
+    uint8_t* base = view.Open(&file) ? view.MapView() : nullptr;
+    if (base == nullptr) {
+        ALOGE("MappedRecordingSink: could not map %s", name.c_str());
+        view.Close();
+        file.Close();
+        return false;
+    }
+    // Se escribe de principio a fin una sola vez
+    view.Advise(OVRFW::MappedView::ACCESS_SEQUENTIAL);
+
+    filename = name;
+    header = reinterpret_cast<RecordingSegmentHeader*>(base);
+    records = reinterpret_cast<RecordingFrameRecord*>(base + sizeof(RecordingSegmentHeader));
+    frameCount = 0;
+    syncedCount = 0;
+    capacity = maxFrames;
+
+    RecordingSegmentHeader h = {};
+    memcpy(h.magic, RECORDING_SEGMENT_MAGIC, sizeof(h.magic));
+    h.version = RECORDING_FORMAT_VERSION;
+    h.headerSize = sizeof(RecordingSegmentHeader);
+    h.recordSize = sizeof(RecordingFrameRecord);
+    h.partIndex = partIndex;
+    h.sessionStartUnixMs = sessionStartUnixMs;
+    h.frameCount = 0;
+    h.capacity = maxFrames;
+    memcpy(header, &h, sizeof(h));
+    return true;
+}
+
+bool MappedRecordingSink::append(const FrameData& frame) {
+    if (records == nullptr || frameCount >= capacity) {
+        return false;
+    }
+    RecordingFrameRecord record;
+    packRecord(frame, record);
+    memcpy(&records[frameCount], &record, sizeof(record));
+
+    // El contador va despues del registro: un fichero a medias nunca cuenta basura
+    frameCount++;
+    memcpy(&header->frameCount, &frameCount, sizeof(frameCount));
+    return true;
+}
+
+void MappedRecordingSink::sync(bool wait) {
+    if (records == nullptr || syncedCount == frameCount) {
+        return;
+    }
+    // Registros nuevos y la cabecera, que lleva frameCount
+    const size_t begin = sizeof(RecordingSegmentHeader) + syncedCount * sizeof(RecordingFrameRecord);
+    const size_t end = static_cast<size_t>(getBytesWritten());
+    view.Sync(begin, end - begin, wait);
+    view.Sync(0, sizeof(RecordingSegmentHeader), wait);
+    syncedCount = frameCount;
+}
+
+void MappedRecordingSink::close() {
+    if (records == nullptr) {
+        return;
+    }
+    sync(true);
+    const uint64_t length = getBytesWritten();
+    view.Close();
+    if (!file.Truncate(static_cast<size_t>(length))) {
+        ALOGW("MappedRecordingSink: could not truncate %s", filename.c_str());
+    }
+    file.Close();
+    header = nullptr;
+    records = nullptr;
+}
+
+#else
+
+bool MappedRecordingSink::open(const std::string& name, uint32_t, int64_t, uint32_t) {
+    ALOGE("MappedRecordingSink: not supported on this platform (%s)", name.c_str());
+    return false;
+}
+
+bool MappedRecordingSink::append(const FrameData&) {
+    return false;
+}
+
+void MappedRecordingSink::sync(bool) {}
+
+void MappedRecordingSink::close() {}
+
+#endif
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include "OVR_MappedFile.h"
+
+#include "Recorder/FrameData.h"
+#include "Recorder/RecordingFormat.h"
+
+// Escribe segmentos .vrms (ver RecordingFormat.h) a traves de un mmap compartido.
+// open preasigna el fichero para capacity frames y lo mapea entero; append copia el
+// registro directamente en la memoria mapeada, sin llamadas al sistema. Cuando el
+// segmento se llena append devuelve false y hay que cerrar y abrir el siguiente.
+// close sincroniza con msync y recorta el fichero a lo realmente escrito.
+// Si la app muere, lo escrito ya esta en la cache de paginas del kernel; solo un
+// apagon pierde lo posterior al ultimo sync.
+class MappedRecordingSink {
+public:
+    MappedRecordingSink() = default;
+    ~MappedRecordingSink();
+
+    MappedRecordingSink(const MappedRecordingSink&) = delete;
+    MappedRecordingSink& operator=(const MappedRecordingSink&) = delete;
+
+    bool open(
+        const std::string& filename,
+        uint32_t partIndex,
+        int64_t sessionStartUnixMs,
+        uint32_t capacity);
+
+    // Devuelve false si no esta abierto o el segmento esta lleno
+    bool append(const FrameData& frame);
+
+    // Programa (wait = false) o fuerza la escritura a disco de lo anadido desde el
+    // ultimo sync
+    void sync(bool wait);
+
+    void close();
+
+    bool isOpen() const { return records != nullptr; }
+    bool isFull() const { return frameCount >= capacity; }
+    const std::string& getFilename() const { return filename; }
+    uint32_t getFrameCount() const { return frameCount; }
+    uint64_t getBytesWritten() const;
+
+    static void packRecord(const FrameData& frame, RecordingFrameRecord& record);
+    static void unpackRecord(const RecordingFrameRecord& record, FrameData& frame);
+
+private:
+#if defined(ANDROID) || defined(__linux__) // MappedFile solo esta implementado con mmap
+    OVRFW::MappedFile file;
+    OVRFW::MappedView view;
+#endif
+    std::string filename;
+    RecordingSegmentHeader* header = nullptr;
+    RecordingFrameRecord* records = nullptr;
+    uint32_t frameCount = 0;
+    uint32_t capacity = 0;
+    uint32_t syncedCount = 0;
+};
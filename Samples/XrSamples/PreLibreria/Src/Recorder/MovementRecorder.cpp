@@ -0,0 +1,526 @@
+#include "Recorder/MovementRecorder.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <ctime>
+#include <initializer_list>
+#include <iomanip>
+#include <sstream>
+
+#if defined(ANDROID) || defined(__linux__)
+#include <pthread.h>
+#endif
+
+#include "Misc/Log.h"
+
+namespace {
+// Cuanto duerme el escritor cuando la cola esta vacia. A 90fps son ~2 frames por vuelta.
+const std::chrono::milliseconds WRITER_IDLE_SLEEP(20);
+} // namespace
+
+MovementRecorder::PoseCompression MovementRecorder::PoseCompression::quantized(
+    float positionResolutionMm) {
+    PoseCompression compression;
+    for (PoseCodecConfig* config : {&compression.head, &compression.left, &compression.right}) {
+        config->enabled = true;
+        config->positionResolutionMm = positionResolutionMm;
+    }
+    return compression;
+}
+
+MovementRecorder::MovementRecorder(BackpressurePolicy backpressure)
+    : MovementRecorder(backpressure, PoseCompression()) {}
+
+MovementRecorder::MovementRecorder(
+    BackpressurePolicy backpressure,
+    const PoseCompression& compression,
+    SinkType sink,
+    bool captureHands,
+    const PoseDecimatorConfig& decimation,
+    bool capturePoseSamples)
+    : frameCount(0),
+      policy(backpressure),
+      sinkType(sink),
+      finalized(false),
+      ring(RING_CAPACITY),
+      uploader(UPLOAD_QUEUE_FILE),
+      decimator(decimation),
+      hasHandLookahead(false),
+      framesInCurrentFile(0),
+      framesSinceSync(0),
+      framesInClosedFiles(0),
+      partFirstTimestamp(0.0),
+      partLastTimestamp(0.0) {
+    // Generar nombre base único con timestamp
+    auto now = std::chrono::system_clock::now();
+    auto time_t = std::chrono::system_clock::to_time_t(now);
+    auto tm = *std::localtime(&time_t);
+
+    std::ostringstream oss;
+    oss << "vr_motion_"
+        << std::put_time(&tm, "%Y%m%d_%H%M%S");
+    baseFilename = oss.str();
+
+    sessionStartUnixMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+                             now.time_since_epoch())
+                             .count();
+    startTime = std::chrono::high_resolution_clock::now();
+    chunkBuffer.resize(FRAMES_PER_CHUNK);
+
+    // Antes de arrancar el hilo: a partir de ahi el escritor es solo suyo
+    writer.setPoseCodec(RECORDING_COLUMN_HEAD_POSE, compression.head);
+    writer.setPoseCodec(RECORDING_COLUMN_LEFT_POSE, compression.left);
+    writer.setPoseCodec(RECORDING_COLUMN_RIGHT_POSE, compression.right);
+    if (captureHands) {
+        if (sinkType == SINK_MAPPED_SEGMENTS) {
+            ALOGW("MovementRecorder: hand capture is not supported with mapped segments");
+        } else {
+            handRing.reset(new SpscRing<HandFrameData>(HAND_RING_CAPACITY));
+            handBuffer.resize(FRAMES_PER_CHUNK);
+        }
+    }
+    if (capturePoseSamples) {
+        if (sinkType == SINK_MAPPED_SEGMENTS) {
+            ALOGW("MovementRecorder: pose samples are not supported with mapped segments");
+        } else {
+            poseSampleRing.reset(
+                new SpscRing<RecordingPoseSample>(POSE_SAMPLE_RING_CAPACITY));
+            poseSampleBuffer.resize(POSE_SAMPLES_PER_CHUNK);
+        }
+    }
+    if (decimation.enabled) {
+        if (handRing) {
+            ALOGW("MovementRecorder: pose decimation is disabled while capturing hands");
+            decimator = PoseDecimator();
+        } else {
+            decimatorInput.resize(FRAMES_PER_CHUNK);
+        }
+    }
+
+    writerThread = std::thread(&MovementRecorder::writerLoop, this);
+
+    ALOG("MovementRecorder initialized with base filename: %s", baseFilename.c_str());
+}
+
+MovementRecorder::~MovementRecorder() {
+    finalize();
+}
+
+std::string MovementRecorder::getCurrentFilename() const {
+    std::ostringstream oss;
+    oss << baseFilename << "_part" << std::setfill('0') << std::setw(3)
+        << currentFileIndex.load(std::memory_order_relaxed)
+        << (sinkType == SINK_MAPPED_SEGMENTS ? ".vrms" : ".vrmr");
+    return oss.str();
+}
+
+// Hilo escritor: escribe los primeros count frames de chunkBuffer como un chunk del
+// fichero actual, abriendolo si hace falta y pasando al siguiente si se llena
+void MovementRecorder::saveBufferToFile(size_t count) {
+    if (count == 0) return;
+
+    if (sinkType == SINK_MAPPED_SEGMENTS) {
+        appendToMappedSink(count);
+        return;
+    }
+
+    if (!openWriter()) {
+        return;
+    }
+
+    // writerLoop ya ha emparejado las manos de cada frame al sacarlo de la cola
+    const HandFrameData* hands = handRing ? handBuffer.data() : nullptr;
+
+    if (framesInCurrentFile == 0) {
+        partFirstTimestamp = chunkBuffer[0].timestamp;
+    }
+    partLastTimestamp = chunkBuffer[count - 1].timestamp;
+
+    const uint64_t before = writer.getBytesWritten();
+    writer.writeChunk(chunkBuffer.data(), hands, count);
+    bytesWritten.fetch_add(writer.getBytesWritten() - before, std::memory_order_relaxed);
+    framesInCurrentFile += static_cast<int>(count);
+
+    if (framesInCurrentFile >= MAX_FRAMES_PER_FILE) {
+        // Las muestras pendientes son de este tramo, van a la parte que se cierra
+        savePoseSamples(true);
+        closeCurrentFile();
+        currentFileIndex.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+// Hilo escritor: abre el fichero de la parte actual si aun no lo esta
+bool MovementRecorder::openWriter() {
+    if (writer.isOpen()) {
+        return true;
+    }
+    const std::string filename = getCurrentFilename();
+    if (!writer.open(filename, currentFileIndex.load(), sessionStartUnixMs)) {
+        ALOG("Error: Could not open file %s for writing", filename.c_str());
+        return false;
+    }
+    return true;
+}
+
+// Hilo escritor: escribe las muestras de pose encoladas como chunks SMPL. Sin all solo
+// si ya hay al menos un chunk completo; con all, todas las que habia al entrar (las que
+// sigan llegando mientras tanto esperan a la siguiente vuelta).
+void MovementRecorder::savePoseSamples(bool all) {
+    if (!poseSampleRing) {
+        return;
+    }
+    size_t pending = poseSampleRing->size();
+    if (pending == 0 || (!all && pending < static_cast<size_t>(POSE_SAMPLES_PER_CHUNK))) {
+        return;
+    }
+    if (!openWriter()) {
+        return;
+    }
+    while (pending > 0) {
+        const size_t count = poseSampleRing->popBatch(
+            poseSampleBuffer.data(), std::min(pending, poseSampleBuffer.size()));
+        if (count == 0) {
+            break;
+        }
+        pending -= count;
+
+        const uint64_t before = writer.getBytesWritten();
+        writer.writePoseSamples(poseSampleBuffer.data(), count);
+        bytesWritten.fetch_add(writer.getBytesWritten() - before, std::memory_order_relaxed);
+        poseSamplesWritten.fetch_add(count, std::memory_order_relaxed);
+    }
+}
+
+// Hilo escritor: copia los frames al segmento mapeado, pasando al siguiente cuando se llena.
+// Si no se puede crear un segmento (p.ej. no hay sitio para preasignarlo) el resto de la
+// sesion va a partes .vrmr, que escriben cada chunk con write y no fallan con SIGBUS.
+void MovementRecorder::appendToMappedSink(size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        if (!mappedSink.isOpen()) {
+            const std::string filename = getCurrentFilename();
+            if (!mappedSink.open(
+                    filename, currentFileIndex.load(), sessionStartUnixMs, MAX_FRAMES_PER_FILE)) {
+                ALOGW("MovementRecorder: could not create %s, using .vrmr parts", filename.c_str());
+                sinkType = SINK_CHUNKED_FILE;
+                std::copy(
+                    chunkBuffer.begin() + i, chunkBuffer.begin() + count, chunkBuffer.begin());
+                saveBufferToFile(count - i);
+                return;
+            }
+            bytesWritten.fetch_add(sizeof(RecordingSegmentHeader), std::memory_order_relaxed);
+        }
+
+        if (framesInCurrentFile == 0) {
+            partFirstTimestamp = chunkBuffer[i].timestamp;
+        }
+        partLastTimestamp = chunkBuffer[i].timestamp;
+        mappedSink.append(chunkBuffer[i]);
+        bytesWritten.fetch_add(sizeof(RecordingFrameRecord), std::memory_order_relaxed);
+        framesInCurrentFile++;
+        framesSinceSync++;
+
+        if (mappedSink.isFull()) {
+            closeCurrentFile();
+            currentFileIndex.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    // msync asincrono cada chunk: acota lo que se perderia en un apagon
+    if (framesSinceSync >= static_cast<uint32_t>(FRAMES_PER_CHUNK)) {
+        mappedSink.sync(false);
+        framesSinceSync = 0;
+    }
+}
+
+// Hilo escritor: busca en la cola de manos las de los frames [first, first + count) del
+// chunk, recien sacados de la cola de frames, asi las dos colas se vacian a la vez. Las
+// manos se encolan antes que su frame, asi que si no estan es que se descartaron (o que el
+// frame se grabo sin manos) y el frame queda sin tracking de manos.
+void MovementRecorder::matchHands(size_t first, size_t count) {
+    for (size_t i = first; i < first + count; i++) {
+        const double timestamp = chunkBuffer[i].timestamp;
+        bool matched = false;
+        for (;;) {
+            if (!hasHandLookahead) {
+                if (handRing->popBatch(&handLookahead, 1) == 0) {
+                    break;
+                }
+                hasHandLookahead = true;
+            }
+            if (handLookahead.timestamp < timestamp) {
+                hasHandLookahead = false; // su frame se descarto en la cola principal
+                continue;
+            }
+            if (handLookahead.timestamp == timestamp) {
+                handBuffer[i] = handLookahead;
+                hasHandLookahead = false;
+                matched = true;
+            }
+            break;
+        }
+        if (!matched) {
+            handBuffer[i].clear(timestamp);
+        }
+    }
+}
+
+// Hilo escritor: pasa al chunk los frames que el diezmado ha decidido guardar,
+// escribiendolo si se llena. Devuelve los frames que quedan en chunkBuffer.
+size_t MovementRecorder::appendKept(size_t filled, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        chunkBuffer[filled++] = decimatorOutput[i];
+        if (filled == static_cast<size_t>(FRAMES_PER_CHUNK)) {
+            saveBufferToFile(filled);
+            filled = 0;
+        }
+    }
+    decimatedFrames.store(
+        decimator.getFramesIn() - decimator.getFramesKept(), std::memory_order_relaxed);
+    return filled;
+}
+
+bool MovementRecorder::isFileOpen() const {
+    return sinkType == SINK_MAPPED_SEGMENTS ? mappedSink.isOpen() : writer.isOpen();
+}
+
+void MovementRecorder::closeCurrentFile() {
+    if (!isFileOpen()) return;
+
+    std::string filename;
+    uint64_t bytes;
+    if (sinkType == SINK_MAPPED_SEGMENTS) {
+        // msync sincrono y recorte al tamano real
+        filename = mappedSink.getFilename();
+        bytes = mappedSink.getBytesWritten();
+        mappedSink.close();
+        framesSinceSync = 0;
+    } else {
+        // close anade el indice de chunks
+        const uint64_t before = writer.getBytesWritten();
+        writer.close();
+        filename = writer.getFilename();
+        bytes = writer.getBytesWritten();
+        bytesWritten.fetch_add(bytes - before, std::memory_order_relaxed);
+    }
+    ALOG(
+        "Saved %d frames (%llu bytes) to %s",
+        framesInCurrentFile,
+        static_cast<unsigned long long>(bytes),
+        filename.c_str());
+
+    // La subida va en su propio hilo, aqui solo se encola
+    uploader.enqueue(filename);
+    addPartToManifest(filename);
+
+    framesInCurrentFile = 0;
+}
+
+// Hilo escritor: anade la parte recien cerrada al manifiesto y lo reescribe entero,
+// asi el .vrmx en disco siempre describe partes completas
+void MovementRecorder::addPartToManifest(const std::string& filename) {
+    if (framesInCurrentFile == 0) {
+        return; // no se llego a escribir ningun frame
+    }
+    RecordingManifestEntry entry = {};
+    entry.partIndex = static_cast<uint32_t>(currentFileIndex.load(std::memory_order_relaxed));
+    entry.frameCount = static_cast<uint32_t>(framesInCurrentFile);
+    entry.firstFrame = framesInClosedFiles;
+    entry.firstTimestamp = partFirstTimestamp;
+    entry.lastTimestamp = partLastTimestamp;
+    snprintf(entry.filename, sizeof(entry.filename), "%s", filename.c_str());
+    manifestParts.push_back(entry);
+    framesInClosedFiles += entry.frameCount;
+
+    RecordingSession::writeManifest(
+        RecordingSession::manifestFilenameFor(baseFilename), sessionStartUnixMs, manifestParts);
+}
+
+void MovementRecorder::writerLoop() {
+#if defined(ANDROID) || defined(__linux__)
+    pthread_setname_np(pthread_self(), "RecorderWriter");
+#endif
+
+    size_t filled = 0;
+    for (;;) {
+        // Leer las peticiones ANTES de vaciar: todo lo encolado antes de ellas ya es visible
+        const bool stopping = stopRequested.load(std::memory_order_acquire);
+        const uint64_t flushSeq = flushRequested.load(std::memory_order_acquire);
+
+        size_t popped;
+        if (decimator.isEnabled()) {
+            popped = ring.popBatch(decimatorInput.data(), decimatorInput.size());
+            for (size_t i = 0; i < popped; i++) {
+                filled = appendKept(filled, decimator.push(decimatorInput[i], decimatorOutput));
+            }
+        } else {
+            popped = ring.popBatch(chunkBuffer.data() + filled, FRAMES_PER_CHUNK - filled);
+            if (handRing) {
+                matchHands(filled, popped);
+            }
+            filled += popped;
+        }
+        savePoseSamples(false);
+
+        // El segmento mapeado no necesita juntar un chunk: cada frame va directo
+        if (sinkType == SINK_MAPPED_SEGMENTS && filled > 0) {
+            saveBufferToFile(filled);
+            filled = 0;
+        }
+
+        if (filled == static_cast<size_t>(FRAMES_PER_CHUNK)) {
+            saveBufferToFile(filled);
+            filled = 0;
+            continue;
+        }
+
+        const bool drainPending =
+            stopping || flushSeq != flushCompleted.load(std::memory_order_relaxed);
+        if (drainPending && ring.size() == 0) {
+            // El ultimo frame recibido se guarda aunque el diezmado aun no lo haya decidido
+            if (decimator.isEnabled()) {
+                filled = appendKept(filled, decimator.drain(decimatorOutput));
+            }
+            // Chunk parcial: el formato admite chunks de cualquier tamano
+            saveBufferToFile(filled);
+            filled = 0;
+            savePoseSamples(true);
+            if (stopping) {
+                closeCurrentFile();
+                if (!manifestParts.empty()) {
+                    uploader.enqueue(RecordingSession::manifestFilenameFor(baseFilename));
+                }
+                break;
+            }
+            if (sinkType == SINK_MAPPED_SEGMENTS) {
+                mappedSink.sync(false);
+            } else {
+                writer.flush();
+            }
+            flushCompleted.store(flushSeq, std::memory_order_release);
+            continue;
+        }
+
+        if (popped == 0) {
+            std::this_thread::sleep_for(WRITER_IDLE_SLEEP);
+        }
+    }
+}
+
+void MovementRecorder::recordFrame(const OVRFW::ovrApplFrameIn& in) {
+    if (finalized) return;
+
+    auto now = std::chrono::high_resolution_clock::now();
+    double timestamp = std::chrono::duration<double>(now - startTime).count();
+
+    pushFrame(FrameData(in, timestamp));
+}
+
+void MovementRecorder::recordFrame(
+    const OVRFW::ovrApplFrameIn& in,
+    const HandJoints& leftHand,
+    const HandJoints& rightHand) {
+    if (finalized) return;
+
+    auto now = std::chrono::high_resolution_clock::now();
+    double timestamp = std::chrono::duration<double>(now - startTime).count();
+
+    // Antes que el frame: cuando el escritor vea el frame sus manos ya estan en la cola
+    if (handRing) {
+        handFrame.timestamp = timestamp;
+        handFrame.hands[0] = leftHand;
+        handFrame.hands[1] = rightHand;
+        if (policy == BACKPRESSURE_DROP_OLDEST) {
+            if (handRing->pushDropOldest(handFrame)) {
+                droppedHandFrames.fetch_add(1, std::memory_order_relaxed);
+            }
+        } else {
+            while (!handRing->tryPush(handFrame)) {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    pushFrame(FrameData(in, timestamp));
+}
+
+void MovementRecorder::recordPoseSample(const RecordingPoseSample& sample) {
+    if (!poseSampleRing) {
+        return;
+    }
+    if (poseSampleRing->pushDropOldest(sample)) {
+        droppedPoseSamples.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+double MovementRecorder::getSessionTime() const {
+    return std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - startTime)
+        .count();
+}
+
+void MovementRecorder::pushFrame(const FrameData& frame) {
+    frameCount++;
+
+    if (policy == BACKPRESSURE_DROP_OLDEST) {
+        if (ring.pushDropOldest(frame)) {
+            droppedFrames.fetch_add(1, std::memory_order_relaxed);
+        }
+    } else {
+        if (!ring.tryPush(frame)) {
+            blockedFrames.fetch_add(1, std::memory_order_relaxed);
+            while (!ring.tryPush(frame)) {
+                std::this_thread::yield();
+            }
+        }
+    }
+}
+
+void MovementRecorder::startUploads(const UploadQueue::Config& config) {
+    uploader.start(config);
+}
+
+void MovementRecorder::flush() {
+    if (finalized) return;
+
+    const uint64_t seq = flushRequested.fetch_add(1, std::memory_order_acq_rel) + 1;
+    while (flushCompleted.load(std::memory_order_acquire) < seq) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
+
+void MovementRecorder::finalize() {
+    if (finalized) return;
+    finalized = true;
+
+    // El escritor vacia la cola, escribe el ultimo chunk parcial y cierra el fichero
+    stopRequested.store(true, std::memory_order_release);
+    if (writerThread.joinable()) {
+        writerThread.join();
+    }
+    uploader.stop();
+
+    ALOG("MovementRecorder finalized. Total frames recorded: %d across %d files",
+         frameCount, currentFileIndex.load() + 1);
+    if (droppedFrames.load() > 0 || blockedFrames.load() > 0 || droppedHandFrames.load() > 0) {
+        ALOG(
+            "MovementRecorder backpressure: %llu frames dropped, %llu frames blocked, "
+            "%llu hand frames dropped",
+            static_cast<unsigned long long>(droppedFrames.load()),
+            static_cast<unsigned long long>(blockedFrames.load()),
+            static_cast<unsigned long long>(droppedHandFrames.load()));
+    }
+    if (poseSampleRing) {
+        ALOG(
+            "MovementRecorder pose samples: %llu written, %llu dropped",
+            static_cast<unsigned long long>(poseSamplesWritten.load()),
+            static_cast<unsigned long long>(droppedPoseSamples.load()));
+    }
+    if (decimator.isEnabled()) {
+        const PoseDecimator::Error& error = decimator.getMaxError();
+        ALOG(
+            "MovementRecorder decimation: kept %llu of %llu frames, max error %.2fmm %.2fdeg",
+            static_cast<unsigned long long>(decimator.getFramesKept()),
+            static_cast<unsigned long long>(decimator.getFramesIn()),
+            error.maxPositionMm,
+            error.maxRotationDeg);
+    }
+}
@@ -0,0 +1,204 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "FrameParams.h"
+
+#include "Recorder/FrameData.h"
+#include "Recorder/HandData.h"
+#include "Recorder/MappedRecordingSink.h"
+#include "Recorder/PoseCodec.h"
+#include "Recorder/PoseDecimator.h"
+#include "Recorder/RecordingSession.h"
+#include "Recorder/RecordingWriter.h"
+#include "Recorder/SpscRing.h"
+#include "Recorder/UploadQueue.h"
+
+// Clase para manejar la grabación de movimientos.
+// recordFrame solo copia el frame a una cola sin locks; un hilo escritor la vacia,
+// arma los chunks y escribe los ficheros, asi el hilo de render nunca toca disco.
+// Cada parte cerrada pasa a una UploadQueue que la sube en segundo plano y se anade
+// al manifiesto de la sesion (.vrmx), que se sube al terminar.
+// Opcionalmente graba tambien las 26 articulaciones de cada mano, que van por una
+// cola aparte para no inflar la de FrameData cuando no se usan.
+// Con un PoseDecimator activo el escritor solo guarda los frames necesarios para
+// rehacer el resto dentro de las tolerancias (ver PoseDecimator.h).
+// Con capturePoseSamples acepta ademas muestras de pose a mas frecuencia que los frames
+// (las de un PoseSampler), que van por su propia cola a chunks SMPL del mismo fichero.
+class MovementRecorder {
+public:
+    using FrameData = ::FrameData;
+
+    // Que hacer si el escritor no da abasto y la cola se llena
+    enum BackpressurePolicy {
+        BACKPRESSURE_DROP_OLDEST, // se pierde el frame mas antiguo, nunca bloquea el render
+        BACKPRESSURE_BLOCK, // el render espera a que haya hueco
+    };
+
+    // Compresion de cada pista de pose. Por defecto van en float sin comprimir.
+    struct PoseCompression {
+        PoseCodecConfig head;
+        PoseCodecConfig left;
+        PoseCodecConfig right;
+
+        // Las tres pistas cuantizadas con la resolucion de posicion indicada
+        static PoseCompression quantized(float positionResolutionMm);
+    };
+
+    // Donde escribe el hilo escritor
+    enum SinkType {
+        SINK_CHUNKED_FILE, // .vrmr columnar, un write por chunk (admite PoseCompression)
+        SINK_MAPPED_SEGMENTS, // .vrms preasignado y mapeado, cada frame es un memcpy
+    };
+
+    static const int FRAMES_PER_CHUNK = 900; // 10 segundos a 90fps
+    static const int MAX_FRAMES_PER_FILE = 5400; // 60 segundos a 90fps
+    static const int RING_CAPACITY = 4096; // ~45 segundos a 90fps, ~0.5MB
+    // Igual que la de frames: las dos se llenan y se vacian a la vez, asi una rafaga que cabe
+    // en una cabe en la otra (~7MB, solo con captureHands)
+    static const int HAND_RING_CAPACITY = RING_CAPACITY;
+    static const int POSE_SAMPLE_RING_CAPACITY = 16384; // ~6 segundos a 2500 muestras/s, ~1.2MB
+    static const int POSE_SAMPLES_PER_CHUNK = 4096; // el escritor escribe un SMPL al llegar a tantas
+    static constexpr const char* UPLOAD_QUEUE_FILE = "vr_upload_queue.txt";
+    // Servidor de subida, ver UploadQueue::loadConfig. Sin el las partes se quedan en cola.
+    static constexpr const char* UPLOAD_CONFIG_FILE = "vr_upload.conf";
+
+    explicit MovementRecorder(BackpressurePolicy policy = BACKPRESSURE_DROP_OLDEST);
+    // captureHands solo se admite con SINK_CHUNKED_FILE: el registro de un .vrms
+    // tiene tamano fijo y no lleva manos. El diezmado no mira las manos, asi que se
+    // desactiva si se capturan. capturePoseSamples, igual que las manos, solo con
+    // SINK_CHUNKED_FILE.
+    MovementRecorder(
+        BackpressurePolicy policy,
+        const PoseCompression& compression,
+        SinkType sink = SINK_CHUNKED_FILE,
+        bool captureHands = false,
+        const PoseDecimatorConfig& decimation = PoseDecimatorConfig(),
+        bool capturePoseSamples = false);
+    ~MovementRecorder();
+
+    MovementRecorder(const MovementRecorder&) = delete;
+    MovementRecorder& operator=(const MovementRecorder&) = delete;
+
+    // Hilo de render
+    void recordFrame(const OVRFW::ovrApplFrameIn& in);
+
+    // Hilo de render, con las manos del frame. Sin captureHands se ignoran las manos.
+    void recordFrame(
+        const OVRFW::ovrApplFrameIn& in,
+        const HandJoints& leftHand,
+        const HandJoints& rightHand);
+
+    bool isCapturingHands() const { return handRing != nullptr; }
+
+    // Hilo de muestreo (un solo productor, normalmente PoseSampler). Nunca bloquea: si
+    // el escritor no da abasto se pierde la muestra mas antigua. Sin capturePoseSamples
+    // no hace nada.
+    void recordPoseSample(const RecordingPoseSample& sample);
+
+    bool isCapturingPoseSamples() const { return poseSampleRing != nullptr; }
+
+    // Segundos desde el inicio de la sesion, el reloj de los timestamps de los frames.
+    // Se puede llamar desde cualquier hilo.
+    double getSessionTime() const;
+
+    // Empieza a subir las partes terminadas (y las pendientes de ejecuciones anteriores)
+    void startUploads(const UploadQueue::Config& config);
+
+    // Bloquea hasta que todo lo encolado este escrito en disco (p.ej. en SessionEnd).
+    // El fichero actual sigue abierto.
+    void flush();
+
+    // Vacia la cola, cierra el fichero y para los hilos escritor y de subida.
+    // Lo que quede sin subir se retoma en la proxima ejecucion. Idempotente.
+    void finalize();
+
+    int getTotalFrames() const { return frameCount; }
+    int getCurrentFileIndex() const { return currentFileIndex.load(std::memory_order_relaxed); }
+
+    // Contadores, se pueden leer desde cualquier hilo
+    size_t getQueueDepth() const { return ring.size(); }
+    uint64_t getDroppedFrames() const { return droppedFrames.load(std::memory_order_relaxed); }
+    uint64_t getBlockedFrames() const { return blockedFrames.load(std::memory_order_relaxed); }
+    uint64_t getDroppedHandFrames() const {
+        return droppedHandFrames.load(std::memory_order_relaxed);
+    }
+    uint64_t getDroppedPoseSamples() const {
+        return droppedPoseSamples.load(std::memory_order_relaxed);
+    }
+    uint64_t getPoseSamplesWritten() const {
+        return poseSamplesWritten.load(std::memory_order_relaxed);
+    }
+    uint64_t getBytesWritten() const { return bytesWritten.load(std::memory_order_relaxed); }
+    // Frames que el diezmado no ha guardado
+    uint64_t getDecimatedFrames() const {
+        return decimatedFrames.load(std::memory_order_relaxed);
+    }
+    size_t getPendingUploads() const { return uploader.getPendingCount(); }
+    uint64_t getBytesUploaded() const { return uploader.getBytesUploaded(); }
+
+private:
+    // Hilo de render
+    std::chrono::high_resolution_clock::time_point startTime;
+    int64_t sessionStartUnixMs;
+    int frameCount;
+    BackpressurePolicy policy;
+    SinkType sinkType; // el escritor pasa a SINK_CHUNKED_FILE si no puede crear un segmento
+    bool finalized;
+
+    SpscRing<FrameData> ring;
+    std::thread writerThread;
+    std::atomic<bool> stopRequested{false};
+    std::atomic<uint64_t> flushRequested{0};
+    std::atomic<uint64_t> flushCompleted{0};
+    std::atomic<uint64_t> droppedFrames{0};
+    std::atomic<uint64_t> blockedFrames{0};
+    std::atomic<uint64_t> droppedHandFrames{0};
+    std::atomic<uint64_t> droppedPoseSamples{0};
+    std::atomic<uint64_t> poseSamplesWritten{0};
+    std::atomic<uint64_t> bytesWritten{0};
+    std::atomic<uint64_t> decimatedFrames{0};
+    std::atomic<int> currentFileIndex{0};
+    UploadQueue uploader;
+    std::unique_ptr<SpscRing<HandFrameData>> handRing; // nullptr sin captura de manos
+    HandFrameData handFrame; // solo lo usa el hilo de render
+    // nullptr sin muestras de pose
+    std::unique_ptr<SpscRing<RecordingPoseSample>> poseSampleRing;
+
+    // Hilo escritor
+    std::vector<FrameData> chunkBuffer;
+    std::vector<HandFrameData> handBuffer; // handBuffer[i] son las manos de chunkBuffer[i]
+    std::vector<RecordingPoseSample> poseSampleBuffer;
+    PoseDecimator decimator;
+    std::vector<FrameData> decimatorInput; // vacio sin diezmado
+    FrameData decimatorOutput[PoseDecimator::MAX_OUTPUT_PER_PUSH];
+    HandFrameData handLookahead; // sacado de la cola pero de un frame posterior
+    bool hasHandLookahead;
+    int framesInCurrentFile;
+    std::string baseFilename;
+    RecordingWriter writer;
+    MappedRecordingSink mappedSink;
+    uint32_t framesSinceSync;
+    std::vector<RecordingManifestEntry> manifestParts;
+    uint64_t framesInClosedFiles;
+    double partFirstTimestamp;
+    double partLastTimestamp;
+
+    void writerLoop();
+    void pushFrame(const FrameData& frame);
+    void matchHands(size_t first, size_t count);
+    size_t appendKept(size_t filled, size_t count);
+    std::string getCurrentFilename() const;
+    void saveBufferToFile(size_t count);
+    bool openWriter();
+    void savePoseSamples(bool all);
+    void appendToMappedSink(size_t count);
+    bool isFileOpen() const;
+    void closeCurrentFile();
+    void addPartToManifest(const std::string& filename);
+};
@@ -0,0 +1,278 @@
+#include "Recorder/PoseCodec.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace {
+
+const float HALF_SQRT2 = 0.70710678f; // rango de las tres componentes guardadas
+const uint8_t TAG_INDEX_MASK = 0x3;
+const uint8_t TAG_ABSOLUTE = 1 << 2;
+const int VALUES_PER_POSE = 6; // pos xyz + 3 componentes de rotacion
+const size_t MAX_VARINT_BYTES = 5; // zigzag de la diferencia de dos int32 cabe en 33 bits
+
+// Valores enteros de una pose ya cuantizada
+struct QuantizedPose {
+    int32_t values[VALUES_PER_POSE];
+    uint8_t largest;
+};
+
+uint32_t rotationMax(uint8_t bits) {
+    return (1u << bits) - 1u;
+}
+
+bool validConfig(float resolutionMm, uint8_t rotationBits) {
+    return std::isfinite(resolutionMm) && resolutionMm > 0.0f && rotationBits >= 8 &&
+        rotationBits <= 16;
+}
+
+int32_t quantizePosition(float meters, float unitsPerMeter) {
+    const double q = std::round(static_cast<double>(meters) * unitsPerMeter);
+    if (!(q > INT32_MIN)) {
+        return INT32_MIN; // tambien NaN
+    }
+    return q < INT32_MAX ? static_cast<int32_t>(q) : INT32_MAX;
+}
+
+void quantizePose(const float* pose, float unitsPerMeter, uint32_t rotMax, QuantizedPose& out) {
+    for (int i = 0; i < 3; i++) {
+        out.values[i] = quantizePosition(pose[i], unitsPerMeter);
+    }
+
+    float q[4] = {pose[3], pose[4], pose[5], pose[6]};
+    const float lengthSq = q[0] * q[0] + q[1] * q[1] + q[2] * q[2] + q[3] * q[3];
+    if (!(lengthSq > 1e-12f) || !std::isfinite(lengthSq)) {
+        q[0] = q[1] = q[2] = 0.0f;
+        q[3] = 1.0f;
+    } else {
+        const float inv = 1.0f / std::sqrt(lengthSq);
+        for (float& c : q) {
+            c *= inv;
+        }
+    }
+
+    uint8_t largest = 0;
+    for (uint8_t i = 1; i < 4; i++) {
+        if (std::fabs(q[i]) > std::fabs(q[largest])) {
+            largest = i;
+        }
+    }
+    // q y -q son la misma rotacion: la componente omitida siempre positiva
+    const float sign = q[largest] < 0.0f ? -1.0f : 1.0f;
+
+    const float scale = static_cast<float>(rotMax) / (2.0f * HALF_SQRT2);
+    int slot = 3;
+    for (uint8_t i = 0; i < 4; i++) {
+        if (i == largest) {
+            continue;
+        }
+        const float v = std::min(std::max(q[i] * sign, -HALF_SQRT2), HALF_SQRT2);
+        const long r = std::lround((v + HALF_SQRT2) * scale);
+        out.values[slot++] = static_cast<int32_t>(std::min<long>(std::max<long>(r, 0), rotMax));
+    }
+    out.largest = largest;
+}
+
+void dequantizePose(const QuantizedPose& in, float unitsPerMeter, uint32_t rotMax, float* pose) {
+    for (int i = 0; i < 3; i++) {
+        pose[i] = static_cast<float>(static_cast<double>(in.values[i]) / unitsPerMeter);
+    }
+
+    const float step = 2.0f * HALF_SQRT2 / static_cast<float>(rotMax);
+    float q[4];
+    float sumSq = 0.0f;
+    int slot = 3;
+    for (uint8_t i = 0; i < 4; i++) {
+        if (i == in.largest) {
+            continue;
+        }
+        q[i] = static_cast<float>(in.values[slot++]) * step - HALF_SQRT2;
+        sumSq += q[i] * q[i];
+    }
+    q[in.largest] = std::sqrt(std::max(0.0f, 1.0f - sumSq));
+    if (sumSq > 1.0f) {
+        // Solo con datos fuera de rango: renormalizar las tres guardadas
+        const float inv = 1.0f / std::sqrt(sumSq);
+        for (uint8_t i = 0; i < 4; i++) {
+            q[i] *= inv;
+        }
+    }
+    memcpy(pose + 3, q, sizeof(q));
+}
+
+uint8_t* putVarint(uint8_t* out, uint64_t value) {
+    while (value >= 0x80) {
+        *out++ = static_cast<uint8_t>(value | 0x80);
+        value >>= 7;
+    }
+    *out++ = static_cast<uint8_t>(value);
+    return out;
+}
+
+bool getVarint(const uint8_t*& in, const uint8_t* end, uint64_t& value) {
+    value = 0;
+    for (size_t i = 0; i < MAX_VARINT_BYTES; i++) {
+        if (in == end) {
+            return false;
+        }
+        const uint8_t byte = *in++;
+        value |= static_cast<uint64_t>(byte & 0x7f) << (7 * i);
+        if ((byte & 0x80) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+uint64_t zigzag(int64_t v) {
+    return (static_cast<uint64_t>(v) << 1) ^ static_cast<uint64_t>(v >> 63);
+}
+
+int64_t unzigzag(uint64_t v) {
+    return static_cast<int64_t>(v >> 1) ^ -static_cast<int64_t>(v & 1);
+}
+
+} // namespace
+
+size_t PoseCodec::maxEncodedSize(size_t frameCount) {
+    return sizeof(PoseCodecStreamHeader) + (frameCount + 7) / 8 +
+        frameCount * (1 + VALUES_PER_POSE * MAX_VARINT_BYTES);
+}
+
+size_t PoseCodec::encode(
+    const PoseCodecConfig& config,
+    const float* poses,
+    const uint8_t* present,
+    size_t frameCount,
+    uint8_t* out) {
+    PoseCodecStreamHeader header = {};
+    header.positionResolutionMm = config.positionResolutionMm;
+    header.rotationBits = config.rotationBits;
+    if (!validConfig(header.positionResolutionMm, header.rotationBits)) {
+        const PoseCodecConfig defaults;
+        header.positionResolutionMm = defaults.positionResolutionMm;
+        header.rotationBits = defaults.rotationBits;
+    }
+    memcpy(out, &header, sizeof(header));
+    uint8_t* cursor = out + sizeof(header);
+
+    uint8_t* mask = cursor;
+    const size_t maskBytes = (frameCount + 7) / 8;
+    memset(mask, 0, maskBytes);
+    cursor += maskBytes;
+
+    const float unitsPerMeter = 1000.0f / header.positionResolutionMm;
+    const uint32_t rotMax = rotationMax(header.rotationBits);
+
+    QuantizedPose previous = {};
+    bool havePrevious = false;
+    for (size_t i = 0; i < frameCount; i++) {
+        if (present != nullptr && !present[i]) {
+            continue;
+        }
+        mask[i / 8] |= static_cast<uint8_t>(1u << (i % 8));
+
+        QuantizedPose current;
+        quantizePose(poses + i * FLOATS_PER_POSE, unitsPerMeter, rotMax, current);
+
+        // Si cambia la componente omitida las deltas de rotacion no tienen sentido
+        const bool absolute = !havePrevious || current.largest != previous.largest;
+        *cursor++ = static_cast<uint8_t>(current.largest | (absolute ? TAG_ABSOLUTE : 0));
+        for (int v = 0; v < VALUES_PER_POSE; v++) {
+            const int64_t value = absolute
+                ? current.values[v]
+                : static_cast<int64_t>(current.values[v]) - previous.values[v];
+            cursor = putVarint(cursor, zigzag(value));
+        }
+        previous = current;
+        havePrevious = true;
+    }
+
+    return static_cast<size_t>(cursor - out);
+}
+
+bool PoseCodec::decode(
+    const uint8_t* data,
+    size_t size,
+    size_t frameCount,
+    float* poses,
+    uint8_t* present) {
+    const size_t maskBytes = (frameCount + 7) / 8;
+    if (size < sizeof(PoseCodecStreamHeader) + maskBytes) {
+        return false;
+    }
+    PoseCodecStreamHeader header;
+    memcpy(&header, data, sizeof(header));
+    if (!validConfig(header.positionResolutionMm, header.rotationBits)) {
+        return false;
+    }
+    const uint8_t* mask = data + sizeof(header);
+    const uint8_t* cursor = mask + maskBytes;
+    const uint8_t* end = data + size;
+
+    const float unitsPerMeter = 1000.0f / header.positionResolutionMm;
+    const uint32_t rotMax = rotationMax(header.rotationBits);
+
+    QuantizedPose previous = {};
+    bool havePrevious = false;
+    for (size_t i = 0; i < frameCount; i++) {
+        float* pose = poses + i * FLOATS_PER_POSE;
+        const bool isPresent = (mask[i / 8] >> (i % 8)) & 1;
+        if (present != nullptr) {
+            present[i] = isPresent ? 1 : 0;
+        }
+        if (!isPresent) {
+            pose[0] = pose[1] = pose[2] = 0.0f;
+            pose[3] = pose[4] = pose[5] = 0.0f;
+            pose[6] = 1.0f;
+            continue;
+        }
+
+        if (cursor == end) {
+            return false;
+        }
+        const uint8_t tag = *cursor++;
+        const bool absolute = (tag & TAG_ABSOLUTE) != 0;
+        if (!absolute && !havePrevious) {
+            return false;
+        }
+
+        QuantizedPose current;
+        current.largest = tag & TAG_INDEX_MASK;
+        for (int v = 0; v < VALUES_PER_POSE; v++) {
+            uint64_t raw;
+            if (!getVarint(cursor, end, raw)) {
+                return false;
+            }
+            int64_t value = unzigzag(raw);
+            if (!absolute) {
+                value += previous.values[v];
+            }
+            if (value < INT32_MIN || value > INT32_MAX ||
+                (v >= 3 && (value < 0 || value > static_cast<int64_t>(rotMax)))) {
+                return false;
+            }
+            current.values[v] = static_cast<int32_t>(value);
+        }
+
+        dequantizePose(current, unitsPerMeter, rotMax, pose);
+        previous = current;
+        havePrevious = true;
+    }
+
+    return cursor == end;
+}
+
+float PoseCodec::positionErrorBound(const PoseCodecConfig& config) {
+    return 0.5f * config.positionResolutionMm / 1000.0f;
+}
+
+float PoseCodec::rotationErrorBound(const PoseCodecConfig& config) {
+    // Cada componente guardada se equivoca como mucho medio paso; la omitida, que se
+    // reconstruye con sqrt y es >= 1/2, como mucho 3 medios pasos. La cuerda entre
+    // cuaterniones queda <= sqrt(12) * medio paso y el angulo de rotacion <= 2 * cuerda.
+    // 8 deja margen para el redondeo en float.
+    const float step = 2.0f * HALF_SQRT2 / static_cast<float>(rotationMax(config.rotationBits));
+    return 8.0f * 0.5f * step;
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+/*
+    Codec de poses cuantizadas para las columnas de pose de una grabacion
+    (RECORDING_ENCODING_POSE_QUANTIZED).
+
+    - Posicion: punto fijo con resolucion configurable en milimetros.
+    - Rotacion: "smallest three". Se guarda el indice de la componente mas grande
+      (que se fuerza positiva, q y -q son la misma rotacion) y las otras tres,
+      que estan en [-1/sqrt(2), 1/sqrt(2)], con rotationBits bits cada una.
+    - Cada frame se codifica como delta del anterior sobre los enteros cuantizados
+      (zigzag + varint), asi no hay deriva y un mando quieto ocupa ~7 bytes.
+    - Un bit de presencia por frame: los frames sin tracking no ocupan nada mas.
+
+    Cada chunk empieza con un frame absoluto, se puede decodificar sin los anteriores.
+
+    Errores maximos tras ida y vuelta (ver positionErrorBound / rotationErrorBound):
+      posicion  <= positionResolutionMm / 2 por eje (mas el redondeo del float, ~1e-7m
+                   a un par de metros del origen)
+      rotacion  <= 8 * paso / 2 radianes, paso = sqrt(2) / (2^rotationBits - 1)
+                   (14 bits: ~0.02 grados)
+    La rotacion decodificada puede salir con el signo cambiado (q en vez de -q).
+
+    Datos de la columna:
+        PoseCodecStreamHeader
+        bitmask de presencia, (frameCount + 7) / 8 bytes, bit i = frame i
+        por cada frame presente:
+            u8 tag: bits 0-1 indice de la componente omitida, bit 2 frame absoluto
+            6 varints zigzag: pos xyz y las tres componentes de rotacion guardadas
+*/
+
+#pragma pack(push, 1)
+struct PoseCodecStreamHeader {
+    float positionResolutionMm;
+    uint8_t rotationBits;
+    uint8_t reserved[3];
+};
+#pragma pack(pop)
+
+static_assert(sizeof(PoseCodecStreamHeader) == 8, "PoseCodecStreamHeader is part of the file format");
+
+struct PoseCodecConfig {
+    bool enabled = false;
+    float positionResolutionMm = 0.1f;
+    uint8_t rotationBits = 14; // 8..16
+};
+
+class PoseCodec {
+public:
+    static const int FLOATS_PER_POSE = 7; // pos xyz + rot xyzw
+
+    // Tamano maximo que puede ocupar la codificacion de frameCount poses
+    static size_t maxEncodedSize(size_t frameCount);
+
+    // poses: FLOATS_PER_POSE floats por frame. present: 0/1 por frame, nullptr = todos.
+    // Escribe en out (al menos maxEncodedSize bytes) y devuelve los bytes usados.
+    static size_t encode(
+        const PoseCodecConfig& config,
+        const float* poses,
+        const uint8_t* present,
+        size_t frameCount,
+        uint8_t* out);
+
+    // Inverso de encode. Los frames ausentes salen como pose identidad y present = 0.
+    // Devuelve false si los datos estan corruptos o no cuadran con frameCount.
+    static bool decode(
+        const uint8_t* data,
+        size_t size,
+        size_t frameCount,
+        float* poses,
+        uint8_t* present);
+
+    // Cotas de error de ida y vuelta (metros por eje y radianes)
+    static float positionErrorBound(const PoseCodecConfig& config);
+    static float rotationErrorBound(const PoseCodecConfig& config);
+};
@@ -0,0 +1,373 @@
+#include "Recorder/PoseDecimator.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+const int TRACK_COUNT = 3; // cabeza, mando izquierdo, mando derecho
+const float DEG_TO_RAD = 0.017453292f;
+const float RAD_TO_DEG = 57.29577951f;
+// Por encima de este coseno slerp y lerp normalizado difieren menos que el redondeo
+const float SLERP_LINEAR_DOT = 0.9995f;
+
+struct Pose {
+    float p[3];
+    float q[4];
+};
+
+bool isTracked(const FrameData& f, int track) {
+    switch (track) {
+        case 0:
+            return true;
+        case 1:
+            return f.leftControllerTracked;
+        default:
+            return f.rightControllerTracked;
+    }
+}
+
+Pose getPose(const FrameData& f, int track) {
+    switch (track) {
+        case 0:
+            return {
+                {f.headPosX, f.headPosY, f.headPosZ},
+                {f.headRotX, f.headRotY, f.headRotZ, f.headRotW}};
+        case 1:
+            return {
+                {f.leftPosX, f.leftPosY, f.leftPosZ},
+                {f.leftRotX, f.leftRotY, f.leftRotZ, f.leftRotW}};
+        default:
+            return {
+                {f.rightPosX, f.rightPosY, f.rightPosZ},
+                {f.rightRotX, f.rightRotY, f.rightRotZ, f.rightRotW}};
+    }
+}
+
+void setPose(FrameData& f, int track, const Pose& pose) {
+    switch (track) {
+        case 0:
+            f.headPosX = pose.p[0];
+            f.headPosY = pose.p[1];
+            f.headPosZ = pose.p[2];
+            f.headRotX = pose.q[0];
+            f.headRotY = pose.q[1];
+            f.headRotZ = pose.q[2];
+            f.headRotW = pose.q[3];
+            break;
+        case 1:
+            f.leftPosX = pose.p[0];
+            f.leftPosY = pose.p[1];
+            f.leftPosZ = pose.p[2];
+            f.leftRotX = pose.q[0];
+            f.leftRotY = pose.q[1];
+            f.leftRotZ = pose.q[2];
+            f.leftRotW = pose.q[3];
+            break;
+        default:
+            f.rightPosX = pose.p[0];
+            f.rightPosY = pose.p[1];
+            f.rightPosZ = pose.p[2];
+            f.rightRotX = pose.q[0];
+            f.rightRotY = pose.q[1];
+            f.rightRotZ = pose.q[2];
+            f.rightRotW = pose.q[3];
+            break;
+    }
+}
+
+// Interpolacion entre dos poses. El angulo del slerp se calcula una vez por segmento
+// y cada evaluacion solo cuesta dos senos.
+struct PoseSegment {
+    Pose a;
+    Pose b;
+    float theta;
+    float invSinTheta;
+    bool linear;
+
+    PoseSegment(const Pose& from, const Pose& to) : a(from), b(to) {
+        float dot = a.q[0] * b.q[0] + a.q[1] * b.q[1] + a.q[2] * b.q[2] + a.q[3] * b.q[3];
+        if (dot < 0.0f) { // q y -q son la misma rotacion, se toma el camino corto
+            for (float& c : b.q) {
+                c = -c;
+            }
+            dot = -dot;
+        }
+        linear = dot > SLERP_LINEAR_DOT;
+        theta = linear ? 0.0f : std::acos(std::min(dot, 1.0f));
+        invSinTheta = linear ? 0.0f : 1.0f / std::sin(theta);
+    }
+
+    void eval(float t, Pose& out) const {
+        for (int i = 0; i < 3; i++) {
+            out.p[i] = a.p[i] + (b.p[i] - a.p[i]) * t;
+        }
+        float wa = 1.0f - t;
+        float wb = t;
+        if (!linear) {
+            wa = std::sin(wa * theta) * invSinTheta;
+            wb = std::sin(wb * theta) * invSinTheta;
+        }
+        float lengthSq = 0.0f;
+        for (int i = 0; i < 4; i++) {
+            out.q[i] = a.q[i] * wa + b.q[i] * wb;
+            lengthSq += out.q[i] * out.q[i];
+        }
+        if (linear && lengthSq > 0.0f) {
+            const float inv = 1.0f / std::sqrt(lengthSq);
+            for (float& c : out.q) {
+                c *= inv;
+            }
+        }
+    }
+};
+
+float distanceSq(const Pose& x, const Pose& y) {
+    const float dx = x.p[0] - y.p[0];
+    const float dy = x.p[1] - y.p[1];
+    const float dz = x.p[2] - y.p[2];
+    return dx * dx + dy * dy + dz * dz;
+}
+
+float absDot(const Pose& x, const Pose& y) {
+    return std::fabs(x.q[0] * y.q[0] + x.q[1] * y.q[1] + x.q[2] * y.q[2] + x.q[3] * y.q[3]);
+}
+
+float fraction(const FrameData& a, const FrameData& b, double timestamp) {
+    const double span = b.timestamp - a.timestamp;
+    if (!(span > 0.0)) {
+        return 0.0f;
+    }
+    return static_cast<float>(std::min(1.0, std::max(0.0, (timestamp - a.timestamp) / span)));
+}
+
+// Gatillos reconstruidos entre a y b. Solo se interpolan si el mando tiene tracking en
+// los dos extremos; si no se mantiene el valor de a. fits e interpolate usan ambas,
+// asi lo que se comprueba al diezmar es lo mismo que sale al reconstruir.
+float leftTriggerAt(const FrameData& a, const FrameData& b, float t) {
+    if (!a.leftControllerTracked || !b.leftControllerTracked) {
+        return a.leftTriggerValue;
+    }
+    return a.leftTriggerValue + (b.leftTriggerValue - a.leftTriggerValue) * t;
+}
+
+float rightTriggerAt(const FrameData& a, const FrameData& b, float t) {
+    if (!a.rightControllerTracked || !b.rightControllerTracked) {
+        return a.rightTriggerValue;
+    }
+    return a.rightTriggerValue + (b.rightTriggerValue - a.rightTriggerValue) * t;
+}
+
+// Botones y tracking: si cambian el frame tiene que guardarse
+bool discreteChanged(const FrameData& x, const FrameData& y) {
+    return x.allButtons != y.allButtons || x.lastFrameAllButtons != y.lastFrameAllButtons ||
+        x.leftControllerTracked != y.leftControllerTracked ||
+        x.rightControllerTracked != y.rightControllerTracked;
+}
+
+float rotationDegrees(float absDotValue) {
+    return 2.0f * std::acos(std::min(absDotValue, 1.0f)) * RAD_TO_DEG;
+}
+
+// Avanza k hasta el ultimo guardado que no pasa de timestamp. Con instantes crecientes y
+// el k anterior se recorre cada guardado una sola vez.
+size_t advanceKept(const FrameData* kept, size_t keptCount, double timestamp, size_t k) {
+    while (k + 1 < keptCount && kept[k + 1].timestamp <= timestamp) {
+        k++;
+    }
+    return k;
+}
+
+// kept[k] y el siguiente, o kept[k] dos veces al final
+void interpolateKept(
+    const FrameData* kept,
+    size_t keptCount,
+    size_t k,
+    double timestamp,
+    FrameData& out) {
+    const FrameData& b = k + 1 < keptCount ? kept[k + 1] : kept[k];
+    PoseDecimator::interpolate(kept[k], b, timestamp, out);
+}
+
+} // namespace
+
+PoseDecimator::PoseDecimator(const PoseDecimatorConfig& cfg)
+    : config(cfg),
+      positionToleranceM(cfg.positionToleranceMm * 0.001f),
+      rotationCosHalfTolerance(std::cos(0.5f * cfg.rotationToleranceDeg * DEG_TO_RAD)),
+      anchor(),
+      previous() {
+    config.maxWindowFrames = std::max<uint32_t>(config.maxWindowFrames, 1);
+    pending.resize(config.maxWindowFrames);
+}
+
+bool PoseDecimator::fits(const FrameData& end, Deviation& deviation) const {
+    const float maxPositionSq = positionToleranceM * positionToleranceM;
+    deviation = Deviation();
+
+    for (int track = 0; track < TRACK_COUNT; track++) {
+        // Si el tracking cambia el frame se guarda antes de llegar aqui
+        if (!isTracked(end, track)) {
+            continue;
+        }
+        const PoseSegment segment(getPose(anchor, track), getPose(end, track));
+        for (size_t i = 0; i < pendingCount; i++) {
+            Pose rebuilt;
+            segment.eval(fraction(anchor, end, pending[i].timestamp), rebuilt);
+            const Pose original = getPose(pending[i], track);
+            const float positionSq = distanceSq(rebuilt, original);
+            const float dot = absDot(rebuilt, original);
+            if (positionSq > maxPositionSq || dot < rotationCosHalfTolerance) {
+                return false;
+            }
+            deviation.maxPositionSq = std::max(deviation.maxPositionSq, positionSq);
+            deviation.minRotationDot = std::min(deviation.minRotationDot, dot);
+        }
+    }
+
+    for (size_t i = 0; i < pendingCount; i++) {
+        const float t = fraction(anchor, end, pending[i].timestamp);
+        const float left = leftTriggerAt(anchor, end, t) - pending[i].leftTriggerValue;
+        const float right = rightTriggerAt(anchor, end, t) - pending[i].rightTriggerValue;
+        const float trigger = std::max(std::fabs(left), std::fabs(right));
+        if (trigger > config.triggerTolerance) {
+            return false;
+        }
+        deviation.maxTrigger = std::max(deviation.maxTrigger, trigger);
+    }
+    return true;
+}
+
+size_t PoseDecimator::keep(const FrameData& frame, FrameData* out, size_t n) {
+    out[n] = frame;
+    anchor = frame;
+    framesKept++;
+    return n + 1;
+}
+
+size_t PoseDecimator::push(const FrameData& frame, FrameData* out) {
+    framesIn++;
+    size_t n = 0;
+
+    if (!hasAnchor) {
+        hasAnchor = true;
+        n = keep(frame, out, n);
+    } else if (discreteChanged(previous, frame)) {
+        // El anterior cierra el segmento y este abre uno nuevo
+        if (pendingCount > 0) {
+            n = drain(out);
+        }
+        n = keep(frame, out, n);
+    } else {
+        Deviation deviation;
+        if (pendingCount > 0 &&
+            (pendingCount >= config.maxWindowFrames || !fits(frame, deviation))) {
+            n = drain(out);
+        } else if (pendingCount > 0) {
+            pendingDeviation = deviation;
+        }
+        if (pendingCount == 0) {
+            pendingDeviation = Deviation(); // segmento sin frames intermedios
+        }
+        pending[pendingCount++] = frame;
+    }
+
+    previous = frame;
+    return n;
+}
+
+size_t PoseDecimator::drain(FrameData* out) {
+    if (pendingCount == 0) {
+        return 0;
+    }
+    // Los pendientes anteriores al ultimo se descartan con el error ya medido
+    if (pendingCount > 1) {
+        maxError.maxPositionMm =
+            std::max(maxError.maxPositionMm, std::sqrt(pendingDeviation.maxPositionSq) * 1000.0f);
+        maxError.maxRotationDeg =
+            std::max(maxError.maxRotationDeg, rotationDegrees(pendingDeviation.minRotationDot));
+        maxError.maxTrigger = std::max(maxError.maxTrigger, pendingDeviation.maxTrigger);
+    }
+    const size_t n = keep(pending[pendingCount - 1], out, 0);
+    pendingCount = 0;
+    pendingDeviation = Deviation();
+    return n;
+}
+
+void PoseDecimator::interpolate(
+    const FrameData& a,
+    const FrameData& b,
+    double timestamp,
+    FrameData& out) {
+    out = a;
+    out.timestamp = timestamp;
+    const float t = fraction(a, b, timestamp);
+    for (int track = 0; track < TRACK_COUNT; track++) {
+        if (isTracked(a, track) && isTracked(b, track)) {
+            Pose pose;
+            PoseSegment(getPose(a, track), getPose(b, track)).eval(t, pose);
+            setPose(out, track, pose);
+        }
+    }
+    out.leftTriggerValue = leftTriggerAt(a, b, t);
+    out.rightTriggerValue = rightTriggerAt(a, b, t);
+}
+
+void PoseDecimator::reconstruct(
+    const FrameData* kept,
+    size_t keptCount,
+    const double* timestamps,
+    size_t count,
+    FrameData* out) {
+    if (keptCount == 0) {
+        return;
+    }
+    size_t k = 0;
+    for (size_t i = 0; i < count; i++) {
+        k = advanceKept(kept, keptCount, timestamps[i], k);
+        interpolateKept(kept, keptCount, k, timestamps[i], out[i]);
+    }
+}
+
+PoseDecimator::Error PoseDecimator::measureError(
+    const FrameData* kept,
+    size_t keptCount,
+    const FrameData* original,
+    size_t originalCount) {
+    Error error;
+    if (keptCount == 0) {
+        error.mismatchedDiscrete = originalCount;
+        return error;
+    }
+    float maxPositionSq = 0.0f;
+    float minDot = 1.0f;
+    // Mismo recorrido que reconstruct sin copiar los instantes: el cursor sigue de un
+    // original al siguiente, O(N+K) en vez de buscar desde el principio en cada frame
+    size_t k = 0;
+    for (size_t i = 0; i < originalCount; i++) {
+        FrameData rebuilt;
+        k = advanceKept(kept, keptCount, original[i].timestamp, k);
+        interpolateKept(kept, keptCount, k, original[i].timestamp, rebuilt);
+        if (discreteChanged(rebuilt, original[i])) {
+            error.mismatchedDiscrete++;
+            continue;
+        }
+        for (int track = 0; track < TRACK_COUNT; track++) {
+            if (!isTracked(original[i], track)) {
+                continue;
+            }
+            const Pose r = getPose(rebuilt, track);
+            const Pose o = getPose(original[i], track);
+            maxPositionSq = std::max(maxPositionSq, distanceSq(r, o));
+            minDot = std::min(minDot, absDot(r, o));
+        }
+        error.maxTrigger = std::max(
+            error.maxTrigger,
+            std::max(
+                std::fabs(rebuilt.leftTriggerValue - original[i].leftTriggerValue),
+                std::fabs(rebuilt.rightTriggerValue - original[i].rightTriggerValue)));
+    }
+    error.maxPositionMm = std::sqrt(maxPositionSq) * 1000.0f;
+    error.maxRotationDeg = rotationDegrees(minDot);
+    return error;
+}
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "Recorder/FrameData.h"
+
+/*
+    Diezmado en linea del flujo de frames: solo se guardan los frames necesarios para
+    rehacer los demas dentro de un presupuesto de error.
+
+    Seleccion de keyframes por ventana deslizante (la variante en streaming de
+    Ramer-Douglas-Peucker): desde el ultimo frame guardado (ancla) se van acumulando
+    frames mientras el segmento ancla -> frame nuevo reproduzca todos los intermedios
+    con lerp de posicion y slerp de rotacion (cabeza y mandos con tracking) y lerp de
+    gatillos dentro de las tolerancias. Cuando un frame no cabe, o la ventana llega a
+    maxWindowFrames, se guarda el anterior y pasa a ser el ancla.
+
+    Siempre se guardan los frames en los que cambian los botones (AllButtons o
+    LastFrameAllButtons) o el tracking de algun mando, y el frame anterior a cada uno:
+    entre dos frames guardados esos campos son constantes y se rehacen sin error.
+
+    Un frame queda decidido con un retraso de como mucho maxWindowFrames frames;
+    drain saca el ultimo pendiente (flush y final de la grabacion).
+    No reserva memoria despues del constructor.
+*/
+struct PoseDecimatorConfig {
+    bool enabled = false;
+    float positionToleranceMm = 1.0f; // distancia entre pose rehecha y original
+    float rotationToleranceDeg = 0.5f; // angulo entre rotacion rehecha y original
+    float triggerTolerance = 0.02f; // en unidades del gatillo, [0, 1]
+    uint32_t maxWindowFrames = 45; // medio segundo a 90fps
+};
+
+class PoseDecimator {
+public:
+
+    // Error de una reconstruccion frente a los frames originales
+    struct Error {
+        float maxPositionMm = 0.0f;
+        float maxRotationDeg = 0.0f;
+        float maxTrigger = 0.0f;
+        size_t mismatchedDiscrete = 0; // frames con botones o tracking distintos
+    };
+
+    // Frames que pueden salir de una llamada a push
+    static const size_t MAX_OUTPUT_PER_PUSH = 2;
+
+    explicit PoseDecimator(const PoseDecimatorConfig& config = PoseDecimatorConfig());
+
+    bool isEnabled() const { return config.enabled; }
+    const PoseDecimatorConfig& getConfig() const { return config; }
+
+    // Pasa el siguiente frame. Copia a out (MAX_OUTPUT_PER_PUSH huecos) los frames que
+    // quedan decididos como guardados, en orden, y devuelve cuantos son.
+    size_t push(const FrameData& frame, FrameData* out);
+
+    // Guarda el ultimo frame pendiente, si lo hay. Devuelve 0 o 1.
+    size_t drain(FrameData* out);
+
+    uint64_t getFramesIn() const { return framesIn; }
+    uint64_t getFramesKept() const { return framesKept; }
+    // Error maximo de los frames descartados hasta ahora
+    const Error& getMaxError() const { return maxError; }
+
+    // Frame en el instante timestamp entre dos frames guardados a y b: posiciones y
+    // gatillos con lerp, rotaciones con slerp; botones y tracking los de a.
+    static void interpolate(const FrameData& a, const FrameData& b, double timestamp, FrameData& out);
+
+    // Rehace los frames de los instantes dados (ordenados) a partir de los guardados
+    // (ordenados por timestamp). Fuera del rango guardado repite el extremo.
+    static void reconstruct(
+        const FrameData* kept,
+        size_t keptCount,
+        const double* timestamps,
+        size_t count,
+        FrameData* out);
+
+    // Rehace cada frame original (ordenados por timestamp, como se grabaron) a partir de
+    // los guardados y devuelve el error maximo. Recorre las dos listas una vez.
+    static Error measureError(
+        const FrameData* kept,
+        size_t keptCount,
+        const FrameData* original,
+        size_t originalCount);
+
+private:
+    // Desviacion de unos frames respecto a un segmento, sin raices ni acos
+    struct Deviation {
+        float maxPositionSq = 0.0f;
+        float minRotationDot = 1.0f;
+        float maxTrigger = 0.0f;
+    };
+
+    bool fits(const FrameData& end, Deviation& deviation) const;
+    size_t keep(const FrameData& frame, FrameData* out, size_t n);
+
+    PoseDecimatorConfig config;
+    float positionToleranceM;
+    float rotationCosHalfTolerance; // |dot| minimo entre cuaterniones
+    FrameData anchor;
+    FrameData previous;
+    bool hasAnchor = false;
+    std::vector<FrameData> pending; // frames despues del ancla aun sin decidir
+    size_t pendingCount = 0;
+    Deviation pendingDeviation; // de los pendientes en el segmento ancla -> ultimo
+    Error maxError;
+    uint64_t framesIn = 0;
+    uint64_t framesKept = 0;
+};
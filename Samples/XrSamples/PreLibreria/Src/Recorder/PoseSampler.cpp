@@ -0,0 +1,137 @@
+#include "Recorder/PoseSampler.h"
+
+#include <chrono>
+#include <cstring>
+
+#if defined(ANDROID) || defined(__linux__)
+#include <pthread.h>
+#endif
+
+#include "Misc/Log.h"
+
+#include "Recorder/MovementRecorder.h"
+
+namespace {
+
+const uint8_t SAMPLE_POSE_VALID =
+    RECORDING_SAMPLE_ORIENTATION_VALID | RECORDING_SAMPLE_POSITION_VALID;
+
+// Misma pose, velocidades y flags. El instante no cuenta: es lo que siempre cambia.
+bool sameMeasurement(const RecordingPoseSample& a, const RecordingPoseSample& b) {
+    return a.flags == b.flags && memcmp(a.pose, b.pose, sizeof(a.pose)) == 0 &&
+        memcmp(a.linearVelocity, b.linearVelocity, sizeof(a.linearVelocity)) == 0 &&
+        memcmp(a.angularVelocity, b.angularVelocity, sizeof(a.angularVelocity)) == 0;
+}
+
+} // namespace
+
+PoseSampler::PoseSampler(MovementRecorder& rec) : recorder(rec) {
+    memset(last, 0, sizeof(last));
+    memset(hasLast, 0, sizeof(hasLast));
+}
+
+PoseSampler::~PoseSampler() {
+    stop();
+}
+
+bool PoseSampler::start(
+    const PoseSamplerConfig& samplerConfig,
+    ClockFunction clock,
+    LocateFunction locateFunction) {
+    if (isRunning()) {
+        ALOGW("PoseSampler: already running");
+        return false;
+    }
+    if (samplerConfig.rateHz <= 0.0f || samplerConfig.sources == 0 || !clock ||
+        !locateFunction) {
+        ALOGE("PoseSampler: invalid configuration");
+        return false;
+    }
+    if (!recorder.isCapturingPoseSamples()) {
+        ALOGW("PoseSampler: the recorder was created without pose samples");
+        return false;
+    }
+
+    config = samplerConfig;
+    now = std::move(clock);
+    locate = std::move(locateFunction);
+    memset(hasLast, 0, sizeof(hasLast));
+    stopRequested.store(false, std::memory_order_relaxed);
+    samplerThread = std::thread(&PoseSampler::samplerLoop, this);
+
+    ALOG(
+        "PoseSampler started at %.0f Hz, %.1f ms behind",
+        config.rateHz,
+        config.lookbackNs * 1e-6);
+    return true;
+}
+
+void PoseSampler::stop() {
+    if (!isRunning()) {
+        return;
+    }
+    stopRequested.store(true, std::memory_order_release);
+    samplerThread.join();
+
+    ALOG(
+        "PoseSampler stopped: %llu samples, %llu duplicates, %llu invalid, %llu late ticks",
+        static_cast<unsigned long long>(samples.load()),
+        static_cast<unsigned long long>(duplicates.load()),
+        static_cast<unsigned long long>(invalid.load()),
+        static_cast<unsigned long long>(lateTicks.load()));
+}
+
+void PoseSampler::samplerLoop() {
+#if defined(ANDROID) || defined(__linux__)
+    pthread_setname_np(pthread_self(), "PoseSampler");
+#endif
+
+    using Clock = std::chrono::steady_clock;
+    const Clock::duration period = std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<double>(1.0 / config.rateHz));
+    const double lookbackSeconds = config.lookbackNs * 1e-9;
+
+    Clock::time_point next = Clock::now();
+    while (!stopRequested.load(std::memory_order_acquire)) {
+        // Los dos relojes se leen seguidos, asi timestamp y XrTime de la muestra cuadran
+        const int64_t time = now() - config.lookbackNs;
+        const double timestamp = recorder.getSessionTime() - lookbackSeconds;
+        for (int source = 0; source < RECORDING_POSE_SOURCE_COUNT; source++) {
+            if ((config.sources >> source) & 1) {
+                sample(static_cast<RecordingPoseSource>(source), time, timestamp);
+            }
+        }
+
+        next += period;
+        const Clock::time_point current = Clock::now();
+        if (current > next + period) {
+            // Sin rafagas para recuperar: se sigue desde ahora
+            lateTicks.fetch_add(1, std::memory_order_relaxed);
+            next = current;
+            continue;
+        }
+        std::this_thread::sleep_until(next);
+    }
+}
+
+void PoseSampler::sample(RecordingPoseSource source, int64_t time, double timestamp) {
+    RecordingPoseSample s = {};
+    if (!locate(source, time, s) || (s.flags & SAMPLE_POSE_VALID) != SAMPLE_POSE_VALID) {
+        invalid.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    s.time = time;
+    s.timestamp = timestamp;
+    s.source = source;
+
+    RecordingPoseSample& previous = last[source];
+    if (hasLast[source] && (time <= previous.time || sameMeasurement(s, previous))) {
+        duplicates.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    previous = s;
+    hasLast[source] = true;
+
+    recorder.recordPoseSample(s);
+    samples.fetch_add(1, std::memory_order_relaxed);
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <thread>
+
+#include "Recorder/RecordingFormat.h"
+
+class MovementRecorder;
+
+// Como muestrea PoseSampler
+struct PoseSamplerConfig {
+    float rateHz = 500.0f;
+    // Cuanto por detras de "ahora" se pide cada muestra. Un instante algo pasado ya lo
+    // ha medido el runtime; uno en el presente o en el futuro es una prediccion.
+    int64_t lookbackNs = 20000000; // 20ms
+    // Bit (1 << RecordingPoseSource) por cada espacio a muestrear
+    uint32_t sources = (1u << RECORDING_POSE_SOURCE_COUNT) - 1;
+};
+
+// Muestrea poses de cabeza y mandos en su propio hilo, a mas frecuencia que los frames,
+// y las pasa a MovementRecorder::recordPoseSample. Los frames solo ven la pose en el
+// PredictedDisplayTime de cada frame; esto recoge lo que el runtime tenga entre medias.
+//
+// No depende de openxr.h: la app da dos funciones, una con el XrTime actual (p.ej.
+// xrConvertTimespecTimeToTimeKHR) y otra que localiza una fuente en un instante
+// (xrLocateSpace con XrSpaceVelocity) y rellena pose, velocidades y flags de la muestra.
+// Las dos se llaman desde el hilo del muestreador.
+//
+// Se descartan las muestras sin posicion u orientacion validas y las repetidas: mismo
+// instante o exactamente la misma pose y velocidades que la anterior de esa fuente (el
+// runtime no tenia nada nuevo). Una fuente quieta deja de generar muestras hasta que se
+// mueve; quien lea el fichero mantiene la ultima.
+class PoseSampler {
+public:
+    using ClockFunction = std::function<int64_t()>;
+    using LocateFunction =
+        std::function<bool(RecordingPoseSource source, int64_t time, RecordingPoseSample& sample)>;
+
+    // El grabador tiene que haberse creado con capturePoseSamples y vivir mas que esto
+    explicit PoseSampler(MovementRecorder& recorder);
+    ~PoseSampler();
+
+    PoseSampler(const PoseSampler&) = delete;
+    PoseSampler& operator=(const PoseSampler&) = delete;
+
+    // Arranca el hilo. false si ya estaba en marcha o la configuracion no vale.
+    bool start(const PoseSamplerConfig& config, ClockFunction now, LocateFunction locate);
+
+    // Para el hilo y espera a que termine. Llamarlo antes de destruir los espacios
+    // que usa locate. Idempotente.
+    void stop();
+
+    bool isRunning() const { return samplerThread.joinable(); }
+
+    // Contadores, se pueden leer desde cualquier hilo
+    uint64_t getSamples() const { return samples.load(std::memory_order_relaxed); }
+    uint64_t getDuplicateSamples() const { return duplicates.load(std::memory_order_relaxed); }
+    uint64_t getInvalidSamples() const { return invalid.load(std::memory_order_relaxed); }
+    // Vueltas que empezaron mas de un periodo tarde (el hilo no llega a la frecuencia)
+    uint64_t getLateTicks() const { return lateTicks.load(std::memory_order_relaxed); }
+
+private:
+    void samplerLoop();
+    void sample(RecordingPoseSource source, int64_t time, double timestamp);
+
+    MovementRecorder& recorder;
+    PoseSamplerConfig config;
+    ClockFunction now;
+    LocateFunction locate;
+    std::thread samplerThread;
+    std::atomic<bool> stopRequested{false};
+    std::atomic<uint64_t> samples{0};
+    std::atomic<uint64_t> duplicates{0};
+    std::atomic<uint64_t> invalid{0};
+    std::atomic<uint64_t> lateTicks{0};
+
+    // Hilo de muestreo: ultima muestra guardada de cada fuente
+    RecordingPoseSample last[RECORDING_POSE_SOURCE_COUNT];
+    bool hasLast[RECORDING_POSE_SOURCE_COUNT];
+};
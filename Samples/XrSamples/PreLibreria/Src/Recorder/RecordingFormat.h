@@ -0,0 +1,286 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+/*
+    Formato binario de grabacion (.vrmr)
+
+    Sustituye a los CSV por parte. Todo se escribe en little-endian (Quest y PC lo son)
+    y con structs empaquetados a mano, sin padding implicito.
+
+        RecordingFileHeader                     cabecera fija
+        RecordingFieldDesc x fieldCount         esquema: que columnas hay y como son
+        [ RecordingChunkHeader                  bloque de frameCount frames
+          ( RecordingColumnHeader + datos ) x columnCount ] x N
+        [ RecordingSampleChunkHeader            muestras de pose a alta frecuencia (version 3)
+          RecordingPoseSample x sampleCount ] intercalados con los chunks de frames
+        RecordingIndexHeader                    indice de chunks (version 2), al cerrar
+        RecordingIndexEntry x entryCount        offset, frames y timestamps de cada chunk
+        RecordingIndexFooter                    ultimos 16 bytes: donde empieza el indice
+
+    Dentro de un chunk cada columna va contigua (todos los timestamps, luego todas las
+    poses de cabeza, etc.), asi escribir es un memcpy por columna y leer una sola
+    columna no obliga a decodificar el resto. La conversion a CSV es un paso offline
+    (RecordingReader::exportCsv), en el dispositivo no se formatea texto.
+
+    Con el pie se llega a cualquier chunk por tiempo o numero de frame con una
+    busqueda binaria sobre el indice, sin leer los anteriores. Una parte que no se
+    llego a cerrar no tiene indice; RecordingReader lo rehace saltando de cabecera
+    en cabecera de chunk.
+
+    Las columnas de manos (26 articulaciones por mano) solo aparecen en los chunks
+    grabados con captura de manos; el esquema las declara siempre. Van en
+    RECORDING_ENCODING_HAND_SOA, ver HandJointColumn.h.
+
+    Las muestras de pose (PoseSampler) no van al ritmo de los frames: son un flujo
+    aparte, ordenado por tiempo, en chunks SMPL que el escritor intercala cuando tiene
+    bastantes y antes de cerrar cada parte. Cada muestra es un registro fijo con su
+    XrTime. Los chunks SMPL no entran en el indice y readChunk los salta; se leen con
+    RecordingReader::readPoseSamples.
+
+    Segmentos mapeados (.vrms, MappedRecordingSink)
+
+        RecordingSegmentHeader                  cabecera fija, frameCount al dia
+        RecordingFrameRecord x frameCount       un registro de tamano fijo por frame
+
+    El fichero se preasigna y se escribe a traves de un mmap, sin llamadas al sistema
+    por frame. Si la app muere antes de cerrarlo el fichero conserva el tamano
+    preasignado; el lector se fia de frameCount y no de la longitud.
+
+    Manifiesto de sesion (.vrmx, RecordingSession)
+
+        RecordingManifestHeader                 cabecera fija
+        RecordingManifestEntry x partCount      fichero, frames y timestamps de cada parte
+
+    Lo reescribe el grabador cada vez que cierra una parte. Con el manifiesto se
+    elige la parte de un instante sin abrir las demas.
+*/
+
+static const char RECORDING_FILE_MAGIC[4] = {'V', 'R', 'M', 'R'};
+static const char RECORDING_CHUNK_MAGIC[4] = {'C', 'H', 'N', 'K'};
+static const char RECORDING_SEGMENT_MAGIC[4] = {'V', 'R', 'M', 'S'};
+static const char RECORDING_INDEX_MAGIC[4] = {'I', 'N', 'D', 'X'};
+static const char RECORDING_FOOTER_MAGIC[4] = {'V', 'R', 'M', 'I'};
+static const char RECORDING_MANIFEST_MAGIC[4] = {'V', 'R', 'M', 'X'};
+static const char RECORDING_SAMPLES_MAGIC[4] = {'S', 'M', 'P', 'L'};
+
+// Subir la version cada vez que cambie el significado de algun campo.
+// El lector rechaza versiones mayores que la suya.
+// 2: indice de chunks al final de los .vrmr
+// 3: chunks de muestras de pose (SMPL) entre los chunks de frames
+static const uint16_t RECORDING_FORMAT_VERSION = 3;
+
+// Identificadores de columna. No reordenar: estan escritos en los ficheros.
+enum RecordingColumn : uint16_t {
+    RECORDING_COLUMN_TIMESTAMP = 0, // f64 x1, segundos desde el inicio de la sesion
+    RECORDING_COLUMN_HEAD_POSE = 1, // f32 x7, pos xyz + rot xyzw
+    RECORDING_COLUMN_LEFT_POSE = 2, // f32 x7
+    RECORDING_COLUMN_RIGHT_POSE = 3, // f32 x7
+    RECORDING_COLUMN_TRIGGERS = 4, // f32 x2, gatillo izquierdo y derecho
+    RECORDING_COLUMN_TRACKED = 5, // u8 x1, bit0 izquierdo, bit1 derecho
+    RECORDING_COLUMN_BUTTONS = 6, // u32 x2, AllButtons y LastFrameAllButtons
+    RECORDING_COLUMN_LEFT_HAND = 7, // f32 x208, 26 articulaciones x (pos xyz + rot xyzw + radio)
+    RECORDING_COLUMN_RIGHT_HAND = 8, // f32 x208
+    RECORDING_COLUMN_COUNT
+};
+
+enum RecordingValueType : uint8_t {
+    RECORDING_TYPE_U8 = 0,
+    RECORDING_TYPE_U32 = 1,
+    RECORDING_TYPE_F32 = 2,
+    RECORDING_TYPE_F64 = 3,
+};
+
+// Como estan codificados los datos de una columna dentro de un chunk
+enum RecordingEncoding : uint16_t {
+    RECORDING_ENCODING_RAW = 0, // array plano de frameCount * components valores
+    RECORDING_ENCODING_POSE_QUANTIZED = 1, // solo columnas de pose, ver PoseCodec.h
+    RECORDING_ENCODING_HAND_SOA = 2, // solo columnas de manos, ver HandJointColumn.h
+};
+
+static const uint8_t RECORDING_TRACKED_LEFT = 1 << 0;
+static const uint8_t RECORDING_TRACKED_RIGHT = 1 << 1;
+
+// Espacio del que sale una muestra de pose. No reordenar: estan escritos en los ficheros.
+enum RecordingPoseSource : uint8_t {
+    RECORDING_POSE_SOURCE_HEAD = 0,
+    RECORDING_POSE_SOURCE_LEFT_GRIP = 1,
+    RECORDING_POSE_SOURCE_RIGHT_GRIP = 2,
+    RECORDING_POSE_SOURCE_LEFT_AIM = 3,
+    RECORDING_POSE_SOURCE_RIGHT_AIM = 4,
+    RECORDING_POSE_SOURCE_COUNT
+};
+
+// Bits de RecordingPoseSample::flags. Los cuatro primeros son los de
+// XrSpaceLocationFlags y los dos siguientes los de XrSpaceVelocityFlags << 4.
+static const uint8_t RECORDING_SAMPLE_ORIENTATION_VALID = 0x01;
+static const uint8_t RECORDING_SAMPLE_POSITION_VALID = 0x02;
+static const uint8_t RECORDING_SAMPLE_ORIENTATION_TRACKED = 0x04;
+static const uint8_t RECORDING_SAMPLE_POSITION_TRACKED = 0x08;
+static const uint8_t RECORDING_SAMPLE_LINEAR_VELOCITY_VALID = 0x10;
+static const uint8_t RECORDING_SAMPLE_ANGULAR_VELOCITY_VALID = 0x20;
+
+#pragma pack(push, 1)
+
+struct RecordingFileHeader {
+    char magic[4]; // RECORDING_FILE_MAGIC
+    uint16_t version; // RECORDING_FORMAT_VERSION
+    uint16_t headerSize; // sizeof(RecordingFileHeader), para poder crecer
+    uint32_t fieldCount; // entradas de esquema que siguen a la cabecera
+    uint32_t partIndex; // indice del fichero dentro de la sesion
+    int64_t sessionStartUnixMs; // hora de pared del inicio de la sesion
+    uint8_t reserved[8];
+};
+
+struct RecordingFieldDesc {
+    uint16_t column; // RecordingColumn
+    uint8_t type; // RecordingValueType
+    uint8_t components; // valores por frame
+    char name[28]; // terminado en 0, informativo
+};
+
+struct RecordingChunkHeader {
+    char magic[4]; // RECORDING_CHUNK_MAGIC
+    uint32_t frameCount;
+    uint32_t columnCount;
+    uint32_t payloadSize; // bytes de columnas que siguen a esta cabecera
+};
+
+struct RecordingColumnHeader {
+    uint16_t column; // RecordingColumn
+    uint16_t encoding; // RecordingEncoding
+    uint32_t size; // bytes de datos que siguen a esta cabecera
+};
+
+struct RecordingSegmentHeader {
+    char magic[4]; // RECORDING_SEGMENT_MAGIC
+    uint16_t version; // RECORDING_FORMAT_VERSION
+    uint16_t headerSize; // sizeof(RecordingSegmentHeader)
+    uint32_t recordSize; // sizeof(RecordingFrameRecord)
+    uint32_t partIndex;
+    int64_t sessionStartUnixMs;
+    uint32_t frameCount; // registros completos; se actualiza tras escribir cada uno
+    uint32_t capacity; // registros que caben en el fichero preasignado
+};
+
+// Ocupa lo mismo que RecordingChunkHeader: un lector secuencial lo lee como tal y
+// reconoce el magic como fin de los chunks
+struct RecordingIndexHeader {
+    char magic[4]; // RECORDING_INDEX_MAGIC
+    uint32_t entryCount;
+    uint32_t frameCount; // frames de toda la parte
+    uint32_t entrySize; // sizeof(RecordingIndexEntry)
+};
+
+struct RecordingIndexEntry {
+    uint64_t offset; // posicion de la RecordingChunkHeader en el fichero
+    uint32_t firstFrame; // numero del primer frame del chunk dentro de la parte
+    uint32_t frameCount;
+    double firstTimestamp;
+    double lastTimestamp;
+};
+
+struct RecordingIndexFooter {
+    uint64_t indexOffset; // posicion de la RecordingIndexHeader
+    uint32_t entryCount;
+    char magic[4]; // RECORDING_FOOTER_MAGIC, ultimo del fichero
+};
+
+struct RecordingManifestHeader {
+    char magic[4]; // RECORDING_MANIFEST_MAGIC
+    uint16_t version; // RECORDING_FORMAT_VERSION
+    uint16_t headerSize; // sizeof(RecordingManifestHeader)
+    uint32_t partCount;
+    uint32_t entrySize; // sizeof(RecordingManifestEntry)
+    int64_t sessionStartUnixMs;
+    uint8_t reserved[8];
+};
+
+struct RecordingManifestEntry {
+    uint32_t partIndex;
+    uint32_t frameCount;
+    uint64_t firstFrame; // numero del primer frame de la parte dentro de la sesion
+    double firstTimestamp;
+    double lastTimestamp;
+    char filename[96]; // terminado en 0, relativo al manifiesto
+};
+
+// Ocupa lo mismo que RecordingChunkHeader, por el mismo motivo que RecordingIndexHeader
+struct RecordingSampleChunkHeader {
+    char magic[4]; // RECORDING_SAMPLES_MAGIC
+    uint32_t sampleCount;
+    uint32_t sampleSize; // sizeof(RecordingPoseSample)
+    uint32_t payloadSize; // sampleCount * sampleSize
+};
+
+// Una pose de un espacio en un instante, con velocidades si el runtime las da
+struct RecordingPoseSample {
+    int64_t time; // XrTime en ns, el instante que se pidio al runtime
+    double timestamp; // mismo reloj que los timestamps de los frames
+    uint8_t source; // RecordingPoseSource
+    uint8_t flags; // RECORDING_SAMPLE_*
+    uint8_t reserved[2];
+    float pose[7]; // pos xyz + rot xyzw, en el mismo espacio que las poses de los frames
+    float linearVelocity[3]; // m/s
+    float angularVelocity[3]; // rad/s
+};
+
+// Mismos campos y unidades que las columnas de un chunk, en una fila
+struct RecordingFrameRecord {
+    double timestamp;
+    float headPose[7]; // pos xyz + rot xyzw
+    float leftPose[7];
+    float rightPose[7];
+    float triggers[2];
+    uint32_t buttons[2]; // AllButtons y LastFrameAllButtons
+    uint8_t tracked; // RECORDING_TRACKED_*
+    uint8_t reserved[3];
+};
+
+#pragma pack(pop)
+
+static_assert(sizeof(RecordingFileHeader) == 32, "RecordingFileHeader is part of the file format");
+static_assert(sizeof(RecordingFieldDesc) == 32, "RecordingFieldDesc is part of the file format");
+static_assert(sizeof(RecordingChunkHeader) == 16, "RecordingChunkHeader is part of the file format");
+static_assert(sizeof(RecordingColumnHeader) == 8, "RecordingColumnHeader is part of the file format");
+static_assert(sizeof(RecordingSegmentHeader) == 32, "RecordingSegmentHeader is part of the file format");
+static_assert(
+    sizeof(RecordingIndexHeader) == sizeof(RecordingChunkHeader),
+    "RecordingIndexHeader is read in place of a RecordingChunkHeader");
+static_assert(sizeof(RecordingIndexEntry) == 32, "RecordingIndexEntry is part of the file format");
+static_assert(sizeof(RecordingIndexFooter) == 16, "RecordingIndexFooter is part of the file format");
+static_assert(sizeof(RecordingManifestHeader) == 32, "RecordingManifestHeader is part of the file format");
+static_assert(sizeof(RecordingManifestEntry) == 128, "RecordingManifestEntry is part of the file format");
+static_assert(sizeof(RecordingFrameRecord) == 112, "RecordingFrameRecord is part of the file format");
+static_assert(
+    sizeof(RecordingSampleChunkHeader) == sizeof(RecordingChunkHeader),
+    "RecordingSampleChunkHeader is read in place of a RecordingChunkHeader");
+static_assert(sizeof(RecordingPoseSample) == 72, "RecordingPoseSample is part of the file format");
+
+// Esquema que escribe esta version del grabador
+static const RecordingFieldDesc RECORDING_SCHEMA[RECORDING_COLUMN_COUNT] = {
+    {RECORDING_COLUMN_TIMESTAMP, RECORDING_TYPE_F64, 1, "timestamp"},
+    {RECORDING_COLUMN_HEAD_POSE, RECORDING_TYPE_F32, 7, "head_pose"},
+    {RECORDING_COLUMN_LEFT_POSE, RECORDING_TYPE_F32, 7, "left_pose"},
+    {RECORDING_COLUMN_RIGHT_POSE, RECORDING_TYPE_F32, 7, "right_pose"},
+    {RECORDING_COLUMN_TRIGGERS, RECORDING_TYPE_F32, 2, "triggers"},
+    {RECORDING_COLUMN_TRACKED, RECORDING_TYPE_U8, 1, "tracked"},
+    {RECORDING_COLUMN_BUTTONS, RECORDING_TYPE_U32, 2, "buttons"},
+    {RECORDING_COLUMN_LEFT_HAND, RECORDING_TYPE_F32, 208, "left_hand_joints"},
+    {RECORDING_COLUMN_RIGHT_HAND, RECORDING_TYPE_F32, 208, "right_hand_joints"},
+};
+
+inline size_t RecordingValueSize(const uint8_t type) {
+    switch (type) {
+        case RECORDING_TYPE_U8:
+            return 1;
+        case RECORDING_TYPE_U32:
+        case RECORDING_TYPE_F32:
+            return 4;
+        case RECORDING_TYPE_F64:
+            return 8;
+        default:
+            return 0;
+    }
+}
@@ -0,0 +1,692 @@
+#include "Recorder/RecordingReader.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+
+#include "Misc/Log.h"
+
+#include "Recorder/HandJointColumn.h"
+#include "Recorder/MappedRecordingSink.h"
+#include "Recorder/PoseCodec.h"
+
+namespace {
+
+// Limites de cordura para no reservar memoria a ciegas con un fichero corrupto
+const uint32_t MAX_SCHEMA_FIELDS = 256;
+const uint32_t MAX_CHUNK_PAYLOAD = 256u * 1024u * 1024u;
+
+// Frames que devuelve cada readChunk de un segmento mapeado
+const uint32_t SEGMENT_FRAMES_PER_READ = 900;
+
+template <typename T>
+T readValue(const uint8_t* data, size_t index) {
+    T value;
+    memcpy(&value, data + index * sizeof(T), sizeof(T));
+    return value;
+}
+
+void readPose(const uint8_t* data, size_t frame, float* out) {
+    memcpy(out, data + frame * 7 * sizeof(float), 7 * sizeof(float));
+}
+
+void setPose(FrameData& f, RecordingColumn column, const float* p) {
+    switch (column) {
+        case RECORDING_COLUMN_HEAD_POSE:
+            f.headPosX = p[0];
+            f.headPosY = p[1];
+            f.headPosZ = p[2];
+            f.headRotX = p[3];
+            f.headRotY = p[4];
+            f.headRotZ = p[5];
+            f.headRotW = p[6];
+            break;
+        case RECORDING_COLUMN_LEFT_POSE:
+            f.leftPosX = p[0];
+            f.leftPosY = p[1];
+            f.leftPosZ = p[2];
+            f.leftRotX = p[3];
+            f.leftRotY = p[4];
+            f.leftRotZ = p[5];
+            f.leftRotW = p[6];
+            break;
+        case RECORDING_COLUMN_RIGHT_POSE:
+            f.rightPosX = p[0];
+            f.rightPosY = p[1];
+            f.rightPosZ = p[2];
+            f.rightRotX = p[3];
+            f.rightRotY = p[4];
+            f.rightRotZ = p[5];
+            f.rightRotW = p[6];
+            break;
+        default:
+            break;
+    }
+}
+
+bool isHandColumn(uint16_t column) {
+    return column == RECORDING_COLUMN_LEFT_HAND || column == RECORDING_COLUMN_RIGHT_HAND;
+}
+
+bool isPoseColumn(uint16_t column) {
+    return column == RECORDING_COLUMN_HEAD_POSE || column == RECORDING_COLUMN_LEFT_POSE ||
+        column == RECORDING_COLUMN_RIGHT_POSE;
+}
+
+} // namespace
+
+RecordingReader::~RecordingReader() {
+    close();
+}
+
+bool RecordingReader::open(const std::string& name) {
+    close();
+
+    file.open(name, std::ios::binary);
+    if (!file.is_open()) {
+        ALOGE("RecordingReader: could not open %s", name.c_str());
+        return false;
+    }
+    filename = name;
+
+    file.read(reinterpret_cast<char*>(&header), sizeof(header));
+    if (file.good() && memcmp(header.magic, RECORDING_SEGMENT_MAGIC, sizeof(header.magic)) == 0) {
+        return openSegment();
+    }
+    if (!file.good() || memcmp(header.magic, RECORDING_FILE_MAGIC, sizeof(header.magic)) != 0) {
+        ALOGE("RecordingReader: %s is not a recording", name.c_str());
+        close();
+        return false;
+    }
+    if (header.version > RECORDING_FORMAT_VERSION || header.headerSize < sizeof(header) ||
+        header.fieldCount > MAX_SCHEMA_FIELDS) {
+        ALOGE(
+            "RecordingReader: unsupported recording %s (version %u)",
+            name.c_str(),
+            header.version);
+        close();
+        return false;
+    }
+    // Una cabecera mas grande viene de una version compatible, se ignora el resto
+    file.seekg(header.headerSize, std::ios::beg);
+
+    schema.resize(header.fieldCount);
+    file.read(
+        reinterpret_cast<char*>(schema.data()),
+        static_cast<std::streamsize>(schema.size() * sizeof(RecordingFieldDesc)));
+    if (!file.good()) {
+        ALOGE("RecordingReader: truncated schema in %s", name.c_str());
+        close();
+        return false;
+    }
+    dataOffset = static_cast<uint64_t>(file.tellg());
+
+    // Las columnas conocidas tienen que tener el tipo que espera este lector
+    for (const RecordingFieldDesc& field : schema) {
+        if (field.column >= RECORDING_COLUMN_COUNT) {
+            continue;
+        }
+        const RecordingFieldDesc& expected = RECORDING_SCHEMA[field.column];
+        if (field.type != expected.type || field.components != expected.components) {
+            ALOGE(
+                "RecordingReader: column %u of %s does not match the schema",
+                field.column,
+                name.c_str());
+            close();
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool RecordingReader::openSegment() {
+    static_assert(
+        sizeof(RecordingSegmentHeader) == sizeof(RecordingFileHeader),
+        "open reads both headers with the same read");
+    RecordingSegmentHeader segment;
+    memcpy(&segment, &header, sizeof(segment));
+    if (segment.version > RECORDING_FORMAT_VERSION || segment.headerSize < sizeof(segment) ||
+        segment.recordSize != sizeof(RecordingFrameRecord)) {
+        ALOGE(
+            "RecordingReader: unsupported segment %s (version %u)",
+            filename.c_str(),
+            segment.version);
+        close();
+        return false;
+    }
+
+    // Un segmento sin cerrar conserva el tamano preasignado: manda frameCount,
+    // pero nunca mas registros de los que caben en el fichero
+    file.seekg(0, std::ios::end);
+    const uint64_t length = static_cast<uint64_t>(file.tellg());
+    const uint64_t stored = length > segment.headerSize
+        ? (length - segment.headerSize) / sizeof(RecordingFrameRecord)
+        : 0;
+    segmentFrameCount = static_cast<uint32_t>(std::min<uint64_t>(segment.frameCount, stored));
+    segmentRemaining = segmentFrameCount;
+    isSegment = true;
+    dataOffset = segment.headerSize;
+    file.seekg(segment.headerSize, std::ios::beg);
+
+    // Para getHeader: los campos comunes de una grabacion
+    header = {};
+    memcpy(header.magic, segment.magic, sizeof(header.magic));
+    header.version = segment.version;
+    header.headerSize = segment.headerSize;
+    header.partIndex = segment.partIndex;
+    header.sessionStartUnixMs = segment.sessionStartUnixMs;
+    schema.assign(RECORDING_SCHEMA, RECORDING_SCHEMA + RECORDING_COLUMN_COUNT);
+    return true;
+}
+
+void RecordingReader::close() {
+    if (file.is_open()) {
+        file.close();
+    }
+    header = {};
+    schema.clear();
+    index.clear();
+    indexLoaded = false;
+    dataOffset = 0;
+    isSegment = false;
+    segmentFrameCount = 0;
+    segmentRemaining = 0;
+}
+
+bool RecordingReader::loadIndex() {
+    if (indexLoaded) {
+        return true;
+    }
+    if (!file.is_open()) {
+        return false;
+    }
+    file.clear();
+    const std::streampos position = file.tellg();
+    bool loaded = false;
+
+    if (isSegment) {
+        loaded = scanSegment();
+    } else {
+        file.seekg(0, std::ios::end);
+        const uint64_t length = static_cast<uint64_t>(file.tellg());
+        RecordingIndexFooter footer = {};
+        if (length >= dataOffset + sizeof(RecordingIndexHeader) + sizeof(footer)) {
+            file.seekg(static_cast<std::streamoff>(length - sizeof(footer)), std::ios::beg);
+            file.read(reinterpret_cast<char*>(&footer), sizeof(footer));
+        }
+        RecordingIndexHeader indexHeader = {};
+        const uint64_t expectedLength = footer.indexOffset + sizeof(indexHeader) +
+            static_cast<uint64_t>(footer.entryCount) * sizeof(RecordingIndexEntry) + sizeof(footer);
+        if (file.good() &&
+            memcmp(footer.magic, RECORDING_FOOTER_MAGIC, sizeof(footer.magic)) == 0 &&
+            footer.indexOffset >= dataOffset && expectedLength == length) {
+            file.seekg(static_cast<std::streamoff>(footer.indexOffset), std::ios::beg);
+            file.read(reinterpret_cast<char*>(&indexHeader), sizeof(indexHeader));
+            index.resize(footer.entryCount);
+            file.read(
+                reinterpret_cast<char*>(index.data()),
+                static_cast<std::streamsize>(index.size() * sizeof(RecordingIndexEntry)));
+            loaded = file.good() &&
+                memcmp(indexHeader.magic, RECORDING_INDEX_MAGIC, sizeof(indexHeader.magic)) == 0 &&
+                indexHeader.entryCount == footer.entryCount &&
+                indexHeader.entrySize == sizeof(RecordingIndexEntry);
+        }
+        if (!loaded) {
+            ALOGW("RecordingReader: no chunk index in %s, scanning chunks", filename.c_str());
+            file.clear();
+            loaded = scanChunks();
+        }
+    }
+
+    file.clear();
+    file.seekg(position, std::ios::beg);
+    indexLoaded = loaded;
+    if (!loaded) {
+        index.clear();
+    }
+    return loaded;
+}
+
+// Rehace el indice de un .vrmr sin pie: por cada chunk lee su cabecera, la del
+// timestamp (siempre la primera columna, sin codificar) y el primer y ultimo valor
+bool RecordingReader::scanChunks() {
+    index.clear();
+    uint64_t offset = dataOffset;
+    uint32_t firstFrame = 0;
+    for (;;) {
+        file.seekg(static_cast<std::streamoff>(offset), std::ios::beg);
+        RecordingChunkHeader chunk;
+        file.read(reinterpret_cast<char*>(&chunk), sizeof(chunk));
+        if (file.gcount() == static_cast<std::streamsize>(sizeof(chunk)) &&
+            memcmp(chunk.magic, RECORDING_SAMPLES_MAGIC, sizeof(chunk.magic)) == 0) {
+            offset += sizeof(chunk) + chunk.payloadSize; // muestras de pose, sin indice
+            continue;
+        }
+        if (file.gcount() < static_cast<std::streamsize>(sizeof(chunk)) ||
+            memcmp(chunk.magic, RECORDING_CHUNK_MAGIC, sizeof(chunk.magic)) != 0) {
+            // Fin, indice o un chunk a medio escribir: vale lo leido hasta aqui
+            return true;
+        }
+
+        RecordingColumnHeader column;
+        file.read(reinterpret_cast<char*>(&column), sizeof(column));
+        if (!file.good() || column.column != RECORDING_COLUMN_TIMESTAMP ||
+            column.encoding != RECORDING_ENCODING_RAW ||
+            column.size != chunk.frameCount * sizeof(double) || chunk.frameCount == 0) {
+            ALOGE("RecordingReader: chunk without timestamps in %s", filename.c_str());
+            return !index.empty();
+        }
+        RecordingIndexEntry entry;
+        entry.offset = offset;
+        entry.firstFrame = firstFrame;
+        entry.frameCount = chunk.frameCount;
+        const uint64_t timestamps = offset + sizeof(chunk) + sizeof(column);
+        file.read(reinterpret_cast<char*>(&entry.firstTimestamp), sizeof(double));
+        file.seekg(
+            static_cast<std::streamoff>(timestamps + (chunk.frameCount - 1) * sizeof(double)),
+            std::ios::beg);
+        file.read(reinterpret_cast<char*>(&entry.lastTimestamp), sizeof(double));
+        if (!file.good()) {
+            return true; // chunk truncado, lo anterior sigue valiendo
+        }
+
+        const uint64_t end = offset + sizeof(chunk) + chunk.payloadSize;
+        file.seekg(0, std::ios::end);
+        if (end > static_cast<uint64_t>(file.tellg())) {
+            return true;
+        }
+        index.push_back(entry);
+        offset = end;
+        firstFrame += chunk.frameCount;
+    }
+}
+
+// Un segmento no tiene chunks: cada bloque de SEGMENT_FRAMES_PER_READ registros es
+// una entrada, con el timestamp de su primer y ultimo registro
+bool RecordingReader::scanSegment() {
+    index.clear();
+    for (uint32_t first = 0; first < segmentFrameCount; first += SEGMENT_FRAMES_PER_READ) {
+        RecordingIndexEntry entry;
+        entry.offset = dataOffset + static_cast<uint64_t>(first) * sizeof(RecordingFrameRecord);
+        entry.firstFrame = first;
+        entry.frameCount = std::min(SEGMENT_FRAMES_PER_READ, segmentFrameCount - first);
+
+        const uint64_t last = entry.offset + (entry.frameCount - 1) * sizeof(RecordingFrameRecord);
+        static_assert(
+            offsetof(RecordingFrameRecord, timestamp) == 0,
+            "the timestamp is read from the start of the record");
+        file.seekg(static_cast<std::streamoff>(entry.offset), std::ios::beg);
+        file.read(reinterpret_cast<char*>(&entry.firstTimestamp), sizeof(double));
+        file.seekg(static_cast<std::streamoff>(last), std::ios::beg);
+        file.read(reinterpret_cast<char*>(&entry.lastTimestamp), sizeof(double));
+        if (!file.good()) {
+            ALOGE("RecordingReader: truncated segment %s", filename.c_str());
+            return false;
+        }
+        index.push_back(entry);
+    }
+    return true;
+}
+
+uint32_t RecordingReader::getFrameCount() const {
+    if (isSegment) {
+        return segmentFrameCount;
+    }
+    return index.empty() ? 0 : index.back().firstFrame + index.back().frameCount;
+}
+
+bool RecordingReader::seekFrame(uint32_t frame, uint32_t& chunkFirstFrame) {
+    if (!loadIndex()) {
+        return false;
+    }
+    // Ultimo chunk que empieza en o antes del frame
+    auto it = std::upper_bound(
+        index.begin(), index.end(), frame, [](uint32_t f, const RecordingIndexEntry& e) {
+            return f < e.firstFrame;
+        });
+    if (it == index.begin()) {
+        return false;
+    }
+    --it;
+    if (frame >= it->firstFrame + it->frameCount) {
+        return false;
+    }
+    return seekEntry(static_cast<size_t>(it - index.begin()), chunkFirstFrame);
+}
+
+bool RecordingReader::seekTime(double timestamp, uint32_t& chunkFirstFrame) {
+    if (!loadIndex()) {
+        return false;
+    }
+    // Primer chunk que termina en o despues del instante
+    auto it = std::lower_bound(
+        index.begin(), index.end(), timestamp, [](const RecordingIndexEntry& e, double t) {
+            return e.lastTimestamp < t;
+        });
+    if (it == index.end()) {
+        return false;
+    }
+    return seekEntry(static_cast<size_t>(it - index.begin()), chunkFirstFrame);
+}
+
+bool RecordingReader::seekEntry(size_t entry, uint32_t& chunkFirstFrame) {
+    const RecordingIndexEntry& e = index[entry];
+    file.clear();
+    file.seekg(static_cast<std::streamoff>(e.offset), std::ios::beg);
+    if (isSegment) {
+        segmentRemaining = segmentFrameCount - e.firstFrame;
+    }
+    chunkFirstFrame = e.firstFrame;
+    return file.good();
+}
+
+bool RecordingReader::readSegmentFrames(std::vector<FrameData>& frames) {
+    const uint32_t count = std::min(segmentRemaining, SEGMENT_FRAMES_PER_READ);
+    if (count == 0) {
+        return false;
+    }
+    chunkBuffer.resize(static_cast<size_t>(count) * sizeof(RecordingFrameRecord));
+    file.read(reinterpret_cast<char*>(chunkBuffer.data()), chunkBuffer.size());
+    if (!file.good()) {
+        ALOGE("RecordingReader: truncated segment %s", filename.c_str());
+        return false;
+    }
+    segmentRemaining -= count;
+
+    frames.resize(count);
+    for (uint32_t i = 0; i < count; i++) {
+        RecordingFrameRecord record;
+        memcpy(&record, chunkBuffer.data() + i * sizeof(record), sizeof(record));
+        MappedRecordingSink::unpackRecord(record, frames[i]);
+    }
+    return true;
+}
+
+bool RecordingReader::readChunk(std::vector<FrameData>& frames) {
+    return readNextChunk(frames, nullptr);
+}
+
+bool RecordingReader::readChunk(std::vector<FrameData>& frames, std::vector<HandFrameData>& hands) {
+    if (!readNextChunk(frames, &hands)) {
+        return false;
+    }
+    for (size_t i = 0; i < frames.size(); i++) {
+        hands[i].timestamp = frames[i].timestamp;
+    }
+    return true;
+}
+
+bool RecordingReader::readNextChunk(
+    std::vector<FrameData>& frames,
+    std::vector<HandFrameData>* hands) {
+    if (!file.is_open()) {
+        return false;
+    }
+    if (isSegment) {
+        if (!readSegmentFrames(frames)) {
+            return false;
+        }
+        if (hands != nullptr) {
+            hands->resize(frames.size());
+            for (HandFrameData& h : *hands) {
+                h.clear(0.0);
+            }
+        }
+        return true;
+    }
+
+    if (!skipSampleChunks()) {
+        return false;
+    }
+    RecordingChunkHeader chunk;
+    file.read(reinterpret_cast<char*>(&chunk), sizeof(chunk));
+    if (file.gcount() == 0) {
+        return false; // fin de fichero
+    }
+    if (file.good() && memcmp(chunk.magic, RECORDING_INDEX_MAGIC, sizeof(chunk.magic)) == 0) {
+        return false; // despues del ultimo chunk va el indice
+    }
+    if (!file.good() || memcmp(chunk.magic, RECORDING_CHUNK_MAGIC, sizeof(chunk.magic)) != 0 ||
+        chunk.payloadSize > MAX_CHUNK_PAYLOAD) {
+        ALOGE("RecordingReader: corrupt chunk in %s", filename.c_str());
+        return false;
+    }
+
+    chunkBuffer.resize(chunk.payloadSize);
+    file.read(reinterpret_cast<char*>(chunkBuffer.data()), chunk.payloadSize);
+    if (!file.good()) {
+        ALOGE("RecordingReader: truncated chunk in %s", filename.c_str());
+        return false;
+    }
+
+    // Valores por defecto para columnas ausentes: sin tracking y rotacion identidad
+    FrameData empty = {};
+    empty.headRotW = empty.leftRotW = empty.rightRotW = 1.0f;
+    frames.assign(chunk.frameCount, empty);
+    if (hands != nullptr) {
+        hands->resize(chunk.frameCount);
+        for (HandFrameData& h : *hands) {
+            h.clear(0.0);
+        }
+    }
+
+    size_t offset = 0;
+    for (uint32_t c = 0; c < chunk.columnCount; c++) {
+        RecordingColumnHeader column;
+        if (offset + sizeof(column) > chunkBuffer.size()) {
+            ALOGE("RecordingReader: column header out of bounds in %s", filename.c_str());
+            return false;
+        }
+        memcpy(&column, chunkBuffer.data() + offset, sizeof(column));
+        offset += sizeof(column);
+        if (offset + column.size > chunkBuffer.size()) {
+            ALOGE("RecordingReader: column data out of bounds in %s", filename.c_str());
+            return false;
+        }
+        if (!decodeColumn(column, chunkBuffer.data() + offset, frames, hands)) {
+            return false;
+        }
+        offset += column.size;
+    }
+
+    return true;
+}
+
+// Deja el fichero en la siguiente cabecera que no sea de muestras de pose
+bool RecordingReader::skipSampleChunks() {
+    for (;;) {
+        const std::streampos position = file.tellg();
+        RecordingSampleChunkHeader samples;
+        file.read(reinterpret_cast<char*>(&samples), sizeof(samples));
+        if (file.gcount() < static_cast<std::streamsize>(sizeof(samples)) ||
+            memcmp(samples.magic, RECORDING_SAMPLES_MAGIC, sizeof(samples.magic)) != 0) {
+            // Otra cosa (o el fin): se deja para quien la lea
+            file.clear();
+            file.seekg(position, std::ios::beg);
+            return file.good();
+        }
+        file.seekg(samples.payloadSize, std::ios::cur);
+    }
+}
+
+bool RecordingReader::readPoseSamples(std::vector<RecordingPoseSample>& samples) {
+    samples.clear();
+    if (!file.is_open()) {
+        return false;
+    }
+    if (isSegment) {
+        return true; // los .vrms no llevan muestras
+    }
+    file.clear();
+    const std::streampos position = file.tellg();
+    file.seekg(0, std::ios::end);
+    const uint64_t length = static_cast<uint64_t>(file.tellg());
+
+    // Mismo recorrido que scanChunks, leyendo solo los chunks SMPL
+    bool ok = true;
+    uint64_t offset = dataOffset;
+    while (offset + sizeof(RecordingChunkHeader) <= length) {
+        file.seekg(static_cast<std::streamoff>(offset), std::ios::beg);
+        RecordingChunkHeader chunk;
+        file.read(reinterpret_cast<char*>(&chunk), sizeof(chunk));
+        const uint64_t end = offset + sizeof(chunk) + chunk.payloadSize;
+        if (!file.good() || end > length) {
+            break; // parte sin cerrar: vale lo leido hasta aqui
+        }
+        if (memcmp(chunk.magic, RECORDING_SAMPLES_MAGIC, sizeof(chunk.magic)) == 0) {
+            RecordingSampleChunkHeader header;
+            memcpy(&header, &chunk, sizeof(header));
+            if (header.sampleSize != sizeof(RecordingPoseSample) ||
+                header.payloadSize !=
+                    static_cast<uint64_t>(header.sampleCount) * sizeof(RecordingPoseSample)) {
+                ALOGE("RecordingReader: corrupt pose sample chunk in %s", filename.c_str());
+                ok = false;
+                break;
+            }
+            const size_t first = samples.size();
+            samples.resize(first + header.sampleCount);
+            file.read(reinterpret_cast<char*>(samples.data() + first), header.payloadSize);
+        } else if (memcmp(chunk.magic, RECORDING_CHUNK_MAGIC, sizeof(chunk.magic)) != 0) {
+            break; // indice o basura al final
+        }
+        offset = end;
+    }
+
+    file.clear();
+    file.seekg(position, std::ios::beg);
+    return ok;
+}
+
+bool RecordingReader::decodeColumn(
+    const RecordingColumnHeader& column,
+    const uint8_t* data,
+    std::vector<FrameData>& frames,
+    std::vector<HandFrameData>* hands) {
+    if (column.column >= RECORDING_COLUMN_COUNT) {
+        return true; // columna de una version posterior, se salta
+    }
+    if (isHandColumn(column.column) && column.encoding == RECORDING_ENCODING_HAND_SOA) {
+        if (hands == nullptr) {
+            return true; // no se han pedido las manos
+        }
+        const int hand = column.column == RECORDING_COLUMN_LEFT_HAND ? 0 : 1;
+        if (!HandJointColumn::decode(data, column.size, frames.size(), hand, hands->data())) {
+            ALOGE("RecordingReader: corrupt hand column %u", column.column);
+            return false;
+        }
+        return true;
+    }
+    if (column.encoding == RECORDING_ENCODING_POSE_QUANTIZED && isPoseColumn(column.column)) {
+        return decodeQuantizedPose(column, data, frames);
+    }
+    if (column.encoding != RECORDING_ENCODING_RAW) {
+        ALOGW(
+            "RecordingReader: unknown encoding %u for column %u, skipped",
+            column.encoding,
+            column.column);
+        return true;
+    }
+
+    const RecordingFieldDesc& desc = RECORDING_SCHEMA[column.column];
+    const size_t count = frames.size();
+    if (column.size != count * desc.components * RecordingValueSize(desc.type)) {
+        ALOGE("RecordingReader: column %u has the wrong size", column.column);
+        return false;
+    }
+
+    switch (column.column) {
+        case RECORDING_COLUMN_TIMESTAMP:
+            for (size_t i = 0; i < count; i++) {
+                frames[i].timestamp = readValue<double>(data, i);
+            }
+            break;
+        case RECORDING_COLUMN_HEAD_POSE:
+        case RECORDING_COLUMN_LEFT_POSE:
+        case RECORDING_COLUMN_RIGHT_POSE:
+            for (size_t i = 0; i < count; i++) {
+                float p[7];
+                readPose(data, i, p);
+                setPose(frames[i], static_cast<RecordingColumn>(column.column), p);
+            }
+            break;
+        case RECORDING_COLUMN_TRIGGERS:
+            for (size_t i = 0; i < count; i++) {
+                frames[i].leftTriggerValue = readValue<float>(data, i * 2 + 0);
+                frames[i].rightTriggerValue = readValue<float>(data, i * 2 + 1);
+            }
+            break;
+        case RECORDING_COLUMN_TRACKED:
+            for (size_t i = 0; i < count; i++) {
+                const uint8_t tracked = data[i];
+                frames[i].leftControllerTracked = (tracked & RECORDING_TRACKED_LEFT) != 0;
+                frames[i].rightControllerTracked = (tracked & RECORDING_TRACKED_RIGHT) != 0;
+            }
+            break;
+        case RECORDING_COLUMN_BUTTONS:
+            for (size_t i = 0; i < count; i++) {
+                frames[i].allButtons = readValue<uint32_t>(data, i * 2 + 0);
+                frames[i].lastFrameAllButtons = readValue<uint32_t>(data, i * 2 + 1);
+            }
+            break;
+        default:
+            break;
+    }
+    return true;
+}
+
+bool RecordingReader::decodeQuantizedPose(
+    const RecordingColumnHeader& column,
+    const uint8_t* data,
+    std::vector<FrameData>& frames) {
+    const size_t count = frames.size();
+    poseScratch.resize(count * PoseCodec::FLOATS_PER_POSE);
+    if (!PoseCodec::decode(data, column.size, count, poseScratch.data(), nullptr)) {
+        ALOGE("RecordingReader: corrupt quantized pose column %u", column.column);
+        return false;
+    }
+    // Los frames sin tracking salen con la pose identidad, igual que al grabar
+    for (size_t i = 0; i < count; i++) {
+        setPose(
+            frames[i],
+            static_cast<RecordingColumn>(column.column),
+            poseScratch.data() + i * PoseCodec::FLOATS_PER_POSE);
+    }
+    return true;
+}
+
+bool RecordingReader::exportCsv(
+    const std::string& recordingFilename,
+    const std::string& csvFilename) {
+    RecordingReader reader;
+    if (!reader.open(recordingFilename)) {
+        return false;
+    }
+
+    std::ofstream csv(csvFilename);
+    if (!csv.is_open()) {
+        ALOGE("RecordingReader: could not open %s for writing", csvFilename.c_str());
+        return false;
+    }
+
+    // Misma cabecera que los CSV que escribia el grabador en el dispositivo
+    csv << "timestamp,head_pos_x,head_pos_y,head_pos_z,"
+        << "head_rot_x,head_rot_y,head_rot_z,head_rot_w,"
+        << "left_tracked,left_pos_x,left_pos_y,left_pos_z,"
+        << "left_rot_x,left_rot_y,left_rot_z,left_rot_w,left_trigger,"
+        << "right_tracked,right_pos_x,right_pos_y,right_pos_z,"
+        << "right_rot_x,right_rot_y,right_rot_z,right_rot_w,right_trigger,"
+        << "button_a\n";
+
+    std::vector<FrameData> frames;
+    size_t total = 0;
+    while (reader.readChunk(frames)) {
+        for (const auto& frame : frames) {
+            csv << frame.toCSV() << "\n";
+        }
+        total += frames.size();
+    }
+
+    ALOG("Exported %zu frames from %s to %s", total, recordingFilename.c_str(), csvFilename.c_str());
+    return csv.good();
+}
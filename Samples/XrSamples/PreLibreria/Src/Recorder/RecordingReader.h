@@ -0,0 +1,96 @@
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "Recorder/FrameData.h"
+#include "Recorder/HandData.h"
+#include "Recorder/RecordingFormat.h"
+
+// Lee ficheros .vrmr chunk a chunk. Las columnas desconocidas (de versiones
+// posteriores con el mismo numero de version mayor) se saltan usando su tamano.
+// Tambien lee segmentos mapeados .vrms, devolviendo sus frames en bloques.
+// Con el indice de chunks se puede saltar a un frame o instante sin leer lo anterior.
+// Los chunks de muestras de pose se saltan al leer frames y se leen aparte.
+class RecordingReader {
+public:
+    RecordingReader() = default;
+    ~RecordingReader();
+
+    RecordingReader(const RecordingReader&) = delete;
+    RecordingReader& operator=(const RecordingReader&) = delete;
+
+    // Valida cabecera y esquema. Devuelve false si el fichero no es una grabacion valida
+    bool open(const std::string& filename);
+    void close();
+
+    // Sustituye el contenido de frames por el siguiente chunk.
+    // Devuelve false al llegar al final o si el chunk esta corrupto.
+    bool readChunk(std::vector<FrameData>& frames);
+
+    // Igual, y ademas las manos de cada frame. Si el chunk no tiene columnas de
+    // manos (o es un segmento .vrms) salen todas sin tracking.
+    bool readChunk(std::vector<FrameData>& frames, std::vector<HandFrameData>& hands);
+
+    // Carga el indice de chunks del pie del fichero. Si no lo tiene (version 1 o parte
+    // sin cerrar) lo rehace leyendo solo las cabeceras y los timestamps de cada chunk.
+    // En un segmento .vrms cada bloque de readChunk cuenta como un chunk.
+    bool loadIndex();
+    const std::vector<RecordingIndexEntry>& getIndex() const { return index; }
+    uint32_t getFrameCount() const; // con el indice cargado
+
+    // Posiciona el lector para que el siguiente readChunk devuelva el chunk que
+    // contiene el frame (numero dentro de la parte). chunkFirstFrame recibe el numero
+    // del primer frame que devolvera. Busqueda binaria sobre el indice, carga el
+    // indice si hace falta. Devuelve false si el frame no esta en la parte.
+    bool seekFrame(uint32_t frame, uint32_t& chunkFirstFrame);
+
+    // Igual, con el chunk del primer frame con timestamp >= timestamp
+    bool seekTime(double timestamp, uint32_t& chunkFirstFrame);
+
+    // Todas las muestras de pose de la parte (chunks SMPL), en el orden en que se
+    // grabaron. No mueve la posicion de readChunk. Una parte sin muestras o un
+    // segmento .vrms devuelven la lista vacia.
+    bool readPoseSamples(std::vector<RecordingPoseSample>& samples);
+
+    bool isOpen() const { return file.is_open(); }
+    const RecordingFileHeader& getHeader() const { return header; }
+    const std::vector<RecordingFieldDesc>& getSchema() const { return schema; }
+
+    // Conversion offline de una grabacion a CSV con las mismas columnas que
+    // escribia antes el grabador
+    static bool exportCsv(const std::string& recordingFilename, const std::string& csvFilename);
+
+private:
+    bool openSegment();
+    bool scanChunks();
+    bool scanSegment();
+    bool skipSampleChunks();
+    bool seekEntry(size_t entry, uint32_t& chunkFirstFrame);
+    bool readSegmentFrames(std::vector<FrameData>& frames);
+    bool readNextChunk(std::vector<FrameData>& frames, std::vector<HandFrameData>* hands);
+    bool decodeColumn(
+        const RecordingColumnHeader& column,
+        const uint8_t* data,
+        std::vector<FrameData>& frames,
+        std::vector<HandFrameData>* hands);
+    bool decodeQuantizedPose(
+        const RecordingColumnHeader& column,
+        const uint8_t* data,
+        std::vector<FrameData>& frames);
+
+    std::ifstream file;
+    std::string filename;
+    RecordingFileHeader header = {};
+    std::vector<RecordingFieldDesc> schema;
+    std::vector<uint8_t> chunkBuffer;
+    std::vector<float> poseScratch;
+    std::vector<RecordingIndexEntry> index;
+    bool indexLoaded = false;
+    uint64_t dataOffset = 0; // primer chunk o primer registro
+    bool isSegment = false;
+    uint32_t segmentFrameCount = 0;
+    uint32_t segmentRemaining = 0;
+};
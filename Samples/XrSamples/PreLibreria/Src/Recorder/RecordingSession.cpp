@@ -0,0 +1,223 @@
+#include "Recorder/RecordingSession.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+#include "Misc/Log.h"
+
+namespace {
+
+// Limite de cordura para no reservar memoria a ciegas con un manifiesto corrupto
+const uint32_t MAX_MANIFEST_PARTS = 1u << 20;
+
+std::string directoryOf(const std::string& filename) {
+    const size_t slash = filename.find_last_of("/\\");
+    return slash == std::string::npos ? std::string() : filename.substr(0, slash + 1);
+}
+
+std::string baseNameOf(const std::string& filename) {
+    const size_t slash = filename.find_last_of("/\\");
+    return slash == std::string::npos ? filename : filename.substr(slash + 1);
+}
+
+} // namespace
+
+std::string RecordingSession::manifestFilenameFor(const std::string& baseFilename) {
+    return baseFilename + ".vrmx";
+}
+
+bool RecordingSession::writeManifest(
+    const std::string& manifestFilename,
+    int64_t sessionStartUnixMs,
+    const std::vector<RecordingManifestEntry>& parts) {
+    const std::string temporary = manifestFilename + ".tmp";
+    {
+        std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+        if (!file.is_open()) {
+            ALOGE("RecordingSession: could not open %s for writing", temporary.c_str());
+            return false;
+        }
+
+        RecordingManifestHeader header = {};
+        memcpy(header.magic, RECORDING_MANIFEST_MAGIC, sizeof(header.magic));
+        header.version = RECORDING_FORMAT_VERSION;
+        header.headerSize = sizeof(RecordingManifestHeader);
+        header.partCount = static_cast<uint32_t>(parts.size());
+        header.entrySize = sizeof(RecordingManifestEntry);
+        header.sessionStartUnixMs = sessionStartUnixMs;
+
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(
+            reinterpret_cast<const char*>(parts.data()),
+            static_cast<std::streamsize>(parts.size() * sizeof(RecordingManifestEntry)));
+        if (!file.good()) {
+            ALOGE("RecordingSession: write failed on %s", temporary.c_str());
+            return false;
+        }
+    }
+    // El manifiesto anterior sigue valiendo hasta que el nuevo esta completo
+    if (std::rename(temporary.c_str(), manifestFilename.c_str()) != 0) {
+        std::remove(manifestFilename.c_str());
+        if (std::rename(temporary.c_str(), manifestFilename.c_str()) != 0) {
+            ALOGE("RecordingSession: could not replace %s", manifestFilename.c_str());
+            return false;
+        }
+    }
+    return true;
+}
+
+bool RecordingSession::buildManifest(
+    const std::string& manifestFilename,
+    const std::vector<std::string>& partFilenames) {
+    std::vector<RecordingManifestEntry> parts;
+    int64_t sessionStartUnixMs = 0;
+    uint64_t firstFrame = 0;
+    for (const std::string& partFilename : partFilenames) {
+        RecordingReader reader;
+        if (!reader.open(partFilename) || !reader.loadIndex()) {
+            return false;
+        }
+        const std::vector<RecordingIndexEntry>& index = reader.getIndex();
+        const std::string name = baseNameOf(partFilename);
+        if (name.size() >= sizeof(RecordingManifestEntry::filename)) {
+            ALOGE("RecordingSession: part name too long: %s", name.c_str());
+            return false;
+        }
+
+        RecordingManifestEntry entry = {};
+        entry.partIndex = reader.getHeader().partIndex;
+        entry.frameCount = reader.getFrameCount();
+        entry.firstFrame = firstFrame;
+        entry.firstTimestamp = index.empty() ? 0.0 : index.front().firstTimestamp;
+        entry.lastTimestamp = index.empty() ? 0.0 : index.back().lastTimestamp;
+        memcpy(entry.filename, name.c_str(), name.size() + 1);
+        parts.push_back(entry);
+
+        if (parts.size() == 1) {
+            sessionStartUnixMs = reader.getHeader().sessionStartUnixMs;
+        }
+        firstFrame += entry.frameCount;
+    }
+    return writeManifest(manifestFilename, sessionStartUnixMs, parts);
+}
+
+bool RecordingSession::open(const std::string& manifestFilename) {
+    close();
+
+    std::ifstream file(manifestFilename, std::ios::binary);
+    if (!file.is_open()) {
+        ALOGE("RecordingSession: could not open %s", manifestFilename.c_str());
+        return false;
+    }
+    RecordingManifestHeader header;
+    file.read(reinterpret_cast<char*>(&header), sizeof(header));
+    if (!file.good() || memcmp(header.magic, RECORDING_MANIFEST_MAGIC, sizeof(header.magic)) != 0 ||
+        header.version > RECORDING_FORMAT_VERSION || header.headerSize < sizeof(header) ||
+        header.entrySize != sizeof(RecordingManifestEntry) || header.partCount > MAX_MANIFEST_PARTS) {
+        ALOGE("RecordingSession: %s is not a session manifest", manifestFilename.c_str());
+        return false;
+    }
+    file.seekg(header.headerSize, std::ios::beg);
+    parts.resize(header.partCount);
+    file.read(
+        reinterpret_cast<char*>(parts.data()),
+        static_cast<std::streamsize>(parts.size() * sizeof(RecordingManifestEntry)));
+    if (!file.good()) {
+        ALOGE("RecordingSession: truncated manifest %s", manifestFilename.c_str());
+        parts.clear();
+        return false;
+    }
+    for (RecordingManifestEntry& part : parts) {
+        part.filename[sizeof(part.filename) - 1] = '\0';
+    }
+
+    directory = directoryOf(manifestFilename);
+    sessionStartUnixMs = header.sessionStartUnixMs;
+    return true;
+}
+
+void RecordingSession::close() {
+    reader.close();
+    parts.clear();
+    directory.clear();
+    sessionStartUnixMs = 0;
+    currentPart = 0;
+    partOpen = false;
+}
+
+uint64_t RecordingSession::getFrameCount() const {
+    return parts.empty() ? 0 : parts.back().firstFrame + parts.back().frameCount;
+}
+
+double RecordingSession::getDuration() const {
+    return parts.empty() ? 0.0 : parts.back().lastTimestamp - parts.front().firstTimestamp;
+}
+
+bool RecordingSession::openPart(size_t part) {
+    if (partOpen && currentPart == part) {
+        return true;
+    }
+    partOpen = false;
+    currentPart = part;
+    if (!reader.open(directory + parts[part].filename)) {
+        return false;
+    }
+    partOpen = true;
+    return true;
+}
+
+bool RecordingSession::seekFrame(uint64_t frame, uint64_t& chunkFirstFrame) {
+    // Ultima parte que empieza en o antes del frame
+    auto it = std::upper_bound(
+        parts.begin(), parts.end(), frame, [](uint64_t f, const RecordingManifestEntry& p) {
+            return f < p.firstFrame;
+        });
+    if (it == parts.begin()) {
+        return false;
+    }
+    --it;
+    if (frame >= it->firstFrame + it->frameCount ||
+        !openPart(static_cast<size_t>(it - parts.begin()))) {
+        return false;
+    }
+    uint32_t partFrame = 0;
+    if (!reader.seekFrame(static_cast<uint32_t>(frame - it->firstFrame), partFrame)) {
+        return false;
+    }
+    chunkFirstFrame = it->firstFrame + partFrame;
+    return true;
+}
+
+bool RecordingSession::seekTime(double timestamp, uint64_t& chunkFirstFrame) {
+    // Primera parte que termina en o despues del instante
+    auto it = std::lower_bound(
+        parts.begin(), parts.end(), timestamp, [](const RecordingManifestEntry& p, double t) {
+            return p.lastTimestamp < t;
+        });
+    if (it == parts.end() || !openPart(static_cast<size_t>(it - parts.begin()))) {
+        return false;
+    }
+    uint32_t partFrame = 0;
+    if (!reader.seekTime(timestamp, partFrame)) {
+        return false;
+    }
+    chunkFirstFrame = it->firstFrame + partFrame;
+    return true;
+}
+
+bool RecordingSession::readChunk(std::vector<FrameData>& frames) {
+    if (parts.empty()) {
+        return false;
+    }
+    if (!partOpen && !openPart(currentPart)) {
+        return false;
+    }
+    while (!reader.readChunk(frames)) {
+        if (currentPart + 1 >= parts.size() || !openPart(currentPart + 1)) {
+            return false;
+        }
+    }
+    return true;
+}
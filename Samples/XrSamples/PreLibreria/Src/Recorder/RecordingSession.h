@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "Recorder/FrameData.h"
+#include "Recorder/RecordingFormat.h"
+#include "Recorder/RecordingReader.h"
+
+// Una sesion completa a traves de su manifiesto .vrmx (ver RecordingFormat.h).
+// Buscar un frame o instante es una busqueda binaria sobre las partes y otra sobre
+// el indice de la parte elegida: solo se abre esa parte y solo se decodifica su chunk.
+// readChunk sigue en la parte siguiente al acabar la actual.
+class RecordingSession {
+public:
+    RecordingSession() = default;
+
+    RecordingSession(const RecordingSession&) = delete;
+    RecordingSession& operator=(const RecordingSession&) = delete;
+
+    // Lee el manifiesto. Las partes se abren al buscar o leer.
+    bool open(const std::string& manifestFilename);
+    void close();
+
+    // Coloca la sesion para que el siguiente readChunk devuelva el chunk que contiene
+    // el frame (numero dentro de la sesion) o el primer frame con timestamp >= timestamp.
+    // chunkFirstFrame recibe el numero de sesion del primer frame que devolvera.
+    bool seekFrame(uint64_t frame, uint64_t& chunkFirstFrame);
+    bool seekTime(double timestamp, uint64_t& chunkFirstFrame);
+
+    // Siguiente chunk de la sesion. Devuelve false al acabar la ultima parte.
+    bool readChunk(std::vector<FrameData>& frames);
+
+    const std::vector<RecordingManifestEntry>& getParts() const { return parts; }
+    int64_t getSessionStartUnixMs() const { return sessionStartUnixMs; }
+    uint64_t getFrameCount() const;
+    double getDuration() const;
+
+    // Escribe el manifiesto de forma atomica (fichero temporal + rename)
+    static bool writeManifest(
+        const std::string& manifestFilename,
+        int64_t sessionStartUnixMs,
+        const std::vector<RecordingManifestEntry>& parts);
+
+    // Rehace el manifiesto de unas partes ya grabadas, en el orden dado, leyendo solo
+    // sus indices. Para sesiones de antes del manifiesto o que no se cerraron.
+    static bool buildManifest(
+        const std::string& manifestFilename,
+        const std::vector<std::string>& partFilenames);
+
+    // Nombre del manifiesto de una sesion a partir del nombre base de sus partes
+    static std::string manifestFilenameFor(const std::string& baseFilename);
+
+private:
+    bool openPart(size_t part);
+
+    std::string directory; // de las partes, el del manifiesto
+    std::vector<RecordingManifestEntry> parts;
+    int64_t sessionStartUnixMs = 0;
+    RecordingReader reader;
+    size_t currentPart = 0;
+    bool partOpen = false;
+};
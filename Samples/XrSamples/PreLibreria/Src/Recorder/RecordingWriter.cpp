@@ -0,0 +1,338 @@
+#include "Recorder/RecordingWriter.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "Misc/Log.h"
+
+#include "Recorder/HandJointColumn.h"
+
+namespace {
+
+// Cursor sobre el buffer del chunk, ya dimensionado con chunkSize()
+struct ChunkCursor {
+    uint8_t* ptr;
+
+    template <typename T>
+    void put(const T& value) {
+        memcpy(ptr, &value, sizeof(T));
+        ptr += sizeof(T);
+    }
+
+    void beginColumn(RecordingColumn column, size_t frameCount) {
+        const RecordingFieldDesc& desc = RECORDING_SCHEMA[column];
+        RecordingColumnHeader header;
+        header.column = column;
+        header.encoding = RECORDING_ENCODING_RAW;
+        header.size = static_cast<uint32_t>(
+            frameCount * desc.components * RecordingValueSize(desc.type));
+        put(header);
+    }
+};
+
+bool isHandColumn(uint16_t column) {
+    return column == RECORDING_COLUMN_LEFT_HAND || column == RECORDING_COLUMN_RIGHT_HAND;
+}
+
+int poseColumnSlot(RecordingColumn column) {
+    switch (column) {
+        case RECORDING_COLUMN_HEAD_POSE:
+            return 0;
+        case RECORDING_COLUMN_LEFT_POSE:
+            return 1;
+        case RECORDING_COLUMN_RIGHT_POSE:
+            return 2;
+        default:
+            return -1;
+    }
+}
+
+void getPose(const FrameData& f, RecordingColumn column, float* pose) {
+    switch (column) {
+        case RECORDING_COLUMN_HEAD_POSE: {
+            const float p[7] = {
+                f.headPosX, f.headPosY, f.headPosZ, f.headRotX, f.headRotY, f.headRotZ, f.headRotW};
+            memcpy(pose, p, sizeof(p));
+            break;
+        }
+        case RECORDING_COLUMN_LEFT_POSE: {
+            const float p[7] = {
+                f.leftPosX, f.leftPosY, f.leftPosZ, f.leftRotX, f.leftRotY, f.leftRotZ, f.leftRotW};
+            memcpy(pose, p, sizeof(p));
+            break;
+        }
+        case RECORDING_COLUMN_RIGHT_POSE:
+        default: {
+            const float p[7] = {
+                f.rightPosX,
+                f.rightPosY,
+                f.rightPosZ,
+                f.rightRotX,
+                f.rightRotY,
+                f.rightRotZ,
+                f.rightRotW};
+            memcpy(pose, p, sizeof(p));
+            break;
+        }
+    }
+}
+
+} // namespace
+
+RecordingWriter::~RecordingWriter() {
+    close();
+}
+
+size_t RecordingWriter::chunkSize(size_t frameCount, bool withHands) {
+    size_t size = sizeof(RecordingChunkHeader);
+    for (const RecordingFieldDesc& desc : RECORDING_SCHEMA) {
+        if (isHandColumn(desc.column)) {
+            if (withHands) {
+                size += sizeof(RecordingColumnHeader) + HandJointColumn::maxEncodedSize(frameCount);
+            }
+            continue;
+        }
+        size_t columnSize = frameCount * desc.components * RecordingValueSize(desc.type);
+        if (poseColumnSlot(static_cast<RecordingColumn>(desc.column)) >= 0) {
+            columnSize = std::max(columnSize, PoseCodec::maxEncodedSize(frameCount));
+        }
+        size += sizeof(RecordingColumnHeader) + columnSize;
+    }
+    return size;
+}
+
+void RecordingWriter::setPoseCodec(RecordingColumn column, const PoseCodecConfig& config) {
+    const int slot = poseColumnSlot(column);
+    if (slot < 0) {
+        ALOGW("RecordingWriter: column %u is not a pose column", column);
+        return;
+    }
+    poseCodecs[slot] = config;
+}
+
+uint8_t* RecordingWriter::putPoseColumn(
+    uint8_t* out,
+    RecordingColumn column,
+    const FrameData* frames,
+    size_t count) {
+    const PoseCodecConfig& codec = poseCodecs[poseColumnSlot(column)];
+    ChunkCursor cursor = {out};
+
+    if (!codec.enabled) {
+        cursor.beginColumn(column, count);
+        for (size_t i = 0; i < count; i++) {
+            float pose[PoseCodec::FLOATS_PER_POSE];
+            getPose(frames[i], column, pose);
+            cursor.put(pose);
+        }
+        return cursor.ptr;
+    }
+
+    poseScratch.resize(count * PoseCodec::FLOATS_PER_POSE);
+    presentScratch.resize(count);
+    for (size_t i = 0; i < count; i++) {
+        getPose(frames[i], column, poseScratch.data() + i * PoseCodec::FLOATS_PER_POSE);
+        // Un mando sin tracking no guarda pose, la cabeza siempre
+        bool present = true;
+        if (column == RECORDING_COLUMN_LEFT_POSE) {
+            present = frames[i].leftControllerTracked;
+        } else if (column == RECORDING_COLUMN_RIGHT_POSE) {
+            present = frames[i].rightControllerTracked;
+        }
+        presentScratch[i] = present ? 1 : 0;
+    }
+
+    uint8_t* data = out + sizeof(RecordingColumnHeader);
+    const size_t size =
+        PoseCodec::encode(codec, poseScratch.data(), presentScratch.data(), count, data);
+
+    RecordingColumnHeader header;
+    header.column = column;
+    header.encoding = RECORDING_ENCODING_POSE_QUANTIZED;
+    header.size = static_cast<uint32_t>(size);
+    memcpy(out, &header, sizeof(header));
+    return data + size;
+}
+
+bool RecordingWriter::open(
+    const std::string& name,
+    uint32_t partIndex,
+    int64_t sessionStartUnixMs) {
+    close();
+
+    file.open(name, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        ALOGE("RecordingWriter: could not open %s for writing", name.c_str());
+        return false;
+    }
+    filename = name;
+    bytesWritten = 0;
+    chunkCount = 0;
+    frameCount = 0;
+    poseSampleCount = 0;
+    index.clear();
+
+    RecordingFileHeader header = {};
+    memcpy(header.magic, RECORDING_FILE_MAGIC, sizeof(header.magic));
+    header.version = RECORDING_FORMAT_VERSION;
+    header.headerSize = sizeof(RecordingFileHeader);
+    header.fieldCount = RECORDING_COLUMN_COUNT;
+    header.partIndex = partIndex;
+    header.sessionStartUnixMs = sessionStartUnixMs;
+
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(RECORDING_SCHEMA), sizeof(RECORDING_SCHEMA));
+    bytesWritten += sizeof(header) + sizeof(RECORDING_SCHEMA);
+
+    return file.good();
+}
+
+bool RecordingWriter::writeChunk(const FrameData* frames, size_t count) {
+    return writeChunk(frames, nullptr, count);
+}
+
+bool RecordingWriter::writeChunk(
+    const FrameData* frames,
+    const HandFrameData* hands,
+    size_t count) {
+    if (!file.is_open() || count == 0) {
+        return false;
+    }
+
+    // resize no libera capacidad, tras el primer chunk ya no hay reservas
+    chunkBuffer.resize(chunkSize(count, hands != nullptr));
+    ChunkCursor cursor = {chunkBuffer.data() + sizeof(RecordingChunkHeader)};
+
+    cursor.beginColumn(RECORDING_COLUMN_TIMESTAMP, count);
+    for (size_t i = 0; i < count; i++) {
+        cursor.put(frames[i].timestamp);
+    }
+
+    cursor.ptr = putPoseColumn(cursor.ptr, RECORDING_COLUMN_HEAD_POSE, frames, count);
+    cursor.ptr = putPoseColumn(cursor.ptr, RECORDING_COLUMN_LEFT_POSE, frames, count);
+    cursor.ptr = putPoseColumn(cursor.ptr, RECORDING_COLUMN_RIGHT_POSE, frames, count);
+
+    cursor.beginColumn(RECORDING_COLUMN_TRIGGERS, count);
+    for (size_t i = 0; i < count; i++) {
+        const float triggers[2] = {frames[i].leftTriggerValue, frames[i].rightTriggerValue};
+        cursor.put(triggers);
+    }
+
+    cursor.beginColumn(RECORDING_COLUMN_TRACKED, count);
+    for (size_t i = 0; i < count; i++) {
+        uint8_t tracked = 0;
+        if (frames[i].leftControllerTracked) {
+            tracked |= RECORDING_TRACKED_LEFT;
+        }
+        if (frames[i].rightControllerTracked) {
+            tracked |= RECORDING_TRACKED_RIGHT;
+        }
+        cursor.put(tracked);
+    }
+
+    cursor.beginColumn(RECORDING_COLUMN_BUTTONS, count);
+    for (size_t i = 0; i < count; i++) {
+        const uint32_t buttons[2] = {frames[i].allButtons, frames[i].lastFrameAllButtons};
+        cursor.put(buttons);
+    }
+
+    uint32_t columnCount = RECORDING_COLUMN_BUTTONS + 1;
+    if (hands != nullptr) {
+        for (int hand = 0; hand < 2; hand++) {
+            RecordingColumnHeader column;
+            column.column = hand == 0 ? RECORDING_COLUMN_LEFT_HAND : RECORDING_COLUMN_RIGHT_HAND;
+            column.encoding = RECORDING_ENCODING_HAND_SOA;
+            const size_t size = HandJointColumn::encode(
+                hands, count, hand, cursor.ptr + sizeof(RecordingColumnHeader));
+            column.size = static_cast<uint32_t>(size);
+            cursor.put(column);
+            cursor.ptr += size;
+        }
+        columnCount += 2;
+    }
+
+    // Con poses cuantizadas o manos el tamano solo se sabe al final
+    const size_t size = static_cast<size_t>(cursor.ptr - chunkBuffer.data());
+    RecordingChunkHeader header;
+    memcpy(header.magic, RECORDING_CHUNK_MAGIC, sizeof(header.magic));
+    header.frameCount = static_cast<uint32_t>(count);
+    header.columnCount = columnCount;
+    header.payloadSize = static_cast<uint32_t>(size - sizeof(RecordingChunkHeader));
+    memcpy(chunkBuffer.data(), &header, sizeof(header));
+
+    file.write(reinterpret_cast<const char*>(chunkBuffer.data()), size);
+    if (!file.good()) {
+        ALOGE("RecordingWriter: write failed on %s", filename.c_str());
+        return false;
+    }
+
+    RecordingIndexEntry entry;
+    entry.offset = bytesWritten;
+    entry.firstFrame = frameCount;
+    entry.frameCount = static_cast<uint32_t>(count);
+    entry.firstTimestamp = frames[0].timestamp;
+    entry.lastTimestamp = frames[count - 1].timestamp;
+    index.push_back(entry);
+
+    bytesWritten += size;
+    chunkCount++;
+    frameCount += static_cast<uint32_t>(count);
+    return true;
+}
+
+bool RecordingWriter::writePoseSamples(const RecordingPoseSample* samples, size_t count) {
+    if (!file.is_open() || count == 0) {
+        return false;
+    }
+
+    // Las muestras ya estan en formato de fichero: cabecera y un solo write
+    RecordingSampleChunkHeader header;
+    memcpy(header.magic, RECORDING_SAMPLES_MAGIC, sizeof(header.magic));
+    header.sampleCount = static_cast<uint32_t>(count);
+    header.sampleSize = sizeof(RecordingPoseSample);
+    header.payloadSize = static_cast<uint32_t>(count * sizeof(RecordingPoseSample));
+
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(samples), header.payloadSize);
+    if (!file.good()) {
+        ALOGE("RecordingWriter: write failed on %s", filename.c_str());
+        return false;
+    }
+    bytesWritten += sizeof(header) + header.payloadSize;
+    poseSampleCount += count;
+    return true;
+}
+
+void RecordingWriter::flush() {
+    if (file.is_open()) {
+        file.flush();
+    }
+}
+
+void RecordingWriter::close() {
+    if (!file.is_open()) {
+        return;
+    }
+
+    RecordingIndexHeader header;
+    memcpy(header.magic, RECORDING_INDEX_MAGIC, sizeof(header.magic));
+    header.entryCount = static_cast<uint32_t>(index.size());
+    header.frameCount = frameCount;
+    header.entrySize = sizeof(RecordingIndexEntry);
+
+    RecordingIndexFooter footer;
+    footer.indexOffset = bytesWritten;
+    footer.entryCount = header.entryCount;
+    memcpy(footer.magic, RECORDING_FOOTER_MAGIC, sizeof(footer.magic));
+
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(
+        reinterpret_cast<const char*>(index.data()),
+        static_cast<std::streamsize>(index.size() * sizeof(RecordingIndexEntry)));
+    file.write(reinterpret_cast<const char*>(&footer), sizeof(footer));
+    if (!file.good()) {
+        ALOGE("RecordingWriter: could not write the index of %s", filename.c_str());
+    }
+    bytesWritten += sizeof(header) + index.size() * sizeof(RecordingIndexEntry) + sizeof(footer);
+    file.close();
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "Recorder/FrameData.h"
+#include "Recorder/HandData.h"
+#include "Recorder/PoseCodec.h"
+#include "Recorder/RecordingFormat.h"
+
+// Escribe un fichero .vrmr: cabecera + esquema al abrir y un chunk columnar por
+// cada llamada a writeChunk. No formatea texto ni reserva memoria por frame, el
+// buffer del chunk se reutiliza entre llamadas. Las columnas de pose se pueden
+// guardar cuantizadas (PoseCodec) en vez de en float, cada una por separado.
+// Al cerrar escribe el indice de chunks (RecordingIndexEntry) para poder buscar.
+// Las muestras de pose van en sus propios chunks, entre los de frames.
+class RecordingWriter {
+public:
+    RecordingWriter() = default;
+    ~RecordingWriter();
+
+    RecordingWriter(const RecordingWriter&) = delete;
+    RecordingWriter& operator=(const RecordingWriter&) = delete;
+
+    // Crea (o trunca) el fichero y escribe cabecera y esquema
+    bool open(const std::string& filename, uint32_t partIndex, int64_t sessionStartUnixMs);
+
+    // Codificacion de una columna de pose (cabeza, izquierdo o derecho) para los
+    // chunks siguientes. Por defecto se guardan en float sin comprimir.
+    void setPoseCodec(RecordingColumn column, const PoseCodecConfig& config);
+
+    // Escribe los frames como un unico chunk. Devuelve false si falla la escritura
+    bool writeChunk(const FrameData* frames, size_t count);
+
+    // Igual, con las manos de cada frame (hands[i] corresponde a frames[i]) en dos
+    // columnas mas. hands = nullptr no escribe columnas de manos.
+    bool writeChunk(const FrameData* frames, const HandFrameData* hands, size_t count);
+
+    // Escribe las muestras de pose como un chunk SMPL. No cuentan como frames ni
+    // entran en el indice.
+    bool writePoseSamples(const RecordingPoseSample* samples, size_t count);
+
+    // Fuerza lo escrito hasta ahora al sistema de ficheros
+    void flush();
+
+    // Escribe el indice y el pie y cierra el fichero
+    void close();
+
+    bool isOpen() const { return file.is_open(); }
+    const std::string& getFilename() const { return filename; }
+    uint64_t getBytesWritten() const { return bytesWritten; }
+    uint32_t getChunkCount() const { return chunkCount; }
+    uint32_t getFrameCount() const { return frameCount; }
+    uint64_t getPoseSampleCount() const { return poseSampleCount; }
+    // Entradas de los chunks escritos, las que ira al indice al cerrar
+    const std::vector<RecordingIndexEntry>& getIndex() const { return index; }
+
+    // Tamano en disco de un chunk de frameCount frames sin comprimir. Con poses
+    // cuantizadas o con manos es una cota superior.
+    static size_t chunkSize(size_t frameCount, bool withHands = false);
+
+private:
+    static const int POSE_COLUMN_COUNT = 3;
+
+    // Escribe cabecera y datos de una columna de pose en out y devuelve el final
+    uint8_t* putPoseColumn(
+        uint8_t* out,
+        RecordingColumn column,
+        const FrameData* frames,
+        size_t count);
+
+    PoseCodecConfig poseCodecs[POSE_COLUMN_COUNT];
+    std::vector<float> poseScratch;
+    std::vector<uint8_t> presentScratch;
+    std::ofstream file;
+    std::string filename;
+    std::vector<uint8_t> chunkBuffer;
+    std::vector<RecordingIndexEntry> index;
+    uint64_t bytesWritten = 0;
+    uint32_t chunkCount = 0;
+    uint32_t frameCount = 0;
+    uint64_t poseSampleCount = 0;
+};
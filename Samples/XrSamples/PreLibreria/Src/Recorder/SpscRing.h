@@ -0,0 +1,110 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <type_traits>
+
+// Cola circular sin locks para un productor y un consumidor.
+// El productor (hilo de render) solo hace un memcpy al hueco y publica el indice;
+// la memoria se reserva entera al construir y no crece nunca.
+//
+// Los indices son contadores de 64 bits que solo crecen, el hueco es indice & mask.
+// tail normalmente solo lo mueve el consumidor, pero pushDropOldest tambien lo
+// adelanta desde el productor para descartar el elemento mas antiguo; por eso el
+// consumidor confirma lo leido con un CAS y si falla repite la lectura (la copia
+// pudo quedar a medias porque el productor reutilizo el hueco).
+template <typename T>
+class SpscRing {
+    static_assert(std::is_trivially_copyable<T>::value, "SpscRing slots are copied with memcpy");
+
+public:
+    // capacity se redondea a la siguiente potencia de dos
+    explicit SpscRing(size_t capacity) {
+        size_t pow2 = 1;
+        while (pow2 < capacity) {
+            pow2 <<= 1;
+        }
+        slots.reset(new T[pow2]);
+        mask = pow2 - 1;
+    }
+
+    SpscRing(const SpscRing&) = delete;
+    SpscRing& operator=(const SpscRing&) = delete;
+
+    // Productor. Devuelve false si esta llena.
+    bool tryPush(const T& item) {
+        const uint64_t h = head.load(std::memory_order_relaxed);
+        const uint64_t t = tail.load(std::memory_order_acquire);
+        if (h - t > mask) {
+            return false;
+        }
+        memcpy(&slots[h & mask], &item, sizeof(T));
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Productor. Si esta llena descarta el elemento mas antiguo; devuelve true en ese caso.
+    bool pushDropOldest(const T& item) {
+        const uint64_t h = head.load(std::memory_order_relaxed);
+        uint64_t t = tail.load(std::memory_order_acquire);
+        bool dropped = false;
+        while (h - t > mask) {
+            if (tail.compare_exchange_weak(t, t + 1, std::memory_order_acq_rel)) {
+                dropped = true;
+                break;
+            }
+            // t se ha recargado: el consumidor ha liberado huecos o hay que reintentar
+        }
+        memcpy(&slots[h & mask], &item, sizeof(T));
+        head.store(h + 1, std::memory_order_release);
+        return dropped;
+    }
+
+    // Consumidor. Copia hasta maxCount elementos en out y devuelve cuantos.
+    size_t popBatch(T* out, size_t maxCount) {
+        for (;;) {
+            uint64_t t = tail.load(std::memory_order_acquire);
+            const uint64_t h = head.load(std::memory_order_acquire);
+            size_t count = static_cast<size_t>(h - t);
+            if (count > maxCount) {
+                count = maxCount;
+            }
+            if (count == 0) {
+                return 0;
+            }
+
+            // Como mucho dos tramos: hasta el final del buffer y desde el principio
+            const size_t first = static_cast<size_t>(t & mask);
+            const size_t firstCount = std::min(count, mask + 1 - first);
+            memcpy(out, &slots[first], firstCount * sizeof(T));
+            if (count > firstCount) {
+                memcpy(out + firstCount, &slots[0], (count - firstCount) * sizeof(T));
+            }
+
+            if (tail.compare_exchange_strong(t, t + count, std::memory_order_acq_rel)) {
+                return count;
+            }
+        }
+    }
+
+    size_t size() const {
+        const uint64_t t = tail.load(std::memory_order_acquire);
+        const uint64_t h = head.load(std::memory_order_acquire);
+        return static_cast<size_t>(h - t);
+    }
+
+    size_t capacity() const {
+        return mask + 1;
+    }
+
+private:
+    // Separados en lineas de cache distintas para que productor y consumidor no se pisen
+    alignas(64) std::atomic<uint64_t> head{0};
+    alignas(64) std::atomic<uint64_t> tail{0};
+    alignas(64) std::unique_ptr<T[]> slots;
+    size_t mask = 0;
+};
@@ -0,0 +1,325 @@
+#include "Recorder/UploadQueue.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <random>
+
+#if defined(ANDROID) || defined(__linux__)
+#include <pthread.h>
+#endif
+
+#include "Misc/Log.h"
+
+namespace {
+
+std::string baseName(const std::string& filename) {
+    const size_t slash = filename.find_last_of("/\\");
+    return slash == std::string::npos ? filename : filename.substr(slash + 1);
+}
+
+bool parseUnsigned(const std::string& value, uint64_t& number) {
+    if (value.empty()) {
+        return false;
+    }
+    char* end = nullptr;
+    number = strtoull(value.c_str(), &end, 10);
+    return end != nullptr && *end == '\0';
+}
+
+} // namespace
+
+bool UploadQueue::loadConfig(const std::string& configFile, Config& config) {
+    std::ifstream in(configFile);
+    if (!in.is_open()) {
+        return false;
+    }
+    Config loaded = config;
+    loaded.host.clear();
+    std::string line;
+    while (std::getline(in, line)) {
+        if (!line.empty() && line.back() == '\r') {
+            line.pop_back(); // guardado en Windows
+        }
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+        const size_t equals = line.find('=');
+        if (equals == std::string::npos) {
+            ALOGE("UploadQueue: bad line in %s: %s", configFile.c_str(), line.c_str());
+            return false;
+        }
+        const std::string key = line.substr(0, equals);
+        const std::string value = line.substr(equals + 1);
+        if (key == "host") {
+            loaded.host = value;
+        } else if (key == "port") {
+            uint64_t port = 0;
+            if (!parseUnsigned(value, port) || port == 0 || port > 65535) {
+                ALOGE("UploadQueue: bad port in %s: %s", configFile.c_str(), value.c_str());
+                return false;
+            }
+            loaded.port = static_cast<uint16_t>(port);
+        } else if (key == "path") {
+            loaded.pathPrefix = value;
+        } else {
+            ALOGW("UploadQueue: unknown key in %s: %s", configFile.c_str(), key.c_str());
+        }
+    }
+    if (loaded.host.empty()) {
+        return false;
+    }
+    config = loaded;
+    return true;
+}
+
+UploadQueue::UploadQueue(const std::string& file) : queueFile(file) {
+    loadPersisted();
+}
+
+UploadQueue::~UploadQueue() {
+    stop();
+}
+
+void UploadQueue::start(const Config& newConfig) {
+    if (worker.joinable()) {
+        return;
+    }
+    if (newConfig.host.empty()) {
+        ALOG("UploadQueue: no upload host configured, parts stay queued");
+        return;
+    }
+    config = newConfig;
+    config.chunkSize = std::max<size_t>(config.chunkSize, 1);
+    chunkBuffer.resize(config.chunkSize);
+    connection.setEndpoint(config.host, config.port, config.timeoutMs);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopRequested = false;
+    }
+    worker = std::thread(&UploadQueue::workerLoop, this);
+}
+
+void UploadQueue::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopRequested = true;
+    }
+    wakeup.notify_all();
+    if (worker.joinable()) {
+        worker.join();
+    }
+}
+
+void UploadQueue::enqueue(const std::string& filename) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (std::find(pending.begin(), pending.end(), filename) != pending.end()) {
+            return;
+        }
+        pending.push_back(filename);
+        persistLocked();
+    }
+    wakeup.notify_all();
+}
+
+size_t UploadQueue::getPendingCount() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return pending.size();
+}
+
+void UploadQueue::persistLocked() const {
+    const std::string tmp = queueFile + ".tmp";
+    {
+        std::ofstream out(tmp, std::ios::trunc);
+        for (const std::string& filename : pending) {
+            out << filename << "\n";
+        }
+        if (!out.good()) {
+            ALOGE("UploadQueue: could not write %s", tmp.c_str());
+            return;
+        }
+    }
+#if defined(_WIN32)
+    std::remove(queueFile.c_str()); // rename no sobrescribe en Windows
+#endif
+    if (std::rename(tmp.c_str(), queueFile.c_str()) != 0) {
+        ALOGE("UploadQueue: could not replace %s", queueFile.c_str());
+    }
+}
+
+void UploadQueue::loadPersisted() {
+    std::ifstream in(queueFile);
+    std::string line;
+    while (std::getline(in, line)) {
+        if (!line.empty() && std::find(pending.begin(), pending.end(), line) == pending.end()) {
+            pending.push_back(line);
+        }
+    }
+    if (!pending.empty()) {
+        ALOG("UploadQueue: %zu parts pending from a previous run", pending.size());
+    }
+}
+
+bool UploadQueue::waitFor(std::chrono::milliseconds delay) {
+    std::unique_lock<std::mutex> lock(mutex);
+    return !wakeup.wait_for(lock, delay, [this] { return stopRequested; });
+}
+
+void UploadQueue::workerLoop() {
+#if defined(ANDROID) || defined(__linux__)
+    pthread_setname_np(pthread_self(), "RecorderUpload");
+#endif
+
+    std::mt19937 jitter(std::random_device{}());
+    int failures = 0;
+    for (;;) {
+        std::string filename;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wakeup.wait(lock, [this] { return stopRequested || !pending.empty(); });
+            if (stopRequested) {
+                break;
+            }
+            filename = pending.front();
+        }
+
+        const uint64_t before = bytesUploaded.load(std::memory_order_relaxed);
+        if (uploadFile(filename)) {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                pending.erase(std::remove(pending.begin(), pending.end(), filename), pending.end());
+                persistLocked();
+            }
+            failures = 0;
+            continue;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (stopRequested) {
+                break; // parada a mitad de fichero, se reanuda en la proxima ejecucion
+            }
+        }
+
+        // Si algun trozo entro el servidor responde, el backoff vuelve a empezar
+        if (bytesUploaded.load(std::memory_order_relaxed) != before) {
+            failures = 0;
+        }
+        connection.close();
+        retries.fetch_add(1, std::memory_order_relaxed);
+
+        // Backoff exponencial con jitter para no sincronizar reintentos entre gafas
+        const int64_t ceiling = std::min<int64_t>(
+            config.maxBackoff.count(), config.minBackoff.count() << std::min(failures, 16));
+        std::uniform_int_distribution<int64_t> pick(ceiling / 2, ceiling);
+        const std::chrono::milliseconds delay(pick(jitter));
+        failures++;
+        ALOGW(
+            "UploadQueue: upload of %s failed, retrying in %lld ms",
+            filename.c_str(),
+            static_cast<long long>(delay.count()));
+        if (!waitFor(delay)) {
+            break;
+        }
+    }
+    connection.close();
+}
+
+bool UploadQueue::queryOffset(const std::string& path, uint64_t& offset) {
+    HttpConnection::Response response;
+    if (!connection.request("HEAD", path, std::string(), nullptr, 0, response)) {
+        return false;
+    }
+    if (response.status == 404) {
+        offset = 0;
+        return true;
+    }
+    if (response.status / 100 != 2 || !parseUnsigned(response.header("upload-offset"), offset)) {
+        ALOGW("UploadQueue: unexpected HEAD response %d for %s", response.status, path.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool UploadQueue::uploadFile(const std::string& filename) {
+    std::ifstream file(filename, std::ios::binary | std::ios::ate);
+    if (!file.is_open()) {
+        ALOGE("UploadQueue: %s no longer exists, dropped from the queue", filename.c_str());
+        return true;
+    }
+    const uint64_t size = static_cast<uint64_t>(file.tellg());
+    const std::string path = config.pathPrefix + baseName(filename);
+
+    uint64_t offset = 0;
+    if (!queryOffset(path, offset)) {
+        return false;
+    }
+    if (offset > size) {
+        ALOGE(
+            "UploadQueue: server has %llu bytes of %s but the file has %llu, skipped",
+            static_cast<unsigned long long>(offset),
+            filename.c_str(),
+            static_cast<unsigned long long>(size));
+        return true;
+    }
+
+    while (offset < size) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (stopRequested) {
+                return false;
+            }
+        }
+
+        const size_t length = static_cast<size_t>(std::min<uint64_t>(config.chunkSize, size - offset));
+        file.seekg(static_cast<std::streamoff>(offset));
+        file.read(chunkBuffer.data(), static_cast<std::streamsize>(length));
+        if (!file.good()) {
+            ALOGE("UploadQueue: could not read %s", filename.c_str());
+            return false;
+        }
+
+        const std::string headers = "Upload-Offset: " + std::to_string(offset) +
+            "\r\nUpload-Length: " + std::to_string(size) +
+            "\r\nContent-Type: application/offset+octet-stream\r\n";
+        HttpConnection::Response response;
+        if (!connection.request("PATCH", path, headers, chunkBuffer.data(), length, response)) {
+            return false;
+        }
+
+        uint64_t serverOffset = 0;
+        const bool hasOffset = parseUnsigned(response.header("upload-offset"), serverOffset);
+        if (response.status / 100 == 2) {
+            if (!hasOffset) {
+                serverOffset = offset + length;
+            }
+        } else if (response.status == 409 && hasOffset && serverOffset != offset) {
+            // El servidor ya tenia otra cosa (p.ej. la respuesta anterior se perdio):
+            // se sigue desde donde dice el, sin reenviar lo que ya tiene
+        } else {
+            ALOGW("UploadQueue: PATCH %s returned %d", path.c_str(), response.status);
+            return false;
+        }
+
+        if (serverOffset > size || serverOffset == offset) {
+            ALOGE("UploadQueue: bad Upload-Offset from the server for %s", filename.c_str());
+            return false;
+        }
+        if (serverOffset > offset) {
+            bytesUploaded.fetch_add(serverOffset - offset, std::memory_order_relaxed);
+        }
+        offset = serverOffset;
+    }
+
+    filesUploaded.fetch_add(1, std::memory_order_relaxed);
+    ALOG(
+        "Uploaded %s (%llu bytes) to %s:%u%s",
+        filename.c_str(),
+        static_cast<unsigned long long>(size),
+        config.host.c_str(),
+        config.port,
+        path.c_str());
+    return true;
+}
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Recorder/HttpConnection.h"
+
+/*
+    Cola de subida de las partes terminadas de una grabacion.
+
+    Un hilo propio sube cada fichero en trozos de chunkSize bytes con un protocolo
+    reanudable al estilo tus:
+
+        HEAD  <pathPrefix><nombre>      -> Upload-Offset: bytes que ya tiene el servidor
+                                           (404 = nada todavia)
+        PATCH <pathPrefix><nombre>      Upload-Offset: o, Upload-Length: total
+                                        Content-Type: application/offset+octet-stream
+                                        -> 204 + Upload-Offset nuevo
+                                        -> 409 + Upload-Offset real si o no coincidia
+
+    El servidor solo acepta un trozo si empieza justo donde acaba lo que ya tiene,
+    asi un reintento nunca duplica datos: tras cualquier fallo se cierra la
+    conexion, se espera con backoff exponencial y se vuelve a preguntar el offset.
+
+    La lista de ficheros pendientes se guarda en queueFile cada vez que cambia
+    (escribiendo a un temporal y renombrando), y se recupera al construir, de modo
+    que lo que no se subio sigue en cola tras reiniciar la app.
+
+    enqueue solo toma un mutex y escribe la lista; nunca toca la red.
+*/
+class UploadQueue {
+public:
+    struct Config {
+        std::string host; // vacio = no se sube nada, los ficheros se quedan en cola
+        uint16_t port = 80;
+        std::string pathPrefix = "/upload/";
+        size_t chunkSize = 256 * 1024;
+        int timeoutMs = 5000;
+        std::chrono::milliseconds minBackoff{500};
+        std::chrono::milliseconds maxBackoff{60000};
+    };
+
+    // Lee el servidor de un fichero de texto con una clave=valor por linea:
+    //
+    //     # comentario
+    //     host=uploads.example.com
+    //     port=8080
+    //     path=/upload/
+    //
+    // host es obligatorio; port y path son opcionales y sin ellos se quedan los de config.
+    // Devuelve false, sin tocar config, si el fichero no existe, no tiene host o tiene
+    // una linea o un puerto invalidos.
+    static bool loadConfig(const std::string& configFile, Config& config);
+
+    explicit UploadQueue(const std::string& queueFile);
+    ~UploadQueue();
+
+    UploadQueue(const UploadQueue&) = delete;
+    UploadQueue& operator=(const UploadQueue&) = delete;
+
+    // Arranca el hilo de subida. Se puede llamar antes o despues de encolar.
+    void start(const Config& config);
+
+    // Para el hilo. Lo pendiente queda en queueFile para la proxima vez.
+    // Puede esperar hasta timeoutMs si hay una peticion en curso.
+    void stop();
+
+    // Anade una parte terminada al final de la cola (ignora duplicados)
+    void enqueue(const std::string& filename);
+
+    size_t getPendingCount() const;
+    uint64_t getBytesUploaded() const { return bytesUploaded.load(std::memory_order_relaxed); }
+    uint32_t getFilesUploaded() const { return filesUploaded.load(std::memory_order_relaxed); }
+    uint32_t getRetries() const { return retries.load(std::memory_order_relaxed); }
+
+private:
+    void workerLoop();
+    bool uploadFile(const std::string& filename);
+    bool queryOffset(const std::string& path, uint64_t& offset);
+    void persistLocked() const;
+    void loadPersisted();
+    // Espera delay o hasta que se pida parar. Devuelve false si hay que parar.
+    bool waitFor(std::chrono::milliseconds delay);
+
+    const std::string queueFile;
+    Config config;
+
+    mutable std::mutex mutex;
+    std::condition_variable wakeup;
+    std::deque<std::string> pending;
+    bool stopRequested = false;
+    std::thread worker;
+
+    // Hilo de subida
+    HttpConnection connection;
+    std::vector<char> chunkBuffer;
+
+    std::atomic<uint64_t> bytesUploaded{0};
+    std::atomic<uint32_t> filesUploaded{0};
+    std::atomic<uint32_t> retries{0};
+};
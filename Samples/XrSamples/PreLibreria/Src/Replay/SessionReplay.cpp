@@ -0,0 +1,199 @@
+#include "Replay/SessionReplay.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <thread>
+
+#include "Misc/Log.h"
+
+#include "Recorder/RecordingReader.h"
+#include "Recorder/RecordingSession.h"
+
+namespace {
+
+// Campo de vision simetrico para las matrices de proyeccion, la grabacion no lo guarda
+const float REPLAY_FOV_Y_RADIANS = 1.6f;
+const float REPLAY_NEAR_Z = 0.1f;
+const float REPLAY_FAR_Z = 1000.0f;
+
+OVR::Posef makePose(float px, float py, float pz, float rx, float ry, float rz, float rw) {
+    return OVR::Posef(OVR::Quatf(rx, ry, rz, rw), OVR::Vector3f(px, py, pz));
+}
+
+// Percentil por rango mas cercano sobre un vector ya ordenado
+double percentile(const std::vector<double>& sorted, double p) {
+    if (sorted.empty()) {
+        return 0.0;
+    }
+    const size_t rank = static_cast<size_t>(std::ceil(p * static_cast<double>(sorted.size())));
+    return sorted[std::min(sorted.size() - 1, rank > 0 ? rank - 1 : 0)];
+}
+
+} // namespace
+
+bool SessionReplay::load(const std::vector<std::string>& filenames) {
+    frames.clear();
+    std::vector<FrameData> chunk;
+    for (const std::string& filename : filenames) {
+        RecordingReader reader;
+        if (!reader.open(filename)) {
+            return false;
+        }
+        while (reader.readChunk(chunk)) {
+            frames.insert(frames.end(), chunk.begin(), chunk.end());
+        }
+    }
+    ALOG("SessionReplay: loaded %zu frames from %zu files", frames.size(), filenames.size());
+    return true;
+}
+
+bool SessionReplay::loadRange(
+    const std::string& manifestFilename,
+    double startSeconds,
+    double durationSeconds) {
+    frames.clear();
+    RecordingSession session;
+    uint64_t firstFrame = 0;
+    if (!session.open(manifestFilename) || !session.seekTime(startSeconds, firstFrame)) {
+        return false;
+    }
+    const double end = durationSeconds > 0.0 ? startSeconds + durationSeconds : HUGE_VAL;
+    std::vector<FrameData> chunk;
+    while (session.readChunk(chunk)) {
+        for (const FrameData& frame : chunk) {
+            if (frame.timestamp >= startSeconds && frame.timestamp < end) {
+                frames.push_back(frame);
+            }
+        }
+        if (chunk.empty() || chunk.back().timestamp >= end) {
+            break;
+        }
+    }
+    ALOG(
+        "SessionReplay: loaded %zu frames from %.2fs of %s (from frame %llu)",
+        frames.size(),
+        startSeconds,
+        manifestFilename.c_str(),
+        static_cast<unsigned long long>(firstFrame));
+    return true;
+}
+
+void SessionReplay::buildFrame(size_t index, OVRFW::ovrApplFrameIn& in) const {
+    const FrameData& f = frames[index];
+    const FrameData* prev = index > 0 ? &frames[index - 1] : nullptr;
+
+    in.FrameIndex = static_cast<int64_t>(index);
+    in.PredictedDisplayTime = f.timestamp;
+    in.RealTimeInSeconds = f.timestamp;
+    // Igual que MainLoop: el primer frame no tiene delta
+    in.DeltaSeconds = prev != nullptr ? std::max(0.0f, static_cast<float>(f.timestamp - prev->timestamp))
+                                      : 0.0f;
+
+    in.HeadPose =
+        makePose(f.headPosX, f.headPosY, f.headPosZ, f.headRotX, f.headRotY, f.headRotZ, f.headRotW);
+    in.LeftRemotePose =
+        makePose(f.leftPosX, f.leftPosY, f.leftPosZ, f.leftRotX, f.leftRotY, f.leftRotZ, f.leftRotW);
+    in.RightRemotePose = makePose(
+        f.rightPosX, f.rightPosY, f.rightPosZ, f.rightRotX, f.rightRotY, f.rightRotZ, f.rightRotW);
+    // La pose de apuntado no se graba: se usa la del agarre
+    in.LeftRemotePointPose = in.LeftRemotePose;
+    in.RightRemotePointPose = in.RightRemotePose;
+    in.LeftRemoteTracked = f.leftControllerTracked;
+    in.RightRemoteTracked = f.rightControllerTracked;
+    in.LeftRemoteIndexTrigger = f.leftTriggerValue;
+    in.RightRemoteIndexTrigger = f.rightTriggerValue;
+
+    in.AllButtons = f.allButtons;
+    in.LastFrameAllButtons = f.lastFrameAllButtons;
+
+    // Ojos separados IPD/2 de la cabeza, como los que entrega el runtime
+    const OVR::Matrix4f stageFromHead(in.HeadPose);
+    const OVR::Matrix4f projection = OVR::Matrix4f::PerspectiveRH(
+        REPLAY_FOV_Y_RADIANS, 1.0f, REPLAY_NEAR_Z, REPLAY_FAR_Z);
+    for (int eye = 0; eye < 2; eye++) {
+        const float offset = (eye == 0 ? -0.5f : 0.5f) * in.IPD;
+        const OVR::Matrix4f stageFromEye = stageFromHead * OVR::Matrix4f::Translation(offset, 0.0f, 0.0f);
+        in.Eye[eye].ViewMatrix = stageFromEye.Inverted();
+        in.Eye[eye].ProjectionMatrix = projection;
+    }
+}
+
+SessionReplay::Stats SessionReplay::run(const UpdateFunction& update, Pacing pacing, int loops) const {
+    Stats stats;
+    if (frames.empty() || loops <= 0) {
+        return stats;
+    }
+
+    const double firstTimestamp = frames.front().timestamp;
+    const double recordedDuration = frames.back().timestamp - firstTimestamp;
+    // Entre vueltas se deja el mismo hueco que hay entre los dos primeros frames
+    const double loopGap = frames.size() > 1 ? frames[1].timestamp - frames[0].timestamp : 0.0;
+
+    std::vector<double> updateMs;
+    updateMs.reserve(frames.size() * static_cast<size_t>(loops));
+
+    OVRFW::ovrApplFrameIn in;
+    const auto start = std::chrono::steady_clock::now();
+    for (int loop = 0; loop < loops; loop++) {
+        const double loopOffset = loop * (recordedDuration + loopGap);
+        for (size_t i = 0; i < frames.size(); i++) {
+            buildFrame(i, in);
+            in.FrameIndex += static_cast<int64_t>(loop) * static_cast<int64_t>(frames.size());
+            in.PredictedDisplayTime += loopOffset;
+            in.RealTimeInSeconds += loopOffset;
+            if (loop > 0 && i == 0) {
+                in.DeltaSeconds = static_cast<float>(loopGap);
+            }
+
+            if (pacing == PACING_RECORDED) {
+                const double due = in.RealTimeInSeconds - firstTimestamp;
+                std::this_thread::sleep_until(
+                    start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                                std::chrono::duration<double>(due)));
+            }
+
+            const auto before = std::chrono::steady_clock::now();
+            update(in);
+            const auto after = std::chrono::steady_clock::now();
+
+            const double ms = std::chrono::duration<double, std::milli>(after - before).count();
+            updateMs.push_back(ms);
+            if (in.DeltaSeconds > 0.0f && ms > in.DeltaSeconds * 1000.0) {
+                stats.overBudgetFrames++;
+            }
+        }
+    }
+    stats.wallSeconds =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    stats.recordedSeconds = recordedDuration * loops + loopGap * (loops - 1);
+
+    stats.frames = updateMs.size();
+    double total = 0.0;
+    for (double ms : updateMs) {
+        total += ms;
+    }
+    stats.meanMs = total / static_cast<double>(updateMs.size());
+    std::sort(updateMs.begin(), updateMs.end());
+    stats.p50Ms = percentile(updateMs, 0.50);
+    stats.p90Ms = percentile(updateMs, 0.90);
+    stats.p99Ms = percentile(updateMs, 0.99);
+    stats.maxMs = updateMs.back();
+    return stats;
+}
+
+void SessionReplay::logStats(const Stats& stats) {
+    ALOG(
+        "Replay: %zu frames in %.3f s (recorded %.3f s)",
+        stats.frames,
+        stats.wallSeconds,
+        stats.recordedSeconds);
+    ALOG(
+        "Replay: Update ms mean %.4f p50 %.4f p90 %.4f p99 %.4f max %.4f, %zu frames over budget",
+        stats.meanMs,
+        stats.p50Ms,
+        stats.p90Ms,
+        stats.p99Ms,
+        stats.maxMs,
+        stats.overBudgetFrames);
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "FrameParams.h"
+
+#include "Recorder/FrameData.h"
+
+// Reproduce una sesion grabada (.vrmr o .vrms) sin casco: reconstruye el
+// ovrApplFrameIn de cada frame y se lo pasa a una funcion de update. No hace falta
+// runtime de OpenXR ni GL. Hoy solo se usa con la grabadora (Tools/ReplaySession.cpp):
+// XrApp no compila en Linux y el Update de la app usa la sesion y GL.
+//
+// Todos los frames se cargan en memoria antes de empezar, asi la lectura del disco
+// no entra en las medidas. Solo se mide la llamada a update.
+class SessionReplay {
+public:
+    using UpdateFunction = std::function<void(const OVRFW::ovrApplFrameIn&)>;
+
+    enum Pacing {
+        PACING_RECORDED, // espera entre frames lo mismo que en la grabacion
+        PACING_MAX_SPEED, // un frame detras de otro
+    };
+
+    struct Stats {
+        size_t frames = 0;
+        double wallSeconds = 0.0; // duracion total de la reproduccion
+        double recordedSeconds = 0.0; // duracion de la grabacion
+        double meanMs = 0.0;
+        double p50Ms = 0.0;
+        double p90Ms = 0.0;
+        double p99Ms = 0.0;
+        double maxMs = 0.0;
+        size_t overBudgetFrames = 0; // update mas largo que el DeltaSeconds grabado
+    };
+
+    // Lee las partes en el orden dado y las encadena. Devuelve false si alguna falla.
+    bool load(const std::vector<std::string>& filenames);
+
+    // Lee solo el tramo [startSeconds, startSeconds + durationSeconds) de una sesion a
+    // traves de su manifiesto .vrmx: busca el chunk de inicio con el indice y decodifica
+    // desde ahi, sin tocar las partes anteriores. durationSeconds <= 0 lee hasta el final.
+    bool loadRange(const std::string& manifestFilename, double startSeconds, double durationSeconds);
+
+    // Para reproducir frames generados en vez de leidos
+    void setFrames(std::vector<FrameData> recordedFrames) { frames = std::move(recordedFrames); }
+
+    size_t getFrameCount() const { return frames.size(); }
+    const std::vector<FrameData>& getFrames() const { return frames; }
+
+    // Rellena in con el frame index tal como lo habria entregado MainLoop.
+    // Los campos que no se graban (joysticks, touches, eventos) quedan a cero.
+    void buildFrame(size_t index, OVRFW::ovrApplFrameIn& in) const;
+
+    // Reproduce todos los frames loops veces y devuelve los tiempos de update
+    Stats run(const UpdateFunction& update, Pacing pacing, int loops = 1) const;
+
+    static void logStats(const Stats& stats);
+
+private:
+    std::vector<FrameData> frames;
+};
@@ -1,15 +1,20 @@
+#include <cstring>
 #include <string>
 #include <string_view>
-#include <fstream>
-#include <chrono>
 #include <vector>
 #include <sstream>
-#include <iomanip>
+
+#if defined(ANDROID)
+#include <time.h>
+// xrConvertTimespecTimeToTimeKHR, el reloj del muestreo de poses
+#define XR_USE_TIMESPEC 1
+#endif // defined(ANDROID)
 
 #include <openxr/openxr.h>
 
 #include "GUI/VRMenuObject.h"
 #include "Render/BitmapFont.h"
+#include "Render/PerfHud.h"
 #include "XrApp.h"
 
 #include "OVR_Math.h"
@@ -17,206 +22,8 @@
 #include "Input/TinyUI.h"
 #include "Render/SimpleBeamRenderer.h"
 
-// Clase para manejar la grabación de movimientos
-class MovementRecorder {
-public:
-    // Estructura para almacenar los datos de cada frame (ahora dentro de la clase)
-    struct FrameData {
-        double timestamp;
-
-        // Headset
-        float headPosX, headPosY, headPosZ;
-        float headRotX, headRotY, headRotZ, headRotW;
-
-        // Controlador izquierdo
-        bool leftControllerTracked;
-        float leftPosX, leftPosY, leftPosZ;
-        float leftRotX, leftRotY, leftRotZ, leftRotW;
-        float leftTriggerValue;
-
-        // Controlador derecho
-        bool rightControllerTracked;
-        float rightPosX, rightPosY, rightPosZ;
-        float rightRotX, rightRotY, rightRotZ, rightRotW;
-        float rightTriggerValue;
-
-        // Botones
-        bool buttonA_pressed;
-
-        // Constructor para inicializar con datos del frame
-        FrameData(const OVRFW::ovrApplFrameIn& in, double ts) : timestamp(ts) {
-            // Headset
-            headPosX = in.HeadPose.Translation.x;
-            headPosY = in.HeadPose.Translation.y;
-            headPosZ = in.HeadPose.Translation.z;
-            headRotX = in.HeadPose.Rotation.x;
-            headRotY = in.HeadPose.Rotation.y;
-            headRotZ = in.HeadPose.Rotation.z;
-            headRotW = in.HeadPose.Rotation.w;
-
-            // Controlador izquierdo
-            leftControllerTracked = in.LeftRemoteTracked;
-            if (leftControllerTracked) {
-                leftPosX = in.LeftRemotePose.Translation.x;
-                leftPosY = in.LeftRemotePose.Translation.y;
-                leftPosZ = in.LeftRemotePose.Translation.z;
-                leftRotX = in.LeftRemotePose.Rotation.x;
-                leftRotY = in.LeftRemotePose.Rotation.y;
-                leftRotZ = in.LeftRemotePose.Rotation.z;
-                leftRotW = in.LeftRemotePose.Rotation.w;
-                leftTriggerValue = in.LeftRemoteIndexTrigger;
-            } else {
-                leftPosX = leftPosY = leftPosZ = 0.0f;
-                leftRotX = leftRotY = leftRotZ = 0.0f;
-                leftRotW = 1.0f;
-                leftTriggerValue = 0.0f;
-            }
-
-            // Controlador derecho
-            rightControllerTracked = in.RightRemoteTracked;
-            if (rightControllerTracked) {
-                rightPosX = in.RightRemotePose.Translation.x;
-                rightPosY = in.RightRemotePose.Translation.y;
-                rightPosZ = in.RightRemotePose.Translation.z;
-                rightRotX = in.RightRemotePose.Rotation.x;
-                rightRotY = in.RightRemotePose.Rotation.y;
-                rightRotZ = in.RightRemotePose.Rotation.z;
-                rightRotW = in.RightRemotePose.Rotation.w;
-                rightTriggerValue = in.RightRemoteIndexTrigger;
-            } else {
-                rightPosX = rightPosY = rightPosZ = 0.0f;
-                rightRotX = rightRotY = rightRotZ = 0.0f;
-                rightRotW = 1.0f;
-                rightTriggerValue = 0.0f;
-            }
-
-            // Botones
-            buttonA_pressed = in.Clicked(OVRFW::ovrApplFrameIn::kButtonA);
-        }
-
-        // Convertir a CSV
-        std::string toCSV() const {
-            std::ostringstream oss;
-            oss << std::fixed << std::setprecision(6)
-                << timestamp << ","
-                << headPosX << "," << headPosY << "," << headPosZ << ","
-                << headRotX << "," << headRotY << "," << headRotZ << "," << headRotW << ","
-                << (leftControllerTracked ? "1" : "0") << ","
-                << leftPosX << "," << leftPosY << "," << leftPosZ << ","
-                << leftRotX << "," << leftRotY << "," << leftRotZ << "," << leftRotW << ","
-                << leftTriggerValue << ","
-                << (rightControllerTracked ? "1" : "0") << ","
-                << rightPosX << "," << rightPosY << "," << rightPosZ << ","
-                << rightRotX << "," << rightRotY << "," << rightRotZ << "," << rightRotW << ","
-                << rightTriggerValue << ","
-                << (buttonA_pressed ? "1" : "0");
-            return oss.str();
-        }
-    };
-private:
-    std::vector<FrameData> frameBuffer;
-    std::chrono::high_resolution_clock::time_point startTime;
-    int currentFileIndex;
-    int frameCount;
-    static const int MAX_FRAMES_PER_FILE = 5400; // 60 segundos a 90fps
-    std::string baseFilename;
-
-    std::string getCurrentFilename() const {
-        std::ostringstream oss;
-        oss << baseFilename << "_part" << std::setfill('0') << std::setw(3) << currentFileIndex << ".csv";
-        return oss.str();
-    }
-
-    void saveBufferToFile() {
-        if (frameBuffer.empty()) return;
-
-        std::string filename = getCurrentFilename();
-        std::ofstream file(filename);
-
-        if (file.is_open()) {
-            // Escribir cabecera CSV
-            file << "timestamp,head_pos_x,head_pos_y,head_pos_z,"
-                 << "head_rot_x,head_rot_y,head_rot_z,head_rot_w,"
-                 << "left_tracked,left_pos_x,left_pos_y,left_pos_z,"
-                 << "left_rot_x,left_rot_y,left_rot_z,left_rot_w,left_trigger,"
-                 << "right_tracked,right_pos_x,right_pos_y,right_pos_z,"
-                 << "right_rot_x,right_rot_y,right_rot_z,right_rot_w,right_trigger,"
-                 << "button_a\n";
-
-            // Escribir datos
-            for (const auto& frame : frameBuffer) {
-                file << frame.toCSV() << "\n";
-            }
-
-            file.close();
-            ALOG("Saved %zu frames to %s", frameBuffer.size(), filename.c_str());
-
-            // Simular envío a servidor web (URL falsa)
-            simulateWebUpload(filename);
-        } else {
-            ALOG("Error: Could not open file %s for writing", filename.c_str());
-        }
-    }
-
-    void simulateWebUpload(const std::string& filename) {
-        // Simulación de envío a servidor web
-        std::string fakeUrl = "https://api.vrmotion.fake/upload/session123/" + filename;
-        ALOG("Simulating upload to: %s", fakeUrl.c_str());
-
-        // Aquí irían las llamadas HTTP reales cuando implementes la funcionalidad
-        // Por ejemplo usando libcurl o similar:
-        // curl_easy_setopt(curl, CURLOPT_URL, fakeUrl.c_str());
-        // curl_easy_setopt(curl, CURLOPT_POSTFIELDS, file_data);
-        // curl_easy_perform(curl);
-    }
-
-public:
-    MovementRecorder() : currentFileIndex(0), frameCount(0) {
-        // Generar nombre base único con timestamp
-        auto now = std::chrono::system_clock::now();
-        auto time_t = std::chrono::system_clock::to_time_t(now);
-        auto tm = *std::localtime(&time_t);
-
-        std::ostringstream oss;
-        oss << "vr_motion_"
-            << std::put_time(&tm, "%Y%m%d_%H%M%S");
-        baseFilename = oss.str();
-
-        startTime = std::chrono::high_resolution_clock::now();
-        frameBuffer.reserve(MAX_FRAMES_PER_FILE);
-
-        ALOG("MovementRecorder initialized with base filename: %s", baseFilename.c_str());
-    }
-
-    void recordFrame(const OVRFW::ovrApplFrameIn& in) {
-        auto now = std::chrono::high_resolution_clock::now();
-        double timestamp = std::chrono::duration<double>(now - startTime).count();
-
-        frameBuffer.emplace_back(in, timestamp);
-        frameCount++;
-
-        // Si el buffer está lleno, guardar archivo y empezar uno nuevo
-        if (frameBuffer.size() >= MAX_FRAMES_PER_FILE) {
-            saveBufferToFile();
-            frameBuffer.clear();
-            currentFileIndex++;
-        }
-    }
-
-    void finalize() {
-        // Guardar cualquier frame restante en el buffer
-        if (!frameBuffer.empty()) {
-            saveBufferToFile();
-            frameBuffer.clear();
-        }
-
-        ALOG("MovementRecorder finalized. Total frames recorded: %d across %d files",
-             frameCount, currentFileIndex + 1);
-    }
-
-    int getTotalFrames() const { return frameCount; }
-    int getCurrentFileIndex() const { return currentFileIndex; }
-};
+#include "Recorder/MovementRecorder.h"
+#include "Recorder/PoseSampler.h"
 
 class XrAppBaseApp : public OVRFW::XrApp {
 
@@ -228,8 +35,19 @@ private:
     bool labelCreado = false;
     bool labelVisible = true;
 
-    // Sistema de grabación
-    MovementRecorder recorder;
+    // Sistema de grabación, poses cuantizadas a 0.1mm, con las articulaciones de las manos
+    // y con muestras de cabeza y mandos a 500Hz entre frame y frame
+    MovementRecorder recorder{
+        MovementRecorder::BACKPRESSURE_DROP_OLDEST,
+        MovementRecorder::PoseCompression::quantized(0.1f),
+        MovementRecorder::SINK_CHUNKED_FILE,
+        true,
+        PoseDecimatorConfig(),
+        true};
+    PoseSampler poseSampler{recorder};
+
+    // Panel de rendimiento con los contadores del framework y de la grabadora
+    OVRFW::ovrPerfHud perfHud;
 
 public:
 
@@ -240,6 +58,13 @@ public:
 
     virtual std::vector<const char*> GetExtensions() override {
         std::vector<const char*> extensions = XrApp::GetExtensions();
+        extensions.push_back(XR_EXT_HAND_TRACKING_EXTENSION_NAME);
+        // XrTime actual para el muestreo de poses; sin ella se graba solo a ritmo de frame
+#if defined(ANDROID)
+        extensions.push_back(XR_KHR_CONVERT_TIMESPEC_TIME_EXTENSION_NAME);
+#elif defined(WIN32)
+        extensions.push_back(XR_KHR_WIN32_CONVERT_PERFORMANCE_COUNTER_TIME_EXTENSION_NAME);
+#endif
         return extensions;
     }
 
@@ -254,6 +79,19 @@ public:
             return false;
         }
 
+        // Servidor de subida de las partes (HTTP plano, ver UploadQueue.h), junto a las
+        // grabaciones. Sin el se graba igual y las partes esperan en la cola de subida.
+        UploadQueue::Config upload;
+        if (UploadQueue::loadConfig(MovementRecorder::UPLOAD_CONFIG_FILE, upload)) {
+            ALOG("Uploading to %s:%u", upload.host.c_str(), upload.port);
+            recorder.startUploads(upload);
+        } else {
+            ALOG("No upload server in %s, uploads off", MovementRecorder::UPLOAD_CONFIG_FILE);
+        }
+
+        // Tiempos por fase para el panel de rendimiento
+        GetFrameTimer().SetEnabled(true);
+
         ALOG("VR Motion Recording started automatically");
         return true;
     }
@@ -273,13 +111,40 @@ public:
             return false;
         }
         cursorBeamRenderer_.Init(GetFileSys(), nullptr, OVR::Vector4f(1.0f), 1.0f);
+
+        // Hand tracking para la grabadora. Si el runtime no lo tiene se graba sin manos.
+        OXR(xrGetInstanceProcAddr(
+            GetInstance(),
+            "xrCreateHandTrackerEXT",
+            (PFN_xrVoidFunction*)(&xrCreateHandTrackerEXT_)));
+        OXR(xrGetInstanceProcAddr(
+            GetInstance(),
+            "xrDestroyHandTrackerEXT",
+            (PFN_xrVoidFunction*)(&xrDestroyHandTrackerEXT_)));
+        OXR(xrGetInstanceProcAddr(
+            GetInstance(),
+            "xrLocateHandJointsEXT",
+            (PFN_xrVoidFunction*)(&xrLocateHandJointsEXT_)));
+        if (xrCreateHandTrackerEXT_ != nullptr) {
+            XrHandTrackerCreateInfoEXT createInfo{XR_TYPE_HAND_TRACKER_CREATE_INFO_EXT};
+            createInfo.handJointSet = XR_HAND_JOINT_SET_DEFAULT_EXT;
+            createInfo.hand = XR_HAND_LEFT_EXT;
+            OXR(xrCreateHandTrackerEXT_(GetSession(), &createInfo, &handTrackerL_));
+            createInfo.hand = XR_HAND_RIGHT_EXT;
+            OXR(xrCreateHandTrackerEXT_(GetSession(), &createInfo, &handTrackerR_));
+        }
+
+        StartPoseSampler();
+        InitPerfHud();
         return true;
     }
 
     virtual void Update(const OVRFW::ovrApplFrameIn& in) override {
 
         // NUEVO: Grabar datos de movimiento cada frame automáticamente
-        recorder.recordFrame(in);
+        LocateHand(handTrackerL_, in, handJointsL_);
+        LocateHand(handTrackerR_, in, handJointsR_);
+        recorder.recordFrame(in, handJointsL_, handJointsR_);
 
         if(!labelCreado){
             //Se obtiene la matriz de pos de la cabeza y se le añade un offset
@@ -360,16 +225,45 @@ public:
         }
 
         cursorBeamRenderer_.Render(in, out);
+
+        // Hilo de GL; solo hace algo cuando toca refrescar el panel
+        perfHud.Update(GetFrameTimer(), GetSimulationTimer());
+    }
+
+    virtual void PostProjectionAddLayer(
+        OVRFW::XrApp::xrCompositorLayerUnion* layers,
+        int& layerCount) override {
+        perfHud.AddLayer(layers, layerCount);
     }
 
     virtual void SessionEnd() override {
+        // Antes del flush, para que las ultimas muestras entren en el
+        poseSampler.stop();
+        DestroySamplerSpaces();
+
+        // Lo grabado hasta aqui queda en disco aunque el proceso muera despues
+        recorder.flush();
+
+        if (xrDestroyHandTrackerEXT_ != nullptr) {
+            if (handTrackerL_ != XR_NULL_HANDLE) {
+                OXR(xrDestroyHandTrackerEXT_(handTrackerL_));
+                handTrackerL_ = XR_NULL_HANDLE;
+            }
+            if (handTrackerR_ != XR_NULL_HANDLE) {
+                OXR(xrDestroyHandTrackerEXT_(handTrackerR_));
+                handTrackerR_ = XR_NULL_HANDLE;
+            }
+        }
+
         controllerRenderL_.Shutdown();
         controllerRenderR_.Shutdown();
         cursorBeamRenderer_.Shutdown();
+        perfHud.Shutdown();
     }
 
     virtual void AppShutdown(const xrJava* context) override {
         // NUEVO: Finalizar la grabación cuando se cierre la app
+        poseSampler.stop();
         recorder.finalize();
         ALOG("VR Motion Recording finalized");
 
@@ -384,6 +278,176 @@ private:
 
     OVRFW::SimpleBeamRenderer cursorBeamRenderer_;
 
+    PFN_xrCreateHandTrackerEXT xrCreateHandTrackerEXT_ = nullptr;
+    PFN_xrDestroyHandTrackerEXT xrDestroyHandTrackerEXT_ = nullptr;
+    PFN_xrLocateHandJointsEXT xrLocateHandJointsEXT_ = nullptr;
+    XrHandTrackerEXT handTrackerL_ = XR_NULL_HANDLE;
+    XrHandTrackerEXT handTrackerR_ = XR_NULL_HANDLE;
+    XrHandJointLocationEXT jointLocations_[XR_HAND_JOINT_COUNT_EXT];
+    HandJoints handJointsL_;
+    HandJoints handJointsR_;
+
+    // Espacios propios del muestreador. Los del framework se destruyen antes de
+    // SessionEnd, cuando el hilo de muestreo aun puede estar usandolos.
+    XrSpace samplerBaseSpace_ = XR_NULL_HANDLE;
+    XrSpace samplerSpaces_[RECORDING_POSE_SOURCE_COUNT] = {};
+#if defined(ANDROID)
+    PFN_xrConvertTimespecTimeToTimeKHR xrConvertTimespecTimeToTimeKHR_ = nullptr;
+#elif defined(WIN32)
+    PFN_xrConvertWin32PerformanceCounterToTimeKHR xrConvertWin32PerformanceCounterToTimeKHR_ =
+        nullptr;
+#endif
+
+    // Panel fijo a la cabeza, abajo a la izquierda. Los valores de la grabadora son
+    // atomicos, leerlos no frena al hilo escritor ni al de subidas. Sin fuente no hay panel.
+    void InitPerfHud() {
+        if (!perfHud.Init(GetSession(), *GetFileSys(), GetSurfaceRender())) {
+            ALOGW("Perf HUD disabled");
+            return;
+        }
+        perfHud.GetOverlay().SetSpace(HeadSpace);
+        perfHud.GetOverlay().SetPose(
+            OVR::Posef(OVR::Quatf(), OVR::Vector3f(-0.35f, -0.3f, -1.5f)));
+        perfHud.GetOverlay().SetSize(0.3f, 0.15f);
+        perfHud.SetRefreshRate(2.0f);
+        perfHud.AddValue("Cola", [this]() { return double(recorder.getQueueDepth()); });
+        perfHud.AddValue("Descartados", [this]() { return double(recorder.getDroppedFrames()); });
+        perfHud.AddValue(
+            "Escrito",
+            [this]() { return double(recorder.getBytesWritten()); },
+            OVRFW::ovrPerfHud::VALUE_BYTES);
+        perfHud.AddValue(
+            "Subido",
+            [this]() { return double(recorder.getBytesUploaded()); },
+            OVRFW::ovrPerfHud::VALUE_BYTES);
+    }
+
+    // XrTime actual, o 0 si el runtime no puede convertir el reloj del sistema
+    XrTime GetXrTimeNow() {
+        XrTime time = 0;
+#if defined(ANDROID)
+        if (xrConvertTimespecTimeToTimeKHR_ != nullptr) {
+            timespec now;
+            clock_gettime(CLOCK_MONOTONIC, &now);
+            xrConvertTimespecTimeToTimeKHR_(GetInstance(), &now, &time);
+        }
+#elif defined(WIN32)
+        if (xrConvertWin32PerformanceCounterToTimeKHR_ != nullptr) {
+            LARGE_INTEGER now;
+            QueryPerformanceCounter(&now);
+            xrConvertWin32PerformanceCounterToTimeKHR_(GetInstance(), &now, &time);
+        }
+#endif
+        return time;
+    }
+
+    // Crea los espacios del muestreador y lo arranca. Si no hay forma de saber el XrTime
+    // actual no arranca y la grabacion sigue a ritmo de frame.
+    void StartPoseSampler() {
+#if defined(ANDROID)
+        xrGetInstanceProcAddr(
+            GetInstance(),
+            "xrConvertTimespecTimeToTimeKHR",
+            (PFN_xrVoidFunction*)(&xrConvertTimespecTimeToTimeKHR_));
+#elif defined(WIN32)
+        xrGetInstanceProcAddr(
+            GetInstance(),
+            "xrConvertWin32PerformanceCounterToTimeKHR",
+            (PFN_xrVoidFunction*)(&xrConvertWin32PerformanceCounterToTimeKHR_));
+#endif
+        if (GetXrTimeNow() == 0) {
+            ALOGW("PoseSampler disabled: the runtime cannot convert the system clock");
+            return;
+        }
+
+        // Mismo espacio base que las poses de ovrApplFrameIn
+        XrReferenceSpaceCreateInfo spaceInfo{XR_TYPE_REFERENCE_SPACE_CREATE_INFO};
+        spaceInfo.poseInReferenceSpace.orientation.w = 1.0f;
+        spaceInfo.referenceSpaceType = GetCurrentSpace() == GetStageSpace()
+            ? XR_REFERENCE_SPACE_TYPE_STAGE
+            : XR_REFERENCE_SPACE_TYPE_LOCAL;
+        OXR(xrCreateReferenceSpace(GetSession(), &spaceInfo, &samplerBaseSpace_));
+        spaceInfo.referenceSpaceType = XR_REFERENCE_SPACE_TYPE_VIEW;
+        OXR(xrCreateReferenceSpace(
+            GetSession(), &spaceInfo, &samplerSpaces_[RECORDING_POSE_SOURCE_HEAD]));
+        samplerSpaces_[RECORDING_POSE_SOURCE_LEFT_GRIP] =
+            CreateActionSpace(GripPoseAction, LeftHandPath);
+        samplerSpaces_[RECORDING_POSE_SOURCE_RIGHT_GRIP] =
+            CreateActionSpace(GripPoseAction, RightHandPath);
+        samplerSpaces_[RECORDING_POSE_SOURCE_LEFT_AIM] =
+            CreateActionSpace(AimPoseAction, LeftHandPath);
+        samplerSpaces_[RECORDING_POSE_SOURCE_RIGHT_AIM] =
+            CreateActionSpace(AimPoseAction, RightHandPath);
+
+        poseSampler.start(
+            PoseSamplerConfig(),
+            [this]() { return static_cast<int64_t>(GetXrTimeNow()); },
+            [this](RecordingPoseSource source, int64_t time, RecordingPoseSample& sample) {
+                return LocateSample(samplerSpaces_[source], time, sample);
+            });
+    }
+
+    void DestroySamplerSpaces() {
+        for (XrSpace& space : samplerSpaces_) {
+            if (space != XR_NULL_HANDLE) {
+                OXR(xrDestroySpace(space));
+                space = XR_NULL_HANDLE;
+            }
+        }
+        if (samplerBaseSpace_ != XR_NULL_HANDLE) {
+            OXR(xrDestroySpace(samplerBaseSpace_));
+            samplerBaseSpace_ = XR_NULL_HANDLE;
+        }
+    }
+
+    // Hilo de muestreo: pose y velocidades de un espacio en el instante pedido
+    bool LocateSample(XrSpace space, int64_t time, RecordingPoseSample& sample) {
+        XrSpaceVelocity velocity{XR_TYPE_SPACE_VELOCITY};
+        XrSpaceLocation location{XR_TYPE_SPACE_LOCATION};
+        location.next = &velocity;
+        if (XR_FAILED(xrLocateSpace(space, samplerBaseSpace_, time, &location))) {
+            return false;
+        }
+        const XrPosef& pose = location.pose;
+        const float p[7] = {
+            pose.position.x,
+            pose.position.y,
+            pose.position.z,
+            pose.orientation.x,
+            pose.orientation.y,
+            pose.orientation.z,
+            pose.orientation.w};
+        memcpy(sample.pose, p, sizeof(p));
+        const float linear[3] = {
+            velocity.linearVelocity.x, velocity.linearVelocity.y, velocity.linearVelocity.z};
+        const float angular[3] = {
+            velocity.angularVelocity.x, velocity.angularVelocity.y, velocity.angularVelocity.z};
+        memcpy(sample.linearVelocity, linear, sizeof(linear));
+        memcpy(sample.angularVelocity, angular, sizeof(angular));
+        sample.flags = static_cast<uint8_t>(
+            (location.locationFlags & 0xF) | ((velocity.velocityFlags & 0x3) << 4));
+        return true;
+    }
+
+    // Localiza las articulaciones de una mano en el mismo espacio que HeadPose
+    void LocateHand(XrHandTrackerEXT tracker, const OVRFW::ovrApplFrameIn& in, HandJoints& out) {
+        if (tracker == XR_NULL_HANDLE) {
+            out.clear();
+            return;
+        }
+        XrHandJointLocationsEXT locations{XR_TYPE_HAND_JOINT_LOCATIONS_EXT};
+        locations.jointCount = XR_HAND_JOINT_COUNT_EXT;
+        locations.jointLocations = jointLocations_;
+        XrHandJointsLocateInfoEXT locateInfo{XR_TYPE_HAND_JOINTS_LOCATE_INFO_EXT};
+        locateInfo.baseSpace = GetCurrentSpace();
+        locateInfo.time = ToXrTime(in.PredictedDisplayTime);
+        if (XR_FAILED(xrLocateHandJointsEXT_(tracker, &locateInfo, &locations))) {
+            out.clear();
+            return;
+        }
+        out.set(locations.isActive == XR_TRUE, jointLocations_);
+    }
+
     void ToggleTextoVisibilidad() {
         if (holaMundoLabel != nullptr) {
             labelVisible = !labelVisible;
@@ -0,0 +1,273 @@
+#include "LoopbackUploadServer.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace {
+
+const int POLL_MS = 20; // cada cuanto se mira stopRequested
+const size_t MAX_HEADER_BYTES = 64 * 1024;
+
+std::string toLower(std::string s) {
+    std::transform(s.begin(), s.end(), s.begin(), [](unsigned char c) {
+        return static_cast<char>(std::tolower(c));
+    });
+    return s;
+}
+
+std::string trim(const std::string& s) {
+    const size_t begin = s.find_first_not_of(" \t");
+    if (begin == std::string::npos) {
+        return std::string();
+    }
+    const size_t end = s.find_last_not_of(" \t\r");
+    return s.substr(begin, end - begin + 1);
+}
+
+} // namespace
+
+LoopbackUploadServer::~LoopbackUploadServer() {
+    stop();
+}
+
+bool LoopbackUploadServer::start() {
+    listenFd = socket(AF_INET, SOCK_STREAM, 0);
+    if (listenFd < 0) {
+        return false;
+    }
+    const int reuse = 1;
+    setsockopt(listenFd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+    sockaddr_in address = {};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port = 0;
+    socklen_t length = sizeof(address);
+    if (bind(listenFd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+        listen(listenFd, 8) != 0 ||
+        getsockname(listenFd, reinterpret_cast<sockaddr*>(&address), &length) != 0) {
+        ::close(listenFd);
+        listenFd = -1;
+        return false;
+    }
+    port = ntohs(address.sin_port);
+    stopRequested = false;
+    thread = std::thread(&LoopbackUploadServer::acceptLoop, this);
+    return true;
+}
+
+void LoopbackUploadServer::stop() {
+    stopRequested = true;
+    if (thread.joinable()) {
+        thread.join();
+    }
+    if (listenFd >= 0) {
+        ::close(listenFd);
+        listenFd = -1;
+    }
+}
+
+void LoopbackUploadServer::setFaults(const Faults& newFaults) {
+    std::lock_guard<std::mutex> lock(mutex);
+    faults = newFaults;
+}
+
+void LoopbackUploadServer::setFile(const std::string& name, const std::string& data) {
+    std::lock_guard<std::mutex> lock(mutex);
+    files[name] = data;
+}
+
+std::string LoopbackUploadServer::getFile(const std::string& name) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    const auto it = files.find(name);
+    return it != files.end() ? it->second : std::string();
+}
+
+bool LoopbackUploadServer::hasFile(const std::string& name) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return files.count(name) != 0;
+}
+
+LoopbackUploadServer::Stats LoopbackUploadServer::getStats() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return stats;
+}
+
+void LoopbackUploadServer::acceptLoop() {
+    while (!stopRequested) {
+        pollfd p = {listenFd, POLLIN, 0};
+        if (poll(&p, 1, POLL_MS) <= 0) {
+            continue;
+        }
+        const int fd = accept(listenFd, nullptr, nullptr);
+        if (fd < 0) {
+            continue;
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stats.connections++;
+        }
+        serveConnection(fd);
+        ::close(fd);
+    }
+}
+
+void LoopbackUploadServer::serveConnection(int fd) {
+    std::string buffer;
+    while (!stopRequested && serveRequest(fd, buffer)) {
+    }
+}
+
+bool LoopbackUploadServer::readAtLeast(int fd, std::string& buffer, size_t size) {
+    char block[16 * 1024];
+    while (buffer.size() < size) {
+        pollfd p = {fd, POLLIN, 0};
+        const int ready = poll(&p, 1, POLL_MS);
+        if (stopRequested) {
+            return false;
+        }
+        if (ready <= 0) {
+            continue;
+        }
+        const ssize_t received = recv(fd, block, sizeof(block), 0);
+        if (received <= 0) {
+            return false;
+        }
+        buffer.append(block, static_cast<size_t>(received));
+    }
+    return true;
+}
+
+bool LoopbackUploadServer::sendResponse(
+    int fd,
+    int status,
+    const char* reason,
+    int64_t uploadOffset) {
+    char head[256];
+    int length = snprintf(head, sizeof(head), "HTTP/1.1 %d %s\r\n", status, reason);
+    if (uploadOffset >= 0) {
+        length += snprintf(
+            head + length,
+            sizeof(head) - length,
+            "Upload-Offset: %lld\r\n",
+            static_cast<long long>(uploadOffset));
+    }
+    length += snprintf(head + length, sizeof(head) - length, "Content-Length: 0\r\n\r\n");
+    return send(fd, head, static_cast<size_t>(length), MSG_NOSIGNAL) == length;
+}
+
+bool LoopbackUploadServer::serveRequest(int fd, std::string& buffer) {
+    size_t headerEnd;
+    while ((headerEnd = buffer.find("\r\n\r\n")) == std::string::npos) {
+        if (buffer.size() > MAX_HEADER_BYTES || !readAtLeast(fd, buffer, buffer.size() + 1)) {
+            return false;
+        }
+    }
+    const std::string head = buffer.substr(0, headerEnd + 2);
+    buffer.erase(0, headerEnd + 4);
+
+    // "PATCH /upload/nombre HTTP/1.1"
+    size_t lineEnd = head.find("\r\n");
+    const std::string requestLine = head.substr(0, lineEnd);
+    const size_t methodEnd = requestLine.find(' ');
+    const size_t pathEnd = requestLine.find(' ', methodEnd + 1);
+    if (methodEnd == std::string::npos || pathEnd == std::string::npos) {
+        return false;
+    }
+    const std::string method = requestLine.substr(0, methodEnd);
+    const std::string path = requestLine.substr(methodEnd + 1, pathEnd - methodEnd - 1);
+    const std::string name = path.substr(path.find_last_of('/') + 1);
+
+    std::map<std::string, std::string> headers;
+    size_t lineStart = lineEnd + 2;
+    while (lineStart < head.size()) {
+        lineEnd = head.find("\r\n", lineStart);
+        const std::string line = head.substr(lineStart, lineEnd - lineStart);
+        lineStart = lineEnd + 2;
+        const size_t colon = line.find(':');
+        if (colon != std::string::npos) {
+            headers[toLower(trim(line.substr(0, colon)))] = trim(line.substr(colon + 1));
+        }
+    }
+    const size_t contentLength = strtoull(headers["content-length"].c_str(), nullptr, 10);
+
+    if (method == "HEAD") {
+        int64_t offset = -1;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stats.heads++;
+            const auto it = files.find(name);
+            if (it != files.end()) {
+                offset = static_cast<int64_t>(it->second.size());
+            }
+            if (faults.staleHeadCount > 0) {
+                faults.staleHeadCount--;
+                offset = static_cast<int64_t>(faults.staleHeadOffset);
+            }
+        }
+        return offset < 0 ? sendResponse(fd, 404, "Not Found", -1)
+                          : sendResponse(fd, 200, "OK", offset);
+    }
+
+    if (method != "PATCH") {
+        if (!readAtLeast(fd, buffer, contentLength)) {
+            return false;
+        }
+        buffer.erase(0, contentLength);
+        return sendResponse(fd, 405, "Method Not Allowed", -1);
+    }
+
+    const uint64_t offset = strtoull(headers["upload-offset"].c_str(), nullptr, 10);
+    size_t dropAfter = 0;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stats.patches++;
+        stats.patchOffsets.push_back(offset);
+        if (faults.dropCount > 0 && faults.dropAfterBodyBytes > 0 &&
+            faults.dropAfterBodyBytes < contentLength) {
+            faults.dropCount--;
+            dropAfter = faults.dropAfterBodyBytes;
+        }
+    }
+
+    if (dropAfter > 0) {
+        // Lo recibido se guarda, como haria un servidor tus, y se corta sin responder
+        readAtLeast(fd, buffer, dropAfter);
+        std::lock_guard<std::mutex> lock(mutex);
+        std::string& file = files[name];
+        if (file.size() == offset) {
+            file.append(buffer, 0, std::min(dropAfter, buffer.size()));
+        }
+        stats.drops++;
+        buffer.clear();
+        return false;
+    }
+
+    if (!readAtLeast(fd, buffer, contentLength)) {
+        return false;
+    }
+    int64_t newOffset;
+    bool conflict;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        std::string& file = files[name];
+        conflict = file.size() != offset;
+        if (conflict) {
+            stats.conflicts++;
+        } else {
+            file.append(buffer, 0, contentLength);
+        }
+        newOffset = static_cast<int64_t>(file.size());
+    }
+    buffer.erase(0, contentLength);
+    return conflict ? sendResponse(fd, 409, "Conflict", newOffset)
+                    : sendResponse(fd, 204, "No Content", newOffset);
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/*
+    Servidor de subidas de prueba en 127.0.0.1 que habla el protocolo de UploadQueue
+    (ver Recorder/UploadQueue.h):
+
+        HEAD  /<prefijo>/<nombre>   -> 200 + Upload-Offset, o 404 si no tiene nada
+        PATCH /<prefijo>/<nombre>   -> 204 + Upload-Offset nuevo si Upload-Offset coincide
+                                    -> 409 + Upload-Offset real si no
+
+    Guarda los ficheros en memoria por nombre (lo que va detras de la ultima '/'). Atiende
+    una conexion cada vez desde su propio hilo, con keep-alive, que es como la usa el cliente.
+
+    Para las pruebas se le pueden inyectar fallos (Faults): cortar la conexion a mitad del
+    cuerpo de un PATCH, guardando lo que llego como haria un servidor tus, o contestar a HEAD
+    con un offset viejo para provocar un 409.
+
+    Solo POSIX: las pruebas solo se compilan en Linux.
+*/
+class LoopbackUploadServer {
+public:
+    struct Faults {
+        // Cierra la conexion tras recibir tantos bytes del cuerpo de un PATCH, las proximas
+        // dropCount veces. 0 = nunca.
+        size_t dropAfterBodyBytes = 0;
+        int dropCount = 0;
+        // Los proximos staleHeadCount HEAD contestan staleHeadOffset en vez del offset real
+        int staleHeadCount = 0;
+        uint64_t staleHeadOffset = 0;
+    };
+
+    struct Stats {
+        uint32_t connections = 0;
+        uint32_t heads = 0;
+        uint32_t patches = 0;
+        uint32_t conflicts = 0; // respuestas 409
+        uint32_t drops = 0; // conexiones cortadas por Faults
+        std::vector<uint64_t> patchOffsets; // Upload-Offset de cada PATCH recibido
+    };
+
+    LoopbackUploadServer() = default;
+    ~LoopbackUploadServer();
+
+    LoopbackUploadServer(const LoopbackUploadServer&) = delete;
+    LoopbackUploadServer& operator=(const LoopbackUploadServer&) = delete;
+
+    // Escucha en un puerto libre de 127.0.0.1
+    bool start();
+    void stop();
+    uint16_t getPort() const { return port; }
+
+    void setFaults(const Faults& faults);
+    // Precarga un fichero, p.ej. lo que dejo un PATCH anterior a medias
+    void setFile(const std::string& name, const std::string& data);
+    std::string getFile(const std::string& name) const;
+    bool hasFile(const std::string& name) const;
+    Stats getStats() const;
+
+private:
+    void acceptLoop();
+    void serveConnection(int fd);
+    // Devuelve false si hay que cerrar la conexion
+    bool serveRequest(int fd, std::string& buffer);
+    // Lee hasta tener al menos size bytes en buffer. false si se cierra o se para.
+    bool readAtLeast(int fd, std::string& buffer, size_t size);
+    bool sendResponse(int fd, int status, const char* reason, int64_t uploadOffset);
+
+    int listenFd = -1;
+    uint16_t port = 0;
+    std::atomic<bool> stopRequested{false};
+    std::thread thread;
+
+    mutable std::mutex mutex;
+    std::map<std::string, std::string> files;
+    Faults faults;
+    Stats stats;
+};
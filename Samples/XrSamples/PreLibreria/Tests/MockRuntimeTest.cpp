@@ -0,0 +1,705 @@
+// Prueba de humo del runtime falso (Tools/MockRuntime), sin loader:
+//
+//   prelibreria_mock_runtime_test <libprelibreria_mock_runtime.so> [serial|pipelined]
+//
+// Carga la libreria, negocia con ella como el loader y hace lo mismo que XrApp::MainLoop en
+// cada frame: eventos, xrWaitFrame, xrBeginFrame, xrLocateSpacesKHR, xrLocateViews,
+// xrSyncActions, una imagen de swapchain por ojo y xrEndFrame con una capa de proyeccion.
+// El runtime corre sin esperar al vsync (MOCKXR_FREE_RUN) y pide salir tras FRAME_COUNT
+// frames: la sesion tiene que pasar por STOPPING, xrEndSession, IDLE y EXITING.
+//
+//   serial     un solo hilo, en el orden de XrApp sin pipeline
+//   pipelined  como XrApp con SetFramePipelineDepth(2): xrWaitFrame, vistas y mandos en un
+//              hilo de simulacion, el resto en este, con OVRFW::ovrFramePipeline entre ambos
+//
+// En los dos casos el informe del runtime (MOCKXR_STATS) tiene que medir el tiempo de
+// todos los frames terminados, tambien con varios frames esperados a la vez.
+//
+// XrApp solo se compila para Android y Windows; en Windows Tests/XrAppSmokeTest.cpp corre
+// el MainLoop de verdad contra el mismo runtime.
+//
+// Sale con codigo 1 si algo falla.
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <dlfcn.h>
+#include <unistd.h>
+
+#define XR_USE_GRAPHICS_API_OPENGL 1
+#include <openxr/openxr.h>
+#include <openxr/openxr_loader_negotiation.h>
+#include <openxr/openxr_platform.h>
+
+#include "Misc/FramePipeline.h"
+
+namespace fs = std::filesystem;
+
+namespace {
+
+const int FRAME_COUNT = 120;
+const int PIPELINE_DEPTH = 2;
+const uint32_t EYE_COUNT = 2;
+const int64_t SWAPCHAIN_FORMAT = 0x8C43; // GL_SRGB8_ALPHA8
+
+std::atomic<int> failures{0}; // el caso pipelined comprueba desde dos hilos
+
+void check(bool condition, const char* test, const char* what) {
+    if (!condition) {
+        printf("FAIL %s: %s\n", test, what);
+        failures++;
+    }
+}
+
+// Funciones que se piden a xrGetInstanceProcAddr una vez creada la instancia
+#define MOCK_TEST_FUNCTIONS(F)              \
+    F(xrDestroyInstance)                    \
+    F(xrPollEvent)                          \
+    F(xrGetSystem)                          \
+    F(xrCreateSession)                      \
+    F(xrDestroySession)                     \
+    F(xrBeginSession)                       \
+    F(xrEndSession)                         \
+    F(xrCreateReferenceSpace)               \
+    F(xrCreateActionSpace)                  \
+    F(xrLocateSpacesKHR)                    \
+    F(xrDestroySpace)                       \
+    F(xrEnumerateViewConfigurationViews)    \
+    F(xrCreateSwapchain)                    \
+    F(xrDestroySwapchain)                   \
+    F(xrEnumerateSwapchainImages)           \
+    F(xrAcquireSwapchainImage)              \
+    F(xrWaitSwapchainImage)                 \
+    F(xrReleaseSwapchainImage)              \
+    F(xrWaitFrame)                          \
+    F(xrBeginFrame)                         \
+    F(xrEndFrame)                           \
+    F(xrLocateViews)                        \
+    F(xrStringToPath)                       \
+    F(xrCreateActionSet)                    \
+    F(xrDestroyActionSet)                   \
+    F(xrCreateAction)                       \
+    F(xrSuggestInteractionProfileBindings)  \
+    F(xrAttachSessionActionSets)            \
+    F(xrGetActionStateFloat)                \
+    F(xrSyncActions)
+
+// La libreria del runtime y sus funciones, como las ve el loader
+struct Runtime {
+    void* library = nullptr;
+    PFN_xrGetInstanceProcAddr xrGetInstanceProcAddr = nullptr;
+    PFN_xrCreateInstance xrCreateInstance = nullptr;
+#define MOCK_TEST_DECLARE(name) PFN_##name name = nullptr;
+    MOCK_TEST_FUNCTIONS(MOCK_TEST_DECLARE)
+#undef MOCK_TEST_DECLARE
+
+    ~Runtime() {
+        if (library != nullptr) {
+            dlclose(library);
+        }
+    }
+
+    template <typename Function>
+    bool load(XrInstance instance, const char* name, Function& function) {
+        PFN_xrVoidFunction voidFunction = nullptr;
+        if (XR_FAILED(xrGetInstanceProcAddr(instance, name, &voidFunction))) {
+            printf("missing %s\n", name);
+            return false;
+        }
+        function = reinterpret_cast<Function>(voidFunction);
+        return function != nullptr;
+    }
+
+    bool open(const char* filename) {
+        library = dlopen(filename, RTLD_NOW | RTLD_LOCAL);
+        if (library == nullptr) {
+            printf("%s\n", dlerror());
+            return false;
+        }
+        PFN_xrNegotiateLoaderRuntimeInterface negotiate =
+            reinterpret_cast<PFN_xrNegotiateLoaderRuntimeInterface>(
+                dlsym(library, "xrNegotiateLoaderRuntimeInterface"));
+        if (negotiate == nullptr) {
+            return false;
+        }
+        XrNegotiateLoaderInfo loaderInfo = {};
+        loaderInfo.structType = XR_LOADER_INTERFACE_STRUCT_LOADER_INFO;
+        loaderInfo.structVersion = XR_LOADER_INFO_STRUCT_VERSION;
+        loaderInfo.structSize = sizeof(loaderInfo);
+        loaderInfo.minInterfaceVersion = 1;
+        loaderInfo.maxInterfaceVersion = XR_CURRENT_LOADER_RUNTIME_VERSION;
+        loaderInfo.minApiVersion = XR_MAKE_VERSION(1, 0, 0);
+        loaderInfo.maxApiVersion = XR_MAKE_VERSION(1, 0x3ff, 0xfff);
+        XrNegotiateRuntimeRequest request = {};
+        request.structType = XR_LOADER_INTERFACE_STRUCT_RUNTIME_REQUEST;
+        request.structVersion = XR_RUNTIME_INFO_STRUCT_VERSION;
+        request.structSize = sizeof(request);
+        if (XR_FAILED(negotiate(&loaderInfo, &request)) || request.getInstanceProcAddr == nullptr) {
+            return false;
+        }
+        xrGetInstanceProcAddr = request.getInstanceProcAddr;
+        return load(XR_NULL_HANDLE, "xrCreateInstance", xrCreateInstance);
+    }
+
+    bool loadAll(XrInstance instance) {
+        bool ok = true;
+#define MOCK_TEST_LOAD(name) ok = load(instance, #name, name) && ok;
+        MOCK_TEST_FUNCTIONS(MOCK_TEST_LOAD)
+#undef MOCK_TEST_LOAD
+        return ok;
+    }
+};
+
+// Lo que pasa de la simulacion al render en un frame, como ovrFramePacket en XrApp
+struct FramePacket {
+    XrFrameState frameState = {XR_TYPE_FRAME_STATE};
+    XrView views[EYE_COUNT] = {{XR_TYPE_VIEW}, {XR_TYPE_VIEW}};
+};
+
+// Lo minimo de XrApp: instancia, sesion, espacios de cabeza y mandos, una accion por
+// mano y una swapchain por ojo
+class MiniApp {
+public:
+    MiniApp(Runtime& runtime, const char* testName) : xr(runtime), test(testName) {}
+
+    ~MiniApp() {
+        for (XrSwapchain swapchain : swapchains) {
+            if (swapchain != XR_NULL_HANDLE) {
+                xr.xrDestroySwapchain(swapchain);
+            }
+        }
+        for (XrSpace space : spaces) {
+            xr.xrDestroySpace(space);
+        }
+        if (actionSet != XR_NULL_HANDLE) {
+            xr.xrDestroyActionSet(actionSet);
+        }
+        if (session != XR_NULL_HANDLE) {
+            check(XR_SUCCEEDED(xr.xrDestroySession(session)), test, "xrDestroySession failed");
+        }
+        if (instance != XR_NULL_HANDLE) {
+            check(XR_SUCCEEDED(xr.xrDestroyInstance(instance)), test, "xrDestroyInstance failed");
+        }
+    }
+
+    // Hasta tener la sesion en FOCUSED con todo creado
+    bool start() {
+        const char* extensions[] = {
+            XR_KHR_OPENGL_ENABLE_EXTENSION_NAME, XR_KHR_LOCATE_SPACES_EXTENSION_NAME};
+        XrInstanceCreateInfo instanceInfo = {XR_TYPE_INSTANCE_CREATE_INFO};
+        strcpy(instanceInfo.applicationInfo.applicationName, "prelibreria_mock_runtime_test");
+        instanceInfo.applicationInfo.apiVersion = XR_MAKE_VERSION(1, 0, 0);
+        instanceInfo.enabledExtensionCount = 2;
+        instanceInfo.enabledExtensionNames = extensions;
+        if (XR_FAILED(xr.xrCreateInstance(&instanceInfo, &instance)) || !xr.loadAll(instance)) {
+            check(false, test, "could not create the instance");
+            return false;
+        }
+
+        XrSystemGetInfo systemInfo = {XR_TYPE_SYSTEM_GET_INFO};
+        systemInfo.formFactor = XR_FORM_FACTOR_HEAD_MOUNTED_DISPLAY;
+        XrSystemId systemId = XR_NULL_SYSTEM_ID;
+        if (XR_FAILED(xr.xrGetSystem(instance, &systemInfo, &systemId))) {
+            check(false, test, "xrGetSystem failed");
+            return false;
+        }
+        // El runtime falso no mira el binding de graficos
+        XrSessionCreateInfo sessionInfo = {XR_TYPE_SESSION_CREATE_INFO};
+        sessionInfo.systemId = systemId;
+        if (XR_FAILED(xr.xrCreateSession(instance, &sessionInfo, &session))) {
+            check(false, test, "could not create the session");
+            return false;
+        }
+        pollEvents();
+        check(state == XR_SESSION_STATE_READY, test, "session did not get to READY");
+
+        XrSessionBeginInfo beginInfo = {XR_TYPE_SESSION_BEGIN_INFO};
+        beginInfo.primaryViewConfigurationType = XR_VIEW_CONFIGURATION_TYPE_PRIMARY_STEREO;
+        if (XR_FAILED(xr.xrBeginSession(session, &beginInfo))) {
+            check(false, test, "xrBeginSession failed");
+            return false;
+        }
+        pollEvents();
+        check(state == XR_SESSION_STATE_FOCUSED, test, "session did not get to FOCUSED");
+
+        return createSpacesAndActions() && createSwapchains();
+    }
+
+    void pollEvents() {
+        XrEventDataBuffer event = {XR_TYPE_EVENT_DATA_BUFFER};
+        while (xr.xrPollEvent(instance, &event) == XR_SUCCESS) {
+            if (event.type == XR_TYPE_EVENT_DATA_SESSION_STATE_CHANGED) {
+                const XrEventDataSessionStateChanged& changed =
+                    *reinterpret_cast<const XrEventDataSessionStateChanged*>(&event);
+                check(changed.session == session, test, "event for another session");
+                state = changed.state;
+                states.push_back(changed.state);
+            }
+            event = {XR_TYPE_EVENT_DATA_BUFFER};
+        }
+    }
+
+    bool waitFrame(FramePacket& packet) {
+        XrFrameWaitInfo waitInfo = {XR_TYPE_FRAME_WAIT_INFO};
+        packet.frameState = {XR_TYPE_FRAME_STATE};
+        return XR_SUCCEEDED(xr.xrWaitFrame(session, &waitInfo, &packet.frameState));
+    }
+
+    // Lo que hace XrApp::SimulateFrame con el runtime
+    void simulateFrame(FramePacket& packet) {
+        const XrTime displayTime = packet.frameState.predictedDisplayTime;
+
+        XrSpaceLocationData locationData[3] = {};
+        XrSpacesLocateInfo locateInfo = {XR_TYPE_SPACES_LOCATE_INFO};
+        locateInfo.baseSpace = localSpace;
+        locateInfo.time = displayTime;
+        locateInfo.spaceCount = 3;
+        locateInfo.spaces = spaces.data() + 1; // cabeza y mandos
+        XrSpaceLocations locations = {XR_TYPE_SPACE_LOCATIONS};
+        locations.locationCount = 3;
+        locations.locations = locationData;
+        check(XR_SUCCEEDED(xr.xrLocateSpacesKHR(session, &locateInfo, &locations)), test,
+              "xrLocateSpacesKHR failed");
+        check((locationData[0].locationFlags & XR_SPACE_LOCATION_ORIENTATION_VALID_BIT) != 0,
+              test, "head not located");
+
+        XrViewLocateInfo viewInfo = {XR_TYPE_VIEW_LOCATE_INFO};
+        viewInfo.viewConfigurationType = XR_VIEW_CONFIGURATION_TYPE_PRIMARY_STEREO;
+        viewInfo.displayTime = displayTime;
+        viewInfo.space = viewSpace;
+        XrViewState viewState = {XR_TYPE_VIEW_STATE};
+        uint32_t viewCount = 0;
+        check(XR_SUCCEEDED(xr.xrLocateViews(
+                  session, &viewInfo, &viewState, EYE_COUNT, &viewCount, packet.views)) &&
+                  viewCount == EYE_COUNT,
+              test, "xrLocateViews failed");
+        check((viewState.viewStateFlags & XR_VIEW_STATE_POSITION_VALID_BIT) != 0 &&
+                  packet.views[0].pose.position.x < packet.views[1].pose.position.x,
+              test, "views not located");
+
+        const XrActiveActionSet active = {actionSet, XR_NULL_PATH};
+        XrActionsSyncInfo syncInfo = {XR_TYPE_ACTIONS_SYNC_INFO};
+        syncInfo.countActiveActionSets = 1;
+        syncInfo.activeActionSets = &active;
+        check(xr.xrSyncActions(session, &syncInfo) == XR_SUCCESS, test, "xrSyncActions failed");
+        XrActionStateGetInfo getInfo = {XR_TYPE_ACTION_STATE_GET_INFO};
+        getInfo.action = triggerAction;
+        getInfo.subactionPath = handPaths[1];
+        XrActionStateFloat trigger = {XR_TYPE_ACTION_STATE_FLOAT};
+        check(XR_SUCCEEDED(xr.xrGetActionStateFloat(session, &getInfo, &trigger)) &&
+                  trigger.isActive,
+              test, "trigger not bound");
+    }
+
+    bool beginFrame() {
+        XrFrameBeginInfo beginInfo = {XR_TYPE_FRAME_BEGIN_INFO};
+        return xr.xrBeginFrame(session, &beginInfo) == XR_SUCCESS;
+    }
+
+    // Lo que hace XrApp::RenderFramePacket con el runtime: un ojo por swapchain y la capa
+    // de proyeccion con las vistas y el tiempo del paquete
+    bool renderFrame(const FramePacket& packet) {
+        XrCompositionLayerProjectionView projectionViews[EYE_COUNT] = {};
+        for (uint32_t eye = 0; eye < EYE_COUNT; eye++) {
+            uint32_t index = 0;
+            XrSwapchainImageAcquireInfo acquireInfo = {XR_TYPE_SWAPCHAIN_IMAGE_ACQUIRE_INFO};
+            XrSwapchainImageWaitInfo waitInfo = {XR_TYPE_SWAPCHAIN_IMAGE_WAIT_INFO};
+            waitInfo.timeout = XR_INFINITE_DURATION;
+            XrSwapchainImageReleaseInfo releaseInfo = {XR_TYPE_SWAPCHAIN_IMAGE_RELEASE_INFO};
+            if (XR_FAILED(xr.xrAcquireSwapchainImage(swapchains[eye], &acquireInfo, &index)) ||
+                XR_FAILED(xr.xrWaitSwapchainImage(swapchains[eye], &waitInfo)) ||
+                XR_FAILED(xr.xrReleaseSwapchainImage(swapchains[eye], &releaseInfo))) {
+                return false;
+            }
+            projectionViews[eye] = {XR_TYPE_COMPOSITION_LAYER_PROJECTION_VIEW};
+            projectionViews[eye].pose = packet.views[eye].pose;
+            projectionViews[eye].fov = packet.views[eye].fov;
+            projectionViews[eye].subImage.swapchain = swapchains[eye];
+            projectionViews[eye].subImage.imageRect.extent = {
+                static_cast<int32_t>(eyeWidth), static_cast<int32_t>(eyeHeight)};
+        }
+        XrCompositionLayerProjection projection = {XR_TYPE_COMPOSITION_LAYER_PROJECTION};
+        projection.space = viewSpace;
+        projection.viewCount = EYE_COUNT;
+        projection.views = projectionViews;
+        const XrCompositionLayerBaseHeader* layers[] = {
+            reinterpret_cast<const XrCompositionLayerBaseHeader*>(&projection)};
+        return endFrame(packet, layers, 1);
+    }
+
+    // Como XrApp::StopSimulationThread con los frames que ya se esperaron
+    bool endFrameWithoutLayers(const FramePacket& packet) {
+        return endFrame(packet, nullptr, 0);
+    }
+
+    bool endSession() {
+        return XR_SUCCEEDED(xr.xrEndSession(session));
+    }
+
+    XrSessionState getState() const {
+        return state;
+    }
+    const std::vector<XrSessionState>& getStates() const {
+        return states;
+    }
+
+private:
+    bool endFrame(
+        const FramePacket& packet,
+        const XrCompositionLayerBaseHeader* const* layers,
+        uint32_t layerCount) {
+        XrFrameEndInfo endInfo = {XR_TYPE_FRAME_END_INFO};
+        endInfo.displayTime = packet.frameState.predictedDisplayTime;
+        endInfo.environmentBlendMode = XR_ENVIRONMENT_BLEND_MODE_OPAQUE;
+        endInfo.layerCount = layerCount;
+        endInfo.layers = layers;
+        return xr.xrEndFrame(session, &endInfo) == XR_SUCCESS;
+    }
+
+    bool createSpacesAndActions() {
+        XrReferenceSpaceCreateInfo spaceInfo = {XR_TYPE_REFERENCE_SPACE_CREATE_INFO};
+        spaceInfo.poseInReferenceSpace.orientation.w = 1.0f;
+        spaceInfo.referenceSpaceType = XR_REFERENCE_SPACE_TYPE_LOCAL;
+        bool ok = XR_SUCCEEDED(xr.xrCreateReferenceSpace(session, &spaceInfo, &localSpace));
+        spaceInfo.referenceSpaceType = XR_REFERENCE_SPACE_TYPE_VIEW;
+        ok = ok && XR_SUCCEEDED(xr.xrCreateReferenceSpace(session, &spaceInfo, &viewSpace));
+        spaces = {localSpace, viewSpace};
+
+        ok = ok && XR_SUCCEEDED(xr.xrStringToPath(instance, "/user/hand/left", &handPaths[0])) &&
+            XR_SUCCEEDED(xr.xrStringToPath(instance, "/user/hand/right", &handPaths[1]));
+        XrActionSetCreateInfo setInfo = {XR_TYPE_ACTION_SET_CREATE_INFO};
+        strcpy(setInfo.actionSetName, "test");
+        strcpy(setInfo.localizedActionSetName, "test");
+        ok = ok && XR_SUCCEEDED(xr.xrCreateActionSet(instance, &setInfo, &actionSet));
+
+        XrActionCreateInfo actionInfo = {XR_TYPE_ACTION_CREATE_INFO};
+        actionInfo.countSubactionPaths = 2;
+        actionInfo.subactionPaths = handPaths;
+        actionInfo.actionType = XR_ACTION_TYPE_POSE_INPUT;
+        strcpy(actionInfo.actionName, "aim");
+        strcpy(actionInfo.localizedActionName, "aim");
+        ok = ok && XR_SUCCEEDED(xr.xrCreateAction(actionSet, &actionInfo, &aimAction));
+        actionInfo.actionType = XR_ACTION_TYPE_FLOAT_INPUT;
+        strcpy(actionInfo.actionName, "trigger");
+        strcpy(actionInfo.localizedActionName, "trigger");
+        ok = ok && XR_SUCCEEDED(xr.xrCreateAction(actionSet, &actionInfo, &triggerAction));
+        if (!ok) {
+            check(false, test, "could not create spaces and actions");
+            return false;
+        }
+
+        const char* bindingPaths[] = {
+            "/user/hand/left/input/aim/pose",
+            "/user/hand/right/input/aim/pose",
+            "/user/hand/left/input/trigger/value",
+            "/user/hand/right/input/trigger/value"};
+        XrActionSuggestedBinding bindings[4];
+        for (int i = 0; i < 4; i++) {
+            bindings[i].action = i < 2 ? aimAction : triggerAction;
+            ok = ok &&
+                XR_SUCCEEDED(xr.xrStringToPath(instance, bindingPaths[i], &bindings[i].binding));
+        }
+        XrInteractionProfileSuggestedBinding suggested = {
+            XR_TYPE_INTERACTION_PROFILE_SUGGESTED_BINDING};
+        ok = ok &&
+            XR_SUCCEEDED(xr.xrStringToPath(
+                instance,
+                "/interaction_profiles/oculus/touch_controller",
+                &suggested.interactionProfile));
+        suggested.countSuggestedBindings = 4;
+        suggested.suggestedBindings = bindings;
+        ok = ok && XR_SUCCEEDED(xr.xrSuggestInteractionProfileBindings(instance, &suggested));
+
+        XrSessionActionSetsAttachInfo attachInfo = {XR_TYPE_SESSION_ACTION_SETS_ATTACH_INFO};
+        attachInfo.countActionSets = 1;
+        attachInfo.actionSets = &actionSet;
+        ok = ok && XR_SUCCEEDED(xr.xrAttachSessionActionSets(session, &attachInfo));
+
+        for (int hand = 0; hand < 2 && ok; hand++) {
+            XrActionSpaceCreateInfo actionSpaceInfo = {XR_TYPE_ACTION_SPACE_CREATE_INFO};
+            actionSpaceInfo.action = aimAction;
+            actionSpaceInfo.subactionPath = handPaths[hand];
+            actionSpaceInfo.poseInActionSpace.orientation.w = 1.0f;
+            XrSpace handSpace = XR_NULL_HANDLE;
+            ok = XR_SUCCEEDED(xr.xrCreateActionSpace(session, &actionSpaceInfo, &handSpace));
+            spaces.push_back(handSpace);
+        }
+        check(ok, test, "could not bind the controllers");
+        return ok;
+    }
+
+    bool createSwapchains() {
+        XrViewConfigurationView configViews[EYE_COUNT] = {
+            {XR_TYPE_VIEW_CONFIGURATION_VIEW}, {XR_TYPE_VIEW_CONFIGURATION_VIEW}};
+        uint32_t viewCount = 0;
+        XrSystemGetInfo systemInfo = {XR_TYPE_SYSTEM_GET_INFO};
+        systemInfo.formFactor = XR_FORM_FACTOR_HEAD_MOUNTED_DISPLAY;
+        XrSystemId systemId = XR_NULL_SYSTEM_ID;
+        bool ok = XR_SUCCEEDED(xr.xrGetSystem(instance, &systemInfo, &systemId)) &&
+            XR_SUCCEEDED(xr.xrEnumerateViewConfigurationViews(
+                instance,
+                systemId,
+                XR_VIEW_CONFIGURATION_TYPE_PRIMARY_STEREO,
+                EYE_COUNT,
+                &viewCount,
+                configViews));
+        eyeWidth = configViews[0].recommendedImageRectWidth;
+        eyeHeight = configViews[0].recommendedImageRectHeight;
+        for (uint32_t eye = 0; eye < EYE_COUNT && ok; eye++) {
+            XrSwapchainCreateInfo swapchainInfo = {XR_TYPE_SWAPCHAIN_CREATE_INFO};
+            swapchainInfo.usageFlags = XR_SWAPCHAIN_USAGE_COLOR_ATTACHMENT_BIT;
+            swapchainInfo.format = SWAPCHAIN_FORMAT;
+            swapchainInfo.sampleCount = 1;
+            swapchainInfo.width = eyeWidth;
+            swapchainInfo.height = eyeHeight;
+            swapchainInfo.faceCount = 1;
+            swapchainInfo.arraySize = 1;
+            swapchainInfo.mipCount = 1;
+            ok = XR_SUCCEEDED(xr.xrCreateSwapchain(session, &swapchainInfo, &swapchains[eye]));
+            uint32_t imageCount = 0;
+            ok = ok &&
+                XR_SUCCEEDED(
+                    xr.xrEnumerateSwapchainImages(swapchains[eye], 0, &imageCount, nullptr));
+            std::vector<XrSwapchainImageOpenGLKHR> images(
+                imageCount, {XR_TYPE_SWAPCHAIN_IMAGE_OPENGL_KHR});
+            ok = ok && imageCount > 0 &&
+                XR_SUCCEEDED(xr.xrEnumerateSwapchainImages(
+                    swapchains[eye],
+                    imageCount,
+                    &imageCount,
+                    reinterpret_cast<XrSwapchainImageBaseHeader*>(images.data())));
+        }
+        check(ok, test, "could not create the swapchains");
+        return ok;
+    }
+
+    Runtime& xr;
+    const char* test;
+    XrInstance instance = XR_NULL_HANDLE;
+    XrSession session = XR_NULL_HANDLE;
+    XrSessionState state = XR_SESSION_STATE_UNKNOWN;
+    std::vector<XrSessionState> states; // todos los cambios de estado recibidos
+    XrSpace localSpace = XR_NULL_HANDLE;
+    XrSpace viewSpace = XR_NULL_HANDLE;
+    std::vector<XrSpace> spaces; // local, vista, mano izquierda, mano derecha
+    XrPath handPaths[2] = {XR_NULL_PATH, XR_NULL_PATH};
+    XrActionSet actionSet = XR_NULL_HANDLE;
+    XrAction aimAction = XR_NULL_HANDLE;
+    XrAction triggerAction = XR_NULL_HANDLE;
+    XrSwapchain swapchains[EYE_COUNT] = {XR_NULL_HANDLE, XR_NULL_HANDLE};
+    uint32_t eyeWidth = 0;
+    uint32_t eyeHeight = 0;
+};
+
+// Cada frame se predice un periodo despues del anterior: MOCKXR_FREE_RUN no salta vsyncs
+void checkDisplayTime(const char* test, const XrFrameState& frameState, XrTime& lastDisplayTime) {
+    check(frameState.shouldRender == XR_TRUE, test, "shouldRender is false while focused");
+    check(lastDisplayTime == 0 ||
+              frameState.predictedDisplayTime ==
+                  lastDisplayTime + frameState.predictedDisplayPeriod,
+          test, "predicted display times are not one period apart");
+    lastDisplayTime = frameState.predictedDisplayTime;
+}
+
+// Despues del ultimo frame: STOPPING, xrEndSession, IDLE y EXITING, como lo ve XrApp
+void checkExit(const char* test, MiniApp& app, int frames) {
+    check(frames == FRAME_COUNT, test, "the runtime did not stop after MOCKXR_FRAMES frames");
+    check(app.getState() == XR_SESSION_STATE_STOPPING, test, "session not STOPPING");
+    check(app.endSession(), test, "xrEndSession failed");
+    app.pollEvents();
+    const std::vector<XrSessionState>& states = app.getStates();
+    check(states.size() >= 2 && states[states.size() - 2] == XR_SESSION_STATE_IDLE &&
+              states.back() == XR_SESSION_STATE_EXITING,
+          test, "session did not go IDLE and EXITING");
+}
+
+void testSerial(Runtime& runtime) {
+    const char* test = "serial";
+    MiniApp app(runtime, test);
+    if (!app.start()) {
+        return;
+    }
+    XrTime lastDisplayTime = 0;
+    int frames = 0;
+    // Un frame de margen por si el runtime no pidiera salir
+    while (frames <= FRAME_COUNT) {
+        app.pollEvents();
+        if (app.getState() == XR_SESSION_STATE_STOPPING) {
+            break;
+        }
+        FramePacket packet;
+        if (!app.waitFrame(packet)) {
+            check(false, test, "xrWaitFrame failed");
+            return;
+        }
+        checkDisplayTime(test, packet.frameState, lastDisplayTime);
+        if (!app.beginFrame()) {
+            check(false, test, "xrBeginFrame failed");
+            return;
+        }
+        app.simulateFrame(packet);
+        if (!app.renderFrame(packet)) {
+            check(false, test, "xrEndFrame failed");
+            return;
+        }
+        frames++;
+    }
+    checkExit(test, app, frames);
+}
+
+void testPipelined(Runtime& runtime) {
+    const char* test = "pipelined";
+    MiniApp app(runtime, test);
+    if (!app.start()) {
+        return;
+    }
+    OVRFW::ovrFramePipeline<FramePacket> pipeline;
+    pipeline.Start(PIPELINE_DEPTH);
+    std::atomic<bool> waitFailed{false};
+    // Lo que hace XrApp::SimulationThreadMain
+    std::thread simulation([&] {
+        XrTime lastDisplayTime = 0;
+        int waited = 0;
+        for (;;) {
+            FramePacket* packet = pipeline.BeginWrite();
+            if (packet == nullptr) {
+                break;
+            }
+            if (!app.waitFrame(*packet)) {
+                waitFailed = true;
+                break;
+            }
+            // Los que se esperan tras el ultimo ya no estan en FOCUSED y no se renderizan
+            if (++waited <= FRAME_COUNT) {
+                checkDisplayTime(test, packet->frameState, lastDisplayTime);
+                app.simulateFrame(*packet);
+            }
+            pipeline.EndWrite();
+        }
+        pipeline.FinishWriting();
+    });
+
+    // Lo que hace XrApp::RenderPipelinedFrame
+    XrTime lastRenderedTime = 0;
+    int frames = 0;
+    while (frames <= FRAME_COUNT) {
+        app.pollEvents();
+        if (app.getState() == XR_SESSION_STATE_STOPPING) {
+            break;
+        }
+        FramePacket* packet = pipeline.BeginRead(std::chrono::milliseconds(10));
+        if (packet == nullptr) {
+            if (pipeline.IsProducerDone()) {
+                break;
+            }
+            continue;
+        }
+        check(packet->frameState.predictedDisplayTime > lastRenderedTime, test,
+              "frames rendered out of order");
+        lastRenderedTime = packet->frameState.predictedDisplayTime;
+        const bool rendered = app.beginFrame() && app.renderFrame(*packet);
+        pipeline.EndRead();
+        if (!rendered) {
+            check(false, test, "xrBeginFrame or xrEndFrame failed");
+            break;
+        }
+        frames++;
+    }
+
+    // Lo que hace XrApp::StopSimulationThread: el hilo puede estar bloqueado en xrWaitFrame
+    // hasta que se empiece el frame que espero antes
+    pipeline.RequestStop();
+    while (!pipeline.IsProducerDone() || pipeline.GetQueued() > 0) {
+        FramePacket* packet = pipeline.BeginRead(std::chrono::milliseconds(5));
+        if (packet != nullptr) {
+            check(app.beginFrame() && app.endFrameWithoutLayers(*packet), test,
+                  "could not finish a waited frame");
+            pipeline.EndRead();
+        }
+    }
+    simulation.join();
+    check(!waitFailed, test, "xrWaitFrame failed");
+    checkExit(test, app, frames);
+}
+
+// Valor de la segunda columna de la fila name del CSV de MOCKXR_STATS, -1 si no esta
+long long statsCount(const std::string& filename, const char* name) {
+    FILE* file = fopen(filename.c_str(), "r");
+    if (file == nullptr) {
+        return -1;
+    }
+    long long count = -1;
+    char line[256];
+    const size_t nameLength = strlen(name);
+    while (fgets(line, sizeof(line), file) != nullptr) {
+        if (strncmp(line, name, nameLength) == 0 && line[nameLength] == ',') {
+            count = atoll(line + nameLength + 1);
+            break;
+        }
+    }
+    fclose(file);
+    return count;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        fprintf(
+            stderr,
+            "usage: prelibreria_mock_runtime_test <mock runtime library> [serial|pipelined]\n");
+        return 1;
+    }
+    // El runtime las lee al crear la instancia
+    char frameLimit[16];
+    snprintf(frameLimit, sizeof(frameLimit), "%d", FRAME_COUNT);
+    setenv("MOCKXR_FREE_RUN", "1", 1);
+    setenv("MOCKXR_FRAMES", frameLimit, 1);
+
+    const char* which = argc > 2 ? argv[2] : "all";
+    bool known = false;
+    struct {
+        const char* name;
+        void (*run)(Runtime&);
+    } tests[] = {
+        {"serial", testSerial},
+        {"pipelined", testPipelined},
+    };
+    for (const auto& test : tests) {
+        if (strcmp(which, "all") == 0 || strcmp(which, test.name) == 0) {
+            known = true;
+            const int before = failures;
+            // El runtime escribe el informe al destruir la instancia
+            const std::string statsFilename = (fs::temp_directory_path() /
+                ("prelibreria_mock_runtime_test_" + std::to_string(getpid()) + ".csv")).string();
+            setenv("MOCKXR_STATS", statsFilename.c_str(), 1);
+            {
+                Runtime runtime;
+                if (!runtime.open(argv[1])) {
+                    check(false, test.name, "could not load the runtime");
+                } else {
+                    test.run(runtime);
+                }
+            }
+            const long long endFrames = statsCount(statsFilename, "xrEndFrame");
+            check(endFrames >= FRAME_COUNT &&
+                      statsCount(statsFilename, "framework_frame") == endFrames,
+                  test.name, "the runtime did not time every ended frame");
+            std::error_code error;
+            fs::remove(statsFilename, error);
+            printf("%s %s\n", failures == before ? "ok  " : "FAIL", test.name);
+        }
+    }
+    if (!known) {
+        fprintf(stderr, "unknown test %s\n", which);
+        return 1;
+    }
+    return failures > 0 ? 1 : 0;
+}
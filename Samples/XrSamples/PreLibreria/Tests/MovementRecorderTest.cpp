@@ -0,0 +1,248 @@
+// Pruebas de ida y vuelta de MovementRecorder (Recorder/MovementRecorder.h) con manos.
+//
+//   prelibreria_recorder_test [hands_drop|hands_block|mapped_no_space]
+//
+// Sin argumento pasa todas. Cada prueba graba de golpe, sin esperar entre frames, en un
+// directorio temporal propio (prelibreria_recorder_test_<pid>_<prueba>), lee las partes con
+// RecordingReader y comprueba que estan todos los frames, en orden:
+//
+//   hands_drop       mas de dos chunks con manos y BACKPRESSURE_DROP_OLDEST: la rafaga cabe
+//                    en las colas, no se pierde nada y cada frame tiene sus dos manos
+//   hands_block      lo mismo con BACKPRESSURE_BLOCK: el render espera al escritor y tiene
+//                    que terminar
+//   mapped_no_space  SINK_MAPPED_SEGMENTS con RLIMIT_FSIZE por debajo del tamano de un
+//                    segmento: no se puede preasignar y el grabador pasa a partes .vrmr
+//
+// Sale con codigo 1 si algo falla.
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include <signal.h>
+#include <sys/resource.h>
+#include <unistd.h>
+
+#include "Recorder/MovementRecorder.h"
+#include "Recorder/RecordingReader.h"
+
+namespace fs = std::filesystem;
+
+namespace {
+
+const int FRAME_COUNT = 2 * MovementRecorder::FRAMES_PER_CHUNK + 300;
+
+int failures = 0;
+
+void check(bool condition, const char* test, const char* what) {
+    if (!condition) {
+        printf("FAIL %s: %s\n", test, what);
+        failures++;
+    }
+}
+
+// El numero de frame va en la posicion x de la cabeza y de la primera articulacion de cada
+// mano: son floats exactos y ninguna columna los cuantiza
+void buildFrame(int index, OVRFW::ovrApplFrameIn& in, HandJoints& left, HandJoints& right) {
+    in.FrameIndex = index;
+    in.HeadPose = OVR::Posef(OVR::Quatf(), OVR::Vector3f(static_cast<float>(index), 1.6f, 0.0f));
+    in.LeftRemoteTracked = true;
+    in.RightRemoteTracked = true;
+    for (HandJoints* hand : {&left, &right}) {
+        hand->clear();
+        hand->tracked = true;
+        for (int j = 0; j < HandJoints::JOINT_COUNT; j++) {
+            hand->positions[j][0] = static_cast<float>(index);
+            hand->positions[j][1] = hand == &left ? -0.1f * j : 0.1f * j;
+            hand->radii[j] = 0.01f;
+            hand->flags[j] =
+                HandJoints::JOINT_ORIENTATION_VALID | HandJoints::JOINT_POSITION_VALID;
+        }
+    }
+}
+
+fs::path testDirectory(const char* test) {
+    const fs::path dir = fs::temp_directory_path() /
+        ("prelibreria_recorder_test_" + std::to_string(getpid()) + "_" + test);
+    fs::create_directory(dir);
+    return dir;
+}
+
+// Partes con la extension dada, en orden (_part000, _part001...)
+std::vector<std::string> listParts(const fs::path& dir, const char* extension) {
+    std::vector<std::string> parts;
+    for (const fs::directory_entry& entry : fs::directory_iterator(dir)) {
+        if (entry.path().extension() == extension) {
+            parts.push_back(entry.path().string());
+        }
+    }
+    std::sort(parts.begin(), parts.end());
+    return parts;
+}
+
+void testHands(const char* test, MovementRecorder::BackpressurePolicy policy) {
+    // MovementRecorder escribe en el directorio actual
+    const fs::path dir = testDirectory(test);
+    const fs::path previous = fs::current_path();
+    fs::current_path(dir);
+
+    uint64_t droppedFrames = 0;
+    uint64_t droppedHands = 0;
+    {
+        MovementRecorder recorder(
+            policy,
+            MovementRecorder::PoseCompression(),
+            MovementRecorder::SINK_CHUNKED_FILE,
+            true);
+        check(recorder.isCapturingHands(), test, "hand capture is off");
+        OVRFW::ovrApplFrameIn in;
+        HandJoints left;
+        HandJoints right;
+        for (int i = 0; i < FRAME_COUNT; i++) {
+            buildFrame(i, in, left, right);
+            recorder.recordFrame(in, left, right);
+        }
+        recorder.finalize();
+        droppedFrames = recorder.getDroppedFrames();
+        droppedHands = recorder.getDroppedHandFrames();
+    }
+    fs::current_path(previous);
+    check(droppedFrames == 0, test, "frames were dropped");
+    check(droppedHands == 0, test, "hand frames were dropped");
+
+    const std::vector<std::string> parts = listParts(dir, ".vrmr");
+    check(!parts.empty(), test, "no part was written");
+
+    int next = 0;
+    int chunks = 0;
+    bool handsMatch = true;
+    std::vector<FrameData> frames;
+    std::vector<HandFrameData> hands;
+    for (const std::string& part : parts) {
+        RecordingReader reader;
+        if (!reader.open(part)) {
+            check(false, test, "could not open a part");
+            continue;
+        }
+        while (reader.readChunk(frames, hands)) {
+            chunks++;
+            for (size_t i = 0; i < frames.size(); i++, next++) {
+                const float index = static_cast<float>(next);
+                if (frames[i].headPosX != index || !hands[i].hands[0].tracked ||
+                    !hands[i].hands[1].tracked || hands[i].timestamp != frames[i].timestamp ||
+                    hands[i].hands[0].positions[0][0] != index ||
+                    hands[i].hands[1].positions[HandJoints::JOINT_COUNT - 1][0] != index) {
+                    handsMatch = false;
+                }
+            }
+        }
+    }
+    check(next == FRAME_COUNT, test, "not every frame was read back");
+    check(chunks > 2, test, "expected more than two chunks");
+    check(handsMatch, test, "a frame was read back without its hands");
+
+    std::error_code error;
+    fs::remove_all(dir, error); // solo lo que ha escrito esta prueba
+}
+
+void testMappedNoSpace() {
+    const char* test = "mapped_no_space";
+    const int frameCount = 1000;
+    // Cabe el .vrmr de frameCount frames pero no un segmento de MAX_FRAMES_PER_FILE
+    const rlim_t limit = 256 * 1024;
+    check(sizeof(RecordingSegmentHeader) +
+                  MovementRecorder::MAX_FRAMES_PER_FILE * sizeof(RecordingFrameRecord) >
+              limit,
+          test, "a segment fits in the file size limit");
+    // Pasar del limite da EFBIG en vez de matar el proceso
+    signal(SIGXFSZ, SIG_IGN);
+    rlimit previousLimit;
+    getrlimit(RLIMIT_FSIZE, &previousLimit);
+    rlimit fileLimit = previousLimit;
+    fileLimit.rlim_cur = limit;
+    if (setrlimit(RLIMIT_FSIZE, &fileLimit) != 0) {
+        check(false, test, "could not set RLIMIT_FSIZE");
+        return;
+    }
+
+    const fs::path dir = testDirectory(test);
+    const fs::path previous = fs::current_path();
+    fs::current_path(dir);
+    {
+        MovementRecorder recorder(
+            MovementRecorder::BACKPRESSURE_BLOCK,
+            MovementRecorder::PoseCompression(),
+            MovementRecorder::SINK_MAPPED_SEGMENTS);
+        OVRFW::ovrApplFrameIn in;
+        HandJoints left;
+        HandJoints right;
+        for (int i = 0; i < frameCount; i++) {
+            buildFrame(i, in, left, right);
+            recorder.recordFrame(in);
+        }
+        recorder.finalize();
+    }
+    fs::current_path(previous);
+    setrlimit(RLIMIT_FSIZE, &previousLimit);
+
+    check(listParts(dir, ".vrms").empty(), test, "a segment was left behind");
+    const std::vector<std::string> parts = listParts(dir, ".vrmr");
+    check(parts.size() == 1, test, "expected one .vrmr part");
+    int next = 0;
+    bool ordered = true;
+    std::vector<FrameData> frames;
+    for (const std::string& part : parts) {
+        RecordingReader reader;
+        check(reader.open(part), test, "could not open the part");
+        while (reader.readChunk(frames)) {
+            for (size_t i = 0; i < frames.size(); i++, next++) {
+                ordered = ordered && frames[i].headPosX == static_cast<float>(next);
+            }
+        }
+    }
+    check(next == frameCount, test, "not every frame was read back");
+    check(ordered, test, "frames read back out of order");
+
+    std::error_code error;
+    fs::remove_all(dir, error);
+}
+
+void testHandsDrop() {
+    testHands("hands_drop", MovementRecorder::BACKPRESSURE_DROP_OLDEST);
+}
+
+void testHandsBlock() {
+    testHands("hands_block", MovementRecorder::BACKPRESSURE_BLOCK);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const char* which = argc > 1 ? argv[1] : "all";
+    bool known = false;
+    struct {
+        const char* name;
+        void (*run)();
+    } tests[] = {
+        {"hands_drop", testHandsDrop},
+        {"hands_block", testHandsBlock},
+        {"mapped_no_space", testMappedNoSpace},
+    };
+    for (const auto& test : tests) {
+        if (strcmp(which, "all") == 0 || strcmp(which, test.name) == 0) {
+            known = true;
+            const int before = failures;
+            test.run();
+            printf("%s %s\n", failures == before ? "ok  " : "FAIL", test.name);
+        }
+    }
+    if (!known) {
+        fprintf(
+            stderr, "usage: prelibreria_recorder_test [hands_drop|hands_block|mapped_no_space]\n");
+        return 1;
+    }
+    return failures > 0 ? 1 : 0;
+}
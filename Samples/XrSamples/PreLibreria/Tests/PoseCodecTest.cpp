@@ -0,0 +1,307 @@
+// Pruebas de ida y vuelta de PoseCodec (Recorder/PoseCodec.h).
+//
+//   prelibreria_pose_codec_test
+//
+// Codifica secuencias de poses aleatorias con varias resoluciones de posicion y bits de
+// rotacion, las decodifica y comprueba que el error queda dentro de positionErrorBound y
+// rotationErrorBound. Tambien prueba frames sin tracking y flujos truncados o corruptos, que
+// decode tiene que rechazar sin leer fuera del buffer. Sale con codigo 1 si algo falla.
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "Recorder/PoseCodec.h"
+
+namespace {
+
+const int F = PoseCodec::FLOATS_PER_POSE;
+
+int failures = 0;
+
+void check(bool condition, const char* what, const char* detail = "") {
+    if (!condition) {
+        printf("FAIL %s %s\n", what, detail);
+        failures++;
+    }
+}
+
+void randomQuat(std::mt19937& rng, float* q) {
+    std::normal_distribution<float> normal;
+    float lengthSq = 0.0f;
+    do {
+        lengthSq = 0.0f;
+        for (int i = 0; i < 4; i++) {
+            q[i] = normal(rng);
+            lengthSq += q[i] * q[i];
+        }
+    } while (lengthSq < 1e-6f);
+    const float inv = 1.0f / std::sqrt(lengthSq);
+    for (int i = 0; i < 4; i++) {
+        q[i] *= inv;
+    }
+}
+
+// Mezcla de paseo aleatorio (deltas pequenas, como un mando de verdad), saltos grandes y
+// rotaciones cerca de los ejes, donde cambia la componente omitida
+std::vector<float> randomPoses(std::mt19937& rng, size_t count) {
+    std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+    std::uniform_int_distribution<int> pick(0, 9);
+    std::vector<float> poses(count * F);
+    float pose[F] = {0.0f, 1.6f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f};
+    for (size_t i = 0; i < count; i++) {
+        const int kind = pick(rng);
+        if (kind == 0) {
+            for (int a = 0; a < 3; a++) {
+                pose[a] = 3.0f * unit(rng);
+            }
+            randomQuat(rng, pose + 3);
+        } else if (kind == 1) {
+            // Un eje casi puro, con el signo al azar
+            const int axis = pick(rng) % 4;
+            for (int c = 0; c < 4; c++) {
+                pose[3 + c] = c == axis ? (unit(rng) < 0.0f ? -1.0f : 1.0f) : 1e-3f * unit(rng);
+            }
+        } else {
+            float lengthSq = 0.0f;
+            for (int a = 0; a < 3; a++) {
+                pose[a] = std::min(3.0f, std::max(-3.0f, pose[a] + 0.002f * unit(rng)));
+            }
+            for (int c = 0; c < 4; c++) {
+                pose[3 + c] += 0.01f * unit(rng);
+                lengthSq += pose[3 + c] * pose[3 + c];
+            }
+            for (int c = 0; c < 4; c++) {
+                pose[3 + c] /= std::sqrt(lengthSq);
+            }
+        }
+        memcpy(poses.data() + i * F, pose, sizeof(pose));
+    }
+    return poses;
+}
+
+// Angulo de la rotacion entre dos cuaterniones, q y -q son la misma. Con la cuerda entre
+// los dos normalizados en double: acos del producto escalar no tiene precision cerca de 1.
+double rotationAngle(const float* a, const float* b) {
+    double qa[4];
+    double qb[4];
+    double lengthA = 0.0;
+    double lengthB = 0.0;
+    double dot = 0.0;
+    for (int c = 0; c < 4; c++) {
+        qa[c] = a[c];
+        qb[c] = b[c];
+        lengthA += qa[c] * qa[c];
+        lengthB += qb[c] * qb[c];
+        dot += qa[c] * qb[c];
+    }
+    const double sign = dot < 0.0 ? -1.0 : 1.0;
+    double chordSq = 0.0;
+    for (int c = 0; c < 4; c++) {
+        const double d = qa[c] / std::sqrt(lengthA) - sign * qb[c] / std::sqrt(lengthB);
+        chordSq += d * d;
+    }
+    return 4.0 * std::asin(std::min(1.0, std::sqrt(chordSq) / 2.0));
+}
+
+void testRoundTrip() {
+    const float resolutions[] = {0.05f, 0.1f, 0.5f, 1.0f, 5.0f};
+    const uint8_t bits[] = {8, 10, 12, 14, 16};
+    std::mt19937 rng(1234);
+    for (const float resolution : resolutions) {
+        for (const uint8_t rotationBits : bits) {
+            PoseCodecConfig config;
+            config.enabled = true;
+            config.positionResolutionMm = resolution;
+            config.rotationBits = rotationBits;
+            const size_t count = 2000;
+            const std::vector<float> poses = randomPoses(rng, count);
+
+            std::vector<uint8_t> encoded(PoseCodec::maxEncodedSize(count));
+            const size_t size =
+                PoseCodec::encode(config, poses.data(), nullptr, count, encoded.data());
+            std::vector<float> decoded(count * F);
+            std::vector<uint8_t> present(count);
+            char detail[96];
+            snprintf(detail, sizeof(detail), "(%.2fmm, %d bits)", resolution, rotationBits);
+            check(
+                PoseCodec::decode(encoded.data(), size, count, decoded.data(), present.data()),
+                "round trip decode",
+                detail);
+
+            const double positionBound = PoseCodec::positionErrorBound(config);
+            const double rotationBound = PoseCodec::rotationErrorBound(config);
+            // La cota es la de la cuantizacion; el header documenta ademas el redondeo del
+            // float decodificado, medio ulp de la coordenada
+            double maxPosition = 0.0;
+            double maxPositionExcess = 0.0;
+            bool positionWithinBound = true;
+            double maxRotation = 0.0;
+            for (size_t i = 0; i < count; i++) {
+                const float* in = poses.data() + i * F;
+                const float* out = decoded.data() + i * F;
+                check(present[i] == 1, "round trip present", detail);
+                for (int a = 0; a < 3; a++) {
+                    const double error = std::fabs(static_cast<double>(out[a]) - in[a]);
+                    maxPosition = std::max(maxPosition, error);
+                    maxPositionExcess = std::max(maxPositionExcess, error - positionBound);
+                    const double rounding = std::fabs(in[a]) * FLT_EPSILON;
+                    positionWithinBound = positionWithinBound && error <= positionBound + rounding;
+                }
+                maxRotation = std::max(maxRotation, rotationAngle(in + 3, out + 3));
+            }
+            printf(
+                "%-20s position %.3g (+%.3g) <= %.3g m, rotation %.3g <= %.3g rad, %.1f B/frame\n",
+                detail,
+                maxPosition,
+                std::max(0.0, maxPositionExcess),
+                positionBound,
+                maxRotation,
+                rotationBound,
+                static_cast<double>(size) / count);
+            check(positionWithinBound, "position error over bound", detail);
+            check(maxRotation <= rotationBound, "rotation error over bound", detail);
+        }
+    }
+}
+
+void testUntracked() {
+    std::mt19937 rng(99);
+    std::uniform_int_distribution<int> pick(0, 9);
+    const size_t count = 1000;
+    PoseCodecConfig config;
+    config.enabled = true;
+    const std::vector<float> poses = randomPoses(rng, count);
+
+    // Huecos al azar, el principio sin tracking y un tramo largo sin tracking
+    std::vector<uint8_t> tracked(count);
+    for (size_t i = 0; i < count; i++) {
+        tracked[i] = i >= 5 && (i < 400 || i >= 600) && pick(rng) >= 3 ? 1 : 0;
+    }
+    std::vector<uint8_t> encoded(PoseCodec::maxEncodedSize(count));
+    const size_t size =
+        PoseCodec::encode(config, poses.data(), tracked.data(), count, encoded.data());
+    std::vector<float> decoded(count * F);
+    std::vector<uint8_t> present(count);
+    check(
+        PoseCodec::decode(encoded.data(), size, count, decoded.data(), present.data()),
+        "untracked decode");
+    const float identity[F] = {0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f};
+    for (size_t i = 0; i < count; i++) {
+        const float* in = poses.data() + i * F;
+        const float* out = decoded.data() + i * F;
+        check(present[i] == tracked[i], "untracked presence");
+        if (!tracked[i]) {
+            check(memcmp(out, identity, sizeof(identity)) == 0, "untracked frame not identity");
+            continue;
+        }
+        for (int a = 0; a < 3; a++) {
+            check(
+                std::fabs(out[a] - in[a]) <=
+                    PoseCodec::positionErrorBound(config) + std::fabs(in[a]) * FLT_EPSILON,
+                "untracked neighbour position");
+        }
+        check(
+            rotationAngle(in + 3, out + 3) <= PoseCodec::rotationErrorBound(config),
+            "untracked neighbour rotation");
+    }
+
+    // Sin ningun frame con tracking solo queda la cabecera y la mascara
+    std::vector<uint8_t> none(count, 0);
+    const size_t emptySize =
+        PoseCodec::encode(config, poses.data(), none.data(), count, encoded.data());
+    check(
+        emptySize == sizeof(PoseCodecStreamHeader) + (count + 7) / 8, "all untracked size");
+    check(
+        PoseCodec::decode(encoded.data(), emptySize, count, decoded.data(), present.data()),
+        "all untracked decode");
+    check(
+        std::count(present.begin(), present.end(), 0) == static_cast<long>(count),
+        "all untracked presence");
+}
+
+// decode sobre una copia del tamano exacto, asi ASan ve cualquier lectura de mas
+bool decodeCopy(const uint8_t* data, size_t size, size_t count, std::vector<float>& poses) {
+    std::vector<uint8_t> copy(data, data + size);
+    return PoseCodec::decode(copy.data(), copy.size(), count, poses.data(), nullptr);
+}
+
+void testCorrupt() {
+    std::mt19937 rng(7);
+    const size_t count = 200;
+    PoseCodecConfig config;
+    config.enabled = true;
+    const std::vector<float> poses = randomPoses(rng, count);
+    std::vector<uint8_t> encoded(PoseCodec::maxEncodedSize(count));
+    const size_t size =
+        PoseCodec::encode(config, poses.data(), nullptr, count, encoded.data());
+    std::vector<float> decoded(count * F);
+    check(decodeCopy(encoded.data(), size, count, decoded), "corrupt baseline");
+
+    // Cualquier truncado se rechaza
+    bool truncatedRejected = true;
+    for (size_t cut = 0; cut < size; cut++) {
+        truncatedRejected = truncatedRejected && !decodeCopy(encoded.data(), cut, count, decoded);
+    }
+    check(truncatedRejected, "truncated stream accepted");
+
+    // Bytes de mas al final, o menos frames de los codificados
+    std::vector<uint8_t> longer(encoded.begin(), encoded.begin() + size);
+    longer.push_back(0);
+    check(!decodeCopy(longer.data(), longer.size(), count, decoded), "trailing byte accepted");
+    check(!decodeCopy(encoded.data(), size, count - 1, decoded), "frame count mismatch");
+
+    // Cabecera invalida
+    std::vector<uint8_t> bad(encoded.begin(), encoded.begin() + size);
+    PoseCodecStreamHeader header;
+    memcpy(&header, bad.data(), sizeof(header));
+    header.rotationBits = 20;
+    memcpy(bad.data(), &header, sizeof(header));
+    check(!decodeCopy(bad.data(), bad.size(), count, decoded), "bad rotation bits accepted");
+    header.rotationBits = config.rotationBits;
+    header.positionResolutionMm = NAN;
+    memcpy(bad.data(), &header, sizeof(header));
+    check(!decodeCopy(bad.data(), bad.size(), count, decoded), "bad resolution accepted");
+
+    // El primer frame presente tiene que ser absoluto
+    bad.assign(encoded.begin(), encoded.begin() + size);
+    const size_t firstTag = sizeof(PoseCodecStreamHeader) + (count + 7) / 8;
+    bad[firstTag] &= static_cast<uint8_t>(~(1u << 2));
+    check(!decodeCopy(bad.data(), bad.size(), count, decoded), "relative first frame accepted");
+
+    // Bytes cambiados al azar: puede salir bien o mal, pero sin salirse del buffer y sin
+    // rotaciones fuera de rango
+    std::uniform_int_distribution<size_t> position(0, size - 1);
+    std::uniform_int_distribution<int> byte(0, 255);
+    for (int round = 0; round < 2000; round++) {
+        bad.assign(encoded.begin(), encoded.begin() + size);
+        for (int k = 0; k < 1 + round % 4; k++) {
+            bad[position(rng)] = static_cast<uint8_t>(byte(rng));
+        }
+        if (decodeCopy(bad.data(), bad.size(), count, decoded)) {
+            for (size_t i = 0; i < count; i++) {
+                const float* q = decoded.data() + i * F + 3;
+                const float length = std::sqrt(q[0] * q[0] + q[1] * q[1] + q[2] * q[2] + q[3] * q[3]);
+                check(std::fabs(length - 1.0f) < 1e-3f, "corrupt stream decoded a non unit rotation");
+            }
+        }
+    }
+}
+
+} // namespace
+
+int main() {
+    testRoundTrip();
+    testUntracked();
+    testCorrupt();
+    if (failures > 0) {
+        printf("%d checks failed\n", failures);
+        return 1;
+    }
+    printf("all checks passed\n");
+    return 0;
+}
@@ -0,0 +1,323 @@
+// Pruebas de UploadQueue (Recorder/UploadQueue.h) contra LoopbackUploadServer.
+//
+//   prelibreria_upload_test [resume|conflict|drop|restart|config]
+//
+// Sin argumento pasa todas. Cada prueba sube ficheros con datos aleatorios desde un
+// directorio temporal propio (prelibreria_upload_test_<pid>) y comprueba que el servidor
+// acaba con los mismos bytes:
+//
+//   resume    el servidor ya tiene media parte de un PATCH anterior: se sigue desde el
+//             offset que da HEAD sin reenviar nada
+//   conflict  HEAD da un offset viejo, el PATCH recibe 409 y se sigue desde el offset real
+//   drop      el servidor corta la conexion a mitad de un PATCH; se reintenta y se reanuda
+//   restart   se para la cola con partes a medias y una cola nueva sobre el mismo fichero
+//             de cola las recupera y las termina desde donde se quedaron
+//   config    UploadQueue::loadConfig con un fichero valido, sin host, con un puerto
+//             invalido y sin fichero
+//
+// Sale con codigo 1 si algo falla.
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <unistd.h>
+
+#include "LoopbackUploadServer.h"
+#include "Recorder/UploadQueue.h"
+
+namespace fs = std::filesystem;
+
+namespace {
+
+const size_t FILE_SIZE = 300 * 1024;
+const size_t CHUNK_SIZE = 64 * 1024;
+
+int failures = 0;
+
+void check(bool condition, const char* test, const char* what) {
+    if (!condition) {
+        printf("FAIL %s: %s\n", test, what);
+        failures++;
+    }
+}
+
+// Directorio propio de la prueba; al final solo se borran los ficheros que se crearon
+class TempFiles {
+public:
+    TempFiles() {
+        dir = fs::temp_directory_path() / ("prelibreria_upload_test_" + std::to_string(getpid()));
+        fs::create_directory(dir);
+    }
+
+    ~TempFiles() {
+        std::error_code error;
+        for (const fs::path& path : created) {
+            fs::remove(path, error);
+        }
+        fs::remove(dir, error); // solo si ha quedado vacio
+    }
+
+    std::string write(const std::string& name, const std::string& data) {
+        const fs::path path = dir / name;
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        out.write(data.data(), static_cast<std::streamsize>(data.size()));
+        created.push_back(path);
+        return path.string();
+    }
+
+    // Un fichero que crea otro (la cola), para borrarlo al final
+    std::string track(const std::string& name) {
+        const fs::path path = dir / name;
+        created.push_back(path);
+        created.push_back(fs::path(path.string() + ".tmp"));
+        return path.string();
+    }
+
+private:
+    fs::path dir;
+    std::vector<fs::path> created;
+};
+
+std::string randomData(size_t size, uint32_t seed) {
+    std::mt19937 rng(seed);
+    std::string data(size, '\0');
+    for (char& c : data) {
+        c = static_cast<char>(rng());
+    }
+    return data;
+}
+
+UploadQueue::Config serverConfig(const LoopbackUploadServer& server) {
+    UploadQueue::Config config;
+    config.host = "127.0.0.1";
+    config.port = server.getPort();
+    config.chunkSize = CHUNK_SIZE;
+    config.timeoutMs = 2000;
+    config.minBackoff = std::chrono::milliseconds(10);
+    config.maxBackoff = std::chrono::milliseconds(100);
+    return config;
+}
+
+template <typename Done>
+bool waitUntil(Done done) {
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(20);
+    while (!done()) {
+        if (std::chrono::steady_clock::now() > deadline) {
+            return false;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    return true;
+}
+
+void testResume() {
+    const char* test = "resume";
+    TempFiles files;
+    LoopbackUploadServer server;
+    check(server.start(), test, "server did not start");
+    const std::string data = randomData(FILE_SIZE, 1);
+    const std::string filename = files.write("part000.vrmr", data);
+    // Un PATCH anterior se corto a 100000 bytes
+    const size_t already = 100000;
+    server.setFile("part000.vrmr", data.substr(0, already));
+
+    UploadQueue queue(files.track("queue.txt"));
+    queue.enqueue(filename);
+    queue.start(serverConfig(server));
+    check(waitUntil([&] { return queue.getPendingCount() == 0; }), test, "upload timed out");
+    queue.stop();
+
+    const LoopbackUploadServer::Stats stats = server.getStats();
+    check(server.getFile("part000.vrmr") == data, test, "server content differs");
+    check(!stats.patchOffsets.empty() && stats.patchOffsets[0] == already, test,
+          "first PATCH did not start at the HEAD offset");
+    check(queue.getBytesUploaded() == FILE_SIZE - already, test, "bytes were sent twice");
+    check(stats.heads == 1 && stats.conflicts == 0, test, "unexpected HEAD or 409");
+}
+
+void testConflict() {
+    const char* test = "conflict";
+    TempFiles files;
+    LoopbackUploadServer server;
+    check(server.start(), test, "server did not start");
+    const std::string data = randomData(FILE_SIZE, 2);
+    const std::string filename = files.write("part001.vrmr", data);
+    const size_t already = 3 * CHUNK_SIZE / 2;
+    server.setFile("part001.vrmr", data.substr(0, already));
+    // HEAD dice 0, como si la respuesta del PATCH anterior se hubiera perdido
+    LoopbackUploadServer::Faults faults;
+    faults.staleHeadCount = 1;
+    faults.staleHeadOffset = 0;
+    server.setFaults(faults);
+
+    UploadQueue queue(files.track("queue.txt"));
+    queue.enqueue(filename);
+    queue.start(serverConfig(server));
+    check(waitUntil([&] { return queue.getPendingCount() == 0; }), test, "upload timed out");
+    queue.stop();
+
+    const LoopbackUploadServer::Stats stats = server.getStats();
+    check(server.getFile("part001.vrmr") == data, test, "server content differs");
+    check(stats.conflicts == 1, test, "expected exactly one 409");
+    check(stats.patchOffsets.size() >= 2 && stats.patchOffsets[0] == 0 &&
+              stats.patchOffsets[1] == already,
+          test, "did not continue from the offset in the 409");
+    check(queue.getRetries() == 0, test, "a 409 with an offset should not be a retry");
+}
+
+void testDrop() {
+    const char* test = "drop";
+    TempFiles files;
+    LoopbackUploadServer server;
+    check(server.start(), test, "server did not start");
+    const std::string data = randomData(FILE_SIZE, 3);
+    const std::string filename = files.write("part002.vrmr", data);
+    // El segundo trozo se corta a los 20000 bytes
+    LoopbackUploadServer::Faults faults;
+    faults.dropAfterBodyBytes = 20000;
+    faults.dropCount = 1;
+    server.setFile("part002.vrmr", data.substr(0, CHUNK_SIZE));
+    server.setFaults(faults);
+
+    UploadQueue queue(files.track("queue.txt"));
+    queue.enqueue(filename);
+    queue.start(serverConfig(server));
+    check(waitUntil([&] { return queue.getPendingCount() == 0; }), test, "upload timed out");
+    queue.stop();
+
+    const LoopbackUploadServer::Stats stats = server.getStats();
+    check(server.getFile("part002.vrmr") == data, test, "server content differs");
+    check(stats.drops == 1, test, "the connection was not dropped");
+    check(stats.connections >= 2, test, "no reconnection after the drop");
+    check(queue.getBytesUploaded() <= FILE_SIZE - CHUNK_SIZE, test, "bytes were sent twice");
+}
+
+void testRestart() {
+    const char* test = "restart";
+    TempFiles files;
+    LoopbackUploadServer server;
+    check(server.start(), test, "server did not start");
+    const std::string data0 = randomData(FILE_SIZE, 4);
+    const std::string data1 = randomData(FILE_SIZE / 3, 5);
+    const std::string file0 = files.write("part003.vrmr", data0);
+    const std::string file1 = files.write("part004.vrmr", data1);
+    const std::string queueFile = files.track("queue.txt");
+
+    // Primera ejecucion: todos los PATCH se cortan, asi que se para con la parte a medias
+    LoopbackUploadServer::Faults faults;
+    faults.dropAfterBodyBytes = 10000;
+    faults.dropCount = 1000;
+    server.setFaults(faults);
+    {
+        UploadQueue queue(queueFile);
+        queue.enqueue(file0);
+        queue.enqueue(file1);
+        queue.start(serverConfig(server));
+        check(waitUntil([&] { return server.getFile("part003.vrmr").size() >= 20000; }), test,
+              "first run made no progress");
+        queue.stop();
+        check(queue.getPendingCount() == 2, test, "parts left the queue without uploading");
+    }
+    // Reiniciar el servidor espera a que termine de guardar el PATCH cortado
+    server.stop();
+    check(server.start(), test, "server did not restart");
+    const size_t partial = server.getFile("part003.vrmr").size();
+
+    std::ifstream persisted(queueFile);
+    std::string line;
+    std::vector<std::string> lines;
+    while (std::getline(persisted, line)) {
+        lines.push_back(line);
+    }
+    check(lines.size() == 2 && lines[0] == file0 && lines[1] == file1, test,
+          "queue file does not list the pending parts in order");
+
+    // Segunda ejecucion sin fallos: la cola se recupera del fichero y reanuda
+    server.setFaults(LoopbackUploadServer::Faults());
+    const size_t patchesBefore = server.getStats().patchOffsets.size();
+    UploadQueue queue(queueFile);
+    check(queue.getPendingCount() == 2, test, "pending parts not restored");
+    queue.start(serverConfig(server));
+    check(waitUntil([&] { return queue.getPendingCount() == 0; }), test, "upload timed out");
+    queue.stop();
+
+    const LoopbackUploadServer::Stats stats = server.getStats();
+    check(server.getFile("part003.vrmr") == data0, test, "server content differs (part003)");
+    check(server.getFile("part004.vrmr") == data1, test, "server content differs (part004)");
+    check(stats.patchOffsets.size() > patchesBefore &&
+              stats.patchOffsets[patchesBefore] == partial,
+          test, "second run did not resume from the server offset");
+    check(queue.getBytesUploaded() == FILE_SIZE - partial + data1.size(), test,
+          "second run sent bytes the server already had");
+    std::ifstream emptied(queueFile);
+    check(emptied.is_open() && !std::getline(emptied, line), test, "queue file not emptied");
+}
+
+void testConfig() {
+    const char* test = "config";
+    TempFiles files;
+
+    UploadQueue::Config config;
+    config.pathPrefix = "/default/";
+    const std::string full = files.write(
+        "full.conf", "# servidor de pruebas\r\nhost=uploads.example.com\r\nport=8080\r\n\r\n");
+    check(UploadQueue::loadConfig(full, config), test, "valid file rejected");
+    check(config.host == "uploads.example.com", test, "wrong host");
+    check(config.port == 8080, test, "wrong port");
+    check(config.pathPrefix == "/default/", test, "path without a key was overwritten");
+
+    const std::string path = files.write("path.conf", "path=/motion/\nhost=10.0.0.2\n");
+    check(UploadQueue::loadConfig(path, config), test, "file with path rejected");
+    check(config.host == "10.0.0.2" && config.pathPrefix == "/motion/", test, "wrong path");
+    check(config.port == 8080, test, "port without a key was overwritten");
+
+    const UploadQueue::Config before = config;
+    const std::string noHost = files.write("nohost.conf", "port=9000\n");
+    check(!UploadQueue::loadConfig(noHost, config), test, "file without host accepted");
+    const std::string badPort = files.write("badport.conf", "host=a\nport=70000\n");
+    check(!UploadQueue::loadConfig(badPort, config), test, "port out of range accepted");
+    const std::string badLine = files.write("badline.conf", "host=a\nport\n");
+    check(!UploadQueue::loadConfig(badLine, config), test, "line without = accepted");
+    check(!UploadQueue::loadConfig(files.track("missing.conf"), config), test,
+          "missing file accepted");
+    check(config.host == before.host && config.port == before.port &&
+              config.pathPrefix == before.pathPrefix,
+          test, "a rejected file changed the config");
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const char* which = argc > 1 ? argv[1] : "all";
+    bool known = false;
+    struct {
+        const char* name;
+        void (*run)();
+    } tests[] = {
+        {"resume", testResume},
+        {"conflict", testConflict},
+        {"drop", testDrop},
+        {"restart", testRestart},
+        {"config", testConfig},
+    };
+    for (const auto& test : tests) {
+        if (strcmp(which, "all") == 0 || strcmp(which, test.name) == 0) {
+            known = true;
+            const int before = failures;
+            test.run();
+            printf("%s %s\n", failures == before ? "ok  " : "FAIL", test.name);
+        }
+    }
+    if (!known) {
+        fprintf(stderr, "usage: prelibreria_upload_test [resume|conflict|drop|restart|config]\n");
+        return 1;
+    }
+    return failures > 0 ? 1 : 0;
+}
@@ -0,0 +1,105 @@
+// Prueba de humo de XrApp::MainLoop contra el runtime falso (Tools/MockRuntime). Solo
+// Windows, que es donde se compila XrApp fuera de Android:
+//
+//   XR_RUNTIME_JSON=<build>/prelibreria_mock_runtime.json MOCKXR_FREE_RUN=1 MOCKXR_FRAMES=120
+//   prelibreria_xrapp_smoke_test [profundidad]
+//
+// Corre MainLoop hasta que el runtime termina la sesion (STOPPING y EXITING tras
+// MOCKXR_FRAMES frames) y comprueba que se han simulado y renderizado esos frames, cada uno
+// con un tiempo de display mayor que el anterior. profundidad se pasa a
+// SetFramePipelineDepth; 0, por defecto, es el MainLoop sin pipeline.
+//
+// Sale con codigo 1 si algo falla.
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+
+#include "XrApp.h"
+
+namespace {
+
+class SmokeTestApp : public OVRFW::XrApp {
+public:
+    explicit SmokeTestApp(int depth) : pipelineDepth(depth) {}
+
+    int getSimulated() const {
+        return simulated;
+    }
+    int getRendered() const {
+        return rendered;
+    }
+    bool isOrdered() const {
+        return ordered;
+    }
+
+protected:
+    bool AppInit(const OVRFW::xrJava* context) override {
+        SetFramePipelineDepth(pipelineDepth);
+        return XrApp::AppInit(context);
+    }
+
+    // Con pipeline corre en el hilo de simulacion
+    void AppSimulateFrame(const OVRFW::ovrApplFrameIn& in, OVRFW::ovrRendererOutput& out)
+        override {
+        if (in.PredictedDisplayTime <= lastSimulatedTime) {
+            ordered = false;
+        }
+        lastSimulatedTime = in.PredictedDisplayTime;
+        simulated++;
+        XrApp::AppSimulateFrame(in, out);
+    }
+
+    // Cada frame llega con la prediccion con la que se simulo, en el mismo orden
+    void AppRenderFrame(const OVRFW::ovrApplFrameIn& in, OVRFW::ovrRendererOutput& out)
+        override {
+        if (in.PredictedDisplayTime <= lastRenderedTime) {
+            ordered = false;
+        }
+        lastRenderedTime = in.PredictedDisplayTime;
+        rendered++;
+        XrApp::AppRenderFrame(in, out);
+    }
+
+private:
+    int pipelineDepth;
+    std::atomic<int> simulated{0};
+    std::atomic<int> rendered{0};
+    std::atomic<bool> ordered{true};
+    double lastSimulatedTime = 0.0; // solo el hilo de simulacion
+    double lastRenderedTime = 0.0; // solo el de MainLoop
+};
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const int depth = argc > 1 ? atoi(argv[1]) : 0;
+    const char* frameLimit = getenv("MOCKXR_FRAMES");
+    if (getenv("XR_RUNTIME_JSON") == nullptr || frameLimit == nullptr) {
+        fprintf(stderr, "XR_RUNTIME_JSON and MOCKXR_FRAMES must select the mock runtime\n");
+        return 1;
+    }
+    const int frames = atoi(frameLimit);
+
+    auto app = std::make_unique<SmokeTestApp>(depth);
+    app->Run();
+
+    int failures = 0;
+    if (app->getRendered() != frames) {
+        printf("FAIL rendered %d frames, expected %d\n", app->getRendered(), frames);
+        failures++;
+    }
+    // Con pipeline se pueden haber simulado frames que se cierran sin capas al parar
+    if (app->getSimulated() < app->getRendered() ||
+        app->getSimulated() > app->getRendered() + depth + 1) {
+        printf("FAIL simulated %d frames for %d rendered\n", app->getSimulated(), frames);
+        failures++;
+    }
+    if (!app->isOrdered()) {
+        printf("FAIL predicted display times went backwards\n");
+        failures++;
+    }
+    printf("%s xrapp depth %d\n", failures == 0 ? "ok  " : "FAIL", depth);
+    return failures > 0 ? 1 : 0;
+}
@@ -0,0 +1,644 @@
+// Microbenchmark de la animacion de modelos glTF con muchos personajes a la vez.
+//
+//   prelibreria_anim_bench [--characters N] [--joints N] [--frames N] [--threads N]
+//                          [--scene-nodes N] [--scene-animated N]
+//                          [--max-ns-per-character N] [--max-allocs-per-frame N]
+//
+// Arma en memoria un ModelFile como los que deja el cargador de glTF: un esqueleto de
+// --joints nodos en cadenas de 8, un nodo con 8 pesos de morph y dos animaciones, "walk"
+// (rotacion en cada articulacion, traslacion y escala en la raiz y pesos, 31 claves a 30 Hz)
+// y "blink" (claves a intervalos irregulares y un peso aditivo). Cada frame anima
+// --characters ModelState desfasados en el tiempo de tres formas:
+//
+//   apply   CalculateAnimationFrameAndFraction + ApplyAnimation, la ruta original
+//   clip    SampleAnimationClip con los clips compilados al cargar
+//   batch   ModelAnimationBatch con --threads hilos de trabajo ademas del principal (0 por
+//           defecto, como ModelAnimationBatch: con pocos nucleos libres los hilos no ganan)
+//
+// y luego recalcula las matrices globales con ModelState::UpdateGlobalTransforms. Saca ns/frame
+// (p50/p95), ns por personaje y reservas de memoria por frame, contadas reemplazando operator
+// new, y comprueba que clip y batch dejan las mismas matrices que apply (codigo 1 si no).
+//
+// Ademas mide la jerarquia aplanada con una escena estatica de --scene-nodes nodos (arbol de 4
+// hijos por nodo) en la que solo se mueven --scene-animated nodos por frame, y con la escena
+// entera movida por SetMatrix, frente a recorrer el arbol recursivamente por children como
+// hacia antes ModelNodeState::RecalculateMatrix. Tambien comprueba que dan las mismas matrices.
+//
+// Los umbrales --max-* se aplican a batch y hacen que termine con codigo 2 si se superan.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <thread>
+#include <vector>
+
+#include "Model/ModelAnimationUtils.h"
+#include "Model/ModelFile.h"
+
+using OVR::Matrix4f;
+using OVR::Quatf;
+using OVR::Vector3f;
+using namespace OVRFW;
+
+//==============================================================
+// Contador de reservas
+//==============================================================
+
+namespace {
+std::atomic<uint64_t> totalAllocations{0};
+
+void* countedAlloc(size_t size) {
+    totalAllocations.fetch_add(1, std::memory_order_relaxed);
+    void* p = malloc(size == 0 ? 1 : size);
+    if (p == nullptr) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+} // namespace
+
+void* operator new(size_t size) {
+    return countedAlloc(size);
+}
+void* operator new[](size_t size) {
+    return countedAlloc(size);
+}
+void operator delete(void* p) noexcept {
+    free(p);
+}
+void operator delete[](void* p) noexcept {
+    free(p);
+}
+void operator delete(void* p, size_t) noexcept {
+    free(p);
+}
+void operator delete[](void* p, size_t) noexcept {
+    free(p);
+}
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+const int CHAIN_LENGTH = 8;
+const int NUM_MORPH_WEIGHTS = 8;
+const int WALK_KEYS = 31; // 1 segundo a 30 Hz
+const float BLINK_TIMES[] = {0.0f, 0.13f, 0.2f, 0.31f, 0.9f, 1.4f};
+const int BLINK_KEYS = sizeof(BLINK_TIMES) / sizeof(BLINK_TIMES[0]);
+
+struct Options {
+    int characters = 300;
+    int joints = 64;
+    int frames = 500;
+    int threads = 0;
+    int sceneNodes = 20000;
+    int sceneAnimated = 16;
+    double maxNsPerCharacter = 0.0; // 0 = sin umbral
+    double maxAllocsPerFrame = -1.0; // < 0 = sin umbral
+};
+
+// Los datos de todas las claves van a un solo buffer, como un .bin de glTF
+struct ModelBuilder {
+    ModelFile& file;
+    std::vector<float> data;
+    struct PendingAccessor {
+        size_t offset;
+        int count;
+        ModelAccessorType type;
+    };
+    std::vector<PendingAccessor> accessors;
+
+    explicit ModelBuilder(ModelFile& modelFile) : file(modelFile) {}
+
+    int addAccessor(const std::vector<float>& values, int count, ModelAccessorType type) {
+        accessors.push_back({data.size() * sizeof(float), count, type});
+        data.insert(data.end(), values.begin(), values.end());
+        return static_cast<int>(accessors.size()) - 1;
+    }
+
+    // Al final, cuando los vectores ya no cambian de tamano
+    void finish() {
+        file.Buffers.resize(1);
+        file.Buffers[0].bufferData.resize(data.size() * sizeof(float));
+        memcpy(file.Buffers[0].bufferData.data(), data.data(), data.size() * sizeof(float));
+        file.Buffers[0].byteLength = file.Buffers[0].bufferData.size();
+        file.BufferViews.resize(1);
+        file.BufferViews[0].buffer = &file.Buffers[0];
+        file.BufferViews[0].byteLength = file.Buffers[0].byteLength;
+        file.Accessors.resize(accessors.size());
+        for (size_t i = 0; i < accessors.size(); i++) {
+            ModelAccessor& accessor = file.Accessors[i];
+            accessor.bufferView = &file.BufferViews[0];
+            accessor.byteOffset = accessors[i].offset;
+            accessor.componentType = MODEL_COMPONENT_TYPE_FLOAT;
+            accessor.count = accessors[i].count;
+            accessor.type = accessors[i].type;
+        }
+    }
+};
+
+struct ChannelDesc {
+    int node;
+    ModelAnimationPath path;
+    int input;
+    int output;
+    ModelAnimationInterpolation interpolation;
+    int additiveWeightIndex;
+};
+
+std::vector<float> keyTimes(int count, float step) {
+    std::vector<float> times(count);
+    for (int i = 0; i < count; i++) {
+        times[i] = i * step;
+    }
+    return times;
+}
+
+void addAnimation(ModelFile& file, const char* name, const std::vector<ChannelDesc>& channels) {
+    file.Animations.emplace_back();
+    ModelAnimation& animation = file.Animations.back();
+    animation.name = name;
+    animation.samplers.resize(channels.size());
+    animation.channels.resize(channels.size());
+    for (size_t i = 0; i < channels.size(); i++) {
+        ModelAnimationSampler& sampler = animation.samplers[i];
+        sampler.input = &file.Accessors[channels[i].input];
+        sampler.output = &file.Accessors[channels[i].output];
+        sampler.interpolation = channels[i].interpolation;
+        ModelAnimationChannel& channel = animation.channels[i];
+        channel.nodeIndex = channels[i].node;
+        channel.path = channels[i].path;
+        channel.sampler = &sampler;
+        channel.additiveWeightIndex = channels[i].additiveWeightIndex;
+    }
+}
+
+// Lo mismo que hace el cargador de glTF despues de leer las animaciones
+void createTimeLines(ModelFile& file) {
+    for (ModelAnimation& animation : file.Animations) {
+        for (ModelAnimationSampler& sampler : animation.samplers) {
+            for (size_t i = 0; i < file.AnimationTimeLines.size(); i++) {
+                if (file.AnimationTimeLines[i].accessor == sampler.input) {
+                    sampler.timeLineIndex = static_cast<int>(i);
+                }
+            }
+            if (sampler.timeLineIndex < 0) {
+                ModelAnimationTimeLine timeLine;
+                timeLine.Initialize(sampler.input);
+                if (file.AnimationTimeLines.empty()) {
+                    file.animationStartTime = timeLine.startTime;
+                    file.animationEndTime = timeLine.endTime;
+                } else {
+                    file.animationStartTime = std::min(file.animationStartTime, timeLine.startTime);
+                    file.animationEndTime = std::max(file.animationEndTime, timeLine.endTime);
+                }
+                file.AnimationTimeLines.push_back(timeLine);
+                sampler.timeLineIndex = static_cast<int>(file.AnimationTimeLines.size()) - 1;
+            }
+        }
+    }
+    CompileAnimationClips(file);
+}
+
+void buildCharacter(const Options& options, ModelFile& file) {
+    const int numJoints = options.joints;
+    file.Nodes.resize(numJoints);
+    for (int i = 0; i < numJoints; i++) {
+        ModelNode& node = file.Nodes[i];
+        node.name = "joint";
+        node.parentIndex = i == 0 ? -1 : (i % CHAIN_LENGTH == 1 ? 0 : i - 1);
+        node.translation = Vector3f(0.0f, i == 0 ? 1.0f : 0.1f, 0.0f);
+        if (node.parentIndex >= 0) {
+            file.Nodes[node.parentIndex].children.push_back(i);
+        }
+    }
+    file.Nodes[1].weights.assign(NUM_MORPH_WEIGHTS, 0.0f);
+
+    ModelBuilder builder(file);
+    const int walkTimes =
+        builder.addAccessor(keyTimes(WALK_KEYS, 1.0f / 30.0f), WALK_KEYS, ACCESSOR_SCALAR);
+    const int blinkTimes = builder.addAccessor(
+        std::vector<float>(BLINK_TIMES, BLINK_TIMES + BLINK_KEYS), BLINK_KEYS, ACCESSOR_SCALAR);
+
+    std::vector<ChannelDesc> walk;
+    for (int joint = 0; joint < numJoints; joint++) {
+        std::vector<float> rotations;
+        for (int key = 0; key < WALK_KEYS; key++) {
+            const float angle = sinf(key * 0.2f + joint * 0.5f) * 0.6f;
+            const Quatf q(Vector3f(joint % 3 == 0, joint % 3 == 1, joint % 3 == 2), angle);
+            rotations.insert(rotations.end(), {q.x, q.y, q.z, q.w});
+        }
+        walk.push_back(
+            {joint,
+             MODEL_ANIMATION_PATH_ROTATION,
+             walkTimes,
+             builder.addAccessor(rotations, WALK_KEYS, ACCESSOR_VEC4),
+             MODEL_ANIMATION_INTERPOLATION_LINEAR,
+             -1});
+    }
+    std::vector<float> translations;
+    std::vector<float> scales;
+    std::vector<float> weights;
+    for (int key = 0; key < WALK_KEYS; key++) {
+        translations.insert(
+            translations.end(), {0.0f, 1.0f + 0.05f * sinf(key * 0.4f), key * 0.04f});
+        const float s = 1.0f + 0.02f * cosf(key * 0.4f);
+        scales.insert(scales.end(), {s, s, s});
+        for (int w = 0; w < NUM_MORPH_WEIGHTS; w++) {
+            weights.push_back(0.5f + 0.5f * sinf(key * 0.3f + w));
+        }
+    }
+    walk.push_back(
+        {0,
+         MODEL_ANIMATION_PATH_TRANSLATION,
+         walkTimes,
+         builder.addAccessor(translations, WALK_KEYS, ACCESSOR_VEC3),
+         MODEL_ANIMATION_INTERPOLATION_LINEAR,
+         -1});
+    walk.push_back(
+        {0,
+         MODEL_ANIMATION_PATH_SCALE,
+         walkTimes,
+         builder.addAccessor(scales, WALK_KEYS, ACCESSOR_VEC3),
+         MODEL_ANIMATION_INTERPOLATION_STEP,
+         -1});
+    walk.push_back(
+        {1,
+         MODEL_ANIMATION_PATH_WEIGHTS,
+         walkTimes,
+         builder.addAccessor(weights, WALK_KEYS * NUM_MORPH_WEIGHTS, ACCESSOR_SCALAR),
+         MODEL_ANIMATION_INTERPOLATION_LINEAR,
+         -1});
+
+    std::vector<float> blinkWeights;
+    for (int key = 0; key < BLINK_KEYS; key++) {
+        for (int w = 0; w < NUM_MORPH_WEIGHTS; w++) {
+            blinkWeights.push_back(w == 3 ? (key % 2 == 0 ? 0.0f : 0.4f) : 0.0f);
+        }
+    }
+    std::vector<ChannelDesc> blink = {
+        {1,
+         MODEL_ANIMATION_PATH_WEIGHTS,
+         blinkTimes,
+         builder.addAccessor(blinkWeights, BLINK_KEYS * NUM_MORPH_WEIGHTS, ACCESSOR_SCALAR),
+         MODEL_ANIMATION_INTERPOLATION_LINEAR,
+         3}};
+
+    builder.finish();
+    addAnimation(file, "walk", walk);
+    addAnimation(file, "blink", blink);
+    createTimeLines(file);
+
+    for (ModelNode& node : file.Nodes) {
+        Matrix4f local;
+        CalculateTransformFromRTS(&local, node.rotation, node.translation, node.scale);
+        node.SetLocalTransform(local);
+    }
+    file.Nodes[0].RecalculateGlobalTransform(file);
+}
+
+void recalculateGlobals(ModelState& state) {
+    state.UpdateGlobalTransforms();
+}
+
+float characterTime(int frame, int character) {
+    return frame / 72.0f + character * 0.037f;
+}
+
+void animateApply(std::vector<ModelState>& states, int frame) {
+    for (size_t c = 0; c < states.size(); c++) {
+        ModelState& state = states[c];
+        state.CalculateAnimationFrameAndFraction(
+            MODEL_ANIMATION_TIME_TYPE_LOOP_FORWARD, characterTime(frame, static_cast<int>(c)));
+        for (int i = 0; i < static_cast<int>(state.mf->Animations.size()); i++) {
+            ApplyAnimation(state, i);
+        }
+        recalculateGlobals(state);
+    }
+}
+
+void animateClip(std::vector<ModelState>& states, int frame) {
+    for (size_t c = 0; c < states.size(); c++) {
+        ModelState& state = states[c];
+        const float time = state.GetAnimationTime(
+            MODEL_ANIMATION_TIME_TYPE_LOOP_FORWARD, characterTime(frame, static_cast<int>(c)));
+        for (const ModelAnimationClip& clip : state.mf->AnimationClips) {
+            SampleAnimationClip(state, clip, time);
+        }
+        recalculateGlobals(state);
+    }
+}
+
+void animateBatch(ModelAnimationBatch& batch, std::vector<ModelState>& states, int frame) {
+    batch.Clear();
+    for (size_t c = 0; c < states.size(); c++) {
+        ModelState& state = states[c];
+        const float time = state.GetAnimationTime(
+            MODEL_ANIMATION_TIME_TYPE_LOOP_FORWARD, characterTime(frame, static_cast<int>(c)));
+        for (const ModelAnimationClip& clip : state.mf->AnimationClips) {
+            batch.Add(state, clip, time);
+        }
+    }
+    batch.Evaluate();
+}
+
+float maxDifference(const std::vector<ModelState>& a, const std::vector<ModelState>& b) {
+    float difference = 0.0f;
+    for (size_t c = 0; c < a.size(); c++) {
+        for (size_t n = 0; n < a[c].nodeStates.size(); n++) {
+            const Matrix4f ma = a[c].nodeStates[n].GetGlobalTransform();
+            const Matrix4f mb = b[c].nodeStates[n].GetGlobalTransform();
+            for (int i = 0; i < 4; i++) {
+                for (int j = 0; j < 4; j++) {
+                    difference = std::max(difference, fabsf(ma.M[i][j] - mb.M[i][j]));
+                }
+            }
+            for (size_t w = 0; w < a[c].nodeStates[n].weights.size(); w++) {
+                difference = std::max(
+                    difference,
+                    fabsf(a[c].nodeStates[n].weights[w] - b[c].nodeStates[n].weights[w]));
+            }
+        }
+    }
+    return difference;
+}
+
+struct Result {
+    double p50 = 0.0;
+    double p95 = 0.0;
+    double nsPerCharacter = 0.0;
+    double allocsPerFrame = 0.0;
+};
+
+double percentile(std::vector<double>& values, double p) {
+    const size_t index = std::min(values.size() - 1, static_cast<size_t>(p * values.size()));
+    std::nth_element(values.begin(), values.begin() + index, values.end());
+    return values[index];
+}
+
+template <typename Animate>
+Result measure(const Options& options, Animate animate) {
+    animate(0); // calentamiento: scratch y capacidad de las listas
+    std::vector<double> frameNs(options.frames);
+    double totalNs = 0.0;
+    const uint64_t allocationsBefore = totalAllocations.load();
+    for (int frame = 0; frame < options.frames; frame++) {
+        const Clock::time_point before = Clock::now();
+        animate(frame);
+        frameNs[frame] = std::chrono::duration<double, std::nano>(Clock::now() - before).count();
+        totalNs += frameNs[frame];
+    }
+    const uint64_t allocations = totalAllocations.load() - allocationsBefore;
+    Result result;
+    result.nsPerCharacter = totalNs / options.frames / options.characters;
+    result.allocsPerFrame = static_cast<double>(allocations) / options.frames;
+    result.p50 = percentile(frameNs, 0.50);
+    result.p95 = percentile(frameNs, 0.95);
+    return result;
+}
+
+void printResult(const char* name, const Result& r) {
+    printf(
+        "%-18s %10.0f %10.0f %12.1f %10.1f\n",
+        name,
+        r.p50,
+        r.p95,
+        r.nsPerCharacter,
+        r.allocsPerFrame);
+}
+
+//==============================================================
+// Escena estatica
+//==============================================================
+
+void buildScene(const Options& options, ModelFile& file) {
+    file.Nodes.resize(options.sceneNodes);
+    for (int i = 0; i < options.sceneNodes; i++) {
+        ModelNode& node = file.Nodes[i];
+        node.name = "node";
+        node.parentIndex = i == 0 ? -1 : (i - 1) / 4;
+        node.translation = Vector3f(0.1f * (i % 4), 0.2f, 0.0f);
+        node.rotation = Quatf(Vector3f(0.0f, 1.0f, 0.0f), 0.1f * (i % 7));
+        if (node.parentIndex >= 0) {
+            file.Nodes[node.parentIndex].children.push_back(i);
+        }
+        Matrix4f local;
+        CalculateTransformFromRTS(&local, node.rotation, node.translation, node.scale);
+        node.SetLocalTransform(local);
+    }
+    file.Nodes[0].RecalculateGlobalTransform(file);
+}
+
+// La ruta anterior: cada nodo multiplica por su padre y baja por children
+void recalculateRecursive(
+    const ModelState& state,
+    int nodeIndex,
+    const Matrix4f& parent,
+    std::vector<Matrix4f>& globals) {
+    const ModelNodeState& nodeState = state.nodeStates[nodeIndex];
+    globals[nodeIndex] = parent * nodeState.GetLocalTransform();
+    for (const int child : nodeState.node->children) {
+        recalculateRecursive(state, child, globals[nodeIndex], globals);
+    }
+}
+
+float maxSceneDifference(const ModelState& state, const std::vector<Matrix4f>& globals) {
+    float difference = 0.0f;
+    for (size_t n = 0; n < state.nodeStates.size(); n++) {
+        const Matrix4f& m = state.nodeStates[n].GetGlobalTransform();
+        for (int i = 0; i < 4; i++) {
+            for (int j = 0; j < 4; j++) {
+                difference = std::max(difference, fabsf(m.M[i][j] - globals[n].M[i][j]));
+            }
+        }
+    }
+    return difference;
+}
+
+struct SceneResult {
+    double recursiveNs = 0.0;
+    double flatNs = 0.0;
+    float difference = 0.0f;
+};
+
+// moveScene: SetMatrix cada frame (todo sucio); si no, solo se animan los nodos de la lista
+SceneResult measureScene(const Options& options, ModelState& state, bool moveScene) {
+    std::vector<Matrix4f> globals(state.nodeStates.size());
+    // Hojas repartidas por el arbol, como objetos sueltos de una escena; los ultimos 3/4 de los
+    // nodos no tienen hijos
+    std::vector<int> animated;
+    const int numLeaves = options.sceneNodes - (options.sceneNodes - 1) / 4 - 1;
+    for (int k = 0; k < options.sceneAnimated; k++) {
+        animated.push_back(
+            options.sceneNodes - 1 -
+            static_cast<int>(static_cast<int64_t>(k) * numLeaves / options.sceneAnimated));
+    }
+    SceneResult result;
+    for (int frame = 0; frame < options.frames; frame++) {
+        const Matrix4f modelMatrix = Matrix4f::Translation(0.0f, 0.0f, frame * 0.001f);
+        if (!moveScene) {
+            for (const int node : animated) {
+                ModelNodeState& nodeState = state.nodeStates[node];
+                nodeState.rotation = Quatf(Vector3f(0.0f, 0.0f, 1.0f), frame * 0.01f + node);
+                nodeState.CalculateLocalTransform();
+            }
+        }
+
+        const Clock::time_point t0 = Clock::now();
+        recalculateRecursive(state, 0, moveScene ? modelMatrix : state.GetMatrix(), globals);
+        const Clock::time_point t1 = Clock::now();
+        if (moveScene) {
+            state.SetMatrix(modelMatrix);
+        } else {
+            state.UpdateGlobalTransforms();
+        }
+        const Clock::time_point t2 = Clock::now();
+
+        result.recursiveNs += std::chrono::duration<double, std::nano>(t1 - t0).count();
+        result.flatNs += std::chrono::duration<double, std::nano>(t2 - t1).count();
+        if (frame % 50 == 0) {
+            result.difference = std::max(result.difference, maxSceneDifference(state, globals));
+        }
+    }
+    result.recursiveNs /= options.frames;
+    result.flatNs /= options.frames;
+    return result;
+}
+
+void printSceneResult(const char* name, const SceneResult& r) {
+    printf(
+        "%-18s %12.0f %12.0f %8.1fx\n",
+        name,
+        r.recursiveNs,
+        r.flatNs,
+        r.flatNs > 0.0 ? r.recursiveNs / r.flatNs : 0.0);
+}
+
+void printUsage() {
+    fprintf(
+        stderr,
+        "usage: prelibreria_anim_bench [--characters N] [--joints N] [--frames N] [--threads N]\n"
+        "           [--scene-nodes N] [--scene-animated N]\n"
+        "           [--max-ns-per-character N] [--max-allocs-per-frame N]\n");
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    for (int i = 1; i < argc; i++) {
+        const bool hasValue = i + 1 < argc;
+        if (strcmp(argv[i], "--characters") == 0 && hasValue) {
+            options.characters = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--joints") == 0 && hasValue) {
+            options.joints = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--frames") == 0 && hasValue) {
+            options.frames = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--threads") == 0 && hasValue) {
+            options.threads = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--scene-nodes") == 0 && hasValue) {
+            options.sceneNodes = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--scene-animated") == 0 && hasValue) {
+            options.sceneAnimated = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--max-ns-per-character") == 0 && hasValue) {
+            options.maxNsPerCharacter = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--max-allocs-per-frame") == 0 && hasValue) {
+            options.maxAllocsPerFrame = atof(argv[++i]);
+        } else {
+            printUsage();
+            return 1;
+        }
+    }
+    if (options.characters <= 0 || options.joints < 2 || options.frames <= 0 ||
+        options.threads < 0 || options.sceneNodes < 2 || options.sceneAnimated < 0 ||
+        options.sceneAnimated > options.sceneNodes / 2) {
+        printUsage();
+        return 1;
+    }
+
+    // ~ModelFile libera texturas y geometria GL (ModelFile.cpp, con los cargadores), asi que
+    // el modelo se queda vivo hasta el final del proceso
+    ModelFile* file = new ModelFile();
+    buildCharacter(options, *file);
+
+    std::vector<ModelState> applyStates(options.characters);
+    std::vector<ModelState> clipStates(options.characters);
+    std::vector<ModelState> batchStates(options.characters);
+    for (int c = 0; c < options.characters; c++) {
+        applyStates[c].GenerateStateFromModelFile(file);
+        clipStates[c].GenerateStateFromModelFile(file);
+        batchStates[c].GenerateStateFromModelFile(file);
+    }
+    ModelAnimationBatch batch;
+    batch.SetNumWorkerThreads(options.threads);
+
+    // Las tres rutas en los mismos frames deben dejar las mismas matrices y pesos
+    float difference = 0.0f;
+    for (int frame = 0; frame < 200; frame += 7) {
+        animateApply(applyStates, frame);
+        animateClip(clipStates, frame);
+        animateBatch(batch, batchStates, frame);
+        difference = std::max(difference, maxDifference(applyStates, clipStates));
+        difference = std::max(difference, maxDifference(applyStates, batchStates));
+    }
+
+    const Result apply = measure(options, [&](int frame) { animateApply(applyStates, frame); });
+    const Result clip = measure(options, [&](int frame) { animateClip(clipStates, frame); });
+    const Result batched =
+        measure(options, [&](int frame) { animateBatch(batch, batchStates, frame); });
+
+    printf(
+        "%d characters, %d joints, %d channels, %d frames, %d worker threads\n",
+        options.characters,
+        options.joints,
+        static_cast<int>(file->Animations[0].channels.size() + file->Animations[1].channels.size()),
+        options.frames,
+        options.threads);
+    printf("%-18s %10s %10s %12s %10s\n", "", "ns/f p50", "ns/f p95", "ns/character", "allocs/f");
+    printResult("apply", apply);
+    printResult("clip", clip);
+    char batchName[32];
+    snprintf(batchName, sizeof(batchName), "batch (%d+1 thr)", options.threads);
+    printResult(batchName, batched);
+    printf("max difference vs apply %g\n", difference);
+
+    ModelFile* sceneFile = new ModelFile();
+    buildScene(options, *sceneFile);
+    ModelState sceneState;
+    sceneState.GenerateStateFromModelFile(sceneFile);
+    const SceneResult fewNodes = measureScene(options, sceneState, false);
+    const SceneResult moved = measureScene(options, sceneState, true);
+    printf(
+        "\nstatic scene, %d nodes, %d animated per frame\n",
+        options.sceneNodes,
+        options.sceneAnimated);
+    printf("%-18s %12s %12s %9s\n", "", "recursive ns", "flat ns", "speedup");
+    printSceneResult("animated nodes", fewNodes);
+    printSceneResult("SetMatrix", moved);
+    const float sceneDifference = std::max(fewNodes.difference, moved.difference);
+    printf("max difference vs recursive %g\n", sceneDifference);
+
+    if (difference > 1e-4f) {
+        printf("  ^ clips do not match ApplyAnimation\n");
+        return 1;
+    }
+    if (sceneDifference > 1e-4f) {
+        printf("  ^ flattened hierarchy does not match the recursive one\n");
+        return 1;
+    }
+    bool regression = false;
+    if (options.maxNsPerCharacter > 0.0 && batched.nsPerCharacter > options.maxNsPerCharacter) {
+        printf("  ^ ns/character over threshold\n");
+        regression = true;
+    }
+    if (options.maxAllocsPerFrame >= 0.0 && batched.allocsPerFrame > options.maxAllocsPerFrame) {
+        printf("  ^ allocs/frame over threshold\n");
+        regression = true;
+    }
+    return regression ? 2 : 0;
+}
@@ -0,0 +1,290 @@
+// Microbenchmark del culling de superficies de BuildModelSurfaceList (Model/ModelRender.cpp).
+//
+//   prelibreria_cull_bench [--counts 1000,5000,10000,50000] [--frames N] [--seed N]
+//                          [--max-ns-per-bounds N]
+//
+// Genera N bounds locales con matrices de modelo aleatorias (rotacion, escala y traslacion)
+// repartidas alrededor de una camara con proyeccion de 90 grados, y las pasa cada frame por:
+//
+//   corners   el BoundsSortCullKey original: vp * model y las 8 esquinas por bounds
+//   scalar    ovrFrustumCuller sin SIMD (Add + Cull)
+//   simd      ovrFrustumCuller con SSE o NEON, lo que haya en la plataforma
+//
+// Por cada caso saca ns/frame (p50), ns por bounds, la parte de Cull (sin Add) y cuantas
+// quedan visibles. Comprueba ademas que ninguna superficie visible para corners quede fuera
+// con el culler (el culler usa la caja alrededor de los bounds transformados, asi que puede
+// dejar alguna mas, nunca menos) y que scalar y simd den la misma visibilidad. Si no, termina
+// con codigo 1; el umbral --max-ns-per-bounds hace que termine con codigo 2 si simd lo supera.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "Render/FrustumCuller.h"
+
+using OVR::Bounds3f;
+using OVR::Matrix4f;
+using OVR::Quatf;
+using OVR::Vector3f;
+using OVR::Vector4f;
+using OVRFW::ovrFrustumCuller;
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+struct Options {
+    std::vector<int> counts = {1000, 5000, 10000, 50000};
+    int frames = 200;
+    unsigned seed = 1;
+    double maxNsPerBounds = 0.0; // 0 = sin umbral
+};
+
+struct Scene {
+    std::vector<Bounds3f> bounds;
+    std::vector<Matrix4f> models;
+};
+
+// Copia del BoundsSortCullKey que habia en ModelRender.cpp, como referencia
+float cornersSortCullKey(const Bounds3f& bounds, const Matrix4f& mvp) {
+    if (bounds.b[1].x == bounds.b[0].x && bounds.b[1].y == bounds.b[0].y) {
+        return 0;
+    }
+    Vector4f c[8];
+    for (int i = 0; i < 8; i++) {
+        Vector4f world;
+        world.x = bounds.b[(i & 1)].x;
+        world.y = bounds.b[(i & 2) >> 1].y;
+        world.z = bounds.b[(i & 4) >> 2].z;
+        world.w = 1.0f;
+        c[i] = mvp.Transform(world);
+    }
+    // Para cada plano, fuera si las 8 esquinas estan fuera
+    for (int axis = 0; axis < 3; axis++) {
+        for (int side = 0; side < 2; side++) {
+            int i;
+            for (i = 0; i < 8; i++) {
+                const float v = (axis == 0) ? c[i].x : (axis == 1) ? c[i].y : c[i].z;
+                if (side == 0 ? (v > -c[i].w) : (v < c[i].w)) {
+                    break;
+                }
+            }
+            if (i == 8) {
+                return 0;
+            }
+        }
+    }
+    float maxW = 0;
+    for (int i = 0; i < 8; i++) {
+        maxW = std::max(maxW, c[i].w);
+    }
+    return maxW;
+}
+
+void buildScene(const int count, const unsigned seed, Scene& scene) {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+    std::uniform_real_distribution<float> size(0.05f, 2.0f);
+    scene.bounds.resize(count);
+    scene.models.resize(count);
+    for (int i = 0; i < count; i++) {
+        const Vector3f extent(size(rng), size(rng), size(rng));
+        const Vector3f offset(unit(rng) * 0.5f, unit(rng) * 0.5f, unit(rng) * 0.5f);
+        scene.bounds[i] = Bounds3f(offset - extent, offset + extent);
+        // Una de cada 64 vacia, como las que se usan para desactivar superficies
+        if ((i & 63) == 63) {
+            scene.bounds[i] = Bounds3f(offset, offset);
+        }
+        Quatf rotation(unit(rng), unit(rng), unit(rng), unit(rng) + 2.0f);
+        rotation.Normalize();
+        const Vector3f position(unit(rng) * 40.0f, unit(rng) * 10.0f, unit(rng) * 40.0f);
+        scene.models[i] = Matrix4f::Translation(position) * Matrix4f(rotation) *
+            Matrix4f::Scaling(0.5f + 0.5f * (unit(rng) + 1.0f));
+    }
+}
+
+struct Result {
+    double nsPerFrame = 0.0;
+    double cullNsPerFrame = 0.0; // solo Cull, sin Add
+    int visible = 0;
+};
+
+double median(std::vector<double>& values) {
+    std::nth_element(values.begin(), values.begin() + values.size() / 2, values.end());
+    return values[values.size() / 2];
+}
+
+Result runCorners(const Scene& scene, const Matrix4f& vp, const int frames,
+                  std::vector<float>& keys) {
+    const int count = static_cast<int>(scene.bounds.size());
+    keys.resize(count);
+    std::vector<double> frameNs(frames);
+    for (int f = 0; f < frames; f++) {
+        const Clock::time_point before = Clock::now();
+        for (int i = 0; i < count; i++) {
+            keys[i] = cornersSortCullKey(scene.bounds[i], vp * scene.models[i]);
+        }
+        frameNs[f] = std::chrono::duration<double, std::nano>(Clock::now() - before).count();
+    }
+    Result result;
+    result.nsPerFrame = median(frameNs);
+    result.cullNsPerFrame = result.nsPerFrame;
+    for (float key : keys) {
+        result.visible += (key > 0.0f);
+    }
+    return result;
+}
+
+Result runCuller(const Scene& scene, const Matrix4f& vp, const int frames, const bool simd,
+                 std::vector<float>& keys) {
+    const int count = static_cast<int>(scene.bounds.size());
+    ovrFrustumCuller culler;
+    culler.SetSimdEnabled(simd);
+    culler.Reserve(count);
+    std::vector<double> frameNs(frames);
+    std::vector<double> cullNs(frames);
+    Result result;
+    for (int f = 0; f < frames; f++) {
+        const Clock::time_point before = Clock::now();
+        culler.Clear();
+        for (int i = 0; i < count; i++) {
+            culler.Add(scene.bounds[i], scene.models[i]);
+        }
+        const Clock::time_point added = Clock::now();
+        result.visible = culler.Cull(vp);
+        const Clock::time_point after = Clock::now();
+        frameNs[f] = std::chrono::duration<double, std::nano>(after - before).count();
+        cullNs[f] = std::chrono::duration<double, std::nano>(after - added).count();
+    }
+    result.nsPerFrame = median(frameNs);
+    result.cullNsPerFrame = median(cullNs);
+    keys = culler.GetSortKeys();
+    return result;
+}
+
+bool parseCounts(const char* text, std::vector<int>& counts) {
+    counts.clear();
+    const std::string list(text);
+    size_t start = 0;
+    while (start <= list.size()) {
+        const size_t end = std::min(list.find(',', start), list.size());
+        const int count = atoi(list.substr(start, end - start).c_str());
+        if (count <= 0) {
+            return false;
+        }
+        counts.push_back(count);
+        start = end + 1;
+    }
+    return !counts.empty();
+}
+
+void printUsage() {
+    fprintf(
+        stderr,
+        "usage: prelibreria_cull_bench [--counts 1000,5000,...] [--frames N] [--seed N]\n"
+        "           [--max-ns-per-bounds N]\n");
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    for (int i = 1; i < argc; i++) {
+        const bool hasValue = i + 1 < argc;
+        if (strcmp(argv[i], "--counts") == 0 && hasValue) {
+            if (!parseCounts(argv[++i], options.counts)) {
+                printUsage();
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--frames") == 0 && hasValue) {
+            options.frames = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--seed") == 0 && hasValue) {
+            options.seed = static_cast<unsigned>(atoi(argv[++i]));
+        } else if (strcmp(argv[i], "--max-ns-per-bounds") == 0 && hasValue) {
+            options.maxNsPerBounds = atof(argv[++i]);
+        } else {
+            printUsage();
+            return 1;
+        }
+    }
+    if (options.frames <= 0) {
+        printUsage();
+        return 1;
+    }
+
+    // Camara a 1.6m mirando a -Z, 90 grados, near 0.1 y far 100
+    const Matrix4f projection =
+        Matrix4f::PerspectiveRH(OVR::DegreeToRad(90.0f), 1.0f, 0.1f, 100.0f);
+    const Matrix4f view = Matrix4f::LookAtRH(
+        Vector3f(0.0f, 1.6f, 0.0f), Vector3f(0.3f, 1.4f, -1.0f), Vector3f(0.0f, 1.0f, 0.0f));
+    const Matrix4f vp = projection * view;
+
+    printf(
+        "%d frames, SIMD %s\n",
+        options.frames,
+        ovrFrustumCuller::HasSimd() ? "available" : "not available (simd = scalar)");
+    printf(
+        "%8s  %-8s %12s %10s %12s %8s %8s\n",
+        "bounds",
+        "case",
+        "ns/frame",
+        "ns/bounds",
+        "cull ns",
+        "visible",
+        "speedup");
+
+    bool mismatch = false;
+    bool regression = false;
+    for (const int count : options.counts) {
+        Scene scene;
+        buildScene(count, options.seed, scene);
+
+        std::vector<float> cornerKeys;
+        std::vector<float> scalarKeys;
+        std::vector<float> simdKeys;
+        const Result corners = runCorners(scene, vp, options.frames, cornerKeys);
+        const Result scalar = runCuller(scene, vp, options.frames, false, scalarKeys);
+        const Result simd = runCuller(scene, vp, options.frames, true, simdKeys);
+
+        const struct {
+            const char* name;
+            const Result& result;
+        } cases[] = {{"corners", corners}, {"scalar", scalar}, {"simd", simd}};
+        for (const auto& c : cases) {
+            printf(
+                "%8d  %-8s %12.0f %10.2f %12.0f %8d %7.1fx\n",
+                count,
+                c.name,
+                c.result.nsPerFrame,
+                c.result.nsPerFrame / count,
+                c.result.cullNsPerFrame,
+                c.result.visible,
+                corners.nsPerFrame / c.result.nsPerFrame);
+        }
+
+        int lost = 0;
+        int different = 0;
+        for (int i = 0; i < count; i++) {
+            lost += (cornerKeys[i] > 0.0f && simdKeys[i] <= 0.0f);
+            different += ((scalarKeys[i] > 0.0f) != (simdKeys[i] > 0.0f));
+        }
+        if (lost > 0 || different > 0) {
+            printf(
+                "  ^ %d visible bounds culled, %d scalar/simd visibility differences\n",
+                lost,
+                different);
+            mismatch = true;
+        }
+        if (options.maxNsPerBounds > 0.0 && simd.nsPerFrame / count > options.maxNsPerBounds) {
+            printf("  ^ ns/bounds over threshold\n");
+            regression = true;
+        }
+    }
+    return mismatch ? 1 : (regression ? 2 : 0);
+}
@@ -0,0 +1,325 @@
+#include "MockRuntime.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include "Misc/Log.h"
+
+#include "Recorder/PoseDecimator.h"
+#include "Replay/SessionReplay.h"
+
+namespace {
+
+const float PI = 3.14159265f;
+
+struct SourcePath {
+    const char* path;
+    MockInputSource source;
+};
+
+const SourcePath SOURCE_PATHS[] = {
+    {"/input/aim/pose", SOURCE_AIM_POSE},
+    {"/input/grip/pose", SOURCE_GRIP_POSE},
+    {"/input/trigger/value", SOURCE_TRIGGER_VALUE},
+    {"/input/squeeze/value", SOURCE_SQUEEZE_VALUE},
+    {"/input/thumbstick", SOURCE_THUMBSTICK},
+    {"/input/thumbstick/click", SOURCE_THUMBSTICK_CLICK},
+    {"/input/thumbstick/touch", SOURCE_THUMBSTICK_TOUCH},
+    {"/input/thumbrest/touch", SOURCE_THUMBREST_TOUCH},
+    {"/input/trigger/touch", SOURCE_TRIGGER_TOUCH},
+    {"/input/a/click", SOURCE_A_CLICK},
+    {"/input/b/click", SOURCE_B_CLICK},
+    {"/input/x/click", SOURCE_X_CLICK},
+    {"/input/y/click", SOURCE_Y_CLICK},
+    {"/input/menu/click", SOURCE_MENU_CLICK},
+    {"/input/select/click", SOURCE_SELECT_CLICK},
+};
+
+uint32_t bit(MockInputSource source) {
+    return 1u << source;
+}
+
+XrQuaternionf multiplyQuat(const XrQuaternionf& a, const XrQuaternionf& b) {
+    return {
+        a.w * b.x + a.x * b.w + a.y * b.z - a.z * b.y,
+        a.w * b.y - a.x * b.z + a.y * b.w + a.z * b.x,
+        a.w * b.z + a.x * b.y - a.y * b.x + a.z * b.w,
+        a.w * b.w - a.x * b.x - a.y * b.y - a.z * b.z};
+}
+
+XrVector3f rotate(const XrQuaternionf& q, const XrVector3f& v) {
+    // v + 2w(u x v) + 2u x (u x v), con u la parte vectorial de q
+    const float cx = q.y * v.z - q.z * v.y;
+    const float cy = q.z * v.x - q.x * v.z;
+    const float cz = q.x * v.y - q.y * v.x;
+    return {
+        v.x + 2.0f * (q.w * cx + q.y * cz - q.z * cy),
+        v.y + 2.0f * (q.w * cy + q.z * cx - q.x * cz),
+        v.z + 2.0f * (q.w * cz + q.x * cy - q.y * cx)};
+}
+
+XrQuaternionf yawPitch(float yaw, float pitch) {
+    const XrQuaternionf y = {0.0f, std::sin(0.5f * yaw), 0.0f, std::cos(0.5f * yaw)};
+    const XrQuaternionf p = {std::sin(0.5f * pitch), 0.0f, 0.0f, std::cos(0.5f * pitch)};
+    return multiplyQuat(y, p);
+}
+
+XrPosef framePose(
+    float px,
+    float py,
+    float pz,
+    float rx,
+    float ry,
+    float rz,
+    float rw) {
+    return {{rx, ry, rz, rw}, {px, py, pz}};
+}
+
+// Misma asignacion de botones que XrApp::SyncActionSets, al reves
+void setButtons(const FrameData& frame, MockInputState& out) {
+    using OVRFW::ovrApplFrameIn;
+    const uint32_t buttons = frame.allButtons;
+    MockHandState& left = out.hands[0];
+    MockHandState& right = out.hands[1];
+    left.buttons = 0;
+    right.buttons = 0;
+    if (buttons & ovrApplFrameIn::kButtonA) {
+        right.buttons |= bit(SOURCE_A_CLICK);
+    }
+    if (buttons & ovrApplFrameIn::kButtonB) {
+        right.buttons |= bit(SOURCE_B_CLICK);
+    }
+    if (buttons & ovrApplFrameIn::kButtonX) {
+        left.buttons |= bit(SOURCE_X_CLICK);
+    }
+    if (buttons & ovrApplFrameIn::kButtonY) {
+        left.buttons |= bit(SOURCE_Y_CLICK);
+    }
+    if (buttons & ovrApplFrameIn::kButtonMenu) {
+        left.buttons |= bit(SOURCE_MENU_CLICK);
+    }
+    if (buttons & ovrApplFrameIn::kButtonLeftThumbStick) {
+        left.buttons |= bit(SOURCE_THUMBSTICK_CLICK);
+    }
+    if (buttons & ovrApplFrameIn::kButtonRightThumbStick) {
+        right.buttons |= bit(SOURCE_THUMBSTICK_CLICK);
+    }
+    // La grabacion no dice de que mano es el grip
+    const float squeeze = (buttons & ovrApplFrameIn::kGripTrigger) ? 1.0f : 0.0f;
+    left.squeeze = squeeze;
+    right.squeeze = squeeze;
+}
+
+} // namespace
+
+MockInputSource mockInputSourceFor(const char* inputPath) {
+    for (const SourcePath& entry : SOURCE_PATHS) {
+        if (strcmp(entry.path, inputPath) == 0) {
+            return entry.source;
+        }
+    }
+    return SOURCE_NONE;
+}
+
+float MockHandState::value(MockInputSource source) const {
+    switch (source) {
+        case SOURCE_TRIGGER_VALUE:
+            return trigger;
+        case SOURCE_SQUEEZE_VALUE:
+            return squeeze;
+        case SOURCE_THUMBSTICK:
+            return thumbstick.x; // como float se lee el eje x
+        case SOURCE_SELECT_CLICK:
+            return trigger > 0.5f ? 1.0f : 0.0f;
+        case SOURCE_AIM_POSE:
+        case SOURCE_GRIP_POSE:
+        case SOURCE_NONE:
+            return 0.0f;
+        default:
+            return (buttons & bit(source)) ? 1.0f : 0.0f;
+    }
+}
+
+bool MockInput::loadRecording(const std::string& spec) {
+    SessionReplay replay;
+    bool loaded = false;
+    const std::string extension = ".vrmx";
+    if (spec.size() > extension.size() &&
+        spec.compare(spec.size() - extension.size(), std::string::npos, extension) == 0) {
+        loaded = replay.loadRange(spec, 0.0, 0.0);
+    } else {
+        std::vector<std::string> parts;
+        size_t start = 0;
+        while (start <= spec.size()) {
+            const size_t comma = std::min(spec.find(',', start), spec.size());
+            if (comma > start) {
+                parts.push_back(spec.substr(start, comma - start));
+            }
+            start = comma + 1;
+        }
+        loaded = replay.load(parts);
+    }
+    if (!loaded || replay.getFrameCount() == 0) {
+        ALOGE("MockRuntime: could not load recording %s", spec.c_str());
+        return false;
+    }
+    frames = replay.getFrames();
+    cursor = 0;
+    ALOG(
+        "MockRuntime: replaying %zu frames (%.1f s) from %s",
+        frames.size(),
+        frames.back().timestamp - frames.front().timestamp,
+        spec.c_str());
+    return true;
+}
+
+void MockInput::sample(double seconds, MockInputState& out) const {
+    if (isRecorded()) {
+        sampleRecorded(seconds, out);
+    } else {
+        sampleScripted(seconds, out);
+    }
+}
+
+void MockInput::sampleScripted(double seconds, MockInputState& out) const {
+    const float t = static_cast<float>(seconds);
+
+    // Cabeza de pie, mirando a los lados a 0.25Hz y asintiendo un poco
+    const float yaw = 0.35f * std::sin(2.0f * PI * 0.25f * t);
+    const float pitch = 0.1f * std::sin(2.0f * PI * 0.4f * t);
+    out.head.orientation = yawPitch(yaw, pitch);
+    out.head.position = {0.0f, 1.6f + 0.01f * std::sin(2.0f * PI * 1.5f * t), 0.0f};
+
+    for (int hand = 0; hand < 2; hand++) {
+        MockHandState& state = out.hands[hand];
+        const float side = hand == 0 ? -1.0f : 1.0f;
+        const float phase = 2.0f * PI * 0.5f * t + (hand == 0 ? 0.0f : PI);
+
+        // Circulos de 5cm delante del cuerpo
+        state.grip.orientation = yawPitch(0.2f * side * std::sin(phase), -0.3f);
+        state.grip.position = {
+            0.2f * side + 0.05f * std::cos(phase), 1.2f + 0.05f * std::sin(phase), -0.35f};
+        // El rayo sale un poco por delante y girado hacia abajo
+        const XrPosef gripFromAim = {yawPitch(0.0f, -0.5f), {0.0f, 0.0f, -0.05f}};
+        state.aim = MockPose::multiply(state.grip, gripFromAim);
+
+        state.trigger = 0.5f + 0.5f * std::sin(2.0f * PI * 0.3f * t + side);
+        state.squeeze = 0.5f + 0.5f * std::cos(2.0f * PI * 0.2f * t + side);
+        state.thumbstick = {std::cos(phase), std::sin(phase)};
+
+        // Un boton distinto cada cuarto de segundo, en un ciclo de dos segundos
+        const int slot = static_cast<int>(std::fmod(seconds, 2.0) * 4.0);
+        const MockInputSource cycle[2][8] = {
+            {SOURCE_X_CLICK,
+             SOURCE_NONE,
+             SOURCE_Y_CLICK,
+             SOURCE_THUMBSTICK_TOUCH,
+             SOURCE_MENU_CLICK,
+             SOURCE_THUMBREST_TOUCH,
+             SOURCE_THUMBSTICK_CLICK,
+             SOURCE_TRIGGER_TOUCH},
+            {SOURCE_NONE,
+             SOURCE_A_CLICK,
+             SOURCE_THUMBSTICK_TOUCH,
+             SOURCE_B_CLICK,
+             SOURCE_THUMBREST_TOUCH,
+             SOURCE_TRIGGER_TOUCH,
+             SOURCE_NONE,
+             SOURCE_THUMBSTICK_CLICK}};
+        const MockInputSource pressed = cycle[hand][std::min(std::max(slot, 0), 7)];
+        state.buttons = pressed == SOURCE_NONE ? 0 : bit(pressed);
+
+        // El izquierdo pierde el tracking el ultimo segundo de cada diez
+        state.tracked = hand == 1 || std::fmod(seconds, 10.0) < 9.0;
+    }
+}
+
+void MockInput::sampleRecorded(double seconds, MockInputState& out) const {
+    const double first = frames.front().timestamp;
+    const double duration = frames.back().timestamp - first;
+    const double timestamp = duration > 0.0 ? first + std::fmod(seconds, duration) : first;
+
+    // Normalmente el instante pedido esta en el mismo frame o en el siguiente
+    if (cursor >= frames.size() || frames[cursor].timestamp > timestamp ||
+        (cursor + 2 < frames.size() && frames[cursor + 2].timestamp <= timestamp)) {
+        auto it = std::upper_bound(
+            frames.begin(), frames.end(), timestamp, [](double t, const FrameData& frame) {
+                return t < frame.timestamp;
+            });
+        cursor = it == frames.begin() ? 0 : static_cast<size_t>(it - frames.begin()) - 1;
+    } else if (cursor + 1 < frames.size() && frames[cursor + 1].timestamp <= timestamp) {
+        cursor++;
+    }
+
+    FrameData frame;
+    const FrameData& a = frames[cursor];
+    const FrameData& b = cursor + 1 < frames.size() ? frames[cursor + 1] : a;
+    PoseDecimator::interpolate(a, b, timestamp, frame);
+
+    out.head = framePose(
+        frame.headPosX,
+        frame.headPosY,
+        frame.headPosZ,
+        frame.headRotX,
+        frame.headRotY,
+        frame.headRotZ,
+        frame.headRotW);
+
+    // Se graba la pose del grip; el rayo se toma igual
+    MockHandState& left = out.hands[0];
+    left.tracked = frame.leftControllerTracked;
+    left.grip = framePose(
+        frame.leftPosX,
+        frame.leftPosY,
+        frame.leftPosZ,
+        frame.leftRotX,
+        frame.leftRotY,
+        frame.leftRotZ,
+        frame.leftRotW);
+    left.aim = left.grip;
+    left.trigger = frame.leftTriggerValue;
+    left.thumbstick = {0.0f, 0.0f};
+
+    MockHandState& right = out.hands[1];
+    right.tracked = frame.rightControllerTracked;
+    right.grip = framePose(
+        frame.rightPosX,
+        frame.rightPosY,
+        frame.rightPosZ,
+        frame.rightRotX,
+        frame.rightRotY,
+        frame.rightRotZ,
+        frame.rightRotW);
+    right.aim = right.grip;
+    right.trigger = frame.rightTriggerValue;
+    right.thumbstick = {0.0f, 0.0f};
+
+    setButtons(frame, out);
+}
+
+namespace MockPose {
+
+XrPosef identity() {
+    return {{0.0f, 0.0f, 0.0f, 1.0f}, {0.0f, 0.0f, 0.0f}};
+}
+
+XrPosef multiply(const XrPosef& a, const XrPosef& b) {
+    XrPosef result;
+    result.orientation = multiplyQuat(a.orientation, b.orientation);
+    const XrVector3f offset = rotate(a.orientation, b.position);
+    result.position = {
+        a.position.x + offset.x, a.position.y + offset.y, a.position.z + offset.z};
+    return result;
+}
+
+XrPosef invert(const XrPosef& pose) {
+    XrPosef result;
+    result.orientation = {
+        -pose.orientation.x, -pose.orientation.y, -pose.orientation.z, pose.orientation.w};
+    const XrVector3f position = rotate(result.orientation, pose.position);
+    result.position = {-position.x, -position.y, -position.z};
+    return result;
+}
+
+} // namespace MockPose
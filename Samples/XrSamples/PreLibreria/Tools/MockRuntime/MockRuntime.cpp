@@ -0,0 +1,2140 @@
+// Runtime de OpenXR falso para medir XrApp::MainLoop sin casco (ver MockRuntime.h).
+//
+//   XR_RUNTIME_JSON=<build>/prelibreria_mock_runtime.json
+//   MOCKXR_FREE_RUN=1 MOCKXR_FRAMES=5000 MOCKXR_STATS=mainloop.csv xrsamples_PreLibreria
+//
+// Solo se exporta xrNegotiateLoaderRuntimeInterface; el resto se entrega por
+// xrGetInstanceProcAddr.
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#endif
+
+#include <GL/gl.h>
+
+#include "MockRuntime.h"
+
+#include <openxr/openxr_loader_negotiation.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "Misc/Log.h"
+
+#if defined(_WIN32)
+#define MOCKXR_EXPORT __declspec(dllexport)
+#else
+#define MOCKXR_EXPORT __attribute__((visibility("default")))
+#endif
+
+#ifndef GL_RGBA8
+#define GL_RGBA8 0x8058
+#endif
+#ifndef GL_SRGB8_ALPHA8
+#define GL_SRGB8_ALPHA8 0x8C43
+#endif
+
+namespace {
+
+const char* const RUNTIME_NAME = "PreLibreria mock runtime";
+const XrSystemId SYSTEM_ID = 1;
+const uint32_t VIEW_COUNT = 2;
+const uint32_t MAX_LAYER_COUNT = 16; // XrApp::MAX_NUM_LAYERS
+const uint32_t SWAPCHAIN_LENGTH = 3;
+const float IPD = 0.064f;
+const XrFovf EYE_FOV = {-0.785398f, 0.785398f, 0.785398f, -0.785398f}; // 90 grados
+
+const char* const CALL_NAMES[MOCK_CALL_COUNT] = {
+    "xrEnumerateInstanceExtensionProperties",
+    "xrCreateInstance",
+    "xrDestroyInstance",
+    "xrGetInstanceProperties",
+    "xrPollEvent",
+    "xrResultToString",
+    "xrStructureTypeToString",
+    "xrGetSystem",
+    "xrGetSystemProperties",
+    "xrEnumerateEnvironmentBlendModes",
+    "xrGetOpenGLGraphicsRequirementsKHR",
+    "xrCreateSession",
+    "xrDestroySession",
+    "xrBeginSession",
+    "xrEndSession",
+    "xrRequestExitSession",
+    "xrEnumerateReferenceSpaces",
+    "xrCreateReferenceSpace",
+    "xrGetReferenceSpaceBoundsRect",
+    "xrCreateActionSpace",
+    "xrLocateSpace",
+    "xrLocateSpaces",
+    "xrDestroySpace",
+    "xrEnumerateViewConfigurations",
+    "xrGetViewConfigurationProperties",
+    "xrEnumerateViewConfigurationViews",
+    "xrEnumerateSwapchainFormats",
+    "xrCreateSwapchain",
+    "xrDestroySwapchain",
+    "xrEnumerateSwapchainImages",
+    "xrAcquireSwapchainImage",
+    "xrWaitSwapchainImage",
+    "xrReleaseSwapchainImage",
+    "xrWaitFrame",
+    "xrBeginFrame",
+    "xrEndFrame",
+    "xrLocateViews",
+    "xrStringToPath",
+    "xrPathToString",
+    "xrCreateActionSet",
+    "xrDestroyActionSet",
+    "xrCreateAction",
+    "xrDestroyAction",
+    "xrSuggestInteractionProfileBindings",
+    "xrAttachSessionActionSets",
+    "xrGetCurrentInteractionProfile",
+    "xrGetActionStateBoolean",
+    "xrGetActionStateFloat",
+    "xrGetActionStateVector2f",
+    "xrGetActionStatePose",
+    "xrSyncActions",
+    "xrApplyHapticFeedback",
+    "xrStopHapticFeedback",
+};
+
+using Clock = std::chrono::steady_clock;
+
+uint64_t nowNs() {
+    return static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now().time_since_epoch())
+            .count());
+}
+
+// ---- Objetos detras de los handles ----
+
+struct Binding {
+    int hand; // 0 izquierda, 1 derecha
+    MockInputSource source;
+};
+
+struct ActionSet;
+
+struct Action {
+    ActionSet* set = nullptr;
+    XrActionType type = XR_ACTION_TYPE_BOOLEAN_INPUT;
+    std::string name;
+    std::vector<XrPath> subactionPaths;
+    std::vector<Binding> bindings; // del perfil elegido, al adjuntar los action sets
+};
+
+struct ActionSet {
+    std::string name;
+    std::vector<std::unique_ptr<Action>> actions;
+    bool attached = false;
+};
+
+struct Space {
+    bool isAction = false;
+    XrReferenceSpaceType referenceType = XR_REFERENCE_SPACE_TYPE_LOCAL;
+    Action* action = nullptr;
+    int hand = -1; // de la subaccion, -1 = la primera con binding de pose
+    XrPosef offset = {{0.0f, 0.0f, 0.0f, 1.0f}, {0.0f, 0.0f, 0.0f}};
+};
+
+struct Swapchain {
+    uint32_t width = 0;
+    uint32_t height = 0;
+    GLuint images[SWAPCHAIN_LENGTH] = {};
+    uint32_t next = 0; // siguiente imagen a adquirir
+};
+
+struct SuggestedBinding {
+    XrAction action;
+    XrPath path;
+};
+
+struct Session {
+    std::atomic<XrSessionState> state{XR_SESSION_STATE_UNKNOWN};
+    bool running = false; // entre xrBeginSession y xrEndSession, con frameMutex
+    bool exitRequested = false;
+    // Con XrApp en modo pipeline xrWaitFrame llega desde otro hilo que
+    // xrBeginFrame/xrEndFrame; estos tres campos van con frameMutex
+    std::mutex frameMutex;
+    std::condition_variable frameCv;
+    bool frameBegun = false;
+    bool waitedFrame = false;
+    std::vector<std::unique_ptr<Space>> spaces;
+    std::vector<std::unique_ptr<Swapchain>> swapchains;
+    std::vector<ActionSet*> attachedSets;
+    XrPath interactionProfile = XR_NULL_PATH;
+
+    // Reloj de frames, en ns de steady_clock (o virtual con freeRun)
+    uint64_t startNs = 0;
+    uint64_t nextVsyncNs = 0;
+    std::atomic<XrTime> lastDisplayTime{0}; // lo escribe xrWaitFrame, lo leen los eventos
+
+    // Entrada: la del ultimo xrSyncActions y la del anterior, para changedSinceLastSync
+    MockInputState synced;
+    MockInputState previousSynced;
+    XrTime syncTime = 0;
+    bool everSynced = false;
+    // Cache de la ultima muestra para xrLocateSpace/xrLocateViews
+    XrTime sampledTime = -1;
+    MockInputState sampled;
+};
+
+// Un frame entre xrWaitFrame y xrEndFrame
+struct FrameStart {
+    XrTime displayTime; // el predictedDisplayTime que se dio, xrEndFrame lo devuelve
+    uint64_t ns; // al volver xrWaitFrame
+    uint64_t runtimeNs; // runtimeNs en ese momento
+};
+
+// Frames esperados y sin terminar que se recuerdan como mucho
+const size_t MAX_FRAMES_IN_FLIGHT = 8;
+
+struct FrameStats {
+    uint64_t frames = 0;
+    uint64_t layers = 0;
+    uint64_t missedVsyncs = 0;
+    // En el orden de xrWaitFrame; con XrApp en modo pipeline hay mas de uno a la vez
+    std::deque<FrameStart> inFlight;
+    std::vector<uint32_t> appNs; // CPU del framework por frame, sin el runtime
+};
+
+struct Instance {
+    MockRuntimeConfig config;
+    MockInput input;
+    std::vector<std::string> paths; // XrPath - 1
+    std::unordered_map<std::string, XrPath> pathIds;
+    std::vector<std::unique_ptr<ActionSet>> actionSets;
+    std::vector<SuggestedBinding> touchBindings;
+    std::vector<SuggestedBinding> simpleBindings;
+    XrPath leftHandPath = XR_NULL_PATH;
+    XrPath rightHandPath = XR_NULL_PATH;
+    XrPath touchProfilePath = XR_NULL_PATH;
+    XrPath simpleProfilePath = XR_NULL_PATH;
+    std::unique_ptr<Session> session;
+    std::deque<XrEventDataSessionStateChanged> events;
+
+    // calls, runtimeNs y frameStats se tocan desde los dos hilos del modo pipeline
+    std::mutex statsMutex;
+    MockCallStats calls[MOCK_CALL_COUNT];
+    uint64_t runtimeNs = 0; // tiempo total dentro del runtime
+    FrameStats frameStats;
+};
+
+Instance* instance = nullptr;
+
+template <typename T, typename Handle>
+T* fromHandle(Handle handle) {
+    return (T*)(uintptr_t)handle;
+}
+
+template <typename Handle, typename T>
+Handle toHandle(T* object) {
+    return (Handle)(uintptr_t)object;
+}
+
+// Cuenta la llamada y su duracion, y mete la latencia configurada al entrar
+class ScopedCall {
+public:
+    explicit ScopedCall(MockCall c) : call(c), startNs(nowNs()) {
+        if (instance != nullptr && instance->config.latencyUs[call] > 0) {
+            // Espera activa: con sleep no se llega a microsegundos
+            const uint64_t endNs = startNs + instance->config.latencyUs[call] * 1000ull;
+            while (nowNs() < endNs) {
+            }
+        }
+    }
+
+    ~ScopedCall() {
+        if (instance == nullptr) {
+            return;
+        }
+        const uint64_t elapsed = nowNs() - startNs;
+        std::lock_guard<std::mutex> lock(instance->statsMutex);
+        MockCallStats& stats = instance->calls[call];
+        stats.calls++;
+        stats.totalNs += elapsed;
+        stats.maxNs = std::max(stats.maxNs, elapsed);
+        instance->runtimeNs += elapsed;
+    }
+
+    ScopedCall(const ScopedCall&) = delete;
+    ScopedCall& operator=(const ScopedCall&) = delete;
+
+private:
+    MockCall call;
+    uint64_t startNs;
+};
+
+// Rellena un array con la convencion de dos llamadas de OpenXR
+template <typename T>
+XrResult fillArray(
+    uint32_t capacity,
+    uint32_t* countOutput,
+    T* out,
+    const T* values,
+    uint32_t count) {
+    if (countOutput == nullptr) {
+        return XR_ERROR_VALIDATION_FAILURE;
+    }
+    *countOutput = count;
+    if (capacity == 0) {
+        return XR_SUCCESS;
+    }
+    if (capacity < count || out == nullptr) {
+        return XR_ERROR_SIZE_INSUFFICIENT;
+    }
+    for (uint32_t i = 0; i < count; i++) {
+        out[i] = values[i];
+    }
+    return XR_SUCCESS;
+}
+
+XrTime toXrTime(const Session& session, uint64_t ns) {
+    // Nunca 0, que en OpenXR es un tiempo invalido
+    return static_cast<XrTime>(ns - session.startNs) + 1000000000;
+}
+
+double sessionSeconds(XrTime time) {
+    return std::max<double>(0.0, static_cast<double>(time - 1000000000) * 1e-9);
+}
+
+void pushState(Session& session, XrSessionState state) {
+    session.state = state;
+    XrEventDataSessionStateChanged event = {XR_TYPE_EVENT_DATA_SESSION_STATE_CHANGED};
+    event.session = toHandle<XrSession>(&session);
+    event.state = state;
+    event.time = session.lastDisplayTime;
+    instance->events.push_back(event);
+}
+
+// Cuando la sesion esta corriendo y se ha pedido salir
+void beginExit(Session& session) {
+    if (session.exitRequested || !session.running) {
+        return;
+    }
+    session.exitRequested = true;
+    if (session.state == XR_SESSION_STATE_FOCUSED) {
+        pushState(session, XR_SESSION_STATE_VISIBLE);
+    }
+    pushState(session, XR_SESSION_STATE_SYNCHRONIZED);
+    pushState(session, XR_SESSION_STATE_STOPPING);
+}
+
+const MockInputState& sampleAt(Session& session, XrTime time) {
+    if (session.sampledTime != time) {
+        instance->input.sample(sessionSeconds(time), session.sampled);
+        session.sampledTime = time;
+    }
+    return session.sampled;
+}
+
+std::string pathString(XrPath path) {
+    if (path == XR_NULL_PATH || path > instance->paths.size()) {
+        return std::string();
+    }
+    return instance->paths[path - 1];
+}
+
+XrPath internPath(const std::string& path) {
+    auto it = instance->pathIds.find(path);
+    if (it != instance->pathIds.end()) {
+        return it->second;
+    }
+    instance->paths.push_back(path);
+    const XrPath id = static_cast<XrPath>(instance->paths.size());
+    instance->pathIds.emplace(path, id);
+    return id;
+}
+
+int handOfPath(XrPath path) {
+    if (path == instance->leftHandPath) {
+        return 0;
+    }
+    if (path == instance->rightHandPath) {
+        return 1;
+    }
+    return -1;
+}
+
+// Pasa los bindings sugeridos del perfil a cada accion como (mano, fuente)
+void resolveBindings(Session& session) {
+    const bool useTouch = !instance->touchBindings.empty();
+    const std::vector<SuggestedBinding>& suggested =
+        useTouch ? instance->touchBindings : instance->simpleBindings;
+    session.interactionProfile =
+        useTouch ? instance->touchProfilePath : instance->simpleProfilePath;
+
+    for (const SuggestedBinding& binding : suggested) {
+        Action* action = fromHandle<Action>(binding.action);
+        if (action == nullptr || !action->set->attached) {
+            continue;
+        }
+        const std::string path = pathString(binding.path);
+        const std::string left = "/user/hand/left";
+        const std::string right = "/user/hand/right";
+        int hand = -1;
+        std::string input;
+        if (path.compare(0, left.size(), left) == 0) {
+            hand = 0;
+            input = path.substr(left.size());
+        } else if (path.compare(0, right.size(), right) == 0) {
+            hand = 1;
+            input = path.substr(right.size());
+        }
+        const MockInputSource source = hand < 0 ? SOURCE_NONE : mockInputSourceFor(input.c_str());
+        if (source == SOURCE_NONE) {
+            ALOGW("MockRuntime: binding %s is not simulated", path.c_str());
+            continue;
+        }
+        action->bindings.push_back({hand, source});
+    }
+}
+
+// ---- Estado de las acciones ----
+
+struct ActionValue {
+    bool active = false;
+    bool boolean = false;
+    float scalar = 0.0f;
+    XrVector2f vector = {0.0f, 0.0f};
+};
+
+ActionValue evaluate(const Action& action, int hand, const MockInputState& state) {
+    ActionValue value;
+    for (const Binding& binding : action.bindings) {
+        if (hand >= 0 && binding.hand != hand) {
+            continue;
+        }
+        const MockHandState& handState = state.hands[binding.hand];
+        if (binding.source == SOURCE_AIM_POSE || binding.source == SOURCE_GRIP_POSE) {
+            value.active = value.active || handState.tracked;
+            continue;
+        }
+        value.active = true;
+        if (binding.source == SOURCE_THUMBSTICK) {
+            const XrVector2f v = handState.thumbstick;
+            if (v.x * v.x + v.y * v.y >
+                value.vector.x * value.vector.x + value.vector.y * value.vector.y) {
+                value.vector = v;
+            }
+        }
+        const float scalar = handState.value(binding.source);
+        value.scalar = std::max(value.scalar, scalar);
+        value.boolean = value.boolean || scalar > 0.5f;
+    }
+    return value;
+}
+
+XrResult getActionValues(
+    XrSession sessionHandle,
+    const XrActionStateGetInfo* getInfo,
+    ActionValue& current,
+    ActionValue& previous,
+    Session*& sessionOut) {
+    Session* session = fromHandle<Session>(sessionHandle);
+    if (session == nullptr || instance == nullptr || session != instance->session.get()) {
+        return XR_ERROR_HANDLE_INVALID;
+    }
+    if (getInfo == nullptr || getInfo->action == XR_NULL_HANDLE) {
+        return XR_ERROR_VALIDATION_FAILURE;
+    }
+    const Action* action = fromHandle<Action>(getInfo->action);
+    if (!action->set->attached) {
+        return XR_ERROR_ACTIONSET_NOT_ATTACHED;
+    }
+    int hand = -1;
+    if (getInfo->subactionPath != XR_NULL_PATH) {
+        hand = handOfPath(getInfo->subactionPath);
+        if (hand < 0) {
+            return XR_ERROR_PATH_UNSUPPORTED;
+        }
+    }
+    sessionOut = session;
+    if (!session->everSynced) {
+        current = ActionValue();
+        previous = ActionValue();
+        return XR_SUCCESS;
+    }
+    current = evaluate(*action, hand, session->synced);
+    previous = evaluate(*action, hand, session->previousSynced);
+    return XR_SUCCESS;
+}
+
+// Pose de un espacio en el mundo; false si no hay tracking
+bool locateInWorld(Session& session, const Space& space, XrTime time, XrPosef& pose) {
+    if (!space.isAction) {
+        if (space.referenceType == XR_REFERENCE_SPACE_TYPE_VIEW) {
+            pose = MockPose::multiply(sampleAt(session, time).head, space.offset);
+        } else {
+            pose = space.offset; // LOCAL y STAGE coinciden con el mundo
+        }
+        return true;
+    }
+    const MockInputState& state = sampleAt(session, time);
+    for (const Binding& binding : space.action->bindings) {
+        if ((space.hand >= 0 && binding.hand != space.hand) ||
+            (binding.source != SOURCE_AIM_POSE && binding.source != SOURCE_GRIP_POSE)) {
+            continue;
+        }
+        const MockHandState& hand = state.hands[binding.hand];
+        if (!hand.tracked) {
+            return false;
+        }
+        const XrPosef& handPose = binding.source == SOURCE_AIM_POSE ? hand.aim : hand.grip;
+        pose = MockPose::multiply(handPose, space.offset);
+        return true;
+    }
+    return false;
+}
+
+XrSpaceLocationFlags locateRelative(
+    Session& session,
+    const Space& space,
+    const Space& baseSpace,
+    XrTime time,
+    XrPosef& pose) {
+    XrPosef spacePose;
+    XrPosef basePose;
+    if (!locateInWorld(session, space, time, spacePose) ||
+        !locateInWorld(session, baseSpace, time, basePose)) {
+        pose = MockPose::identity();
+        return 0;
+    }
+    pose = MockPose::multiply(MockPose::invert(basePose), spacePose);
+    return XR_SPACE_LOCATION_ORIENTATION_VALID_BIT | XR_SPACE_LOCATION_POSITION_VALID_BIT |
+        XR_SPACE_LOCATION_ORIENTATION_TRACKED_BIT | XR_SPACE_LOCATION_POSITION_TRACKED_BIT;
+}
+
+// ---- Puntos de entrada ----
+
+XRAPI_ATTR XrResult XRAPI_CALL mockGetInstanceProcAddr(
+    XrInstance instanceHandle,
+    const char* name,
+    PFN_xrVoidFunction* function);
+
+XRAPI_ATTR XrResult XRAPI_CALL mockEnumerateInstanceExtensionProperties(
+    const char* layerName,
+    uint32_t propertyCapacityInput,
+    uint32_t* propertyCountOutput,
+    XrExtensionProperties* properties) {
+    ScopedCall scope(CALL_ENUMERATE_INSTANCE_EXTENSION_PROPERTIES);
+    if (layerName != nullptr) {
+        return XR_ERROR_API_LAYER_NOT_PRESENT;
+    }
+    struct Extension {
+        const char* name;
+        uint32_t version;
+    };
+    const Extension extensions[] = {
+        {XR_KHR_OPENGL_ENABLE_EXTENSION_NAME, XR_KHR_opengl_enable_SPEC_VERSION},
+        {XR_KHR_COMPOSITION_LAYER_CUBE_EXTENSION_NAME, XR_KHR_composition_layer_cube_SPEC_VERSION},
+        {XR_KHR_COMPOSITION_LAYER_CYLINDER_EXTENSION_NAME,
+         XR_KHR_composition_layer_cylinder_SPEC_VERSION},
+        {XR_KHR_COMPOSITION_LAYER_COLOR_SCALE_BIAS_EXTENSION_NAME,
+         XR_KHR_composition_layer_color_scale_bias_SPEC_VERSION},
+        {XR_KHR_LOCATE_SPACES_EXTENSION_NAME, XR_KHR_locate_spaces_SPEC_VERSION},
+    };
+    const uint32_t count = sizeof(extensions) / sizeof(extensions[0]);
+    if (propertyCountOutput == nullptr) {
+        return XR_ERROR_VALIDATION_FAILURE;
+    }
+    *propertyCountOutput = count;
+    if (propertyCapacityInput == 0) {
+        return XR_SUCCESS;
+    }
+    if (propertyCapacityInput < count || properties == nullptr) {
+        return XR_ERROR_SIZE_INSUFFICIENT;
+    }
+    for (uint32_t i = 0; i < count; i++) {
+        strncpy(properties[i].extensionName, extensions[i].name, XR_MAX_EXTENSION_NAME_SIZE - 1);
+        properties[i].extensionName[XR_MAX_EXTENSION_NAME_SIZE - 1] = '\0';
+        properties[i].extensionVersion = extensions[i].version;
+    }
+    return XR_SUCCESS;
+}
+
+XRAPI_ATTR XrResult XRAPI_CALL mockCreateInstance(
+    const XrInstanceCreateInfo* createInfo,
+    XrInstance* instanceOut) {
+    if (createInfo == nullptr || instanceOut == nullptr) {
+        return XR_ERROR_VALIDATION_FAILURE;
+    }
+    if (instance != nullptr) {
+        ALOGE("MockRuntime: only one instance at a time");
+        return XR_ERROR_LIMIT_REACHED;
+    }
+    if (XR_VERSION_MAJOR(createInfo->applicationInfo.apiVersion) != 1) {
+        return XR_ERROR_API_VERSION_UNSUPPORTED;
+    }
+    for (uint32_t i = 0; i < createInfo->enabledExtensionCount; i++) {
+        uint32_t count = 0;
+        mockEnumerateInstanceExtensionProperties(nullptr, 0, &count, nullptr);
+        std::vector<XrExtensionProperties> available(count, {XR_TYPE_EXTENSION_PROPERTIES});
+        mockEnumerateInstanceExtensionProperties(nullptr, count, &count, available.data());
+        const char* requested = createInfo->enabledExtensionNames[i];
+        const bool found = std::any_of(
+            available.begin(), available.end(), [requested](const XrExtensionProperties& e) {
+                return strcmp(e.extensionName, requested) == 0;
+            });
+        if (!found) {
+            ALOGE("MockRuntime: extension %s not supported", requested);
+            return XR_ERROR_EXTENSION_NOT_PRESENT;
+        }
+    }
+
+    std::unique_ptr<Instance> created(new Instance());
+    created->config.loadFromEnvironment();
+    if (!created->config.recording.empty() &&
+        !created->input.loadRecording(created->config.recording)) {
+        return XR_ERROR_INITIALIZATION_FAILED;
+    }
+    created->frameStats.appNs.reserve(
+        created->config.frameLimit > 0 ? created->config.frameLimit : 1 << 16);
+    instance = created.release();
+    ScopedCall scope(CALL_CREATE_INSTANCE);
+
+    instance->leftHandPath = internPath("/user/hand/left");
+    instance->rightHandPath = internPath("/user/hand/right");
+    instance->touchProfilePath = internPath("/interaction_profiles/oculus/touch_controller");
+    instance->simpleProfilePath = internPath("/interaction_profiles/khr/simple_controller");
+
+    ALOG(
+        "MockRuntime: %.1f Hz%s, %s input, eye buffers %ux%u",
+        instance->config.displayHz,
+        instance->config.freeRun ? " free-running" : "",
+        instance->input.isRecorded() ? "recorded" : "scripted",
+        instance->config.eyeWidth,
+        instance->config.eyeHeight);
+    *instanceOut = toHandle<XrInstance>(instance);
+    return XR_SUCCESS;
+}
+
+void writeReport();
+
+XRAPI_ATTR XrResult XRAPI_CALL mockDestroyInstance(XrInstance instanceHandle) {
+    if (instance == nullptr || fromHandle<Instance>(instanceHandle) != instance) {
+        return XR_ERROR_HANDLE_INVALID;
+    }
+    {
+        ScopedCall scope(CALL_DESTROY_INSTANCE);
+    }
+    writeReport();
+    delete instance;
+    instance = nullptr;
+    return XR_SUCCESS;
+}
+
+XRAPI_ATTR XrResult XRAPI_CALL mockGetInstanceProperties(
+    XrInstance instanceHandle,
+    XrInstanceProperties* properties) {
+    ScopedCall scope(CALL_GET_INSTANCE_PROPERTIES);
+    if (fromHandle<Instance>(instanceHandle) != instance || instance == nullptr) {
+        return XR_ERROR_HANDLE_INVALID;
+    }
+    if (properties == nullptr) {
+        return XR_ERROR_VALIDATION_FAILURE;
+    }
+    properties->runtimeVersion = XR_MAKE_VERSION(1, 0, 0);
+    strncpy(properties->runtimeName, RUNTIME_NAME, XR_MAX_RUNTIME_NAME_SIZE - 1);
+    properties->runtimeName[XR_MAX_RUNTIME_NAME_SIZE - 1] = '\0';
+    return XR_SUCCESS;
+}
+
+XRAPI_ATTR XrResult XRAPI_CALL mockPollEvent(
+    XrInstance instanceHandle,
+    XrEventDataBuffer* eventData) {
+    ScopedCall scope(CALL_POLL_EVENT);
+    if (fromHandle<Instance>(instanceHandle) != instance || instance == nullptr) {
+        return XR_ERROR_HANDLE_INVALID;
+    }
+    if (eventData == nullptr) {
+        return XR_ERROR_VALIDATION_FAILURE;
+    }
+    if (instance->events.empty()) {
+        return XR_EVENT_UNAVAILABLE;
+    }
+    static_assert(
+        sizeof(XrEventDataSessionStateChanged) <= sizeof(XrEventDataBuffer),
+        "event does not fit");
+    memcpy(eventData, &instance->events.front(), sizeof(XrEventDataSessionStateChanged));
+    instance->events.pop_front();
+    return XR_SUCCESS;
+}
+
+struct ResultName {
+    XrResult result;
+    const char* name;
+};
+
+const ResultName RESULT_NAMES[] = {
+    {XR_SUCCESS, "XR_SUCCESS"},
+    {XR_TIMEOUT_EXPIRED, "XR_TIMEOUT_EXPIRED"},
+    {XR_SESSION_LOSS_PENDING, "XR_SESSION_LOSS_PENDING"},
+    {XR_EVENT_UNAVAILABLE, "XR_EVENT_UNAVAILABLE"},
+    {XR_SESSION_NOT_FOCUSED, "XR_SESSION_NOT_FOCUSED"},
+    {XR_FRAME_DISCARDED, "XR_FRAME_DISCARDED"},
+    {XR_ERROR_VALIDATION_FAILURE, "XR_ERROR_VALIDATION_FAILURE"},
+    {XR_ERROR_RUNTIME_FAILURE, "XR_ERROR_RUNTIME_FAILURE"},
+    {XR_ERROR_OUT_OF_MEMORY, "XR_ERROR_OUT_OF_MEMORY"},
+    {XR_ERROR_API_VERSION_UNSUPPORTED, "XR_ERROR_API_VERSION_UNSUPPORTED"},
+    {XR_ERROR_INITIALIZATION_FAILED, "XR_ERROR_INITIALIZATION_FAILED"},
+    {XR_ERROR_FUNCTION_UNSUPPORTED, "XR_ERROR_FUNCTION_UNSUPPORTED"},
+    {XR_ERROR_FEATURE_UNSUPPORTED, "XR_ERROR_FEATURE_UNSUPPORTED"},
+    {XR_ERROR_EXTENSION_NOT_PRESENT, "XR_ERROR_EXTENSION_NOT_PRESENT"},
+    {XR_ERROR_LIMIT_REACHED, "XR_ERROR_LIMIT_REACHED"},
+    {XR_ERROR_SIZE_INSUFFICIENT, "XR_ERROR_SIZE_INSUFFICIENT"},
+    {XR_ERROR_HANDLE_INVALID, "XR_ERROR_HANDLE_INVALID"},
+    {XR_ERROR_SESSION_RUNNING, "XR_ERROR_SESSION_RUNNING"},
+    {XR_ERROR_SESSION_NOT_RUNNING, "XR_ERROR_SESSION_NOT_RUNNING"},
+    {XR_ERROR_SESSION_NOT_READY, "XR_ERROR_SESSION_NOT_READY"},
+    {XR_ERROR_SESSION_NOT_STOPPING, "XR_ERROR_SESSION_NOT_STOPPING"},
+    {XR_ERROR_CALL_ORDER_INVALID, "XR_ERROR_CALL_ORDER_INVALID"},
+    {XR_ERROR_ACTIONSET_NOT_ATTACHED, "XR_ERROR_ACTIONSET_NOT_ATTACHED"},
+    {XR_ERROR_ACTIONSETS_ALREADY_ATTACHED, "XR_ERROR_ACTIONSETS_ALREADY_ATTACHED"},
+    {XR_ERROR_PATH_INVALID, "XR_ERROR_PATH_INVALID"},
+    {XR_ERROR_PATH_UNSUPPORTED, "XR_ERROR_PATH_UNSUPPORTED"},
+    {XR_ERROR_FORM_FACTOR_UNSUPPORTED, "XR_ERROR_FORM_FACTOR_UNSUPPORTED"},
+    {XR_ERROR_SYSTEM_INVALID, "XR_ERROR_SYSTEM_INVALID"},
+    {XR_ERROR_VIEW_CONFIGURATION_TYPE_UNSUPPORTED,
+     "XR_ERROR_VIEW_CONFIGURATION_TYPE_UNSUPPORTED"},
+    {XR_ERROR_REFERENCE_SPACE_UNSUPPORTED, "XR_ERROR_REFERENCE_SPACE_UNSUPPORTED"},
+    {XR_ERROR_SWAPCHAIN_FORMAT_UNSUPPORTED, "XR_ERROR_SWAPCHAIN_FORMAT_UNSUPPORTED"},
+    {XR_ERROR_LAYER_LIMIT_EXCEEDED, "XR_ERROR_LAYER_LIMIT_EXCEEDED"},
+    {XR_ERROR_API_LAYER_NOT_PRESENT, "XR_ERROR_API_LAYER_NOT_PRESENT"},
+};
+
+XRAPI_ATTR XrResult XRAPI_CALL mockResultToString(
+    XrInstance instanceHandle,
+    XrResult value,
+    char buffer[XR_MAX_RESULT_STRING_SIZE]) {
+    ScopedCall scope(CALL_RESULT_TO_STRING);
+    for (const ResultName& entry : RESULT_NAMES) {
+        if (entry.result == value) {
+            snprintf(buffer, XR_MAX_RESULT_STRING_SIZE, "%s", entry.name);
+            return XR_SUCCESS;
+        }
+    }
+    snprintf(
+        buffer,
+        XR_MAX_RESULT_STRING_SIZE,
+        XR_SUCCEEDED(value) ? "XR_UNKNOWN_SUCCESS_%d" : "XR_UNKNOWN_FAILURE_%d",
+        static_cast<int>(value));
+    return XR_SUCCESS;
+}
+
+XRAPI_ATTR XrResult XRAPI_CALL mockStructureTypeToString(
+    XrInstance instanceHandle,
+    XrStructureType value,
+    char buffer[XR_MAX_STRUCTURE_NAME_SIZE]) {
+    ScopedCall scope(CALL_STRUCTURE_TYPE_TO_STRING);
+    snprintf(buffer, XR_MAX_STRUCTURE_NAME_SIZE, "XR_UNKNOWN_STRUCTURE_TYPE_%d", value);
+    return XR_SUCCESS;
+}
+
+XRAPI_ATTR XrResult XRAPI_CALL mockGetSystem(
+    XrInstance instanceHandle,
+    const XrSystemGetInfo* getInfo,
+    XrSystemId* systemId) {
+    ScopedCall scope(CALL_GET_SYSTEM);
+    if (getInfo == nullptr || systemId == nullptr) {
+        return XR_ERROR_VALIDATION_FAILURE;
+    }
+    if (getInfo->formFactor != XR_FORM_FACTOR_HEAD_MOUNTED_DISPLAY) {
+        return XR_ERROR_FORM_FACTOR_UNSUPPORTED;
+    }
+    *systemId = SYSTEM_ID;
+    return XR_SUCCESS;
+}
+
+XRAPI_ATTR XrResult XRAPI_CALL mockGetSystemProperties(
+    XrInstance instanceHandle,
+    XrSystemId systemId,
+    XrSystemProperties* properties) {
+    ScopedCall scope(CALL_GET_SYSTEM_PROPERTIES);
+    if (systemId != SYSTEM_ID) {
+        return XR_ERROR_SYSTEM_INVALID;
+    }
+    if (properties == nullptr) {
+        return XR_ERROR_VALIDATION_FAILURE;
+    }
+    properties->systemId = SYSTEM_ID;
+    properties->vendorId = 0;
+    strncpy(properties->systemName, RUNTIME_NAME, XR_MAX_SYSTEM_NAME_SIZE - 1);
+    properties->systemName[XR_MAX_SYSTEM_NAME_SIZE - 1] = '\0';
+    properties->graphicsProperties.maxSwapchainImageWidth = 4096;
+    properties->graphicsProperties.maxSwapchainImageHeight = 4096;
+    properties->graphicsProperties.maxLayerCount = MAX_LAYER_COUNT;
+    properties->trackingProperties.orientationTracking = XR_TRUE;
+    properties->trackingProperties.positionTracking = XR_TRUE;
+    return XR_SUCCESS;
+}
+
+XRAPI_ATTR XrResult XRAPI_CALL mockEnumerateEnvironmentBlendModes(
+    XrInstance instanceHandle,
+    XrSystemId systemId,
+    XrViewConfigurationType viewConfigurationType,
+    uint32_t environmentBlendModeCapacityInput,
+    uint32_t* environmentBlendModeCountOutput,
+    XrEnvironmentBlendMode* environmentBlendModes) {
+    ScopedCall scope(CALL_ENUMERATE_ENVIRONMENT_BLEND_MODES);
+    const XrEnvironmentBlendMode modes[] = {XR_ENVIRONMENT_BLEND_MODE_OPAQUE};
+    return fillArray(
+        environmentBlendModeCapacityInput,
+        environmentBlendModeCountOutput,
+        environmentBlendModes,
+        modes,
+        1);
+}
+
+XRAPI_ATTR XrResult XRAPI_CALL mockGetOpenGLGraphicsRequirementsKHR(
+    XrInstance instanceHandle,
+    XrSystemId systemId,
+    XrGraphicsRequirementsOpenGLKHR* graphicsRequirements) {
+    ScopedCall scope(CALL_GET_OPENGL_GRAPHICS_REQUIREMENTS);
+    if (graphicsRequirements == nullptr) {
+        return XR_ERROR_VALIDATION_FAILURE;
+    }
+    graphicsRequirements->minApiVersionSupported = XR_MAKE_VERSION(3, 0, 0);
+    graphicsRequirements->maxApiVersionSupported = XR_MAKE_VERSION(4, 6, 0);
+    return XR_SUCCESS;
+}
+
+XRAPI_ATTR XrResult XRAPI_CALL mockCreateSession(
+    XrInstance instanceHandle,
+    const XrSessionCreateInfo* createInfo,
+    XrSession* sessionOut) {
+    ScopedCall scope(CALL_CREATE_SESSION);
+    if (fromHandle<Instance>(instanceHandle) != instance || instance == nullptr) {
+        return XR_ERROR_HANDLE_INVALID;
+    }
+    if (createInfo == nullptr || sessionOut == nullptr) {
+        return XR_ERROR_VALIDATION_FAILURE;
+    }
+    if (createInfo->systemId != SYSTEM_ID) {
+        return XR_ERROR_SYSTEM_INVALID;
+    }
+    if (instance->session) {
+        return XR_ERROR_LIMIT_REACHED;
+    }
+    // El binding de graficos no se mira: las texturas se crean en el contexto actual
+    instance->session.reset(new Session());
+    Session& session = *instance->session;
+    session.startNs = nowNs();
+    session.nextVsyncNs = session.startNs;
+    pushState(session, XR_SESSION_STATE_IDLE);
+    pushState(session, XR_SESSION_STATE_READY);
+    *sessionOut = toHandle<XrSession>(&session);
+    return XR_SUCCESS;
+}
+
+Session* getSession(XrSession handle) {
+    Session* session = fromHandle<Session>(handle);
+    if (session == nullptr || instance == nullptr || session != instance->session.get()) {
+        return nullptr;
+    }
+    return session;
+}
+
+XRAPI_ATTR XrResult XRAPI_CALL mockDestroySession(XrSession sessionHandle) {
+    ScopedCall scope(CALL_DESTROY_SESSION);
+    Session* session = getSession(sessionHandle);
+    if (session == nullptr) {
+        return XR_ERROR_HANDLE_INVALID;
+    }
+    for (const std::unique_ptr<Swapchain>& swapchain : session->swapchains) {
+        glDeleteTextures(SWAPCHAIN_LENGTH, swapchain->images);
+    }
+    // Los eventos pendientes de la sesion se descartan
+    instance->events.clear();
+    instance->session.reset();
+    return XR_SUCCESS;
+}
+
+XRAPI_ATTR XrResult XRAPI_CALL mockBeginSession(
+    XrSession sessionHandle,
+    const XrSessionBeginInfo* beginInfo) {
+    ScopedCall scope(CALL_BEGIN_SESSION);
+    Session* session = getSession(sessionHandle);
+    if (session == nullptr) {
+        return XR_ERROR_HANDLE_INVALID;
+    }
+    if (beginInfo == nullptr) {
+        return XR_ERROR_VALIDATION_FAILURE;
+    }
+    if (beginInfo->primaryViewConfigurationType != XR_VIEW_CONFIGURATION_TYPE_PRIMARY_STEREO) {
+        return XR_ERROR_VIEW_CONFIGURATION_TYPE_UNSUPPORTED;
+    }
+    if (session->running) {
+        return XR_ERROR_SESSION_RUNNING;
+    }
+    if (session->state != XR_SESSION_STATE_READY) {
+        return XR_ERROR_SESSION_NOT_READY;
+    }
+    {
+        std::lock_guard<std::mutex> lock(session->frameMutex);
+        session->running = true;
+    }
+    pushState(*session, XR_SESSION_STATE_SYNCHRONIZED);
+    pushState(*session, XR_SESSION_STATE_VISIBLE);
+    pushState(*session, XR_SESSION_STATE_FOCUSED);
+    return XR_SUCCESS;
+}
+
+XRAPI_ATTR XrResult XRAPI_CALL mockEndSession(XrSession sessionHandle) {
+    ScopedCall scope(CALL_END_SESSION);
+    Session* session = getSession(sessionHandle);
+    if (session == nullptr) {
+        return XR_ERROR_HANDLE_INVALID;
+    }
+    if (!session->running) {
+        return XR_ERROR_SESSION_NOT_RUNNING;
+    }
+    if (session->state != XR_SESSION_STATE_STOPPING) {
+        return XR_ERROR_SESSION_NOT_STOPPING;
+    }
+    {
+        std::lock_guard<std::mutex> lock(session->frameMutex);
+        session->running = false;
+    }
+    // Despierta un xrWaitFrame bloqueado en otro hilo
+    session->frameCv.notify_all();
+    pushState(*session, XR_SESSION_STATE_IDLE);
+    if (session->exitRequested) {
+        pushState(*session, XR_SESSION_STATE_EXITING);
+    }
+    return XR_SUCCESS;
+}
+
+XRAPI_ATTR XrResult XRAPI_CALL mockRequestExitSession(XrSession sessionHandle) {
+    ScopedCall scope(CALL_REQUEST_EXIT_SESSION);
+    Session* session = getSession(sessionHandle);
+    if (session == nullptr) {
+        return XR_ERROR_HANDLE_INVALID;
+    }
+    if (!session->running) {
+        return XR_ERROR_SESSION_NOT_RUNNING;
+    }
+    beginExit(*session);
+    return XR_SUCCESS;
+}
+
+XRAPI_ATTR XrResult XRAPI_CALL mockEnumerateReferenceSpaces(
+    XrSession sessionHandle,
+    uint32_t spaceCapacityInput,
+    uint32_t* spaceCountOutput,
+    XrReferenceSpaceType* spaces) {
+    ScopedCall scope(CALL_ENUMERATE_REFERENCE_SPACES);
+    if (getSession(sessionHandle) == nullptr) {
+        return XR_ERROR_HANDLE_INVALID;
+    }
+    const XrReferenceSpaceType types[] = {
+        XR_REFERENCE_SPACE_TYPE_VIEW, XR_REFERENCE_SPACE_TYPE_LOCAL, XR_REFERENCE_SPACE_TYPE_STAGE};
+    return fillArray(spaceCapacityInput, spaceCountOutput, spaces, types, 3);
+}
+
+XRAPI_ATTR XrResult XRAPI_CALL mockCreateReferenceSpace(
+    XrSession sessionHandle,
+    const XrReferenceSpaceCreateInfo* createInfo,
+    XrSpace* spaceOut) {
+    ScopedCall scope(CALL_CREATE_REFERENCE_SPACE);
+    Session* session = getSession(sessionHandle);
+    if (session == nullptr) {
+        return XR_ERROR_HANDLE_INVALID;
+    }
+    if (createInfo == nullptr || spaceOut == nullptr) {
+        return XR_ERROR_VALIDATION_FAILURE;
+    }
+    if (createInfo->referenceSpaceType != XR_REFERENCE_SPACE_TYPE_VIEW &&
+        createInfo->referenceSpaceType != XR_REFERENCE_SPACE_TYPE_LOCAL &&
+        createInfo->referenceSpaceType != XR_REFERENCE_SPACE_TYPE_STAGE) {
+        return XR_ERROR_REFERENCE_SPACE_UNSUPPORTED;
+    }
+    std::unique_ptr<Space> space(new Space());
+    space->referenceType = createInfo->referenceSpaceType;
+    space->offset = createInfo->poseInReferenceSpace;
+    *spaceOut = toHandle<XrSpace>(space.get());
+    session->spaces.push_back(std::move(space));
+    return XR_SUCCESS;
+}
+
+XRAPI_ATTR XrResult XRAPI_CALL mockGetReferenceSpaceBoundsRect(
+    XrSession sessionHandle,
+    XrReferenceSpaceType referenceSpaceType,
+    XrExtent2Df* bounds) {
+    ScopedCall scope(CALL_GET_REFERENCE_SPACE_BOUNDS_RECT);
+    if (getSession(sessionHandle) == nullptr) {
+        return XR_ERROR_HANDLE_INVALID;
+    }
+    if (bounds == nullptr) {
+        return XR_ERROR_VALIDATION_FAILURE;
+    }
+    if (referenceSpaceType != XR_REFERENCE_SPACE_TYPE_STAGE) {
+        bounds->width = 0.0f;
+        bounds->height = 0.0f;
+        return XR_SPACE_BOUNDS_UNAVAILABLE;
+    }
+    bounds->width = 2.0f;
+    bounds->height = 2.0f;
+    return XR_SUCCESS;
+}
+
+XRAPI_ATTR XrResult XRAPI_CALL mockCreateActionSpace(
+    XrSession sessionHandle,
+    const XrActionSpaceCreateInfo* createInfo,
+    XrSpace* spaceOut) {
+    ScopedCall scope(CALL_CREATE_ACTION_SPACE);
+    Session* session = getSession(sessionHandle);
+    if (session == nullptr) {
+        return XR_ERROR_HANDLE_INVALID;
+    }
+    if (createInfo == nullptr || spaceOut == nullptr || createInfo->action == XR_NULL_HANDLE) {
+        return XR_ERROR_VALIDATION_FAILURE;
+    }
+    Action* action = fromHandle<Action>(createInfo->action);
+    if (action->type != XR_ACTION_TYPE_POSE_INPUT) {
+        return XR_ERROR_ACTION_TYPE_MISMATCH;
+    }
+    int hand = -1;
+    if (createInfo->subactionPath != XR_NULL_PATH) {
+        hand = handOfPath(createInfo->subactionPath);
+        if (hand < 0) {
+            return XR_ERROR_PATH_UNSUPPORTED;
+        }
+    }
+    std::unique_ptr<Space> space(new Space());
+    space->isAction = true;
+    space->action = action;
+    space->hand = hand;
+    space->offset = createInfo->poseInActionSpace;
+    *spaceOut = toHandle<XrSpace>(space.get());
+    session->spaces.push_back(std::move(space));
+    return XR_SUCCESS;
+}
+
+XRAPI_ATTR XrResult XRAPI_CALL mockLocateSpace(
+    XrSpace spaceHandle,
+    XrSpace baseSpaceHandle,
+    XrTime time,
+    XrSpaceLocation* location) {
+    ScopedCall scope(CALL_LOCATE_SPACE);
+    const Space* space = fromHandle<Space>(spaceHandle);
+    const Space* baseSpace = fromHandle<Space>(baseSpaceHandle);
+    if (space == nullptr || baseSpace == nullptr || instance == nullptr || !instance->session) {
+        return XR_ERROR_HANDLE_INVALID;
+    }
+    if (location == nullptr) {
+        return XR_ERROR_VALIDATION_FAILURE;
+    }
+    if (time <= 0) {
+        return XR_ERROR_TIME_INVALID;
+    }
+    Session& session = *instance->session;
+
+    // La velocidad no se simula
+    for (XrBaseOutStructure* next = reinterpret_cast<XrBaseOutStructure*>(location->next);
+         next != nullptr;
+         next = next->next) {
+        if (next->type == XR_TYPE_SPACE_VELOCITY) {
+            reinterpret_cast<XrSpaceVelocity*>(next)->velocityFlags = 0;
+        }
+    }
+
+    location->locationFlags =
+        locateRelative(session, *space, *baseSpace, time, location->pose);
+    return XR_SUCCESS;
+}
+
+XRAPI_ATTR XrResult XRAPI_CALL mockLocateSpaces(
+    XrSession sessionHandle,
+    const XrSpacesLocateInfo* locateInfo,
+    XrSpaceLocations* spaceLocations) {
+    ScopedCall scope(CALL_LOCATE_SPACES);
+    Session* session = getSession(sessionHandle);
+    if (session == nullptr) {
+        return XR_ERROR_HANDLE_INVALID;
+    }
+    if (locateInfo == nullptr || spaceLocations == nullptr || locateInfo->spaces == nullptr ||
+        spaceLocations->locationCount != locateInfo->spaceCount) {
+        return XR_ERROR_VALIDATION_FAILURE;
+    }
+    if (locateInfo->time <= 0) {
+        return XR_ERROR_TIME_INVALID;
+    }
+    const Space* baseSpace = fromHandle<Space>(locateInfo->baseSpace);
+    if (baseSpace == nullptr) {
+        return XR_ERROR_HANDLE_INVALID;
+    }
+    for (XrBaseOutStructure* next = reinterpret_cast<XrBaseOutStructure*>(spaceLocations->next);
+         next != nullptr;
+         next = next->next) {
+        if (next->type == XR_TYPE_SPACE_VELOCITIES) {
+            XrSpaceVelocities* velocities = reinterpret_cast<XrSpaceVelocities*>(next);
+            for (uint32_t i = 0; i < velocities->velocityCount; i++) {
+                velocities->velocities[i].velocityFlags = 0;
+            }
+        }
+    }
+    for (uint32_t i = 0; i < locateInfo->spaceCount; i++) {
+        const Space* space = fromHandle<Space>(locateInfo->spaces[i]);
+        XrSpaceLocationData& location = spaceLocations->locations[i];
+        if (space == nullptr) {
+            return XR_ERROR_HANDLE_INVALID;
+        }
+        location.locationFlags =
+            locateRelative(*session, *space, *baseSpace, locateInfo->time, location.pose);
+    }
+    return XR_SUCCESS;
+}
+
+XRAPI_ATTR XrResult XRAPI_CALL mockDestroySpace(XrSpace spaceHandle) {
+    ScopedCall scope(CALL_DESTROY_SPACE);
+    if (instance == nullptr || !instance->session) {
+        return XR_ERROR_HANDLE_INVALID;
+    }
+    std::vector<std::unique_ptr<Space>>& spaces = instance->session->spaces;
+    const Space* space = fromHandle<Space>(spaceHandle);
+    auto it = std::find_if(spaces.begin(), spaces.end(), [space](const std::unique_ptr<Space>& s) {
+        return s.get() == space;
+    });
+    if (it == spaces.end()) {
+        return XR_ERROR_HANDLE_INVALID;
+    }
+    spaces.erase(it);
+    return XR_SUCCESS;
+}
+
+XRAPI_ATTR XrResult XRAPI_CALL mockEnumerateViewConfigurations(
+    XrInstance instanceHandle,
+    XrSystemId systemId,
+    uint32_t viewConfigurationTypeCapacityInput,
+    uint32_t* viewConfigurationTypeCountOutput,
+    XrViewConfigurationType* viewConfigurationTypes) {
+    ScopedCall scope(CALL_ENUMERATE_VIEW_CONFIGURATIONS);
+    if (systemId != SYSTEM_ID) {
+        return XR_ERROR_SYSTEM_INVALID;
+    }
+    const XrViewConfigurationType types[] = {XR_VIEW_CONFIGURATION_TYPE_PRIMARY_STEREO};
+    return fillArray(
+        viewConfigurationTypeCapacityInput,
+        viewConfigurationTypeCountOutput,
+        viewConfigurationTypes,
+        types,
+        1);
+}
+
+XRAPI_ATTR XrResult XRAPI_CALL mockGetViewConfigurationProperties(
+    XrInstance instanceHandle,
+    XrSystemId systemId,
+    XrViewConfigurationType viewConfigurationType,
+    XrViewConfigurationProperties* configurationProperties) {
+    ScopedCall scope(CALL_GET_VIEW_CONFIGURATION_PROPERTIES);
+    if (systemId != SYSTEM_ID) {
+        return XR_ERROR_SYSTEM_INVALID;
+    }
+    if (viewConfigurationType != XR_VIEW_CONFIGURATION_TYPE_PRIMARY_STEREO) {
+        return XR_ERROR_VIEW_CONFIGURATION_TYPE_UNSUPPORTED;
+    }
+    if (configurationProperties == nullptr) {
+        return XR_ERROR_VALIDATION_FAILURE;
+    }
+    configurationProperties->viewConfigurationType = viewConfigurationType;
+    configurationProperties->fovMutable = XR_FALSE;
+    return XR_SUCCESS;
+}
+
+XRAPI_ATTR XrResult XRAPI_CALL mockEnumerateViewConfigurationViews(
+    XrInstance instanceHandle,
+    XrSystemId systemId,
+    XrViewConfigurationType viewConfigurationType,
+    uint32_t viewCapacityInput,
+    uint32_t* viewCountOutput,
+    XrViewConfigurationView* views) {
+    ScopedCall scope(CALL_ENUMERATE_VIEW_CONFIGURATION_VIEWS);
+    if (systemId != SYSTEM_ID || instance == nullptr) {
+        return XR_ERROR_SYSTEM_INVALID;
+    }
+    if (viewConfigurationType != XR_VIEW_CONFIGURATION_TYPE_PRIMARY_STEREO) {
+        return XR_ERROR_VIEW_CONFIGURATION_TYPE_UNSUPPORTED;
+    }
+    if (viewCountOutput == nullptr) {
+        return XR_ERROR_VALIDATION_FAILURE;
+    }
+    *viewCountOutput = VIEW_COUNT;
+    if (viewCapacityInput == 0) {
+        return XR_SUCCESS;
+    }
+    if (viewCapacityInput < VIEW_COUNT || views == nullptr) {
+        return XR_ERROR_SIZE_INSUFFICIENT;
+    }
+    for (uint32_t i = 0; i < VIEW_COUNT; i++) {
+        views[i].recommendedImageRectWidth = instance->config.eyeWidth;
+        views[i].maxImageRectWidth = 4096;
+        views[i].recommendedImageRectHeight = instance->config.eyeHeight;
+        views[i].maxImageRectHeight = 4096;
+        views[i].recommendedSwapchainSampleCount = 1;
+        views[i].maxSwapchainSampleCount = 4;
+    }
+    return XR_SUCCESS;
+}
+
+XRAPI_ATTR XrResult XRAPI_CALL mockEnumerateSwapchainFormats(
+    XrSession sessionHandle,
+    uint32_t formatCapacityInput,
+    uint32_t* formatCountOutput,
+    int64_t* formats) {
+    ScopedCall scope(CALL_ENUMERATE_SWAPCHAIN_FORMATS);
+    if (getSession(sessionHandle) == nullptr) {
+        return XR_ERROR_HANDLE_INVALID;
+    }
+    const int64_t supported[] = {GL_SRGB8_ALPHA8, GL_RGBA8};
+    return fillArray(formatCapacityInput, formatCountOutput, formats, supported, 2);
+}
+
+XRAPI_ATTR XrResult XRAPI_CALL mockCreateSwapchain(
+    XrSession sessionHandle,
+    const XrSwapchainCreateInfo* createInfo,
+    XrSwapchain* swapchainOut) {
+    ScopedCall scope(CALL_CREATE_SWAPCHAIN);
+    Session* session = getSession(sessionHandle);
+    if (session == nullptr) {
+        return XR_ERROR_HANDLE_INVALID;
+    }
+    if (createInfo == nullptr || swapchainOut == nullptr || createInfo->width == 0 ||
+        createInfo->height == 0) {
+        return XR_ERROR_VALIDATION_FAILURE;
+    }
+    if (createInfo->format != GL_SRGB8_ALPHA8 && createInfo->format != GL_RGBA8) {
+        return XR_ERROR_SWAPCHAIN_FORMAT_UNSUPPORTED;
+    }
+    std::unique_ptr<Swapchain> swapchain(new Swapchain());
+    swapchain->width = createInfo->width;
+    swapchain->height = createInfo->height;
+    // La app llama con su contexto GL activo, como con un runtime de verdad
+    glGenTextures(SWAPCHAIN_LENGTH, swapchain->images);
+    for (GLuint image : swapchain->images) {
+        glBindTexture(GL_TEXTURE_2D, image);
+        glTexImage2D(
+            GL_TEXTURE_2D,
+            0,
+            static_cast<GLint>(createInfo->format),
+            static_cast<GLsizei>(createInfo->width),
+            static_cast<GLsizei>(createInfo->height),
+            0,
+            GL_RGBA,
+            GL_UNSIGNED_BYTE,
+            nullptr);
+    }
+    glBindTexture(GL_TEXTURE_2D, 0);
+    *swapchainOut = toHandle<XrSwapchain>(swapchain.get());
+    session->swapchains.push_back(std::move(swapchain));
+    return XR_SUCCESS;
+}
+
+Swapchain* getSwapchain(XrSwapchain handle) {
+    if (instance == nullptr || !instance->session) {
+        return nullptr;
+    }
+    const Swapchain* swapchain = fromHandle<Swapchain>(handle);
+    for (const std::unique_ptr<Swapchain>& s : instance->session->swapchains) {
+        if (s.get() == swapchain) {
+            return s.get();
+        }
+    }
+    return nullptr;
+}
+
+XRAPI_ATTR XrResult XRAPI_CALL mockDestroySwapchain(XrSwapchain swapchainHandle) {
+    ScopedCall scope(CALL_DESTROY_SWAPCHAIN);
+    Swapchain* swapchain = getSwapchain(swapchainHandle);
+    if (swapchain == nullptr) {
+        return XR_ERROR_HANDLE_INVALID;
+    }
+    glDeleteTextures(SWAPCHAIN_LENGTH, swapchain->images);
+    std::vector<std::unique_ptr<Swapchain>>& swapchains = instance->session->swapchains;
+    swapchains.erase(std::find_if(
+        swapchains.begin(), swapchains.end(), [swapchain](const std::unique_ptr<Swapchain>& s) {
+            return s.get() == swapchain;
+        }));
+    return XR_SUCCESS;
+}
+
+XRAPI_ATTR XrResult XRAPI_CALL mockEnumerateSwapchainImages(
+    XrSwapchain swapchainHandle,
+    uint32_t imageCapacityInput,
+    uint32_t* imageCountOutput,
+    XrSwapchainImageBaseHeader* images) {
+    ScopedCall scope(CALL_ENUMERATE_SWAPCHAIN_IMAGES);
+    const Swapchain* swapchain = getSwapchain(swapchainHandle);
+    if (swapchain == nullptr) {
+        return XR_ERROR_HANDLE_INVALID;
+    }
+    if (imageCountOutput == nullptr) {
+        return XR_ERROR_VALIDATION_FAILURE;
+    }
+    *imageCountOutput = SWAPCHAIN_LENGTH;
+    if (imageCapacityInput == 0) {
+        return XR_SUCCESS;
+    }
+    if (imageCapacityInput < SWAPCHAIN_LENGTH || images == nullptr) {
+        return XR_ERROR_SIZE_INSUFFICIENT;
+    }
+    if (images[0].type != XR_TYPE_SWAPCHAIN_IMAGE_OPENGL_KHR) {
+        return XR_ERROR_VALIDATION_FAILURE;
+    }
+    XrSwapchainImageOpenGLKHR* glImages = reinterpret_cast<XrSwapchainImageOpenGLKHR*>(images);
+    for (uint32_t i = 0; i < SWAPCHAIN_LENGTH; i++) {
+        glImages[i].image = swapchain->images[i];
+    }
+    return XR_SUCCESS;
+}
+
+XRAPI_ATTR XrResult XRAPI_CALL mockAcquireSwapchainImage(
+    XrSwapchain swapchainHandle,
+    const XrSwapchainImageAcquireInfo* acquireInfo,
+    uint32_t* index) {
+    ScopedCall scope(CALL_ACQUIRE_SWAPCHAIN_IMAGE);
+    Swapchain* swapchain = getSwapchain(swapchainHandle);
+    if (swapchain == nullptr) {
+        return XR_ERROR_HANDLE_INVALID;
+    }
+    if (index == nullptr) {
+        return XR_ERROR_VALIDATION_FAILURE;
+    }
+    *index = swapchain->next;
+    swapchain->next = (swapchain->next + 1) % SWAPCHAIN_LENGTH;
+    return XR_SUCCESS;
+}
+
+XRAPI_ATTR XrResult XRAPI_CALL mockWaitSwapchainImage(
+    XrSwapchain swapchainHandle,
+    const XrSwapchainImageWaitInfo* waitInfo) {
+    ScopedCall scope(CALL_WAIT_SWAPCHAIN_IMAGE);
+    return getSwapchain(swapchainHandle) == nullptr ? XR_ERROR_HANDLE_INVALID : XR_SUCCESS;
+}
+
+XRAPI_ATTR XrResult XRAPI_CALL mockReleaseSwapchainImage(
+    XrSwapchain swapchainHandle,
+    const XrSwapchainImageReleaseInfo* releaseInfo) {
+    ScopedCall scope(CALL_RELEASE_SWAPCHAIN_IMAGE);
+    return getSwapchain(swapchainHandle) == nullptr ? XR_ERROR_HANDLE_INVALID : XR_SUCCESS;
+}
+
+XRAPI_ATTR XrResult XRAPI_CALL mockWaitFrame(
+    XrSession sessionHandle,
+    const XrFrameWaitInfo* frameWaitInfo,
+    XrFrameState* frameState) {
+    XrTime displayTime = 0;
+    {
+        ScopedCall scope(CALL_WAIT_FRAME);
+        Session* session = getSession(sessionHandle);
+        if (session == nullptr) {
+            return XR_ERROR_HANDLE_INVALID;
+        }
+        if (frameState == nullptr) {
+            return XR_ERROR_VALIDATION_FAILURE;
+        }
+        {
+            // Como un runtime real: no se entrega otro frame hasta que se empiece el
+            // anterior con xrBeginFrame, que en modo pipeline viene de otro hilo
+            std::unique_lock<std::mutex> lock(session->frameMutex);
+            session->frameCv.wait(
+                lock, [session] { return !session->waitedFrame || !session->running; });
+            if (!session->running) {
+                return XR_ERROR_SESSION_NOT_RUNNING;
+            }
+        }
+
+        const MockRuntimeConfig& config = instance->config;
+        const uint64_t periodNs = static_cast<uint64_t>(1e9 / std::max(config.displayHz, 1.0));
+        session->nextVsyncNs += periodNs;
+        if (!config.freeRun) {
+            const uint64_t now = nowNs();
+            if (now > session->nextVsyncNs) {
+                // Frames perdidos: se salta al siguiente vsync
+                const uint64_t missed = (now - session->nextVsyncNs) / periodNs + 1;
+                std::lock_guard<std::mutex> lock(instance->statsMutex);
+                instance->frameStats.missedVsyncs += missed;
+                session->nextVsyncNs += missed * periodNs;
+            }
+            std::this_thread::sleep_until(Clock::time_point(
+                std::chrono::duration_cast<Clock::duration>(
+                    std::chrono::nanoseconds(session->nextVsyncNs))));
+        }
+
+        // Se predice para el vsync siguiente, como con la tuberia de un runtime real
+        frameState->predictedDisplayTime = toXrTime(*session, session->nextVsyncNs + periodNs);
+        frameState->predictedDisplayPeriod = static_cast<XrDuration>(periodNs);
+        frameState->shouldRender = session->state == XR_SESSION_STATE_VISIBLE ||
+                session->state == XR_SESSION_STATE_FOCUSED
+            ? XR_TRUE
+            : XR_FALSE;
+        session->lastDisplayTime = frameState->predictedDisplayTime;
+        displayTime = frameState->predictedDisplayTime;
+        std::lock_guard<std::mutex> lock(session->frameMutex);
+        session->waitedFrame = true;
+    }
+    // Lo que queda de frame es del framework
+    std::lock_guard<std::mutex> lock(instance->statsMutex);
+    std::deque<FrameStart>& inFlight = instance->frameStats.inFlight;
+    if (inFlight.size() == MAX_FRAMES_IN_FLIGHT) {
+        inFlight.pop_front(); // nunca terminado
+    }
+    inFlight.push_back({displayTime, nowNs(), instance->runtimeNs});
+    return XR_SUCCESS;
+}
+
+XRAPI_ATTR XrResult XRAPI_CALL mockBeginFrame(
+    XrSession sessionHandle,
+    const XrFrameBeginInfo* frameBeginInfo) {
+    ScopedCall scope(CALL_BEGIN_FRAME);
+    Session* session = getSession(sessionHandle);
+    if (session == nullptr) {
+        return XR_ERROR_HANDLE_INVALID;
+    }
+    bool discarded = false;
+    {
+        std::lock_guard<std::mutex> lock(session->frameMutex);
+        if (!session->running) {
+            return XR_ERROR_SESSION_NOT_RUNNING;
+        }
+        if (!session->waitedFrame) {
+            return XR_ERROR_CALL_ORDER_INVALID;
+        }
+        session->waitedFrame = false;
+        discarded = session->frameBegun;
+        session->frameBegun = true;
+    }
+    session->frameCv.notify_all();
+    return discarded ? XR_FRAME_DISCARDED : XR_SUCCESS;
+}
+
+XRAPI_ATTR XrResult XRAPI_CALL mockEndFrame(
+    XrSession sessionHandle,
+    const XrFrameEndInfo* frameEndInfo) {
+    const uint64_t entryNs = nowNs();
+    if (instance == nullptr) {
+        return XR_ERROR_HANDLE_INVALID;
+    }
+    FrameStats& frameStats = instance->frameStats;
+    if (frameEndInfo != nullptr) {
+        // El frame se reconoce por su displayTime. Con XrApp en modo pipeline esto mide
+        // desde que vuelve su xrWaitFrame en el hilo de simulacion hasta aqui: latencia del
+        // frame, no CPU de un solo hilo
+        std::lock_guard<std::mutex> lock(instance->statsMutex);
+        std::deque<FrameStart>& inFlight = frameStats.inFlight;
+        const auto start = std::find_if(
+            inFlight.begin(), inFlight.end(), [frameEndInfo](const FrameStart& frame) {
+                return frame.displayTime == frameEndInfo->displayTime;
+            });
+        if (start != inFlight.end()) {
+            const uint64_t inRuntime = instance->runtimeNs - start->runtimeNs;
+            const uint64_t elapsed = entryNs - start->ns;
+            frameStats.appNs.push_back(static_cast<uint32_t>(
+                std::min<uint64_t>(elapsed - std::min(elapsed, inRuntime), UINT32_MAX)));
+            // Los anteriores no se van a terminar ya
+            inFlight.erase(inFlight.begin(), start + 1);
+        }
+    }
+
+    ScopedCall scope(CALL_END_FRAME);
+    Session* session = getSession(sessionHandle);
+    if (session == nullptr) {
+        return XR_ERROR_HANDLE_INVALID;
+    }
+    if (frameEndInfo == nullptr) {
+        return XR_ERROR_VALIDATION_FAILURE;
+    }
+    if (frameEndInfo->layerCount > MAX_LAYER_COUNT) {
+        return XR_ERROR_LAYER_LIMIT_EXCEEDED;
+    }
+    {
+        std::lock_guard<std::mutex> lock(session->frameMutex);
+        if (!session->frameBegun) {
+            return XR_ERROR_CALL_ORDER_INVALID;
+        }
+        session->frameBegun = false;
+    }
+    uint64_t frames = 0;
+    {
+        std::lock_guard<std::mutex> lock(instance->statsMutex);
+        frames = ++frameStats.frames;
+        frameStats.layers += frameEndInfo->layerCount;
+    }
+    if (instance->config.frameLimit > 0 && frames >= instance->config.frameLimit) {
+        beginExit(*session);
+    }
+    return XR_SUCCESS;
+}
+
+XRAPI_ATTR XrResult XRAPI_CALL mockLocateViews(
+    XrSession sessionHandle,
+    const XrViewLocateInfo* viewLocateInfo,
+    XrViewState* viewState,
+    uint32_t viewCapacityInput,
+    uint32_t* viewCountOutput,
+    XrView* views) {
+    ScopedCall scope(CALL_LOCATE_VIEWS);
+    Session* session = getSession(sessionHandle);
+    if (session == nullptr) {
+        return XR_ERROR_HANDLE_INVALID;
+    }
+    if (viewLocateInfo == nullptr || viewState == nullptr || viewCountOutput == nullptr) {
+        return XR_ERROR_VALIDATION_FAILURE;
+    }
+    if (viewLocateInfo->viewConfigurationType != XR_VIEW_CONFIGURATION_TYPE_PRIMARY_STEREO) {
+        return XR_ERROR_VIEW_CONFIGURATION_TYPE_UNSUPPORTED;
+    }
+    *viewCountOutput = VIEW_COUNT;
+    if (viewCapacityInput == 0) {
+        return XR_SUCCESS;
+    }
+    if (viewCapacityInput < VIEW_COUNT || views == nullptr) {
+        return XR_ERROR_SIZE_INSUFFICIENT;
+    }
+    const Space* space = fromHandle<Space>(viewLocateInfo->space);
+    XrPosef spacePose;
+    if (space == nullptr ||
+        !locateInWorld(*session, *space, viewLocateInfo->displayTime, spacePose)) {
+        viewState->viewStateFlags = 0;
+        return XR_SUCCESS;
+    }
+    const XrPosef head = sampleAt(*session, viewLocateInfo->displayTime).head;
+    const XrPosef spaceFromWorld = MockPose::invert(spacePose);
+    for (uint32_t eye = 0; eye < VIEW_COUNT; eye++) {
+        const XrPosef headFromEye = {
+            {0.0f, 0.0f, 0.0f, 1.0f}, {eye == 0 ? -0.5f * IPD : 0.5f * IPD, 0.0f, 0.0f}};
+        views[eye].pose = MockPose::multiply(spaceFromWorld, MockPose::multiply(head, headFromEye));
+        views[eye].fov = EYE_FOV;
+    }
+    viewState->viewStateFlags = XR_VIEW_STATE_ORIENTATION_VALID_BIT |
+        XR_VIEW_STATE_POSITION_VALID_BIT | XR_VIEW_STATE_ORIENTATION_TRACKED_BIT |
+        XR_VIEW_STATE_POSITION_TRACKED_BIT;
+    return XR_SUCCESS;
+}
+
+XRAPI_ATTR XrResult XRAPI_CALL mockStringToPath(
+    XrInstance instanceHandle,
+    const char* pathString,
+    XrPath* path) {
+    ScopedCall scope(CALL_STRING_TO_PATH);
+    if (fromHandle<Instance>(instanceHandle) != instance || instance == nullptr) {
+        return XR_ERROR_HANDLE_INVALID;
+    }
+    if (pathString == nullptr || path == nullptr) {
+        return XR_ERROR_VALIDATION_FAILURE;
+    }
+    if (pathString[0] != '/') {
+        return XR_ERROR_PATH_FORMAT_INVALID;
+    }
+    *path = internPath(pathString);
+    return XR_SUCCESS;
+}
+
+XRAPI_ATTR XrResult XRAPI_CALL mockPathToString(
+    XrInstance instanceHandle,
+    XrPath path,
+    uint32_t bufferCapacityInput,
+    uint32_t* bufferCountOutput,
+    char* buffer) {
+    ScopedCall scope(CALL_PATH_TO_STRING);
+    if (fromHandle<Instance>(instanceHandle) != instance || instance == nullptr) {
+        return XR_ERROR_HANDLE_INVALID;
+    }
+    if (path == XR_NULL_PATH || path > instance->paths.size()) {
+        return XR_ERROR_PATH_INVALID;
+    }
+    const std::string& value = instance->paths[path - 1];
+    return fillArray(
+        bufferCapacityInput,
+        bufferCountOutput,
+        buffer,
+        value.c_str(),
+        static_cast<uint32_t>(value.size() + 1));
+}
+
+XRAPI_ATTR XrResult XRAPI_CALL mockCreateActionSet(
+    XrInstance instanceHandle,
+    const XrActionSetCreateInfo* createInfo,
+    XrActionSet* actionSetOut) {
+    ScopedCall scope(CALL_CREATE_ACTION_SET);
+    if (fromHandle<Instance>(instanceHandle) != instance || instance == nullptr) {
+        return XR_ERROR_HANDLE_INVALID;
+    }
+    if (createInfo == nullptr || actionSetOut == nullptr) {
+        return XR_ERROR_VALIDATION_FAILURE;
+    }
+    std::unique_ptr<ActionSet> actionSet(new ActionSet());
+    actionSet->name = createInfo->actionSetName;
+    *actionSetOut = toHandle<XrActionSet>(actionSet.get());
+    instance->actionSets.push_back(std::move(actionSet));
+    return XR_SUCCESS;
+}
+
+XRAPI_ATTR XrResult XRAPI_CALL mockDestroyActionSet(XrActionSet actionSetHandle) {
+    ScopedCall scope(CALL_DESTROY_ACTION_SET);
+    if (instance == nullptr) {
+        return XR_ERROR_HANDLE_INVALID;
+    }
+    const ActionSet* actionSet = fromHandle<ActionSet>(actionSetHandle);
+    std::vector<std::unique_ptr<ActionSet>>& sets = instance->actionSets;
+    auto it = std::find_if(
+        sets.begin(), sets.end(), [actionSet](const std::unique_ptr<ActionSet>& s) {
+            return s.get() == actionSet;
+        });
+    if (it == sets.end()) {
+        return XR_ERROR_HANDLE_INVALID;
+    }
+    sets.erase(it);
+    return XR_SUCCESS;
+}
+
+XRAPI_ATTR XrResult XRAPI_CALL mockCreateAction(
+    XrActionSet actionSetHandle,
+    const XrActionCreateInfo* createInfo,
+    XrAction* actionOut) {
+    ScopedCall scope(CALL_CREATE_ACTION);
+    ActionSet* actionSet = fromHandle<ActionSet>(actionSetHandle);
+    if (actionSet == nullptr) {
+        return XR_ERROR_HANDLE_INVALID;
+    }
+    if (createInfo == nullptr || actionOut == nullptr) {
+        return XR_ERROR_VALIDATION_FAILURE;
+    }
+    if (actionSet->attached) {
+        return XR_ERROR_ACTIONSETS_ALREADY_ATTACHED;
+    }
+    std::unique_ptr<Action> action(new Action());
+    action->set = actionSet;
+    action->type = createInfo->actionType;
+    action->name = createInfo->actionName;
+    action->subactionPaths.assign(
+        createInfo->subactionPaths, createInfo->subactionPaths + createInfo->countSubactionPaths);
+    *actionOut = toHandle<XrAction>(action.get());
+    actionSet->actions.push_back(std::move(action));
+    return XR_SUCCESS;
+}
+
+XRAPI_ATTR XrResult XRAPI_CALL mockDestroyAction(XrAction actionHandle) {
+    ScopedCall scope(CALL_DESTROY_ACTION);
+    Action* action = fromHandle<Action>(actionHandle);
+    if (action == nullptr) {
+        return XR_ERROR_HANDLE_INVALID;
+    }
+    std::vector<std::unique_ptr<Action>>& actions = action->set->actions;
+    actions.erase(std::find_if(
+        actions.begin(), actions.end(), [action](const std::unique_ptr<Action>& a) {
+            return a.get() == action;
+        }));
+    return XR_SUCCESS;
+}
+
+XRAPI_ATTR XrResult XRAPI_CALL mockSuggestInteractionProfileBindings(
+    XrInstance instanceHandle,
+    const XrInteractionProfileSuggestedBinding* suggestedBindings) {
+    ScopedCall scope(CALL_SUGGEST_INTERACTION_PROFILE_BINDINGS);
+    if (fromHandle<Instance>(instanceHandle) != instance || instance == nullptr) {
+        return XR_ERROR_HANDLE_INVALID;
+    }
+    if (suggestedBindings == nullptr) {
+        return XR_ERROR_VALIDATION_FAILURE;
+    }
+    std::vector<SuggestedBinding>* target = nullptr;
+    if (suggestedBindings->interactionProfile == instance->touchProfilePath) {
+        target = &instance->touchBindings;
+    } else if (suggestedBindings->interactionProfile == instance->simpleProfilePath) {
+        target = &instance->simpleBindings;
+    } else {
+        // Perfiles de otros mandos: validos, pero no se simulan
+        return XR_SUCCESS;
+    }
+    // Como en OpenXR, cada llamada sustituye lo sugerido antes para ese perfil
+    target->clear();
+    for (uint32_t i = 0; i < suggestedBindings->countSuggestedBindings; i++) {
+        const XrActionSuggestedBinding& binding = suggestedBindings->suggestedBindings[i];
+        target->push_back({binding.action, binding.binding});
+    }
+    return XR_SUCCESS;
+}
+
+XRAPI_ATTR XrResult XRAPI_CALL mockAttachSessionActionSets(
+    XrSession sessionHandle,
+    const XrSessionActionSetsAttachInfo* attachInfo) {
+    ScopedCall scope(CALL_ATTACH_SESSION_ACTION_SETS);
+    Session* session = getSession(sessionHandle);
+    if (session == nullptr) {
+        return XR_ERROR_HANDLE_INVALID;
+    }
+    if (attachInfo == nullptr) {
+        return XR_ERROR_VALIDATION_FAILURE;
+    }
+    if (!session->attachedSets.empty()) {
+        return XR_ERROR_ACTIONSETS_ALREADY_ATTACHED;
+    }
+    for (uint32_t i = 0; i < attachInfo->countActionSets; i++) {
+        ActionSet* actionSet = fromHandle<ActionSet>(attachInfo->actionSets[i]);
+        actionSet->attached = true;
+        session->attachedSets.push_back(actionSet);
+    }
+    resolveBindings(*session);
+    return XR_SUCCESS;
+}
+
+XRAPI_ATTR XrResult XRAPI_CALL mockGetCurrentInteractionProfile(
+    XrSession sessionHandle,
+    XrPath topLevelUserPath,
+    XrInteractionProfileState* interactionProfile) {
+    ScopedCall scope(CALL_GET_CURRENT_INTERACTION_PROFILE);
+    Session* session = getSession(sessionHandle);
+    if (session == nullptr) {
+        return XR_ERROR_HANDLE_INVALID;
+    }
+    if (interactionProfile == nullptr) {
+        return XR_ERROR_VALIDATION_FAILURE;
+    }
+    if (session->attachedSets.empty()) {
+        return XR_ERROR_ACTIONSET_NOT_ATTACHED;
+    }
+    interactionProfile->interactionProfile =
+        handOfPath(topLevelUserPath) >= 0 ? session->interactionProfile : XR_NULL_PATH;
+    return XR_SUCCESS;
+}
+
+XRAPI_ATTR XrResult XRAPI_CALL mockGetActionStateBoolean(
+    XrSession sessionHandle,
+    const XrActionStateGetInfo* getInfo,
+    XrActionStateBoolean* state) {
+    ScopedCall scope(CALL_GET_ACTION_STATE_BOOLEAN);
+    if (state == nullptr) {
+        return XR_ERROR_VALIDATION_FAILURE;
+    }
+    ActionValue current;
+    ActionValue previous;
+    Session* session = nullptr;
+    const XrResult result = getActionValues(sessionHandle, getInfo, current, previous, session);
+    if (XR_FAILED(result)) {
+        return result;
+    }
+    state->currentState = current.boolean ? XR_TRUE : XR_FALSE;
+    state->changedSinceLastSync = current.boolean != previous.boolean ? XR_TRUE : XR_FALSE;
+    // Solo se sabe si cambio en el ultimo sync, no cuando fue el cambio anterior
+    state->lastChangeTime = state->changedSinceLastSync ? session->syncTime : 0;
+    state->isActive = current.active ? XR_TRUE : XR_FALSE;
+    return XR_SUCCESS;
+}
+
+XRAPI_ATTR XrResult XRAPI_CALL mockGetActionStateFloat(
+    XrSession sessionHandle,
+    const XrActionStateGetInfo* getInfo,
+    XrActionStateFloat* state) {
+    ScopedCall scope(CALL_GET_ACTION_STATE_FLOAT);
+    if (state == nullptr) {
+        return XR_ERROR_VALIDATION_FAILURE;
+    }
+    ActionValue current;
+    ActionValue previous;
+    Session* session = nullptr;
+    const XrResult result = getActionValues(sessionHandle, getInfo, current, previous, session);
+    if (XR_FAILED(result)) {
+        return result;
+    }
+    state->currentState = current.scalar;
+    state->changedSinceLastSync = current.scalar != previous.scalar ? XR_TRUE : XR_FALSE;
+    state->lastChangeTime = state->changedSinceLastSync ? session->syncTime : 0;
+    state->isActive = current.active ? XR_TRUE : XR_FALSE;
+    return XR_SUCCESS;
+}
+
+XRAPI_ATTR XrResult XRAPI_CALL mockGetActionStateVector2f(
+    XrSession sessionHandle,
+    const XrActionStateGetInfo* getInfo,
+    XrActionStateVector2f* state) {
+    ScopedCall scope(CALL_GET_ACTION_STATE_VECTOR2F);
+    if (state == nullptr) {
+        return XR_ERROR_VALIDATION_FAILURE;
+    }
+    ActionValue current;
+    ActionValue previous;
+    Session* session = nullptr;
+    const XrResult result = getActionValues(sessionHandle, getInfo, current, previous, session);
+    if (XR_FAILED(result)) {
+        return result;
+    }
+    state->currentState = current.vector;
+    state->changedSinceLastSync =
+        current.vector.x != previous.vector.x || current.vector.y != previous.vector.y
+        ? XR_TRUE
+        : XR_FALSE;
+    state->lastChangeTime = state->changedSinceLastSync ? session->syncTime : 0;
+    state->isActive = current.active ? XR_TRUE : XR_FALSE;
+    return XR_SUCCESS;
+}
+
+XRAPI_ATTR XrResult XRAPI_CALL mockGetActionStatePose(
+    XrSession sessionHandle,
+    const XrActionStateGetInfo* getInfo,
+    XrActionStatePose* state) {
+    ScopedCall scope(CALL_GET_ACTION_STATE_POSE);
+    if (state == nullptr) {
+        return XR_ERROR_VALIDATION_FAILURE;
+    }
+    ActionValue current;
+    ActionValue previous;
+    Session* session = nullptr;
+    const XrResult result = getActionValues(sessionHandle, getInfo, current, previous, session);
+    if (XR_FAILED(result)) {
+        return result;
+    }
+    state->isActive = current.active ? XR_TRUE : XR_FALSE;
+    return XR_SUCCESS;
+}
+
+XRAPI_ATTR XrResult XRAPI_CALL mockSyncActions(
+    XrSession sessionHandle,
+    const XrActionsSyncInfo* syncInfo) {
+    ScopedCall scope(CALL_SYNC_ACTIONS);
+    Session* session = getSession(sessionHandle);
+    if (session == nullptr) {
+        return XR_ERROR_HANDLE_INVALID;
+    }
+    if (syncInfo == nullptr) {
+        return XR_ERROR_VALIDATION_FAILURE;
+    }
+    if (!session->running) {
+        return XR_ERROR_SESSION_NOT_RUNNING;
+    }
+    // La entrada se toma en el instante de display del frame en curso
+    const XrTime lastDisplayTime = session->lastDisplayTime;
+    const XrTime time = lastDisplayTime > 0 ? lastDisplayTime : 1;
+    session->previousSynced = session->everSynced ? session->synced : sampleAt(*session, time);
+    session->synced = sampleAt(*session, time);
+    session->syncTime = time;
+    session->everSynced = true;
+    return session->state == XR_SESSION_STATE_FOCUSED ? XR_SUCCESS : XR_SESSION_NOT_FOCUSED;
+}
+
+XRAPI_ATTR XrResult XRAPI_CALL mockApplyHapticFeedback(
+    XrSession sessionHandle,
+    const XrHapticActionInfo* hapticActionInfo,
+    const XrHapticBaseHeader* hapticFeedback) {
+    ScopedCall scope(CALL_APPLY_HAPTIC_FEEDBACK);
+    return getSession(sessionHandle) == nullptr ? XR_ERROR_HANDLE_INVALID : XR_SUCCESS;
+}
+
+XRAPI_ATTR XrResult XRAPI_CALL mockStopHapticFeedback(
+    XrSession sessionHandle,
+    const XrHapticActionInfo* hapticActionInfo) {
+    ScopedCall scope(CALL_STOP_HAPTIC_FEEDBACK);
+    return getSession(sessionHandle) == nullptr ? XR_ERROR_HANDLE_INVALID : XR_SUCCESS;
+}
+
+// ---- Tabla de funciones ----
+
+struct Entry {
+    const char* name;
+    PFN_xrVoidFunction function;
+};
+
+#define MOCKXR_ENTRY(name, function) \
+    { name, reinterpret_cast<PFN_xrVoidFunction>(function) }
+
+const Entry ENTRIES[] = {
+    MOCKXR_ENTRY("xrGetInstanceProcAddr", mockGetInstanceProcAddr),
+    MOCKXR_ENTRY(
+        "xrEnumerateInstanceExtensionProperties",
+        mockEnumerateInstanceExtensionProperties),
+    MOCKXR_ENTRY("xrCreateInstance", mockCreateInstance),
+    MOCKXR_ENTRY("xrDestroyInstance", mockDestroyInstance),
+    MOCKXR_ENTRY("xrGetInstanceProperties", mockGetInstanceProperties),
+    MOCKXR_ENTRY("xrPollEvent", mockPollEvent),
+    MOCKXR_ENTRY("xrResultToString", mockResultToString),
+    MOCKXR_ENTRY("xrStructureTypeToString", mockStructureTypeToString),
+    MOCKXR_ENTRY("xrGetSystem", mockGetSystem),
+    MOCKXR_ENTRY("xrGetSystemProperties", mockGetSystemProperties),
+    MOCKXR_ENTRY("xrEnumerateEnvironmentBlendModes", mockEnumerateEnvironmentBlendModes),
+    MOCKXR_ENTRY("xrGetOpenGLGraphicsRequirementsKHR", mockGetOpenGLGraphicsRequirementsKHR),
+    MOCKXR_ENTRY("xrCreateSession", mockCreateSession),
+    MOCKXR_ENTRY("xrDestroySession", mockDestroySession),
+    MOCKXR_ENTRY("xrBeginSession", mockBeginSession),
+    MOCKXR_ENTRY("xrEndSession", mockEndSession),
+    MOCKXR_ENTRY("xrRequestExitSession", mockRequestExitSession),
+    MOCKXR_ENTRY("xrEnumerateReferenceSpaces", mockEnumerateReferenceSpaces),
+    MOCKXR_ENTRY("xrCreateReferenceSpace", mockCreateReferenceSpace),
+    MOCKXR_ENTRY("xrGetReferenceSpaceBoundsRect", mockGetReferenceSpaceBoundsRect),
+    MOCKXR_ENTRY("xrCreateActionSpace", mockCreateActionSpace),
+    MOCKXR_ENTRY("xrLocateSpace", mockLocateSpace),
+    MOCKXR_ENTRY("xrLocateSpaces", mockLocateSpaces),
+    MOCKXR_ENTRY("xrLocateSpacesKHR", mockLocateSpaces),
+    MOCKXR_ENTRY("xrDestroySpace", mockDestroySpace),
+    MOCKXR_ENTRY("xrEnumerateViewConfigurations", mockEnumerateViewConfigurations),
+    MOCKXR_ENTRY("xrGetViewConfigurationProperties", mockGetViewConfigurationProperties),
+    MOCKXR_ENTRY("xrEnumerateViewConfigurationViews", mockEnumerateViewConfigurationViews),
+    MOCKXR_ENTRY("xrEnumerateSwapchainFormats", mockEnumerateSwapchainFormats),
+    MOCKXR_ENTRY("xrCreateSwapchain", mockCreateSwapchain),
+    MOCKXR_ENTRY("xrDestroySwapchain", mockDestroySwapchain),
+    MOCKXR_ENTRY("xrEnumerateSwapchainImages", mockEnumerateSwapchainImages),
+    MOCKXR_ENTRY("xrAcquireSwapchainImage", mockAcquireSwapchainImage),
+    MOCKXR_ENTRY("xrWaitSwapchainImage", mockWaitSwapchainImage),
+    MOCKXR_ENTRY("xrReleaseSwapchainImage", mockReleaseSwapchainImage),
+    MOCKXR_ENTRY("xrWaitFrame", mockWaitFrame),
+    MOCKXR_ENTRY("xrBeginFrame", mockBeginFrame),
+    MOCKXR_ENTRY("xrEndFrame", mockEndFrame),
+    MOCKXR_ENTRY("xrLocateViews", mockLocateViews),
+    MOCKXR_ENTRY("xrStringToPath", mockStringToPath),
+    MOCKXR_ENTRY("xrPathToString", mockPathToString),
+    MOCKXR_ENTRY("xrCreateActionSet", mockCreateActionSet),
+    MOCKXR_ENTRY("xrDestroyActionSet", mockDestroyActionSet),
+    MOCKXR_ENTRY("xrCreateAction", mockCreateAction),
+    MOCKXR_ENTRY("xrDestroyAction", mockDestroyAction),
+    MOCKXR_ENTRY("xrSuggestInteractionProfileBindings", mockSuggestInteractionProfileBindings),
+    MOCKXR_ENTRY("xrAttachSessionActionSets", mockAttachSessionActionSets),
+    MOCKXR_ENTRY("xrGetCurrentInteractionProfile", mockGetCurrentInteractionProfile),
+    MOCKXR_ENTRY("xrGetActionStateBoolean", mockGetActionStateBoolean),
+    MOCKXR_ENTRY("xrGetActionStateFloat", mockGetActionStateFloat),
+    MOCKXR_ENTRY("xrGetActionStateVector2f", mockGetActionStateVector2f),
+    MOCKXR_ENTRY("xrGetActionStatePose", mockGetActionStatePose),
+    MOCKXR_ENTRY("xrSyncActions", mockSyncActions),
+    MOCKXR_ENTRY("xrApplyHapticFeedback", mockApplyHapticFeedback),
+    MOCKXR_ENTRY("xrStopHapticFeedback", mockStopHapticFeedback),
+};
+
+#undef MOCKXR_ENTRY
+
+XRAPI_ATTR XrResult XRAPI_CALL mockGetInstanceProcAddr(
+    XrInstance instanceHandle,
+    const char* name,
+    PFN_xrVoidFunction* function) {
+    if (name == nullptr || function == nullptr) {
+        return XR_ERROR_VALIDATION_FAILURE;
+    }
+    *function = nullptr;
+    if (instanceHandle == XR_NULL_HANDLE) {
+        // Sin instancia solo se pueden pedir estas
+        if (strcmp(name, "xrEnumerateInstanceExtensionProperties") != 0 &&
+            strcmp(name, "xrCreateInstance") != 0 &&
+            strcmp(name, "xrEnumerateApiLayerProperties") != 0) {
+            return XR_ERROR_HANDLE_INVALID;
+        }
+    } else if (fromHandle<Instance>(instanceHandle) != instance) {
+        return XR_ERROR_HANDLE_INVALID;
+    }
+    for (const Entry& entry : ENTRIES) {
+        if (strcmp(entry.name, name) == 0) {
+            *function = entry.function;
+            return XR_SUCCESS;
+        }
+    }
+    return XR_ERROR_FUNCTION_UNSUPPORTED;
+}
+
+// ---- Informe ----
+
+double percentileMs(std::vector<uint32_t>& samples, double fraction) {
+    if (samples.empty()) {
+        return 0.0;
+    }
+    const size_t index = std::min(
+        samples.size() - 1, static_cast<size_t>(fraction * static_cast<double>(samples.size())));
+    std::nth_element(samples.begin(), samples.begin() + index, samples.end());
+    return samples[index] * 1e-6;
+}
+
+void writeReport() {
+    FrameStats& frameStats = instance->frameStats;
+    const uint64_t frames = std::max<uint64_t>(frameStats.frames, 1);
+    std::vector<uint32_t> appNs = frameStats.appNs;
+    uint64_t appTotalNs = 0;
+    for (uint32_t ns : appNs) {
+        appTotalNs += ns;
+    }
+    const double appMeanMs = appNs.empty() ? 0.0 : appTotalNs * 1e-6 / appNs.size();
+    const double appP50 = percentileMs(appNs, 0.50);
+    const double appP95 = percentileMs(appNs, 0.95);
+    const double appP99 = percentileMs(appNs, 0.99);
+    const double appMax =
+        appNs.empty() ? 0.0 : *std::max_element(appNs.begin(), appNs.end()) * 1e-6;
+
+    ALOG(
+        "MockRuntime: %llu frames, %llu missed vsyncs, %.2f layers/frame",
+        static_cast<unsigned long long>(frameStats.frames),
+        static_cast<unsigned long long>(frameStats.missedVsyncs),
+        static_cast<double>(frameStats.layers) / frames);
+    ALOG(
+        "MockRuntime: framework CPU per frame mean %.3f ms p50 %.3f p95 %.3f p99 %.3f max %.3f",
+        appMeanMs,
+        appP50,
+        appP95,
+        appP99,
+        appMax);
+    for (int i = 0; i < MOCK_CALL_COUNT; i++) {
+        const MockCallStats& stats = instance->calls[i];
+        if (stats.calls == 0) {
+            continue;
+        }
+        ALOG(
+            "MockRuntime: %-40s %10llu calls %7.2f/frame mean %8.0f ns max %8llu ns",
+            CALL_NAMES[i],
+            static_cast<unsigned long long>(stats.calls),
+            static_cast<double>(stats.calls) / frames,
+            static_cast<double>(stats.totalNs) / stats.calls,
+            static_cast<unsigned long long>(stats.maxNs));
+    }
+
+    const std::string& filename = instance->config.statsFilename;
+    if (filename.empty()) {
+        return;
+    }
+    FILE* file = fopen(filename.c_str(), "w");
+    if (file == nullptr) {
+        ALOGE("MockRuntime: could not write %s", filename.c_str());
+        return;
+    }
+    fprintf(file, "function,calls,calls_per_frame,mean_ns,max_ns\n");
+    for (int i = 0; i < MOCK_CALL_COUNT; i++) {
+        const MockCallStats& stats = instance->calls[i];
+        fprintf(
+            file,
+            "%s,%llu,%.3f,%.0f,%llu\n",
+            CALL_NAMES[i],
+            static_cast<unsigned long long>(stats.calls),
+            static_cast<double>(stats.calls) / frames,
+            stats.calls > 0 ? static_cast<double>(stats.totalNs) / stats.calls : 0.0,
+            static_cast<unsigned long long>(stats.maxNs));
+    }
+    fprintf(
+        file,
+        "framework_frame,%llu,1.000,%.0f,%.0f\n",
+        static_cast<unsigned long long>(appNs.size()),
+        appMeanMs * 1e6,
+        appMax * 1e6);
+    fprintf(file, "framework_frame_p50,,,%.0f,\n", appP50 * 1e6);
+    fprintf(file, "framework_frame_p95,,,%.0f,\n", appP95 * 1e6);
+    fprintf(file, "framework_frame_p99,,,%.0f,\n", appP99 * 1e6);
+    fclose(file);
+}
+
+bool parseLatency(const char* value, uint32_t* latencyUs) {
+    bool ok = true;
+    std::string list = value;
+    size_t start = 0;
+    while (start < list.size()) {
+        const size_t comma = std::min(list.find(',', start), list.size());
+        const std::string item = list.substr(start, comma - start);
+        start = comma + 1;
+        const size_t equals = item.find('=');
+        if (equals == std::string::npos) {
+            ok = false;
+            continue;
+        }
+        const std::string name = item.substr(0, equals);
+        const uint32_t us = static_cast<uint32_t>(strtoul(item.c_str() + equals + 1, nullptr, 10));
+        bool matched = false;
+        for (int i = 0; i < MOCK_CALL_COUNT; i++) {
+            // Un nombre concreto manda sobre *, vaya antes o despues en la lista
+            if (name == CALL_NAMES[i]) {
+                latencyUs[i] = us | 0x80000000u;
+                matched = true;
+            } else if (name == "*" && (latencyUs[i] & 0x80000000u) == 0) {
+                latencyUs[i] = us;
+                matched = true;
+            }
+        }
+        if (!matched) {
+            ALOGW("MockRuntime: unknown function in MOCKXR_LATENCY: %s", name.c_str());
+            ok = false;
+        }
+    }
+    for (int i = 0; i < MOCK_CALL_COUNT; i++) {
+        latencyUs[i] &= 0x7fffffffu;
+    }
+    return ok;
+}
+
+} // namespace
+
+const char* mockCallName(MockCall call) {
+    return call < MOCK_CALL_COUNT ? CALL_NAMES[call] : "?";
+}
+
+bool MockRuntimeConfig::loadFromEnvironment() {
+    bool ok = true;
+    if (const char* value = getenv("MOCKXR_DISPLAY_HZ")) {
+        const double hz = atof(value);
+        if (hz > 0.0) {
+            displayHz = hz;
+        } else {
+            ok = false;
+        }
+    }
+    if (const char* value = getenv("MOCKXR_FREE_RUN")) {
+        freeRun = atoi(value) != 0;
+    }
+    if (const char* value = getenv("MOCKXR_FRAMES")) {
+        frameLimit = strtoull(value, nullptr, 10);
+    }
+    if (const char* value = getenv("MOCKXR_RECORDING")) {
+        recording = value;
+    }
+    if (const char* value = getenv("MOCKXR_EYE_SIZE")) {
+        unsigned width = 0;
+        unsigned height = 0;
+        if (sscanf(value, "%ux%u", &width, &height) == 2 && width > 0 && height > 0 &&
+            width <= 4096 && height <= 4096) {
+            eyeWidth = width;
+            eyeHeight = height;
+        } else {
+            ok = false;
+        }
+    }
+    if (const char* value = getenv("MOCKXR_STATS")) {
+        statsFilename = value;
+    }
+    if (const char* value = getenv("MOCKXR_LATENCY")) {
+        ok = parseLatency(value, latencyUs) && ok;
+    }
+    if (!ok) {
+        ALOGW("MockRuntime: some MOCKXR_* variables were ignored");
+    }
+    return ok;
+}
+
+extern "C" MOCKXR_EXPORT XRAPI_ATTR XrResult XRAPI_CALL xrNegotiateLoaderRuntimeInterface(
+    const XrNegotiateLoaderInfo* loaderInfo,
+    XrNegotiateRuntimeRequest* runtimeRequest) {
+    if (loaderInfo == nullptr || runtimeRequest == nullptr ||
+        loaderInfo->structType != XR_LOADER_INTERFACE_STRUCT_LOADER_INFO ||
+        loaderInfo->structVersion != XR_LOADER_INFO_STRUCT_VERSION ||
+        loaderInfo->structSize != sizeof(XrNegotiateLoaderInfo) ||
+        runtimeRequest->structType != XR_LOADER_INTERFACE_STRUCT_RUNTIME_REQUEST ||
+        runtimeRequest->structVersion != XR_RUNTIME_INFO_STRUCT_VERSION ||
+        runtimeRequest->structSize != sizeof(XrNegotiateRuntimeRequest)) {
+        return XR_ERROR_INITIALIZATION_FAILED;
+    }
+    if (loaderInfo->minInterfaceVersion > XR_CURRENT_LOADER_RUNTIME_VERSION ||
+        loaderInfo->maxInterfaceVersion < XR_CURRENT_LOADER_RUNTIME_VERSION ||
+        XR_VERSION_MAJOR(loaderInfo->maxApiVersion) < 1 ||
+        XR_VERSION_MAJOR(loaderInfo->minApiVersion) > 1) {
+        return XR_ERROR_INITIALIZATION_FAILED;
+    }
+    runtimeRequest->runtimeInterfaceVersion = XR_CURRENT_LOADER_RUNTIME_VERSION;
+    runtimeRequest->runtimeApiVersion = XR_CURRENT_API_VERSION;
+    runtimeRequest->getInstanceProcAddr = mockGetInstanceProcAddr;
+    return XR_SUCCESS;
+}
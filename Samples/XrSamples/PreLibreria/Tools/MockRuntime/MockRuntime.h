@@ -0,0 +1,190 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#define XR_USE_GRAPHICS_API_OPENGL 1
+#include <openxr/openxr.h>
+#include <openxr/openxr_platform.h>
+
+#include "Recorder/FrameData.h"
+
+/*
+    Runtime de OpenXR falso para medir XrApp::MainLoop sin casco.
+
+    Es una libreria compartida que el loader carga como cualquier runtime
+    (xrNegotiateLoaderRuntimeInterface + manifiesto JSON, se elige con XR_RUNTIME_JSON).
+    Implementa lo que usan XrApp y Framebuffer: instancia, sistema, sesion con sus
+    estados, espacios, vistas, swapchains de texturas GL, acciones y el ciclo
+    xrWaitFrame/xrBeginFrame/xrEndFrame. Las poses y los mandos salen de un guion
+    generado o de una grabacion (.vrmx o partes .vrmr/.vrms).
+
+    Cuenta las llamadas y el tiempo dentro de cada funcion, y mide el tiempo de CPU del
+    framework en cada frame: desde que vuelve xrWaitFrame hasta que entra xrEndFrame,
+    descontando lo que se pasa dentro del runtime. Al destruir la instancia lo escribe
+    en el log y, si se pide, en un CSV.
+
+    Una sola instancia y una sola sesion a la vez. Las llamadas llegan desde un solo hilo,
+    salvo con XrApp en modo pipeline: alli xrWaitFrame, xrLocateSpaces, xrLocateViews y
+    las acciones vienen del hilo de simulacion y el resto del de MainLoop. Solo OpenGL de
+    escritorio.
+*/
+
+// Funciones que se cuentan, una por punto de entrada
+enum MockCall {
+    CALL_ENUMERATE_INSTANCE_EXTENSION_PROPERTIES,
+    CALL_CREATE_INSTANCE,
+    CALL_DESTROY_INSTANCE,
+    CALL_GET_INSTANCE_PROPERTIES,
+    CALL_POLL_EVENT,
+    CALL_RESULT_TO_STRING,
+    CALL_STRUCTURE_TYPE_TO_STRING,
+    CALL_GET_SYSTEM,
+    CALL_GET_SYSTEM_PROPERTIES,
+    CALL_ENUMERATE_ENVIRONMENT_BLEND_MODES,
+    CALL_GET_OPENGL_GRAPHICS_REQUIREMENTS,
+    CALL_CREATE_SESSION,
+    CALL_DESTROY_SESSION,
+    CALL_BEGIN_SESSION,
+    CALL_END_SESSION,
+    CALL_REQUEST_EXIT_SESSION,
+    CALL_ENUMERATE_REFERENCE_SPACES,
+    CALL_CREATE_REFERENCE_SPACE,
+    CALL_GET_REFERENCE_SPACE_BOUNDS_RECT,
+    CALL_CREATE_ACTION_SPACE,
+    CALL_LOCATE_SPACE,
+    CALL_LOCATE_SPACES, // xrLocateSpaces y xrLocateSpacesKHR
+    CALL_DESTROY_SPACE,
+    CALL_ENUMERATE_VIEW_CONFIGURATIONS,
+    CALL_GET_VIEW_CONFIGURATION_PROPERTIES,
+    CALL_ENUMERATE_VIEW_CONFIGURATION_VIEWS,
+    CALL_ENUMERATE_SWAPCHAIN_FORMATS,
+    CALL_CREATE_SWAPCHAIN,
+    CALL_DESTROY_SWAPCHAIN,
+    CALL_ENUMERATE_SWAPCHAIN_IMAGES,
+    CALL_ACQUIRE_SWAPCHAIN_IMAGE,
+    CALL_WAIT_SWAPCHAIN_IMAGE,
+    CALL_RELEASE_SWAPCHAIN_IMAGE,
+    CALL_WAIT_FRAME,
+    CALL_BEGIN_FRAME,
+    CALL_END_FRAME,
+    CALL_LOCATE_VIEWS,
+    CALL_STRING_TO_PATH,
+    CALL_PATH_TO_STRING,
+    CALL_CREATE_ACTION_SET,
+    CALL_DESTROY_ACTION_SET,
+    CALL_CREATE_ACTION,
+    CALL_DESTROY_ACTION,
+    CALL_SUGGEST_INTERACTION_PROFILE_BINDINGS,
+    CALL_ATTACH_SESSION_ACTION_SETS,
+    CALL_GET_CURRENT_INTERACTION_PROFILE,
+    CALL_GET_ACTION_STATE_BOOLEAN,
+    CALL_GET_ACTION_STATE_FLOAT,
+    CALL_GET_ACTION_STATE_VECTOR2F,
+    CALL_GET_ACTION_STATE_POSE,
+    CALL_SYNC_ACTIONS,
+    CALL_APPLY_HAPTIC_FEEDBACK,
+    CALL_STOP_HAPTIC_FEEDBACK,
+    MOCK_CALL_COUNT
+};
+
+// Nombre OpenXR de cada MockCall ("xrWaitFrame", ...)
+const char* mockCallName(MockCall call);
+
+// Se lee de variables de entorno al crear la instancia: la app carga el runtime a
+// traves del loader y no tiene otra forma de configurarlo.
+struct MockRuntimeConfig {
+    double displayHz = 90.0; // MOCKXR_DISPLAY_HZ
+    bool freeRun = false; // MOCKXR_FREE_RUN=1: xrWaitFrame no espera, el reloj es virtual
+    uint64_t frameLimit = 0; // MOCKXR_FRAMES: pide salir despues de N frames, 0 = nunca
+    std::string recording; // MOCKXR_RECORDING: manifiesto .vrmx o partes separadas por comas
+    uint32_t eyeWidth = 1024; // MOCKXR_EYE_SIZE=WxH
+    uint32_t eyeHeight = 1024;
+    std::string statsFilename; // MOCKXR_STATS: CSV con las cuentas al destruir la instancia
+    // MOCKXR_LATENCY=xrWaitFrame=2000,xrLocateSpace=20,*=1 (microsegundos de espera
+    // activa al entrar en cada funcion, * para todas las que no se nombran)
+    uint32_t latencyUs[MOCK_CALL_COUNT] = {};
+
+    // Devuelve false si alguna variable no se entiende (se usa el valor por defecto)
+    bool loadFromEnvironment();
+};
+
+// Cuentas de una funcion
+struct MockCallStats {
+    uint64_t calls = 0;
+    uint64_t totalNs = 0;
+    uint64_t maxNs = 0;
+};
+
+// Fuentes de entrada del touch_controller (y select del simple_controller).
+// Los bits de MockHandState::buttons son 1 << SOURCE_*.
+enum MockInputSource {
+    SOURCE_AIM_POSE,
+    SOURCE_GRIP_POSE,
+    SOURCE_TRIGGER_VALUE,
+    SOURCE_SQUEEZE_VALUE,
+    SOURCE_THUMBSTICK,
+    SOURCE_THUMBSTICK_CLICK,
+    SOURCE_THUMBSTICK_TOUCH,
+    SOURCE_THUMBREST_TOUCH,
+    SOURCE_TRIGGER_TOUCH,
+    SOURCE_A_CLICK,
+    SOURCE_B_CLICK,
+    SOURCE_X_CLICK,
+    SOURCE_Y_CLICK,
+    SOURCE_MENU_CLICK,
+    SOURCE_SELECT_CLICK,
+    SOURCE_COUNT,
+    SOURCE_NONE = SOURCE_COUNT
+};
+
+// Fuente de un binding a partir de la parte de la ruta que sigue a /user/hand/<mano>
+MockInputSource mockInputSourceFor(const char* inputPath);
+
+struct MockHandState {
+    bool tracked = false;
+    XrPosef aim = {{0.0f, 0.0f, 0.0f, 1.0f}, {0.0f, 0.0f, 0.0f}};
+    XrPosef grip = {{0.0f, 0.0f, 0.0f, 1.0f}, {0.0f, 0.0f, 0.0f}};
+    float trigger = 0.0f;
+    float squeeze = 0.0f;
+    XrVector2f thumbstick = {0.0f, 0.0f};
+    uint32_t buttons = 0;
+
+    // Valor de una fuente que no es pose: 0/1 para botones, el eje para el joystick
+    float value(MockInputSource source) const;
+};
+
+// Todo lo que el runtime sabe del usuario en un instante. Las poses estan en el
+// espacio del mundo, que es a la vez LOCAL y STAGE.
+struct MockInputState {
+    XrPosef head = {{0.0f, 0.0f, 0.0f, 1.0f}, {0.0f, 0.0f, 0.0f}};
+    MockHandState hands[2]; // izquierda, derecha
+};
+
+// Poses y mandos en funcion del tiempo: un guion fijo (la cabeza mira a los lados, los
+// mandos hacen circulos, los gatillos oscilan, los botones se pulsan por turnos y el
+// mando izquierdo pierde el tracking un segundo de cada diez) o una grabacion en bucle.
+class MockInput {
+public:
+    // spec es un manifiesto .vrmx o una lista de partes separadas por comas
+    bool loadRecording(const std::string& spec);
+    bool isRecorded() const { return !frames.empty(); }
+
+    // seconds es el tiempo desde el inicio de la sesion
+    void sample(double seconds, MockInputState& out) const;
+
+private:
+    void sampleScripted(double seconds, MockInputState& out) const;
+    void sampleRecorded(double seconds, MockInputState& out) const;
+
+    std::vector<FrameData> frames;
+    mutable size_t cursor = 0; // ultimo frame usado, casi siempre vale el mismo o el siguiente
+};
+
+namespace MockPose {
+XrPosef identity();
+XrPosef multiply(const XrPosef& a, const XrPosef& b); // a * b, b expresada en a
+XrPosef invert(const XrPosef& pose);
+} // namespace MockPose
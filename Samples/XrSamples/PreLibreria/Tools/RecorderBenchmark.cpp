@@ -0,0 +1,645 @@
+// Microbenchmark de la ruta caliente de la grabadora, para comparar cambios.
+//
+//   prelibreria_recorder_bench [--seconds S] [--rates 72,90,120] [--backends csv,binary,...]
+//                              [--dir DIR] [--paced] [--max-ns-per-frame N]
+//                              [--max-allocs-per-frame N]
+//
+// Genera un flujo sintetico de ovrApplFrameIn (cabeza y mandos moviendose, gatillos y
+// botones) a cada frecuencia y lo pasa por cada backend:
+//
+//   csv       FrameData + toCSV + ofstream por frame, flush cada chunk (grabadora original)
+//   binary    FrameData al buffer del chunk, RecordingWriter::writeChunk cada chunk
+//   quantized igual que binary con las poses en PoseCodec a 0.1mm
+//   hands     igual que quantized con las 26 articulaciones de cada mano (HandJointColumn)
+//   mmap      MappedRecordingSink::append por frame, sync asincrono cada chunk
+//   async     MovementRecorder::recordFrame, el hilo escritor hace el resto
+//   decimated igual que async con PoseDecimator (1mm, 0.5 grados) en el escritor
+//
+// Por cada combinacion saca ns/frame (media y p99 del trabajo del hilo de render),
+// latencia del flush de cada chunk (p50/p99/max), bytes escritos y reservas de memoria
+// por frame en el hilo de render, contadas reemplazando operator new. En async el flush
+// es MovementRecorder::flush, es decir, lo que tarda el escritor en dejar el chunk en disco.
+//
+// Sin --paced los frames van seguidos (async usa BACKPRESSURE_BLOCK para no perder
+// ninguno); con --paced se espera a la hora de cada frame como en el casco. Los umbrales
+// --max-* hacen que termine con codigo 2 si algun caso los supera.
+//
+// Los ficheros se escriben en un subdirectorio propio, DIR/prelibreria_bench_<pid>, que se
+// vacia entre casos y se borra al terminar; DIR (por defecto el actual) no se toca.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <new>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <unistd.h>
+
+#include "Recorder/MappedRecordingSink.h"
+#include "Recorder/MovementRecorder.h"
+#include "Recorder/RecordingWriter.h"
+
+//==============================================================
+// Contador de reservas
+//==============================================================
+
+namespace {
+std::atomic<uint64_t> totalAllocations{0};
+thread_local uint64_t threadAllocations = 0;
+
+void* countedAlloc(size_t size) {
+    totalAllocations.fetch_add(1, std::memory_order_relaxed);
+    threadAllocations++;
+    void* p = malloc(size == 0 ? 1 : size);
+    if (p == nullptr) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void* countedAlignedAlloc(size_t size, std::align_val_t align) {
+    totalAllocations.fetch_add(1, std::memory_order_relaxed);
+    threadAllocations++;
+    void* p = nullptr;
+    if (posix_memalign(&p, std::max(sizeof(void*), static_cast<size_t>(align)), size == 0 ? 1 : size) != 0) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+} // namespace
+
+void* operator new(size_t size) {
+    return countedAlloc(size);
+}
+void* operator new[](size_t size) {
+    return countedAlloc(size);
+}
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+    try {
+        return countedAlloc(size);
+    } catch (...) {
+        return nullptr;
+    }
+}
+void* operator new[](size_t size, const std::nothrow_t&) noexcept {
+    try {
+        return countedAlloc(size);
+    } catch (...) {
+        return nullptr;
+    }
+}
+void* operator new(size_t size, std::align_val_t align) {
+    return countedAlignedAlloc(size, align);
+}
+void* operator new[](size_t size, std::align_val_t align) {
+    return countedAlignedAlloc(size, align);
+}
+void operator delete(void* p) noexcept {
+    free(p);
+}
+void operator delete[](void* p) noexcept {
+    free(p);
+}
+void operator delete(void* p, size_t) noexcept {
+    free(p);
+}
+void operator delete[](void* p, size_t) noexcept {
+    free(p);
+}
+void operator delete(void* p, std::align_val_t) noexcept {
+    free(p);
+}
+void operator delete[](void* p, std::align_val_t) noexcept {
+    free(p);
+}
+void operator delete(void* p, size_t, std::align_val_t) noexcept {
+    free(p);
+}
+void operator delete[](void* p, size_t, std::align_val_t) noexcept {
+    free(p);
+}
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+const int FRAMES_PER_CHUNK = MovementRecorder::FRAMES_PER_CHUNK;
+const uint32_t FRAMES_PER_SEGMENT = MovementRecorder::MAX_FRAMES_PER_FILE;
+
+enum Backend {
+    BACKEND_CSV,
+    BACKEND_BINARY,
+    BACKEND_QUANTIZED,
+    BACKEND_HANDS,
+    BACKEND_MMAP,
+    BACKEND_ASYNC,
+    BACKEND_DECIMATED,
+    BACKEND_COUNT
+};
+
+const char* const BACKEND_NAMES[BACKEND_COUNT] = {"csv", "binary", "quantized", "hands", "mmap", "async", "decimated"};
+
+struct Options {
+    double seconds = 60.0;
+    std::vector<int> rates = {72, 90, 120};
+    std::vector<Backend> backends = {
+        BACKEND_CSV,
+        BACKEND_BINARY,
+        BACKEND_QUANTIZED,
+        BACKEND_HANDS,
+        BACKEND_MMAP,
+        BACKEND_ASYNC,
+        BACKEND_DECIMATED};
+    std::string dir = "."; // --dir; el benchmark escribe en workDir, dentro
+    std::string workDir; // DIR/prelibreria_bench_<pid>, lo unico que se borra
+    bool paced = false;
+    double maxNsPerFrame = 0.0; // 0 = sin umbral
+    double maxAllocsPerFrame = -1.0; // < 0 = sin umbral
+};
+
+struct Result {
+    size_t frames = 0;
+    double meanNs = 0.0;
+    double p99Ns = 0.0;
+    double flushP50Ms = 0.0;
+    double flushP99Ms = 0.0;
+    double flushMaxMs = 0.0;
+    uint64_t bytes = 0;
+    double allocsPerFrame = 0.0;
+    double backgroundAllocsPerFrame = 0.0; // reservas de otros hilos (escritor de async)
+};
+
+// Todo lo que se mide en el hilo de render. Los vectores se reservan antes de contar.
+struct Samples {
+    std::vector<double> frameNs;
+    std::vector<double> flushMs;
+
+    explicit Samples(size_t frames) {
+        frameNs.reserve(frames);
+        flushMs.reserve(frames / FRAMES_PER_CHUNK + 16);
+    }
+};
+
+double percentile(std::vector<double>& values, double p) {
+    if (values.empty()) {
+        return 0.0;
+    }
+    std::sort(values.begin(), values.end());
+    const size_t rank = static_cast<size_t>(std::ceil(p * static_cast<double>(values.size())));
+    return values[std::min(values.size() - 1, rank > 0 ? rank - 1 : 0)];
+}
+
+double elapsedNs(Clock::time_point from, Clock::time_point to) {
+    return std::chrono::duration<double, std::nano>(to - from).count();
+}
+
+double elapsedMs(Clock::time_point from, Clock::time_point to) {
+    return std::chrono::duration<double, std::milli>(to - from).count();
+}
+
+// Movimiento plausible y determinista: la cabeza oscila y gira, los mandos describen
+// circulos, el mando derecho pierde el tracking un rato cada 10 segundos
+void buildSyntheticFrame(int64_t index, int rate, OVRFW::ovrApplFrameIn& in) {
+    const double t = static_cast<double>(index) / rate;
+    const float ft = static_cast<float>(t);
+    in.FrameIndex = index;
+    in.PredictedDisplayTime = t;
+    in.RealTimeInSeconds = t;
+    in.DeltaSeconds = index > 0 ? 1.0f / rate : 0.0f;
+
+    in.HeadPose = OVR::Posef(
+        OVR::Quatf(OVR::Vector3f(0.0f, 1.0f, 0.0f), 0.6f * sinf(0.5f * ft)),
+        OVR::Vector3f(0.05f * sinf(1.3f * ft), 1.6f + 0.02f * sinf(2.1f * ft), 0.03f * cosf(0.7f * ft)));
+    in.LeftRemotePose = OVR::Posef(
+        OVR::Quatf(OVR::Vector3f(1.0f, 0.0f, 0.0f), 0.8f * sinf(1.1f * ft)),
+        OVR::Vector3f(-0.25f + 0.1f * cosf(2.0f * ft), 1.2f + 0.1f * sinf(2.0f * ft), -0.3f));
+    in.RightRemotePose = OVR::Posef(
+        OVR::Quatf(OVR::Vector3f(0.0f, 0.0f, 1.0f), 0.8f * cosf(0.9f * ft)),
+        OVR::Vector3f(0.25f + 0.1f * sinf(1.7f * ft), 1.2f + 0.1f * cosf(1.7f * ft), -0.3f));
+    in.LeftRemoteTracked = true;
+    in.RightRemoteTracked = fmod(t, 10.0) < 8.0;
+    in.LeftRemoteIndexTrigger = 0.5f + 0.5f * sinf(3.0f * ft);
+    in.RightRemoteIndexTrigger = 0.5f + 0.5f * cosf(3.0f * ft);
+
+    in.LastFrameAllButtons = in.AllButtons;
+    in.AllButtons = (index / rate) % 3 == 0 ? OVRFW::ovrApplFrameIn::kButtonA : 0u;
+}
+
+// Manos sinteticas: los dedos se cierran y abren, la derecha pierde el tracking 3s de cada 10
+void buildSyntheticHands(int64_t index, int rate, HandJoints& left, HandJoints& right) {
+    const double t = static_cast<double>(index) / rate;
+    const float ft = static_cast<float>(t);
+    for (int hand = 0; hand < 2; hand++) {
+        HandJoints& h = hand == 0 ? left : right;
+        if (hand == 1 && fmod(t, 10.0) >= 7.0) {
+            h.clear();
+            continue;
+        }
+        const float side = hand == 0 ? -1.0f : 1.0f;
+        const float curl = 0.5f + 0.5f * sinf(2.0f * ft + side);
+        h.tracked = true;
+        for (int j = 0; j < HandJoints::JOINT_COUNT; j++) {
+            const float angle = 0.1f * curl * static_cast<float>(j % 5);
+            h.positions[j][0] = side * (0.2f + 0.01f * static_cast<float>(j));
+            h.positions[j][1] = 1.1f + 0.02f * sinf(ft) - 0.005f * curl * static_cast<float>(j % 5);
+            h.positions[j][2] = -0.3f - 0.004f * static_cast<float>(j);
+            h.rotations[j][0] = sinf(angle);
+            h.rotations[j][1] = 0.0f;
+            h.rotations[j][2] = 0.0f;
+            h.rotations[j][3] = cosf(angle);
+            h.radii[j] = 0.008f;
+            h.flags[j] = HandJoints::JOINT_ORIENTATION_VALID | HandJoints::JOINT_POSITION_VALID |
+                HandJoints::JOINT_ORIENTATION_TRACKED | HandJoints::JOINT_POSITION_TRACKED;
+        }
+    }
+}
+
+// Espera a la hora del frame en modo --paced
+void waitForFrame(const Options& options, Clock::time_point start, int64_t index, int rate) {
+    if (options.paced) {
+        std::this_thread::sleep_until(
+            start +
+            std::chrono::duration_cast<Clock::duration>(
+                std::chrono::duration<double>(static_cast<double>(index) / rate)));
+    }
+}
+
+uint64_t directorySize(const std::string& dir) {
+    uint64_t size = 0;
+    for (const auto& entry : std::filesystem::directory_iterator(dir)) {
+        if (entry.is_regular_file() && entry.path().extension() != ".txt") {
+            size += entry.file_size();
+        }
+    }
+    return size;
+}
+
+//==============================================================
+// Backends
+//==============================================================
+
+void runCsv(const Options& options, int rate, size_t frames, Samples& samples) {
+    std::ofstream file(options.workDir + "/recording.csv");
+    OVRFW::ovrApplFrameIn in;
+    const Clock::time_point start = Clock::now();
+    for (size_t i = 0; i < frames; i++) {
+        buildSyntheticFrame(static_cast<int64_t>(i), rate, in);
+        waitForFrame(options, start, static_cast<int64_t>(i), rate);
+
+        const Clock::time_point before = Clock::now();
+        FrameData frame(in, in.RealTimeInSeconds);
+        file << frame.toCSV() << "\n";
+        const Clock::time_point after = Clock::now();
+        samples.frameNs.push_back(elapsedNs(before, after));
+
+        if ((i + 1) % FRAMES_PER_CHUNK == 0) {
+            file.flush();
+            samples.flushMs.push_back(elapsedMs(after, Clock::now()));
+        }
+    }
+    file.close();
+}
+
+void runBinary(
+    const Options& options,
+    int rate,
+    size_t frames,
+    bool quantized,
+    bool withHands,
+    Samples& samples) {
+    const MovementRecorder::PoseCompression compression =
+        quantized ? MovementRecorder::PoseCompression::quantized(0.1f)
+                  : MovementRecorder::PoseCompression();
+    RecordingWriter writer;
+    writer.setPoseCodec(RECORDING_COLUMN_HEAD_POSE, compression.head);
+    writer.setPoseCodec(RECORDING_COLUMN_LEFT_POSE, compression.left);
+    writer.setPoseCodec(RECORDING_COLUMN_RIGHT_POSE, compression.right);
+
+    std::vector<FrameData> chunk(FRAMES_PER_CHUNK);
+    std::vector<HandFrameData> hands(withHands ? FRAMES_PER_CHUNK : 0);
+    HandFrameData handFrame;
+    size_t filled = 0;
+    int part = 0;
+    int framesInFile = 0;
+    char filename[64];
+
+    OVRFW::ovrApplFrameIn in;
+    const Clock::time_point start = Clock::now();
+    for (size_t i = 0; i < frames; i++) {
+        buildSyntheticFrame(static_cast<int64_t>(i), rate, in);
+        waitForFrame(options, start, static_cast<int64_t>(i), rate);
+
+        if (withHands) {
+            buildSyntheticHands(static_cast<int64_t>(i), rate, handFrame.hands[0], handFrame.hands[1]);
+            handFrame.timestamp = in.RealTimeInSeconds;
+        }
+
+        const Clock::time_point before = Clock::now();
+        if (withHands) {
+            hands[filled] = handFrame;
+        }
+        chunk[filled++] = FrameData(in, in.RealTimeInSeconds);
+        const Clock::time_point after = Clock::now();
+        samples.frameNs.push_back(elapsedNs(before, after));
+
+        if (filled == chunk.size() || i + 1 == frames) {
+            if (!writer.isOpen()) {
+                snprintf(filename, sizeof(filename), "/part%03d.vrmr", part);
+                writer.open(options.workDir + filename, static_cast<uint32_t>(part), 0);
+            }
+            writer.writeChunk(chunk.data(), withHands ? hands.data() : nullptr, filled);
+            writer.flush();
+            framesInFile += static_cast<int>(filled);
+            filled = 0;
+            if (framesInFile >= MovementRecorder::MAX_FRAMES_PER_FILE) {
+                writer.close();
+                part++;
+                framesInFile = 0;
+            }
+            samples.flushMs.push_back(elapsedMs(after, Clock::now()));
+        }
+    }
+    writer.close();
+}
+
+void runMapped(const Options& options, int rate, size_t frames, Samples& samples) {
+    MappedRecordingSink sink;
+    int part = 0;
+    char filename[64];
+
+    OVRFW::ovrApplFrameIn in;
+    const Clock::time_point start = Clock::now();
+    for (size_t i = 0; i < frames; i++) {
+        buildSyntheticFrame(static_cast<int64_t>(i), rate, in);
+        waitForFrame(options, start, static_cast<int64_t>(i), rate);
+
+        // Abrir el segmento siguiente cuenta como flush, no como coste del frame
+        if (!sink.isOpen()) {
+            const Clock::time_point before = Clock::now();
+            snprintf(filename, sizeof(filename), "/part%03d.vrms", part);
+            if (!sink.open(options.workDir + filename, static_cast<uint32_t>(part), 0, FRAMES_PER_SEGMENT)) {
+                return;
+            }
+            samples.flushMs.push_back(elapsedMs(before, Clock::now()));
+        }
+
+        const Clock::time_point before = Clock::now();
+        sink.append(FrameData(in, in.RealTimeInSeconds));
+        const Clock::time_point after = Clock::now();
+        samples.frameNs.push_back(elapsedNs(before, after));
+
+        if (sink.isFull()) {
+            sink.close();
+            part++;
+            samples.flushMs.push_back(elapsedMs(after, Clock::now()));
+        } else if ((i + 1) % FRAMES_PER_CHUNK == 0) {
+            sink.sync(false);
+            samples.flushMs.push_back(elapsedMs(after, Clock::now()));
+        }
+    }
+    sink.close();
+}
+
+void runAsync(const Options& options, int rate, size_t frames, bool decimated, Samples& samples) {
+    // MovementRecorder escribe en el directorio actual
+    const std::filesystem::path previous = std::filesystem::current_path();
+    std::filesystem::current_path(options.workDir);
+    {
+        PoseDecimatorConfig decimation;
+        decimation.enabled = decimated;
+        MovementRecorder recorder(
+            options.paced ? MovementRecorder::BACKPRESSURE_DROP_OLDEST
+                          : MovementRecorder::BACKPRESSURE_BLOCK,
+            MovementRecorder::PoseCompression(),
+            MovementRecorder::SINK_CHUNKED_FILE,
+            false,
+            decimation);
+
+        OVRFW::ovrApplFrameIn in;
+        const Clock::time_point start = Clock::now();
+        for (size_t i = 0; i < frames; i++) {
+            buildSyntheticFrame(static_cast<int64_t>(i), rate, in);
+            waitForFrame(options, start, static_cast<int64_t>(i), rate);
+
+            const Clock::time_point before = Clock::now();
+            recorder.recordFrame(in);
+            const Clock::time_point after = Clock::now();
+            samples.frameNs.push_back(elapsedNs(before, after));
+
+            if ((i + 1) % FRAMES_PER_CHUNK == 0) {
+                recorder.flush();
+                samples.flushMs.push_back(elapsedMs(after, Clock::now()));
+            }
+        }
+        recorder.finalize();
+        if (decimated) {
+            printf(
+                "  decimated: %llu of %zu frames not stored\n",
+                static_cast<unsigned long long>(recorder.getDecimatedFrames()),
+                frames);
+        }
+        if (recorder.getDroppedFrames() > 0) {
+            printf(
+                "  async: %llu frames dropped\n",
+                static_cast<unsigned long long>(recorder.getDroppedFrames()));
+        }
+    }
+    std::filesystem::current_path(previous);
+}
+
+Result runCase(const Options& options, Backend backend, int rate) {
+    std::filesystem::remove_all(options.workDir);
+    std::filesystem::create_directory(options.workDir);
+
+    const size_t frames = static_cast<size_t>(options.seconds * rate);
+    Samples samples(frames);
+
+    const uint64_t renderBefore = threadAllocations;
+    const uint64_t totalBefore = totalAllocations.load();
+    switch (backend) {
+        case BACKEND_CSV:
+            runCsv(options, rate, frames, samples);
+            break;
+        case BACKEND_BINARY:
+            runBinary(options, rate, frames, false, false, samples);
+            break;
+        case BACKEND_QUANTIZED:
+            runBinary(options, rate, frames, true, false, samples);
+            break;
+        case BACKEND_HANDS:
+            runBinary(options, rate, frames, true, true, samples);
+            break;
+        case BACKEND_MMAP:
+            runMapped(options, rate, frames, samples);
+            break;
+        case BACKEND_ASYNC:
+            runAsync(options, rate, frames, false, samples);
+            break;
+        default:
+            runAsync(options, rate, frames, true, samples);
+            break;
+    }
+    const uint64_t renderAllocs = threadAllocations - renderBefore;
+    const uint64_t totalAllocs = totalAllocations.load() - totalBefore;
+
+    Result result;
+    result.frames = samples.frameNs.size();
+    if (result.frames == 0) {
+        return result;
+    }
+    double total = 0.0;
+    for (double ns : samples.frameNs) {
+        total += ns;
+    }
+    result.meanNs = total / static_cast<double>(result.frames);
+    result.p99Ns = percentile(samples.frameNs, 0.99);
+    result.flushP50Ms = percentile(samples.flushMs, 0.50);
+    result.flushP99Ms = percentile(samples.flushMs, 0.99);
+    result.flushMaxMs = samples.flushMs.empty() ? 0.0 : samples.flushMs.back();
+    result.bytes = directorySize(options.workDir);
+    // Incluye abrir/cerrar ficheros: es el coste amortizado por frame grabado
+    result.allocsPerFrame = static_cast<double>(renderAllocs) / static_cast<double>(result.frames);
+    result.backgroundAllocsPerFrame =
+        static_cast<double>(totalAllocs - renderAllocs) / static_cast<double>(result.frames);
+    return result;
+}
+
+bool parseBackends(const char* list, std::vector<Backend>& backends) {
+    backends.clear();
+    std::stringstream ss(list);
+    std::string name;
+    while (std::getline(ss, name, ',')) {
+        int found = -1;
+        for (int b = 0; b < BACKEND_COUNT; b++) {
+            if (name == BACKEND_NAMES[b]) {
+                found = b;
+            }
+        }
+        if (found < 0) {
+            return false;
+        }
+        backends.push_back(static_cast<Backend>(found));
+    }
+    return !backends.empty();
+}
+
+bool parseRates(const char* list, std::vector<int>& rates) {
+    rates.clear();
+    std::stringstream ss(list);
+    std::string value;
+    while (std::getline(ss, value, ',')) {
+        const int rate = atoi(value.c_str());
+        if (rate <= 0) {
+            return false;
+        }
+        rates.push_back(rate);
+    }
+    return !rates.empty();
+}
+
+void printUsage() {
+    fprintf(
+        stderr,
+        "usage: prelibreria_recorder_bench [--seconds S] [--rates 72,90,120]\n"
+        "           [--backends csv,binary,quantized,hands,mmap,async,decimated]\n"
+        "           [--dir DIR] [--paced]\n"
+        "           [--max-ns-per-frame N] [--max-allocs-per-frame N]\n");
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    for (int i = 1; i < argc; i++) {
+        const bool hasValue = i + 1 < argc;
+        if (strcmp(argv[i], "--seconds") == 0 && hasValue) {
+            options.seconds = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--rates") == 0 && hasValue) {
+            if (!parseRates(argv[++i], options.rates)) {
+                printUsage();
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--backends") == 0 && hasValue) {
+            if (!parseBackends(argv[++i], options.backends)) {
+                printUsage();
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--dir") == 0 && hasValue) {
+            options.dir = argv[++i];
+        } else if (strcmp(argv[i], "--paced") == 0) {
+            options.paced = true;
+        } else if (strcmp(argv[i], "--max-ns-per-frame") == 0 && hasValue) {
+            options.maxNsPerFrame = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--max-allocs-per-frame") == 0 && hasValue) {
+            options.maxAllocsPerFrame = atof(argv[++i]);
+        } else {
+            printUsage();
+            return 1;
+        }
+    }
+    if (options.seconds <= 0.0) {
+        printUsage();
+        return 1;
+    }
+    // Nunca se borra nada que no haya creado el benchmark: si el subdirectorio ya
+    // existe (p.ej. de otro proceso con el mismo pid) no se usa
+    std::error_code error;
+    std::filesystem::create_directories(options.dir, error);
+    const std::filesystem::path workDir = std::filesystem::absolute(options.dir) /
+        ("prelibreria_bench_" + std::to_string(getpid()));
+    if (!std::filesystem::create_directory(workDir, error)) {
+        fprintf(stderr, "could not create %s\n", workDir.string().c_str());
+        return 1;
+    }
+    options.workDir = workDir.string();
+
+    printf(
+        "%-9s %4s %8s %10s %10s %10s %10s %10s %12s %8s %8s\n",
+        "backend",
+        "hz",
+        "frames",
+        "ns/frame",
+        "p99 ns",
+        "flush p50",
+        "flush p99",
+        "flush max",
+        "bytes",
+        "allocs/f",
+        "bg/f");
+
+    bool regression = false;
+    for (Backend backend : options.backends) {
+        for (int rate : options.rates) {
+            const Result r = runCase(options, backend, rate);
+            printf(
+                "%-9s %4d %8zu %10.1f %10.1f %8.3fms %8.3fms %8.3fms %12llu %8.3f %8.3f\n",
+                BACKEND_NAMES[backend],
+                rate,
+                r.frames,
+                r.meanNs,
+                r.p99Ns,
+                r.flushP50Ms,
+                r.flushP99Ms,
+                r.flushMaxMs,
+                static_cast<unsigned long long>(r.bytes),
+                r.allocsPerFrame,
+                r.backgroundAllocsPerFrame);
+            if ((options.maxNsPerFrame > 0.0 && r.meanNs > options.maxNsPerFrame) ||
+                (options.maxAllocsPerFrame >= 0.0 && r.allocsPerFrame > options.maxAllocsPerFrame)) {
+                printf("  ^ over threshold\n");
+                regression = true;
+            }
+        }
+    }
+    std::filesystem::remove_all(options.workDir);
+    return regression ? 2 : 0;
+}
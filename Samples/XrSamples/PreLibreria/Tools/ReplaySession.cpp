@@ -0,0 +1,108 @@
+// Herramienta de escritorio: reproduce una sesion grabada sin casco y mide el update.
+//
+//   prelibreria_replay [--max-speed] [--loops N] [--target none|recorder] parte0 parte1 ...
+//   prelibreria_replay [opciones] --manifest sesion.vrmx [--start S] [--duration S]
+//   prelibreria_replay --export-csv parte.vrmr salida.csv
+//
+// --export-csv no reproduce nada: convierte una parte al CSV que escribia antes el grabador
+// (RecordingReader::exportCsv) y sale.
+// Con --manifest solo se lee el tramo pedido, buscandolo con el indice de las partes.
+// --target none llama a un update vacio (linea base del propio replay).
+// --target recorder los pasa por MovementRecorder::recordFrame, como hace la app.
+// No hay target de app: el Update de PreLibreria necesita sesion y GL, asi que el
+// replay solo mide la grabadora.
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "Misc/Log.h"
+
+#include "Recorder/MovementRecorder.h"
+#include "Recorder/RecordingReader.h"
+#include "Replay/SessionReplay.h"
+
+namespace {
+
+void printUsage() {
+    fprintf(
+        stderr,
+        "usage: prelibreria_replay [--max-speed] [--loops N] [--target none|recorder] "
+        "recording...\n"
+        "       prelibreria_replay [options] --manifest SESSION.vrmx [--start S] [--duration S]\n"
+        "       prelibreria_replay --export-csv RECORDING OUT.csv\n");
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    SessionReplay::Pacing pacing = SessionReplay::PACING_RECORDED;
+    int loops = 1;
+    std::string target = "none";
+    std::vector<std::string> files;
+    std::string manifest;
+    double startSeconds = 0.0;
+    double durationSeconds = 0.0;
+
+    if (argc >= 2 && strcmp(argv[1], "--export-csv") == 0) {
+        if (argc != 4) {
+            printUsage();
+            return 1;
+        }
+        return RecordingReader::exportCsv(argv[2], argv[3]) ? 0 : 1;
+    }
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--max-speed") == 0) {
+            pacing = SessionReplay::PACING_MAX_SPEED;
+        } else if (strcmp(argv[i], "--loops") == 0 && i + 1 < argc) {
+            loops = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--target") == 0 && i + 1 < argc) {
+            target = argv[++i];
+        } else if (strcmp(argv[i], "--manifest") == 0 && i + 1 < argc) {
+            manifest = argv[++i];
+        } else if (strcmp(argv[i], "--start") == 0 && i + 1 < argc) {
+            startSeconds = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--duration") == 0 && i + 1 < argc) {
+            durationSeconds = atof(argv[++i]);
+        } else if (argv[i][0] == '-') {
+            printUsage();
+            return 1;
+        } else {
+            files.push_back(argv[i]);
+        }
+    }
+    if (files.empty() == manifest.empty() || loops <= 0 || (target != "none" && target != "recorder")) {
+        printUsage();
+        return 1;
+    }
+
+    SessionReplay replay;
+    const bool loaded = manifest.empty()
+        ? replay.load(files)
+        : replay.loadRange(manifest, startSeconds, durationSeconds);
+    if (!loaded || replay.getFrameCount() == 0) {
+        ALOGE("Replay: nothing to replay");
+        return 1;
+    }
+
+    SessionReplay::Stats stats;
+    if (target == "recorder") {
+        MovementRecorder recorder;
+        stats = replay.run(
+            [&recorder](const OVRFW::ovrApplFrameIn& in) { recorder.recordFrame(in); },
+            pacing,
+            loops);
+        recorder.finalize();
+        ALOG(
+            "Replay: recorder wrote %llu bytes, dropped %llu frames",
+            static_cast<unsigned long long>(recorder.getBytesWritten()),
+            static_cast<unsigned long long>(recorder.getDroppedFrames()));
+    } else {
+        stats = replay.run([](const OVRFW::ovrApplFrameIn&) {}, pacing, loops);
+    }
+    SessionReplay::logStats(stats);
+    return 0;
+}
@@ -0,0 +1,432 @@
+// Microbenchmark del coste de CPU de ovrSurfaceRender::RenderSurfaceList, sin GPU.
+//
+//   prelibreria_surface_bench [--surfaces N] [--programs N] [--textures N] [--geometries N]
+//                             [--frames N] [--sorted] [--queue] [--instancing]
+//                             [--no-filter] [--top N]
+//                             [--max-ns-per-surface N] [--max-redundant-calls N]
+//
+// Se compila con OVR_GL_DISPATCH, asi que las llamadas GL del framework van a la tabla
+// nula de Render/GlDispatch.h: el tiempo medido es solo el de SurfaceRender (cambios de
+// estado, programa, uniforms, texturas, VAO) mas una llamada indirecta por funcion GL,
+// no el del driver.
+//
+// Arma una lista sintetica de superficies que reparten programas, texturas y geometrias,
+// con una de cada cuatro transparente, en orden aleatorio (o ordenada por programa,
+// textura y geometria con --sorted, o en el orden de ovrRenderQueue con --queue, que es el
+// de BuildModelSurfaceList) y la pinta para los dos ojos en cada frame. Saca
+// ns/frame (p50/p95) y ns por superficie, y captura un frame con ovrGlCapture: llamadas
+// por funcion, total y cuantas dejan el estado como estaba (redundantes). Con --no-filter
+// se desactiva la cache de estado de ovrSurfaceRender (SetStateFiltering) para comparar.
+// Con --queue saca tambien lo que cuesta llenar y ordenar la cola en cada frame.
+// Con --instancing las superficies comparten color y fade, como los nodos que repiten una
+// malla, y la lista pasa por ovrInstanceBatcher con variantes instanciadas de los
+// programas: saca los draws instanciados, las instancias y lo que cuesta agrupar por frame.
+// Los umbrales --max-* hacen que termine con codigo 2 si se superan.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "Render/Egl.h"
+#include "Render/InstanceBatcher.h"
+#include "Render/RenderQueue.h"
+#include "Render/SurfaceRender.h"
+
+#if !defined(OVR_GL_DISPATCH)
+#error "prelibreria_surface_bench necesita OVR_GL_DISPATCH"
+#endif
+
+using OVR::Matrix4f;
+using OVR::Vector3f;
+using OVR::Vector4f;
+using namespace OVRFW;
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+struct Options {
+    int surfaces = 500;
+    int programs = 8;
+    int textures = 16;
+    int geometries = 4;
+    int frames = 2000;
+    int top = 12;
+    bool sorted = false;
+    bool queue = false;
+    bool instancing = false;
+    bool filter = true;
+    double maxNsPerSurface = 0.0; // 0 = sin umbral
+    long long maxRedundantCalls = -1; // < 0 = sin umbral
+};
+
+// Con la tabla nula los shaders no se compilan, pero Build pide las mismas ubicaciones
+const char* VERTEX_SHADER = R"glsl(
+attribute highp vec4 Position;
+attribute highp vec2 TexCoord;
+varying highp vec2 oTexCoord;
+void main() {
+    gl_Position = TransformVertex(Position);
+    oTexCoord = TexCoord;
+}
+)glsl";
+
+const char* FRAGMENT_SHADER = R"glsl(
+uniform sampler2D Texture0;
+uniform lowp vec4 UniformColor;
+uniform lowp float UniformFade;
+varying highp vec2 oTexCoord;
+void main() {
+    gl_FragColor = UniformColor * UniformFade * texture2D(Texture0, oTexCoord);
+}
+)glsl";
+
+const ovrProgramParm PROGRAM_PARMS[] = {
+    {"Texture0", ovrProgramParmType::TEXTURE_SAMPLED},
+    {"UniformColor", ovrProgramParmType::FLOAT_VECTOR4},
+    {"UniformFade", ovrProgramParmType::FLOAT},
+};
+
+struct Scene {
+    std::vector<GlProgram> programs;
+    std::vector<GlProgram> instancedPrograms;
+    std::vector<GlTexture> textures;
+    std::vector<GlGeometry> geometries;
+    std::vector<ovrSurfaceDef> surfaces;
+    std::vector<Vector4f> colors;
+    std::vector<float> fades;
+    std::vector<ovrDrawSurface> emitted; // en el orden de entrada
+    std::vector<ovrDrawSurface> drawList; // en el orden de pintado
+    std::vector<ovrDrawSurface> unbatched; // drawList antes de ovrInstanceBatcher
+    ovrInstanceBatcher batcher;
+};
+
+// Como BuildModelSurfaceList: la clave de profundidad es la distancia a la camara
+void queueSurfaces(const std::vector<ovrDrawSurface>& emitted, ovrRenderQueue& queue) {
+    queue.Clear();
+    for (const ovrDrawSurface& drawSurf : emitted) {
+        const int transform = queue.AddTransform(drawSurf.modelMatrix);
+        queue.Add(drawSurf.surface, transform, -drawSurf.modelMatrix.M[2][3]);
+    }
+    queue.Sort();
+}
+
+void buildScene(const Options& options, Scene& scene) {
+    for (int i = 0; i < options.programs; i++) {
+        scene.programs.push_back(GlProgram::Build(
+            VERTEX_SHADER,
+            FRAGMENT_SHADER,
+            PROGRAM_PARMS,
+            sizeof(PROGRAM_PARMS) / sizeof(PROGRAM_PARMS[0])));
+        if (options.instancing) {
+            scene.instancedPrograms.push_back(GlProgram::Build(
+                GlProgram::INSTANCED_VERTEX_DIRECTIVES,
+                VERTEX_SHADER,
+                nullptr,
+                FRAGMENT_SHADER,
+                PROGRAM_PARMS,
+                sizeof(PROGRAM_PARMS) / sizeof(PROGRAM_PARMS[0])));
+            scene.batcher.SetInstancedProgram(scene.programs[i], scene.instancedPrograms[i]);
+        }
+    }
+    for (int i = 0; i < options.textures; i++) {
+        // La tabla nula no crea texturas, basta con nombres distintos
+        scene.textures.push_back(GlTexture(1000 + i, GL_TEXTURE_2D, 256, 256));
+    }
+    for (int i = 0; i < options.geometries; i++) {
+        scene.geometries.push_back(BuildTesselatedQuad(1 + i, 1 + i));
+    }
+
+    // Reservado antes para que los punteros de UniformData no cambien
+    scene.surfaces.resize(options.surfaces);
+    scene.colors.resize(options.surfaces);
+    scene.fades.resize(options.surfaces);
+    std::mt19937 random(1234);
+    for (int i = 0; i < options.surfaces; i++) {
+        ovrSurfaceDef& surface = scene.surfaces[i];
+        surface.surfaceName = "surface";
+        surface.geo = scene.geometries[random() % scene.geometries.size()];
+
+        ovrGraphicsCommand& cmd = surface.graphicsCommand;
+        cmd.Program = scene.programs[random() % scene.programs.size()];
+        cmd.Textures[0] = scene.textures[random() % scene.textures.size()];
+        scene.colors[i] = Vector4f(1.0f, 0.5f, 0.25f, 1.0f);
+        scene.fades[i] = 1.0f;
+        cmd.UniformData[0].Data = &cmd.Textures[0];
+        // Con --instancing el mismo color y fade para todas, si no cada una los suyos
+        const int uniforms = options.instancing ? 0 : i;
+        cmd.UniformData[1].Data = &scene.colors[uniforms];
+        cmd.UniformData[2].Data = &scene.fades[uniforms];
+        if (i % 4 == 0) {
+            cmd.GpuState.blendEnable = ovrGpuState::BLEND_ENABLE;
+            cmd.GpuState.depthMaskEnable = false;
+        }
+
+        const Matrix4f model = Matrix4f::Translation(
+            Vector3f(float(i % 10) - 5.0f, float((i / 10) % 10) - 5.0f, -2.0f - float(i / 100)));
+        scene.emitted.push_back(ovrDrawSurface(model, &surface));
+    }
+    scene.drawList = scene.emitted;
+
+    if (options.queue) {
+        ovrRenderQueue queue;
+        queueSurfaces(scene.emitted, queue);
+        queue.GetSurfaceList(scene.drawList);
+    } else if (options.sorted) {
+        std::stable_sort(
+            scene.drawList.begin(),
+            scene.drawList.end(),
+            [](const ovrDrawSurface& a, const ovrDrawSurface& b) {
+                const ovrGraphicsCommand& ca = a.surface->graphicsCommand;
+                const ovrGraphicsCommand& cb = b.surface->graphicsCommand;
+                if (ca.GpuState.blendEnable != cb.GpuState.blendEnable) {
+                    return ca.GpuState.blendEnable < cb.GpuState.blendEnable;
+                }
+                if (ca.Program.Program != cb.Program.Program) {
+                    return ca.Program.Program < cb.Program.Program;
+                }
+                if (ca.Textures[0].texture != cb.Textures[0].texture) {
+                    return ca.Textures[0].texture < cb.Textures[0].texture;
+                }
+                return a.surface->geo.vertexArrayObject < b.surface->geo.vertexArrayObject;
+            });
+    }
+
+    scene.unbatched = scene.drawList;
+    if (options.instancing) {
+        scene.batcher.Batch(scene.drawList);
+    }
+}
+
+void freeScene(Scene& scene) {
+    for (GlProgram& program : scene.programs) {
+        GlProgram::Free(program);
+    }
+    for (GlProgram& program : scene.instancedPrograms) {
+        GlProgram::Free(program);
+    }
+    scene.batcher.Shutdown();
+    for (GlGeometry& geometry : scene.geometries) {
+        geometry.Free();
+    }
+}
+
+// Un frame: los dos ojos, como XrApp sin multiview
+ovrDrawCounters renderFrame(ovrSurfaceRender& surfaceRender, const Scene& scene) {
+    const Matrix4f views[2] = {
+        Matrix4f::Translation(Vector3f(0.032f, 0.0f, 0.0f)),
+        Matrix4f::Translation(Vector3f(-0.032f, 0.0f, 0.0f))};
+    const Matrix4f projection = Matrix4f::PerspectiveLH(1.5f, 1.0f, 0.1f, 100.0f);
+    const Matrix4f projections[2] = {projection, projection};
+    ovrDrawCounters total;
+    // RenderSurfaceList lee las matrices de los dos ojos a partir de la primera
+    for (int eye = 0; eye < 2; eye++) {
+        const ovrDrawCounters c =
+            surfaceRender.RenderSurfaceList(scene.drawList, views[0], projections[0], eye);
+        total.numDrawCalls += c.numDrawCalls;
+        total.numInstancedDrawCalls += c.numInstancedDrawCalls;
+        total.numInstances += c.numInstances;
+        total.numProgramBinds += c.numProgramBinds;
+        total.numTextureBinds += c.numTextureBinds;
+        total.numBufferBinds += c.numBufferBinds;
+        total.numVertexArrayBinds += c.numVertexArrayBinds;
+        total.numParameterUpdates += c.numParameterUpdates;
+        total.numElidedProgramBinds += c.numElidedProgramBinds;
+        total.numElidedParameterUpdates += c.numElidedParameterUpdates;
+        total.numElidedTextureBinds += c.numElidedTextureBinds;
+        total.numElidedBufferBinds += c.numElidedBufferBinds;
+        total.numElidedVertexArrayBinds += c.numElidedVertexArrayBinds;
+    }
+    return total;
+}
+
+double percentile(std::vector<double>& values, double p) {
+    if (values.empty()) {
+        return 0.0;
+    }
+    const size_t index = std::min(values.size() - 1, static_cast<size_t>(p * values.size()));
+    std::nth_element(values.begin(), values.begin() + index, values.end());
+    return values[index];
+}
+
+void printUsage() {
+    fprintf(
+        stderr,
+        "usage: prelibreria_surface_bench [--surfaces N] [--programs N] [--textures N]\n"
+        "           [--geometries N] [--frames N] [--sorted] [--queue] [--instancing]\n"
+        "           [--no-filter] [--top N] [--max-ns-per-surface N] [--max-redundant-calls N]\n");
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    for (int i = 1; i < argc; i++) {
+        const bool hasValue = i + 1 < argc;
+        if (strcmp(argv[i], "--surfaces") == 0 && hasValue) {
+            options.surfaces = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--programs") == 0 && hasValue) {
+            options.programs = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--textures") == 0 && hasValue) {
+            options.textures = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--geometries") == 0 && hasValue) {
+            options.geometries = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--frames") == 0 && hasValue) {
+            options.frames = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--top") == 0 && hasValue) {
+            options.top = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--sorted") == 0) {
+            options.sorted = true;
+        } else if (strcmp(argv[i], "--queue") == 0) {
+            options.queue = true;
+        } else if (strcmp(argv[i], "--instancing") == 0) {
+            options.instancing = true;
+        } else if (strcmp(argv[i], "--no-filter") == 0) {
+            options.filter = false;
+        } else if (strcmp(argv[i], "--max-ns-per-surface") == 0 && hasValue) {
+            options.maxNsPerSurface = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--max-redundant-calls") == 0 && hasValue) {
+            options.maxRedundantCalls = atoll(argv[++i]);
+        } else {
+            printUsage();
+            return 1;
+        }
+    }
+    if (options.surfaces <= 0 || options.programs <= 0 || options.textures <= 0 ||
+        options.geometries <= 0 || options.frames <= 0) {
+        printUsage();
+        return 1;
+    }
+
+    ovrGlDispatch_UseNull();
+    ovrSurfaceRender surfaceRender;
+    surfaceRender.Init();
+    surfaceRender.SetStateFiltering(options.filter);
+    Scene scene;
+    buildScene(options, scene);
+
+    // Calentamiento, y el frame capturado
+    renderFrame(surfaceRender, scene);
+    ovrGlCapture capture;
+    capture.Begin();
+    const ovrDrawCounters counters = renderFrame(surfaceRender, scene);
+    capture.End();
+
+    std::vector<double> frameNs(options.frames);
+    for (int i = 0; i < options.frames; i++) {
+        const Clock::time_point before = Clock::now();
+        renderFrame(surfaceRender, scene);
+        frameNs[i] =
+            std::chrono::duration<double, std::nano>(Clock::now() - before).count();
+    }
+    double totalNs = 0.0;
+    for (double ns : frameNs) {
+        totalNs += ns;
+    }
+    const double meanNs = totalNs / options.frames;
+    const double nsPerSurface = meanNs / (2.0 * options.surfaces);
+
+    printf(
+        "%d surfaces, %d programs, %d textures, %d geometries, %s%s, %s, %d frames (2 eyes)\n",
+        options.surfaces,
+        options.programs,
+        options.textures,
+        options.geometries,
+        options.queue ? "render queue" : (options.sorted ? "sorted" : "unsorted"),
+        options.instancing ? " + instancing" : "",
+        options.filter ? "state filtering" : "no state filtering",
+        options.frames);
+    printf(
+        "ns/frame mean %.0f  p50 %.0f  p95 %.0f   ns/surface %.1f\n",
+        meanNs,
+        percentile(frameNs, 0.50),
+        percentile(frameNs, 0.95),
+        nsPerSurface);
+    printf(
+        "draws %d  program binds %d  uniforms %d  texture binds %d  buffer binds %d  vaos %d\n",
+        counters.numDrawCalls,
+        counters.numProgramBinds,
+        counters.numParameterUpdates,
+        counters.numTextureBinds,
+        counters.numBufferBinds,
+        counters.numVertexArrayBinds);
+    printf(
+        "elided:      program binds %d  uniforms %d  texture binds %d  buffer binds %d  vaos %d\n",
+        counters.numElidedProgramBinds,
+        counters.numElidedParameterUpdates,
+        counters.numElidedTextureBinds,
+        counters.numElidedBufferBinds,
+        counters.numElidedVertexArrayBinds);
+
+    if (options.queue) {
+        ovrRenderQueue queue;
+        std::vector<double> queueNs(options.frames);
+        for (int i = 0; i < options.frames; i++) {
+            const Clock::time_point before = Clock::now();
+            queueSurfaces(scene.emitted, queue);
+            queue.GetSurfaceList(scene.drawList);
+            queueNs[i] =
+                std::chrono::duration<double, std::nano>(Clock::now() - before).count();
+        }
+        printf("queue fill + sort ns/frame p50 %.0f\n", percentile(queueNs, 0.50));
+    }
+
+    if (options.instancing) {
+        printf(
+            "instanced draws %d  instances %d  batches %d  batched surfaces %d\n",
+            counters.numInstancedDrawCalls,
+            counters.numInstances,
+            scene.batcher.GetNumBatches(),
+            scene.batcher.GetNumBatchedSurfaces());
+        std::vector<double> batchNs(options.frames);
+        for (int i = 0; i < options.frames; i++) {
+            const Clock::time_point before = Clock::now();
+            scene.drawList = scene.unbatched;
+            scene.batcher.Batch(scene.drawList);
+            batchNs[i] =
+                std::chrono::duration<double, std::nano>(Clock::now() - before).count();
+        }
+        printf("instance batching ns/frame p50 %.0f\n", percentile(batchNs, 0.50));
+    }
+
+    const unsigned long long redundant = capture.CountRedundantStateCalls();
+    printf(
+        "GL calls/frame %llu  redundant state calls %llu\n",
+        static_cast<unsigned long long>(capture.GetTotalCallCount()),
+        redundant);
+
+    std::vector<int> functions;
+    for (int f = 0; f < OVR_GL_FUNCTION_COUNT; f++) {
+        if (capture.GetCallCount(ovrGlFunction(f)) > 0) {
+            functions.push_back(f);
+        }
+    }
+    std::sort(functions.begin(), functions.end(), [&capture](int a, int b) {
+        return capture.GetCallCount(ovrGlFunction(a)) > capture.GetCallCount(ovrGlFunction(b));
+    });
+    for (size_t i = 0; i < functions.size() && i < static_cast<size_t>(options.top); i++) {
+        printf(
+            "  %-26s %8llu\n",
+            ovrGlDispatch_FunctionName(ovrGlFunction(functions[i])),
+            static_cast<unsigned long long>(capture.GetCallCount(ovrGlFunction(functions[i]))));
+    }
+
+    freeScene(scene);
+    surfaceRender.Shutdown();
+
+    bool regression = false;
+    if (options.maxNsPerSurface > 0.0 && nsPerSurface > options.maxNsPerSurface) {
+        printf("  ^ ns/surface over threshold\n");
+        regression = true;
+    }
+    if (options.maxRedundantCalls >= 0 &&
+        redundant > static_cast<unsigned long long>(options.maxRedundantCalls)) {
+        printf("  ^ redundant state calls over threshold\n");
+        regression = true;
+    }
+    return regression ? 2 : 0;
+}
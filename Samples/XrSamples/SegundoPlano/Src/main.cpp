@@ -14,12 +14,17 @@
 #include "XrApp.h"
 #include "OVR_Math.h"
 #include "Misc/Log.h"
+#include "Render/PerfHud.h"
+#include "Render/QuadOverlay.h"
 
 class SegundoPlanoApp : public OVRFW::XrApp {
 private:
-    // Compositor Layer para el overlay de texto (Quad=Rectangulo)
-    XrCompositionLayerQuad textOverlayLayer;
-    XrSwapchain textSwapchain;
+    // Overlay de texto: compositor layer Quad (Rectangulo) con su propio swapchain.
+    // Solo se vuelve a dibujar cuando cambia el texto.
+    OVRFW::ovrQuadOverlay textOverlay;
+
+    // Panel de rendimiento: tiempos de frame, Update, render y draw calls del framework
+    OVRFW::ovrPerfHud perfHud;
 
     // Configuración del overlay
     bool overlayEnabled = true;
@@ -27,9 +32,12 @@ private:
     static const int OVERLAY_HEIGHT = 256;
 
     // OpenGL resources
-    GLuint framebuffer;
     GLuint shaderProgram;
     GLuint VAO, VBO, EBO;
+    // Posiciones de los uniforms, se buscan una vez al linkar
+    GLint colorLocation = -1;
+    GLint timeLocation = -1;
+    GLint digitsLocation = -1;
 
     // Variables para texto dinámico
     std::string currentTimeText;
@@ -39,15 +47,9 @@ private:
 public:
     SegundoPlanoApp() : OVRFW::XrApp() {
         BackgroundColor = OVR::Vector4f(0.1f, 0.1f, 0.1f, 1.0f);
-        textSwapchain = XR_NULL_HANDLE; // El valor significa no-inicializado
-        framebuffer = 0;
         shaderProgram = 0;
         VAO = VBO = EBO = 0;
 
-        // Memory set para inicializacion de forma segura
-        std::memset(&textOverlayLayer, 0, sizeof(textOverlayLayer));
-        textOverlayLayer.type = XR_TYPE_COMPOSITION_LAYER_QUAD;
-
         lastTimeUpdate = std::chrono::steady_clock::now();
         UpdateTimeText();
     }
@@ -60,6 +62,8 @@ public:
     //Aqui se crea la sesion OpenXR
     virtual bool AppInit(const xrJava* context) override {
         ALOG("SegundoPlano AppInit iniciado");
+        // El panel de rendimiento lee los tiempos del frame timer
+        GetFrameTimer().SetEnabled(true);
         return true;
     }
 
@@ -67,11 +71,12 @@ public:
     virtual bool SessionInit() override {
         ALOG("SegundoPlano SessionInit iniciado");
 
-        // Crear swapchain para el overlay de texto
-        if (!CreateTextOverlaySwapchain()) {
+        // Crear swapchain y framebuffers para el overlay de texto
+        if (!textOverlay.Init(Session, OVERLAY_WIDTH, OVERLAY_HEIGHT)) {
             ALOG("ERROR: No se pudo crear el swapchain para el overlay");
             return false;
         }
+        ALOG("Swapchain creado exitosamente: %dx%d", OVERLAY_WIDTH, OVERLAY_HEIGHT);
 
         // Configurar OpenGL para renderizar texto
         if (!SetupTextRendering()) {
@@ -82,11 +87,26 @@ public:
         // Configurar la compositor layer
         SetupCompositorLayer();
 
+        // Panel de rendimiento a la izquierda del reloj, se refresca 4 veces por segundo.
+        // Si falla la fuente se sigue sin el.
+        if (perfHud.Init(Session, *GetFileSys(), GetSurfaceRender())) {
+            perfHud.GetOverlay().SetSpace(HeadSpace);
+            perfHud.GetOverlay().SetPose(
+                OVR::Posef(OVR::Quatf(), OVR::Vector3f(-0.4f, -0.25f, -1.5f)));
+            perfHud.GetOverlay().SetSize(0.3f, 0.15f);
+            perfHud.SetRefreshRate(4.0f);
+        } else {
+            ALOG("ERROR: No se pudo crear el panel de rendimiento");
+        }
+
         ALOG("SegundoPlano SessionInit completado exitosamente");
         return true;
     }
 
-    virtual void Update(const OVRFW::ovrApplFrameIn& in) override {
+    // Todo lo de los overlays va aqui, en el hilo de GL aunque el MainLoop vaya en pipeline:
+    // textOverlay.Update dibuja con GL y RenderText lee el texto y el tiempo de animacion,
+    // asi nada se comparte con Update
+    virtual void Render(const OVRFW::ovrApplFrameIn& in, OVRFW::ovrRendererOutput& out) override {
         // Actualizar el tiempo de animación
         animationTime += in.DeltaSeconds;
 
@@ -96,39 +116,33 @@ public:
         if (duration.count() >= 1000) { // Actualizar cada 1000ms (1 segundo)
             UpdateTimeText();
             lastTimeUpdate = now;
-        }
-
-        // Actualizar el contenido del overlay cada frame
-        if (overlayEnabled && textSwapchain != XR_NULL_HANDLE) {
-            UpdateTextOverlay();
+            textOverlay.MarkDirty();
         }
 
         // Toggle overlay con botón A
         if (in.Clicked(OVRFW::ovrApplFrameIn::kButtonA)) {
             overlayEnabled = !overlayEnabled;
+            textOverlay.SetVisible(overlayEnabled);
+            perfHud.GetOverlay().SetVisible(overlayEnabled);
             ALOG("Overlay %s", overlayEnabled ? "activado" : "desactivado");
         }
-    }
 
-    virtual void Render(const OVRFW::ovrApplFrameIn& in, OVRFW::ovrRendererOutput& out) override {
-        // La aplicación base puede renderizar su contenido aquí
+        // Solo dibuja si el texto ha cambiado; si no, se reenvia la ultima imagen
+        textOverlay.Update();
+        perfHud.Update(GetFrameTimer(), GetSimulationTimer());
     }
 
     // Se ejecuta en el main loop despues de renderizar el contenido  (si quisieramos capas detras del contenido se usaria PreProjectionAddLayer)
     virtual void PostProjectionAddLayer(OVRFW::XrApp::xrCompositorLayerUnion* layers, int& layerCount) override {
-        if (overlayEnabled && textSwapchain != XR_NULL_HANDLE) {
-            // Accedemos al tipo quad en la union que contiene los tipos de layer
-            layers[layerCount++].Quad = textOverlayLayer;
-            ALOG("Compositor layer añadida, total layers: %d", layerCount);
-        }
+        // Accedemos al tipo quad en la union que contiene los tipos de layer
+        textOverlay.AddLayer(layers, layerCount);
+        perfHud.AddLayer(layers, layerCount);
     }
 
     virtual void SessionEnd() override {
         CleanupTextRendering();
-        if (textSwapchain != XR_NULL_HANDLE) {
-            xrDestroySwapchain(textSwapchain);
-            textSwapchain = XR_NULL_HANDLE;
-        }
+        textOverlay.Shutdown();
+        perfHud.Shutdown();
         ALOG("SegundoPlano SessionEnd completado");
     }
 
@@ -153,95 +167,9 @@ private:
         ALOG("Tiempo actualizado: %s", currentTimeText.c_str());
     }
 
-    bool CreateTextOverlaySwapchain() {
-        // Configurar el formato del swapchain
-        XrSwapchainCreateInfo swapchainCreateInfo{XR_TYPE_SWAPCHAIN_CREATE_INFO};
-        swapchainCreateInfo.arraySize = 1; // 1 para Imagen 2D normal
-        swapchainCreateInfo.format = static_cast<int64_t>(GL_RGBA8); // OpenXR espera int64_t para format
-        swapchainCreateInfo.width = OVERLAY_WIDTH;
-        swapchainCreateInfo.height = OVERLAY_HEIGHT;
-        swapchainCreateInfo.mipCount = 1; //sin mipmaps
-        swapchainCreateInfo.faceCount = 1; //sin cubemap
-        swapchainCreateInfo.sampleCount = 1; //sin multisampling
-        swapchainCreateInfo.usageFlags = XR_SWAPCHAIN_USAGE_COLOR_ATTACHMENT_BIT | XR_SWAPCHAIN_USAGE_SAMPLED_BIT;
-
-        XrResult result = xrCreateSwapchain(Session, &swapchainCreateInfo, &textSwapchain);
-        if (XR_FAILED(result)) {
-            ALOG("ERROR: xrCreateSwapchain falló: %d", result);
-            return false;
-        }
-
-        ALOG("Swapchain creado exitosamente: %dx%d", OVERLAY_WIDTH, OVERLAY_HEIGHT);
-        return true;
-    }
-
-    void UpdateTextOverlay() {
-        // Obtener imagen actual del swapchain
-        XrSwapchainImageAcquireInfo acquireInfo{XR_TYPE_SWAPCHAIN_IMAGE_ACQUIRE_INFO};
-        uint32_t imageIndex;
-        XrResult result = xrAcquireSwapchainImage(textSwapchain, &acquireInfo, &imageIndex);
-        if (XR_FAILED(result)) {
-            ALOG("ERROR: xrAcquireSwapchainImage falló: %d", result);
-            return;
-        }
-
-        // Esperar a que la imagen esté disponible
-        XrSwapchainImageWaitInfo waitInfo{XR_TYPE_SWAPCHAIN_IMAGE_WAIT_INFO};
-        waitInfo.timeout = XR_INFINITE_DURATION;
-        result = xrWaitSwapchainImage(textSwapchain, &waitInfo);
-        if (XR_FAILED(result)) {
-            ALOG("ERROR: xrWaitSwapchainImage falló: %d", result);
-            XrSwapchainImageReleaseInfo releaseInfo{XR_TYPE_SWAPCHAIN_IMAGE_RELEASE_INFO};
-            xrReleaseSwapchainImage(textSwapchain, &releaseInfo);
-            return;
-        }
-
-        // Obtener las imágenes del swapchain
-        uint32_t imageCount;
-        xrEnumerateSwapchainImages(textSwapchain, 0, &imageCount, nullptr);
-        std::vector<XrSwapchainImageOpenGLESKHR> swapchainImages(imageCount, {XR_TYPE_SWAPCHAIN_IMAGE_OPENGL_ES_KHR});
-        xrEnumerateSwapchainImages(textSwapchain, imageCount, &imageCount,
-                                   reinterpret_cast<XrSwapchainImageBaseHeader*>(swapchainImages.data()));
-
-        if (imageIndex >= imageCount) {
-            ALOG("ERROR: imageIndex fuera de rango: %u >= %u", imageIndex, imageCount);
-            XrSwapchainImageReleaseInfo releaseInfo{XR_TYPE_SWAPCHAIN_IMAGE_RELEASE_INFO};
-            xrReleaseSwapchainImage(textSwapchain, &releaseInfo);
-            return;
-        }
-
-        // Renderizar el contenido del texto
-        RenderTextToTexture(swapchainImages[imageIndex].image);
-
-        // Liberar la imagen
-        XrSwapchainImageReleaseInfo releaseInfo{XR_TYPE_SWAPCHAIN_IMAGE_RELEASE_INFO};
-        xrReleaseSwapchainImage(textSwapchain, &releaseInfo);
-    }
-
-    void RenderTextToTexture(GLuint texture) {
-        // Crear framebuffer si no existe
-        if (framebuffer == 0) {
-            glGenFramebuffers(1, &framebuffer);
-        }
-
-        // Configurar framebuffer para renderizar a la textura
-        glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
-        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, texture, 0);
-
-        GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
-        if (status != GL_FRAMEBUFFER_COMPLETE) {
-            ALOG("ERROR: Framebuffer incompleto: 0x%x", status);
-            glBindFramebuffer(GL_FRAMEBUFFER, 0);
-            return;
-        }
-
-        // Configurar viewport
-        glViewport(0, 0, OVERLAY_WIDTH, OVERLAY_HEIGHT);
-
-        // Limpiar con transparencia
-        glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
-        glClear(GL_COLOR_BUFFER_BIT);
-
+    // Lo llama textOverlay.Update con el framebuffer de la imagen ya enlazado y limpio
+    // (transparente). El brillo pulsante avanza solo cuando se redibuja, una vez por segundo.
+    void RenderText(int width, int height) {
         // Activa el mezclado alfa
         glEnable(GL_BLEND);
         glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
@@ -251,19 +179,16 @@ private:
 
         // Configurar color del texto (verde brillante con pulsación)
         float pulse = 0.8f + 0.2f * sinf(animationTime * 2.0f);
-        GLint colorLocation = glGetUniformLocation(shaderProgram, "textColor");
         if (colorLocation >= 0) {
             glUniform3f(colorLocation, 0.0f, pulse, 0.2f);
         }
 
         // Pasar el tiempo para animación
-        GLint timeLocation = glGetUniformLocation(shaderProgram, "time");
         if (timeLocation >= 0) {
             glUniform1f(timeLocation, animationTime);
         }
 
         // Pasar la cadena de tiempo como uniforms (simplificado para los primeros 8 caracteres)
-        GLint digitsLocation = glGetUniformLocation(shaderProgram, "timeDigits");
         if (digitsLocation >= 0) {
             float digits[12] = {0.0f}; // Máximo 12 caracteres
             for (int i = 0; i < std::min(12, (int)currentTimeText.length()); ++i) {
@@ -287,7 +212,6 @@ private:
         glBindVertexArray(0);
 
         glDisable(GL_BLEND);
-        glBindFramebuffer(GL_FRAMEBUFFER, 0);
     }
 
     bool SetupTextRendering() {
@@ -439,6 +363,10 @@ private:
         glDeleteShader(vertexShader);
         glDeleteShader(fragmentShader);
 
+        colorLocation = glGetUniformLocation(shaderProgram, "textColor");
+        timeLocation = glGetUniformLocation(shaderProgram, "time");
+        digitsLocation = glGetUniformLocation(shaderProgram, "timeDigits");
+
         // Configurar geometría (quad completo)
         float vertices[] = {
                 // positions    // texture coords
@@ -498,43 +426,23 @@ private:
     }
 
     void SetupCompositorLayer() {
-        // Configurar la compositor layer
-        textOverlayLayer.type = XR_TYPE_COMPOSITION_LAYER_QUAD;
-        textOverlayLayer.layerFlags = XR_COMPOSITION_LAYER_BLEND_TEXTURE_SOURCE_ALPHA_BIT;
-        textOverlayLayer.space = HeadSpace;
-        textOverlayLayer.eyeVisibility = XR_EYE_VISIBILITY_BOTH;
-
-        // Posición: delante del usuario, ligeramente hacia arriba
-        textOverlayLayer.pose.position.x = 0.4f;    // derecha
-        textOverlayLayer.pose.position.y = -0.3f;  // abajo
-        textOverlayLayer.pose.position.z = -1.5f; // Distancia cómoda
-        textOverlayLayer.pose.orientation.x = 0.0f;
-        textOverlayLayer.pose.orientation.y = 0.0f;
-        textOverlayLayer.pose.orientation.z = 0.0f;
-        textOverlayLayer.pose.orientation.w = 1.0f;
+        // Capa fija a la cabeza, con alfa
+        textOverlay.SetSpace(HeadSpace);
+        textOverlay.SetLayerFlags(XR_COMPOSITION_LAYER_BLEND_TEXTURE_SOURCE_ALPHA_BIT);
+
+        // Posición: delante del usuario, abajo a la derecha, a una distancia cómoda
+        textOverlay.SetPose(OVR::Posef(OVR::Quatf(), OVR::Vector3f(0.4f, -0.3f, -1.5f)));
 
         // Tamaño del quad (más grande para texto)
-        textOverlayLayer.size.width = 0.3f;
-        textOverlayLayer.size.height = 0.08f;
-
-        // Configurar el submuestreo (imagen completa)
-        textOverlayLayer.subImage.swapchain = textSwapchain;
-        textOverlayLayer.subImage.imageRect.offset.x = 0;
-        textOverlayLayer.subImage.imageRect.offset.y = 0;
-        textOverlayLayer.subImage.imageRect.extent.width = OVERLAY_WIDTH;
-        textOverlayLayer.subImage.imageRect.extent.height = OVERLAY_HEIGHT;
-        textOverlayLayer.subImage.imageArrayIndex = 0;
-
-        ALOG("Compositor layer configurada: posición (%.2f, %.2f, %.2f), tamaño (%.2f, %.2f)",
-             textOverlayLayer.pose.position.x, textOverlayLayer.pose.position.y, textOverlayLayer.pose.position.z,
-             textOverlayLayer.size.width, textOverlayLayer.size.height);
+        textOverlay.SetSize(0.3f, 0.08f);
+
+        textOverlay.SetRenderFunction(
+            [this](int width, int height) { RenderText(width, height); });
+
+        ALOG("Compositor layer configurada: posición (0.40, -0.30, -1.50), tamaño (0.30, 0.08)");
     }
 
     void CleanupTextRendering() {
-        if (framebuffer != 0) {
-            glDeleteFramebuffers(1, &framebuffer);
-            framebuffer = 0;
-        }
         if (VAO != 0) {
             glDeleteVertexArrays(1, &VAO);
             VAO = 0;